@@ -5,18 +5,21 @@ pushd build
 
 OPTIND=1
 RELEASE=false
+PERF=false
 RELEASE_FLAGS=""
 INTERNAL=1
 SLOW=1
 
-while getopts "h?r" opt; do
+while getopts "h?rp" opt; do
     case "$opt" in
     h|\?)
-        echo "Usage: $0 [-r]"
+        echo "Usage: $0 [-r] [-p] [-- replay bench options]"
         exit 0
         ;;
     r)  RELEASE=true
         ;;
+    p)  PERF=true
+        ;;
     esac
 done
 
@@ -34,10 +37,45 @@ else
     echo "Building debug build..."
 fi
 
-COMPILER_FLAGS="-fno-rtti -fno-exceptions -Wall -Werror -Wno-write-strings -Wno-unused-variable -Wno-unused-function -Wno-unused-but-set-variable -DHEX_MAGIC_INTERNAL=$INTERNAL -DHEX_MAGIC_SLOW=$SLOW -DHEX_MAGIC_LINUX=1"
-LINKER_FLAGS="-lSDL2"
+COMMON_FLAGS="-fno-rtti -fno-exceptions -Wall -Werror -Wno-write-strings -Wno-unused-variable -Wno-unused-function -Wno-unused-but-set-variable -DHEX_MAGIC_LINUX=1"
+COMPILER_FLAGS="$COMMON_FLAGS -DHEX_MAGIC_INTERNAL=$INTERNAL -DHEX_MAGIC_SLOW=$SLOW"
+LINKER_FLAGS="-lSDL2 -lpthread"
 
 g++ $COMPILER_FLAGS $RELEASE_FLAGS ../src/hex_magic.cpp -g -shared -fPIC -o hex_magic_temp.so && mv hex_magic_temp.so hex_magic.so
 g++ $COMPILER_FLAGS $RELEASE_FLAGS ../src/linux_hex_magic.cpp -g -o linux_hex_magic $LINKER_FLAGS
+g++ $COMPILER_FLAGS $RELEASE_FLAGS ../src/hex_magic_bench.cpp -g -o hex_magic_bench -lpthread
+g++ $COMPILER_FLAGS $RELEASE_FLAGS ../src/hex_magic_packer.cpp -g -o hex_magic_packer
+
+# NOTE the game itself only builds as an internal build, but the timed blocks all over it have to compile away
+# without one. This only checks the macros.
+g++ $COMMON_FLAGS -DHEX_MAGIC_INTERNAL=0 -DHEX_MAGIC_SLOW=0 -I../src -fsyntax-only -x c++ - <<'EOF'
+#include "hex_magic_platform.h"
+
+internal void CheckTimedBlocks()
+{
+    TIMED_FUNCTION();
+    TIMED_BLOCK("CheckTimedBlocks");
+
+    BEGIN_TIMED_BLOCK(CHECK_TIMED_BLOCKS);
+    END_TIMED_BLOCK(CHECK_TIMED_BLOCKS);
+}
+EOF
 
 popd
+
+# NOTE packs data/assets into data/assets.hxa for the game to map. If it can't, the game loads the source files the
+# slow way, so the build goes on either way.
+pushd data
+../build/hex_magic_packer
+popd
+
+# NOTE plays the canonical replays and checks them against data/replay_baseline.txt, what is left after -- goes to the
+# bench, like --threshold 5 or --save-baseline.
+if $PERF;
+then
+    pushd data
+    ../build/hex_magic_bench replay "$@"
+    PERF_RESULT=$?
+    popd
+    exit $PERF_RESULT
+fi
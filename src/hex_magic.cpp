@@ -7,38 +7,35 @@
 #include "hex_magic_platform.h"
 
 #include "hex_magic_hex.cpp"
+#include "hex_magic_hex_batch.cpp"
+#include "hex_magic_font.cpp"
 #include "hex_magic_render.cpp"
+#include "hex_magic_checksum.cpp"
+#include "hex_magic_asset.cpp"
+#include "hex_magic_world.cpp"
+#include "hex_magic_hash.cpp"
+#include "hex_magic_map.cpp"
+#include "hex_magic_path.cpp"
+#include "hex_magic_hpa.cpp"
+#include "hex_magic_flow.cpp"
+#include "hex_magic_range.cpp"
+#include "hex_magic_fog.cpp"
+#include "hex_magic_generate.cpp"
+#include "hex_magic_kernel.cpp"
+#include "hex_magic_influence.cpp"
+#include "hex_magic_turn.cpp"
+#include "hex_magic_battle.cpp"
+#include "hex_magic_ai.cpp"
+#include "hex_magic_journal.cpp"
+#include "hex_magic_undo.cpp"
+#include "hex_magic_fill.cpp"
+#include "hex_magic_editor.cpp"
 
-inline void InitializeArena(MemoryArena *arena, MemoryIndex size, uint8 *base)
-{
-    arena->size      = size;
-    arena->base      = base;
-    arena->used      = 0;
-    arena->tempCount = 0;
-}
-
-inline TemporaryMemory StartTemporaryMemory(MemoryArena *arena)
-{
-    TemporaryMemory result = {};
-
-    result.arena = arena;
-    result.used  = arena->used;
-
-    ++arena->tempCount;
-
-    return result;
-}
-
-inline void EndTemporaryMemory(TemporaryMemory memory)
-{
-    memory.arena->used = memory.used;
-
-    Assert(memory.arena->tempCount > 0);
-
-    --memory.arena->tempCount;
-}
+#if HEX_MAGIC_INTERNAL
+#include "hex_magic_debug.cpp"
 
-inline void CheckArena(MemoryArena *arena) { Assert(arena->tempCount == 0); }
+DebugTable *globalDebugTable;
+#endif
 
 internal void GameOutputSound(GameState *gameState, GameSoundOutputBuffer *soundBuffer, int toneHz)
 {
@@ -67,95 +64,145 @@ internal void GameOutputSound(GameState *gameState, GameSoundOutputBuffer *sound
     }
 }
 
-internal uint32 AddEntity(World *world)
+internal void DrawResource(Renderer *renderer, V2 position)
 {
-    uint32 enitityIndex = ++world->entityCount;
-    Assert(enitityIndex < ArrayCount(world->entities));
+    V2 dimensions = {1.25f, 1.25f};
+    V4 color      = {0.5f, 0.0f, 0.5f, 1.0f};
 
-    return enitityIndex;
+    RendererPushRectangle(renderer, position, dimensions, color);
 }
 
-internal Entity *GetEntity(World *world, uint32 index)
+internal void DrawCity(GameState *state, Renderer *renderer, Camera *camera, V2 position)
 {
-    Entity *hero = 0;
-
-    if (index > 0 && index < ArrayCount(world->entities))
-    {
-        hero = &world->entities[index];
-    }
-
-    return hero;
+    RendererPushBitmap(renderer, position, &state->city);
 }
 
-internal uint32 AddHero(World *world, V2 position)
+internal void DrawHero(GameState *state, Renderer *renderer, Camera *camera, V2 position)
 {
-    uint32 index   = AddEntity(world);
-    Entity *entity = GetEntity(world, index);
-
-    entity->type     = ENTITY_HERO;
-    entity->position = position;
-
-    return index;
+    RendererPushBitmap(renderer, position, &state->hero);
 }
 
-internal uint32 AddCity(World *world, V2 position)
+internal void ResetPathfinding(GameState *gameState, GameMemory *memory)
 {
-    uint32 index   = AddEntity(world);
-    Entity *entity = GetEntity(world, index);
+    World *world          = gameState->world;
+    MemoryArena *arena    = &gameState->pathArena;
+    MemoryIndex cellCount = (MemoryIndex)world->width * world->height;
 
-    entity->type     = ENTITY_CITY;
-    entity->position = position;
+    if (gameState->hpa)
+    {
+        FinishHpaBuild(gameState->hpa, memory);
+    }
 
-    return index;
-}
+    arena->used           = 0;
+    gameState->pathfinder = 0;
+    gameState->hpa        = 0;
+    gameState->flowFields = 0;
+    gameState->fog        = 0;
+    gameState->influence  = 0;
+    gameState->economy    = 0;
+    gameState->worldHash  = 0;
 
-internal uint32 AddResource(World *world, V2 position)
-{
-    uint32 index   = AddEntity(world);
-    Entity *entity = GetEntity(world, index);
+    gameState->movementRange = PushStruct(arena, MovementRange);
+    InitializeMovementRange(gameState->movementRange, arena);
 
-    entity->type     = ENTITY_RESOURCE;
-    entity->position = position;
+    if (sizeof(Pathfinder) + cellCount * (sizeof(PathNode) + sizeof(PathHeapEntry)) <= arena->size)
+    {
+        gameState->pathfinder = PushStruct(arena, Pathfinder);
+        InitializePathfinder(gameState->pathfinder, arena, cellCount);
+    }
 
-    return index;
-}
+    if (HpaGraphFitsInArena(arena, world))
+    {
+        gameState->hpa = PushStruct(arena, HpaGraph);
+        InitializeHpaGraph(gameState->hpa, arena, world, &gameState->heroCosts);
+    }
 
-internal void DrawResource(Renderer *renderer, V2 position)
-{
-    V2 dimensions = {1.25f, 1.25f};
-    V4 color      = {0.5f, 0.0f, 0.5f, 1.0f};
+    MemoryIndex flowCellCount = cellCount < FLOW_MAX_FIELD_CELL_COUNT ? cellCount : FLOW_MAX_FIELD_CELL_COUNT;
+    if (FlowFieldCacheFitsInArena(arena, flowCellCount))
+    {
+        gameState->flowFields = PushStruct(arena, FlowFieldCache);
+        InitializeFlowFieldCache(gameState->flowFields, arena, flowCellCount);
+    }
 
-    RendererPushRectangle(renderer, position, dimensions, color);
-}
+    if (FogFitsInArena(arena, world))
+    {
+        gameState->fog = PushStruct(arena, FogOfWar);
+        InitializeFog(gameState->fog, arena, world);
+    }
 
-internal void DrawCity(GameState *state, Renderer *renderer, Camera *camera, V2 position)
-{
-    RendererPushBitmap(renderer, position, &state->city);
-}
+    if (InfluenceMapFitsInArena(arena, world))
+    {
+        gameState->influence = PushStruct(arena, InfluenceMap);
+        InitializeInfluenceMap(gameState->influence, arena, world);
+    }
 
-internal void DrawHero(GameState *state, Renderer *renderer, Camera *camera, V2 position)
-{
-    RendererPushBitmap(renderer, position, &state->hero);
+    // NOTE the world only has room for so many entities, so the economy always fits.
+    uint32 entityCapacity = ArrayCount(world->entities);
+    gameState->economy    = PushStruct(arena, Economy);
+    InitializeEconomy(gameState->economy, arena, entityCapacity, entityCapacity, entityCapacity);
+    LoadEconomy(gameState->economy, world);
+
+    if (WorldHashFitsInArena(arena, world))
+    {
+        gameState->worldHash = PushStruct(arena, WorldHash);
+        InitializeWorldHash(gameState->worldHash, arena, world);
+    }
+
+    gameState->editor.hpa        = gameState->hpa;
+    gameState->editor.flowFields = gameState->flowFields;
+    gameState->editor.fog        = gameState->fog;
+    gameState->editor.influence  = gameState->influence;
+    gameState->editor.economy    = gameState->economy;
+    gameState->editor.worldHash  = gameState->worldHash;
 }
 
-internal Cell *GetCell(World *world, OffsetCoord coord)
+// NOTE everything the simulation carries from one frame to the next. What gets rebuilt from the world, like the fog or
+// the influence map, is left out, it can only ever go wrong by making the world go wrong later on.
+internal uint64 HashGameState(GameState *gameState)
 {
-    Cell *result = 0;
-
-    if (coord.x > 0 && coord.x < (int32)world->width && coord.y > 0 && coord.y < (int32)world->height)
+    World *world        = gameState->world;
+    Economy *economy    = gameState->economy;
+    WorldHash *hash     = gameState->worldHash;
+    uint32 selectedCell = world->selectedCell ? GetCellIndex(world, world->selectedCell) + 1 : 0;
+
+    HashStream stream;
+    BeginHash(&stream);
+
+    AddHash(&stream, &gameState->camera, sizeof(gameState->camera));
+    AddHash(&stream, &gameState->mode, sizeof(gameState->mode));
+
+    AddHash(&stream, &world->width, sizeof(world->width));
+    AddHash(&stream, &world->height, sizeof(world->height));
+    AddHash(&stream, &selectedCell, sizeof(selectedCell));
+    AddHash(&stream, &world->entityCount, sizeof(world->entityCount));
+    AddHash(&stream, world->entities, world->entityCount * sizeof(Entity));
+    AddHash(&stream, &world->freeEntityCount, sizeof(world->freeEntityCount));
+    AddHash(&stream, world->freeEntities, world->freeEntityCount * sizeof(uint32));
+
+    if (hash)
     {
-        result = &world->cells[coord.y * world->width + coord.x];
+        UpdateWorldHash(hash, world);
+        AddHash(&stream, &hash->cellHash, sizeof(hash->cellHash));
     }
 
+    AddHash(&stream, &economy->turnIndex, sizeof(economy->turnIndex));
+    AddHash(&stream, &economy->currentPlayer, sizeof(economy->currentPlayer));
+    AddHash(&stream, economy->isPlaying, sizeof(economy->isPlaying));
+    AddHash(&stream, economy->stockpiles, sizeof(economy->stockpiles));
+
+    uint64 result = EndHash(&stream);
     return result;
 }
 
-internal Cell *GetCell(World *world, HexCoord coord)
+internal void DrawPath(Renderer *renderer, Path *path)
 {
-    OffsetCoord offsetCoord = OffsetFromHex(coord);
-    Cell *result            = GetCell(world, offsetCoord);
+    V2 dimensions = {0.4f, 0.4f};
+    V4 color      = {1.0f, 1.0f, 1.0f, 0.8f};
 
-    return result;
+    for (uint32 cellIndex = 0; cellIndex < path->cellCount; ++cellIndex)
+    {
+        RendererPushRectangle(renderer, HexToV2(HexFromOffset(path->cells[cellIndex])), dimensions, color);
+    }
 }
 
 internal Bitmap *BiomeTexture(GameState *state, Biome biome)
@@ -227,24 +274,6 @@ internal Bitmap *BiomeTexture(GameState *state, Biome biome)
     return result;
 }
 
-inline bool32 WasPressed(GameButtonState button)
-{
-    bool32 result = button.endedDown && button.halfTransitionCount > 0;
-    return result;
-}
-
-inline bool32 WasReleased(GameButtonState button)
-{
-    bool32 result = !button.endedDown && button.halfTransitionCount > 0;
-    return result;
-}
-
-inline bool32 IsHeld(GameButtonState button)
-{
-    bool32 result = button.endedDown;
-    return result;
-}
-
 #pragma pack(push, 1)
 struct BitmapHeader
 {
@@ -329,36 +358,114 @@ internal Bitmap DEBUGLoadBMP(ThreadContext *thread, DEBUGPlatformReadEntireFile
         }
     }
 
-    result.pitch  = -result.width * BITMAP_BYTES_PER_PIXEL;
-    result.memory = (uint8 *)result.memory - result.pitch * (result.height - 1);
+    result.pitch    = -result.width * BITMAP_BYTES_PER_PIXEL;
+    result.memory   = (uint8 *)result.memory - result.pitch * (result.height - 1);
+    result.mipCount = 1;
+
+    return result;
+}
+
+internal Bitmap *GetGameBitmap(GameState *gameState, AssetId id)
+{
+    Bitmap *bitmaps[] = {
+        &gameState->city,         &gameState->hero,         &gameState->grassTexture, &gameState->dirtTexture,
+        &gameState->lavaTexture,  &gameState->roughTexture, &gameState->sandTexture,  &gameState->snowTexture,
+        &gameState->swampTexture, &gameState->waterTexture, &gameState->rockTexture,
+    };
+
+    Assert(id < ArrayCount(bitmaps));
+    Bitmap *result = bitmaps[id];
 
     return result;
 }
 
+// NOTE the pack is what a build ships with. Without one, like when the packer hasn't been run yet, everything is
+// loaded from the source files the way the packer would, only slower and without mips.
+internal void LoadGameAssets(ThreadContext *thread, GameMemory *memory, GameState *gameState)
+{
+    if (OpenAssetPack(&gameState->assetPack, thread, memory, ASSET_PACK_FILE_NAME))
+    {
+        for (uint32 assetIndex = 0; assetIndex < ASSET_FONT_ATLAS; ++assetIndex)
+        {
+            *GetGameBitmap(gameState, (AssetId)assetIndex) = GetAssetBitmap(&gameState->assetPack, (AssetId)assetIndex);
+        }
+
+        GetAssetFontAtlas(&gameState->assetPack, &gameState->fontAtlas);
+    }
+    else
+    {
+        DEBUGPlatformReadEntireFile *fileReader = memory->debugPlatformReadEntireFile;
+
+        for (uint32 assetIndex = 0; assetIndex < ASSET_FONT_ATLAS; ++assetIndex)
+        {
+            *GetGameBitmap(gameState, (AssetId)assetIndex) =
+                DEBUGLoadBMP(thread, fileReader, globalAssetFileNames[assetIndex]);
+        }
+
+        DEBUGLoadFontAtlas(thread, memory, &gameState->fontAtlas, &gameState->editorArena);
+    }
+}
+
+#if HEX_MAGIC_INTERNAL
+// NOTE undo memory is the bar in the top left corner, filled up to what can be undone and then to what can be redone.
+internal void DrawDebugOverlay(GameState *gameState, Renderer *renderer)
+{
+    UndoHistory *undo = gameState->editor.undo;
+
+    V2 barMin       = {10.0f, 10.0f};
+    V2 barDim       = {200.0f, 8.0f};
+    real32 capacity = (real32)GetUndoMemoryCap(undo);
+    real32 undoEnd  = barDim.x * (real32)((undo->top - undo->oldest) * sizeof(UndoRecord)) / capacity;
+    real32 redoEnd  = barDim.x * (real32)GetUndoMemoryUsed(undo) / capacity;
+
+    RendererPushScreenRectangle(renderer, barMin, barMin + barDim, {0.1f, 0.1f, 0.1f, 1.0f});
+    RendererPushScreenRectangle(renderer, barMin, barMin + Vector2(undoEnd, barDim.y), {0.2f, 0.8f, 0.2f, 1.0f});
+    RendererPushScreenRectangle(renderer, barMin + Vector2(undoEnd, 0.0f), barMin + Vector2(redoEnd, barDim.y),
+                                {0.9f, 0.8f, 0.2f, 1.0f});
+}
+#endif
+
 extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
 {
+#if HEX_MAGIC_INTERNAL
+    globalDebugTable = memory->debugTable;
+
+    // NOTE the profiler takes the clicks that land on it, the game gets what is left of the input.
+    BEGIN_TIMED_BLOCK(DEBUG_OVERLAY);
+    GameInput gameInput    = *input;
+    DebugState *debugState = GetDebugState(thread, memory);
+    UpdateProfiler(debugState, memory->debugTable, &gameInput);
+    input = &gameInput;
+    END_TIMED_BLOCK(DEBUG_OVERLAY);
+#endif
+
+    BEGIN_TIMED_BLOCK(GAME_UPDATE_AND_RENDER);
+
     Assert(sizeof(GameState) <= memory->permanentStorageSize);
 
     GameState *gameState = (GameState *)memory->permanentStorage;
     if (!memory->isInitialized)
     {
-        InitializeArena(&gameState->worldArena, memory->permanentStorageSize - sizeof(GameState),
-                        (uint8 *)memory->permanentStorage + sizeof(GameState));
+        // NOTE the world arena gets reset whenever a map is loaded, so anything that has to outlive the world is
+        // kept in front of it.
+        MemoryIndex editorArenaSize = Gigabytes(1);
+        MemoryIndex pathArenaSize   = Gigabytes(1);
+        uint8 *storage              = (uint8 *)memory->permanentStorage + sizeof(GameState);
 
-        DEBUGPlatformReadEntireFile *fileReader = memory->debugPlatformReadEntireFile;
+        InitializeArena(&gameState->editorArena, editorArenaSize, storage);
+        InitializeArena(&gameState->pathArena, pathArenaSize, storage + editorArenaSize);
+        InitializeArena(&gameState->worldArena,
+                        memory->permanentStorageSize - sizeof(GameState) - editorArenaSize - pathArenaSize,
+                        storage + editorArenaSize + pathArenaSize);
 
-        gameState->city = DEBUGLoadBMP(thread, fileReader, "assets/sprites/city.bmp");
-        gameState->hero = DEBUGLoadBMP(thread, fileReader, "assets/sprites/hero.bmp");
+        gameState->pathfinder = 0;
+        gameState->hpa        = 0;
+        gameState->flowFields = 0;
+        gameState->heroCosts  = MakeHeroPathCosts();
 
-        gameState->grassTexture = DEBUGLoadBMP(thread, fileReader, "assets/textures/grass.bmp");
-        gameState->dirtTexture  = DEBUGLoadBMP(thread, fileReader, "assets/textures/dirt.bmp");
-        gameState->lavaTexture  = DEBUGLoadBMP(thread, fileReader, "assets/textures/lava.bmp");
-        gameState->roughTexture = DEBUGLoadBMP(thread, fileReader, "assets/textures/rough.bmp");
-        gameState->sandTexture  = DEBUGLoadBMP(thread, fileReader, "assets/textures/sand.bmp");
-        gameState->snowTexture  = DEBUGLoadBMP(thread, fileReader, "assets/textures/snow.bmp");
-        gameState->swampTexture = DEBUGLoadBMP(thread, fileReader, "assets/textures/swamp.bmp");
-        gameState->waterTexture = DEBUGLoadBMP(thread, fileReader, "assets/textures/water.bmp");
-        gameState->rockTexture  = DEBUGLoadBMP(thread, fileReader, "assets/textures/rock.bmp");
+        gameState->movementRange = 0;
+
+        LoadGameAssets(thread, memory, gameState);
 
         gameState->camera.zoom         = 150.0f;
         gameState->camera.zoomVelocity = 0.0f;
@@ -374,34 +481,42 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
         gameState->editor              = {};
         gameState->editor.brushSize    = 0;
         gameState->editor.minBrushSize = 0;
-        gameState->editor.maxBrushSize = 5;
+        gameState->editor.maxBrushSize = 300;
+        gameState->editor.worldSeed    = 1;
 
         gameState->mode = PLAY;
 
-        gameState->world = PushStruct(&gameState->worldArena, World);
-        World *world     = gameState->world;
+#if HEX_MAGIC_INTERNAL
+        gameState->editor.journal = PushStruct(&gameState->editorArena, Journal);
+        InitializeJournal(gameState->editor.journal, memory, &gameState->editorArena, Megabytes(512), "world");
 
-        world->width        = 160;
-        world->height       = 100;
-        world->selectedCell = 0;
-        world->entityCount  = 0;
+        gameState->editor.undo = PushStruct(&gameState->editorArena, UndoHistory);
+        InitializeUndoHistory(gameState->editor.undo, &gameState->editorArena, Megabytes(64));
 
-        world->cells = PushArray(&gameState->worldArena, world->width * world->height, Cell);
+        gameState->world = LoadJournaledWorld(thread, gameState->editor.journal, &gameState->worldArena, 0);
+#endif
 
-        Cell *cell = world->cells;
-        for (int32 y = 0; y < world->height; ++y)
+        if (!gameState->world)
         {
-            for (int32 x = 0; x < world->width; ++x)
-            {
-                cell->coord    = HexFromOffset({x, y});
-                cell->biome    = WATER;
-                cell->position = HexToV2(cell->coord);
+            gameState->world = CreateWorld(&gameState->worldArena, 160, 100);
+            World *world     = gameState->world;
 
-                ++cell;
-            }
+            // NOTE the path arena gets reset once the world is there, so it doubles as scratch until then.
+            MemoryArena *scratchArena     = &gameState->pathArena;
+            TemporaryMemory scratchMemory = StartTemporaryMemory(scratchArena);
+
+            WorldGenerator *generator = PushStruct(scratchArena, WorldGenerator);
+            GenerateWorld(generator, world, memory, scratchArena, gameState->editor.worldSeed, GENERATE_MAX_JOB_COUNT);
+
+            EndTemporaryMemory(scratchMemory);
+
+#if HEX_MAGIC_INTERNAL
+            // NOTE edits made before the first snapshot only live in the log.
+            ReplayJournal(thread, memory, world, gameState->editor.journal->logFileName);
+#endif
         }
 
-        AddEntity(world);
+        ResetPathfinding(gameState, memory);
 
         memory->isInitialized = true;
     }
@@ -430,13 +545,20 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
     {
         gameState->mode     = gameState->mode == EDIT ? PLAY : EDIT;
         world->selectedCell = 0;
+
+        EditorEndBrushStroke(editor);
+        EndUndoStroke(editor->undo);
     }
 
     if (gameState->mode == EDIT)
     {
         if (WasPressed(keyboard->nextBiome))
         {
-            editor->brush = BRUSH_BIOME;
+            // NOTE every tool but the entity brush paints biomes, so they keep working with the new biome.
+            if (editor->brush == BRUSH_ENTITY)
+            {
+                editor->brush = BRUSH_BIOME;
+            }
 
             // TODO figure out this enum stuff how to loop arround to the beginning.
             if (editor->brushBiome == ROCK)
@@ -464,30 +586,126 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
             }
         }
 
+        if (WasPressed(keyboard->nextTool))
+        {
+            switch (editor->brush)
+            {
+                case BRUSH_BIOME:
+                {
+                    editor->brush = BRUSH_FLOOD_FILL;
+                }
+                break;
+
+                case BRUSH_FLOOD_FILL:
+                {
+                    editor->brush = BRUSH_RECTANGLE;
+                }
+                break;
+
+                case BRUSH_RECTANGLE:
+                {
+                    editor->brush = BRUSH_POLYGON;
+                }
+                break;
+
+                case BRUSH_POLYGON:
+                {
+                    editor->brush = BRUSH_SMOOTH;
+                }
+                break;
+
+                default:
+                {
+                    editor->brush = BRUSH_BIOME;
+                }
+                break;
+            }
+
+            editor->isDragging         = false;
+            editor->polygonVertexCount = 0;
+        }
+
         if (WasPressed(keyboard->save))
         {
-            memory->debugPlatformWriteEntireFile(thread, "world.map", gameState->worldArena.size, world);
+            RequestJournalSnapshot(editor->journal);
         }
 
         if (WasPressed(keyboard->load))
         {
-            DebugReadFileResult result = memory->debugPlatformReadEntireFile(thread, "world.map");
-            if (result.contentsSize)
+            EditorEndBrushStroke(editor);
+            FlushJournal(editor->journal, world);
+
+            // NOTE the build jobs read the world that is about to be replaced.
+            if (gameState->hpa)
+            {
+                FinishHpaBuild(gameState->hpa, memory);
+            }
+
+            World *loadedWorld = LoadJournaledWorld(thread, editor->journal, &gameState->worldArena, world);
+            if (loadedWorld)
+            {
+                ClearUndoHistory(editor->undo);
+
+                gameState->world = loadedWorld;
+                world            = loadedWorld;
+
+                ResetPathfinding(gameState, memory);
+            }
+        }
+
+        if (WasPressed(keyboard->generate))
+        {
+            EditorEndBrushStroke(editor);
+            FlushJournal(editor->journal, world);
+
+            // NOTE the build jobs read the world that is about to be replaced.
+            if (gameState->hpa)
             {
-                memcpy(world, result.contents, result.contentsSize);
+                FinishHpaBuild(gameState->hpa, memory);
+            }
+
+            MemoryArena *scratchArena     = &transientState->transientArena;
+            TemporaryMemory scratchMemory = StartTemporaryMemory(scratchArena);
+
+            WorldGenerator *generator = PushStruct(scratchArena, WorldGenerator);
+            bool32 generated =
+                GenerateWorld(generator, world, memory, scratchArena, ++editor->worldSeed, GENERATE_MAX_JOB_COUNT);
+
+            EndTemporaryMemory(scratchMemory);
+
+            // NOTE the log only holds edits, a whole new world has to go out as a snapshot.
+            if (generated)
+            {
+                ClearUndoHistory(editor->undo);
+                RequestJournalSnapshot(editor->journal);
+
+                ResetPathfinding(gameState, memory);
             }
         }
 
-        if (editor->brush == BRUSH_BIOME)
+        if (WasPressed(keyboard->undo))
         {
-            if (WasPressed(keyboard->actionUp) && editor->brushSize < editor->maxBrushSize)
+            EditorUndo(editor, world);
+        }
+
+        if (WasPressed(keyboard->redo))
+        {
+            EditorRedo(editor, world);
+        }
+
+        if (editor->brush == BRUSH_BIOME || editor->brush == BRUSH_SMOOTH)
+        {
+            // NOTE steps grow with the brush so big brushes don't take forever to get to.
+            int32 sizeStep = Max(1, (int32)editor->brushSize / 4);
+
+            if (WasPressed(keyboard->actionUp))
             {
-                editor->brushSize++;
+                editor->brushSize = Min((int32)editor->brushSize + sizeStep, (int32)editor->maxBrushSize);
             }
 
-            if (WasPressed(keyboard->actionDown) && editor->brushSize > editor->minBrushSize)
+            if (WasPressed(keyboard->actionDown))
             {
-                editor->brushSize--;
+                editor->brushSize = Max((int32)editor->brushSize - sizeStep, (int32)editor->minBrushSize);
             }
         }
     }
@@ -496,6 +714,9 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
     if (WasPressed(keyboard->cancel))
     {
         world->selectedCell = 0;
+
+        editor->isDragging         = false;
+        editor->polygonVertexCount = 0;
     }
 
     Camera *camera = &gameState->camera;
@@ -586,88 +807,273 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
         }
     }
 
+    BEGIN_TIMED_BLOCK(UPDATE_HPA);
+    if (gameState->hpa)
+    {
+        UpdateHpaGraph(gameState->hpa, world, memory);
+    }
+    END_TIMED_BLOCK(UPDATE_HPA);
+
+    // NOTE previews the route the selected hero would take to the cell under the mouse. Long routes go over the
+    // hierarchical graph whenever it is up to date with the edits.
+    BEGIN_TIMED_BLOCK(FIND_PATH);
+    Path heroPath = {};
+    if (gameState->mode == PLAY && world->selectedCell && world->selectedCell->heroIndex)
+    {
+        HexCoord heroHexPos = world->selectedCell->coord;
+        MemoryArena *arena  = &transientState->transientArena;
+
+        // NOTE while the graph is still catching up with edits the flat search stands in for it, the preview never
+        // waits on the build.
+        bool32 isLongRoute = Distance(heroHexPos, mouseHexPos) > 2 * HPA_CLUSTER_DIM;
+        if (gameState->hpa && isLongRoute && IsHpaGraphReady(gameState->hpa))
+        {
+            heroPath = FindHpaPath(gameState->hpa, world, OffsetFromHex(heroHexPos), OffsetFromHex(mouseHexPos), arena);
+        }
+        else if (gameState->pathfinder)
+        {
+            heroPath = FindPath(gameState->pathfinder, world, &gameState->heroCosts, OffsetFromHex(heroHexPos),
+                                OffsetFromHex(mouseHexPos), arena);
+        }
+    }
+    END_TIMED_BLOCK(FIND_PATH);
+
 #if HEX_MAGIC_INTERNAL
+    BEGIN_TIMED_BLOCK(UPDATE_EDITOR);
     if (gameState->mode == EDIT)
     {
-        if (IsHeld(mouse->lButton))
+        // NOTE everything changed while the button is held is undone in one go, and so is every fill.
+        BeginUndoStroke(editor->undo);
+
+        MemoryArena *fillArena     = &transientState->transientArena;
+        TemporaryMemory fillMemory = StartTemporaryMemory(fillArena);
+        Cell *cell                 = GetCell(world, OffsetFromHex(mouseHexPos));
+
+        switch (editor->brush)
         {
-            Cell *cell = GetCell(world, OffsetFromHex(mouseHexPos));
-            if (cell)
+            case BRUSH_BIOME:
             {
-                if (editor->brush == BRUSH_BIOME)
+                if (IsHeld(mouse->lButton))
                 {
-                    if (editor->brushSize > 0)
+                    if (!editor->isBrushStroking)
                     {
-                        int32 n = editor->brushSize;
-                        for (int32 q = -n; q <= n; ++q)
-                        {
-                            for (int32 r = Max(-n, -q - n); r <= Min(n, -q + n); ++r)
-                            {
-                                HexCoord coord    = cell->coord + HexCoord{q, r, -q - r};
-                                Cell *cellToPaint = GetCell(world, coord);
-
-                                if (cellToPaint)
-                                {
-                                    cellToPaint->biome = editor->brushBiome;
-                                }
-                            }
-                        }
+                        EditorBeginBrushStroke(editor, world, &gameState->editorArena, mouseHexPos);
                     }
-                    else
+
+                    EditorBrushStrokeTo(editor, world, fillArena, mouseHexPos, editor->brushBiome);
+                }
+            }
+            break;
+
+            case BRUSH_ENTITY:
+            {
+                if (cell && IsHeld(mouse->lButton))
+                {
+                    EditorPlaceEntity(editor, world, cell, editor->brushEntity);
+                }
+            }
+            break;
+
+            case BRUSH_FLOOD_FILL:
+            {
+                if (cell && WasPressed(mouse->lButton))
+                {
+                    FillSpanList spans = MakeFillSpanList(fillArena, FILL_MAX_SPAN_COUNT);
+
+                    FloodFillSpans(world, OffsetFromHex(cell->coord), &spans, fillArena);
+
+                    // NOTE a region that ran out of spans would only get part of it painted, so it isn't filled.
+                    if (!spans.overflowed)
                     {
-                        cell->biome = editor->brushBiome;
+                        EditorFillSpans(editor, world, memory, fillArena, &spans, editor->brushBiome);
                     }
                 }
+            }
+            break;
 
-                if (editor->brush == BRUSH_ENTITY)
+            case BRUSH_RECTANGLE:
+            {
+                if (cell && WasPressed(mouse->lButton))
                 {
-                    switch (editor->brushEntity)
-                    {
-                        case ENTITY_HERO:
-                        {
-                            if (!cell->heroIndex)
-                            {
-                                cell->heroIndex = AddHero(world, cell->position);
-                            }
-                        }
-                        break;
+                    editor->isDragging = true;
+                    editor->dragStart  = OffsetFromHex(cell->coord);
+                }
 
-                        case ENTITY_CITY:
-                        {
-                            if (!cell->cityIndex)
-                            {
-                                cell->cityIndex = AddCity(world, cell->position);
-                            }
-                        }
-                        break;
+                if (editor->isDragging && !IsHeld(mouse->lButton))
+                {
+                    if (cell)
+                    {
+                        OffsetCoord dragEnd = OffsetFromHex(cell->coord);
+                        FillSpanList spans  = MakeFillSpanList(fillArena, Abs(dragEnd.y - editor->dragStart.y) + 1);
 
-                        case ENTITY_RESOURCE:
-                        {
-                            if (!cell->resourceIndex)
-                            {
-                                cell->resourceIndex = AddResource(world, cell->position);
-                            }
-                        }
-                        break;
+                        RectangleFillSpans(world, editor->dragStart, dragEnd, &spans);
+                        EditorFillSpans(editor, world, memory, fillArena, &spans, editor->brushBiome);
                     }
+
+                    editor->isDragging = false;
+                }
+            }
+            break;
+
+            case BRUSH_POLYGON:
+            {
+                if (cell && WasPressed(mouse->lButton) &&
+                    editor->polygonVertexCount < ArrayCount(editor->polygonVertices))
+                {
+                    editor->polygonVertices[editor->polygonVertexCount++] = cell->position;
+                }
+
+                if (WasPressed(mouse->rButton) && editor->polygonVertexCount >= 3)
+                {
+                    FillSpanList spans = MakeFillSpanList(fillArena, world->height * editor->polygonVertexCount / 2);
+
+                    PolygonFillSpans(world, editor->polygonVertices, editor->polygonVertexCount, &spans, fillArena);
+                    EditorFillSpans(editor, world, memory, fillArena, &spans, editor->brushBiome);
+
+                    editor->polygonVertexCount = 0;
+                }
+            }
+            break;
+
+            case BRUSH_SMOOTH:
+            {
+                if (cell && WasPressed(mouse->lButton))
+                {
+                    EditorSmoothBiomes(editor, world, memory, fillArena, mouseHexPos, editor->brushSize);
                 }
             }
+            break;
+        }
+
+        EndTemporaryMemory(fillMemory);
+
+        if (!IsHeld(mouse->lButton))
+        {
+            EditorEndBrushStroke(editor);
+            EndUndoStroke(editor->undo);
         }
     }
+
+    UpdateJournal(editor->journal, world, input->dtForFrame);
+    END_TIMED_BLOCK(UPDATE_EDITOR);
 #endif
 
+    BEGIN_TIMED_BLOCK(UPDATE_FOG);
+    if (gameState->fog)
+    {
+        UpdateFog(gameState->fog, world);
+    }
+    END_TIMED_BLOCK(UPDATE_FOG);
+
+    BEGIN_TIMED_BLOCK(BUILD_INFLUENCE);
+    if (gameState->mode == PLAY && gameState->influence)
+    {
+        UpdateInfluenceMap(gameState->influence, world, &gameState->heroCosts, memory, HEX_KERNEL_MAX_JOB_COUNT);
+    }
+    END_TIMED_BLOCK(BUILD_INFLUENCE);
+
+    BEGIN_TIMED_BLOCK(UPDATE_ECONOMY);
+    if (gameState->mode == PLAY)
+    {
+        Economy *economy = gameState->economy;
+
+        if (economy->isDirty)
+        {
+            LoadEconomy(economy, world);
+        }
+
+        if (WasPressed(keyboard->endTurn))
+        {
+            EndPlayerTurn(economy, world, memory);
+        }
+    }
+    END_TIMED_BLOCK(UPDATE_ECONOMY);
+
+    // NOTE nothing after this point changes the simulation, so this is the state the frame leaves it in.
+    BEGIN_TIMED_BLOCK(HASH_STATE);
+    memory->debugStateHash = HashGameState(gameState);
+    END_TIMED_BLOCK(HASH_STATE);
+
+    // NOTE in play mode the map is hidden behind the fog of the player at the keyboard, unless they have no heroes on
+    // it yet. Cells they never explored aren't drawn at all, and explored ones their heroes can't see right now are
+    // drawn darker and without heroes on them.
+    FogOfWar *fog   = gameState->fog;
+    bool32 isFogged = gameState->mode == PLAY && fog && fog->viewerCounts[LOCAL_PLAYER];
+
+    // NOTE shows how far the hero under the mouse can go, or the selected one when the mouse isn't over a hero. The
+    // hexes pick the tint up as they are drawn. Other players' heroes only get theirs while they can be seen, or the
+    // range would give away heroes hidden in the fog.
+    BEGIN_TIMED_BLOCK(FIND_MOVEMENT_RANGE);
+    if (gameState->mode == PLAY)
+    {
+        Cell *rangeCell = GetCell(world, OffsetFromHex(mouseHexPos));
+        if (!rangeCell || !rangeCell->heroIndex)
+        {
+            rangeCell = world->selectedCell;
+        }
+
+        Entity *hero = rangeCell ? GetEntity(world, rangeCell->heroIndex) : 0;
+        if (hero && isFogged && hero->player != LOCAL_PLAYER &&
+            !IsFogVisible(fog, LOCAL_PLAYER, OffsetFromHex(rangeCell->coord)))
+        {
+            hero = 0;
+        }
+
+        if (hero)
+        {
+            MovementRange *range = gameState->movementRange;
+
+            FindMovementRange(range, world, &gameState->heroCosts, rangeCell->coord, hero->movePoints);
+            RendererPushHexMask(renderer, &range->mask, {0.3f, 0.6f, 1.0f, 0.3f});
+        }
+    }
+    END_TIMED_BLOCK(FIND_MOVEMENT_RANGE);
+
     V4 white           = {1.0f, 1.0f, 1.0f, 1.0f};
     real32 innerRadius = Sqrt(3) / 2.0f;
     // TODO better calculation for xSpan and ySpan
     int32 xSpan = CeilReal32ToInt32(buffer->width / (4 * innerRadius * camera->zoom)) + 2;
     int32 ySpan = buffer->height / 3;
+
+    BEGIN_TIMED_BLOCK(DRAW_WORLD);
     for (int32 relY = -ySpan; relY < ySpan; ++relY)
     {
+        int32 fogChunkX    = -1;
+        uint64 exploredRow = 0;
+        uint64 visibleRow  = 0;
+
         for (int32 relX = -xSpan; relX < xSpan; ++relX)
         {
             int32 x = cameraOffset.x + relX;
             int32 y = cameraOffset.y + relY;
 
+            bool32 isVisible = true;
+            if (isFogged && x >= 0 && x < fog->width && y >= 0 && y < fog->height)
+            {
+                if ((x >> WORLD_CHUNK_SHIFT) != fogChunkX)
+                {
+                    fogChunkX   = x >> WORLD_CHUNK_SHIFT;
+                    exploredRow = GetFogExploredRow(fog, LOCAL_PLAYER, x, y);
+                    visibleRow  = GetFogVisibleRow(fog, LOCAL_PLAYER, x, y);
+                }
+
+                uint32 bit = x & WORLD_CHUNK_MASK;
+
+                // NOTE nothing explored in the rest of this row of the chunk, so it is skipped in one go.
+                if (!(exploredRow >> bit))
+                {
+                    relX += WORLD_CHUNK_MASK - bit;
+                    continue;
+                }
+
+                if (!((exploredRow >> bit) & 1))
+                {
+                    continue;
+                }
+
+                isVisible = (visibleRow >> bit) & 1;
+            }
+
             Cell *cell      = GetCell(gameState->world, OffsetCoord{x, y});
             Bitmap *texture = &gameState->waterTexture;
             V4 color        = {1.0, 1.0, 1.0, 0.0};
@@ -677,11 +1083,22 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
                 bool32 isHovering = mouseHexPos == cell->coord;
 
 #if HEX_MAGIC_INTERNAL
-                if (gameState->mode == EDIT && editor->brush == BRUSH_BIOME &&
+                if (gameState->mode == EDIT && (editor->brush == BRUSH_BIOME || editor->brush == BRUSH_SMOOTH) &&
                     Distance(cell->coord, mouseHexPos) <= editor->brushSize)
                 {
                     isHovering = true;
                 }
+
+                if (gameState->mode == EDIT && editor->brush == BRUSH_RECTANGLE && editor->isDragging)
+                {
+                    OffsetCoord dragEnd = OffsetFromHex(mouseHexPos);
+
+                    if (x >= Min(editor->dragStart.x, dragEnd.x) && x <= Max(editor->dragStart.x, dragEnd.x) &&
+                        y >= Min(editor->dragStart.y, dragEnd.y) && y <= Max(editor->dragStart.y, dragEnd.y))
+                    {
+                        isHovering = true;
+                    }
+                }
 #endif
 
                 texture = BiomeTexture(gameState, cell->biome);
@@ -693,13 +1110,17 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
                 else if (isHovering)
                 {
 #if HEX_MAGIC_INTERNAL
-                    if (gameState->mode == EDIT && editor->brush == BRUSH_BIOME)
+                    if (gameState->mode == EDIT && editor->brush != BRUSH_ENTITY && editor->brush != BRUSH_SMOOTH)
                     {
                         texture = BiomeTexture(gameState, editor->brushBiome);
                     }
 #endif
                     color.a = 0.1;
                 }
+                else if (!isVisible)
+                {
+                    color = {0.0f, 0.0f, 0.0f, 0.5f};
+                }
 
                 RendererPushHex(renderer, cell->position, color, texture);
 
@@ -713,7 +1134,7 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
                     DrawCity(gameState, renderer, camera, cell->position);
                 }
 
-                if (cell->heroIndex)
+                if (cell->heroIndex && isVisible)
                 {
                     DrawHero(gameState, renderer, camera, cell->position);
                 }
@@ -747,12 +1168,40 @@ extern "C" GAME_UPDATE_AND_RENDER(gameUpdateAndRender)
         }
     }
 
+    END_TIMED_BLOCK(DRAW_WORLD);
+
+    DrawPath(renderer, &heroPath);
+
+#if HEX_MAGIC_INTERNAL
+    if (gameState->mode == EDIT)
+    {
+        for (uint32 vertexIndex = 0; vertexIndex < editor->polygonVertexCount; ++vertexIndex)
+        {
+            RendererPushRectangle(renderer, editor->polygonVertices[vertexIndex], V2{0.3f, 0.3f},
+                                  V4{1.0f, 1.0f, 0.0f, 1.0f});
+        }
+
+        DrawDebugOverlay(gameState, renderer);
+    }
+#endif
+
+    BEGIN_TIMED_BLOCK(RENDER_TO_OUTPUT);
     RenderToOutput(buffer, renderer);
+    END_TIMED_BLOCK(RENDER_TO_OUTPUT);
 
     EndTemporaryMemory(renderMemory);
 
+    CheckArena(&gameState->editorArena);
     CheckArena(&gameState->worldArena);
     CheckArena(&transientState->transientArena);
+
+    END_TIMED_BLOCK(GAME_UPDATE_AND_RENDER);
+
+#if HEX_MAGIC_INTERNAL
+    BEGIN_TIMED_BLOCK(DEBUG_OVERLAY);
+    DrawProfiler(debugState, memory->debugTable, &gameState->fontAtlas, buffer);
+    END_TIMED_BLOCK(DEBUG_OVERLAY);
+#endif
 }
 
 extern "C" GAME_GET_SOUND_SAMPLES(gameGetSoundSamples)
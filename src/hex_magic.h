@@ -4,9 +4,14 @@
 #include "hex_magic_math.h"
 #include "hex_magic_intrinsics.h"
 #include "hex_magic_hex.h"
+#include "hex_magic_map.h"
 
 #define BITMAP_BYTES_PER_PIXEL 4
 
+#define WORLD_CHUNK_SHIFT 6
+#define WORLD_CHUNK_DIM (1 << WORLD_CHUNK_SHIFT)
+#define WORLD_CHUNK_MASK (WORLD_CHUNK_DIM - 1)
+
 struct MemoryArena
 {
     MemoryIndex size;
@@ -36,6 +41,67 @@ inline void *PushSize_(MemoryArena *arena, MemoryIndex size)
     return result;
 }
 
+inline void InitializeArena(MemoryArena *arena, MemoryIndex size, uint8 *base)
+{
+    arena->size      = size;
+    arena->base      = base;
+    arena->used      = 0;
+    arena->tempCount = 0;
+}
+
+inline void SubArena(MemoryArena *result, MemoryArena *arena, MemoryIndex size)
+{
+    result->size      = size;
+    result->base      = (uint8 *)PushSize(arena, size);
+    result->used      = 0;
+    result->tempCount = 0;
+}
+
+inline TemporaryMemory StartTemporaryMemory(MemoryArena *arena)
+{
+    TemporaryMemory result = {};
+
+    result.arena = arena;
+    result.used  = arena->used;
+
+    ++arena->tempCount;
+
+    return result;
+}
+
+inline void EndTemporaryMemory(TemporaryMemory memory)
+{
+    memory.arena->used = memory.used;
+
+    Assert(memory.arena->tempCount > 0);
+
+    --memory.arena->tempCount;
+}
+
+inline void CheckArena(MemoryArena *arena) { Assert(arena->tempCount == 0); }
+
+inline bool32 WasPressed(GameButtonState button)
+{
+    bool32 result = button.endedDown && button.halfTransitionCount > 0;
+    return result;
+}
+
+inline bool32 WasReleased(GameButtonState button)
+{
+    bool32 result = !button.endedDown && button.halfTransitionCount > 0;
+    return result;
+}
+
+inline bool32 IsHeld(GameButtonState button)
+{
+    bool32 result = button.endedDown;
+    return result;
+}
+
+#include "hex_magic_journal.h"
+#include "hex_magic_undo.h"
+#include "hex_magic_fill.h"
+
 enum Biome
 {
     WATER,
@@ -46,7 +112,9 @@ enum Biome
     SAND,
     SNOW,
     SWAMP,
-    ROCK
+    ROCK,
+
+    BIOME_COUNT
 };
 
 struct Cell
@@ -68,10 +136,53 @@ enum EntityType
     ENTITY_CITY,
 };
 
+// NOTE thirty moves over grass.
+#define HERO_MOVE_POINTS 60
+#define HERO_VISION_RADIUS 6
+
+#define MAX_PLAYER_COUNT 8
+
+// NOTE the player sitting at this machine.
+#define LOCAL_PLAYER 0
+
 struct Entity
 {
     V2 position;
     EntityType type;
+
+    // NOTE only heroes move.
+    uint32 movePoints;
+
+    // NOTE which player the entity belongs to, and whose fog its vision lifts.
+    uint32 player;
+};
+
+enum WorldChunkState
+{
+    WORLD_CHUNK_RESIDENT = 0x1,
+    WORLD_CHUNK_DIRTY    = 0x2,
+};
+
+// NOTE backs a world with a mapped map file. Cells of a chunk are only initialised from the mapping the first time
+// they are touched, and painted chunks are queued on the dirty list until they get written back through the chunk
+// log, see StageWorldPager.
+struct WorldPager
+{
+    DebugMappedFile file;
+    MapChunkedView view;
+    char chunkLogFileName[MAP_FILE_NAME_LENGTH];
+
+    // NOTE where the cell bands come from, a band is only pushed once a chunk in it is paged in.
+    MemoryArena *cellArena;
+
+    int32 chunkCountX;
+    int32 chunkCountY;
+
+    uint8 *chunkStates;
+    uint32 residentChunkCount;
+
+    uint32 dirtyChunkCount;
+    uint32 *dirtyChunks;
 };
 
 struct World
@@ -79,13 +190,35 @@ struct World
     int32 width;
     int32 height;
 
+    // NOTE dense worlds keep every cell in one block. Paged worlds have no block, their rows come in bands of
+    // WORLD_CHUNK_DIM that are 0 until something in them is touched, see GetCellRow.
     Cell *cells;
+    Cell **cellBands;
     Cell *selectedCell;
 
+    WorldPager *pager;
+
     uint32 entityCount;
     Entity entities[256];
+
+    // NOTE slots below entityCount whose entities were removed, see RemoveEntity.
+    uint32 freeEntityCount;
+    uint32 freeEntities[256];
 };
 
+#include "hex_magic_hash.h"
+#include "hex_magic_path.h"
+#include "hex_magic_hpa.h"
+#include "hex_magic_flow.h"
+#include "hex_magic_range.h"
+#include "hex_magic_fog.h"
+#include "hex_magic_generate.h"
+#include "hex_magic_kernel.h"
+#include "hex_magic_influence.h"
+#include "hex_magic_turn.h"
+#include "hex_magic_battle.h"
+#include "hex_magic_ai.h"
+
 struct Camera
 {
     V2 position;
@@ -111,8 +244,14 @@ enum BrushType
 {
     BRUSH_BIOME,
     BRUSH_ENTITY,
+    BRUSH_FLOOD_FILL,
+    BRUSH_RECTANGLE,
+    BRUSH_POLYGON,
+    BRUSH_SMOOTH,
 };
 
+#define EDITOR_MAX_POLYGON_VERTEX_COUNT 64
+
 struct Editor
 {
     BrushType brush;
@@ -123,6 +262,39 @@ struct Editor
     uint32 maxBrushSize;
 
     EntityType brushEntity;
+
+    // NOTE brush strokes fill in the cells between where the mouse was on consecutive frames. The mask has a bit per
+    // cell that is set once the stroke has painted it, and only the range of cells the stroke touched gets cleared.
+    bool32 isBrushStroking;
+    HexCoord lastBrushHex;
+    uint64 *strokeMask;
+    MemoryIndex strokeMaskCellCount;
+    MemoryIndex strokeMinCellIndex;
+    MemoryIndex strokeMaxCellIndex;
+
+    // NOTE kept after the stroke ends, so they describe the last stroke until the next one starts.
+    uint32 strokeCellCount;
+    uint64 strokeCycles;
+
+    bool32 isDragging;
+    OffsetCoord dragStart;
+
+    uint32 polygonVertexCount;
+    V2 polygonVertices[EDITOR_MAX_POLYGON_VERTEX_COUNT];
+
+    // NOTE seed of the last generated world, generating again moves on to the next one.
+    uint32 worldSeed;
+
+    Journal *journal;
+    UndoHistory *undo;
+
+    // NOTE 0 when the world is too big for them, otherwise every edit marks what it touches dirty.
+    HpaGraph *hpa;
+    FlowFieldCache *flowFields;
+    FogOfWar *fog;
+    InfluenceMap *influence;
+    Economy *economy;
+    WorldHash *worldHash;
 };
 
 struct Bitmap
@@ -131,13 +303,34 @@ struct Bitmap
     int32 height;
     int32 pitch;
     void *memory;
+
+    // NOTE bitmaps from the asset pack have smaller copies of themselves right after them, see GetBitmapMip.
+    uint32 mipCount;
 };
 
+#include "hex_magic_font.h"
+#include "hex_magic_asset.h"
+
 struct GameState
 {
+    MemoryArena editorArena;
+
     MemoryArena worldArena;
     World *world;
 
+    // NOTE the pathfinder, the hierarchical graph, the flow fields, the fog and the influence map are sized to the
+    // world, and get rebuilt in their arena whenever a world is loaded. Each is 0 when the world is too big for it.
+    MemoryArena pathArena;
+    Pathfinder *pathfinder;
+    HpaGraph *hpa;
+    FlowFieldCache *flowFields;
+    FogOfWar *fog;
+    InfluenceMap *influence;
+    Economy *economy;
+    WorldHash *worldHash;
+    MovementRange *movementRange;
+    PathCostTable heroCosts;
+
     Camera camera;
 
     GameMode mode;
@@ -155,6 +348,11 @@ struct GameState
     Bitmap swampTexture;
     Bitmap waterTexture;
     Bitmap rockTexture;
+
+    FontAtlas fontAtlas;
+
+    // NOTE stays mapped for as long as the game runs, the bitmaps point into it.
+    AssetPack assetPack;
 };
 
 struct TransientState
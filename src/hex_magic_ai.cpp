@@ -0,0 +1,794 @@
+#include "hex_magic.h"
+#include "hex_magic_ai.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_influence.h"
+#include "hex_magic_path.h"
+#include "hex_magic_platform.h"
+#include "hex_magic_range.h"
+#include "hex_magic_turn.h"
+
+internal void InitializeAiPlanner(AiPlanner *planner, MemoryArena *arena, int32 width, int32 height,
+                                  uint32 heroCapacity, uint32 cityCapacity, uint32 targetCapacity)
+{
+    AiSnapshot *snapshot  = &planner->snapshot;
+    MemoryIndex cellCount = (MemoryIndex)width * height;
+
+    snapshot->width     = width;
+    snapshot->height    = height;
+    snapshot->cellCosts = PushArray(arena, cellCount, uint8);
+    snapshot->territory = PushArray(arena, cellCount, uint8);
+
+    AiHeroes *heroes      = &snapshot->heroes;
+    heroes->capacity      = heroCapacity;
+    heroes->entityIndices = PushArray(arena, heroCapacity, uint32);
+    heroes->hexes         = PushArray(arena, heroCapacity, HexCoord);
+    heroes->movePoints    = PushArray(arena, heroCapacity, uint32);
+    heroes->owners        = PushArray(arena, heroCapacity, uint8);
+
+    AiCities *cities      = &snapshot->cities;
+    cities->capacity      = cityCapacity;
+    cities->entityIndices = PushArray(arena, cityCapacity, uint32);
+    cities->hexes         = PushArray(arena, cityCapacity, HexCoord);
+    cities->populations   = PushArray(arena, cityCapacity, Fixed);
+    cities->capacities    = PushArray(arena, cityCapacity, Fixed);
+    cities->owners        = PushArray(arena, cityCapacity, uint8);
+
+    AiTargets *targets     = &snapshot->targets;
+    targets->capacity      = targetCapacity;
+    targets->bucketCountX  = (width + (1 << AI_TARGET_BUCKET_SHIFT) - 1) >> AI_TARGET_BUCKET_SHIFT;
+    targets->bucketCountY  = (height + (1 << AI_TARGET_BUCKET_SHIFT) - 1) >> AI_TARGET_BUCKET_SHIFT;
+    targets->entityIndices = PushArray(arena, targetCapacity, uint32);
+    targets->hexes         = PushArray(arena, targetCapacity, HexCoord);
+    targets->values        = PushArray(arena, targetCapacity, uint16);
+    targets->owners        = PushArray(arena, targetCapacity, uint8);
+    targets->firstInBucket = PushArray(arena, (targets->bucketCountX * targets->bucketCountY + 1), uint32);
+
+    for (uint32 jobIndex = 0; jobIndex < AI_MAX_JOB_COUNT; ++jobIndex)
+    {
+        AiJob *job   = planner->jobs + jobIndex;
+        job->planner = planner;
+
+        SubArena(&job->scratch, arena, AI_JOB_SCRATCH_SIZE);
+        InitializeMovementRange(&job->range, &job->scratch);
+
+        job->scratchStart = job->scratch.used;
+    }
+
+    // NOTE room for every candidate of every hero twice over, since they are sorted through a second buffer, and a flag
+    // per hero.
+    MemoryIndex candidateCount = (MemoryIndex)heroCapacity * AI_MAX_CANDIDATE_COUNT;
+    MemoryIndex mergeSize      = 2 * candidateCount * sizeof(AiMergeEntry) + heroCapacity;
+    SubArena(&planner->mergeArena, arena, mergeSize);
+
+    planner->claimStamps = PushArray(arena, targetCapacity, uint32);
+    planner->claimStamp  = 0;
+
+    memset(planner->claimStamps, 0, targetCapacity * sizeof(uint32));
+
+    planner->orderCapacity = heroCapacity + cityCapacity;
+    planner->orders        = PushArray(arena, planner->orderCapacity, AiOrder);
+    planner->orderCount    = 0;
+}
+
+internal void ClearAiSnapshot(AiSnapshot *snapshot)
+{
+    snapshot->hasTerritory  = false;
+    snapshot->heroes.count  = 0;
+    snapshot->cities.count  = 0;
+    snapshot->targets.count = 0;
+    snapshot->minimumCost   = 0xFF;
+
+    memset(snapshot->stockpiles, 0, sizeof(snapshot->stockpiles));
+}
+
+// NOTE the first row and column aren't part of the world as far as GetCell is concerned, so nobody can enter them.
+internal void LoadAiSnapshotCells(AiSnapshot *snapshot, World *world, PathCostTable *costs)
+{
+    Assert(snapshot->width == world->width && snapshot->height == world->height);
+
+    memset(snapshot->cellCosts, 0, snapshot->width);
+
+    for (int32 y = 1; y < world->height; ++y)
+    {
+        uint8 *cellCost = snapshot->cellCosts + (MemoryIndex)y * snapshot->width;
+        Cell *cell      = GetCellSpan(world, y, 1, world->width - 1, false);
+
+        *cellCost++ = 0;
+
+        for (int32 x = 1; x < world->width; ++x)
+        {
+            *cellCost++ = costs->costs[(cell++)->biome];
+        }
+    }
+
+    snapshot->minimumCost = GetMinimumPathCost(costs);
+}
+
+internal void LoadAiSnapshotTerritory(AiSnapshot *snapshot, InfluenceMap *map)
+{
+    Assert(snapshot->width == map->width && snapshot->height == map->height);
+
+    memcpy(snapshot->territory, map->owners, (MemoryIndex)snapshot->width * snapshot->height);
+    snapshot->hasTerritory = true;
+}
+
+internal void AddAiHero(AiSnapshot *snapshot, uint32 entityIndex, HexCoord hex, uint32 owner, uint32 movePoints)
+{
+    AiHeroes *heroes = &snapshot->heroes;
+    Assert(heroes->count < heroes->capacity && owner < MAX_PLAYER_COUNT);
+
+    uint32 index = heroes->count++;
+
+    heroes->entityIndices[index] = entityIndex;
+    heroes->hexes[index]         = hex;
+    heroes->movePoints[index]    = movePoints;
+    heroes->owners[index]        = (uint8)owner;
+}
+
+internal void AddAiCity(AiSnapshot *snapshot, uint32 entityIndex, HexCoord hex, uint32 owner, Fixed population,
+                        Fixed capacity)
+{
+    AiCities *cities = &snapshot->cities;
+    Assert(cities->count < cities->capacity);
+
+    uint32 index = cities->count++;
+
+    cities->entityIndices[index] = entityIndex;
+    cities->hexes[index]         = hex;
+    cities->populations[index]   = population;
+    cities->capacities[index]    = capacity;
+    cities->owners[index]        = owner < MAX_PLAYER_COUNT ? (uint8)owner : TURN_NO_OWNER;
+}
+
+internal void AddAiTarget(AiSnapshot *snapshot, uint32 entityIndex, HexCoord hex, uint32 owner, uint32 value)
+{
+    AiTargets *targets = &snapshot->targets;
+    Assert(targets->count < targets->capacity && value <= 0xFFFF);
+
+    uint32 index = targets->count++;
+
+    targets->entityIndices[index] = entityIndex;
+    targets->hexes[index]         = hex;
+    targets->values[index]        = (uint16)value;
+    targets->owners[index]        = owner < MAX_PLAYER_COUNT ? (uint8)owner : TURN_NO_OWNER;
+}
+
+internal uint32 GetAiResourceValue(ResourceKind kind)
+{
+    uint32 result = 0;
+
+    switch (kind)
+    {
+        case RESOURCE_GOLD:
+        {
+            result = 30;
+        }
+        break;
+
+        case RESOURCE_CRYSTAL:
+        {
+            result = 20;
+        }
+        break;
+
+        case RESOURCE_WOOD:
+        case RESOURCE_ORE:
+        {
+            result = 12;
+        }
+        break;
+
+        default:
+        {
+            InvalidCodePath;
+        }
+        break;
+    }
+
+    return result;
+}
+
+// NOTE a city is worth more the more people it has, a point for every hundred of them, but only as much as the chance
+// a hero has of taking it. The battle is seeded with the city, so the same city always comes out the same.
+internal uint32 GetAiCityValue(uint32 entityIndex, Fixed population)
+{
+    int64 people = RoundFixedToInt64(population);
+    people       = people < 100 * 1000 ? people : 100 * 1000;
+
+    Battle battle                 = {};
+    battle.sides[BATTLE_ATTACKER] = MakeHeroBattleSide();
+    battle.sides[BATTLE_DEFENDER] = MakeCityBattleSide((uint32)people);
+
+    BattleEstimate estimate = EstimateBattle(&battle, entityIndex, AI_BATTLE_COUNT);
+
+    uint32 value  = AI_CITY_VALUE + (uint32)(people / 100);
+    uint32 result = value * estimate.attackerWinCount / AI_BATTLE_COUNT;
+
+    return result;
+}
+
+// NOTE stable counting sort, leaves where every key starts in firstOfKey and which entry goes where in order.
+internal void SortAiEntries(uint32 *keys, uint32 count, uint32 keyCount, uint32 *firstOfKey, uint32 *order,
+                            MemoryArena *arena)
+{
+    TemporaryMemory temp = StartTemporaryMemory(arena);
+    uint32 *cursors      = PushArray(arena, keyCount, uint32);
+
+    memset(firstOfKey, 0, (keyCount + 1) * sizeof(uint32));
+
+    for (uint32 index = 0; index < count; ++index)
+    {
+        ++firstOfKey[keys[index] + 1];
+    }
+
+    for (uint32 key = 0; key < keyCount; ++key)
+    {
+        firstOfKey[key + 1] += firstOfKey[key];
+        cursors[key] = firstOfKey[key];
+    }
+
+    for (uint32 index = 0; index < count; ++index)
+    {
+        order[cursors[keys[index]]++] = index;
+    }
+
+    EndTemporaryMemory(temp);
+}
+
+internal void GatherAiArray(void *array, uint32 *order, uint32 count, MemoryIndex size, MemoryArena *arena)
+{
+    TemporaryMemory temp = StartTemporaryMemory(arena);
+    uint8 *source        = (uint8 *)PushSize(arena, count * size);
+    uint8 *dest          = (uint8 *)array;
+
+    memcpy(source, array, count * size);
+
+    for (uint32 index = 0; index < count; ++index)
+    {
+        memcpy(dest + index * size, source + order[index] * size, size);
+    }
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE puts heroes and cities in order of their owners and targets in order of their buckets, keeping the order they
+// were added in otherwise. Has to be called once everything is added and before planning.
+internal void FinishAiSnapshot(AiSnapshot *snapshot, MemoryArena *arena)
+{
+    AiHeroes *heroes   = &snapshot->heroes;
+    AiCities *cities   = &snapshot->cities;
+    AiTargets *targets = &snapshot->targets;
+
+    TemporaryMemory temp = StartTemporaryMemory(arena);
+
+    uint32 maxCount = heroes->count > cities->count ? heroes->count : cities->count;
+    maxCount        = maxCount > targets->count ? maxCount : targets->count;
+    uint32 *keys    = PushArray(arena, maxCount, uint32);
+    uint32 *order   = PushArray(arena, maxCount, uint32);
+
+    for (uint32 index = 0; index < heroes->count; ++index)
+    {
+        keys[index] = heroes->owners[index];
+    }
+
+    SortAiEntries(keys, heroes->count, MAX_PLAYER_COUNT, heroes->firstOfPlayer, order, arena);
+    GatherAiArray(heroes->entityIndices, order, heroes->count, sizeof(uint32), arena);
+    GatherAiArray(heroes->hexes, order, heroes->count, sizeof(HexCoord), arena);
+    GatherAiArray(heroes->movePoints, order, heroes->count, sizeof(uint32), arena);
+    GatherAiArray(heroes->owners, order, heroes->count, sizeof(uint8), arena);
+
+    for (uint32 index = 0; index < cities->count; ++index)
+    {
+        keys[index] = cities->owners[index] < MAX_PLAYER_COUNT ? cities->owners[index] : MAX_PLAYER_COUNT;
+    }
+
+    SortAiEntries(keys, cities->count, MAX_PLAYER_COUNT + 1, cities->firstOfPlayer, order, arena);
+    GatherAiArray(cities->entityIndices, order, cities->count, sizeof(uint32), arena);
+    GatherAiArray(cities->hexes, order, cities->count, sizeof(HexCoord), arena);
+    GatherAiArray(cities->populations, order, cities->count, sizeof(Fixed), arena);
+    GatherAiArray(cities->capacities, order, cities->count, sizeof(Fixed), arena);
+    GatherAiArray(cities->owners, order, cities->count, sizeof(uint8), arena);
+
+    for (uint32 index = 0; index < targets->count; ++index)
+    {
+        OffsetCoord offset = OffsetFromHex(targets->hexes[index]);
+        Assert(offset.x >= 0 && offset.x < snapshot->width && offset.y >= 0 && offset.y < snapshot->height);
+
+        int32 bucketX = offset.x >> AI_TARGET_BUCKET_SHIFT;
+        int32 bucketY = offset.y >> AI_TARGET_BUCKET_SHIFT;
+        keys[index]   = bucketY * targets->bucketCountX + bucketX;
+    }
+
+    SortAiEntries(keys, targets->count, targets->bucketCountX * targets->bucketCountY, targets->firstInBucket, order,
+                  arena);
+    GatherAiArray(targets->entityIndices, order, targets->count, sizeof(uint32), arena);
+    GatherAiArray(targets->hexes, order, targets->count, sizeof(HexCoord), arena);
+    GatherAiArray(targets->values, order, targets->count, sizeof(uint16), arena);
+    GatherAiArray(targets->owners, order, targets->count, sizeof(uint8), arena);
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE takes heroes, cities and resources from the economy rather than the world, so their move points, people and
+// what they produce are the ones of the turn being played. The territory is the one of the last influence map that was
+// finished, while the next one is still being built it can be a little behind the world.
+internal void LoadAiSnapshot(AiSnapshot *snapshot, World *world, Economy *economy, PathCostTable *costs,
+                             InfluenceMap *influence, MemoryArena *arena)
+{
+    ClearAiSnapshot(snapshot);
+    LoadAiSnapshotCells(snapshot, world, costs);
+
+    if (influence && influence->hasOwners)
+    {
+        LoadAiSnapshotTerritory(snapshot, influence);
+    }
+
+    EconomyHeroes *heroes = &economy->heroes;
+    for (uint32 index = 0; index < heroes->count; ++index)
+    {
+        Cell *cell = GetEntityCell(world, heroes->entityIndices[index]);
+        if (cell)
+        {
+            AddAiHero(snapshot, heroes->entityIndices[index], cell->coord, heroes->owners[index],
+                      heroes->movePoints[index]);
+        }
+    }
+
+    // NOTE cities are places heroes go to as well as places that build.
+    EconomyCities *cities = &economy->cities;
+    for (uint32 index = 0; index < cities->count; ++index)
+    {
+        Cell *cell = GetEntityCell(world, cities->entityIndices[index]);
+        if (cell)
+        {
+            uint32 owner     = cities->buckets[index] / RESOURCE_KIND_COUNT;
+            Fixed population = cities->populations[index];
+            Fixed capacity   = cities->capacities[index];
+
+            AddAiCity(snapshot, cities->entityIndices[index], cell->coord, owner, population, capacity);
+            AddAiTarget(snapshot, cities->entityIndices[index], cell->coord, owner,
+                        GetAiCityValue(cities->entityIndices[index], population));
+        }
+    }
+
+    EconomyResources *resources = &economy->resources;
+    for (uint32 index = 0; index < resources->count; ++index)
+    {
+        Cell *cell = GetEntityCell(world, resources->entityIndices[index]);
+        if (cell)
+        {
+            uint32 owner      = resources->buckets[index] / RESOURCE_KIND_COUNT;
+            ResourceKind kind = (ResourceKind)(resources->buckets[index] % RESOURCE_KIND_COUNT);
+
+            AddAiTarget(snapshot, resources->entityIndices[index], cell->coord, owner, GetAiResourceValue(kind));
+        }
+    }
+
+    memcpy(snapshot->stockpiles, economy->stockpiles, sizeof(snapshot->stockpiles));
+
+    FinishAiSnapshot(snapshot, arena);
+}
+
+// NOTE taking something away from another player is worth half as much again, and going deep into what they hold
+// costs a quarter of what it is worth.
+internal int32 ScoreAiTarget(AiSnapshot *snapshot, uint32 player, uint32 target, uint32 cost)
+{
+    AiTargets *targets = &snapshot->targets;
+
+    int32 value  = targets->values[target];
+    uint32 owner = targets->owners[target];
+
+    if (owner != TURN_NO_OWNER)
+    {
+        value += value / 2;
+    }
+
+    if (snapshot->hasTerritory)
+    {
+        OffsetCoord offset = OffsetFromHex(targets->hexes[target]);
+        uint32 holder      = snapshot->territory[(MemoryIndex)offset.y * snapshot->width + offset.x];
+
+        if (holder == player)
+        {
+            value += value / 4;
+        }
+        else if (holder != TURN_NO_OWNER)
+        {
+            value -= value / 4;
+        }
+    }
+
+    int32 result = value * AI_SCORE_SCALE / (int32)(cost + HERO_MOVE_POINTS);
+    return result;
+}
+
+inline bool32 IsBetterAiCandidate(int32 score, uint32 target, AiCandidate *other)
+{
+    bool32 result = score > other->score || (score == other->score && target < other->target);
+    return result;
+}
+
+// NOTE keeps the best AI_MAX_CANDIDATE_COUNT, best first, and ties go to the target that comes first.
+internal uint32 InsertAiCandidate(AiCandidate *candidates, uint32 count, uint32 target, uint32 cost, int32 score)
+{
+    uint32 slot = count;
+    while (slot > 0 && IsBetterAiCandidate(score, target, candidates + slot - 1))
+    {
+        --slot;
+    }
+
+    if (slot < AI_MAX_CANDIDATE_COUNT)
+    {
+        uint32 last = count < AI_MAX_CANDIDATE_COUNT ? count : AI_MAX_CANDIDATE_COUNT - 1;
+        for (uint32 index = last; index > slot; --index)
+        {
+            candidates[index] = candidates[index - 1];
+        }
+
+        candidates[slot].target = target;
+        candidates[slot].cost   = cost;
+        candidates[slot].score  = score;
+
+        count = count < AI_MAX_CANDIDATE_COUNT ? count + 1 : count;
+    }
+
+    return count;
+}
+
+// NOTE goes over the targets of every bucket the range overlaps. Heroes searched properly only see targets they can
+// walk to, the ones past the budget see every target within their radius as if the way there was all the cheapest
+// biome.
+internal uint32 FindAiCandidates(AiSnapshot *snapshot, MovementRange *range, uint32 player, HexCoord origin,
+                                 uint32 radius, bool32 isEstimate, AiCandidate *candidates)
+{
+    AiTargets *targets = &snapshot->targets;
+    OffsetCoord offset = OffsetFromHex(origin);
+
+    int32 minBucketX = Max(offset.x - (int32)radius - 1, 0) >> AI_TARGET_BUCKET_SHIFT;
+    int32 minBucketY = Max(offset.y - (int32)radius, 0) >> AI_TARGET_BUCKET_SHIFT;
+    int32 maxBucketX = Min(offset.x + (int32)radius + 1, snapshot->width - 1) >> AI_TARGET_BUCKET_SHIFT;
+    int32 maxBucketY = Min(offset.y + (int32)radius, snapshot->height - 1) >> AI_TARGET_BUCKET_SHIFT;
+
+    uint32 result = 0;
+
+    for (int32 bucketY = minBucketY; bucketY <= maxBucketY; ++bucketY)
+    {
+        for (int32 bucketX = minBucketX; bucketX <= maxBucketX; ++bucketX)
+        {
+            uint32 bucket = bucketY * targets->bucketCountX + bucketX;
+
+            for (uint32 target = targets->firstInBucket[bucket]; target < targets->firstInBucket[bucket + 1]; ++target)
+            {
+                if (targets->owners[target] == player)
+                {
+                    continue;
+                }
+
+                HexCoord hex    = targets->hexes[target];
+                uint32 distance = Distance(origin, hex);
+                uint32 cost     = 0;
+
+                if (distance > radius)
+                {
+                    continue;
+                }
+
+                if (isEstimate)
+                {
+                    cost = distance * snapshot->minimumCost;
+                }
+                else
+                {
+                    int32 pointsLeft = GetMovementRangePointsLeft(range, hex);
+                    if (pointsLeft < 0)
+                    {
+                        continue;
+                    }
+
+                    cost = range->movePoints - (uint32)pointsLeft;
+                }
+
+                int32 score = ScoreAiTarget(snapshot, player, target, cost);
+                result      = InsertAiCandidate(candidates, result, target, cost, score);
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE cities go in the order they were added, and each spends out of what is left after the ones before it. A player
+// recruits while it has the gold and not too many heroes for its cities, and builds housing in cities getting full.
+internal void PlanAiCities(AiJob *job)
+{
+    AiSnapshot *snapshot = &job->planner->snapshot;
+    AiCities *cities     = &snapshot->cities;
+    uint32 player        = job->player;
+
+    uint32 firstCity = cities->firstOfPlayer[player];
+    uint32 cityCount = cities->firstOfPlayer[player + 1] - firstCity;
+    uint32 heroCount = snapshot->heroes.firstOfPlayer[player + 1] - snapshot->heroes.firstOfPlayer[player];
+
+    Fixed gold = snapshot->stockpiles[player][RESOURCE_GOLD];
+    Fixed wood = snapshot->stockpiles[player][RESOURCE_WOOD];
+    Fixed ore  = snapshot->stockpiles[player][RESOURCE_ORE];
+
+    job->cityOrders     = PushArray(&job->scratch, cityCount, AiOrder);
+    job->cityOrderCount = 0;
+
+    for (uint32 city = firstCity; city < firstCity + cityCount; ++city)
+    {
+        AiOrder order = {};
+        order.player      = player;
+        order.entityIndex = cities->entityIndices[city];
+        order.target      = cities->hexes[city];
+
+        if (gold >= AI_HERO_GOLD_COST && heroCount < cityCount * AI_MAX_HEROES_PER_CITY)
+        {
+            order.type = AI_ORDER_RECRUIT_HERO;
+            gold -= AI_HERO_GOLD_COST;
+            ++heroCount;
+        }
+        else if (4 * cities->populations[city] >= 3 * cities->capacities[city] && wood >= AI_HOUSING_WOOD_COST &&
+                 ore >= AI_HOUSING_ORE_COST)
+        {
+            order.type = AI_ORDER_BUILD_HOUSING;
+            wood -= AI_HOUSING_WOOD_COST;
+            ore -= AI_HOUSING_ORE_COST;
+        }
+        else
+        {
+            continue;
+        }
+
+        job->cityOrders[job->cityOrderCount++] = order;
+    }
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoAiJob)
+{
+    TIMED_FUNCTION();
+
+    AiJob *job           = (AiJob *)data;
+    AiPlanner *planner   = job->planner;
+    AiSnapshot *snapshot = &planner->snapshot;
+    AiHeroes *heroes     = &snapshot->heroes;
+
+    job->scratch.used       = job->scratchStart;
+    job->candidates         = PushArray(&job->scratch, job->heroCount * AI_MAX_CANDIDATE_COUNT, AiCandidate);
+    job->candidateCounts    = PushArray(&job->scratch, job->heroCount, uint8);
+    job->cityOrders         = 0;
+    job->cityOrderCount     = 0;
+    job->searchedHeroCount  = 0;
+    job->estimatedHeroCount = 0;
+
+    for (uint32 batchIndex = 0; batchIndex < job->heroCount; ++batchIndex)
+    {
+        uint32 hero         = job->firstHero + batchIndex;
+        HexCoord origin     = heroes->hexes[hero];
+        uint32 searchPoints = heroes->movePoints[hero] + (AI_SEARCH_TURN_COUNT - 1) * HERO_MOVE_POINTS;
+        bool32 isEstimate   = planner->deadline && __rdtsc() > planner->deadline;
+        uint32 radius       = 0;
+
+        if (isEstimate)
+        {
+            radius = searchPoints / snapshot->minimumCost;
+            radius = radius < RANGE_MAX_RADIUS ? radius : RANGE_MAX_RADIUS;
+            ++job->estimatedHeroCount;
+        }
+        else
+        {
+            BeginMovementRange(&job->range, origin, searchPoints, snapshot->minimumCost);
+            LoadMovementRangeGridCosts(&job->range, snapshot->cellCosts, snapshot->width, snapshot->height);
+            SearchMovementRange(&job->range);
+
+            radius = job->range.radius;
+            ++job->searchedHeroCount;
+        }
+
+        AiCandidate *candidates = job->candidates + batchIndex * AI_MAX_CANDIDATE_COUNT;
+        job->candidateCounts[batchIndex] =
+            (uint8)FindAiCandidates(snapshot, &job->range, job->player, origin, radius, isEstimate, candidates);
+    }
+
+    if (job->plansCities)
+    {
+        PlanAiCities(job);
+    }
+}
+
+// NOTE stable radix sort on the keys, a byte at a time, so entries with the same score keep the order they were
+// gathered in.
+internal AiMergeEntry *SortAiMergeEntries(AiMergeEntry *entries, AiMergeEntry *scratch, uint32 count)
+{
+    for (uint32 shift = 0; shift < 32; shift += 8)
+    {
+        uint32 firstOfDigit[256] = {};
+
+        for (uint32 index = 0; index < count; ++index)
+        {
+            ++firstOfDigit[(entries[index].key >> shift) & 0xFF];
+        }
+
+        uint32 first = 0;
+        for (uint32 digit = 0; digit < 256; ++digit)
+        {
+            uint32 digitCount   = firstOfDigit[digit];
+            firstOfDigit[digit] = first;
+            first += digitCount;
+        }
+
+        for (uint32 index = 0; index < count; ++index)
+        {
+            scratch[firstOfDigit[(entries[index].key >> shift) & 0xFF]++] = entries[index];
+        }
+
+        AiMergeEntry *swap = entries;
+        entries            = scratch;
+        scratch            = swap;
+    }
+
+    return entries;
+}
+
+// NOTE the best candidate of every hero of the player goes first, whichever hero it belongs to. A hero gets the best
+// target it has that no hero before it took, and heroes left without one stay where they are.
+internal void MergeAiPlayerOrders(AiPlanner *planner, uint32 player, uint32 firstJob, uint32 jobCount)
+{
+    AiSnapshot *snapshot = &planner->snapshot;
+    AiHeroes *heroes     = &snapshot->heroes;
+    MemoryArena *arena   = &planner->mergeArena;
+
+    uint32 firstHero = heroes->firstOfPlayer[player];
+    uint32 heroCount = heroes->firstOfPlayer[player + 1] - firstHero;
+
+    TemporaryMemory temp = StartTemporaryMemory(arena);
+
+    AiMergeEntry *entries = PushArray(arena, heroCount * AI_MAX_CANDIDATE_COUNT, AiMergeEntry);
+    AiMergeEntry *scratch = PushArray(arena, heroCount * AI_MAX_CANDIDATE_COUNT, AiMergeEntry);
+    uint8 *isMoving       = PushArray(arena, heroCount, uint8);
+    uint32 entryCount     = 0;
+
+    memset(isMoving, 0, heroCount);
+
+    for (uint32 jobIndex = firstJob; jobIndex < firstJob + jobCount; ++jobIndex)
+    {
+        AiJob *job = planner->jobs + jobIndex;
+
+        for (uint32 batchIndex = 0; batchIndex < job->heroCount; ++batchIndex)
+        {
+            AiCandidate *candidates = job->candidates + batchIndex * AI_MAX_CANDIDATE_COUNT;
+
+            for (uint32 candidate = 0; candidate < job->candidateCounts[batchIndex]; ++candidate)
+            {
+                AiMergeEntry *entry = entries + entryCount++;
+
+                entry->key    = 0x7FFFFFFF - (uint32)candidates[candidate].score;
+                entry->hero   = job->firstHero + batchIndex;
+                entry->target = candidates[candidate].target;
+                entry->cost   = candidates[candidate].cost;
+            }
+        }
+    }
+
+    entries = SortAiMergeEntries(entries, scratch, entryCount);
+
+    uint32 stamp = ++planner->claimStamp;
+
+    for (uint32 entryIndex = 0; entryIndex < entryCount; ++entryIndex)
+    {
+        AiMergeEntry *entry = entries + entryIndex;
+
+        if (!isMoving[entry->hero - firstHero] && planner->claimStamps[entry->target] != stamp)
+        {
+            isMoving[entry->hero - firstHero]    = true;
+            planner->claimStamps[entry->target] = stamp;
+
+            Assert(planner->orderCount < planner->orderCapacity);
+            AiOrder *order = planner->orders + planner->orderCount++;
+
+            order->type              = AI_ORDER_MOVE_HERO;
+            order->player            = player;
+            order->entityIndex       = heroes->entityIndices[entry->hero];
+            order->target            = snapshot->targets.hexes[entry->target];
+            order->targetEntityIndex = snapshot->targets.entityIndices[entry->target];
+            order->cost              = entry->cost;
+            order->score             = 0x7FFFFFFF - (int32)entry->key;
+        }
+    }
+
+    AiJob *cityJob = planner->jobs + firstJob;
+    for (uint32 orderIndex = 0; orderIndex < cityJob->cityOrderCount; ++orderIndex)
+    {
+        Assert(planner->orderCount < planner->orderCapacity);
+        planner->orders[planner->orderCount++] = cityJob->cityOrders[orderIndex];
+    }
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE plans every player in playerMask from the snapshot, which has to be finished. The players share the jobs, each
+// with at least one, and none gets more than it has batches of heroes for. budgetCycles of 0 means no budget.
+internal void PlanAiTurn(AiPlanner *planner, GameMemory *memory, uint32 playerMask, uint32 jobCount,
+                         uint64 budgetCycles)
+{
+    uint64 start = __rdtsc();
+
+    AiSnapshot *snapshot = &planner->snapshot;
+
+    planner->budgetCycles = budgetCycles;
+    planner->deadline     = budgetCycles ? start + budgetCycles : 0;
+    planner->orderCount   = 0;
+
+    uint32 playerCount = 0;
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        playerCount += (playerMask >> player) & 1;
+    }
+
+    jobCount             = jobCount < AI_MAX_JOB_COUNT ? jobCount : AI_MAX_JOB_COUNT;
+    uint32 jobsPerPlayer = playerCount && jobCount > playerCount ? jobCount / playerCount : 1;
+
+    uint32 firstJobs[MAX_PLAYER_COUNT + 1] = {};
+
+    planner->jobCount = 0;
+
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        firstJobs[player] = planner->jobCount;
+
+        if (!((playerMask >> player) & 1))
+        {
+            continue;
+        }
+
+        uint32 firstHero  = snapshot->heroes.firstOfPlayer[player];
+        uint32 heroCount  = snapshot->heroes.firstOfPlayer[player + 1] - firstHero;
+        uint32 batchCount = heroCount / AI_MIN_JOB_HERO_COUNT + 1;
+        uint32 playerJobs = jobsPerPlayer < batchCount ? jobsPerPlayer : batchCount;
+
+        for (uint32 playerJob = 0; playerJob < playerJobs; ++playerJob)
+        {
+            Assert(planner->jobCount < AI_MAX_JOB_COUNT);
+            AiJob *job = planner->jobs + planner->jobCount++;
+
+            job->player      = player;
+            job->plansCities = playerJob == 0;
+
+            GetTurnJobRange(heroCount, playerJob, playerJobs, &job->firstHero, &job->heroCount);
+            job->firstHero += firstHero;
+
+            memory->platformAddEntry(memory->highPriorityQueue, DoAiJob, job);
+        }
+    }
+
+    firstJobs[MAX_PLAYER_COUNT] = planner->jobCount;
+
+    memory->platformCompleteAllWork(memory->highPriorityQueue);
+
+    uint64 mergeStart = __rdtsc();
+
+    planner->lastSearchedHeroCount  = 0;
+    planner->lastEstimatedHeroCount = 0;
+
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        uint32 playerJobs = firstJobs[player + 1] - firstJobs[player];
+        if (playerJobs)
+        {
+            MergeAiPlayerOrders(planner, player, firstJobs[player], playerJobs);
+        }
+    }
+
+    for (uint32 jobIndex = 0; jobIndex < planner->jobCount; ++jobIndex)
+    {
+        planner->lastSearchedHeroCount += planner->jobs[jobIndex].searchedHeroCount;
+        planner->lastEstimatedHeroCount += planner->jobs[jobIndex].estimatedHeroCount;
+    }
+
+    uint64 end = __rdtsc();
+
+    planner->lastJobCount    = planner->jobCount;
+    planner->lastMergeCycles = end - mergeStart;
+    planner->lastPlanCycles  = end - start;
+}
@@ -0,0 +1,204 @@
+#if !defined(HEX_MAGIC_AI)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_range.h"
+#include "hex_magic_turn.h"
+#include "hex_magic_battle.h"
+
+// NOTE plans the turn of computer players. What the planner needs from the world is copied into a snapshot first: the
+// cost of entering every cell, and heroes, cities and targets in one array per component. Heroes and cities are
+// sorted by owner and targets by the chunk they are in, so a job only ever reads runs of consecutive entries.
+//
+// Each job takes a batch of heroes of one player, searches how far every one of them gets in a couple of turns and
+// keeps the best targets it could go for. Jobs write into their own scratch arena and nothing else, and orders are
+// picked from what they found on the main thread once they are all done, player by player in the same order every
+// time. So the same snapshot gets the same orders however many threads planned it, as long as it wasn't cut short by
+// the time budget.
+
+#define AI_MAX_JOB_COUNT 64
+#define AI_MIN_JOB_HERO_COUNT 8
+#define AI_JOB_SCRATCH_SIZE Megabytes(1)
+
+// NOTE best targets kept for every hero, and how many turns of walking the planner looks ahead.
+#define AI_MAX_CANDIDATE_COUNT 8
+#define AI_SEARCH_TURN_COUNT 2
+
+#define AI_TARGET_BUCKET_SHIFT WORLD_CHUNK_SHIFT
+#define AI_SCORE_SCALE 1024
+
+#define AI_CITY_VALUE 60
+#define AI_BATTLE_COUNT 128
+#define AI_HERO_GOLD_COST (2500 * FIXED_ONE)
+#define AI_HOUSING_WOOD_COST (5 * FIXED_ONE)
+#define AI_HOUSING_ORE_COST (5 * FIXED_ONE)
+#define AI_MAX_HEROES_PER_CITY 4
+
+enum AiOrderType
+{
+    AI_ORDER_MOVE_HERO,
+    AI_ORDER_RECRUIT_HERO,
+    AI_ORDER_BUILD_HOUSING,
+};
+
+struct AiOrder
+{
+    AiOrderType type;
+    uint32 player;
+
+    // NOTE the hero that moves or the city that builds.
+    uint32 entityIndex;
+
+    // NOTE where the hero goes and what it goes for, only for moves.
+    HexCoord target;
+    uint32 targetEntityIndex;
+    uint32 cost;
+
+    // NOTE how much the target is worth per move point of getting there, 0 for cities.
+    int32 score;
+};
+
+// NOTE sorted by owner, the heroes of a player are firstOfPlayer[player] up to firstOfPlayer[player + 1].
+struct AiHeroes
+{
+    uint32 count;
+    uint32 capacity;
+
+    uint32 *entityIndices;
+    HexCoord *hexes;
+    uint32 *movePoints;
+    uint8 *owners;
+
+    uint32 firstOfPlayer[MAX_PLAYER_COUNT + 1];
+};
+
+// NOTE same as heroes, with the cities nobody owns after the last player's.
+struct AiCities
+{
+    uint32 count;
+    uint32 capacity;
+
+    uint32 *entityIndices;
+    HexCoord *hexes;
+    uint8 *owners;
+
+    Fixed *populations;
+    Fixed *capacities;
+
+    uint32 firstOfPlayer[MAX_PLAYER_COUNT + 2];
+};
+
+// NOTE whatever a hero can go for, resources and cities alike, sorted by the chunk of the world they are in. The
+// targets of a bucket are firstInBucket[bucket] up to firstInBucket[bucket + 1].
+struct AiTargets
+{
+    uint32 count;
+    uint32 capacity;
+
+    uint32 *entityIndices;
+    HexCoord *hexes;
+    uint8 *owners;
+    uint16 *values;
+
+    int32 bucketCountX;
+    int32 bucketCountY;
+    uint32 *firstInBucket;
+};
+
+struct AiSnapshot
+{
+    int32 width;
+    int32 height;
+
+    // NOTE cost of entering every cell in offset coordinates, 0 for cells that can't be entered.
+    uint8 *cellCosts;
+    uint32 minimumCost;
+
+    // NOTE who holds every cell, when there was an influence map to take it from.
+    bool32 hasTerritory;
+    uint8 *territory;
+
+    AiHeroes heroes;
+    AiCities cities;
+    AiTargets targets;
+
+    Fixed stockpiles[MAX_PLAYER_COUNT][RESOURCE_KIND_COUNT];
+};
+
+struct AiCandidate
+{
+    uint32 target;
+    uint32 cost;
+    int32 score;
+};
+
+struct AiPlanner;
+
+struct AiJob
+{
+    AiPlanner *planner;
+
+    uint32 player;
+    uint32 firstHero;
+    uint32 heroCount;
+
+    // NOTE only the first job of a player decides what its cities build.
+    bool32 plansCities;
+
+    // NOTE the range is set up once, everything after it is thrown away at the start of every plan.
+    MemoryArena scratch;
+    MovementRange range;
+    MemoryIndex scratchStart;
+
+    // NOTE AI_MAX_CANDIDATE_COUNT per hero, best first.
+    AiCandidate *candidates;
+    uint8 *candidateCounts;
+
+    AiOrder *cityOrders;
+    uint32 cityOrderCount;
+
+    uint32 searchedHeroCount;
+    uint32 estimatedHeroCount;
+};
+
+// NOTE the key sorts the best score first.
+struct AiMergeEntry
+{
+    uint32 key;
+    uint32 hero;
+    uint32 target;
+    uint32 cost;
+};
+
+struct AiPlanner
+{
+    AiSnapshot snapshot;
+
+    // NOTE 0 plans every hero properly. Otherwise heroes whose turn comes after the budget has run out only get their
+    // targets estimated from how far away they are.
+    uint64 budgetCycles;
+    uint64 deadline;
+
+    uint32 jobCount;
+    AiJob jobs[AI_MAX_JOB_COUNT];
+
+    MemoryArena mergeArena;
+
+    // NOTE a target is taken for this plan and player when it holds claimStamp.
+    uint32 *claimStamps;
+    uint32 claimStamp;
+
+    uint32 orderCount;
+    uint32 orderCapacity;
+    AiOrder *orders;
+
+    // NOTE stats of the last plan.
+    uint64 lastPlanCycles;
+    uint64 lastMergeCycles;
+    uint32 lastJobCount;
+    uint32 lastSearchedHeroCount;
+    uint32 lastEstimatedHeroCount;
+};
+
+#define HEX_MAGIC_AI
+#endif
@@ -0,0 +1,152 @@
+#include "hex_magic.h"
+#include "hex_magic_asset.h"
+#include "hex_magic_font.h"
+#include "hex_magic_platform.h"
+
+// NOTE where the packer takes every asset from, relative to data. The font atlas is baked from the fonts
+// DEBUGLoadFontAtlas reads.
+global char *globalAssetFileNames[ASSET_COUNT] = {
+    "assets/sprites/city.bmp",
+    "assets/sprites/hero.bmp",
+    "assets/textures/grass.bmp",
+    "assets/textures/dirt.bmp",
+    "assets/textures/lava.bmp",
+    "assets/textures/rough.bmp",
+    "assets/textures/sand.bmp",
+    "assets/textures/snow.bmp",
+    "assets/textures/swamp.bmp",
+    "assets/textures/water.bmp",
+    "assets/textures/rock.bmp",
+    0,
+};
+
+inline uint32 GetAssetPackChecksum(AssetPackHeader *header, AssetPackEntry *entries)
+{
+    AssetPackHeader checked = *header;
+    checked.checksum        = 0;
+
+    uint32 result = Crc32(0, &checked, sizeof(checked));
+    result        = Crc32(result, entries, header->assetCount * sizeof(AssetPackEntry));
+
+    return result;
+}
+
+inline uint32 GetAssetType(AssetId id)
+{
+    uint32 result = id == ASSET_FONT_ATLAS ? ASSET_TYPE_FONT_ATLAS : ASSET_TYPE_BITMAP;
+    return result;
+}
+
+// NOTE everything the game reads from the pack is checked here once, so getting an asset out of it later is only
+// pointing at it. A pack that is missing, from another version or cut short is not used at all.
+internal bool32 OpenAssetPack(AssetPack *pack, ThreadContext *thread, GameMemory *memory, char *fileName)
+{
+    *pack = {};
+
+    PlatformMappedFile file = memory->platformMapReadOnlyFile(thread, fileName);
+    bool32 isValid          = file.memory && file.size >= sizeof(AssetPackHeader);
+
+    AssetPackHeader *header = (AssetPackHeader *)file.memory;
+    AssetPackEntry *entries = (AssetPackEntry *)(header + 1);
+
+    isValid = isValid && header->magicValue == ASSET_PACK_MAGIC_VALUE && header->version == ASSET_PACK_VERSION &&
+              header->assetCount == ASSET_COUNT && header->size == file.size &&
+              sizeof(AssetPackHeader) + ASSET_COUNT * sizeof(AssetPackEntry) <= file.size &&
+              header->checksum == GetAssetPackChecksum(header, entries);
+
+    for (uint32 assetIndex = 0; isValid && assetIndex < ASSET_COUNT; ++assetIndex)
+    {
+        AssetPackEntry *entry = entries + assetIndex;
+
+        uint64 expectedSize = 0;
+        if (entry->type == ASSET_TYPE_BITMAP)
+        {
+            expectedSize = GetAssetBitmapSize(entry->width, entry->height, entry->mipCount);
+        }
+        else if (entry->type == ASSET_TYPE_FONT_ATLAS)
+        {
+            expectedSize = GetAssetFontAtlasSize(entry->width, entry->height);
+        }
+
+        isValid = entry->id == assetIndex && entry->type == GetAssetType((AssetId)assetIndex) &&
+                  entry->width > 0 && entry->height > 0 && entry->mipCount > 0 &&
+                  entry->mipCount <= GetAssetMipCount(entry->width, entry->height) && entry->size == expectedSize &&
+                  entry->offset % ASSET_PACK_ALIGNMENT == 0 && entry->offset <= file.size &&
+                  entry->size <= file.size - entry->offset;
+    }
+
+    if (isValid)
+    {
+        pack->file    = file;
+        pack->header  = header;
+        pack->entries = entries;
+    }
+    else if (file.memory)
+    {
+        memory->platformUnmapFile(thread, &file);
+    }
+
+    return isValid;
+}
+
+internal void CloseAssetPack(AssetPack *pack, ThreadContext *thread, GameMemory *memory)
+{
+    memory->platformUnmapFile(thread, &pack->file);
+    *pack = {};
+}
+
+inline Bitmap GetAssetBitmap(AssetPack *pack, AssetId id)
+{
+    AssetPackEntry *entry = pack->entries + id;
+    Assert(entry->type == ASSET_TYPE_BITMAP);
+
+    Bitmap result   = {};
+    result.width    = entry->width;
+    result.height   = entry->height;
+    result.pitch    = entry->width * BITMAP_BYTES_PER_PIXEL;
+    result.memory   = (uint8 *)pack->file.memory + entry->offset;
+    result.mipCount = entry->mipCount;
+
+    return result;
+}
+
+// NOTE the glyphs and kerning are copied out, the atlas texels are used where they are in the pack.
+internal void GetAssetFontAtlas(AssetPack *pack, FontAtlas *fontAtlas)
+{
+    AssetPackEntry *entry = pack->entries + ASSET_FONT_ATLAS;
+    Assert(entry->type == ASSET_TYPE_FONT_ATLAS);
+
+    uint8 *at            = (uint8 *)pack->file.memory + entry->offset;
+    AssetPackFont *fonts = (AssetPackFont *)at;
+    at += FONT_STYLE_COUNT * FONT_SIZE_COUNT * sizeof(AssetPackFont);
+
+    memcpy(fontAtlas->kerning, at, sizeof(fontAtlas->kerning));
+    at += sizeof(fontAtlas->kerning);
+
+    Bitmap *atlas   = &fontAtlas->bitmap;
+    atlas->width    = entry->width;
+    atlas->height   = entry->height;
+    atlas->pitch    = entry->width * BITMAP_BYTES_PER_PIXEL;
+    atlas->memory   = at;
+    atlas->mipCount = 1;
+
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        for (uint32 size = 0; size < FONT_SIZE_COUNT; ++size)
+        {
+            AssetPackFont *source = fonts + style * FONT_SIZE_COUNT + size;
+            Font *font            = &fontAtlas->fonts[style][size];
+
+            font->isValid     = source->isValid;
+            font->pixelHeight = source->pixelHeight;
+            font->ascent      = source->ascent;
+            font->descent     = source->descent;
+            font->lineAdvance = source->lineAdvance;
+            font->unitScale   = source->unitScale;
+            font->kerning     = &fontAtlas->kerning[style][0][0];
+            font->atlas       = atlas;
+
+            memcpy(font->glyphs, source->glyphs, sizeof(font->glyphs));
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#if !defined(HEX_MAGIC_ASSET)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_map.h"
+#include "hex_magic_font.h"
+
+// NOTE the asset pack is made from data/assets by the packer at build time and mapped by the game as it is. Like map
+// files it is little endian and never contains pointers. A pack is an AssetPackHeader followed by the directory, one
+// entry per AssetId in order, followed by the asset data at the offsets the directory points to.
+
+#define ASSET_PACK_MAGIC_VALUE MAP_CODE('h', 'x', 'a', 'p')
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_FILE_NAME "assets.hxa"
+
+// NOTE asset data starts on a cache line.
+#define ASSET_PACK_ALIGNMENT 64
+
+enum AssetId
+{
+    ASSET_CITY,
+    ASSET_HERO,
+
+    ASSET_GRASS_TEXTURE,
+    ASSET_DIRT_TEXTURE,
+    ASSET_LAVA_TEXTURE,
+    ASSET_ROUGH_TEXTURE,
+    ASSET_SAND_TEXTURE,
+    ASSET_SNOW_TEXTURE,
+    ASSET_SWAMP_TEXTURE,
+    ASSET_WATER_TEXTURE,
+    ASSET_ROCK_TEXTURE,
+
+    ASSET_FONT_ATLAS,
+
+    ASSET_COUNT,
+};
+
+enum AssetType
+{
+    ASSET_TYPE_BITMAP     = MAP_CODE('b', 'm', 'a', 'p'),
+    ASSET_TYPE_FONT_ATLAS = MAP_CODE('f', 'o', 'n', 't'),
+};
+
+#pragma pack(push, 1)
+struct AssetPackHeader
+{
+    uint32 magicValue;
+    uint32 version;
+    uint32 assetCount;
+
+    // NOTE covers the header, with this field zeroed, and the directory. The asset data is left out, checking it
+    // would mean reading every texel of the pack at startup.
+    uint32 checksum;
+
+    uint64 size;
+};
+
+// NOTE a bitmap is its mips one after the other, from the full size one down, each halved until a side would get
+// shorter than two texels. Texels are premultiplied in the layout of the screen, rows go down the bitmap.
+struct AssetPackEntry
+{
+    uint32 id;
+    uint32 type;
+    uint64 offset;
+    uint64 size;
+
+    int32 width;
+    int32 height;
+    uint32 mipCount;
+    uint32 reserved;
+};
+
+// NOTE a font atlas is one of these for every style and size in FontAtlas order, followed by the kerning of every
+// style, followed by the atlas texels with the width and height of the entry.
+struct AssetPackFont
+{
+    uint32 isValid;
+
+    real32 pixelHeight;
+    real32 ascent;
+    real32 descent;
+    real32 lineAdvance;
+    real32 unitScale;
+
+    FontGlyph glyphs[FONT_GLYPH_COUNT];
+};
+#pragma pack(pop)
+
+struct AssetPack
+{
+    PlatformMappedFile file;
+
+    AssetPackHeader *header;
+    AssetPackEntry *entries;
+};
+
+inline uint32 GetAssetMipCount(int32 width, int32 height)
+{
+    uint32 result = 1;
+
+    while (width >= 4 && height >= 4)
+    {
+        width /= 2;
+        height /= 2;
+        ++result;
+    }
+
+    return result;
+}
+
+inline uint64 GetAssetBitmapSize(int32 width, int32 height, uint32 mipCount)
+{
+    uint64 result = 0;
+
+    for (uint32 mipIndex = 0; mipIndex < mipCount; ++mipIndex)
+    {
+        result += (uint64)width * (uint64)height * BITMAP_BYTES_PER_PIXEL;
+
+        width /= 2;
+        height /= 2;
+    }
+
+    return result;
+}
+
+inline uint64 GetAssetFontAtlasSize(int32 width, int32 height)
+{
+    uint64 result = FONT_STYLE_COUNT * FONT_SIZE_COUNT * sizeof(AssetPackFont) +
+                    FONT_STYLE_COUNT * FONT_GLYPH_COUNT * FONT_GLYPH_COUNT * sizeof(int16) +
+                    (uint64)width * (uint64)height * BITMAP_BYTES_PER_PIXEL;
+
+    return result;
+}
+
+#define HEX_MAGIC_ASSET
+#endif
@@ -0,0 +1,483 @@
+#include "hex_magic.h"
+#include "hex_magic_battle.h"
+#include "hex_magic_intrinsics.h"
+#include "hex_magic_platform.h"
+
+// NOTE every point of attack over the defense adds a twentieth to the damage, up to three times as much, and every
+// point under takes it down to as little as a third.
+internal real32 GetBattleModifier(int32 attack, int32 defense)
+{
+    int32 difference = attack - defense;
+    real32 result    = 1.0f;
+
+    if (difference >= 0)
+    {
+        result = 1.0f + 0.05f * (real32)difference;
+        result = result < 3.0f ? result : 3.0f;
+    }
+    else
+    {
+        result = 1.0f / (1.0f - 0.025f * (real32)difference);
+        result = result > 0.33f ? result : 0.33f;
+    }
+
+    return result;
+}
+
+internal BattleSetup MakeBattleSetup(Battle *battle)
+{
+    BattleSetup result = {};
+
+    for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+    {
+        BattleSide *us   = battle->sides + side;
+        BattleSide *them = battle->sides + (side ^ 1);
+        Assert(us->stackCount <= BATTLE_MAX_STACK_COUNT);
+
+        for (uint32 stackIndex = 0; stackIndex < BATTLE_MAX_STACK_COUNT; ++stackIndex)
+        {
+            // NOTE stacks that aren't there have a hit point, so counting their units never divides by 0.
+            result.hitPoints[side][stackIndex] = 1.0f;
+
+            if (stackIndex < us->stackCount)
+            {
+                BattleStack *stack = us->stacks + stackIndex;
+                Assert(stack->hitPoints > 0 && stack->minDamage <= stack->maxDamage);
+
+                result.pools[side][stackIndex]        = (real32)stack->count * (real32)stack->hitPoints;
+                result.hitPoints[side][stackIndex]    = (real32)stack->hitPoints;
+                result.minDamages[side][stackIndex]   = (real32)stack->minDamage;
+                result.damageRanges[side][stackIndex] = (real32)(stack->maxDamage - stack->minDamage + 1);
+                result.modifiers[side][stackIndex]    = GetBattleModifier(us->attack + stack->attack, them->defense);
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE mixes the seed and the index of the battle, so battles next to each other start far apart. xorshift never
+// leaves 0, so 0 is never a state.
+inline uint32 GetBattleRandomState(uint32 seed, uint32 battleIndex)
+{
+    uint32 x = seed ^ (battleIndex * 0x9E3779B9);
+
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    x ^= x >> 16;
+
+    uint32 result = x ? x : 1;
+    return result;
+}
+
+//
+// NOTE one at a time
+//
+
+// NOTE xorshift, and the top 24 bits of the new state as a float in [0, 1).
+inline real32 NextBattleUniform(uint32 *state)
+{
+    uint32 x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    *state = x;
+
+    real32 result = (real32)(int32)(x >> 8) * (1.0f / 16777216.0f);
+    return result;
+}
+
+inline real32 CountBattleUnits(real32 pool, real32 hitPoints)
+{
+    real32 units  = pool / hitPoints;
+    real32 result = (real32)(int32)units;
+
+    if (result < units)
+    {
+        result += 1.0f;
+    }
+
+    return result;
+}
+
+internal void PlayBattle(BattleSetup *setup, uint32 randomState, BattleLanes *lanes, uint32 lane)
+{
+    real32 pools[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+    memcpy(pools, setup->pools, sizeof(pools));
+
+    for (uint32 round = 0; round < BATTLE_MAX_ROUND_COUNT; ++round)
+    {
+        real32 damages[BATTLE_SIDE_COUNT] = {};
+        bool32 isAlive[BATTLE_SIDE_COUNT] = {};
+
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+            {
+                real32 units = CountBattleUnits(pools[side][stack], setup->hitPoints[side][stack]);
+                real32 roll  = setup->minDamages[side][stack] +
+                              (real32)(int32)(NextBattleUniform(&randomState) * setup->damageRanges[side][stack]);
+
+                damages[side] = damages[side] + units * roll * setup->modifiers[side][stack];
+                isAlive[side] |= pools[side][stack] > 0.0f;
+            }
+        }
+
+        if (!isAlive[BATTLE_ATTACKER] || !isAlive[BATTLE_DEFENDER])
+        {
+            break;
+        }
+
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            real32 damage = damages[side ^ 1];
+
+            for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+            {
+                real32 taken = damage < pools[side][stack] ? damage : pools[side][stack];
+
+                pools[side][stack] = pools[side][stack] - taken;
+                damage             = damage - taken;
+            }
+        }
+    }
+
+    for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+    {
+        for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+        {
+            lanes->counts[side][stack][lane] =
+                (int32)CountBattleUnits(pools[side][stack], setup->hitPoints[side][stack]);
+        }
+    }
+}
+
+//
+// NOTE SSE2
+//
+
+inline __m128 NextBattleUniformSse2(__m128i *state)
+{
+    __m128i x = *state;
+
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+
+    *state = x;
+
+    __m128 result = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+    return result;
+}
+
+inline __m128 CountBattleUnitsSse2(__m128 pool, __m128 hitPoints)
+{
+    __m128 units     = _mm_div_ps(pool, hitPoints);
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(units));
+
+    __m128 result = _mm_add_ps(truncated, _mm_and_ps(_mm_cmplt_ps(truncated, units), _mm_set1_ps(1.0f)));
+    return result;
+}
+
+// NOTE stops early once every lane is done, which changes nothing for the lanes that were done before.
+internal void PlayBattlesSse2(BattleSetup *setup, uint32 *randomStates, BattleLanes *lanes)
+{
+    __m128 pools[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+    for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+    {
+        for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+        {
+            pools[side][stack] = _mm_set1_ps(setup->pools[side][stack]);
+        }
+    }
+
+    __m128i state = _mm_loadu_si128((__m128i *)randomStates);
+    __m128 zero   = _mm_setzero_ps();
+
+    for (uint32 round = 0; round < BATTLE_MAX_ROUND_COUNT; ++round)
+    {
+        __m128 damages[BATTLE_SIDE_COUNT];
+        __m128 isAlive[BATTLE_SIDE_COUNT];
+
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            damages[side] = zero;
+            isAlive[side] = zero;
+
+            for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+            {
+                __m128 hitPoints = _mm_set1_ps(setup->hitPoints[side][stack]);
+                __m128 units     = CountBattleUnitsSse2(pools[side][stack], hitPoints);
+                __m128 uniform   = NextBattleUniformSse2(&state);
+                __m128 range     = _mm_mul_ps(uniform, _mm_set1_ps(setup->damageRanges[side][stack]));
+                __m128 roll      = _mm_add_ps(_mm_set1_ps(setup->minDamages[side][stack]),
+                                              _mm_cvtepi32_ps(_mm_cvttps_epi32(range)));
+                __m128 modifier  = _mm_set1_ps(setup->modifiers[side][stack]);
+                __m128 hit       = _mm_mul_ps(_mm_mul_ps(units, roll), modifier);
+
+                damages[side] = _mm_add_ps(damages[side], hit);
+                isAlive[side] = _mm_or_ps(isAlive[side], _mm_cmpgt_ps(pools[side][stack], zero));
+            }
+        }
+
+        if (!_mm_movemask_ps(_mm_and_ps(isAlive[BATTLE_ATTACKER], isAlive[BATTLE_DEFENDER])))
+        {
+            break;
+        }
+
+        // NOTE a lane with a side gone has no damage left for the other one to take, and deals none either.
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            __m128 damage = damages[side ^ 1];
+
+            for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+            {
+                __m128 taken = _mm_min_ps(damage, pools[side][stack]);
+
+                pools[side][stack] = _mm_sub_ps(pools[side][stack], taken);
+                damage             = _mm_sub_ps(damage, taken);
+            }
+        }
+    }
+
+    for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+    {
+        for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+        {
+            __m128 units = CountBattleUnitsSse2(pools[side][stack], _mm_set1_ps(setup->hitPoints[side][stack]));
+            _mm_storeu_si128((__m128i *)lanes->counts[side][stack], _mm_cvttps_epi32(units));
+        }
+    }
+}
+
+//
+// NOTE AVX2
+//
+
+TARGET_AVX2 inline __m256 NextBattleUniformAvx2(__m256i *state)
+{
+    __m256i x = *state;
+
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+
+    *state = x;
+
+    __m256 result = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+    return result;
+}
+
+TARGET_AVX2 inline __m256 CountBattleUnitsAvx2(__m256 pool, __m256 hitPoints)
+{
+    __m256 units     = _mm256_div_ps(pool, hitPoints);
+    __m256 truncated = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(units));
+    __m256 isShort   = _mm256_cmp_ps(truncated, units, _CMP_LT_OQ);
+
+    __m256 result = _mm256_add_ps(truncated, _mm256_and_ps(isShort, _mm256_set1_ps(1.0f)));
+    return result;
+}
+
+TARGET_AVX2 internal void PlayBattlesAvx2(BattleSetup *setup, uint32 *randomStates, BattleLanes *lanes)
+{
+    __m256 pools[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+    for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+    {
+        for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+        {
+            pools[side][stack] = _mm256_set1_ps(setup->pools[side][stack]);
+        }
+    }
+
+    __m256i state = _mm256_loadu_si256((__m256i *)randomStates);
+    __m256 zero   = _mm256_setzero_ps();
+
+    for (uint32 round = 0; round < BATTLE_MAX_ROUND_COUNT; ++round)
+    {
+        __m256 damages[BATTLE_SIDE_COUNT];
+        __m256 isAlive[BATTLE_SIDE_COUNT];
+
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            damages[side] = zero;
+            isAlive[side] = zero;
+
+            for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+            {
+                __m256 hitPoints = _mm256_set1_ps(setup->hitPoints[side][stack]);
+                __m256 units     = CountBattleUnitsAvx2(pools[side][stack], hitPoints);
+                __m256 uniform   = NextBattleUniformAvx2(&state);
+                __m256 range     = _mm256_mul_ps(uniform, _mm256_set1_ps(setup->damageRanges[side][stack]));
+                __m256 roll      = _mm256_add_ps(_mm256_set1_ps(setup->minDamages[side][stack]),
+                                                 _mm256_cvtepi32_ps(_mm256_cvttps_epi32(range)));
+                __m256 modifier  = _mm256_set1_ps(setup->modifiers[side][stack]);
+                __m256 hit       = _mm256_mul_ps(_mm256_mul_ps(units, roll), modifier);
+
+                damages[side] = _mm256_add_ps(damages[side], hit);
+                isAlive[side] = _mm256_or_ps(isAlive[side], _mm256_cmp_ps(pools[side][stack], zero, _CMP_GT_OQ));
+            }
+        }
+
+        if (!_mm256_movemask_ps(_mm256_and_ps(isAlive[BATTLE_ATTACKER], isAlive[BATTLE_DEFENDER])))
+        {
+            break;
+        }
+
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            __m256 damage = damages[side ^ 1];
+
+            for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+            {
+                __m256 taken = _mm256_min_ps(damage, pools[side][stack]);
+
+                pools[side][stack] = _mm256_sub_ps(pools[side][stack], taken);
+                damage             = _mm256_sub_ps(damage, taken);
+            }
+        }
+    }
+
+    for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+    {
+        for (uint32 stack = 0; stack < BATTLE_MAX_STACK_COUNT; ++stack)
+        {
+            __m256 units = CountBattleUnitsAvx2(pools[side][stack], _mm256_set1_ps(setup->hitPoints[side][stack]));
+            _mm256_storeu_si256((__m256i *)lanes->counts[side][stack], _mm256_cvttps_epi32(units));
+        }
+    }
+}
+
+//
+// NOTE estimates
+//
+
+// NOTE the attacker wins when it is the only one left, so both sides going down together is a win for nobody.
+internal void AddBattleLanes(Battle *battle, BattleLanes *lanes, uint32 laneCount, BattleEstimate *estimate)
+{
+    for (uint32 lane = 0; lane < laneCount; ++lane)
+    {
+        bool32 isAlive[BATTLE_SIDE_COUNT] = {};
+
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            BattleSide *battleSide = battle->sides + side;
+
+            for (uint32 stack = 0; stack < battleSide->stackCount; ++stack)
+            {
+                uint32 count = (uint32)lanes->counts[side][stack][lane];
+                uint32 lost  = battleSide->stacks[stack].count - count;
+
+                estimate->lostUnitCounts[side] += lost;
+                estimate->lostValues[side] += (uint64)lost * battleSide->stacks[stack].value;
+
+                isAlive[side] |= count > 0;
+            }
+        }
+
+        if (isAlive[BATTLE_ATTACKER] && !isAlive[BATTLE_DEFENDER])
+        {
+            ++estimate->attackerWinCount;
+        }
+        else if (isAlive[BATTLE_DEFENDER] && !isAlive[BATTLE_ATTACKER])
+        {
+            ++estimate->defenderWinCount;
+        }
+    }
+}
+
+// NOTE plays battleCount battles, as many as fit in whole groups of lanes on the widest path there is and the rest
+// one at a time.
+internal BattleEstimate EstimateBattle(Battle *battle, uint32 seed, uint32 battleCount)
+{
+    uint64 start = __rdtsc();
+
+    BattleEstimate result = {};
+    result.battleCount    = battleCount;
+
+    BattleSetup setup = MakeBattleSetup(battle);
+    BattleLanes lanes = {};
+
+    HexBatchPath path = GetHexBatchPath();
+    uint32 laneCount  = path == HEX_BATCH_AVX2 ? 8 : path == HEX_BATCH_SSE2 ? 4 : 1;
+    uint32 index      = 0;
+
+    if (laneCount > 1)
+    {
+        for (; index + laneCount <= battleCount; index += laneCount)
+        {
+            uint32 randomStates[BATTLE_MAX_LANE_COUNT];
+            for (uint32 lane = 0; lane < laneCount; ++lane)
+            {
+                randomStates[lane] = GetBattleRandomState(seed, index + lane);
+            }
+
+            if (path == HEX_BATCH_AVX2)
+            {
+                PlayBattlesAvx2(&setup, randomStates, &lanes);
+            }
+            else
+            {
+                PlayBattlesSse2(&setup, randomStates, &lanes);
+            }
+
+            AddBattleLanes(battle, &lanes, laneCount, &result);
+        }
+    }
+
+    for (; index < battleCount; ++index)
+    {
+        PlayBattle(&setup, GetBattleRandomState(seed, index), &lanes, 0);
+        AddBattleLanes(battle, &lanes, 1, &result);
+    }
+
+    if (battleCount)
+    {
+        result.winChance = (real32)result.attackerWinCount / (real32)battleCount;
+
+        for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+        {
+            result.expectedLosses[side]      = (real32)((real64)result.lostUnitCounts[side] / battleCount);
+            result.expectedValueLosses[side] = (real32)((real64)result.lostValues[side] / battleCount);
+        }
+    }
+
+    result.cycles = __rdtsc() - start;
+    return result;
+}
+
+//
+// NOTE armies
+//
+
+// NOTE heroes don't have armies of their own yet, so every hero leads the same one.
+internal BattleSide MakeHeroBattleSide()
+{
+    BattleSide result = {};
+
+    result.attack  = 2;
+    result.defense = 2;
+
+    result.stacks[result.stackCount++] = {20, 10, 1, 3, 4, 1};
+    result.stacks[result.stackCount++] = {12, 10, 2, 3, 6, 2};
+    result.stacks[result.stackCount++] = {5, 25, 3, 6, 8, 5};
+
+    return result;
+}
+
+// NOTE a city is held by a militia of a unit per hundred people and a guard per four hundred, behind its walls.
+internal BattleSide MakeCityBattleSide(uint32 population)
+{
+    BattleSide result = {};
+
+    result.attack  = 0;
+    result.defense = 5;
+
+    result.stacks[result.stackCount++] = {population / 100, 8, 1, 2, 1, 1};
+    result.stacks[result.stackCount++] = {population / 400, 20, 2, 4, 4, 3};
+
+    return result;
+}
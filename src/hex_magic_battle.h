@@ -0,0 +1,93 @@
+#if !defined(HEX_MAGIC_BATTLE)
+
+#include "hex_magic_platform.h"
+
+// NOTE quick combat. Two sides with a few stacks of units each fight in rounds until one of them is gone or the rounds
+// run out, which the defender counts as holding. Every round every stack of both sides rolls its damage at the same
+// time, and the damage a side takes goes to its stacks in order, spilling over to the next one once a stack is gone.
+// A stack is as many units as it takes to hold the hit points it has left.
+//
+// Battles are estimated by playing the same one many times with different rolls, four or eight of them at once with
+// one battle per SIMD lane. Each battle gets its own random state from the seed and its index, and lanes only ever do
+// the same float operations in the same order as the one at a time version, so an estimate comes out the same for the
+// same seed whichever path played it.
+
+#define BATTLE_MAX_STACK_COUNT 4
+#define BATTLE_MAX_ROUND_COUNT 32
+#define BATTLE_MAX_LANE_COUNT 8
+
+enum BattleSideIndex
+{
+    BATTLE_ATTACKER,
+    BATTLE_DEFENDER,
+
+    BATTLE_SIDE_COUNT
+};
+
+struct BattleStack
+{
+    uint32 count;
+    uint32 hitPoints;
+
+    uint32 minDamage;
+    uint32 maxDamage;
+
+    // NOTE added to the attack of the side for what the stack deals.
+    int32 attack;
+
+    // NOTE what losing a unit of the stack is worth, for the AI to weigh losses with.
+    uint32 value;
+};
+
+struct BattleSide
+{
+    uint32 stackCount;
+    BattleStack stacks[BATTLE_MAX_STACK_COUNT];
+
+    int32 attack;
+    int32 defense;
+};
+
+struct Battle
+{
+    BattleSide sides[BATTLE_SIDE_COUNT];
+};
+
+// NOTE everything a round needs, per stack of both sides, worked out once per estimate. Stacks that aren't there have
+// no hit points to lose and deal no damage.
+struct BattleSetup
+{
+    real32 pools[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+    real32 hitPoints[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+    real32 minDamages[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+    real32 damageRanges[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+    real32 modifiers[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT];
+};
+
+// NOTE units left in every stack at the end of each battle, a lane per battle.
+struct BattleLanes
+{
+    int32 counts[BATTLE_SIDE_COUNT][BATTLE_MAX_STACK_COUNT][BATTLE_MAX_LANE_COUNT];
+};
+
+struct BattleEstimate
+{
+    uint32 battleCount;
+    uint32 attackerWinCount;
+    uint32 defenderWinCount;
+
+    // NOTE attacker wins over battleCount.
+    real32 winChance;
+
+    // NOTE units and value each side loses on average.
+    real32 expectedLosses[BATTLE_SIDE_COUNT];
+    real32 expectedValueLosses[BATTLE_SIDE_COUNT];
+
+    uint64 lostUnitCounts[BATTLE_SIDE_COUNT];
+    uint64 lostValues[BATTLE_SIDE_COUNT];
+
+    uint64 cycles;
+};
+
+#define HEX_MAGIC_BATTLE
+#endif
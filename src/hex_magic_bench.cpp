@@ -0,0 +1,131 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hex_magic.cpp"
+#include "linux_hex_magic_posix.cpp"
+
+// NOTE headless driver that links the game code directly and times individual systems. Run it from data/ like the
+// game, optionally passing the names of the benchmarks to run. The benches of every system live in a file of their own,
+// and what they all share, the context, timing and the worlds and editors they run on, in the fixture.
+
+#include "hex_magic_bench_fixture.cpp"
+#include "hex_magic_bench_map.cpp"
+#include "hex_magic_bench_editor.cpp"
+#include "hex_magic_bench_path.cpp"
+#include "hex_magic_bench_hex.cpp"
+#include "hex_magic_bench_generate.cpp"
+#include "hex_magic_bench_turn.cpp"
+#include "hex_magic_bench_hash.cpp"
+#include "hex_magic_bench_debug.cpp"
+#include "hex_magic_bench_render.cpp"
+
+struct BenchEntry
+{
+    char *name;
+    void (*run)(BenchContext *context);
+};
+
+global BenchEntry globalBenchmarks[] = {
+    {"map", BenchMapFormat},
+    {"paging", BenchMapPaging},
+    {"journal", BenchJournal},
+    {"undo", BenchUndo},
+    {"fill", BenchFill},
+    {"stroke", BenchStroke},
+    {"path", BenchPath},
+    {"hpa", BenchHpa},
+    {"flow", BenchFlow},
+    {"range", BenchRange},
+    {"fog", BenchFog},
+    {"hex", BenchHex},
+    {"hexiter", BenchHexIterators},
+    {"generate", BenchGenerate},
+    {"kernel", BenchKernel},
+    {"turn", BenchTurn},
+    {"battle", BenchBattle},
+    {"ai", BenchAi},
+    {"hash", BenchHash},
+    {"timed", BenchTimedBlocks},
+    {"replay", BenchReplays},
+    {"text", BenchText},
+    {"assets", BenchAssets},
+};
+
+int main(int argc, char *args[])
+{
+    BenchContext context = {};
+
+    context.randomState = 0x9E3779B9;
+    context.argc        = argc;
+    context.args        = args;
+
+    context.memory.permanentStorageSize         = Gigabytes(16);
+    context.memory.transientStorageSize         = Gigabytes(1);
+    context.memory.debugPlatformFreeFileMemory  = debugPlatformFreeFileMemory;
+    context.memory.debugPlatformReadEntireFile  = debugPlatformReadEntireFile;
+    context.memory.debugPlatformWriteEntireFile = debugPlatformWriteEntireFile;
+    context.memory.debugPlatformMapFile         = debugPlatformMapFile;
+    context.memory.debugPlatformUnmapFile       = debugPlatformUnmapFile;
+    context.memory.debugPlatformFlushMappedFile = debugPlatformFlushMappedFile;
+    context.memory.debugPlatformAppendToFile    = debugPlatformAppendToFile;
+    context.memory.debugPlatformSyncFile        = debugPlatformSyncFile;
+    context.memory.debugPlatformReplaceFile     = debugPlatformReplaceFile;
+
+    PlatformWorkQueue highPriorityQueue = {};
+    LinuxMakeQueue(&highPriorityQueue, LinuxGetWorkerThreadCount());
+
+    PlatformWorkQueue lowPriorityQueue = {};
+    LinuxMakeQueue(&lowPriorityQueue, 1);
+
+    context.memory.highPriorityQueue       = &highPriorityQueue;
+    context.memory.lowPriorityQueue        = &lowPriorityQueue;
+    context.memory.highPriorityWorkerCount = LinuxGetWorkerThreadCount();
+    context.memory.platformAddEntry        = LinuxAddEntry;
+    context.memory.platformCompleteAllWork = LinuxCompleteAllWork;
+    context.memory.platformMapReadOnlyFile = platformMapReadOnlyFile;
+    context.memory.platformUnmapFile       = platformUnmapFile;
+    context.memory.debugTable              = LinuxAllocateDebugTable();
+
+    uint64 totalSize = context.memory.permanentStorageSize + context.memory.transientStorageSize;
+    void *memoryBlock =
+        mmap(0, totalSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (memoryBlock == MAP_FAILED)
+    {
+        printf("Could not initialize bench memory\n");
+        return 1;
+    }
+
+    context.memory.permanentStorage = memoryBlock;
+    context.memory.transientStorage = (uint8 *)memoryBlock + context.memory.permanentStorageSize;
+
+    InitializeArena(&context.worldArena, context.memory.permanentStorageSize,
+                    (uint8 *)context.memory.permanentStorage);
+    InitializeArena(&context.tempArena, context.memory.transientStorageSize,
+                    (uint8 *)context.memory.transientStorage);
+
+    for (uint32 benchIndex = 0; benchIndex < ArrayCount(globalBenchmarks); ++benchIndex)
+    {
+        BenchEntry *bench = globalBenchmarks + benchIndex;
+
+        bool32 selected = argc <= 1;
+        for (int argIndex = 1; argIndex < argc; ++argIndex)
+        {
+            if (strcmp(args[argIndex], bench->name) == 0)
+            {
+                selected = true;
+            }
+        }
+
+        if (selected)
+        {
+            bench->run(&context);
+        }
+    }
+
+    int result = context.failed ? 1 : 0;
+    return result;
+}
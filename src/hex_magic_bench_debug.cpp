@@ -0,0 +1,673 @@
+struct BenchTimedBlockJob
+{
+    uint32 blockCount;
+    uint64 nanoseconds;
+};
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(BenchDoTimedBlockJob)
+{
+    BenchTimedBlockJob *job = (BenchTimedBlockJob *)data;
+    uint64 start            = BenchGetNanoseconds();
+
+    for (uint32 blockIndex = 0; blockIndex < job->blockCount; ++blockIndex)
+    {
+        TIMED_BLOCK("BenchTimedBlock");
+    }
+
+    job->nanoseconds = BenchGetNanoseconds() - start;
+}
+
+// NOTE counts the events the last collate left of the bench's own block, every begin has to have its end.
+internal uint64 BenchCountTimedBlockEvents(DebugTable *table, uint64 *unmatchedCount)
+{
+    uint64 result      = 0;
+    uint32 threadCount = table->threadCount < DEBUG_MAX_THREAD_COUNT ? table->threadCount : DEBUG_MAX_THREAD_COUNT;
+
+    for (uint32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        DebugThreadEvents *thread = table->threads + threadIndex;
+        DebugEvent *events        = thread->events[table->collatedArrayIndex];
+        int64 openCount           = 0;
+
+        for (uint32 eventIndex = 0; eventIndex < thread->collatedEventCount; ++eventIndex)
+        {
+            DebugEvent *event = events + eventIndex;
+            if (event->blockName && strcmp(event->blockName, "BenchTimedBlock") == 0)
+            {
+                openCount += event->type == DEBUG_EVENT_BEGIN_BLOCK ? 1 : -1;
+                ++result;
+            }
+        }
+
+        *unmatchedCount += openCount < 0 ? -openCount : openCount;
+        result += thread->droppedEventCount;
+    }
+
+    return result;
+}
+
+// NOTE what a timed block costs, on the main thread alone and on every worker at once, and that the events come out
+// the way they went in. One round of the workers also goes out as a Chrome trace.
+internal void BenchTimedBlocks(BenchContext *context)
+{
+    DebugTable *table = context->memory.debugTable;
+    globalDebugTable  = table;
+    LinuxDropDebugEvents(table);
+
+    // NOTE a begin and an end for every block, a thread can take a few jobs before the events run out.
+    uint32 blockCount = DEBUG_MAX_EVENT_COUNT / 8;
+    uint32 roundCount = 64;
+
+    uint64 lostCount      = 0;
+    uint64 unmatchedCount = 0;
+    uint64 nanoseconds    = 0;
+
+    for (uint32 roundIndex = 0; roundIndex < roundCount; ++roundIndex)
+    {
+        BenchTimedBlockJob job = {};
+        job.blockCount         = blockCount;
+
+        BenchDoTimedBlockJob(0, &job);
+        nanoseconds += job.nanoseconds;
+
+        LinuxCollateDebugEvents(table);
+        lostCount += 2 * (uint64)blockCount - BenchCountTimedBlockEvents(table, &unmatchedCount);
+    }
+
+    real64 singleTime = (real64)nanoseconds / ((real64)blockCount * roundCount);
+
+    uint32 workerCount       = LinuxGetWorkerThreadCount();
+    PlatformWorkQueue *queue = BenchGetQueue(workerCount);
+    uint32 jobCount          = workerCount ? workerCount : 1;
+
+    TemporaryMemory temp     = StartTemporaryMemory(&context->tempArena);
+    BenchTimedBlockJob *jobs = PushArray(&context->tempArena, jobCount, BenchTimedBlockJob);
+    LinuxDebugTrace *trace   = PushStruct(&context->tempArena, LinuxDebugTrace);
+
+    nanoseconds = 0;
+
+    for (uint32 roundIndex = 0; roundIndex < roundCount; ++roundIndex)
+    {
+        for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+        {
+            jobs[jobIndex]            = {};
+            jobs[jobIndex].blockCount = blockCount;
+
+            LinuxAddEntry(queue, BenchDoTimedBlockJob, jobs + jobIndex);
+        }
+
+        LinuxCompleteAllWork(queue);
+        LinuxCollateDebugEvents(table);
+
+        for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+        {
+            nanoseconds += jobs[jobIndex].nanoseconds;
+        }
+
+        lostCount += 2 * (uint64)blockCount * jobCount - BenchCountTimedBlockEvents(table, &unmatchedCount);
+
+        if (roundIndex == 0)
+        {
+            LinuxBeginDebugTrace(trace, "bench_timed.json");
+            LinuxTraceDebugEvents(trace, table);
+            LinuxEndDebugTrace(trace);
+        }
+    }
+
+    real64 workerTime = (real64)nanoseconds / ((real64)blockCount * roundCount * jobCount);
+
+    printf("timed blocks: %.1fns a block on one thread, %.1fns a block on %u threads at once, %u threads recorded\n",
+           singleTime, workerTime, jobCount, table->threadCount);
+    printf("timed check: %llu events lost, %llu blocks without an end\n", (unsigned long long)lostCount,
+           (unsigned long long)unmatchedCount);
+
+    EndTemporaryMemory(temp);
+    unlink("bench_timed.json");
+
+    globalDebugTable = 0;
+    LinuxDropDebugEvents(table);
+}
+
+enum BenchReplayScript
+{
+    BENCH_REPLAY_SCROLL,
+    BENCH_REPLAY_ZOOM,
+    BENCH_REPLAY_PAINT,
+    BENCH_REPLAY_ENTITIES,
+};
+
+struct BenchReplay
+{
+    char *name;
+    BenchReplayScript script;
+    uint32 frameCount;
+};
+
+// NOTE the replays are scripted input rather than recordings made with the platform layer. A recording starts from a
+// snapshot of game memory, which stops loading the moment a struct changes size, and a script keeps saying the same
+// thing about the game whatever its memory looks like.
+global BenchReplay globalBenchReplays[] = {
+    {"scroll", BENCH_REPLAY_SCROLL, 240},
+    {"zoom", BENCH_REPLAY_ZOOM, 240},
+    {"paint", BENCH_REPLAY_PAINT, 300},
+    {"entities", BENCH_REPLAY_ENTITIES, 300},
+};
+
+#define BENCH_REPLAY_RESULTS_FILE_NAME "replay_results.txt"
+#define BENCH_REPLAY_BASELINE_FILE_NAME "replay_baseline.txt"
+#define BENCH_REPLAY_DIRECTORY "bench_replay"
+
+// NOTE blocks that take less than this many megacycles a frame are mostly noise, they don't count as regressions.
+#define BENCH_REPLAY_BLOCK_NOISE_FLOOR 0.05
+
+inline void BenchSetButton(GameButtonState *button, bool32 isDown)
+{
+    if (button->endedDown != isDown)
+    {
+        button->endedDown = isDown;
+        ++button->halfTransitionCount;
+    }
+}
+
+// NOTE a button goes down on the frame it is pressed and back up on the next one.
+inline void BenchTapButton(GameButtonState *button, uint32 frameIndex, uint32 pressFrameIndex)
+{
+    BenchSetButton(button, frameIndex == pressFrameIndex);
+}
+
+internal void BenchScriptReplayInput(BenchReplay *replay, uint32 frameIndex, GameInput *input, int32 width,
+                                     int32 height)
+{
+    GameKeyboardInput *keyboard = &input->keyboard;
+    GameMouseInput *mouse       = &input->mouse;
+
+    for (uint32 buttonIndex = 0; buttonIndex < ArrayCount(keyboard->buttons); ++buttonIndex)
+    {
+        keyboard->buttons[buttonIndex].halfTransitionCount = 0;
+    }
+
+    for (uint32 buttonIndex = 0; buttonIndex < ArrayCount(mouse->buttons); ++buttonIndex)
+    {
+        mouse->buttons[buttonIndex].halfTransitionCount = 0;
+    }
+
+    input->dtForFrame = 1.0f / 60.0f;
+    mouse->wheel      = 0.0f;
+    mouse->x          = width / 2;
+    mouse->y          = height / 2;
+
+    uint32 frameCount = replay->frameCount;
+
+    switch (replay->script)
+    {
+        // NOTE zooms all the way out first, where the most hexes are on screen, then pushes the mouse against each
+        // edge in turn. The camera starts in the bottom left corner of the map, going right and up first keeps it over
+        // the map the whole way round.
+        case BENCH_REPLAY_SCROLL:
+        {
+            uint32 zoomFrameCount = 30;
+            uint32 edgeFrameCount = (frameCount - zoomFrameCount) / 4;
+
+            if (frameIndex < zoomFrameCount)
+            {
+                mouse->wheel = -1.0f;
+            }
+            else
+            {
+                uint32 edge = (frameIndex - zoomFrameCount) / edgeFrameCount;
+                if (edge == 0)
+                {
+                    mouse->x = width - 10;
+                }
+                else if (edge == 1)
+                {
+                    mouse->y = 10;
+                }
+                else if (edge == 2)
+                {
+                    mouse->x = 10;
+                }
+                else
+                {
+                    mouse->y = height - 10;
+                }
+            }
+        }
+        break;
+
+        // NOTE goes from the closest zoom to the furthest and back a couple of times.
+        case BENCH_REPLAY_ZOOM:
+        {
+            mouse->wheel = (frameIndex / 60) % 2 == 0 ? -1.0f : 1.0f;
+        }
+        break;
+
+        // NOTE switches to the editor, grows the brush and paints circles with it, then floods the middle of the
+        // screen.
+        case BENCH_REPLAY_PAINT:
+        {
+            uint32 floodFrameIndex = frameCount - 20;
+
+            BenchTapButton(&keyboard->toggleMode, frameIndex, 0);
+            BenchSetButton(&keyboard->actionUp, frameIndex >= 2 && frameIndex < 22 && frameIndex % 2 == 0);
+            BenchTapButton(&keyboard->nextBiome, frameIndex, floodFrameIndex / 2);
+            BenchTapButton(&keyboard->nextTool, frameIndex, floodFrameIndex);
+
+            if (frameIndex >= 24 && frameIndex < floodFrameIndex)
+            {
+                real32 angle = 0.1f * (real32)frameIndex;
+                real32 size  = 0.3f * (real32)height;
+
+                mouse->x = width / 2 + (int32)(size * Cos(angle));
+                mouse->y = height / 2 + (int32)(size * Sin(angle));
+                BenchSetButton(&mouse->lButton, true);
+            }
+            else
+            {
+                BenchTapButton(&mouse->lButton, frameIndex, floodFrameIndex + 2);
+            }
+        }
+        break;
+
+        // NOTE places heroes all over the screen in the editor, then goes back to play and ends turns while the mouse
+        // goes over them with one selected, which is what keeps the fog, the ranges and the paths busy.
+        case BENCH_REPLAY_ENTITIES:
+        {
+            uint32 playFrameIndex = frameCount / 2;
+
+            // NOTE the entity brush starts out on heroes once it has gone round every entity.
+            BenchTapButton(&keyboard->toggleMode, frameIndex, frameIndex < playFrameIndex ? 0 : playFrameIndex);
+            BenchSetButton(&keyboard->nextEntity, frameIndex >= 2 && frameIndex < 8 && frameIndex % 2 == 0);
+
+            // NOTE the mouse goes over the same spots again in play, where the heroes got placed.
+            uint32 spotIndex = frameIndex % playFrameIndex;
+            int32 marginX    = width / 8;
+            int32 marginY    = height / 8;
+            mouse->x         = marginX + (int32)((spotIndex * 97) % (uint32)(width - 2 * marginX));
+            mouse->y         = marginY + (int32)((spotIndex * 61) % (uint32)(height - 2 * marginY));
+
+            if (frameIndex < playFrameIndex)
+            {
+                BenchSetButton(&mouse->lButton, frameIndex >= 10 && frameIndex < playFrameIndex - 2);
+            }
+            else
+            {
+                BenchSetButton(&keyboard->endTurn, (frameIndex - playFrameIndex) % 10 == 5);
+                BenchTapButton(&mouse->lButton, frameIndex, playFrameIndex + 4);
+            }
+        }
+        break;
+    }
+}
+
+#define BENCH_MAX_BLOCK_COUNT 64
+#define BENCH_MAX_BLOCK_DEPTH 64
+
+// NOTE cycles and hits of every timed block, by name, over however many frames were added up.
+struct BenchBlockTotals
+{
+    uint32 blockCount;
+    char *blockNames[BENCH_MAX_BLOCK_COUNT];
+    uint64 cycleCounts[BENCH_MAX_BLOCK_COUNT];
+    uint64 hitCounts[BENCH_MAX_BLOCK_COUNT];
+};
+
+// NOTE pairs the events the last collate left up into blocks. A block that was still open when the frame ended, like a
+// job that runs for longer than that, is left out.
+internal void BenchAddDebugEvents(BenchBlockTotals *totals, DebugTable *table)
+{
+    uint32 threadCount = table->threadCount < DEBUG_MAX_THREAD_COUNT ? table->threadCount : DEBUG_MAX_THREAD_COUNT;
+
+    for (uint32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        DebugThreadEvents *thread = table->threads + threadIndex;
+        DebugEvent *events        = thread->events[table->collatedArrayIndex];
+
+        DebugEvent *openBlocks[BENCH_MAX_BLOCK_DEPTH];
+        uint32 depth = 0;
+
+        for (uint32 eventIndex = 0; eventIndex < thread->collatedEventCount; ++eventIndex)
+        {
+            DebugEvent *event = events + eventIndex;
+
+            if (event->type == DEBUG_EVENT_BEGIN_BLOCK)
+            {
+                if (depth < BENCH_MAX_BLOCK_DEPTH)
+                {
+                    openBlocks[depth] = event;
+                }
+
+                ++depth;
+            }
+            else if (depth > 0)
+            {
+                --depth;
+
+                if (depth < BENCH_MAX_BLOCK_DEPTH && openBlocks[depth]->blockName)
+                {
+                    DebugEvent *begin = openBlocks[depth];
+
+                    uint32 blockIndex = 0;
+                    while (blockIndex < totals->blockCount && strcmp(totals->blockNames[blockIndex], begin->blockName))
+                    {
+                        ++blockIndex;
+                    }
+
+                    if (blockIndex == totals->blockCount && blockIndex < BENCH_MAX_BLOCK_COUNT)
+                    {
+                        totals->blockNames[blockIndex] = begin->blockName;
+                        ++totals->blockCount;
+                    }
+
+                    if (blockIndex < totals->blockCount)
+                    {
+                        totals->cycleCounts[blockIndex] += event->clock - begin->clock;
+                        ++totals->hitCounts[blockIndex];
+                    }
+                }
+            }
+        }
+    }
+}
+
+struct BenchReplayResult
+{
+    real64 meanTime;
+    real64 medianTime;
+    real64 p95Time;
+    real64 maxTime;
+    uint64 stateHash;
+
+    BenchBlockTotals blocks;
+};
+
+// NOTE every replay boots the game from scratch in memory of its own, inside a directory of its own so the journal
+// starts out empty and the world is the generated one. The boot frame is left out of the timings, and so are the
+// blocks timed in it.
+internal BenchReplayResult BenchRunReplay(BenchContext *context, BenchReplay *replay, real64 *frameTimes)
+{
+    BenchReplayResult result = {};
+
+    GameMemory memory    = context->memory;
+    memory.isInitialized = false;
+
+    uint64 totalSize  = memory.permanentStorageSize + memory.transientStorageSize;
+    void *memoryBlock = mmap(0, totalSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    Assert(memoryBlock != MAP_FAILED);
+
+    memory.permanentStorage = memoryBlock;
+    memory.transientStorage = (uint8 *)memoryBlock + memory.permanentStorageSize;
+
+    int32 width  = 1280;
+    int32 height = 720;
+
+    GameOffscreenBuffer buffer = {};
+    buffer.width               = width;
+    buffer.height              = height;
+    buffer.pitch               = width * 4;
+    buffer.memory              = PushArray(&context->tempArena, (width * height), uint32);
+
+    GameInput input  = {};
+    input.dtForFrame = 1.0f / 60.0f;
+    input.mouse.x    = width / 2;
+    input.mouse.y    = height / 2;
+
+    gameUpdateAndRender(&context->thread, &memory, &input, &buffer);
+    LinuxDropDebugEvents(memory.debugTable);
+
+    for (uint32 frameIndex = 0; frameIndex < replay->frameCount; ++frameIndex)
+    {
+        BenchScriptReplayInput(replay, frameIndex, &input, width, height);
+
+        uint64 start = BenchGetNanoseconds();
+        gameUpdateAndRender(&context->thread, &memory, &input, &buffer);
+        frameTimes[frameIndex] = BenchMillisecondsSince(start);
+
+        LinuxCollateDebugEvents(memory.debugTable);
+        BenchAddDebugEvents(&result.blocks, memory.debugTable);
+
+        result.meanTime += frameTimes[frameIndex];
+    }
+
+    result.stateHash = memory.debugStateHash;
+    result.meanTime /= replay->frameCount;
+
+    // NOTE the journal writes its snapshots on the low priority queue.
+    memory.platformCompleteAllWork(memory.highPriorityQueue);
+    memory.platformCompleteAllWork(memory.lowPriorityQueue);
+
+    munmap(memoryBlock, totalSize);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    real64 *sorted       = PushArray(&context->tempArena, replay->frameCount, real64);
+    memcpy(sorted, frameTimes, replay->frameCount * sizeof(real64));
+
+    result.medianTime = BenchPercentile(sorted, replay->frameCount, 50.0);
+    result.p95Time    = BenchPercentile(sorted, replay->frameCount, 95.0);
+    result.maxTime    = sorted[replay->frameCount - 1];
+
+    EndTemporaryMemory(temp);
+
+    return result;
+}
+
+// NOTE finds the line that starts with prefix and returns what follows the prefix on it.
+internal char *BenchFindResultLine(char *contents, char *prefix)
+{
+    char *result        = 0;
+    size_t prefixLength = strlen(prefix);
+
+    for (char *line = contents; line && *line && !result;)
+    {
+        if (strncmp(line, prefix, prefixLength) == 0)
+        {
+            result = line + prefixLength;
+        }
+
+        line = strchr(line, '\n');
+        if (line)
+        {
+            ++line;
+        }
+    }
+
+    return result;
+}
+
+struct BenchResultWriter
+{
+    char *buffer;
+    MemoryIndex size;
+    MemoryIndex maxSize;
+};
+
+internal void BenchWriteResult(BenchResultWriter *writer, char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    int written = vsnprintf(writer->buffer + writer->size, writer->maxSize - writer->size, format, args);
+    Assert(written >= 0 && writer->size + written < writer->maxSize);
+    writer->size += written;
+
+    va_end(args);
+}
+
+internal void BenchClearReplayFiles(void)
+{
+    unlink(BENCH_REPLAY_DIRECTORY "/world.map");
+    unlink(BENCH_REPLAY_DIRECTORY "/world.map.tmp");
+    unlink(BENCH_REPLAY_DIRECTORY "/world.map.chunks");
+    unlink(BENCH_REPLAY_DIRECTORY "/world.log");
+}
+
+internal void BenchRemoveReplayDirectory(void)
+{
+    BenchClearReplayFiles();
+    unlink(BENCH_REPLAY_DIRECTORY "/assets");
+    rmdir(BENCH_REPLAY_DIRECTORY);
+}
+
+// NOTE plays the canonical replays through the whole game and writes what every frame took, and what the timed blocks
+// in it took, to replay_results.txt. When there is a replay_baseline.txt next to it, means and blocks that got slower
+// than the threshold allows are regressions and fail the run, and a replay that ends up in a different state than the
+// baseline did is reported, since its timings measure something else now.
+//
+// --threshold <percent> sets how much slower is still fine, 10% unless given. --save-baseline makes these results the
+// baseline.
+internal void BenchReplays(BenchContext *context)
+{
+    real64 threshold    = 10.0;
+    bool32 saveBaseline = false;
+
+    for (int argIndex = 1; argIndex < context->argc; ++argIndex)
+    {
+        if (strcmp(context->args[argIndex], "--threshold") == 0 && argIndex + 1 < context->argc)
+        {
+            threshold = atof(context->args[argIndex + 1]);
+        }
+        else if (strcmp(context->args[argIndex], "--save-baseline") == 0)
+        {
+            saveBaseline = true;
+        }
+    }
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    char *baseline           = 0;
+    DebugReadFileResult file = debugPlatformReadEntireFile(&context->thread, BENCH_REPLAY_BASELINE_FILE_NAME);
+    if (file.contents)
+    {
+        baseline = PushArray(&context->tempArena, (file.contentsSize + 1), char);
+        memcpy(baseline, file.contents, file.contentsSize);
+        baseline[file.contentsSize] = 0;
+
+        debugPlatformFreeFileMemory(&context->thread, file.contents);
+    }
+
+    BenchResultWriter writer = {};
+    writer.maxSize           = Megabytes(4);
+    writer.buffer            = PushArray(&context->tempArena, writer.maxSize, char);
+
+    // NOTE a run that got killed leaves its directory behind, removing it first starts every run from a clean one.
+    BenchRemoveReplayDirectory();
+    mkdir(BENCH_REPLAY_DIRECTORY, 0755);
+    symlink("../assets", BENCH_REPLAY_DIRECTORY "/assets");
+
+    uint32 regressionCount = 0;
+
+    for (uint32 replayIndex = 0; replayIndex < ArrayCount(globalBenchReplays); ++replayIndex)
+    {
+        BenchReplay *replay = globalBenchReplays + replayIndex;
+        real64 *frameTimes  = PushArray(&context->tempArena, replay->frameCount, real64);
+
+        int changedDirectory = chdir(BENCH_REPLAY_DIRECTORY);
+        Assert(changedDirectory == 0);
+
+        BenchReplayResult result = BenchRunReplay(context, replay, frameTimes);
+
+        changedDirectory = chdir("..");
+        Assert(changedDirectory == 0);
+
+        BenchClearReplayFiles();
+
+        printf("replay %s, %u frames: %.3fms a frame on average, %.3fms p50, %.3fms p95, %.3fms at most, state "
+               "%016llx\n",
+               replay->name, replay->frameCount, result.meanTime, result.medianTime, result.p95Time, result.maxTime,
+               (unsigned long long)result.stateHash);
+
+        BenchWriteResult(&writer, "replay %s frames %u mean %.4f p50 %.4f p95 %.4f max %.4f hash %016llx\n",
+                         replay->name, replay->frameCount, result.meanTime, result.medianTime, result.p95Time,
+                         result.maxTime, (unsigned long long)result.stateHash);
+
+        BenchBlockTotals *blocks = &result.blocks;
+        real64 frameCount        = (real64)replay->frameCount;
+
+        for (uint32 blockIndex = 0; blockIndex < blocks->blockCount; ++blockIndex)
+        {
+            BenchWriteResult(&writer, "block %s %s %.4f %.2f\n", replay->name, blocks->blockNames[blockIndex],
+                             (real64)blocks->cycleCounts[blockIndex] / (1000.0 * 1000.0) / frameCount,
+                             (real64)blocks->hitCounts[blockIndex] / frameCount);
+        }
+
+        for (uint32 frameIndex = 0; frameIndex < replay->frameCount; ++frameIndex)
+        {
+            BenchWriteResult(&writer, "frame %s %u %.4f\n", replay->name, frameIndex, frameTimes[frameIndex]);
+        }
+
+        if (baseline)
+        {
+            char prefix[128];
+            snprintf(prefix, sizeof(prefix), "replay %s ", replay->name);
+
+            char *line              = BenchFindResultLine(baseline, prefix);
+            real64 baseMeanTime     = 0;
+            unsigned long long hash = 0;
+
+            if (line &&
+                sscanf(line, "frames %*u mean %lf p50 %*f p95 %*f max %*f hash %llx", &baseMeanTime, &hash) == 2)
+            {
+                if (result.meanTime > baseMeanTime * (1.0 + threshold / 100.0))
+                {
+                    printf("replay %s REGRESSION: %.3fms a frame against %.3fms in the baseline\n", replay->name,
+                           result.meanTime, baseMeanTime);
+                    ++regressionCount;
+                }
+
+                if (hash != result.stateHash)
+                {
+                    printf("replay %s ended up in a different state than the baseline, it plays differently now\n",
+                           replay->name);
+                }
+            }
+            else
+            {
+                printf("replay %s is not in the baseline\n", replay->name);
+            }
+
+            for (uint32 blockIndex = 0; blockIndex < blocks->blockCount; ++blockIndex)
+            {
+                snprintf(prefix, sizeof(prefix), "block %s %s ", replay->name, blocks->blockNames[blockIndex]);
+
+                line              = BenchFindResultLine(baseline, prefix);
+                real64 baseCycles = 0;
+                real64 cycles     = (real64)blocks->cycleCounts[blockIndex] / (1000.0 * 1000.0) / frameCount;
+
+                if (line && sscanf(line, "%lf", &baseCycles) == 1 && cycles > BENCH_REPLAY_BLOCK_NOISE_FLOOR &&
+                    cycles > baseCycles * (1.0 + threshold / 100.0))
+                {
+                    printf("replay %s REGRESSION in %s: %.3f megacycles a frame against %.3f in the baseline\n",
+                           replay->name, blocks->blockNames[blockIndex], cycles, baseCycles);
+                    ++regressionCount;
+                }
+            }
+        }
+    }
+
+    unlink(BENCH_REPLAY_DIRECTORY "/assets");
+    rmdir(BENCH_REPLAY_DIRECTORY);
+
+    // NOTE the game left its table behind, nothing else the bench runs should record into it.
+    globalDebugTable = 0;
+    LinuxDropDebugEvents(context->memory.debugTable);
+
+    debugPlatformWriteEntireFile(&context->thread, BENCH_REPLAY_RESULTS_FILE_NAME, (uint32)writer.size, writer.buffer);
+
+    if (saveBaseline)
+    {
+        debugPlatformWriteEntireFile(&context->thread, BENCH_REPLAY_BASELINE_FILE_NAME, (uint32)writer.size,
+                                     writer.buffer);
+        printf("replay results saved as the baseline\n");
+    }
+    else if (baseline)
+    {
+        printf("replay check: %u regressions over %.0f%% against the baseline\n", regressionCount, threshold);
+    }
+
+    if (regressionCount)
+    {
+        context->failed = true;
+    }
+
+    EndTemporaryMemory(temp);
+}
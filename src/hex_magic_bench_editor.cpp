@@ -0,0 +1,537 @@
+// NOTE plays back a few seconds of painting at 60 frames per second, saving every second. Saving used to write the
+// whole map on the main thread, the journal only stages the snapshot there and leaves the disk to the low priority
+// queue, so the frame times are what matters. Sync times are the fsync calls alone.
+internal void BenchJournal(BenchContext *context)
+{
+    int32 sizes[]       = {512, 1024};
+    int32 frameCount    = 180;
+    int32 framesPerSave = 60;
+    real32 dt           = 1.0f / 60.0f;
+    real64 cyclesPerMs  = BenchCyclesPerMillisecond();
+    char *names[]       = {"synchronous save", "journal"};
+
+    for (uint32 runIndex = 0; runIndex < 2 * ArrayCount(sizes); ++runIndex)
+    {
+        int32 size        = sizes[runIndex / 2];
+        uint32 modeIndex  = runIndex % 2;
+        bool32 useJournal = modeIndex == 1;
+
+        unlink("bench_journal.map");
+        unlink("bench_journal.log");
+
+        World *world = BenchCreateWorld(context, size, size);
+        BenchPaintBlobs(context, world, (uint32)(size * size / 200), 12);
+
+        TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+        Editor editor    = BenchCreateEditor(context, "bench_journal", Megabytes(64));
+        Journal *journal = editor.journal;
+
+        real64 totalFrame    = 0.0;
+        real64 worstFrame    = 0.0;
+        real64 worstStage    = 0.0;
+        real64 appendTime    = 0.0;
+        real64 appendSync    = 0.0;
+        real64 snapshotTime  = 0.0;
+        real64 snapshotSync  = 0.0;
+        uint32 seenFlushes   = 0;
+        uint32 seenSnapshots = 0;
+
+        for (int32 frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+        {
+            uint64 start = BenchGetNanoseconds();
+
+            BenchPaintBrush(context, useJournal ? &editor : 0, world, frameIndex);
+
+            bool32 save = (frameIndex + 1) % framesPerSave == 0;
+            if (useJournal)
+            {
+                if (save)
+                {
+                    RequestJournalSnapshot(journal);
+                }
+
+                UpdateJournal(journal, world, dt);
+            }
+            else if (save)
+            {
+                SaveWorldMap(&context->thread, &context->memory, world, &context->tempArena, "bench_journal.map");
+            }
+
+            real64 frameTime = BenchMillisecondsSince(start);
+            totalFrame += frameTime;
+            worstFrame = BenchMaximum(worstFrame, frameTime);
+
+            if (useJournal && !journal->isBusy)
+            {
+                worstStage = BenchMaximum(worstStage, journal->stageCycles / cyclesPerMs);
+
+                if (journal->flushCount != seenFlushes)
+                {
+                    appendTime += journal->appendCycles / cyclesPerMs;
+                    appendSync += journal->appendSyncCycles / cyclesPerMs;
+                    seenFlushes = journal->flushCount;
+                }
+
+                if (journal->snapshotCount != seenSnapshots)
+                {
+                    snapshotTime += journal->snapshotCycles / cyclesPerMs;
+                    snapshotSync += journal->snapshotSyncCycles / cyclesPerMs;
+                    seenSnapshots = journal->snapshotCount;
+                }
+            }
+
+            real64 frameLeft = dt * 1000.0 - BenchMillisecondsSince(start);
+            if (frameLeft > 0.0)
+            {
+                usleep((useconds_t)(frameLeft * 1000.0));
+            }
+        }
+
+        printf("journal %dx%d %s: frame mean %.3fms worst %.3fms", size, size, names[modeIndex],
+               totalFrame / frameCount, worstFrame);
+
+        if (useJournal)
+        {
+            // NOTE paints a cell of the first row once it is already in the snapshot being staged, only the journal
+            // can still carry it into the snapshot. The log is cut once the snapshot is written, so the replay below
+            // is only right if it did.
+            FlushJournal(journal, world);
+            RequestJournalSnapshot(journal);
+            UpdateJournal(journal, world, dt);
+
+            Cell *cell = GetCell(world, OffsetCoord{1, 1});
+            BeginUndoStroke(editor.undo);
+            EditorPaintCell(&editor, world, cell, (Biome)((cell->biome + 1) % BIOME_COUNT));
+            EndUndoStroke(editor.undo);
+
+            uint32 stagedFrameCount = 1;
+            while (journal->snapshotCount == seenSnapshots)
+            {
+                UpdateJournal(journal, world, dt);
+                FinishJournalWork(journal);
+                ++stagedFrameCount;
+            }
+
+            FlushJournal(journal, world);
+
+            printf(", snapshot staged over %u frames", stagedFrameCount);
+            printf(", staging worst %.3fms, %u appends %.3fms + fsync %.3fms, %u snapshots %.3fms + fsync %.3fms",
+                   worstStage, seenFlushes, appendTime, appendSync, seenSnapshots, snapshotTime, snapshotSync);
+
+            // NOTE the world has to come back from the last snapshot and the log exactly as it was painted.
+            MapSnapshot painted = CaptureMapSnapshot(world, &context->tempArena);
+            World *replayed     = LoadJournaledWorld(&context->thread, journal, &context->worldArena, world);
+            MapSnapshot loaded  = CaptureMapSnapshot(replayed, &context->tempArena);
+
+            bool32 matches = painted.entityCount == loaded.entityCount &&
+                             memcmp(painted.biomes, loaded.biomes, (MemoryIndex)size * size) == 0;
+            printf(", replay %s", matches ? "matches" : "DIFFERS");
+
+            // NOTE big maps come back paged, so painting on and snapshotting again goes through the chunk log.
+            if (replayed && replayed->pager)
+            {
+                for (int32 frameIndex = 0; frameIndex < framesPerSave; ++frameIndex)
+                {
+                    BenchPaintBrush(context, &editor, replayed, frameIndex + frameCount);
+                }
+
+                FinishJournalWork(journal);
+                StartJournalJob(journal, replayed, true);
+                FinishJournalWork(journal);
+
+                painted  = CaptureMapSnapshot(replayed, &context->tempArena);
+                replayed = LoadJournaledWorld(&context->thread, journal, &context->worldArena, replayed);
+                loaded   = CaptureMapSnapshot(replayed, &context->tempArena);
+
+                matches = !journal->lastJobFailed && painted.entityCount == loaded.entityCount &&
+                          memcmp(painted.biomes, loaded.biomes, (MemoryIndex)size * size) == 0;
+                printf(", paged snapshot %s", matches ? "matches" : "DIFFERS");
+            }
+
+            if (replayed && replayed->pager)
+            {
+                context->memory.debugPlatformUnmapFile(&context->thread, &replayed->pager->file);
+            }
+        }
+
+        printf("\n");
+
+        EndTemporaryMemory(temp);
+    }
+
+    unlink("bench_journal.map");
+    unlink("bench_journal.log");
+    unlink("bench_journal.map.chunks");
+}
+
+// NOTE paints a filled hexagon of the given radius in one stroke, row by row like the fill tools would.
+internal void BenchPaintHexagonStroke(Editor *editor, World *world, int32 centerX, int32 centerY, int32 radius,
+                                      Biome biome)
+{
+    BeginUndoStroke(editor->undo);
+
+    Cell *center = GetCell(world, OffsetCoord{centerX, centerY});
+    for (HexSpanIterator it = BeginHexSpans(center->coord, radius, 1, 1, world->width - 1, world->height - 1);
+         !it.isDone; NextHexSpan(&it))
+    {
+        for (int32 x = it.minX; x <= it.maxX; ++x)
+        {
+            EditorPaintCell(editor, world, GetCell(world, OffsetCoord{x, it.y}), biome);
+        }
+    }
+
+    EndUndoStroke(editor->undo);
+}
+
+internal void BenchUndo(BenchContext *context)
+{
+    int32 size   = 1024;
+    World *world = BenchCreateWorld(context, size, size);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    Editor editor = BenchCreateEditor(context, "bench_undo", Megabytes(64));
+
+    MapSnapshot before = CaptureMapSnapshot(world, &context->tempArena);
+
+    // NOTE a radius 182 hexagon is just under 100k cells.
+    uint64 start = BenchGetNanoseconds();
+    BenchPaintHexagonStroke(&editor, world, size / 2, size / 2, 182, GRASS);
+    real64 paintTime = BenchMillisecondsSince(start);
+
+    MemoryIndex strokeMemory = GetUndoMemoryUsed(editor.undo);
+    MapSnapshot painted      = CaptureMapSnapshot(world, &context->tempArena);
+
+    start = BenchGetNanoseconds();
+    EditorUndo(&editor, world);
+    real64 undoTime = BenchMillisecondsSince(start);
+
+    MapSnapshot undone = CaptureMapSnapshot(world, &context->tempArena);
+
+    start = BenchGetNanoseconds();
+    EditorRedo(&editor, world);
+    real64 redoTime = BenchMillisecondsSince(start);
+
+    MapSnapshot redone = CaptureMapSnapshot(world, &context->tempArena);
+
+    MemoryIndex cellCount = (MemoryIndex)size * size;
+    bool32 matches        = memcmp(before.biomes, undone.biomes, cellCount) == 0 &&
+                     memcmp(painted.biomes, redone.biomes, cellCount) == 0;
+
+    printf("undo %dx%d: %u cell stroke painted %.3fms, undo %.3fms, redo %.3fms, %zu KB of history, %s\n", size,
+           size, (uint32)(strokeMemory / sizeof(UndoRecord)) - 2, paintTime, undoTime, redoTime, strokeMemory / 1024,
+           matches ? "round trip matches" : "round trip DIFFERS");
+
+    FlushJournal(editor.journal, world);
+    EndTemporaryMemory(temp);
+
+    // NOTE with a 1MB cap the ring holds 128k records, so only the last dozen 10k cell strokes stay undoable.
+    temp   = StartTemporaryMemory(&context->tempArena);
+    editor = BenchCreateEditor(context, "bench_undo", Megabytes(1));
+
+    uint32 strokeCount = 30;
+    for (uint32 strokeIndex = 0; strokeIndex < strokeCount; ++strokeIndex)
+    {
+        BenchPaintHexagonStroke(&editor, world, 100 + 25 * strokeIndex, 300, 57,
+                                (Biome)(1 + strokeIndex % (BIOME_COUNT - 1)));
+    }
+
+    uint32 undoableCount = 0;
+    while (PopUndoStroke(editor.undo).count)
+    {
+        ++undoableCount;
+    }
+
+    // NOTE a fill of the whole world doesn't fit in the history, so it can't be undone, but the strokes before it
+    // still can.
+    for (uint32 strokeIndex = 0; strokeIndex < undoableCount; ++strokeIndex)
+    {
+        PopRedoStroke(editor.undo);
+    }
+
+    BeginUndoStroke(editor.undo);
+    FillSpanList worldSpans = MakeFillSpanList(&context->tempArena, size);
+    RectangleFillSpans(world, OffsetCoord{1, 1}, OffsetCoord{size - 1, size - 1}, &worldSpans);
+    EditorFillSpans(&editor, world, &context->memory, &context->tempArena, &worldSpans, SWAMP);
+    EndUndoStroke(editor.undo);
+
+    uint32 keptCount = 0;
+    while (PopUndoStroke(editor.undo).count)
+    {
+        ++keptCount;
+    }
+
+    printf("undo capped at %zu KB: %u of %u strokes undoable, %u still after a %llu cell fill\n",
+           GetUndoMemoryCap(editor.undo) / 1024, undoableCount, strokeCount, keptCount,
+           (unsigned long long)worldSpans.cellCount);
+
+    FlushJournal(editor.journal, world);
+    EndTemporaryMemory(temp);
+
+    // NOTE placing an entity and undoing it over and over has to give the slot back every time, and redo has to link
+    // the same entity again.
+    temp   = StartTemporaryMemory(&context->tempArena);
+    editor = BenchCreateEditor(context, "bench_undo", Megabytes(1));
+
+    uint32 startEntityCount = world->entityCount;
+    uint32 cycleCount       = 4 * ArrayCount(world->entities);
+    uint32 relinkedCount    = 0;
+
+    for (uint32 cycleIndex = 0; cycleIndex < cycleCount; ++cycleIndex)
+    {
+        Cell *cell      = GetCell(world, OffsetCoord{100 + (int32)(cycleIndex % 64), 700 + (int32)(cycleIndex / 64)});
+        EntityType type = (EntityType)(cycleIndex % (ENTITY_CITY + 1));
+
+        BeginUndoStroke(editor.undo);
+        EditorPlaceEntity(&editor, world, cell, type);
+        EndUndoStroke(editor.undo);
+
+        uint32 entityIndex = *GetCellEntitySlot(cell, type);
+
+        EditorUndo(&editor, world);
+
+        if (cycleIndex % 2)
+        {
+            EditorRedo(&editor, world);
+            relinkedCount += entityIndex && *GetCellEntitySlot(cell, type) == entityIndex;
+
+            EditorUndo(&editor, world);
+        }
+    }
+
+    bool32 entitiesFreed = world->entityCount == startEntityCount && relinkedCount == cycleCount / 2;
+
+    printf("undo %u entity placements: table at %u of %u, %u of %u redone in place, %s\n", cycleCount,
+           world->entityCount, startEntityCount, relinkedCount, cycleCount / 2,
+           entitiesFreed ? "slots freed" : "slots LEAKED");
+
+    if (!entitiesFreed)
+    {
+        context->failed = true;
+    }
+
+    FlushJournal(editor.journal, world);
+    EndTemporaryMemory(temp);
+
+    unlink("bench_undo.log");
+}
+
+inline uint64 BenchCountBiome(World *world, Biome biome)
+{
+    uint64 result = 0;
+
+    MemoryIndex cellCount = (MemoryIndex)world->width * world->height;
+    for (MemoryIndex cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+    {
+        result += world->cells[cellIndex].biome == biome;
+    }
+
+    return result;
+}
+
+// NOTE times the fill tools on a world with a roughly 1M cell grass hexagon in the middle, peppered with rock so the
+// flood fill has to work around holes. Fills are timed end to end, the way a click in the editor would run them.
+internal void BenchFill(BenchContext *context)
+{
+    int32 size   = 2048;
+    World *world = BenchCreateWorld(context, size, size);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    Editor editor = BenchCreateEditor(context, "bench_fill", Megabytes(64));
+
+    FillSpanList hexagon = MakeFillSpanList(&context->tempArena, 2 * 577 + 1);
+    HexagonFillSpans(world, world->cells[(size / 2) * size + size / 2].coord, 577, &hexagon);
+
+    for (uint32 spanIndex = 0; spanIndex < hexagon.count; ++spanIndex)
+    {
+        FillSpan *span = hexagon.spans + spanIndex;
+        Cell *cell     = world->cells + (MemoryIndex)span->y * size + span->minX;
+
+        for (int32 x = span->minX; x <= span->maxX; ++x)
+        {
+            (cell++)->biome = GRASS;
+        }
+    }
+
+    for (uint32 holeIndex = 0; holeIndex < 2000; ++holeIndex)
+    {
+        FillSpan *span = hexagon.spans + BenchRandomBetween(context, 0, hexagon.count - 1);
+        int32 x        = BenchRandomBetween(context, span->minX, span->maxX);
+
+        world->cells[(MemoryIndex)span->y * size + x].biome = ROCK;
+    }
+
+    uint64 grassCount  = BenchCountBiome(world, GRASS);
+    MapSnapshot before = CaptureMapSnapshot(world, &context->tempArena);
+
+    BeginUndoStroke(editor.undo);
+
+    uint64 start       = BenchGetNanoseconds();
+    FillSpanList spans = MakeFillSpanList(&context->tempArena, FILL_MAX_SPAN_COUNT);
+    FloodFillSpans(world, OffsetCoord{size / 2, size / 2}, &spans, &context->tempArena);
+    real64 searchTime = BenchMillisecondsSince(start);
+
+    start = BenchGetNanoseconds();
+    EditorFillSpans(&editor, world, &context->memory, &context->tempArena, &spans, DIRT);
+    real64 applyTime = BenchMillisecondsSince(start);
+
+    EndUndoStroke(editor.undo);
+
+    uint64 filledCount = BenchCountBiome(world, DIRT);
+
+    start = BenchGetNanoseconds();
+    EditorUndo(&editor, world);
+    real64 undoTime = BenchMillisecondsSince(start);
+
+    MapSnapshot undone = CaptureMapSnapshot(world, &context->tempArena);
+    bool32 matches     = memcmp(before.biomes, undone.biomes, (MemoryIndex)size * size) == 0;
+
+    printf("fill %dx%d flood: %u spans, %llu of %llu cells, search %.3fms, apply %.3fms, total %.3fms, undo %.3fms, "
+           "%s, %s\n",
+           size, size, spans.count, (unsigned long long)spans.cellCount, (unsigned long long)grassCount, searchTime,
+           applyTime, searchTime + applyTime, undoTime, filledCount == grassCount ? "filled all" : "MISSED cells",
+           matches ? "undo matches" : "undo DIFFERS");
+
+    BeginUndoStroke(editor.undo);
+
+    start                  = BenchGetNanoseconds();
+    FillSpanList rectSpans = MakeFillSpanList(&context->tempArena, 1000);
+    RectangleFillSpans(world, OffsetCoord{500, 500}, OffsetCoord{1499, 1499}, &rectSpans);
+    EditorFillSpans(&editor, world, &context->memory, &context->tempArena, &rectSpans, SAND);
+    real64 rectTime = BenchMillisecondsSince(start);
+
+    EndUndoStroke(editor.undo);
+
+    V2 vertices[6];
+    for (uint32 vertexIndex = 0; vertexIndex < ArrayCount(vertices); ++vertexIndex)
+    {
+        real32 angle          = 2.0f * PI32 * vertexIndex / ArrayCount(vertices);
+        V2 center             = world->cells[(size / 2) * size + size / 2].position;
+        vertices[vertexIndex] = center + 900.0f * V2{cosf(angle), sinf(angle)};
+    }
+
+    BeginUndoStroke(editor.undo);
+
+    start                     = BenchGetNanoseconds();
+    FillSpanList polygonSpans = MakeFillSpanList(&context->tempArena, size * 3);
+    PolygonFillSpans(world, vertices, ArrayCount(vertices), &polygonSpans, &context->tempArena);
+    EditorFillSpans(&editor, world, &context->memory, &context->tempArena, &polygonSpans, SNOW);
+    real64 polygonTime = BenchMillisecondsSince(start);
+
+    EndUndoStroke(editor.undo);
+
+    printf("fill rectangle: %llu cells %.3fms, polygon: %llu cells %.3fms, %u worker threads\n",
+           (unsigned long long)rectSpans.cellCount, rectTime, (unsigned long long)polygonSpans.cellCount,
+           polygonTime, LinuxGetWorkerThreadCount());
+
+    // NOTE the old brush looked every cell up through GetCell and recorded cell by cell, spans walk rows of cells
+    // directly and record runs. Both paint over what the other just painted, so every cell changes every time, and
+    // the best of a few rounds is kept.
+    int32 radius      = 200;
+    real64 lookupTime = 1e9;
+    real64 spanTime   = 1e9;
+
+    FillSpanList brushSpans = MakeFillSpanList(&context->tempArena, 2 * radius + 1);
+    HexagonFillSpans(world, world->cells[(size / 2) * size + size / 2].coord, radius, &brushSpans);
+
+    for (uint32 roundIndex = 0; roundIndex < 5; ++roundIndex)
+    {
+        start = BenchGetNanoseconds();
+        BenchPaintHexagonStroke(&editor, world, size / 2, size / 2, radius, GRASS);
+        lookupTime = BenchMinimum(lookupTime, BenchMillisecondsSince(start));
+
+        BeginUndoStroke(editor.undo);
+
+        start = BenchGetNanoseconds();
+        EditorPaintSpans(&editor, world, &brushSpans, DIRT);
+        spanTime = BenchMinimum(spanTime, BenchMillisecondsSince(start));
+
+        EndUndoStroke(editor.undo);
+    }
+
+    printf("fill brush radius %d: %llu cells, per cell lookups %.3fms, spans %.3fms\n", radius,
+           (unsigned long long)brushSpans.cellCount, lookupTime, spanTime);
+
+    FlushJournal(editor.journal, world);
+    EndTemporaryMemory(temp);
+
+    unlink("bench_fill.log");
+}
+
+// NOTE drags the brush around a circle at 30 frames per second, fast enough that the mouse jumps about 14 cells a
+// frame. Painting only where the mouse was leaves gaps unless the brush is wide enough to cover them, interpolated
+// strokes paint the whole path and write each cell once however wide the brush is.
+internal void BenchStroke(BenchContext *context)
+{
+    int32 size   = 1024;
+    World *world = BenchCreateWorld(context, size, size);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    Editor editor      = BenchCreateEditor(context, "bench_stroke", Megabytes(64));
+    real64 cyclesPerMs = BenchCyclesPerMillisecond();
+
+    uint32 frameCount = 90;
+    HexCoord *samples = PushArray(&context->tempArena, frameCount, HexCoord);
+    V2 center         = world->cells[(size / 2) * size + size / 2].position;
+
+    for (uint32 frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+    {
+        real32 angle = 2.0f * PI32 * frameIndex / frameCount;
+
+        samples[frameIndex] = V2ToHex(center + 350.0f * V2{cosf(angle), sinf(angle)});
+    }
+
+    int32 radii[] = {1, 4, 7, 300};
+    for (uint32 radiusIndex = 0; radiusIndex < ArrayCount(radii); ++radiusIndex)
+    {
+        editor.brushSize   = radii[radiusIndex];
+        Biome sampledBiome = (Biome)(1 + 2 * radiusIndex);
+        Biome strokeBiome  = (Biome)(2 + 2 * radiusIndex);
+
+        uint64 sampledVisits = 0;
+        uint64 start         = BenchGetNanoseconds();
+
+        BeginUndoStroke(editor.undo);
+        for (uint32 frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+        {
+            TemporaryMemory spanMemory = StartTemporaryMemory(&context->tempArena);
+
+            FillSpanList spans = MakeFillSpanList(&context->tempArena, 2 * editor.brushSize + 1);
+            HexagonFillSpans(world, samples[frameIndex], editor.brushSize, &spans);
+            EditorPaintSpans(&editor, world, &spans, sampledBiome);
+
+            sampledVisits += spans.cellCount;
+
+            EndTemporaryMemory(spanMemory);
+        }
+        EndUndoStroke(editor.undo);
+
+        real64 sampledTime  = BenchMillisecondsSince(start);
+        uint64 sampledCount = BenchCountBiome(world, sampledBiome);
+
+        BeginUndoStroke(editor.undo);
+        EditorBeginBrushStroke(&editor, world, &context->tempArena, samples[0]);
+        for (uint32 frameIndex = 0; frameIndex <= frameCount; ++frameIndex)
+        {
+            EditorBrushStrokeTo(&editor, world, &context->tempArena, samples[frameIndex % frameCount], strokeBiome);
+        }
+        EditorEndBrushStroke(&editor);
+        EndUndoStroke(editor.undo);
+
+        real64 strokeTime = editor.strokeCycles / cyclesPerMs;
+
+        printf("stroke radius %d, %u frames: sampled %llu cells painted from %llu visits %.3fms, interpolated %llu "
+               "cells painted with %u writes %.3fms (%.3fms a frame)\n",
+               editor.brushSize, frameCount, (unsigned long long)sampledCount, (unsigned long long)sampledVisits,
+               sampledTime, (unsigned long long)BenchCountBiome(world, strokeBiome), editor.strokeCellCount,
+               strokeTime, strokeTime / frameCount);
+    }
+
+    FlushJournal(editor.journal, world);
+    EndTemporaryMemory(temp);
+
+    unlink("bench_stroke.log");
+}
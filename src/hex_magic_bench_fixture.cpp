@@ -0,0 +1,284 @@
+// NOTE everything the benches share. The context holds the memory every bench runs in, worlds get rebuilt from
+// scratch at the start of the world arena, and everything else goes into the temp arena between temporary memory
+// markers.
+
+struct BenchContext
+{
+    ThreadContext thread;
+    GameMemory memory;
+
+    MemoryArena worldArena;
+    MemoryArena tempArena;
+
+    uint32 randomState;
+
+    int argc;
+    char **args;
+
+    // NOTE set by benches that check against a baseline, makes the bench exit with an error.
+    bool32 failed;
+};
+
+inline uint64 BenchGetNanoseconds()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    uint64 result = (uint64)time.tv_sec * 1000 * 1000 * 1000 + (uint64)time.tv_nsec;
+    return result;
+}
+
+inline real64 BenchMillisecondsSince(uint64 start)
+{
+    real64 result = (real64)(BenchGetNanoseconds() - start) / (1000.0 * 1000.0);
+    return result;
+}
+
+#define BENCH_MAX_QUEUE_COUNT 8
+
+// NOTE worker threads wait on their queue for as long as the bench runs, so queues can't live in memory that gets
+// reused. Benches that want a given number of workers share the one queue made for it.
+global PlatformWorkQueue globalBenchQueues[BENCH_MAX_QUEUE_COUNT];
+global uint32 globalBenchQueueWorkerCounts[BENCH_MAX_QUEUE_COUNT];
+global uint32 globalBenchQueueCount;
+
+internal PlatformWorkQueue *BenchGetQueue(uint32 workerCount)
+{
+    PlatformWorkQueue *result = 0;
+
+    for (uint32 queueIndex = 0; queueIndex < globalBenchQueueCount; ++queueIndex)
+    {
+        if (globalBenchQueueWorkerCounts[queueIndex] == workerCount)
+        {
+            result = globalBenchQueues + queueIndex;
+        }
+    }
+
+    if (!result)
+    {
+        Assert(globalBenchQueueCount < BENCH_MAX_QUEUE_COUNT);
+
+        result                                              = globalBenchQueues + globalBenchQueueCount;
+        globalBenchQueueWorkerCounts[globalBenchQueueCount] = workerCount;
+        ++globalBenchQueueCount;
+
+        LinuxMakeQueue(result, workerCount);
+    }
+
+    return result;
+}
+
+// NOTE runs on more threads than there are cores only take turns on the same cores, their times show what the extra
+// threads cost and not how the work scales. Benches that compare thread counts print this ahead of their runs.
+internal void BenchPrintCoreCount(char *name, uint32 maxThreadCount)
+{
+    uint32 coreCount = LinuxGetWorkerThreadCount() + 1;
+
+    if (coreCount < maxThreadCount)
+    {
+        printf("%s: cores online %u, runs on more threads than that do not show scaling\n", name, coreCount);
+    }
+    else
+    {
+        printf("%s: cores online %u\n", name, coreCount);
+    }
+}
+
+inline real64 BenchMinimum(real64 a, real64 b)
+{
+    real64 result = a < b ? a : b;
+    return result;
+}
+
+inline real64 BenchMaximum(real64 a, real64 b)
+{
+    real64 result = a > b ? a : b;
+    return result;
+}
+
+inline uint32 BenchRandom(BenchContext *context)
+{
+    uint32 x = context->randomState;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    context->randomState = x;
+    return x;
+}
+
+inline int32 BenchRandomBetween(BenchContext *context, int32 min, int32 max)
+{
+    int32 result = min + (int32)(BenchRandom(context) % (uint32)(max - min + 1));
+    return result;
+}
+
+global char *globalHexBatchPathNames[] = {"unknown", "scalar", "sse2", "avx2"};
+
+internal World *BenchCreateWorld(BenchContext *context, int32 width, int32 height)
+{
+    MemoryArena *arena = &context->worldArena;
+    arena->used        = 0;
+
+    World *world = CreateWorld(arena, width, height);
+
+    Cell *cell = world->cells;
+    for (int32 y = 0; y < height; ++y)
+    {
+        for (int32 x = 0; x < width; ++x)
+        {
+            InitializeCell(cell++, x, y, WATER);
+        }
+    }
+
+    AddEntity(world);
+
+    return world;
+}
+
+// NOTE paints hexagonal blobs of random biomes, which gives runs that look roughly like a hand painted map.
+internal void BenchPaintBlobs(BenchContext *context, World *world, uint32 blobCount, int32 maxRadius)
+{
+    for (uint32 blobIndex = 0; blobIndex < blobCount; ++blobIndex)
+    {
+        int32 centerX = BenchRandomBetween(context, 0, world->width - 1);
+        int32 centerY = BenchRandomBetween(context, 0, world->height - 1);
+        int32 radius  = BenchRandomBetween(context, 1, maxRadius);
+        Biome biome   = (Biome)BenchRandomBetween(context, 0, BIOME_COUNT - 1);
+
+        for (int32 dy = -radius; dy <= radius; ++dy)
+        {
+            int32 y = centerY + dy;
+            if (y < 0 || y >= world->height)
+            {
+                continue;
+            }
+
+            int32 halfWidth = radius - (int32)Abs(dy) / 2;
+            int32 minX      = Max(0, centerX - halfWidth);
+            int32 maxX      = Min(world->width - 1, centerX + halfWidth);
+
+            Cell *cell = world->cells + (MemoryIndex)y * world->width + minX;
+            for (int32 x = minX; x <= maxX; ++x)
+            {
+                (cell++)->biome = biome;
+            }
+        }
+    }
+}
+
+internal void BenchPlaceEntities(BenchContext *context, World *world, uint32 count)
+{
+    for (uint32 entityIndex = 0; entityIndex < count; ++entityIndex)
+    {
+        OffsetCoord offset = {BenchRandomBetween(context, 1, world->width - 1),
+                              BenchRandomBetween(context, 1, world->height - 1)};
+
+        Cell *cell = GetCell(world, offset);
+        if (cell && world->entityCount + 1 < ArrayCount(world->entities))
+        {
+            PlaceEntity(world, cell, (EntityType)BenchRandomBetween(context, 0, ENTITY_CITY));
+        }
+    }
+}
+
+inline real64 BenchCyclesPerMillisecond()
+{
+    uint64 start       = BenchGetNanoseconds();
+    uint64 startCycles = __rdtsc();
+
+    usleep(20 * 1000);
+
+    real64 result = (real64)(__rdtsc() - startCycles) / BenchMillisecondsSince(start);
+    return result;
+}
+
+internal Editor BenchCreateEditor(BenchContext *context, char *journalName, MemoryIndex undoMemoryCap)
+{
+    Editor result = {};
+
+    result.journal = PushStruct(&context->tempArena, Journal);
+    InitializeJournal(result.journal, &context->memory, &context->tempArena, Megabytes(64), journalName);
+
+    result.undo = PushStruct(&context->tempArena, UndoHistory);
+    InitializeUndoHistory(result.undo, &context->tempArena, undoMemoryCap);
+
+    return result;
+}
+
+internal void BenchPaintBrush(BenchContext *context, Editor *editor, World *world, int32 frameIndex)
+{
+    int32 span   = world->width - 40;
+    Cell *center = GetCell(world, OffsetCoord{20 + (frameIndex * 3) % span, 20 + (frameIndex * 7) % span});
+    Biome biome  = (Biome)((frameIndex / 20) % BIOME_COUNT);
+    int32 n      = 5;
+
+    if (editor)
+    {
+        BeginUndoStroke(editor->undo);
+    }
+
+    for (HexSpanIterator it = BeginHexSpans(center->coord, n, 1, 1, world->width - 1, world->height - 1); !it.isDone;
+         NextHexSpan(&it))
+    {
+        for (int32 x = it.minX; x <= it.maxX; ++x)
+        {
+            Cell *cell = GetCell(world, OffsetCoord{x, it.y});
+            if (editor)
+            {
+                EditorPaintCell(editor, world, cell, biome);
+            }
+            else
+            {
+                SetCellBiome(world, cell, biome);
+            }
+        }
+    }
+
+    if (editor && frameIndex % 10 == 0)
+    {
+        EditorPlaceEntity(editor, world, center, (EntityType)(frameIndex % (ENTITY_CITY + 1)));
+    }
+
+    if (editor)
+    {
+        EndUndoStroke(editor->undo);
+    }
+}
+
+internal int BenchCompareReal64(const void *a, const void *b)
+{
+    real64 valueA = *(real64 *)a;
+    real64 valueB = *(real64 *)b;
+
+    int result = valueA < valueB ? -1 : (valueA > valueB ? 1 : 0);
+    return result;
+}
+
+// NOTE sorts the samples in place.
+inline real64 BenchPercentile(real64 *samples, uint32 sampleCount, real64 percentile)
+{
+    qsort(samples, sampleCount, sizeof(real64), BenchCompareReal64);
+
+    uint32 index  = (uint32)(percentile / 100.0 * (sampleCount - 1) + 0.5);
+    real64 result = samples[index];
+
+    return result;
+}
+
+internal OffsetCoord BenchRandomPassableCell(BenchContext *context, World *world, PathCostTable *costs)
+{
+    OffsetCoord result = {};
+
+    for (;;)
+    {
+        result = {BenchRandomBetween(context, 1, world->width - 1), BenchRandomBetween(context, 1, world->height - 1)};
+        if (costs->costs[GetCell(world, result)->biome])
+        {
+            break;
+        }
+    }
+
+    return result;
+}
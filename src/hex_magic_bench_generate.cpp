@@ -0,0 +1,499 @@
+// NOTE checksum of everything the generator decides, the biome of every cell and where every entity went.
+internal uint32 BenchWorldChecksum(World *world, uint8 *rowBiomes)
+{
+    uint32 result = 0;
+
+    for (int32 y = 0; y < world->height; ++y)
+    {
+        if (world->pager)
+        {
+            PageInWorldBand(world, y);
+        }
+
+        Cell *cell = GetCellRow(world, y);
+        for (int32 x = 0; x < world->width; ++x)
+        {
+            rowBiomes[x] = (uint8)(cell++)->biome;
+        }
+
+        result = Crc32(result, rowBiomes, world->width);
+    }
+
+    for (uint32 entityIndex = 1; entityIndex <= world->entityCount; ++entityIndex)
+    {
+        Entity *entity = GetEntity(world, entityIndex);
+
+        result = Crc32(result, &entity->type, sizeof(entity->type));
+        result = Crc32(result, &entity->position, sizeof(entity->position));
+    }
+
+    return result;
+}
+
+// NOTE generates over a map that was loaded paged, with a couple of its chunks already paged in. It has to come out
+// the same as the dense world, and the same again once it has been written back and opened once more. With an arena
+// that only has room for the chunks already in, the world has to stay as it was.
+internal void BenchGeneratePaged(BenchContext *context, WorldGenerator *generator, uint8 *rowBiomes, uint32 seed)
+{
+    int32 size   = 1024;
+    World *world = BenchCreateWorld(context, size, size);
+
+    GenerateWorld(generator, world, &context->memory, &context->tempArena, seed + 1, GENERATE_MAX_JOB_COUNT);
+    SaveWorldMap(&context->thread, &context->memory, world, &context->tempArena, "bench_generate.map");
+
+    GenerateWorld(generator, world, &context->memory, &context->tempArena, seed, GENERATE_MAX_JOB_COUNT);
+    uint32 denseChecksum = BenchWorldChecksum(world, rowBiomes);
+
+    BenchReleaseWorldArena(context);
+    world = LoadWorldMap(&context->thread, &context->memory, &context->worldArena, 0, "bench_generate.map");
+    Assert(world && world->pager);
+
+    Cell *center      = GetCell(world, OffsetCoord{size / 2, size / 2});
+    Cell *corner      = GetCell(world, OffsetCoord{size / 4, 3 * size / 4});
+    Biome centerBiome = center->biome;
+    Biome cornerBiome = corner->biome;
+
+    MemoryIndex arenaSize    = context->worldArena.size;
+    context->worldArena.size = context->worldArena.used;
+    bool32 fullGenerated =
+        GenerateWorld(generator, world, &context->memory, &context->tempArena, seed, GENERATE_MAX_JOB_COUNT);
+    context->worldArena.size = arenaSize;
+
+    uint32 fullResident = world->pager->residentChunkCount;
+    bool32 fullKept     = center->biome == centerBiome && corner->biome == cornerBiome;
+    fullKept            = fullKept && !world->pager->dirtyChunkCount;
+
+    uint64 start = BenchGetNanoseconds();
+    bool32 generated =
+        GenerateWorld(generator, world, &context->memory, &context->tempArena, seed, GENERATE_MAX_JOB_COUNT);
+    real64 time = BenchMillisecondsSince(start);
+
+    uint32 pagedChecksum   = BenchWorldChecksum(world, rowBiomes);
+    uint32 dirtyChunkCount = world->pager->dirtyChunkCount;
+    uint32 chunkCount      = (uint32)(world->pager->chunkCountX * world->pager->chunkCountY);
+
+    FlushWorldPager(&context->thread, &context->memory, world, &context->tempArena);
+    context->memory.debugPlatformUnmapFile(&context->thread, &world->pager->file);
+    BenchReleaseWorldArena(context);
+
+    world = LoadWorldMap(&context->thread, &context->memory, &context->worldArena, 0, "bench_generate.map");
+    uint32 reopenedChecksum = world ? BenchWorldChecksum(world, rowBiomes) : 0;
+
+    printf("generate %dx%d paged: %.2fms, %u of %u chunks dirty, checksum %s the dense one, %s once written back\n",
+           size, size, time, dirtyChunkCount, chunkCount,
+           generated && pagedChecksum == denseChecksum ? "matches" : "DIFFERS FROM",
+           reopenedChecksum == denseChecksum ? "still matches" : "DIFFERS");
+    printf("generate %dx%d paged, arena full: %s, %u chunks resident, world %s\n", size, size,
+           fullGenerated ? "GENERATED" : "refused", fullResident, fullKept ? "kept" : "CHANGED");
+
+    if (world)
+    {
+        context->memory.debugPlatformUnmapFile(&context->thread, &world->pager->file);
+    }
+
+    BenchReleaseWorldArena(context);
+
+    unlink("bench_generate.map");
+    unlink("bench_generate.map.chunks");
+}
+
+global char *globalBenchBiomeNames[] = {"water", "grass", "dirt", "lava", "rough", "sand", "snow", "swamp", "rock"};
+
+// NOTE the same seed goes through the generator with a single job on the main thread, with SSE2 and with whatever the
+// CPU has, and with every job it can have on queues with different numbers of threads. All of them have to come out
+// the same.
+internal void BenchGenerate(BenchContext *context)
+{
+    int32 size   = 4096;
+    World *world = BenchCreateWorld(context, size, size);
+    uint32 seed  = 1;
+
+    TemporaryMemory temp      = StartTemporaryMemory(&context->tempArena);
+    WorldGenerator *generator = PushStruct(&context->tempArena, WorldGenerator);
+    uint8 *rowBiomes          = PushArray(&context->tempArena, size, uint8);
+
+    PlatformWorkQueue *defaultQueue = context->memory.highPriorityQueue;
+
+    PlatformWorkQueue *mainQueue  = BenchGetQueue(0);
+    PlatformWorkQueue *eightQueue = BenchGetQueue(7);
+
+    HexBatchPath cpuPath = GetHexBatchPath();
+
+    struct
+    {
+        char *name;
+        PlatformWorkQueue *queue;
+        uint32 jobCount;
+        HexBatchPath path;
+    } runs[] = {
+        {"1 job, main thread", mainQueue, 1, HEX_BATCH_SSE2},
+        {"1 job, main thread", mainQueue, 1, cpuPath},
+        {"64 jobs, main thread", mainQueue, GENERATE_MAX_JOB_COUNT, cpuPath},
+        {"64 jobs, default queue", defaultQueue, GENERATE_MAX_JOB_COUNT, cpuPath},
+        {"64 jobs, 8 threads", eightQueue, GENERATE_MAX_JOB_COUNT, cpuPath},
+    };
+
+    uint32 firstChecksum = 0;
+    uint32 mismatchCount = 0;
+
+    // NOTE the 8 thread run is the one to hold against the second the request allows on 8 cores.
+    BenchPrintCoreCount("generate", 8);
+
+    for (uint32 runIndex = 0; runIndex < ArrayCount(runs); ++runIndex)
+    {
+        context->memory.highPriorityQueue = runs[runIndex].queue;
+        globalHexBatchPath                = runs[runIndex].path;
+
+        uint64 start = BenchGetNanoseconds();
+        GenerateWorld(generator, world, &context->memory, &context->tempArena, seed, runs[runIndex].jobCount);
+        real64 time = BenchMillisecondsSince(start);
+
+        real64 fieldTime = (real64)generator->lastFieldCycles /
+                           (real64)(generator->lastFieldCycles + generator->lastPlaceCycles) * time;
+        uint32 checksum  = BenchWorldChecksum(world, rowBiomes);
+
+        if (runIndex == 0)
+        {
+            firstChecksum = checksum;
+        }
+        else if (checksum != firstChecksum)
+        {
+            ++mismatchCount;
+        }
+
+        printf("generate %dx%d, %s, %s: %.2fms, fields %.2fms, %.1f ns per cell, checksum %08x\n", size, size,
+               runs[runIndex].name, globalHexBatchPathNames[runs[runIndex].path], time, fieldTime,
+               fieldTime * 1000.0 * 1000.0 / ((real64)size * size), checksum);
+    }
+
+    context->memory.highPriorityQueue = defaultQueue;
+    globalHexBatchPath                = cpuPath;
+
+    uint64 biomeCounts[BIOME_COUNT] = {};
+    for (MemoryIndex cellIndex = 0; cellIndex < (MemoryIndex)size * size; ++cellIndex)
+    {
+        ++biomeCounts[world->cells[cellIndex].biome];
+    }
+
+    printf("generate biomes:");
+    for (uint32 biome = 0; biome < BIOME_COUNT; ++biome)
+    {
+        printf(" %s %.1f%%", globalBenchBiomeNames[biome], 100.0 * (real64)biomeCounts[biome] / ((real64)size * size));
+    }
+    printf("\n");
+
+    printf("generate entities: %u cities, %u resources, %u octaves of elevation, %u of moisture\n",
+           generator->lastCityCount, generator->lastResourceCount, generator->elevation.octaveCount,
+           generator->moisture.octaveCount);
+
+    // NOTE a small world and the next seed, which has to come out different.
+    World *small = BenchCreateWorld(context, 160, 100);
+    GenerateWorld(generator, small, &context->memory, &context->tempArena, seed, GENERATE_MAX_JOB_COUNT);
+    uint32 smallChecksum = BenchWorldChecksum(small, rowBiomes);
+    uint32 smallLand     = generator->lastLandCellCount;
+    uint32 smallCities   = generator->lastCityCount;
+    uint32 smallResources = generator->lastResourceCount;
+
+    GenerateWorld(generator, small, &context->memory, &context->tempArena, seed + 1, GENERATE_MAX_JOB_COUNT);
+    uint32 nextChecksum = BenchWorldChecksum(small, rowBiomes);
+
+    printf("generate 160x100: %u land cells, %u cities, %u resources, next seed %s\n", smallLand, smallCities,
+           smallResources, nextChecksum != smallChecksum ? "differs" : "IS THE SAME");
+    printf("generate check: %u of %u runs differ from the single job SSE2 one\n", mismatchCount,
+           (uint32)ArrayCount(runs) - 1);
+
+    BenchGeneratePaged(context, generator, rowBiomes, seed);
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE what the kernel passes should come out with, cell by cell, going over the taps of every cell with the spiral
+// iterator instead of the kernel.
+internal real32 BenchReferenceConvolve(HexScalarGrid *grid, real32 *ringWeights, int32 radius, int32 x, int32 y)
+{
+    real32 result   = 0.0f;
+    HexCoord center = HexFromOffset(OffsetCoord{x, y + grid->rowParity});
+
+    for (HexSpiralIterator it = BeginHexSpiral(center, radius); !it.isDone; NextHexSpiral(&it))
+    {
+        int32 tapX = it.offset.x;
+        int32 tapY = it.offset.y - grid->rowParity;
+
+        real32 value = grid->apronValue;
+        if (tapX >= 0 && tapX < grid->width && tapY >= 0 && tapY < grid->height)
+        {
+            value = GetHexGridRow(grid, tapY)[tapX];
+        }
+
+        result += ringWeights[it.ring.radius] * value;
+    }
+
+    return result;
+}
+
+internal uint8 BenchReferenceMajority(HexBiomeGrid *grid, int32 radius, int32 x, int32 y)
+{
+    uint32 counts[BIOME_COUNT] = {};
+    HexCoord center            = HexFromOffset(OffsetCoord{x, y + grid->rowParity});
+    uint8 centerBiome          = GetHexGridRow(grid, y)[x];
+
+    for (HexSpiralIterator it = BeginHexSpiral(center, radius); !it.isDone; NextHexSpiral(&it))
+    {
+        int32 tapX = it.offset.x;
+        int32 tapY = it.offset.y - grid->rowParity;
+
+        if (tapX >= 0 && tapX < grid->width && tapY >= 0 && tapY < grid->height)
+        {
+            counts[GetHexGridRow(grid, tapY)[tapX]] += 2;
+        }
+    }
+
+    counts[centerBiome] += 1;
+
+    uint8 result     = centerBiome;
+    uint32 bestCount  = 0;
+    for (uint32 biome = 0; biome < BIOME_COUNT; ++biome)
+    {
+        if (counts[biome] > bestCount)
+        {
+            result    = (uint8)biome;
+            bestCount = counts[biome];
+        }
+    }
+
+    return result;
+}
+
+// NOTE checks a small grid with odd rows first against the reference on every path, then times single passes over
+// 16M cells on every path and every thread count, and an influence map build on a generated world.
+internal void BenchKernel(BenchContext *context)
+{
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    MemoryArena *arena   = &context->tempArena;
+
+    PlatformWorkQueue *defaultQueue = context->memory.highPriorityQueue;
+    HexBatchPath cpuPath            = GetHexBatchPath();
+
+    PlatformWorkQueue *mainQueue = BenchGetQueue(0);
+
+    real32 smoothWeights[HEX_KERNEL_MAX_RADIUS + 1] = {0.4f, 0.1f, 0.05f, 0.02f, 0.01f};
+    real32 majorityWeights[2]                        = {1.0f, 1.0f};
+
+    HexKernel majority = MakeHexKernel(1, majorityWeights);
+
+    {
+        int32 width  = 77;
+        int32 height = 53;
+
+        HexScalarGrid source = MakeHexScalarGrid(arena, width, height, 1, 0.5f);
+        HexScalarGrid dest   = MakeHexScalarGrid(arena, width, height, 1, 0.5f);
+        HexBiomeGrid biomes  = MakeHexBiomeGrid(arena, width, height, 1);
+        HexBiomeGrid voted   = MakeHexBiomeGrid(arena, width, height, 1);
+
+        ClearHexGrid(&source, 0.0f);
+        FillHexGridApron(&biomes);
+
+        for (int32 y = 0; y < height; ++y)
+        {
+            for (int32 x = 0; x < width; ++x)
+            {
+                GetHexGridRow(&source, y)[x] = (real32)(BenchRandom(context) % 1000) / 1000.0f;
+                GetHexGridRow(&biomes, y)[x] = (uint8)(BenchRandom(context) % 3);
+            }
+        }
+
+        uint64 convolveMismatchCount = 0;
+        uint64 majorityMismatchCount = 0;
+        real32 maxError              = 0.0f;
+
+        for (uint32 path = HEX_BATCH_SSE2; path <= (uint32)cpuPath; ++path)
+        {
+            globalHexBatchPath = (HexBatchPath)path;
+
+            for (int32 radius = 1; radius <= HEX_KERNEL_MAX_RADIUS; ++radius)
+            {
+                HexKernel kernel = MakeHexKernel(radius, smoothWeights);
+                ConvolveHexGrid(&kernel, &source, &dest, 0, 0, &context->memory, HEX_KERNEL_MAX_JOB_COUNT);
+
+                for (int32 y = 0; y < height; ++y)
+                {
+                    for (int32 x = 0; x < width; ++x)
+                    {
+                        real32 expected = BenchReferenceConvolve(&source, smoothWeights, radius, x, y);
+                        real32 error    = GetHexGridRow(&dest, y)[x] - expected;
+                        error           = error < 0.0f ? -error : error;
+
+                        maxError = error > maxError ? error : maxError;
+                        if (error > 0.0001f)
+                        {
+                            ++convolveMismatchCount;
+                        }
+                    }
+                }
+            }
+
+            MajorityFilterHexGrid(&majority, &biomes, &voted, &context->memory, HEX_KERNEL_MAX_JOB_COUNT);
+
+            for (int32 y = 0; y < height; ++y)
+            {
+                for (int32 x = 0; x < width; ++x)
+                {
+                    if (GetHexGridRow(&voted, y)[x] != BenchReferenceMajority(&biomes, 1, x, y))
+                    {
+                        ++majorityMismatchCount;
+                    }
+                }
+            }
+        }
+
+        printf("kernel check %dx%d, sse2 up to %s: %llu convolved cells off (max error %g), %llu voted cells off\n",
+               width, height, globalHexBatchPathNames[cpuPath], (unsigned long long)convolveMismatchCount, maxError,
+               (unsigned long long)majorityMismatchCount);
+    }
+
+    int32 size    = 4096;
+    real64 mcells = (real64)size * size / 1000000.0;
+    World *world  = BenchCreateWorld(context, size, size);
+
+    HexScalarGrid source = MakeHexScalarGrid(arena, size, size, 0, 0.0f);
+    HexScalarGrid dest   = MakeHexScalarGrid(arena, size, size, 0, 0.0f);
+    HexBiomeGrid biomes  = MakeHexBiomeGrid(arena, size, size, 0);
+    HexBiomeGrid voted   = MakeHexBiomeGrid(arena, size, size, 0);
+
+    WorldGenerator *generator = PushStruct(arena, WorldGenerator);
+    GenerateWorld(generator, world, &context->memory, arena, 1, GENERATE_MAX_JOB_COUNT);
+
+    for (int32 y = 0; y < size; ++y)
+    {
+        real32 *values = GetHexGridRow(&source, y);
+        uint8 *row     = GetHexGridRow(&biomes, y);
+
+        for (int32 x = 0; x < size; ++x)
+        {
+            values[x] = (real32)(BenchRandom(context) % 1000) / 1000.0f;
+            row[x]    = (uint8)world->cells[(MemoryIndex)y * size + x].biome;
+        }
+    }
+
+    FillHexGridApron(&source);
+    FillHexGridApron(&biomes);
+
+    HexKernel kernels[] = {MakeHexKernel(1, smoothWeights), MakeHexKernel(2, smoothWeights)};
+
+    for (uint32 path = HEX_BATCH_SSE2; path <= (uint32)cpuPath; ++path)
+    {
+        globalHexBatchPath                = (HexBatchPath)path;
+        context->memory.highPriorityQueue = mainQueue;
+
+        for (uint32 kernelIndex = 0; kernelIndex <= ArrayCount(kernels); ++kernelIndex)
+        {
+            real64 best = 0.0;
+
+            for (uint32 repeat = 0; repeat < 3; ++repeat)
+            {
+                uint64 start = BenchGetNanoseconds();
+
+                if (kernelIndex < ArrayCount(kernels))
+                {
+                    ConvolveHexGrid(kernels + kernelIndex, &source, &dest, 0, 0, &context->memory,
+                                    HEX_KERNEL_MAX_JOB_COUNT);
+                }
+                else
+                {
+                    MajorityFilterHexGrid(&majority, &biomes, &voted, &context->memory, HEX_KERNEL_MAX_JOB_COUNT);
+                }
+
+                real64 time = BenchMillisecondsSince(start);
+                best        = repeat == 0 || time < best ? time : best;
+            }
+
+            if (kernelIndex < ArrayCount(kernels))
+            {
+                printf("kernel %dx%d convolve radius %d (%u taps), %s, 1 thread: %.2fms, %.0fM cells/s\n", size, size,
+                       kernels[kernelIndex].radius, kernels[kernelIndex].tapCount, globalHexBatchPathNames[path], best,
+                       mcells * 1000.0 / best);
+            }
+            else
+            {
+                printf("kernel %dx%d majority radius 1, %s, 1 thread: %.2fms, %.0fM cells/s\n", size, size,
+                       globalHexBatchPathNames[path], best, mcells * 1000.0 / best);
+            }
+        }
+    }
+
+    globalHexBatchPath = cpuPath;
+
+    // NOTE the main thread works the queue as well, so a queue with n workers runs on n + 1 threads.
+    uint32 workerCounts[] = {0, 1, 3, 7};
+    real64 singleTime     = 0.0;
+
+    BenchPrintCoreCount("kernel scaling", workerCounts[ArrayCount(workerCounts) - 1] + 1);
+    printf("kernel scaling, convolve radius 2, %s:", globalHexBatchPathNames[cpuPath]);
+    for (uint32 countIndex = 0; countIndex < ArrayCount(workerCounts); ++countIndex)
+    {
+        context->memory.highPriorityQueue = BenchGetQueue(workerCounts[countIndex]);
+
+        real64 best = 0.0;
+        for (uint32 repeat = 0; repeat < 3; ++repeat)
+        {
+            uint64 start = BenchGetNanoseconds();
+            ConvolveHexGrid(kernels + 1, &source, &dest, 0, 0, &context->memory, HEX_KERNEL_MAX_JOB_COUNT);
+            real64 time = BenchMillisecondsSince(start);
+
+            best = repeat == 0 || time < best ? time : best;
+        }
+
+        singleTime = countIndex == 0 ? best : singleTime;
+        printf(" %u threads %.2fms (%.2fx)", workerCounts[countIndex] + 1, best, singleTime / best);
+    }
+    printf("\n");
+
+    context->memory.highPriorityQueue = defaultQueue;
+
+    // NOTE the generator gives every city to the first player, the bench hands them out to everybody.
+    for (uint32 entityIndex = 1; entityIndex <= world->entityCount; ++entityIndex)
+    {
+        GetEntity(world, entityIndex)->player = entityIndex % MAX_PLAYER_COUNT;
+    }
+
+    PathCostTable costs     = MakeHeroPathCosts();
+    InfluenceMap *influence = PushStruct(arena, InfluenceMap);
+    InitializeInfluenceMap(influence, arena, world);
+
+    uint64 start = BenchGetNanoseconds();
+    BuildInfluenceMap(influence, world, &costs, &context->memory, HEX_KERNEL_MAX_JOB_COUNT);
+    real64 influenceTime = BenchMillisecondsSince(start);
+
+    printf("kernel influence %dx%d, %u players, %u passes: %.2fms, owned cells:", size, size, MAX_PLAYER_COUNT,
+           INFLUENCE_PASS_COUNT, influenceTime);
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        printf(" %u", influence->ownedCellCounts[player]);
+    }
+    printf("\n");
+
+    // NOTE the same build spread over frames the way the game runs it, which has to come out with the same owners.
+    MemoryIndex cellCount = (MemoryIndex)size * size;
+    uint8 *owners         = PushArray(arena, cellCount, uint8);
+    memcpy(owners, influence->owners, cellCount);
+
+    MarkInfluenceDirty(influence);
+
+    real64 worstFrame = 0.0;
+    real64 totalTime  = 0.0;
+    do
+    {
+        start = BenchGetNanoseconds();
+        UpdateInfluenceMap(influence, world, &costs, &context->memory, HEX_KERNEL_MAX_JOB_COUNT);
+        real64 frameTime = BenchMillisecondsSince(start);
+
+        worstFrame = BenchMaximum(worstFrame, frameTime);
+        totalTime += frameTime;
+    } while (influence->isBuilding);
+
+    printf("kernel influence %dx%d over frames: %u frames, worst %.2fms, %.2fms in all, owners %s\n", size, size,
+           influence->lastBuildFrameCount, worstFrame, totalTime,
+           memcmp(owners, influence->owners, cellCount) == 0 ? "match" : "DIFFER");
+
+    EndTemporaryMemory(temp);
+}
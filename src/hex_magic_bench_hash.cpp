@@ -0,0 +1,146 @@
+// NOTE the hash has to come out the same whichever path ran it and however the data was split up between calls, and
+// the world hash kept up to date from the chunks edits touch has to match hashing the whole world again.
+internal void BenchHash(BenchContext *context)
+{
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    MemoryIndex size = Megabytes(256);
+    uint32 *words    = PushArray(&context->tempArena, (size / sizeof(uint32)), uint32);
+    uint8 *data      = (uint8 *)words;
+
+    for (MemoryIndex wordIndex = 0; wordIndex < size / sizeof(uint32); ++wordIndex)
+    {
+        words[wordIndex] = BenchRandom(context);
+    }
+
+    HexBatchPath paths[] = {HEX_BATCH_SCALAR, HEX_BATCH_SSE2, HEX_BATCH_AVX2};
+    HexBatchPath cpuPath = GetHexBatchPath();
+
+    uint32 mismatchCount = 0;
+    uint64 first         = 0;
+
+    for (uint32 pathIndex = 0; pathIndex < ArrayCount(paths); ++pathIndex)
+    {
+        if (paths[pathIndex] == HEX_BATCH_AVX2 && cpuPath != HEX_BATCH_AVX2)
+        {
+            continue;
+        }
+
+        globalHexBatchPath = paths[pathIndex];
+
+        uint64 start = BenchGetNanoseconds();
+        uint64 hash  = Hash64(data, size);
+        real64 time  = BenchMillisecondsSince(start);
+
+        if (pathIndex == 0)
+        {
+            first = hash;
+        }
+        else if (hash != first)
+        {
+            ++mismatchCount;
+        }
+
+        // NOTE the same megabyte in one go and in pieces of every size up to a few stripes.
+        MemoryIndex pieceSize = Megabytes(1) + 13;
+        uint64 whole          = Hash64(data, pieceSize);
+
+        HashStream stream;
+        BeginHash(&stream);
+
+        for (MemoryIndex offset = 0; offset < pieceSize;)
+        {
+            MemoryIndex addSize = BenchRandomBetween(context, 0, 300);
+            if (addSize > pieceSize - offset)
+            {
+                addSize = pieceSize - offset;
+            }
+
+            AddHash(&stream, data + offset, addSize);
+            offset += addSize;
+        }
+
+        if (EndHash(&stream) != whole)
+        {
+            ++mismatchCount;
+        }
+
+        printf("hash %lluMB, %s: %016llx %.3fms, %.2fGB/s\n", (unsigned long long)(size / Megabytes(1)),
+               globalHexBatchPathNames[paths[pathIndex]], (unsigned long long)hash, time,
+               (real64)size / (time * 1000.0 * 1000.0));
+    }
+
+    globalHexBatchPath = cpuPath;
+
+    // NOTE small inputs are what a frame hashes the most of.
+    uint32 smallCount = 1000000;
+    uint64 smallSum   = 0;
+    uint64 smallStart = BenchGetNanoseconds();
+
+    for (uint32 smallIndex = 0; smallIndex < smallCount; ++smallIndex)
+    {
+        smallSum += Hash64(data + (smallIndex & 1023), 24);
+    }
+
+    real64 smallTime = BenchMillisecondsSince(smallStart);
+    printf("hash %u hashes of 24 bytes: %.1fns each (%llx)\n", smallCount, smallTime * 1000.0 * 1000.0 / smallCount,
+           (unsigned long long)(smallSum & 0xFF));
+
+    EndTemporaryMemory(temp);
+
+    int32 worldSizes[] = {512, 2048, 4096};
+    for (uint32 sizeIndex = 0; sizeIndex < ArrayCount(worldSizes); ++sizeIndex)
+    {
+        int32 worldSize = worldSizes[sizeIndex];
+        World *world    = BenchCreateWorld(context, worldSize, worldSize);
+        BenchPaintBlobs(context, world, 200, 40);
+
+        temp = StartTemporaryMemory(&context->tempArena);
+
+        Editor editor = BenchCreateEditor(context, "bench_hash", Megabytes(64));
+
+        uint64 start   = BenchGetNanoseconds();
+        WorldHash hash = {};
+        InitializeWorldHash(&hash, &context->tempArena, world);
+        real64 fullTime = BenchMillisecondsSince(start);
+
+        editor.worldHash = &hash;
+
+        uint32 frameCount    = 120;
+        uint64 updateSum     = 0;
+        uint64 updateMax     = 0;
+        uint64 chunkCountSum = 0;
+
+        for (uint32 frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+        {
+            BenchPaintBrush(context, &editor, world, frameIndex);
+            UpdateWorldHash(&hash, world);
+
+            updateSum += hash.lastUpdateCycles;
+            updateMax = hash.lastUpdateCycles > updateMax ? hash.lastUpdateCycles : updateMax;
+            chunkCountSum += hash.lastChunkCount;
+        }
+
+        WorldHash fresh = {};
+        InitializeWorldHash(&fresh, &context->tempArena, world);
+
+        if (fresh.cellHash != hash.cellHash)
+        {
+            ++mismatchCount;
+        }
+
+        real64 cyclesPerMs = BenchCyclesPerMillisecond();
+
+        printf("hash world %dx%d, %s: full %.3fms, %u painted frames %.4fms a frame on average, %.4fms at most, %.1f "
+               "chunks a frame\n",
+               worldSize, worldSize, globalHexBatchPathNames[cpuPath], fullTime, frameCount,
+               updateSum / cyclesPerMs / frameCount, updateMax / cyclesPerMs, (real64)chunkCountSum / frameCount);
+
+        FlushJournal(editor.journal, world);
+        EndTemporaryMemory(temp);
+
+        unlink("bench_hash.log");
+    }
+
+    printf("hash check: %u hashes differ between paths, splits or incremental updates\n", mismatchCount);
+}
@@ -0,0 +1,358 @@
+enum BenchHexConversion
+{
+    BENCH_HEX_FROM_OFFSET,
+    BENCH_OFFSET_FROM_HEX,
+    BENCH_HEX_TO_V2,
+    BENCH_ROUND_HEX,
+    BENCH_V2_TO_HEX,
+    BENCH_HEX_CONVERSION_COUNT,
+};
+
+global char *globalBenchHexConversionNames[] = {"HexFromOffset", "OffsetFromHex", "HexToV2", "RoundHex", "V2ToHex"};
+
+internal void BenchRunHexConversion(BenchHexConversion conversion, int32 **ints, real32 **reals, int32 **outInts,
+                                    real32 **outReals, uint32 count)
+{
+    switch (conversion)
+    {
+        case BENCH_HEX_FROM_OFFSET:
+        {
+            HexFromOffsetBatch({ints[0], ints[1]}, {outInts[0], outInts[1], outInts[2]}, count);
+        }
+        break;
+
+        case BENCH_OFFSET_FROM_HEX:
+        {
+            OffsetFromHexBatch({ints[0], ints[1], ints[2]}, {outInts[0], outInts[1]}, count);
+        }
+        break;
+
+        case BENCH_HEX_TO_V2:
+        {
+            HexToV2Batch({ints[0], ints[1], ints[2]}, {outReals[0], outReals[1]}, count);
+        }
+        break;
+
+        case BENCH_ROUND_HEX:
+        {
+            RoundHexBatch({reals[0], reals[1], reals[2]}, {outInts[0], outInts[1], outInts[2]}, count);
+        }
+        break;
+
+        case BENCH_V2_TO_HEX:
+        {
+            V2ToHexBatch({reals[0], reals[1]}, {outInts[0], outInts[1], outInts[2]}, count);
+        }
+        break;
+
+        default:
+        {
+        }
+        break;
+    }
+}
+
+// NOTE runs one of the batched conversions with every path, and counts the elements where the SIMD paths come out
+// different from the scalar one, comparing floats bit for bit.
+internal uint64 BenchCheckHexConversion(BenchHexConversion conversion, int32 **ints, real32 **reals, int32 **outInts,
+                                        real32 **outReals, int32 **checkInts, real32 **checkReals, uint32 count)
+{
+    uint64 result = 0;
+
+    globalHexBatchPath = HEX_BATCH_SCALAR;
+    BenchRunHexConversion(conversion, ints, reals, checkInts, checkReals, count);
+
+    for (uint32 path = HEX_BATCH_SSE2; path <= HEX_BATCH_AVX2; ++path)
+    {
+        if (path == HEX_BATCH_AVX2 && !__builtin_cpu_supports("avx2"))
+        {
+            continue;
+        }
+
+        for (uint32 index = 0; index < 3; ++index)
+        {
+            memset(outInts[index], 0x55, count * sizeof(int32));
+        }
+        memset(outReals[0], 0x55, count * sizeof(real32));
+        memset(outReals[1], 0x55, count * sizeof(real32));
+
+        globalHexBatchPath = (HexBatchPath)path;
+        BenchRunHexConversion(conversion, ints, reals, outInts, outReals, count);
+
+        bool32 isReal = conversion == BENCH_HEX_TO_V2;
+        uint32 arrays = isReal || conversion == BENCH_OFFSET_FROM_HEX ? 2 : 3;
+
+        for (uint32 arrayIndex = 0; arrayIndex < arrays; ++arrayIndex)
+        {
+            void *got      = isReal ? (void *)outReals[arrayIndex] : (void *)outInts[arrayIndex];
+            void *expected = isReal ? (void *)checkReals[arrayIndex] : (void *)checkInts[arrayIndex];
+
+            if (memcmp(got, expected, count * sizeof(int32)) != 0)
+            {
+                for (uint32 index = 0; index < count; ++index)
+                {
+                    result += ((uint32 *)got)[index] != ((uint32 *)expected)[index];
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE checks the batched conversions against the one at a time ones over every coordinate of a 4096 by 4096 block,
+// every 1/32 of a hex over a 128 by 128 block of fractional coordinates and positions, halves included, and random
+// positions all over a big map. Row lengths vary so the leftovers get checked too. Then times each path over a million
+// elements.
+internal void BenchHex(BenchContext *context)
+{
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    MemoryArena *arena   = &context->tempArena;
+
+    uint32 rowDim = 4096;
+    int32 *ints[3];
+    real32 *reals[3];
+    int32 *outInts[3];
+    real32 *outReals[2];
+    int32 *checkInts[3];
+    real32 *checkReals[2];
+
+    uint32 capacity = 1024 * 1024;
+    for (uint32 index = 0; index < 3; ++index)
+    {
+        ints[index]      = PushArray(arena, capacity, int32);
+        reals[index]     = PushArray(arena, capacity, real32);
+        outInts[index]   = PushArray(arena, capacity, int32);
+        checkInts[index] = PushArray(arena, capacity, int32);
+    }
+    for (uint32 index = 0; index < 2; ++index)
+    {
+        outReals[index]   = PushArray(arena, capacity, real32);
+        checkReals[index] = PushArray(arena, capacity, real32);
+    }
+
+    uint64 mismatches[BENCH_HEX_CONVERSION_COUNT] = {};
+    uint64 checked[BENCH_HEX_CONVERSION_COUNT]    = {};
+
+    HexBatchPath bestPath = GetHexBatchPath();
+
+    for (uint32 row = 0; row < rowDim; ++row)
+    {
+        uint32 count = rowDim - (row & 7);
+        int32 a      = (int32)row - (int32)rowDim / 2;
+
+        for (uint32 index = 0; index < count; ++index)
+        {
+            int32 b = (int32)index - (int32)rowDim / 2;
+
+            ints[0][index] = b;
+            ints[1][index] = a;
+            ints[2][index] = -a - b;
+
+            // NOTE fractional hexes on a 1/32 grid over [-64, 64), with s worked out the way V2ToHex does.
+            reals[0][index] = (real32)b / 32.0f;
+            reals[1][index] = (real32)a / 32.0f;
+            reals[2][index] = -reals[0][index] - reals[1][index];
+        }
+
+        for (uint32 conversion = 0; conversion < BENCH_HEX_CONVERSION_COUNT; ++conversion)
+        {
+            mismatches[conversion] += BenchCheckHexConversion((BenchHexConversion)conversion, ints, reals, outInts,
+                                                              outReals, checkInts, checkReals, count);
+            checked[conversion] += count;
+        }
+    }
+
+    // NOTE positions anywhere on the biggest map, at random fractions of a pixel.
+    for (uint32 round = 0; round < 16; ++round)
+    {
+        uint32 count = capacity - round;
+        for (uint32 index = 0; index < count; ++index)
+        {
+            reals[0][index] = (real32)BenchRandom(context) / 4294967296.0f * 30000.0f - 1000.0f;
+            reals[1][index] = (real32)BenchRandom(context) / 4294967296.0f * 26000.0f - 1000.0f;
+        }
+
+        mismatches[BENCH_V2_TO_HEX] += BenchCheckHexConversion(BENCH_V2_TO_HEX, ints, reals, outInts, outReals,
+                                                               checkInts, checkReals, count);
+        checked[BENCH_V2_TO_HEX] += count;
+    }
+
+    for (uint32 conversion = 0; conversion < BENCH_HEX_CONVERSION_COUNT; ++conversion)
+    {
+        printf("hex check %s: %llu elements, %llu differ from scalar\n", globalBenchHexConversionNames[conversion],
+               (unsigned long long)checked[conversion], (unsigned long long)mismatches[conversion]);
+    }
+
+    for (uint32 index = 0; index < capacity; ++index)
+    {
+        int32 q = BenchRandomBetween(context, -8192, 8192);
+        int32 r = BenchRandomBetween(context, -8192, 8192);
+
+        ints[0][index]  = q;
+        ints[1][index]  = r;
+        ints[2][index]  = -q - r;
+        reals[0][index] = (real32)BenchRandom(context) / 4294967296.0f * 30000.0f;
+        reals[1][index] = (real32)BenchRandom(context) / 4294967296.0f * 26000.0f;
+        reals[2][index] = -reals[0][index] - reals[1][index];
+    }
+
+    uint32 repeatCount = 20;
+    for (uint32 conversion = 0; conversion < BENCH_HEX_CONVERSION_COUNT; ++conversion)
+    {
+        printf("hex %s:", globalBenchHexConversionNames[conversion]);
+
+        for (uint32 path = HEX_BATCH_SCALAR; path <= HEX_BATCH_AVX2; ++path)
+        {
+            if (path == HEX_BATCH_AVX2 && !__builtin_cpu_supports("avx2"))
+            {
+                continue;
+            }
+
+            globalHexBatchPath = (HexBatchPath)path;
+
+            uint64 start = BenchGetNanoseconds();
+            for (uint32 repeat = 0; repeat < repeatCount; ++repeat)
+            {
+                BenchRunHexConversion((BenchHexConversion)conversion, ints, reals, outInts, outReals, capacity);
+            }
+            real64 time = BenchMillisecondsSince(start);
+
+            printf(" %s %.0fM/s", globalHexBatchPathNames[path],
+                   (real64)capacity * repeatCount / (time / 1000.0) / 1000000.0);
+        }
+
+        printf("\n");
+    }
+
+    globalHexBatchPath = bestPath;
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE paints hexagons of a few sizes over a map two ways: the open-coded q and r loop the brush used to be, with a
+// hex to offset conversion and a GetCell per cell, and the span iterator walking rows of the cell array. The sums of
+// the painted cell indices show they both cover the same cells.
+// Also checks that rings and spirals have the cells they should.
+internal void BenchHexIterators(BenchContext *context)
+{
+    int32 size   = 2048;
+    World *world = BenchCreateWorld(context, size, size);
+
+    int32 radii[] = {5, 200};
+    char *names[] = {"brush loop", "span iterator"};
+
+    for (uint32 radiusIndex = 0; radiusIndex < ArrayCount(radii); ++radiusIndex)
+    {
+        int32 radius        = radii[radiusIndex];
+        uint32 stampCount   = radius < 50 ? 200000 : 100;
+
+        // NOTE small stamps stay within a corner of the map that fits in the cache, or cache misses are all they
+        // measure. Big ones go anywhere, some of them over the edges.
+        int32 minCenter = radius < 50 ? 64 : 0;
+        int32 maxCenter = radius < 50 ? 128 : size - 1;
+
+        uint32 randomState  = context->randomState;
+        uint64 cellSums[2]  = {};
+        uint64 cellCount[2] = {};
+        real64 times[2]     = {1e9, 1e9};
+
+        // NOTE every method gets the best of a few rounds, and goes first in some of them, so none of them is the
+        // only one that runs on a cold cache or when the machine is busy.
+        uint32 roundCount = 6;
+        for (uint32 step = 0; step < 2 * roundCount; ++step)
+        {
+            uint32 method = (step + step / 2) % 2;
+
+            context->randomState = randomState;
+            cellSums[method]     = 0;
+            cellCount[method]    = 0;
+
+            uint64 start = BenchGetNanoseconds();
+            for (uint32 stampIndex = 0; stampIndex < stampCount; ++stampIndex)
+            {
+                HexCoord center = HexFromOffset({BenchRandomBetween(context, minCenter, maxCenter),
+                                                 BenchRandomBetween(context, minCenter, maxCenter)});
+                Biome biome     = (Biome)(stampIndex % BIOME_COUNT);
+
+                switch (method)
+                {
+                    case 0:
+                    {
+                        for (int32 q = -radius; q <= radius; ++q)
+                        {
+                            for (int32 r = Max(-radius, -q - radius); r <= Min(radius, -q + radius); ++r)
+                            {
+                                Cell *cell = GetCell(world, center + HexCoord{q, r, -q - r});
+                                if (cell)
+                                {
+                                    cell->biome = biome;
+                                    cellSums[method] += GetCellIndex(world, cell);
+                                    ++cellCount[method];
+                                }
+                            }
+                        }
+                    }
+                    break;
+
+                    case 1:
+                    {
+                        for (HexSpanIterator it = BeginHexSpans(center, radius, 1, 1, size - 1, size - 1);
+                             !it.isDone; NextHexSpan(&it))
+                        {
+                            Cell *cell            = GetCellSpan(world, it.y, it.minX, it.maxX, false);
+                            MemoryIndex cellIndex = (MemoryIndex)it.y * size + it.minX;
+
+                            for (int32 x = it.minX; x <= it.maxX; ++x)
+                            {
+                                (cell++)->biome = biome;
+                                cellSums[method] += cellIndex++;
+                            }
+
+                            cellCount[method] += it.maxX - it.minX + 1;
+                        }
+                    }
+                    break;
+                }
+            }
+            times[method] = BenchMinimum(times[method], BenchMillisecondsSince(start));
+        }
+
+        printf("hex iterators radius %d, %u stamps, best of %u:", radius, stampCount, roundCount);
+        for (uint32 method = 0; method < 2; ++method)
+        {
+            printf(" %s %.2fns a cell%s", names[method], 1000000.0 * times[method] / (real64)cellCount[method],
+                   method == 1 ? "" : ",");
+        }
+        printf(" (%s)\n", cellSums[0] == cellSums[1] && cellCount[0] == cellCount[1] ? "same cells" : "CELLS DIFFER");
+    }
+
+    uint32 badRingCount = 0;
+    for (int32 radius = 0; radius <= 64; ++radius)
+    {
+        HexCoord center    = HexFromOffset({size / 2 + radius, size / 2 - radius});
+        int32 ringCount    = 0;
+        int32 spiralCount  = 0;
+        bool32 isRingValid = true;
+
+        for (HexRingIterator it = BeginHexRing(center, radius); !it.isDone; NextHexRing(&it))
+        {
+            isRingValid = isRingValid && (int32)Distance(it.hex, center) == radius && it.index == ringCount &&
+                          it.offset.x == OffsetFromHex(it.hex).x && it.offset.y == OffsetFromHex(it.hex).y;
+            ++ringCount;
+        }
+
+        for (HexSpiralIterator spiral = BeginHexSpiral(center, radius); !spiral.isDone; NextHexSpiral(&spiral))
+        {
+            isRingValid = isRingValid && (int32)Distance(spiral.hex, center) <= radius;
+            ++spiralCount;
+        }
+
+        if (!isRingValid || ringCount != (radius ? 6 * radius : 1) || spiralCount != 3 * radius * (radius + 1) + 1)
+        {
+            ++badRingCount;
+        }
+    }
+
+    printf("hex iterators: rings and spirals of radius 0 to 64, %u wrong\n", badRingCount);
+}
@@ -0,0 +1,350 @@
+// NOTE the game switches big maps over to the chunked layout, this always writes the run-length one.
+internal void BenchSaveRunLengthMap(BenchContext *context, World *world, char *fileName)
+{
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    MapBuffer map = EncodeWorldMap(world, &context->tempArena);
+    context->memory.debugPlatformWriteEntireFile(&context->thread, fileName, SafeTruncateUInt64(map.size),
+                                                 map.memory);
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE swaps the run-length plane of an encoded map for the given runs and fixes the checksums up, so the map still
+// validates and only its runs are broken.
+internal void BenchReplaceBiomeRuns(MapBuffer map, uint8 *runs, uint32 runsSize)
+{
+    MapHeader *header  = (MapHeader *)map.memory;
+    MapSection *biomes = FindMapSection(header, MAP_SECTION_BIOME_RLE);
+    Assert(biomes && runsSize <= biomes->size);
+
+    memcpy(map.memory + biomes->offset, runs, runsSize);
+    biomes->size     = runsSize;
+    biomes->checksum = Crc32(0, map.memory + biomes->offset, biomes->size);
+    header->checksum = MapHeaderChecksum(header);
+}
+
+// NOTE maps with broken runs have to be refused without touching the world that is already loaded.
+internal void BenchCorruptMaps(BenchContext *context)
+{
+    World *world = BenchCreateWorld(context, 160, 100);
+    BenchPaintBlobs(context, world, 80, 12);
+    BenchPlaceEntities(context, world, 20);
+
+    uint32 cellCount    = (uint32)world->width * world->height;
+    uint8 longRun[8]    = {GRASS};
+    uint8 shortRun[8]   = {GRASS};
+    uint32 longRunSize  = (uint32)(WriteVarint(longRun + 1, cellCount + 1) - longRun);
+    uint32 shortRunSize = (uint32)(WriteVarint(shortRun + 1, cellCount - 1) - shortRun);
+
+    uint8 zeroRun[]       = {GRASS, 0};
+    uint8 badBiome[]      = {BIOME_COUNT, 0x80, 0x7D};
+    uint8 cutVarint[]     = {GRASS, 0x80};
+    uint8 wideVarint[]    = {GRASS, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F};
+    uint8 trailingBytes[] = {GRASS, 0x80, 0x7D, GRASS};
+
+    struct
+    {
+        char *name;
+        uint8 *runs;
+        uint32 size;
+    } corruptions[] = {
+        {"a run past the end", longRun, longRunSize},
+        {"runs that stop short", shortRun, shortRunSize},
+        {"an empty run", zeroRun, sizeof(zeroRun)},
+        {"a biome that does not exist", badBiome, sizeof(badBiome)},
+        {"a cut off varint", cutVarint, sizeof(cutVarint)},
+        {"a varint past 32 bits", wideVarint, sizeof(wideVarint)},
+        {"bytes after the last run", trailingBytes, sizeof(trailingBytes)},
+    };
+
+    // NOTE 0x80 0x7D is the varint for 16000, the whole 160x100 world.
+    Assert(cellCount == 16000);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    Cell *cells = PushArray(&context->tempArena, cellCount, Cell);
+    memcpy(cells, world->cells, cellCount * sizeof(Cell));
+
+    for (uint32 corruptionIndex = 0; corruptionIndex < ArrayCount(corruptions); ++corruptionIndex)
+    {
+        MapBuffer map = EncodeWorldMap(world, &context->tempArena);
+        BenchReplaceBiomeRuns(map, corruptions[corruptionIndex].runs, corruptions[corruptionIndex].size);
+        Assert(ValidateMap(map.memory, map.size));
+
+        bool32 refused = !DecodeWorldMap(&context->worldArena, map.memory, map.size);
+
+        context->memory.debugPlatformWriteEntireFile(&context->thread, "bench.map", SafeTruncateUInt64(map.size),
+                                                     map.memory);
+        refused = refused &&
+                  !LoadWorldMap(&context->thread, &context->memory, &context->worldArena, world, "bench.map");
+
+        bool32 kept = memcmp(cells, world->cells, cellCount * sizeof(Cell)) == 0;
+        printf("map with %s: %s, world %s\n", corruptions[corruptionIndex].name, refused ? "refused" : "LOADED",
+               kept ? "kept" : "CHANGED");
+        Assert(refused && kept);
+    }
+
+    uint8 wholeRun[] = {GRASS, 0x80, 0x7D};
+    MapBuffer map    = EncodeWorldMap(world, &context->tempArena);
+    BenchReplaceBiomeRuns(map, wholeRun, sizeof(wholeRun));
+
+    world = DecodeWorldMap(&context->worldArena, map.memory, map.size);
+    Assert(world && world->cells[cellCount - 1].biome == GRASS);
+
+    EndTemporaryMemory(temp);
+    unlink("bench.map");
+}
+
+internal void BenchMapFormat(BenchContext *context)
+{
+    OffsetCoord sizes[] = {{160, 100}, {4096, 4096}};
+
+    for (uint32 sizeIndex = 0; sizeIndex < ArrayCount(sizes); ++sizeIndex)
+    {
+        OffsetCoord size = sizes[sizeIndex];
+        World *world     = BenchCreateWorld(context, size.x, size.y);
+
+        uint32 blobCount = (uint32)((MemoryIndex)size.x * size.y / 200);
+        BenchPaintBlobs(context, world, blobCount, 12);
+        BenchPlaceEntities(context, world, 200);
+
+        uint32 iterationCount = size.x * size.y > 1000000 ? 3 : 200;
+        real64 bestSave       = 1e9;
+        real64 bestLoad       = 1e9;
+        real64 bestEncode     = 1e9;
+        real64 bestDecode     = 1e9;
+        MemoryIndex fileSize  = 0;
+
+        for (uint32 iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+            uint64 start  = BenchGetNanoseconds();
+            MapBuffer map = EncodeWorldMap(world, &context->tempArena);
+            bestEncode    = BenchMinimum(bestEncode, BenchMillisecondsSince(start));
+            fileSize      = map.size;
+
+            start = BenchGetNanoseconds();
+            world = DecodeWorldMap(&context->worldArena, map.memory, map.size);
+            Assert(world);
+            bestDecode = BenchMinimum(bestDecode, BenchMillisecondsSince(start));
+
+            EndTemporaryMemory(temp);
+
+            start = BenchGetNanoseconds();
+            BenchSaveRunLengthMap(context, world, "bench.map");
+            bestSave = BenchMinimum(bestSave, BenchMillisecondsSince(start));
+
+            start = BenchGetNanoseconds();
+            world = LoadWorldMap(&context->thread, &context->memory, &context->worldArena, world, "bench.map");
+            Assert(world);
+            bestLoad = BenchMinimum(bestLoad, BenchMillisecondsSince(start));
+        }
+
+        MemoryIndex rawSize = sizeof(World) + (MemoryIndex)size.x * size.y * sizeof(Cell);
+        printf("map %dx%d: file %zu bytes (raw world %zu bytes), encode %.3fms, decode %.3fms, save %.3fms, load "
+               "%.3fms\n",
+               size.x, size.y, fileSize, rawSize, bestEncode, bestDecode, bestSave, bestLoad);
+    }
+
+    BenchCorruptMaps(context);
+
+    unlink("bench.map");
+}
+
+internal MemoryIndex BenchResidentBytes()
+{
+    MemoryIndex result = 0;
+
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm)
+    {
+        unsigned long totalPages    = 0;
+        unsigned long residentPages = 0;
+
+        if (fscanf(statm, "%lu %lu", &totalPages, &residentPages) == 2)
+        {
+            result = (MemoryIndex)residentPages * sysconf(_SC_PAGESIZE);
+        }
+
+        fclose(statm);
+    }
+
+    return result;
+}
+
+// NOTE drops every page of the world arena so resident memory only counts what paging brings back in.
+internal void BenchReleaseWorldArena(BenchContext *context)
+{
+    madvise(context->worldArena.base, context->worldArena.size, MADV_DONTNEED);
+    context->worldArena.used = 0;
+}
+
+// NOTE writes a chunked map straight into the file mapping, for maps too big to ever be resident as a World.
+internal void BenchWriteSyntheticChunkedMap(BenchContext *context, int32 width, int32 height, char *fileName)
+{
+    MemoryIndex size     = LayoutChunkedMap(0, width, height, 0);
+    DebugMappedFile file = context->memory.debugPlatformMapFile(&context->thread, fileName, size);
+    Assert(file.memory);
+
+    MapChunkedView view = {};
+    LayoutChunkedMap((uint8 *)file.memory, width, height, &view);
+
+    uint32 chunkCount = view.table->chunkCountX * view.table->chunkCountY;
+    for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+    {
+        uint8 *chunk = view.chunkData + (MemoryIndex)chunkIndex * view.table->chunkSize;
+
+        for (uint32 blockIndex = 0; blockIndex < 16; ++blockIndex)
+        {
+            uint8 biome  = (uint8)BenchRandomBetween(context, 0, BIOME_COUNT - 1);
+            uint32 minY  = (blockIndex / 4) * (WORLD_CHUNK_DIM / 4);
+            uint32 minX  = (blockIndex % 4) * (WORLD_CHUNK_DIM / 4);
+            uint8 *block = chunk + minY * WORLD_CHUNK_DIM + minX;
+
+            for (uint32 y = 0; y < WORLD_CHUNK_DIM / 4; ++y)
+            {
+                memset(block + y * WORLD_CHUNK_DIM, biome, WORLD_CHUNK_DIM / 4);
+            }
+        }
+
+        view.chunkChecksums[chunkIndex] = Crc32(0, chunk, view.table->chunkSize);
+    }
+
+    FinalizeChunkedMap(&view);
+    context->memory.debugPlatformFlushMappedFile(&context->thread, &file);
+    context->memory.debugPlatformUnmapFile(&context->thread, &file);
+}
+
+internal void BenchMapPaging(BenchContext *context)
+{
+    int32 sizes[] = {4096, 16384};
+
+    for (uint32 sizeIndex = 0; sizeIndex < ArrayCount(sizes); ++sizeIndex)
+    {
+        int32 size   = sizes[sizeIndex];
+        uint64 start = BenchGetNanoseconds();
+
+        if (size <= 4096)
+        {
+            World *world = BenchCreateWorld(context, size, size);
+            BenchPaintBlobs(context, world, (uint32)((MemoryIndex)size * size / 200), 12);
+            BenchPlaceEntities(context, world, 200);
+
+            start = BenchGetNanoseconds();
+            SaveWorldMap(&context->thread, &context->memory, world, &context->tempArena, "bench_paged.map");
+        }
+        else
+        {
+            BenchWriteSyntheticChunkedMap(context, size, size, "bench_paged.map");
+        }
+
+        real64 writeTime = BenchMillisecondsSince(start);
+
+        BenchReleaseWorldArena(context);
+        MemoryIndex baseResident = BenchResidentBytes();
+
+        start        = BenchGetNanoseconds();
+        World *world = LoadWorldMap(&context->thread, &context->memory, &context->worldArena, 0, "bench_paged.map");
+        real64 openTime = BenchMillisecondsSince(start);
+        Assert(world && world->pager);
+
+        MemoryIndex openResident = BenchResidentBytes();
+
+        // NOTE roughly what the renderer touches for one screen at the closest zoom.
+        int32 viewWidth  = 64;
+        int32 viewHeight = 40;
+        int32 centerX    = size / 2;
+        int32 centerY    = size / 2;
+
+        start = BenchGetNanoseconds();
+        for (int32 y = centerY - viewHeight / 2; y < centerY + viewHeight / 2; ++y)
+        {
+            for (int32 x = centerX - viewWidth / 2; x < centerX + viewWidth / 2; ++x)
+            {
+                GetCell(world, OffsetCoord{x, y});
+            }
+        }
+        real64 viewTime = BenchMillisecondsSince(start);
+
+        MemoryIndex viewResident = BenchResidentBytes();
+
+        for (int32 paintIndex = 0; paintIndex < 1000; ++paintIndex)
+        {
+            Cell *cell = GetCell(world, OffsetCoord{centerX + paintIndex % 50, centerY + paintIndex / 50});
+            SetCellBiome(world, cell, (Biome)(paintIndex % BIOME_COUNT));
+        }
+
+        uint32 dirtyChunkCount = world->pager->dirtyChunkCount;
+
+        start = BenchGetNanoseconds();
+        FlushWorldPager(&context->thread, &context->memory, world, &context->tempArena);
+        real64 flushTime = BenchMillisecondsSince(start);
+
+        printf("paging %dx%d: file %llu bytes, write %.1fms, open %.3fms (+%zu KB resident), first view %.3fms "
+               "(%u chunks, +%zu KB resident, %zu MB of world arena), flush %u dirty chunks %.3fms\n",
+               size, size, (unsigned long long)world->pager->file.size, writeTime, openTime,
+               (openResident - baseResident) / 1024, viewTime, world->pager->residentChunkCount,
+               (viewResident - openResident) / 1024, context->worldArena.used / (1024 * 1024), dirtyChunkCount,
+               flushTime);
+
+        // NOTE crashes halfway through writing the next paint back: the chunk log is on disk, the mapping has one of
+        // its chunks torn and a header that no longer checks out. Opening the map again has to bring all of it back.
+        for (int32 paintIndex = 0; paintIndex < 1000; ++paintIndex)
+        {
+            Cell *cell = GetCell(world, OffsetCoord{centerX + paintIndex % 50, centerY + paintIndex / 50});
+            SetCellBiome(world, cell, (Biome)((paintIndex + 1) % BIOME_COUNT));
+        }
+
+        TemporaryMemory logMemory = StartTemporaryMemory(&context->tempArena);
+
+        WorldPager *pager = world->pager;
+        uint32 tornChunk  = pager->dirtyChunks[0];
+        MapBuffer log     = StageWorldPager(world, &context->tempArena);
+
+        context->memory.debugPlatformWriteEntireFile(&context->thread, pager->chunkLogFileName,
+                                                     SafeTruncateUInt64(log.size), log.memory);
+        memset(pager->view.chunkData + (MemoryIndex)tornChunk * pager->view.table->chunkSize, 0xFF,
+               pager->view.table->chunkSize / 2);
+        ++pager->view.header->checksum;
+
+        EndTemporaryMemory(logMemory);
+
+        context->memory.debugPlatformUnmapFile(&context->thread, &pager->file);
+        BenchReleaseWorldArena(context);
+
+        start = BenchGetNanoseconds();
+        world = LoadWorldMap(&context->thread, &context->memory, &context->worldArena, 0, "bench_paged.map");
+        real64 recoverTime = BenchMillisecondsSince(start);
+
+        uint32 recoveredCount = 0;
+        for (int32 paintIndex = 0; world && paintIndex < 1000; ++paintIndex)
+        {
+            Cell *cell = GetCell(world, OffsetCoord{centerX + paintIndex % 50, centerY + paintIndex / 50});
+            recoveredCount += cell->biome == (Biome)((paintIndex + 1) % BIOME_COUNT);
+        }
+
+        DebugReadFileResult leftover =
+            context->memory.debugPlatformReadEntireFile(&context->thread, "bench_paged.map.chunks");
+
+        printf("paging %dx%d: crash while writing back, reopened in %.3fms with %u of 1000 cells painted, "
+               "chunk log %s\n",
+               size, size, recoverTime, recoveredCount, leftover.contentsSize ? "left behind" : "emptied");
+
+        if (leftover.contents)
+        {
+            context->memory.debugPlatformFreeFileMemory(&context->thread, leftover.contents);
+        }
+
+        if (world)
+        {
+            context->memory.debugPlatformUnmapFile(&context->thread, &world->pager->file);
+        }
+
+        BenchReleaseWorldArena(context);
+    }
+
+    unlink("bench_paged.map");
+    unlink("bench_paged.map.chunks");
+}
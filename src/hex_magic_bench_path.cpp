@@ -0,0 +1,551 @@
+// NOTE random queries between passable cells of a grass map covered in blobs of every biome, so routes have to get
+// around lakes, lava and rock. Queries whose goal is walled off explore everything reachable before giving up, those
+// are what the tail is made of.
+internal void BenchPath(BenchContext *context)
+{
+    int32 size   = 1024;
+    World *world = BenchCreateWorld(context, size, size);
+
+    for (MemoryIndex cellIndex = 0; cellIndex < (MemoryIndex)size * size; ++cellIndex)
+    {
+        world->cells[cellIndex].biome = GRASS;
+    }
+
+    BenchPaintBlobs(context, world, 3000, 12);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    PathCostTable costs    = MakeHeroPathCosts();
+    Pathfinder *pathfinder = PushStruct(&context->tempArena, Pathfinder);
+    InitializePathfinder(pathfinder, &context->tempArena, (MemoryIndex)size * size);
+
+    uint32 queryCount = 10000;
+    real64 *times     = PushArray(&context->tempArena, queryCount, real64);
+    uint32 foundCount = 0;
+    uint64 expanded   = 0;
+    uint64 pathCells  = 0;
+    real64 totalTime  = 0.0;
+
+    for (uint32 queryIndex = 0; queryIndex < queryCount; ++queryIndex)
+    {
+        OffsetCoord start = BenchRandomPassableCell(context, world, &costs);
+        OffsetCoord goal  = BenchRandomPassableCell(context, world, &costs);
+
+        TemporaryMemory pathMemory = StartTemporaryMemory(&context->tempArena);
+
+        uint64 queryStart = BenchGetNanoseconds();
+        Path path         = FindPath(pathfinder, world, &costs, start, goal, &context->tempArena);
+        times[queryIndex] = BenchMillisecondsSince(queryStart);
+
+        EndTemporaryMemory(pathMemory);
+
+        totalTime += times[queryIndex];
+        expanded += pathfinder->expandedCount;
+
+        if (path.found)
+        {
+            ++foundCount;
+            pathCells += path.cellCount;
+        }
+    }
+
+    real64 p50 = BenchPercentile(times, queryCount, 50.0);
+    real64 p99 = BenchPercentile(times, queryCount, 99.0);
+
+    printf("path %dx%d: %u queries, %u found, mean path %llu cells, mean %llu cells expanded, mean %.3fms, p50 "
+           "%.3fms, p99 %.3fms, max %.3fms\n",
+           size, size, queryCount, foundCount, (unsigned long long)(foundCount ? pathCells / foundCount : 0),
+           (unsigned long long)(expanded / queryCount), totalTime / queryCount, p50, p99, times[queryCount - 1]);
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE long routes are the ones the hierarchical graph is for, so every query here crosses at least half the map.
+internal void BenchHpa(BenchContext *context)
+{
+    int32 sizes[]        = {1024, 2048, 4096};
+    uint32 queryCounts[] = {100, 40, 10};
+
+    for (uint32 sizeIndex = 0; sizeIndex < ArrayCount(sizes); ++sizeIndex)
+    {
+        int32 size   = sizes[sizeIndex];
+        World *world = BenchCreateWorld(context, size, size);
+
+        for (MemoryIndex cellIndex = 0; cellIndex < (MemoryIndex)size * size; ++cellIndex)
+        {
+            world->cells[cellIndex].biome = GRASS;
+        }
+
+        BenchPaintBlobs(context, world, 3000 * (size / 1024) * (size / 1024), 12);
+
+        TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+        PathCostTable costs  = MakeHeroPathCosts();
+
+        Pathfinder *pathfinder = PushStruct(&context->tempArena, Pathfinder);
+        InitializePathfinder(pathfinder, &context->tempArena, (MemoryIndex)size * size);
+
+        HpaGraph *graph = PushStruct(&context->tempArena, HpaGraph);
+
+        uint64 buildStart = BenchGetNanoseconds();
+        InitializeHpaGraph(graph, &context->tempArena, world, &costs);
+        UpdateHpaGraph(graph, world, &context->memory);
+        FinishHpaBuild(graph, &context->memory);
+        real64 buildTime = BenchMillisecondsSince(buildStart);
+
+        uint32 nodeCount = 0;
+        for (uint32 clusterIndex = 0; clusterIndex < graph->clusterCount; ++clusterIndex)
+        {
+            nodeCount += graph->clusters[clusterIndex].nodeCount;
+        }
+
+        printf("hpa %dx%d: built %u clusters with %u nodes in %.1fms\n", size, size, graph->clusterCount, nodeCount,
+               buildTime);
+
+        uint32 queryCount   = queryCounts[sizeIndex];
+        uint32 foundCount   = 0;
+        uint64 hpaCost      = 0;
+        uint64 flatCost     = 0;
+        uint64 hpaExpanded  = 0;
+        uint64 flatExpanded = 0;
+        real64 hpaTime      = 0.0;
+        real64 flatTime     = 0.0;
+
+        for (uint32 queryIndex = 0; queryIndex < queryCount; ++queryIndex)
+        {
+            OffsetCoord start = {};
+            OffsetCoord goal  = {};
+
+            do
+            {
+                start = BenchRandomPassableCell(context, world, &costs);
+                goal  = BenchRandomPassableCell(context, world, &costs);
+            } while (Distance(HexFromOffset(start), HexFromOffset(goal)) < (uint32)size / 2);
+
+            TemporaryMemory pathMemory = StartTemporaryMemory(&context->tempArena);
+
+            uint64 queryStart = BenchGetNanoseconds();
+            Path hpaPath      = FindHpaPath(graph, world, start, goal, &context->tempArena);
+            hpaTime += BenchMillisecondsSince(queryStart);
+            hpaExpanded += graph->expandedCount;
+
+            queryStart    = BenchGetNanoseconds();
+            Path flatPath = FindPath(pathfinder, world, &costs, start, goal, &context->tempArena);
+            flatTime += BenchMillisecondsSince(queryStart);
+            flatExpanded += pathfinder->expandedCount;
+
+            EndTemporaryMemory(pathMemory);
+
+            if (hpaPath.found && flatPath.found)
+            {
+                ++foundCount;
+                hpaCost += hpaPath.cost;
+                flatCost += flatPath.cost;
+            }
+            else if (hpaPath.found != flatPath.found)
+            {
+                printf("hpa %dx%d: query %u found by only one of the searches\n", size, size, queryIndex);
+            }
+        }
+
+        printf("hpa %dx%d: %u long queries, %u found, mean %.3fms (%llu abstract nodes expanded) against flat A* "
+               "%.3fms (%llu cells expanded), routes %.2f%% longer\n",
+               size, size, queryCount, foundCount, hpaTime / queryCount,
+               (unsigned long long)(hpaExpanded / queryCount), flatTime / queryCount,
+               (unsigned long long)(flatExpanded / queryCount),
+               flatCost ? 100.0 * ((real64)hpaCost - (real64)flatCost) / (real64)flatCost : 0.0);
+
+        // NOTE an edit through the editor only rebuilds the clusters around the cells it touched.
+        Editor editor = BenchCreateEditor(context, "bench_hpa", Megabytes(16));
+        editor.hpa    = graph;
+
+        FillSpanList spans = MakeFillSpanList(&context->tempArena, 64);
+        HexagonFillSpans(world, HexFromOffset(OffsetCoord{size / 2, size / 2}), 8, &spans);
+
+        BeginUndoStroke(editor.undo);
+        EditorPaintSpans(&editor, world, &spans, ROCK);
+        EndUndoStroke(editor.undo);
+
+        uint64 rebuildStart = BenchGetNanoseconds();
+        UpdateHpaGraph(graph, world, &context->memory);
+        FinishHpaBuild(graph, &context->memory);
+        real64 rebuildTime = BenchMillisecondsSince(rebuildStart);
+
+        printf("hpa %dx%d: brush edit of %llu cells rebuilt %u clusters in %.3fms\n", size, size,
+               (unsigned long long)spans.cellCount, graph->lastBuildClusterCount, rebuildTime);
+
+        // NOTE on a single core nothing runs the jobs, so the main thread builds a slice of the clusters every frame
+        // and hovering a long route falls back to the flat search until the graph is done.
+        uint32 workerCount                      = context->memory.highPriorityWorkerCount;
+        context->memory.highPriorityWorkerCount = 0;
+
+        for (uint32 clusterIndex = 0; clusterIndex < graph->clusterCount; ++clusterIndex)
+        {
+            MarkHpaClusterDirty(graph, clusterIndex);
+        }
+
+        uint32 sliceFrameCount = 0;
+        real64 worstSlice      = 0.0;
+        real64 totalSlice      = 0.0;
+
+        do
+        {
+            uint64 sliceStart = BenchGetNanoseconds();
+            UpdateHpaGraph(graph, world, &context->memory);
+
+            real64 sliceTime = BenchMillisecondsSince(sliceStart);
+            worstSlice       = BenchMaximum(worstSlice, sliceTime);
+            totalSlice += sliceTime;
+            ++sliceFrameCount;
+        } while (!IsHpaGraphReady(graph));
+
+        context->memory.highPriorityWorkerCount = workerCount;
+
+        printf("hpa %dx%d: no worker threads, full rebuild spread over %u frames, worst frame %.3fms, %.1fms in all\n",
+               size, size, sliceFrameCount, worstSlice, totalSlice);
+
+        FlushJournal(editor.journal, world);
+        EndTemporaryMemory(temp);
+
+        unlink("bench_hpa.log");
+    }
+}
+
+// NOTE a field to a handful of cities over a whole 2048x2048 map, built both ways, and then walked by a crowd of units
+// against running A* for each of them.
+internal void BenchFlow(BenchContext *context)
+{
+    int32 size   = 2048;
+    World *world = BenchCreateWorld(context, size, size);
+
+    for (MemoryIndex cellIndex = 0; cellIndex < (MemoryIndex)size * size; ++cellIndex)
+    {
+        world->cells[cellIndex].biome = GRASS;
+    }
+
+    BenchPaintBlobs(context, world, 12000, 12);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    PathCostTable costs  = MakeHeroPathCosts();
+
+    FlowFieldCache *cache = PushStruct(&context->tempArena, FlowFieldCache);
+    InitializeFlowFieldCache(cache, &context->tempArena, (MemoryIndex)size * size);
+
+    OffsetCoord targets[4];
+    for (uint32 targetIndex = 0; targetIndex < ArrayCount(targets); ++targetIndex)
+    {
+        targets[targetIndex] = BenchRandomPassableCell(context, world, &costs);
+    }
+
+    OffsetCoord regionMin = {0, 0};
+    OffsetCoord regionMax = {size - 1, size - 1};
+
+    FlowField *field = GetFlowField(cache, world, &context->memory, &costs, targets, ArrayCount(targets), regionMin,
+                                    regionMax);
+
+    uint32 *expected = PushArray(&context->tempArena, (MemoryIndex)size * size, uint32);
+    uint32 runCount  = 5;
+
+    real64 singleTime = 0.0;
+    for (uint32 runIndex = 0; runIndex < runCount; ++runIndex)
+    {
+        uint64 buildStart = BenchGetNanoseconds();
+        BuildFlowField(cache, field, world);
+        singleTime += BenchMillisecondsSince(buildStart);
+    }
+
+    memcpy(expected, field->distances, (MemoryIndex)size * size * sizeof(uint32));
+
+    real64 jobTime = 0.0;
+    for (uint32 runIndex = 0; runIndex < runCount; ++runIndex)
+    {
+        uint64 buildStart = BenchGetNanoseconds();
+        BuildFlowFieldWithJobs(cache, field, world, &context->memory);
+        jobTime += BenchMillisecondsSince(buildStart);
+    }
+
+    uint32 mismatchCount = 0;
+    uint32 reachedCount  = 0;
+    for (MemoryIndex cellIndex = 0; cellIndex < (MemoryIndex)size * size; ++cellIndex)
+    {
+        mismatchCount += field->distances[cellIndex] != expected[cellIndex];
+        reachedCount += field->distances[cellIndex] != FLOW_UNREACHABLE;
+    }
+
+    printf("flow %dx%d: %u targets, %u cells reached, single-threaded %.1fms, tiled on %u worker threads %.1fms "
+           "(%u passes, %u tile runs), %u cells differ\n",
+           size, size, (uint32)ArrayCount(targets), reachedCount, singleTime / runCount,
+           LinuxGetWorkerThreadCount(), jobTime / runCount, cache->lastBuildPassCount, cache->lastBuildTileCount,
+           mismatchCount);
+
+    uint64 lookupStart = BenchGetNanoseconds();
+    FlowField *cached =
+        GetFlowField(cache, world, &context->memory, &costs, targets, ArrayCount(targets), regionMin, regionMax);
+    real64 lookupTime = BenchMillisecondsSince(lookupStart);
+
+    printf("flow %dx%d: cached lookup %.4fms, %s\n", size, size, lookupTime,
+           cached == field ? "same field" : "rebuilt");
+
+    Pathfinder *pathfinder = PushStruct(&context->tempArena, Pathfinder);
+    InitializePathfinder(pathfinder, &context->tempArena, (MemoryIndex)size * size);
+
+    uint32 unitCount = 100;
+    uint64 stepCount = 0;
+    uint64 flowCost  = 0;
+    uint64 pathCost  = 0;
+    real64 flowTime  = 0.0;
+    real64 pathTime  = 0.0;
+
+    for (uint32 unitIndex = 0; unitIndex < unitCount; ++unitIndex)
+    {
+        OffsetCoord start = BenchRandomPassableCell(context, world, &costs);
+        if (GetFlowDistance(field, start) == FLOW_UNREACHABLE)
+        {
+            continue;
+        }
+
+        uint64 walkStart = BenchGetNanoseconds();
+        OffsetCoord at   = start;
+        for (;;)
+        {
+            OffsetCoord next = GetFlowStep(field, at);
+            if (next.x == at.x && next.y == at.y)
+            {
+                break;
+            }
+
+            flowCost += costs.costs[world->cells[(MemoryIndex)next.y * size + next.x].biome];
+            ++stepCount;
+            at = next;
+        }
+        flowTime += BenchMillisecondsSince(walkStart);
+
+        // NOTE A* only knows one goal, so it gets the target the field led to.
+        TemporaryMemory pathMemory = StartTemporaryMemory(&context->tempArena);
+
+        uint64 pathStart = BenchGetNanoseconds();
+        Path path        = FindPath(pathfinder, world, &costs, start, at, &context->tempArena);
+        pathTime += BenchMillisecondsSince(pathStart);
+
+        EndTemporaryMemory(pathMemory);
+
+        pathCost += path.cost;
+    }
+
+    printf("flow %dx%d: %u units walked %llu steps in %.3fms, A* to the same targets %.1fms, route costs %llu vs "
+           "%llu\n",
+           size, size, unitCount, (unsigned long long)stepCount, flowTime, pathTime, (unsigned long long)flowCost,
+           (unsigned long long)pathCost);
+
+    // NOTE painting anywhere in the region drops the field.
+    Editor editor      = BenchCreateEditor(context, "bench_flow", Megabytes(16));
+    editor.flowFields  = cache;
+    FillSpanList spans = MakeFillSpanList(&context->tempArena, 64);
+    HexagonFillSpans(world, HexFromOffset(OffsetCoord{size / 2, size / 2}), 8, &spans);
+
+    BeginUndoStroke(editor.undo);
+    EditorPaintSpans(&editor, world, &spans, ROCK);
+    EndUndoStroke(editor.undo);
+    FlushJournal(editor.journal, world);
+
+    uint64 rebuildStart = BenchGetNanoseconds();
+    field = GetFlowField(cache, world, &context->memory, &costs, targets, ArrayCount(targets), regionMin, regionMax);
+    real64 rebuildTime = BenchMillisecondsSince(rebuildStart);
+
+    printf("flow %dx%d: after a brush edit the field was rebuilt in %.1fms\n", size, size, rebuildTime);
+
+    EndTemporaryMemory(temp);
+    unlink("bench_flow.log");
+}
+
+internal void BenchRange(BenchContext *context)
+{
+    int32 size   = 1024;
+    World *world = BenchCreateWorld(context, size, size);
+
+    for (MemoryIndex cellIndex = 0; cellIndex < (MemoryIndex)size * size; ++cellIndex)
+    {
+        world->cells[cellIndex].biome = GRASS;
+    }
+
+    BenchPaintBlobs(context, world, 3000, 12);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    PathCostTable costs  = MakeHeroPathCosts();
+
+    MovementRange *range = PushStruct(&context->tempArena, MovementRange);
+    InitializeMovementRange(range, &context->tempArena);
+
+    uint32 queryCount = 10000;
+    real64 *times     = PushArray(&context->tempArena, queryCount, real64);
+    uint64 cellCount  = 0;
+    real64 totalTime  = 0.0;
+
+    for (uint32 queryIndex = 0; queryIndex < queryCount; ++queryIndex)
+    {
+        HexCoord origin = HexFromOffset(BenchRandomPassableCell(context, world, &costs));
+
+        uint64 queryStart = BenchGetNanoseconds();
+        FindMovementRange(range, world, &costs, origin, HERO_MOVE_POINTS);
+        times[queryIndex] = BenchMillisecondsSince(queryStart);
+
+        totalTime += times[queryIndex];
+        cellCount += range->cellCount;
+    }
+
+    real64 p50 = BenchPercentile(times, queryCount, 50.0);
+    real64 p99 = BenchPercentile(times, queryCount, 99.0);
+
+    printf("range %dx%d: %u queries of %u move points (radius %u), mean %llu cells reached, mean %.4fms, p50 %.4fms, "
+           "p99 %.4fms, max %.4fms\n",
+           size, size, queryCount, HERO_MOVE_POINTS, range->radius,
+           (unsigned long long)(cellCount / queryCount), totalTime / queryCount, p50, p99, times[queryCount - 1]);
+
+    EndTemporaryMemory(temp);
+}
+
+// NOTE heroes wander a step at a time over a blob map, and each step only updates the fog around where the hero was
+// and where it is now. The game has no hero moves yet, so this is the only place moves go through the fog. The
+// visible planes are then checked against a fog built from scratch with every hero where it ended up.
+internal void BenchFog(BenchContext *context)
+{
+    int32 size   = 2048;
+    World *world = BenchCreateWorld(context, size, size);
+
+    for (MemoryIndex cellIndex = 0; cellIndex < (MemoryIndex)size * size; ++cellIndex)
+    {
+        world->cells[cellIndex].biome = GRASS;
+    }
+
+    BenchPaintBlobs(context, world, 12000, 12);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    PathCostTable costs  = MakeHeroPathCosts();
+
+    uint32 heroCount = 200;
+    for (uint32 heroIndex = 0; heroIndex < heroCount; ++heroIndex)
+    {
+        Cell *cell = GetCell(world, BenchRandomPassableCell(context, world, &costs));
+        if (PlaceEntity(world, cell, ENTITY_HERO))
+        {
+            GetEntity(world, cell->heroIndex)->player = heroIndex % MAX_PLAYER_COUNT;
+        }
+    }
+
+    FogOfWar *fog = PushStruct(&context->tempArena, FogOfWar);
+
+    uint64 start = BenchGetNanoseconds();
+    InitializeFog(fog, &context->tempArena, world);
+    UpdateFog(fog, world);
+    real64 buildTime = BenchMillisecondsSince(start);
+
+    uint32 stepCount   = 20000;
+    real64 *times      = PushArray(&context->tempArena, stepCount, real64);
+    real64 totalTime   = 0.0;
+    uint64 cellCount   = 0;
+    uint64 viewerCount = 0;
+
+    for (uint32 stepIndex = 0; stepIndex < stepCount; ++stepIndex)
+    {
+        uint32 entityIndex = (uint32)BenchRandomBetween(context, 1, world->entityCount);
+        Entity *entity     = GetEntity(world, entityIndex);
+        Cell *from         = GetEntityCell(world, entityIndex);
+
+        if (entity->type != ENTITY_HERO || !from)
+        {
+            times[stepIndex] = 0.0;
+            continue;
+        }
+
+        HexCoord toHex = from->coord + globalHexDirections[BenchRandomBetween(context, 0, 5)];
+        Cell *to       = GetCell(world, toHex);
+
+        uint64 stepStart = BenchGetNanoseconds();
+        if (to && !to->heroIndex && costs.costs[to->biome])
+        {
+            OffsetCoord fromOffset = OffsetFromHex(from->coord);
+            OffsetCoord toOffset   = OffsetFromHex(to->coord);
+
+            LinkEntity(to, ENTITY_HERO, UnlinkEntity(from, ENTITY_HERO));
+            entity->position = to->position;
+
+            MarkFogDirty(fog, fromOffset.x, fromOffset.y);
+            MarkFogDirty(fog, toOffset.x, toOffset.y);
+            UpdateFog(fog, world);
+
+            cellCount += fog->lastUpdateCellCount;
+            viewerCount += fog->lastUpdateViewerCount;
+        }
+        times[stepIndex] = BenchMillisecondsSince(stepStart);
+
+        totalTime += times[stepIndex];
+    }
+
+    FogOfWar *check = PushStruct(&context->tempArena, FogOfWar);
+    InitializeFog(check, &context->tempArena, world);
+    UpdateFog(check, world);
+
+    uint64 visibleMismatchCount   = 0;
+    uint64 unexploredVisibleCount = 0;
+    uint64 exploredCount          = 0;
+
+    for (MemoryIndex chunkIndex = 0; chunkIndex < (MemoryIndex)MAX_PLAYER_COUNT * fog->chunkCount; ++chunkIndex)
+    {
+        for (uint32 row = 0; row < WORLD_CHUNK_DIM; ++row)
+        {
+            uint64 visible = fog->chunks[chunkIndex].visible[row];
+
+            visibleMismatchCount += __builtin_popcountll(visible ^ check->chunks[chunkIndex].visible[row]);
+            unexploredVisibleCount += __builtin_popcountll(visible & ~fog->chunks[chunkIndex].explored[row]);
+            exploredCount += __builtin_popcountll(fog->chunks[chunkIndex].explored[row]);
+        }
+    }
+
+    // NOTE how long going over the whole map for the local player takes, testing a cell at a time against skipping
+    // the rows of chunks that were never explored a word at a time.
+    uint64 perCellCount = 0;
+    start               = BenchGetNanoseconds();
+    for (int32 y = 0; y < size; ++y)
+    {
+        for (int32 x = 0; x < size; ++x)
+        {
+            perCellCount += IsFogExplored(fog, LOCAL_PLAYER, {x, y});
+        }
+    }
+    real64 perCellTime = BenchMillisecondsSince(start);
+
+    uint64 perWordCount = 0;
+    start               = BenchGetNanoseconds();
+    for (int32 y = 0; y < size; ++y)
+    {
+        for (int32 x = 0; x < size; ++x)
+        {
+            uint64 exploredRow = GetFogExploredRow(fog, LOCAL_PLAYER, x, y);
+            uint32 bit         = x & WORLD_CHUNK_MASK;
+
+            if (!(exploredRow >> bit))
+            {
+                x += WORLD_CHUNK_MASK - bit;
+                continue;
+            }
+
+            perWordCount += (exploredRow >> bit) & 1;
+        }
+    }
+    real64 perWordTime = BenchMillisecondsSince(start);
+
+    real64 p50 = BenchPercentile(times, stepCount, 50.0);
+    real64 p99 = BenchPercentile(times, stepCount, 99.0);
+
+    printf("fog %dx%d: %u heroes, %u players, vision %d, full build %.2fms\n", size, size, heroCount, MAX_PLAYER_COUNT,
+           HERO_VISION_RADIUS, buildTime);
+    printf("fog steps: %u, mean %.4fms, p50 %.4fms, p99 %.4fms, max %.4fms, %llu cells and %llu heroes per step\n",
+           stepCount, totalTime / stepCount, p50, p99, times[stepCount - 1],
+           (unsigned long long)(cellCount / stepCount), (unsigned long long)(viewerCount / stepCount));
+    printf("fog check: %llu cells visible differently from a full rebuild, %llu visible but unexplored, %llu explored\n",
+           (unsigned long long)visibleMismatchCount, (unsigned long long)unexploredVisibleCount,
+           (unsigned long long)exploredCount);
+    printf("fog scan: %llu explored cells, per cell %.2fms, per word %.2fms (%s)\n", (unsigned long long)perWordCount,
+           perCellTime, perWordTime, perCellCount == perWordCount ? "match" : "MISMATCH");
+
+    EndTemporaryMemory(temp);
+}
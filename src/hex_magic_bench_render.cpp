@@ -0,0 +1,344 @@
+// NOTE what text cost before it had an entry of its own, a screen bitmap per glyph blended in floats.
+internal void BenchDrawTextPerGlyph(GameOffscreenBuffer *buffer, Font *font, V2 position, char *text, V4 color)
+{
+    color.rgb *= color.a;
+
+    real32 penX         = position.x;
+    int32 baselineY     = RoundReal32ToInt32(position.y + font->ascent);
+    FontGlyph *previous = 0;
+
+    for (char *at = text; *at; ++at)
+    {
+        FontGlyph *glyph = GetFontGlyph(font, *at);
+
+        if (glyph)
+        {
+            penX += GetFontKerning(font, previous, glyph);
+
+            int32 minX = RoundReal32ToInt32(penX) + glyph->offsetX;
+            int32 minY = baselineY + glyph->offsetY;
+
+            for (int32 y = 0; y < glyph->height; ++y)
+            {
+                for (int32 x = 0; x < glyph->width; ++x)
+                {
+                    if (minX + x >= 0 && minX + x < buffer->width && minY + y >= 0 && minY + y < buffer->height)
+                    {
+                        uint8 *sourceRow = (uint8 *)font->atlas->memory + (glyph->y + y) * font->atlas->pitch;
+                        uint8 *destRow   = (uint8 *)buffer->memory + (minY + y) * buffer->pitch;
+                        uint32 *source   = (uint32 *)sourceRow + glyph->x + x;
+                        uint32 *dest     = (uint32 *)destRow + minX + x;
+
+                        V4 texel = Hadamard(Unpack(*source), color);
+                        *dest    = Pack((1.0f - texel.a / 255.0f) * Unpack(*dest) + texel);
+                    }
+                }
+            }
+
+            penX += glyph->advance;
+        }
+
+        previous = glyph;
+    }
+}
+
+// NOTE lines of text in every font of the atlas down a frame, over and over until there are glyphCount glyphs.
+internal uint32 BenchPushTextFrame(Renderer *renderer, FontAtlas *fontAtlas, GameOffscreenBuffer *buffer,
+                                   uint32 glyphCount, bool32 isTranslucent, GameOffscreenBuffer *reference)
+{
+    char *lines[] = {
+        "The quick brown fox jumps over the lazy dog. AVAWAY Tomorrow, 1234567890!",
+        "SWAMP (rough) -> lava: 12.5 Mc, 42 hits; {hero} at [160, 100] ~ \"yes\" & 'no' ?",
+        "Hex Magic: Water, Sand, Snow, Dirt, Grass, Rock, Swamp, Lava | To Ty Va We Yo",
+    };
+
+    uint32 result = 0;
+    real32 y      = 0.0f;
+
+    for (uint32 lineIndex = 0; result < glyphCount; ++lineIndex)
+    {
+        FontStyle style = (FontStyle)(lineIndex % FONT_STYLE_COUNT);
+        FontSize size   = (FontSize)((lineIndex / FONT_STYLE_COUNT) % FONT_SIZE_COUNT);
+        Font *font      = GetFont(fontAtlas, style, size);
+        char *text      = lines[lineIndex % ArrayCount(lines)];
+
+        V2 position = {(real32)(lineIndex % 7) * 3.3f - 4.0f, y};
+        V4 color    = {0.9f, 0.8f - 0.1f * (lineIndex % 3), 0.3f, isTranslucent ? 0.6f : 1.0f};
+
+        if (reference)
+        {
+            BenchDrawTextPerGlyph(reference, font, position, text, color);
+        }
+        else
+        {
+            RendererPushText(renderer, font, position, text, color);
+        }
+
+        result += (uint32)strlen(text);
+
+        y += font->lineAdvance;
+        if (y > buffer->height)
+        {
+            y = -8.0f;
+        }
+    }
+
+    return result;
+}
+
+internal void BenchFillTextBackground(GameOffscreenBuffer *buffer)
+{
+    uint32 *pixels = (uint32 *)buffer->memory;
+
+    for (int32 y = 0; y < buffer->height; ++y)
+    {
+        for (int32 x = 0; x < buffer->width; ++x)
+        {
+            pixels[y * buffer->width + x] =
+                0xFF000000 | (((x * 7) & 0xFF) << 16) | (((y * 3) & 0xFF) << 8) | ((x ^ y) & 0xFF);
+        }
+    }
+}
+
+// NOTE bakes the atlas the game bakes at startup and draws a few thousand glyphs a frame with the text entry, against
+// a bitmap blend per glyph. Both have to come out the same but for rounding.
+internal void BenchText(BenchContext *context)
+{
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    FontAtlas *fontAtlas = PushStruct(&context->tempArena, FontAtlas);
+
+    uint64 bakeStart = BenchGetNanoseconds();
+    DEBUGLoadFontAtlas(&context->thread, &context->memory, fontAtlas, &context->tempArena);
+    real64 bakeTime = BenchMillisecondsSince(bakeStart);
+
+    uint32 kernedPairCount = 0;
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        for (uint32 pair = 0; pair < FONT_GLYPH_COUNT * FONT_GLYPH_COUNT; ++pair)
+        {
+            kernedPairCount += (&fontAtlas->kerning[style][0][0])[pair] != 0;
+        }
+    }
+
+    printf("text atlas %dx%d, %d styles of %d sizes, %u kerned pairs: %.2fms\n", fontAtlas->bitmap.width,
+           fontAtlas->bitmap.height, FONT_STYLE_COUNT, FONT_SIZE_COUNT, kernedPairCount, bakeTime);
+
+    if (!fontAtlas->fonts[FONT_STYLE_REGULAR][FONT_SIZE_SMALL].isValid)
+    {
+        printf("text: no font in assets/fonts/montserrat, nothing to draw\n");
+    }
+    else
+    {
+        int32 width  = 1280;
+        int32 height = 720;
+
+        uint32 *pixels          = PushArray(&context->tempArena, (width * height), uint32);
+        uint32 *referencePixels = PushArray(&context->tempArena, (width * height), uint32);
+
+        GameOffscreenBuffer buffer    = {pixels, width, height, width * 4};
+        GameOffscreenBuffer reference = {referencePixels, width, height, width * 4};
+
+        Renderer *renderer = MakeRenderer(&context->tempArena, Megabytes(4), 0);
+
+        uint32 glyphCounts[] = {1000, 5000, 20000};
+        uint32 frameCount    = 50;
+
+        for (uint32 translucent = 0; translucent < 2; ++translucent)
+        {
+            for (uint32 countIndex = 0; countIndex < ArrayCount(glyphCounts); ++countIndex)
+            {
+                uint32 glyphCount = 0;
+
+                real64 entryTime = 0.0;
+                for (uint32 frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+                {
+                    BenchFillTextBackground(&buffer);
+                    renderer->pushBufferSize = 0;
+
+                    uint64 start = BenchGetNanoseconds();
+                    glyphCount   = BenchPushTextFrame(renderer, fontAtlas, &buffer, glyphCounts[countIndex],
+                                                      translucent, 0);
+                    RenderToOutput(&buffer, renderer);
+                    entryTime += BenchMillisecondsSince(start);
+                }
+
+                real64 perGlyphTime = 0.0;
+                for (uint32 frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+                {
+                    BenchFillTextBackground(&reference);
+
+                    uint64 start = BenchGetNanoseconds();
+                    BenchPushTextFrame(renderer, fontAtlas, &reference, glyphCounts[countIndex], translucent,
+                                       &reference);
+                    perGlyphTime += BenchMillisecondsSince(start);
+                }
+
+                uint32 maxDifference = 0;
+                for (int32 pixelIndex = 0; pixelIndex < width * height; ++pixelIndex)
+                {
+                    uint32 a = ((uint32 *)buffer.memory)[pixelIndex];
+                    uint32 b = ((uint32 *)reference.memory)[pixelIndex];
+
+                    for (uint32 shift = 0; shift < 32; shift += 8)
+                    {
+                        int32 difference = (int32)((a >> shift) & 0xFF) - (int32)((b >> shift) & 0xFF);
+                        if ((uint32)Abs(difference) > maxDifference)
+                        {
+                            maxDifference = (uint32)Abs(difference);
+                        }
+                    }
+                }
+
+                printf("text %u glyphs, %s: entry %.3fms, per glyph %.3fms, %.1fx, max difference %u\n", glyphCount,
+                       translucent ? "translucent" : "opaque", entryTime / frameCount, perGlyphTime / frameCount,
+                       perGlyphTime / entryTime, maxDifference);
+
+                // NOTE past the first count the lines wrap around and get drawn over each other, and the rounding of
+                // every layer adds up.
+                if (countIndex == 0 && maxDifference > 2)
+                {
+                    printf("text: entry and per glyph blend differ by more than rounding\n");
+                    context->failed = true;
+                }
+            }
+        }
+    }
+
+    EndTemporaryMemory(temp);
+}
+
+inline bool32 BenchBitmapsMatch(Bitmap *a, Bitmap *b)
+{
+    bool32 result = a->width == b->width && a->height == b->height;
+
+    for (int32 y = 0; result && y < a->height; ++y)
+    {
+        result = memcmp((uint8 *)a->memory + y * a->pitch, (uint8 *)b->memory + y * b->pitch,
+                        a->width * BITMAP_BYTES_PER_PIXEL) == 0;
+    }
+
+    return result;
+}
+
+// NOTE compares what startup costs loading the source files against mapping the pack the packer made from them, and
+// checks that the pack holds the same texels and fonts. Touching every page of the pack is timed on its own, the game
+// only pays for that as it draws. The files DEBUGLoadBMP reads are never freed, like in the game.
+internal void BenchAssets(BenchContext *context)
+{
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    ThreadContext *thread = &context->thread;
+    GameMemory *memory    = &context->memory;
+    uint32 runCount       = 5;
+
+    Bitmap sourceBitmaps[ASSET_FONT_ATLAS] = {};
+    FontAtlas *sourceFonts                 = 0;
+
+    real64 sourceTime = 0.0;
+    for (uint32 runIndex = 0; runIndex < runCount; ++runIndex)
+    {
+        TemporaryMemory runMemory = StartTemporaryMemory(&context->tempArena);
+        uint64 start              = BenchGetNanoseconds();
+
+        for (uint32 assetIndex = 0; assetIndex < ASSET_FONT_ATLAS; ++assetIndex)
+        {
+            sourceBitmaps[assetIndex] =
+                DEBUGLoadBMP(thread, memory->debugPlatformReadEntireFile, globalAssetFileNames[assetIndex]);
+        }
+
+        sourceFonts = PushStruct(&context->tempArena, FontAtlas);
+        DEBUGLoadFontAtlas(thread, memory, sourceFonts, &context->tempArena);
+
+        real64 time = BenchMillisecondsSince(start);
+        sourceTime  = runIndex == 0 || time < sourceTime ? time : sourceTime;
+
+        // NOTE the last run is kept to check the pack against.
+        if (runIndex + 1 < runCount)
+        {
+            EndTemporaryMemory(runMemory);
+        }
+    }
+
+    printf("assets from source files: %.2fms\n", sourceTime);
+
+    AssetPack pack = {};
+    if (!OpenAssetPack(&pack, thread, memory, ASSET_PACK_FILE_NAME))
+    {
+        printf("assets: no valid %s, run the packer from data first\n", ASSET_PACK_FILE_NAME);
+    }
+    else
+    {
+        CloseAssetPack(&pack, thread, memory);
+
+        Bitmap packBitmaps[ASSET_FONT_ATLAS] = {};
+        FontAtlas *packFonts                 = PushStruct(&context->tempArena, FontAtlas);
+
+        real64 packTime  = 0.0;
+        real64 touchTime = 0.0;
+        uint32 touched   = 0;
+        for (uint32 runIndex = 0; runIndex < runCount; ++runIndex)
+        {
+            uint64 start = BenchGetNanoseconds();
+
+            OpenAssetPack(&pack, thread, memory, ASSET_PACK_FILE_NAME);
+            for (uint32 assetIndex = 0; assetIndex < ASSET_FONT_ATLAS; ++assetIndex)
+            {
+                packBitmaps[assetIndex] = GetAssetBitmap(&pack, (AssetId)assetIndex);
+            }
+
+            GetAssetFontAtlas(&pack, packFonts);
+
+            real64 time = BenchMillisecondsSince(start);
+            packTime    = runIndex == 0 || time < packTime ? time : packTime;
+
+            start = BenchGetNanoseconds();
+            for (uint64 offset = 0; offset < pack.file.size; offset += 4096)
+            {
+                touched += ((uint8 *)pack.file.memory)[offset];
+            }
+
+            time      = BenchMillisecondsSince(start);
+            touchTime = runIndex == 0 || time < touchTime ? time : touchTime;
+
+            if (runIndex + 1 < runCount)
+            {
+                CloseAssetPack(&pack, thread, memory);
+            }
+        }
+
+        printf("assets from %s, %.2f MB: %.3fms, %.3fms touching every page, %.0fx (%u)\n", ASSET_PACK_FILE_NAME,
+               (real64)pack.file.size / (1024.0 * 1024.0), packTime, touchTime, sourceTime / (packTime + touchTime),
+               touched & 1);
+
+        bool32 isSame = memcmp(sourceFonts->kerning, packFonts->kerning, sizeof(packFonts->kerning)) == 0 &&
+                        BenchBitmapsMatch(&sourceFonts->bitmap, &packFonts->bitmap);
+
+        for (uint32 assetIndex = 0; assetIndex < ASSET_FONT_ATLAS; ++assetIndex)
+        {
+            isSame = isSame && BenchBitmapsMatch(sourceBitmaps + assetIndex, packBitmaps + assetIndex);
+        }
+
+        for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+        {
+            for (uint32 size = 0; size < FONT_SIZE_COUNT; ++size)
+            {
+                Font *a = &sourceFonts->fonts[style][size];
+                Font *b = &packFonts->fonts[style][size];
+
+                isSame = isSame && a->isValid == b->isValid && a->lineAdvance == b->lineAdvance &&
+                         memcmp(a->glyphs, b->glyphs, sizeof(a->glyphs)) == 0;
+            }
+        }
+
+        if (!isSame)
+        {
+            printf("assets: %s doesn't hold what the source files do, run the packer again\n", ASSET_PACK_FILE_NAME);
+            context->failed = true;
+        }
+
+        CloseAssetPack(&pack, thread, memory);
+    }
+
+    EndTemporaryMemory(temp);
+}
@@ -0,0 +1,452 @@
+// NOTE a hot seat game far bigger than a world can hold. Everybody owns cities and heroes, and a tenth of the resources
+// belong to nobody.
+internal void BenchFillEconomy(BenchContext *context, Economy *economy, uint32 cityCount, uint32 resourceCount,
+                               uint32 heroCount)
+{
+    ClearEconomy(economy);
+
+    for (uint32 index = 0; index < cityCount; ++index)
+    {
+        Fixed population = (Fixed)BenchRandomBetween(context, 100, 3000) * FIXED_ONE;
+        Fixed capacity   = (Fixed)BenchRandomBetween(context, 3000, 20000) * FIXED_ONE;
+
+        AddEconomyCity(economy, index, BenchRandom(context) % MAX_PLAYER_COUNT, population, capacity);
+    }
+
+    for (uint32 index = 0; index < resourceCount; ++index)
+    {
+        uint32 owner = BenchRandom(context) % 10 ? BenchRandom(context) % MAX_PLAYER_COUNT : TURN_NO_OWNER;
+        AddEconomyResource(economy, index, owner, (ResourceKind)(BenchRandom(context) % RESOURCE_KIND_COUNT));
+    }
+
+    for (uint32 index = 0; index < heroCount; ++index)
+    {
+        AddEconomyHero(economy, index, BenchRandom(context) % MAX_PLAYER_COUNT, HERO_MOVE_POINTS);
+    }
+}
+
+internal uint32 BenchEconomyChecksum(Economy *economy)
+{
+    uint32 result = Crc32(0, economy->stockpiles, sizeof(economy->stockpiles));
+    result        = Crc32(result, economy->cities.populations, economy->cities.count * sizeof(Fixed));
+    result        = Crc32(result, economy->heroes.movePoints, economy->heroes.count * sizeof(uint32));
+
+    return result;
+}
+
+// NOTE every run starts from the same game and plays the same turns, on one job on the main thread and on every job
+// on queues with different numbers of threads. All of them have to end up with the same stockpiles and cities.
+internal void BenchTurn(BenchContext *context)
+{
+    uint32 cityCount     = 100000;
+    uint32 resourceCount = 1000000;
+    uint32 heroCount     = 20000;
+    uint32 turnCount     = 20;
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    MemoryArena *arena   = &context->tempArena;
+
+    PlatformWorkQueue *defaultQueue = context->memory.highPriorityQueue;
+
+    PlatformWorkQueue *mainQueue  = BenchGetQueue(0);
+    PlatformWorkQueue *eightQueue = BenchGetQueue(7);
+
+    Economy *economy = PushStruct(arena, Economy);
+    InitializeEconomy(economy, arena, cityCount, resourceCount, heroCount);
+
+    struct
+    {
+        char *name;
+        PlatformWorkQueue *queue;
+        uint32 jobCount;
+    } runs[] = {
+        {"1 job, main thread", mainQueue, 1},
+        {"64 jobs, main thread", mainQueue, TURN_MAX_JOB_COUNT},
+        {"64 jobs, default queue", defaultQueue, TURN_MAX_JOB_COUNT},
+        {"64 jobs, 8 threads", eightQueue, TURN_MAX_JOB_COUNT},
+    };
+
+    uint32 randomState   = context->randomState;
+    uint32 firstChecksum = 0;
+    uint32 mismatchCount = 0;
+
+    real64 cyclesPerMs = BenchCyclesPerMillisecond();
+
+    for (uint32 runIndex = 0; runIndex < ArrayCount(runs); ++runIndex)
+    {
+        context->randomState = randomState;
+        BenchFillEconomy(context, economy, cityCount, resourceCount, heroCount);
+
+        context->memory.highPriorityQueue = runs[runIndex].queue;
+
+        real64 totalTime = 0.0;
+        real64 worstTime = 0.0;
+
+        for (uint32 turnIndex = 0; turnIndex < turnCount; ++turnIndex)
+        {
+            ResolveTurn(economy, &context->memory, runs[runIndex].jobCount);
+
+            real64 time = (real64)economy->lastResolveCycles / cyclesPerMs;
+            totalTime += time;
+            worstTime = time > worstTime ? time : worstTime;
+        }
+
+        uint32 checksum = BenchEconomyChecksum(economy);
+        if (runIndex == 0)
+        {
+            firstChecksum = checksum;
+        }
+        else if (checksum != firstChecksum)
+        {
+            ++mismatchCount;
+        }
+
+        printf("turn %u cities, %u resources, %u heroes, %s: %.3fms per turn, worst %.3fms, %u jobs, checksum %08x\n",
+               cityCount, resourceCount, heroCount, runs[runIndex].name, totalTime / turnCount, worstTime,
+               economy->lastJobCount, checksum);
+    }
+
+    context->memory.highPriorityQueue = defaultQueue;
+
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        printf("turn player %u after %u turns: %lld gold, %lld wood, %lld ore, %lld crystal\n", player, turnCount,
+               (long long)RoundFixedToInt64(economy->stockpiles[player][RESOURCE_GOLD]),
+               (long long)RoundFixedToInt64(economy->stockpiles[player][RESOURCE_WOOD]),
+               (long long)RoundFixedToInt64(economy->stockpiles[player][RESOURCE_ORE]),
+               (long long)RoundFixedToInt64(economy->stockpiles[player][RESOURCE_CRYSTAL]));
+    }
+    printf("turn check: %u of %u runs differ from the single job one\n", mismatchCount,
+           (uint32)ArrayCount(runs) - 1);
+
+    EndTemporaryMemory(temp);
+}
+
+inline bool32 BenchBattleEstimatesMatch(BattleEstimate *a, BattleEstimate *b)
+{
+    bool32 result = a->attackerWinCount == b->attackerWinCount && a->defenderWinCount == b->defenderWinCount;
+
+    for (uint32 side = 0; side < BATTLE_SIDE_COUNT; ++side)
+    {
+        result &= a->lostUnitCounts[side] == b->lostUnitCounts[side] && a->lostValues[side] == b->lostValues[side];
+    }
+
+    return result;
+}
+
+// NOTE every battle is estimated on every path with a count that doesn't fill the last group of lanes, and all of them
+// have to agree with the one at a time path. The same seed again has to give the same estimate and the next one a
+// different one.
+internal void BenchBattle(BenchContext *context)
+{
+    uint32 battleCount = 100003;
+    uint32 seed        = 7;
+
+    BattleSide hero     = MakeHeroBattleSide();
+    BattleSide bigHero  = hero;
+    BattleSide weakHero = hero;
+
+    for (uint32 stack = 0; stack < hero.stackCount; ++stack)
+    {
+        bigHero.stacks[stack].count *= 50;
+        weakHero.stacks[stack].count /= 2;
+    }
+
+    struct
+    {
+        char *name;
+        BattleSide attacker;
+        BattleSide defender;
+    } battles[] = {
+        {"hero vs hero", hero, hero},
+        {"hero vs weak hero", hero, weakHero},
+        {"hero vs city of 500", hero, MakeCityBattleSide(500)},
+        {"hero vs city of 2000", hero, MakeCityBattleSide(2000)},
+        {"hero vs city of 8000", hero, MakeCityBattleSide(8000)},
+        {"big hero vs city of 100000", bigHero, MakeCityBattleSide(100000)},
+    };
+
+    HexBatchPath paths[] = {HEX_BATCH_SCALAR, HEX_BATCH_SSE2, HEX_BATCH_AVX2};
+    HexBatchPath cpuPath = GetHexBatchPath();
+
+    real64 cyclesPerMs   = BenchCyclesPerMillisecond();
+    uint32 mismatchCount = 0;
+    uint32 seedFailCount = 0;
+
+    for (uint32 battleIndex = 0; battleIndex < ArrayCount(battles); ++battleIndex)
+    {
+        Battle battle                 = {};
+        battle.sides[BATTLE_ATTACKER] = battles[battleIndex].attacker;
+        battle.sides[BATTLE_DEFENDER] = battles[battleIndex].defender;
+
+        BattleEstimate first = {};
+
+        for (uint32 pathIndex = 0; pathIndex < ArrayCount(paths); ++pathIndex)
+        {
+            if (paths[pathIndex] == HEX_BATCH_AVX2 && cpuPath != HEX_BATCH_AVX2)
+            {
+                continue;
+            }
+
+            globalHexBatchPath = paths[pathIndex];
+
+            BattleEstimate estimate = EstimateBattle(&battle, seed, battleCount);
+            real64 time             = (real64)estimate.cycles / cyclesPerMs;
+
+            if (pathIndex == 0)
+            {
+                first = estimate;
+            }
+            else if (!BenchBattleEstimatesMatch(&estimate, &first))
+            {
+                ++mismatchCount;
+            }
+
+            printf("battle %s, %s: win %.2f%%, losses %.2f / %.2f units, %.0f battles per second\n",
+                   battles[battleIndex].name, globalHexBatchPathNames[paths[pathIndex]], 100.0f * estimate.winChance,
+                   estimate.expectedLosses[BATTLE_ATTACKER], estimate.expectedLosses[BATTLE_DEFENDER],
+                   battleCount / time * 1000.0);
+        }
+
+        globalHexBatchPath = cpuPath;
+
+        BattleEstimate again = EstimateBattle(&battle, seed, battleCount);
+        BattleEstimate next  = EstimateBattle(&battle, seed + 1, battleCount);
+
+        if (!BenchBattleEstimatesMatch(&again, &first) || BenchBattleEstimatesMatch(&next, &first))
+        {
+            ++seedFailCount;
+        }
+    }
+
+    // NOTE what the AI pays for weighing a city, a small estimate at a time.
+    Battle cityBattle                 = {};
+    cityBattle.sides[BATTLE_ATTACKER] = hero;
+    cityBattle.sides[BATTLE_DEFENDER] = MakeCityBattleSide(2000);
+
+    uint32 smallCount = 10000;
+    uint64 start      = BenchGetNanoseconds();
+
+    for (uint32 estimateIndex = 0; estimateIndex < smallCount; ++estimateIndex)
+    {
+        EstimateBattle(&cityBattle, estimateIndex, AI_BATTLE_COUNT);
+    }
+
+    real64 smallTime = BenchMillisecondsSince(start);
+
+    printf("battle %u estimates of %u battles, %s: %.4fms each\n", smallCount, AI_BATTLE_COUNT,
+           globalHexBatchPathNames[cpuPath], smallTime / smallCount);
+    printf("battle check: %u estimates differ from the one at a time path, %u seeds don't repeat or don't change\n",
+           mismatchCount, seedFailCount);
+}
+
+// NOTE a passable cell within radius of center, any passable cell when there is none after a few tries.
+internal OffsetCoord BenchRandomPassableCellNear(BenchContext *context, World *world, PathCostTable *costs,
+                                                 OffsetCoord center, int32 radius)
+{
+    OffsetCoord result = {};
+
+    for (uint32 tryIndex = 0; tryIndex < 64; ++tryIndex)
+    {
+        result = {BenchRandomBetween(context, Max(center.x - radius, 1), Min(center.x + radius, world->width - 1)),
+                  BenchRandomBetween(context, Max(center.y - radius, 1), Min(center.y + radius, world->height - 1))};
+
+        if (costs->costs[GetCell(world, result)->biome])
+        {
+            return result;
+        }
+    }
+
+    result = BenchRandomPassableCell(context, world, costs);
+    return result;
+}
+
+// NOTE every player has its cities spread over the world and its heroes around them. A few cities belong to nobody,
+// and mines are all over, most of them nobody's.
+internal void BenchFillAiSnapshot(BenchContext *context, AiSnapshot *snapshot, World *world, PathCostTable *costs,
+                                  uint32 citiesPerPlayer, uint32 heroesPerPlayer, uint32 resourceCount)
+{
+    ClearAiSnapshot(snapshot);
+    LoadAiSnapshotCells(snapshot, world, costs);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+
+    uint32 entityIndex  = 1;
+    uint32 cityCount    = (MAX_PLAYER_COUNT + 1) * citiesPerPlayer;
+    OffsetCoord *cities = PushArray(&context->tempArena, cityCount, OffsetCoord);
+
+    for (uint32 city = 0; city < cityCount; ++city)
+    {
+        uint32 owner     = city % (MAX_PLAYER_COUNT + 1);
+        Fixed population = (Fixed)BenchRandomBetween(context, 100, 4000) * FIXED_ONE;
+        cities[city]     = BenchRandomPassableCell(context, world, costs);
+
+        AddAiCity(snapshot, entityIndex, HexFromOffset(cities[city]), owner, population, CITY_START_CAPACITY);
+        AddAiTarget(snapshot, entityIndex, HexFromOffset(cities[city]), owner, GetAiCityValue(entityIndex, population));
+        ++entityIndex;
+    }
+
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        for (uint32 hero = 0; hero < heroesPerPlayer; ++hero)
+        {
+            OffsetCoord home   = cities[(hero % citiesPerPlayer) * (MAX_PLAYER_COUNT + 1) + player];
+            OffsetCoord offset = BenchRandomPassableCellNear(context, world, costs, home, 24);
+
+            AddAiHero(snapshot, entityIndex++, HexFromOffset(offset), player, HERO_MOVE_POINTS);
+        }
+
+        snapshot->stockpiles[player][RESOURCE_GOLD] = (Fixed)BenchRandomBetween(context, 0, 20000) * FIXED_ONE;
+        snapshot->stockpiles[player][RESOURCE_WOOD] = (Fixed)BenchRandomBetween(context, 0, 40) * FIXED_ONE;
+        snapshot->stockpiles[player][RESOURCE_ORE]  = (Fixed)BenchRandomBetween(context, 0, 40) * FIXED_ONE;
+    }
+
+    for (uint32 resource = 0; resource < resourceCount; ++resource)
+    {
+        uint32 owner      = BenchRandom(context) % 10 ? TURN_NO_OWNER : BenchRandom(context) % MAX_PLAYER_COUNT;
+        ResourceKind kind = (ResourceKind)(BenchRandom(context) % RESOURCE_KIND_COUNT);
+        HexCoord hex      = HexFromOffset(BenchRandomPassableCell(context, world, costs));
+
+        AddAiTarget(snapshot, entityIndex++, hex, owner, GetAiResourceValue(kind));
+    }
+
+    EndTemporaryMemory(temp);
+
+    FinishAiSnapshot(snapshot, &context->tempArena);
+}
+
+internal uint32 BenchAiOrderChecksum(AiPlanner *planner)
+{
+    uint32 result = Crc32(0, planner->orders, planner->orderCount * sizeof(AiOrder));
+    return result;
+}
+
+// NOTE the same snapshot is planned for every player on one job per player on the main thread and on every job on
+// queues with more and more threads, and all of them have to come up with the same orders. Then the same again with
+// budgets shorter than planning everything takes, where the heroes past the budget only get estimated.
+internal void BenchAi(BenchContext *context)
+{
+    int32 size             = 1024;
+    uint32 citiesPerPlayer = 32;
+    uint32 heroesPerPlayer = 96;
+    uint32 resourceCount   = 20000;
+    uint32 planCount       = 5;
+
+    World *world = BenchCreateWorld(context, size, size);
+
+    TemporaryMemory temp = StartTemporaryMemory(&context->tempArena);
+    MemoryArena *arena   = &context->tempArena;
+
+    WorldGenerator *generator = PushStruct(arena, WorldGenerator);
+    GenerateWorld(generator, world, &context->memory, arena, 1, GENERATE_MAX_JOB_COUNT);
+
+    PathCostTable costs = MakeHeroPathCosts();
+
+    uint32 heroCount   = MAX_PLAYER_COUNT * heroesPerPlayer;
+    uint32 cityCount   = (MAX_PLAYER_COUNT + 1) * citiesPerPlayer;
+    uint32 targetCount = cityCount + resourceCount;
+
+    AiPlanner *planner = PushStruct(arena, AiPlanner);
+    InitializeAiPlanner(planner, arena, size, size, heroCount, cityCount, targetCount);
+
+    uint64 snapshotStart = BenchGetNanoseconds();
+    BenchFillAiSnapshot(context, &planner->snapshot, world, &costs, citiesPerPlayer, heroesPerPlayer, resourceCount);
+    real64 snapshotTime = BenchMillisecondsSince(snapshotStart);
+
+    printf("ai %dx%d: %u players, %u heroes, %u cities, %u targets, snapshot %.2fms\n", size, size, MAX_PLAYER_COUNT,
+           heroCount, cityCount, targetCount, snapshotTime);
+
+    PlatformWorkQueue *defaultQueue = context->memory.highPriorityQueue;
+
+    struct
+    {
+        char *name;
+        PlatformWorkQueue *queue;
+        uint32 jobCount;
+    } runs[] = {
+        {"1 job per player, main thread", BenchGetQueue(0), 1},
+        {"64 jobs, main thread", BenchGetQueue(0), AI_MAX_JOB_COUNT},
+        {"64 jobs, default queue", defaultQueue, AI_MAX_JOB_COUNT},
+        {"64 jobs, 2 threads", BenchGetQueue(1), AI_MAX_JOB_COUNT},
+        {"64 jobs, 4 threads", BenchGetQueue(3), AI_MAX_JOB_COUNT},
+        {"64 jobs, 8 threads", BenchGetQueue(7), AI_MAX_JOB_COUNT},
+    };
+
+    uint32 allPlayers    = (1 << MAX_PLAYER_COUNT) - 1;
+    uint32 firstChecksum = 0;
+    uint32 mismatchCount = 0;
+    real64 singleTime    = 0.0;
+
+    real64 cyclesPerMs = BenchCyclesPerMillisecond();
+
+    BenchPrintCoreCount("ai plan", 8);
+
+    for (uint32 runIndex = 0; runIndex < ArrayCount(runs); ++runIndex)
+    {
+        context->memory.highPriorityQueue = runs[runIndex].queue;
+
+        real64 bestTime  = 1e30;
+        real64 mergeTime = 0.0;
+
+        for (uint32 planIndex = 0; planIndex < planCount; ++planIndex)
+        {
+            PlanAiTurn(planner, &context->memory, allPlayers, runs[runIndex].jobCount, 0);
+
+            real64 time = (real64)planner->lastPlanCycles / cyclesPerMs;
+            if (time < bestTime)
+            {
+                bestTime  = time;
+                mergeTime = (real64)planner->lastMergeCycles / cyclesPerMs;
+            }
+        }
+
+        uint32 checksum = BenchAiOrderChecksum(planner);
+        if (runIndex == 0)
+        {
+            firstChecksum = checksum;
+            singleTime    = bestTime;
+        }
+        else if (checksum != firstChecksum)
+        {
+            ++mismatchCount;
+        }
+
+        printf("ai plan, %s: %.2fms, merge %.3fms, %.2fx, %u jobs, %u orders, checksum %08x\n", runs[runIndex].name,
+               bestTime, mergeTime, singleTime / bestTime, planner->lastJobCount, planner->orderCount, checksum);
+    }
+
+    uint32 orderCounts[3] = {};
+    uint64 moveCost       = 0;
+    for (uint32 orderIndex = 0; orderIndex < planner->orderCount; ++orderIndex)
+    {
+        AiOrder *order = planner->orders + orderIndex;
+
+        ++orderCounts[order->type];
+        moveCost += order->type == AI_ORDER_MOVE_HERO ? order->cost : 0;
+    }
+
+    printf("ai orders: %u moves, mean cost %.1f, %u recruits, %u housing\n", orderCounts[AI_ORDER_MOVE_HERO],
+           orderCounts[AI_ORDER_MOVE_HERO] ? (real64)moveCost / orderCounts[AI_ORDER_MOVE_HERO] : 0.0,
+           orderCounts[AI_ORDER_RECRUIT_HERO], orderCounts[AI_ORDER_BUILD_HOUSING]);
+    printf("ai check: %u of %u runs differ from the single job one\n", mismatchCount, (uint32)ArrayCount(runs) - 1);
+
+    real64 budgetFractions[] = {0.5, 0.25, 0.1, 0.0};
+
+    context->memory.highPriorityQueue = BenchGetQueue(0);
+
+    for (uint32 budgetIndex = 0; budgetIndex < ArrayCount(budgetFractions); ++budgetIndex)
+    {
+        real64 budget       = singleTime * budgetFractions[budgetIndex];
+        uint64 budgetCycles = (uint64)(budget * cyclesPerMs) + 1;
+
+        PlanAiTurn(planner, &context->memory, allPlayers, AI_MAX_JOB_COUNT, budgetCycles);
+
+        printf("ai budget %.2fms, main thread: %.2fms, %u heroes searched, %u estimated, %u orders\n", budget,
+               (real64)planner->lastPlanCycles / cyclesPerMs, planner->lastSearchedHeroCount,
+               planner->lastEstimatedHeroCount, planner->orderCount);
+    }
+
+    context->memory.highPriorityQueue = defaultQueue;
+
+    EndTemporaryMemory(temp);
+}
@@ -0,0 +1,30 @@
+#include "hex_magic_platform.h"
+
+global uint32 globalCrc32Table[256];
+
+internal uint32 Crc32(uint32 crc, void *data, MemoryIndex size)
+{
+    if (!globalCrc32Table[1])
+    {
+        for (uint32 tableIndex = 0; tableIndex < ArrayCount(globalCrc32Table); ++tableIndex)
+        {
+            uint32 value = tableIndex;
+            for (uint32 bit = 0; bit < 8; ++bit)
+            {
+                value = (value & 1) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1);
+            }
+
+            globalCrc32Table[tableIndex] = value;
+        }
+    }
+
+    uint8 *at = (uint8 *)data;
+
+    crc = ~crc;
+    for (MemoryIndex byteIndex = 0; byteIndex < size; ++byteIndex)
+    {
+        crc = globalCrc32Table[(crc ^ *at++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
@@ -0,0 +1,661 @@
+#include "hex_magic.h"
+#include "hex_magic_debug.h"
+#include "hex_magic_font.h"
+#include "hex_magic_platform.h"
+#include "hex_magic_render.h"
+
+#define DEBUG_PANEL_WIDTH 520.0f
+#define DEBUG_PANEL_PADDING 8.0f
+#define DEBUG_BAR_WIDTH 3.0f
+#define DEBUG_GRAPH_HEIGHT 64.0f
+#define DEBUG_INDENT_WIDTH 14.0f
+
+// NOTE the first name is the overlay's own block, see DEBUG_OVERLAY_NAME_INDEX.
+internal uint32 InternDebugName(DebugState *state, char *name)
+{
+    uint32 result = DEBUG_MAX_NAME_COUNT;
+
+    if (!name)
+    {
+        name = "?";
+    }
+
+    // NOTE the same block hands in the same pointer every time until the game code gets reloaded, a reload can put
+    // another name at the same address, so the name itself still has to match.
+    for (uint32 nameIndex = 0; nameIndex < state->nameCount; ++nameIndex)
+    {
+        if (state->namePointers[nameIndex] == name &&
+            strncmp(state->names[nameIndex], name, DEBUG_MAX_NAME_LENGTH - 1) == 0)
+        {
+            result = nameIndex;
+            break;
+        }
+    }
+
+    if (result == DEBUG_MAX_NAME_COUNT)
+    {
+        for (uint32 nameIndex = 0; nameIndex < state->nameCount; ++nameIndex)
+        {
+            if (strncmp(state->names[nameIndex], name, DEBUG_MAX_NAME_LENGTH - 1) == 0)
+            {
+                state->namePointers[nameIndex] = name;
+                result                         = nameIndex;
+                break;
+            }
+        }
+    }
+
+    if (result == DEBUG_MAX_NAME_COUNT)
+    {
+        // NOTE once the names run out the rest share the last one.
+        result = state->nameCount < DEBUG_MAX_NAME_COUNT ? state->nameCount++ : DEBUG_MAX_NAME_COUNT - 1;
+
+        state->namePointers[result] = name;
+        snprintf(state->names[result], DEBUG_MAX_NAME_LENGTH, "%s", name);
+    }
+
+    return result;
+}
+
+internal DebugState *GetDebugState(ThreadContext *thread, GameMemory *memory)
+{
+    DebugState *result = 0;
+
+    if (memory->debugStorage && memory->debugStorageSize > sizeof(DebugState))
+    {
+        result = (DebugState *)memory->debugStorage;
+
+        if (!result->isInitialized)
+        {
+            InitializeArena(&result->arena, memory->debugStorageSize - sizeof(DebugState),
+                            (uint8 *)memory->debugStorage + sizeof(DebugState));
+
+            result->frames = PushArray(&result->arena, DEBUG_FRAME_COUNT, DebugFrame);
+            InternDebugName(result, "DEBUG_OVERLAY");
+
+            result->isInitialized = true;
+        }
+    }
+
+    return result;
+}
+
+// NOTE pairs the events of every thread up into blocks nested the way they ran. The overlay's block and everything
+// in it only count towards what the overlay cost.
+internal void CollectDebugFrame(DebugState *state, DebugTable *table)
+{
+    DebugFrame *frame = state->frames + (state->frameCount % DEBUG_FRAME_COUNT);
+
+    frame->secondsElapsed    = table->collatedSecondsElapsed;
+    frame->clockCount        = table->collatedClockCount;
+    frame->overlayClockCount = 0;
+    frame->droppedEventCount = 0;
+    frame->droppedNodeCount  = 0;
+    frame->nodeCount         = 0;
+
+    uint32 threadCount = table->threadCount < DEBUG_MAX_THREAD_COUNT ? table->threadCount : DEBUG_MAX_THREAD_COUNT;
+
+    for (uint32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        DebugThreadEvents *thread = table->threads + threadIndex;
+        DebugEvent *events        = thread->events[table->collatedArrayIndex];
+
+        uint32 openNodes[DEBUG_MAX_NODE_DEPTH];
+        uint64 openClocks[DEBUG_MAX_NODE_DEPTH];
+        bool32 openIsOverlay[DEBUG_MAX_NODE_DEPTH];
+        uint32 depth = 0;
+
+        for (uint32 eventIndex = 0; eventIndex < thread->collatedEventCount; ++eventIndex)
+        {
+            DebugEvent *event = events + eventIndex;
+
+            if (event->type == DEBUG_EVENT_BEGIN_BLOCK)
+            {
+                if (depth < DEBUG_MAX_NODE_DEPTH)
+                {
+                    uint32 nameIndex = InternDebugName(state, event->blockName);
+                    uint32 parent    = depth > 0 ? openNodes[depth - 1] : DEBUG_NO_NODE;
+                    bool32 isOverlay = (depth > 0 && openIsOverlay[depth - 1]) || nameIndex == DEBUG_OVERLAY_NAME_INDEX;
+                    uint32 nodeIndex = DEBUG_NO_NODE;
+
+                    if (!isOverlay && frame->nodeCount < DEBUG_MAX_FRAME_NODE_COUNT)
+                    {
+                        nodeIndex       = frame->nodeCount++;
+                        DebugNode *node = frame->nodes + nodeIndex;
+
+                        node->nameIndex   = nameIndex;
+                        node->threadIndex = threadIndex;
+                        node->parent      = parent;
+                        node->firstChild  = DEBUG_NO_NODE;
+                        node->lastChild   = DEBUG_NO_NODE;
+                        node->nextSibling = DEBUG_NO_NODE;
+                        node->beginClock  = event->clock;
+                        node->clockCount  = 0;
+
+                        if (parent != DEBUG_NO_NODE)
+                        {
+                            DebugNode *parentNode = frame->nodes + parent;
+
+                            if (parentNode->lastChild == DEBUG_NO_NODE)
+                            {
+                                parentNode->firstChild = nodeIndex;
+                            }
+                            else
+                            {
+                                frame->nodes[parentNode->lastChild].nextSibling = nodeIndex;
+                            }
+
+                            parentNode->lastChild = nodeIndex;
+                        }
+                    }
+                    else if (!isOverlay)
+                    {
+                        ++frame->droppedNodeCount;
+                    }
+
+                    openNodes[depth]     = nodeIndex;
+                    openClocks[depth]    = event->clock;
+                    openIsOverlay[depth] = isOverlay;
+                }
+
+                ++depth;
+            }
+            else if (depth > 0)
+            {
+                // NOTE an end without its begin is a block that started before the frame did.
+                --depth;
+
+                if (depth < DEBUG_MAX_NODE_DEPTH)
+                {
+                    uint64 clockCount = event->clock - openClocks[depth];
+
+                    if (openNodes[depth] != DEBUG_NO_NODE)
+                    {
+                        frame->nodes[openNodes[depth]].clockCount = clockCount > 0 ? clockCount : 1;
+                    }
+                    else if (openIsOverlay[depth] && (depth == 0 || !openIsOverlay[depth - 1]))
+                    {
+                        frame->overlayClockCount += clockCount;
+                    }
+                }
+            }
+        }
+
+        frame->droppedEventCount += thread->droppedEventCount;
+    }
+
+    ++state->frameCount;
+}
+
+inline DebugFrame *GetViewedDebugFrame(DebugState *state)
+{
+    DebugFrame *result = 0;
+
+    if (state->frameCount > 0)
+    {
+        result = state->frames + (state->viewedFrame % DEBUG_FRAME_COUNT);
+    }
+
+    return result;
+}
+
+inline uint32 GetOldestDebugFrame(DebugState *state)
+{
+    uint32 result = state->frameCount > DEBUG_FRAME_COUNT ? state->frameCount - DEBUG_FRAME_COUNT : 0;
+    return result;
+}
+
+inline bool32 IsInDebugRectangle(V2 min, V2 max, real32 x, real32 y)
+{
+    bool32 result = x >= min.x && x < max.x && y >= min.y && y < max.y;
+    return result;
+}
+
+internal void ToggleDebugPath(DebugState *state, uint32 path)
+{
+    bool32 wasExpanded = false;
+
+    for (uint32 pathIndex = 0; pathIndex < state->expandedCount; ++pathIndex)
+    {
+        if (state->expandedPaths[pathIndex] == path)
+        {
+            state->expandedPaths[pathIndex] = state->expandedPaths[--state->expandedCount];
+            wasExpanded                     = true;
+            break;
+        }
+    }
+
+    if (!wasExpanded && state->expandedCount < DEBUG_MAX_EXPANDED_COUNT)
+    {
+        state->expandedPaths[state->expandedCount++] = path;
+    }
+}
+
+internal bool32 IsDebugPathExpanded(DebugState *state, uint32 path)
+{
+    bool32 result = false;
+
+    for (uint32 pathIndex = 0; pathIndex < state->expandedCount; ++pathIndex)
+    {
+        if (state->expandedPaths[pathIndex] == path)
+        {
+            result = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+// NOTE collects the last frame and takes the input that is meant for the overlay out of what the game gets. The
+// overlay is laid out where it was drawn last frame.
+internal void UpdateProfiler(DebugState *state, DebugTable *table, GameInput *input)
+{
+    if (state)
+    {
+        GameKeyboardInput *keyboard = &input->keyboard;
+        GameMouseInput *mouse       = &input->mouse;
+
+        if (WasPressed(keyboard->toggleProfiler))
+        {
+            state->isVisible = !state->isVisible;
+        }
+
+        if (state->isVisible && WasPressed(keyboard->freezeProfiler))
+        {
+            state->isFrozen = !state->isFrozen;
+        }
+
+        // NOTE while frozen the events keep getting collated by the platform, they just aren't kept.
+        if (table && !state->isFrozen)
+        {
+            CollectDebugFrame(state, table);
+            state->viewedFrame = state->frameCount - 1;
+        }
+
+        real32 mouseX = (real32)mouse->x;
+        real32 mouseY = (real32)mouse->y;
+
+        if (state->isVisible && IsInDebugRectangle(state->panelMin, state->panelMax, mouseX, mouseY))
+        {
+            if (IsHeld(mouse->lButton) && IsInDebugRectangle(state->graphMin, state->graphMax, mouseX, mouseY))
+            {
+                // NOTE the newest frame is the rightmost bar.
+                int32 barIndex = FloorReal32ToInt32((mouseX - state->graphMin.x) / DEBUG_BAR_WIDTH);
+                int32 frame    = (int32)state->frameCount - DEBUG_FRAME_COUNT + barIndex;
+
+                if (frame >= (int32)GetOldestDebugFrame(state) && frame < (int32)state->frameCount)
+                {
+                    state->isFrozen    = true;
+                    state->viewedFrame = (uint32)frame;
+                }
+            }
+
+            if (WasPressed(mouse->lButton))
+            {
+                for (uint32 rowIndex = 0; rowIndex < state->rowCount; ++rowIndex)
+                {
+                    DebugRow *row = state->rows + rowIndex;
+
+                    if (row->hasChildren && IsInDebugRectangle(row->min, row->max, mouseX, mouseY))
+                    {
+                        ToggleDebugPath(state, row->path);
+                    }
+                }
+            }
+
+            for (uint32 buttonIndex = 0; buttonIndex < ArrayCount(mouse->buttons); ++buttonIndex)
+            {
+                mouse->buttons[buttonIndex] = {};
+            }
+
+            mouse->wheel = 0.0f;
+        }
+    }
+}
+
+inline uint32 GetDebugPath(uint32 parentPath, uint32 nameIndex)
+{
+    uint32 result = (parentPath ^ (nameIndex + 1)) * 16777619;
+    return result;
+}
+
+// NOTE nodes is every call of the blocks at this level. Calls of the same block are added up into one row, and the
+// calls under them make up the level below when the row is expanded.
+internal void AddDebugRows(DebugState *state, DebugFrame *frame, uint32 *nodes, uint32 nodeCount, uint32 depth,
+                           uint32 parentPath, uint32 maxRowCount)
+{
+    TemporaryMemory rowMemory = StartTemporaryMemory(&state->arena);
+    bool32 *isCounted         = PushArray(&state->arena, nodeCount, bool32);
+
+    for (uint32 nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+    {
+        isCounted[nodeIndex] = false;
+    }
+
+    for (uint32 nodeIndex = 0; nodeIndex < nodeCount && state->rowCount < maxRowCount; ++nodeIndex)
+    {
+        if (!isCounted[nodeIndex])
+        {
+            uint32 nameIndex  = frame->nodes[nodes[nodeIndex]].nameIndex;
+            uint32 childCount = 0;
+
+            DebugRow *row  = state->rows + state->rowCount++;
+            *row           = {};
+            row->path      = GetDebugPath(parentPath, nameIndex);
+            row->depth     = depth;
+            row->nameIndex = nameIndex;
+
+            for (uint32 otherIndex = nodeIndex; otherIndex < nodeCount; ++otherIndex)
+            {
+                DebugNode *node = frame->nodes + nodes[otherIndex];
+
+                if (node->nameIndex == nameIndex)
+                {
+                    isCounted[otherIndex] = true;
+                    row->clockCount += node->clockCount;
+                    ++row->hitCount;
+
+                    for (uint32 child = node->firstChild; child != DEBUG_NO_NODE;)
+                    {
+                        childCount += frame->nodes[child].clockCount > 0;
+                        child = frame->nodes[child].nextSibling;
+                    }
+                }
+            }
+
+            row->hasChildren = childCount > 0;
+            row->isExpanded  = row->hasChildren && IsDebugPathExpanded(state, row->path);
+
+            if (row->isExpanded)
+            {
+                uint32 *children  = PushArray(&state->arena, childCount, uint32);
+                uint32 childIndex = 0;
+
+                for (uint32 otherIndex = nodeIndex; otherIndex < nodeCount; ++otherIndex)
+                {
+                    DebugNode *node = frame->nodes + nodes[otherIndex];
+
+                    if (node->nameIndex == nameIndex)
+                    {
+                        for (uint32 child = node->firstChild; child != DEBUG_NO_NODE;)
+                        {
+                            if (frame->nodes[child].clockCount > 0)
+                            {
+                                children[childIndex++] = child;
+                            }
+
+                            child = frame->nodes[child].nextSibling;
+                        }
+                    }
+                }
+
+                AddDebugRows(state, frame, children, childCount, depth + 1, row->path, maxRowCount);
+            }
+        }
+    }
+
+    EndTemporaryMemory(rowMemory);
+}
+
+inline void PushDebugTextRight(Renderer *renderer, Font *font, real32 right, real32 y, char *text, V4 color)
+{
+    RendererPushText(renderer, font, Vector2(right - GetTextWidth(font, text), y), text, color);
+}
+
+inline real32 GetMegacycles(uint64 clockCount)
+{
+    real32 result = (real32)clockCount / (1000.0f * 1000.0f);
+    return result;
+}
+
+// NOTE drawn on top of the finished frame with a renderer of its own, in the top right corner of the screen. The
+// frame graph runs against the target frame time, the table has the blocks that took the longest themselves, without
+// the blocks they called, and below it is the call hierarchy.
+internal void DrawProfiler(DebugState *state, DebugTable *table, FontAtlas *fontAtlas, GameOffscreenBuffer *buffer)
+{
+    DebugFrame *frame = state ? GetViewedDebugFrame(state) : 0;
+
+    if (state && state->isVisible && frame && table)
+    {
+        TemporaryMemory renderMemory = StartTemporaryMemory(&state->arena);
+        Renderer *renderer           = MakeRenderer(&state->arena, Megabytes(1), 0);
+        Font *font                   = GetFont(fontAtlas, FONT_STYLE_REGULAR, FONT_SIZE_SMALL);
+        Font *headerFont             = GetFont(fontAtlas, FONT_STYLE_BOLD, FONT_SIZE_SMALL);
+
+        real32 lineHeight = font->isValid ? CeilReal32ToInt32(font->lineAdvance) : 0.0f;
+
+        V4 backgroundColor = {0.05f, 0.05f, 0.08f, 1.0f};
+        V4 textColor       = {0.9f, 0.9f, 0.9f, 1.0f};
+        V4 dimTextColor    = {0.6f, 0.6f, 0.65f, 1.0f};
+        V4 goodColor       = {0.2f, 0.7f, 0.3f, 1.0f};
+        V4 badColor        = {0.85f, 0.25f, 0.2f, 1.0f};
+        V4 overlayColor    = {0.3f, 0.4f, 0.9f, 1.0f};
+        V4 targetColor     = {0.95f, 0.85f, 0.2f, 1.0f};
+        V4 viewedColor     = {1.0f, 1.0f, 1.0f, 1.0f};
+
+        // NOTE self time is what is left of a block once the blocks it called are taken out.
+        uint64 totalClocks[DEBUG_MAX_NAME_COUNT] = {};
+        uint64 selfClocks[DEBUG_MAX_NAME_COUNT]  = {};
+        uint32 hitCounts[DEBUG_MAX_NAME_COUNT]   = {};
+
+        TemporaryMemory rootMemory = StartTemporaryMemory(&state->arena);
+        uint32 *roots              = PushArray(&state->arena, frame->nodeCount, uint32);
+        uint32 rootCount           = 0;
+
+        for (uint32 nodeIndex = 0; nodeIndex < frame->nodeCount; ++nodeIndex)
+        {
+            DebugNode *node = frame->nodes + nodeIndex;
+
+            if (node->clockCount > 0)
+            {
+                uint64 childClocks = 0;
+                for (uint32 child = node->firstChild; child != DEBUG_NO_NODE; child = frame->nodes[child].nextSibling)
+                {
+                    childClocks += frame->nodes[child].clockCount;
+                }
+
+                totalClocks[node->nameIndex] += node->clockCount;
+                selfClocks[node->nameIndex] += childClocks < node->clockCount ? node->clockCount - childClocks : 0;
+                ++hitCounts[node->nameIndex];
+
+                if (node->parent == DEBUG_NO_NODE || frame->nodes[node->parent].clockCount == 0)
+                {
+                    roots[rootCount++] = nodeIndex;
+                }
+            }
+        }
+
+        uint32 sortedNames[DEBUG_MAX_NAME_COUNT];
+        uint32 sortedCount = 0;
+
+        for (uint32 nameIndex = 0; nameIndex < state->nameCount; ++nameIndex)
+        {
+            if (hitCounts[nameIndex])
+            {
+                uint32 insertIndex = sortedCount++;
+                while (insertIndex > 0 && selfClocks[sortedNames[insertIndex - 1]] < selfClocks[nameIndex])
+                {
+                    sortedNames[insertIndex] = sortedNames[insertIndex - 1];
+                    --insertIndex;
+                }
+
+                sortedNames[insertIndex] = nameIndex;
+            }
+        }
+
+        uint32 tableRowCount = sortedCount < DEBUG_TABLE_ROW_COUNT ? sortedCount : DEBUG_TABLE_ROW_COUNT;
+
+        real32 panelWidth = DEBUG_PANEL_WIDTH;
+        V2 panelMin       = {buffer->width - panelWidth - DEBUG_PANEL_PADDING, DEBUG_PANEL_PADDING};
+        real32 textTop    = panelMin.y + 2.0f * DEBUG_PANEL_PADDING + DEBUG_GRAPH_HEIGHT;
+
+        // NOTE as many hierarchy rows as fit on the screen under the summary line and the table.
+        uint32 maxRowCount = 0;
+        if (lineHeight > 0.0f)
+        {
+            real32 rowsTop    = textTop + lineHeight * (tableRowCount + 3);
+            real32 rowsHeight = buffer->height - rowsTop - 2.0f * DEBUG_PANEL_PADDING;
+
+            maxRowCount = rowsHeight > 0.0f ? (uint32)(rowsHeight / lineHeight) : 0;
+            if (maxRowCount > DEBUG_MAX_ROW_COUNT)
+            {
+                maxRowCount = DEBUG_MAX_ROW_COUNT;
+            }
+        }
+
+        state->rowCount = 0;
+        AddDebugRows(state, frame, roots, rootCount, 0, 0, maxRowCount);
+
+        EndTemporaryMemory(rootMemory);
+
+        real32 textHeight = lineHeight > 0.0f ? lineHeight * (tableRowCount + 3 + state->rowCount) : 0.0f;
+        V2 panelMax       = {panelMin.x + panelWidth, textTop + textHeight + DEBUG_PANEL_PADDING};
+
+        state->panelMin = panelMin;
+        state->panelMax = panelMax;
+
+        RendererPushScreenRectangle(renderer, panelMin, panelMax, backgroundColor);
+
+        // NOTE twice the target frame time fills the graph, so the target is half way up.
+        real32 targetSeconds = table->targetSecondsPerFrame > 0.0f ? table->targetSecondsPerFrame : 1.0f / 30.0f;
+        V2 graphMin          = panelMin + Vector2(DEBUG_PANEL_PADDING, DEBUG_PANEL_PADDING);
+        V2 graphMax          = graphMin + Vector2(DEBUG_FRAME_COUNT * DEBUG_BAR_WIDTH, DEBUG_GRAPH_HEIGHT);
+
+        state->graphMin = graphMin;
+        state->graphMax = graphMax;
+
+        for (uint32 frameIndex = GetOldestDebugFrame(state); frameIndex < state->frameCount; ++frameIndex)
+        {
+            DebugFrame *barFrame = state->frames + (frameIndex % DEBUG_FRAME_COUNT);
+            real32 barX          = graphMin.x + (frameIndex + DEBUG_FRAME_COUNT - state->frameCount) * DEBUG_BAR_WIDTH;
+            real32 barHeight     = DEBUG_GRAPH_HEIGHT * Clamp01(0.5f * barFrame->secondsElapsed / targetSeconds);
+            real32 overlayHeight = 0.0f;
+
+            if (barFrame->clockCount > 0)
+            {
+                overlayHeight = barHeight * Clamp01((real32)barFrame->overlayClockCount / barFrame->clockCount);
+            }
+
+            V4 barColor = barFrame->secondsElapsed > targetSeconds ? badColor : goodColor;
+
+            if (frameIndex == state->viewedFrame)
+            {
+                RendererPushScreenRectangle(renderer, Vector2(barX, graphMin.y),
+                                            Vector2(barX + DEBUG_BAR_WIDTH, graphMax.y), viewedColor);
+            }
+
+            RendererPushScreenRectangle(renderer, Vector2(barX, graphMax.y - barHeight),
+                                        Vector2(barX + DEBUG_BAR_WIDTH - 1.0f, graphMax.y), barColor);
+            RendererPushScreenRectangle(renderer, Vector2(barX, graphMax.y - barHeight),
+                                        Vector2(barX + DEBUG_BAR_WIDTH - 1.0f, graphMax.y - barHeight + overlayHeight),
+                                        overlayColor);
+        }
+
+        real32 targetY = graphMax.y - 0.5f * DEBUG_GRAPH_HEIGHT;
+        RendererPushScreenRectangle(renderer, Vector2(graphMin.x, targetY), Vector2(graphMax.x, targetY + 1.0f),
+                                    targetColor);
+
+        char text[256];
+        real32 textLeft  = panelMin.x + DEBUG_PANEL_PADDING;
+        real32 textRight = panelMax.x - DEBUG_PANEL_PADDING;
+        real32 y         = graphMin.y;
+
+        snprintf(text, sizeof(text), "target %.2f ms", 1000.0f * targetSeconds);
+        PushDebugTextRight(renderer, font, textRight, y, text, targetColor);
+        y += lineHeight;
+
+        snprintf(text, sizeof(text), "frame %.2f ms", 1000.0f * frame->secondsElapsed);
+        PushDebugTextRight(renderer, font, textRight, y, text, textColor);
+        y += lineHeight;
+
+        PushDebugTextRight(renderer, font, textRight, y, state->isFrozen ? (char *)"FROZEN" : (char *)"LIVE",
+                           state->isFrozen ? targetColor : dimTextColor);
+
+        // NOTE what the overlay took, collecting the frame and drawing it, is measured like everything else but kept
+        // out of the table and the hierarchy.
+        y = textTop;
+        snprintf(text, sizeof(text), "frame %u: %.2f Mc, overlay %.2f Mc, %u events lost", state->viewedFrame,
+                 GetMegacycles(frame->clockCount), GetMegacycles(frame->overlayClockCount),
+                 frame->droppedEventCount + frame->droppedNodeCount);
+        RendererPushText(renderer, font, Vector2(textLeft, y), text, textColor);
+        y += lineHeight;
+
+        real32 selfRight    = textLeft + 300.0f;
+        real32 totalRight   = textLeft + 380.0f;
+        real32 hitsRight    = textLeft + 440.0f;
+        real32 percentRight = textRight;
+
+        RendererPushText(renderer, headerFont, Vector2(textLeft, y), "block", dimTextColor);
+        PushDebugTextRight(renderer, headerFont, selfRight, y, "self Mc", dimTextColor);
+        PushDebugTextRight(renderer, headerFont, totalRight, y, "total Mc", dimTextColor);
+        PushDebugTextRight(renderer, headerFont, hitsRight, y, "hits", dimTextColor);
+        PushDebugTextRight(renderer, headerFont, percentRight, y, "self %", dimTextColor);
+        y += lineHeight;
+
+        for (uint32 sortedIndex = 0; sortedIndex < tableRowCount; ++sortedIndex)
+        {
+            uint32 nameIndex = sortedNames[sortedIndex];
+
+            RendererPushText(renderer, font, Vector2(textLeft, y), state->names[nameIndex], textColor);
+
+            snprintf(text, sizeof(text), "%.3f", GetMegacycles(selfClocks[nameIndex]));
+            PushDebugTextRight(renderer, font, selfRight, y, text, textColor);
+
+            snprintf(text, sizeof(text), "%.3f", GetMegacycles(totalClocks[nameIndex]));
+            PushDebugTextRight(renderer, font, totalRight, y, text, textColor);
+
+            snprintf(text, sizeof(text), "%u", hitCounts[nameIndex]);
+            PushDebugTextRight(renderer, font, hitsRight, y, text, textColor);
+
+            if (frame->clockCount > 0)
+            {
+                snprintf(text, sizeof(text), "%.1f", 100.0f * (real32)selfClocks[nameIndex] / frame->clockCount);
+                PushDebugTextRight(renderer, font, percentRight, y, text, textColor);
+            }
+
+            y += lineHeight;
+        }
+
+        RendererPushText(renderer, headerFont, Vector2(textLeft, y), "calls", dimTextColor);
+        PushDebugTextRight(renderer, headerFont, totalRight, y, "total Mc", dimTextColor);
+        PushDebugTextRight(renderer, headerFont, hitsRight, y, "hits", dimTextColor);
+        PushDebugTextRight(renderer, headerFont, percentRight, y, "total %", dimTextColor);
+        y += lineHeight;
+
+        for (uint32 rowIndex = 0; rowIndex < state->rowCount; ++rowIndex)
+        {
+            DebugRow *row = state->rows + rowIndex;
+            real32 x      = textLeft + row->depth * DEBUG_INDENT_WIDTH;
+
+            row->min = Vector2(textLeft, y);
+            row->max = Vector2(textRight, y + lineHeight);
+
+            if (row->hasChildren)
+            {
+                char *marker = row->isExpanded ? (char *)"-" : (char *)"+";
+                RendererPushText(renderer, font, Vector2(x, y), marker, dimTextColor);
+            }
+
+            RendererPushText(renderer, font, Vector2(x + DEBUG_INDENT_WIDTH, y), state->names[row->nameIndex],
+                             textColor);
+
+            snprintf(text, sizeof(text), "%.3f", GetMegacycles(row->clockCount));
+            PushDebugTextRight(renderer, font, totalRight, y, text, textColor);
+
+            snprintf(text, sizeof(text), "%u", row->hitCount);
+            PushDebugTextRight(renderer, font, hitsRight, y, text, textColor);
+
+            if (frame->clockCount > 0)
+            {
+                snprintf(text, sizeof(text), "%.1f", 100.0f * (real32)row->clockCount / frame->clockCount);
+                PushDebugTextRight(renderer, font, percentRight, y, text, textColor);
+            }
+
+            y += lineHeight;
+        }
+
+        RenderToOutput(buffer, renderer);
+        EndTemporaryMemory(renderMemory);
+    }
+}
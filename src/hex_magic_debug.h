@@ -0,0 +1,102 @@
+#if !defined(HEX_MAGIC_DEBUG)
+
+#include "hex_magic.h"
+#include "hex_magic_platform.h"
+
+// NOTE the profiler turns the events of every frame the platform collates into a tree of blocks per thread and keeps
+// the last frames of them around, so a frame that went wrong can still be looked at after it has gone by. Block names
+// are copied, the events point into the game code, which can get reloaded.
+#define DEBUG_FRAME_COUNT 128
+#define DEBUG_MAX_FRAME_NODE_COUNT 4096
+#define DEBUG_MAX_NODE_DEPTH 64
+#define DEBUG_MAX_NAME_COUNT 256
+#define DEBUG_MAX_NAME_LENGTH 64
+#define DEBUG_MAX_EXPANDED_COUNT 256
+#define DEBUG_MAX_ROW_COUNT 128
+#define DEBUG_TABLE_ROW_COUNT 12
+
+#define DEBUG_NO_NODE 0xFFFFFFFF
+
+// NOTE the overlay's own block, it is never part of the tree so it doesn't skew what it shows.
+#define DEBUG_OVERLAY_NAME_INDEX 0
+
+struct DebugNode
+{
+    uint32 nameIndex;
+    uint32 threadIndex;
+
+    uint32 parent;
+    uint32 firstChild;
+    uint32 lastChild;
+    uint32 nextSibling;
+
+    uint64 beginClock;
+
+    // NOTE 0 for a block that didn't end in the frame, those are left out.
+    uint64 clockCount;
+};
+
+struct DebugFrame
+{
+    // NOTE what the platform measured the whole frame to take, sleeping for the flip included.
+    real32 secondsElapsed;
+    uint64 clockCount;
+
+    uint64 overlayClockCount;
+
+    uint32 droppedEventCount;
+    uint32 droppedNodeCount;
+
+    uint32 nodeCount;
+    DebugNode nodes[DEBUG_MAX_FRAME_NODE_COUNT];
+};
+
+// NOTE a line of the call hierarchy. Calls of the same block under the same parent are added up into one row. Where
+// it was drawn is kept so that a click on it next frame can expand or collapse it.
+struct DebugRow
+{
+    uint32 path;
+    uint32 depth;
+    uint32 nameIndex;
+
+    uint64 clockCount;
+    uint32 hitCount;
+
+    bool32 hasChildren;
+    bool32 isExpanded;
+
+    V2 min;
+    V2 max;
+};
+
+struct DebugState
+{
+    bool32 isInitialized;
+    bool32 isVisible;
+    bool32 isFrozen;
+
+    MemoryArena arena;
+
+    uint32 nameCount;
+    char *namePointers[DEBUG_MAX_NAME_COUNT];
+    char names[DEBUG_MAX_NAME_COUNT][DEBUG_MAX_NAME_LENGTH];
+
+    // NOTE frames are numbered from the first one collated, frame n is in frames[n % DEBUG_FRAME_COUNT].
+    uint32 frameCount;
+    uint32 viewedFrame;
+    DebugFrame *frames;
+
+    uint32 expandedCount;
+    uint32 expandedPaths[DEBUG_MAX_EXPANDED_COUNT];
+
+    V2 panelMin;
+    V2 panelMax;
+    V2 graphMin;
+    V2 graphMax;
+
+    uint32 rowCount;
+    DebugRow rows[DEBUG_MAX_ROW_COUNT];
+};
+
+#define HEX_MAGIC_DEBUG
+#endif
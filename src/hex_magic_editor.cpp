@@ -0,0 +1,588 @@
+#include "hex_magic.h"
+#include "hex_magic_fill.h"
+#include "hex_magic_journal.h"
+#include "hex_magic_platform.h"
+#include "hex_magic_undo.h"
+
+// NOTE every change the editor makes to the world goes through here, so it ends up in the journal, and unless it is
+// an undo or redo itself, in the undo history.
+
+inline void EditorMarkTerrainDirty(Editor *editor, int32 y, int32 minX, int32 maxX)
+{
+    if (editor->hpa)
+    {
+        MarkHpaSpanDirty(editor->hpa, y, minX, maxX);
+    }
+
+    if (editor->flowFields)
+    {
+        MarkFlowSpanDirty(editor->flowFields, y, minX, maxX);
+    }
+
+    if (editor->fog)
+    {
+        MarkFogDirty(editor->fog, minX, y);
+        MarkFogDirty(editor->fog, maxX, y);
+    }
+
+    if (editor->influence)
+    {
+        MarkInfluenceDirty(editor->influence);
+    }
+
+    // NOTE resources dig up different things on different ground.
+    if (editor->economy)
+    {
+        editor->economy->isDirty = true;
+    }
+
+    if (editor->worldHash)
+    {
+        MarkWorldHashDirty(editor->worldHash, y, minX, maxX);
+    }
+}
+
+inline void EditorMarkEntityDirty(Editor *editor, World *world, uint32 cellIndex, EntityType type)
+{
+    if (editor->fog && type == ENTITY_HERO)
+    {
+        MarkFogDirty(editor->fog, cellIndex % world->width, cellIndex / world->width);
+    }
+
+    if (editor->influence && type != ENTITY_RESOURCE)
+    {
+        MarkInfluenceDirty(editor->influence);
+    }
+
+    if (editor->economy)
+    {
+        editor->economy->isDirty = true;
+    }
+
+    if (editor->worldHash)
+    {
+        MarkWorldHashDirty(editor->worldHash, cellIndex / world->width, cellIndex % world->width,
+                           cellIndex % world->width);
+    }
+}
+
+internal void EditorSetCellBiome(Editor *editor, World *world, uint32 cellIndex, Biome biome)
+{
+    Cell *cell = GetCellByIndex(world, cellIndex);
+
+    SetCellBiome(world, cell, biome);
+    EditorMarkTerrainDirty(editor, cellIndex / world->width, cellIndex % world->width, cellIndex % world->width);
+    JournalPaint(editor->journal, world, cellIndex % world->width, cellIndex / world->width, biome);
+}
+
+internal void EditorRestoreEntity(Editor *editor, World *world, uint32 cellIndex, EntityType type, uint32 entityIndex)
+{
+    if (RestoreEntity(world, entityIndex))
+    {
+        LinkEntity(GetCellByIndex(world, cellIndex), type, entityIndex);
+        EditorMarkEntityDirty(editor, world, cellIndex, type);
+        JournalEntity(editor->journal, world, JOURNAL_RECORD_PLACE_ENTITY, cellIndex % world->width,
+                      cellIndex / world->width, type);
+    }
+}
+
+internal void EditorRemoveEntity(Editor *editor, World *world, uint32 cellIndex, EntityType type)
+{
+    uint32 entityIndex = UnlinkEntity(GetCellByIndex(world, cellIndex), type);
+    if (entityIndex)
+    {
+        RemoveEntity(world, entityIndex);
+        EditorMarkEntityDirty(editor, world, cellIndex, type);
+        JournalEntity(editor->journal, world, JOURNAL_RECORD_REMOVE_ENTITY, cellIndex % world->width,
+                      cellIndex / world->width, type);
+    }
+}
+
+internal void EditorPaintCell(Editor *editor, World *world, Cell *cell, Biome biome)
+{
+    if (cell->biome != biome)
+    {
+        uint32 cellIndex = GetCellIndex(world, cell);
+
+        RecordUndo(editor->undo, UNDO_RECORD_PAINT, cellIndex, (uint8)cell->biome, (uint8)biome, 0);
+        EditorSetCellBiome(editor, world, cellIndex, biome);
+    }
+}
+
+// NOTE nothing gets placed once every entity slot is taken.
+internal void EditorPlaceEntity(Editor *editor, World *world, Cell *cell, EntityType type)
+{
+    uint32 entityIndex = CanAddEntity(world) ? PlaceEntity(world, cell, type) : 0;
+    if (entityIndex)
+    {
+        uint32 cellIndex = GetCellIndex(world, cell);
+
+        RecordUndo(editor->undo, UNDO_RECORD_ADD_ENTITY, cellIndex, (uint8)type, (uint8)type, (uint8)entityIndex);
+        EditorMarkEntityDirty(editor, world, cellIndex, type);
+        JournalEntity(editor->journal, world, JOURNAL_RECORD_PLACE_ENTITY, cellIndex % world->width,
+                      cellIndex / world->width, type);
+    }
+}
+
+// NOTE only records the cells that actually change, which is what the brush wants since it keeps painting over the
+// same cells while it is held. Cells that change next to each other are recorded, marked dirty and journaled as one
+// run.
+internal void EditorPaintSpans(Editor *editor, World *world, FillSpanList *list, Biome biome)
+{
+    for (uint32 spanIndex = 0; spanIndex < list->count; ++spanIndex)
+    {
+        FillSpan *span = list->spans + spanIndex;
+        Cell *row      = GetCellSpan(world, span->y, span->minX, span->maxX, false) - span->minX;
+
+        int32 x = span->minX;
+        while (x <= span->maxX)
+        {
+            if (row[x].biome == biome)
+            {
+                ++x;
+            }
+            else
+            {
+                int32 runMinX = x;
+                while (x <= span->maxX && row[x].biome != biome)
+                {
+                    ++x;
+                }
+
+                int32 runMaxX    = x - 1;
+                uint32 runCount  = runMaxX - runMinX + 1;
+                uint32 cellIndex = (uint32)span->y * world->width + runMinX;
+
+                uint64 undoPosition = 0;
+                bool32 recordUndo   = ReserveUndoRecords(editor->undo, runCount, &undoPosition);
+
+                GetCellSpan(world, span->y, runMinX, runMaxX, true);
+
+                for (int32 runX = runMinX; runX <= runMaxX; ++runX)
+                {
+                    if (recordUndo)
+                    {
+                        UndoRecord *record  = GetUndoRecord(editor->undo, undoPosition++);
+                        record->type        = UNDO_RECORD_PAINT;
+                        record->cellIndex   = cellIndex + (runX - runMinX);
+                        record->before      = (uint8)row[runX].biome;
+                        record->after       = (uint8)biome;
+                        record->entityIndex = 0;
+                    }
+
+                    row[runX].biome = biome;
+                }
+
+                EditorMarkTerrainDirty(editor, span->y, runMinX, runMaxX);
+                JournalPaintRun(editor->journal, world, runMinX, span->y, runCount, biome);
+            }
+        }
+    }
+}
+
+// NOTE gives every cell within radius the biome most of the cells around it have. The filter reads the biomes as they
+// were before any of them changed, so it copies the brush with a ring of cells around it into a grid and only paints
+// once the whole grid is done.
+internal void EditorSmoothBiomes(Editor *editor, World *world, GameMemory *memory, MemoryArena *arena,
+                                 HexCoord center, int32 radius)
+{
+    TemporaryMemory smoothMemory = StartTemporaryMemory(arena);
+    FillSpanList spans           = MakeFillSpanList(arena, 2 * radius + 1);
+
+    HexagonFillSpans(world, center, radius, &spans);
+
+    if (spans.count)
+    {
+        int32 minX = world->width;
+        int32 maxX = 0;
+
+        for (uint32 spanIndex = 0; spanIndex < spans.count; ++spanIndex)
+        {
+            minX = Min(minX, spans.spans[spanIndex].minX);
+            maxX = Max(maxX, spans.spans[spanIndex].maxX);
+        }
+
+        minX       = Max(minX - 1, 1);
+        maxX       = Min(maxX + 1, world->width - 1);
+        int32 minY = Max(spans.spans[0].y - 1, 1);
+        int32 maxY = Min(spans.spans[spans.count - 1].y + 1, world->height - 1);
+
+        HexBiomeGrid source = MakeHexBiomeGrid(arena, maxX - minX + 1, maxY - minY + 1, minY);
+        HexBiomeGrid dest   = MakeHexBiomeGrid(arena, maxX - minX + 1, maxY - minY + 1, minY);
+
+        FillHexGridApron(&source);
+
+        for (int32 y = minY; y <= maxY; ++y)
+        {
+            uint8 *row = GetHexGridRow(&source, y - minY);
+            Cell *cell = GetCellSpan(world, y, minX, maxX, false);
+
+            for (int32 x = minX; x <= maxX; ++x)
+            {
+                *row++ = (uint8)(cell++)->biome;
+            }
+        }
+
+        real32 ringWeights[2] = {1.0f, 1.0f};
+        HexKernel kernel      = MakeHexKernel(1, ringWeights);
+
+        MajorityFilterHexGrid(&kernel, &source, &dest, memory, HEX_KERNEL_MAX_JOB_COUNT);
+
+        for (uint32 spanIndex = 0; spanIndex < spans.count; ++spanIndex)
+        {
+            FillSpan *span = spans.spans + spanIndex;
+            uint8 *row     = GetHexGridRow(&dest, span->y - minY) + span->minX - minX;
+            Cell *cell     = GetCellSpan(world, span->y, span->minX, span->maxX, false);
+
+            for (int32 x = span->minX; x <= span->maxX; ++x)
+            {
+                EditorPaintCell(editor, world, cell++, (Biome)*row++);
+            }
+        }
+    }
+
+    EndTemporaryMemory(smoothMemory);
+}
+
+internal void EditorBeginBrushStroke(Editor *editor, World *world, MemoryArena *arena, HexCoord at)
+{
+    MemoryIndex cellCount = (MemoryIndex)world->width * world->height;
+    if (editor->strokeMaskCellCount < cellCount)
+    {
+        // NOTE only happens when a bigger world gets loaded, the old mask stays behind in the arena.
+        MemoryIndex wordCount = (cellCount + 63) / 64;
+
+        editor->strokeMask          = PushArray(arena, wordCount, uint64);
+        editor->strokeMaskCellCount = cellCount;
+
+        memset(editor->strokeMask, 0, wordCount * sizeof(uint64));
+    }
+
+    editor->isBrushStroking    = true;
+    editor->lastBrushHex       = at;
+    editor->strokeMinCellIndex = cellCount;
+    editor->strokeMaxCellIndex = 0;
+    editor->strokeCellCount    = 0;
+    editor->strokeCycles       = 0;
+}
+
+// NOTE paints the brush at every cell on the line from where the stroke was last frame to where it is now. The
+// footprints overlap almost entirely, so they are merged first: the hexagons along a line cover one run of cells on
+// every row, and only the cells of those runs get tested against the mask, once each, however long the line is.
+internal void EditorBrushStrokeTo(Editor *editor, World *world, MemoryArena *arena, HexCoord to, Biome biome)
+{
+    Assert(editor->isBrushStroking);
+
+    uint64 start = __rdtsc();
+
+    HexCoord from = editor->lastBrushHex;
+    int32 radius  = editor->brushSize;
+    int32 minY    = Max(Min(from.r, to.r) - radius, 1);
+    int32 maxY    = Min(Max(from.r, to.r) + radius, world->height - 1);
+
+    if (minY <= maxY)
+    {
+        TemporaryMemory rowMemory = StartTemporaryMemory(arena);
+
+        int32 rowCount = maxY - minY + 1;
+        int32 *rowMinX = PushArray(arena, rowCount, int32);
+        int32 *rowMaxX = PushArray(arena, rowCount, int32);
+
+        for (int32 rowIndex = 0; rowIndex < rowCount; ++rowIndex)
+        {
+            rowMinX[rowIndex] = world->width;
+            rowMaxX[rowIndex] = 0;
+        }
+
+        for (HexLineIterator line = BeginHexLine(from, to); !line.isDone; NextHexLine(&line))
+        {
+            for (HexSpanIterator it = BeginHexSpans(line.hex, radius, 1, minY, world->width - 1, maxY); !it.isDone;
+                 NextHexSpan(&it))
+            {
+                int32 rowIndex    = it.y - minY;
+                rowMinX[rowIndex] = Min(rowMinX[rowIndex], it.minX);
+                rowMaxX[rowIndex] = Max(rowMaxX[rowIndex], it.maxX);
+            }
+        }
+
+        uint64 *mask = editor->strokeMask;
+
+        for (int32 rowIndex = 0; rowIndex < rowCount; ++rowIndex)
+        {
+            int32 y    = minY + rowIndex;
+            int32 minX = rowMinX[rowIndex];
+            int32 maxX = rowMaxX[rowIndex];
+
+            if (minX <= maxX)
+            {
+                Cell *cell            = GetCellSpan(world, y, minX, maxX, false);
+                MemoryIndex cellIndex = (MemoryIndex)y * world->width + minX;
+
+                if (cellIndex < editor->strokeMinCellIndex)
+                {
+                    editor->strokeMinCellIndex = cellIndex;
+                }
+
+                if (cellIndex + maxX - minX > editor->strokeMaxCellIndex)
+                {
+                    editor->strokeMaxCellIndex = cellIndex + maxX - minX;
+                }
+
+                for (int32 x = minX; x <= maxX; ++x)
+                {
+                    uint64 bit = (uint64)1 << (cellIndex & 63);
+                    if (!(mask[cellIndex >> 6] & bit))
+                    {
+                        mask[cellIndex >> 6] |= bit;
+
+                        EditorPaintCell(editor, world, cell, biome);
+                        ++editor->strokeCellCount;
+                    }
+
+                    ++cell;
+                    ++cellIndex;
+                }
+            }
+        }
+
+        EndTemporaryMemory(rowMemory);
+    }
+
+    editor->lastBrushHex = to;
+    editor->strokeCycles += __rdtsc() - start;
+}
+
+internal void EditorEndBrushStroke(Editor *editor)
+{
+    if (editor->isBrushStroking)
+    {
+        if (editor->strokeMinCellIndex <= editor->strokeMaxCellIndex)
+        {
+            MemoryIndex firstWord = editor->strokeMinCellIndex >> 6;
+            MemoryIndex lastWord  = editor->strokeMaxCellIndex >> 6;
+
+            memset(editor->strokeMask + firstWord, 0, (lastWord - firstWord + 1) * sizeof(uint64));
+        }
+
+        editor->isBrushStroking = false;
+    }
+}
+
+struct FillJob
+{
+    World *world;
+    UndoHistory *undo;
+
+    FillSpan *spans;
+    uint32 spanCount;
+
+    // NOTE how many of the cells the job covers get another biome, counted before anything is painted.
+    uint32 changeCount;
+
+    bool32 recordUndo;
+    uint64 undoPosition;
+
+    Biome biome;
+};
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoCountFillJob)
+{
+    TIMED_FUNCTION();
+
+    FillJob *job       = (FillJob *)data;
+    World *world       = job->world;
+    uint32 changeCount = 0;
+
+    for (uint32 spanIndex = 0; spanIndex < job->spanCount; ++spanIndex)
+    {
+        FillSpan *span = job->spans + spanIndex;
+        Cell *cell     = GetCellByIndex(world, (uint32)span->y * world->width + span->minX);
+
+        for (int32 x = span->minX; x <= span->maxX; ++x)
+        {
+            changeCount += (cell++)->biome != job->biome;
+        }
+    }
+
+    job->changeCount = changeCount;
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoFillJob)
+{
+    TIMED_FUNCTION();
+
+    FillJob *job        = (FillJob *)data;
+    World *world        = job->world;
+    uint64 undoPosition = job->undoPosition;
+
+    for (uint32 spanIndex = 0; spanIndex < job->spanCount; ++spanIndex)
+    {
+        FillSpan *span   = job->spans + spanIndex;
+        uint32 cellIndex = (uint32)span->y * world->width + span->minX;
+        Cell *cell       = GetCellByIndex(world, cellIndex);
+
+        for (int32 x = span->minX; x <= span->maxX; ++x)
+        {
+            if (cell->biome != job->biome)
+            {
+                if (job->recordUndo)
+                {
+                    UndoRecord *record  = GetUndoRecord(job->undo, undoPosition++);
+                    record->type        = UNDO_RECORD_PAINT;
+                    record->cellIndex   = cellIndex;
+                    record->before      = (uint8)cell->biome;
+                    record->after       = (uint8)job->biome;
+                    record->entityIndex = 0;
+                }
+
+                cell->biome = job->biome;
+            }
+
+            ++cell;
+            ++cellIndex;
+        }
+    }
+}
+
+// NOTE small fills go through EditorPaintSpans. Big ones do everything that touches shared state on this thread
+// first, paging chunks in, marking them dirty and journaling every span, and then split the spans over the high
+// priority queue twice. The first time the jobs count the cells that are going to change, so only those get an undo
+// record, and the second time each job knows where its records start, so no two jobs ever write to the same cell or
+// record.
+internal void EditorFillSpans(Editor *editor, World *world, GameMemory *memory, MemoryArena *arena,
+                              FillSpanList *list, Biome biome)
+{
+    if (list->cellCount < FILL_JOB_MIN_CELL_COUNT)
+    {
+        EditorPaintSpans(editor, world, list, biome);
+    }
+    else
+    {
+        for (uint32 spanIndex = 0; spanIndex < list->count; ++spanIndex)
+        {
+            FillSpan *span = list->spans + spanIndex;
+
+            GetCellSpan(world, span->y, span->minX, span->maxX, true);
+            EditorMarkTerrainDirty(editor, span->y, span->minX, span->maxX);
+            JournalPaintRun(editor->journal, world, span->minX, span->y, span->maxX - span->minX + 1, biome);
+        }
+
+        TemporaryMemory jobMemory = StartTemporaryMemory(arena);
+
+        FillJob *jobs       = PushArray(arena, FILL_MAX_JOB_COUNT, FillJob);
+        uint32 jobCount     = 0;
+        uint64 cellsPerJob  = list->cellCount / FILL_MAX_JOB_COUNT + 1;
+        uint64 jobCellCount = 0;
+        uint32 firstSpan    = 0;
+
+        for (uint32 spanIndex = 0; spanIndex < list->count; ++spanIndex)
+        {
+            FillSpan *span = list->spans + spanIndex;
+            jobCellCount += span->maxX - span->minX + 1;
+
+            if (jobCellCount >= cellsPerJob || spanIndex == list->count - 1)
+            {
+                Assert(jobCount < FILL_MAX_JOB_COUNT);
+
+                FillJob *job   = jobs + jobCount++;
+                job->world     = world;
+                job->undo      = editor->undo;
+                job->spans     = list->spans + firstSpan;
+                job->spanCount = spanIndex - firstSpan + 1;
+                job->biome     = biome;
+
+                memory->platformAddEntry(memory->highPriorityQueue, DoCountFillJob, job);
+
+                jobCellCount = 0;
+                firstSpan    = spanIndex + 1;
+            }
+        }
+
+        memory->platformCompleteAllWork(memory->highPriorityQueue);
+
+        uint64 changeCount = 0;
+        for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+        {
+            changeCount += jobs[jobIndex].changeCount;
+        }
+
+        // NOTE a fill that changes more cells than the history holds doesn't get recorded, the strokes before it
+        // stay undoable.
+        uint64 undoPosition = 0;
+        bool32 recordUndo   = false;
+
+        if (changeCount)
+        {
+            uint32 reserveCount = changeCount < 0xFFFFFFFF ? (uint32)changeCount : 0xFFFFFFFF;
+            recordUndo          = ReserveUndoRecords(editor->undo, reserveCount, &undoPosition);
+
+            for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+            {
+                FillJob *job      = jobs + jobIndex;
+                job->recordUndo   = recordUndo;
+                job->undoPosition = undoPosition;
+
+                memory->platformAddEntry(memory->highPriorityQueue, DoFillJob, job);
+
+                undoPosition += job->changeCount;
+            }
+
+            memory->platformCompleteAllWork(memory->highPriorityQueue);
+        }
+
+        EndTemporaryMemory(jobMemory);
+    }
+}
+
+// NOTE strokes only reference cells by index, which is fine since chunks of a paged world never get paged out.
+internal void EditorUndo(Editor *editor, World *world)
+{
+    UndoHistory *history = editor->undo;
+    UndoStroke stroke    = PopUndoStroke(history);
+
+    for (uint64 position = stroke.first + stroke.count; position > stroke.first; --position)
+    {
+        UndoRecord *record = GetUndoRecord(history, position - 1);
+
+        switch (record->type)
+        {
+            case UNDO_RECORD_PAINT:
+            {
+                EditorSetCellBiome(editor, world, record->cellIndex, (Biome)record->before);
+            }
+            break;
+
+            case UNDO_RECORD_ADD_ENTITY:
+            {
+                EditorRemoveEntity(editor, world, record->cellIndex, (EntityType)record->before);
+            }
+            break;
+        }
+    }
+}
+
+internal void EditorRedo(Editor *editor, World *world)
+{
+    UndoHistory *history = editor->undo;
+    UndoStroke stroke    = PopRedoStroke(history);
+
+    for (uint64 position = stroke.first; position < stroke.first + stroke.count; ++position)
+    {
+        UndoRecord *record = GetUndoRecord(history, position);
+
+        switch (record->type)
+        {
+            case UNDO_RECORD_PAINT:
+            {
+                EditorSetCellBiome(editor, world, record->cellIndex, (Biome)record->after);
+            }
+            break;
+
+            case UNDO_RECORD_ADD_ENTITY:
+            {
+                EditorRestoreEntity(editor, world, record->cellIndex, (EntityType)record->after, record->entityIndex);
+            }
+            break;
+        }
+    }
+}
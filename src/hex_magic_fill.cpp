@@ -0,0 +1,225 @@
+#include "hex_magic.h"
+#include "hex_magic_fill.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_platform.h"
+
+internal FillSpanList MakeFillSpanList(MemoryArena *arena, uint32 capacity)
+{
+    FillSpanList result = {};
+
+    result.capacity = capacity;
+    result.spans    = PushArray(arena, capacity, FillSpan);
+
+    return result;
+}
+
+inline void ClearFillSpanList(FillSpanList *list)
+{
+    list->count      = 0;
+    list->cellCount  = 0;
+    list->overflowed = false;
+}
+
+// NOTE clips the span to the cells GetCell hands out, and drops it if nothing is left.
+internal void AddFillSpan(FillSpanList *list, World *world, int32 y, int32 minX, int32 maxX)
+{
+    minX = Max(minX, 1);
+    maxX = Min(maxX, world->width - 1);
+
+    if (y > 0 && y < world->height && minX <= maxX)
+    {
+        if (list->count < list->capacity)
+        {
+            FillSpan *span = list->spans + list->count++;
+            span->y        = y;
+            span->minX     = minX;
+            span->maxX     = maxX;
+
+            list->cellCount += maxX - minX + 1;
+        }
+        else
+        {
+            list->overflowed = true;
+        }
+    }
+}
+
+internal void HexagonFillSpans(World *world, HexCoord center, int32 radius, FillSpanList *list)
+{
+    for (HexSpanIterator it = BeginHexSpans(center, radius, 1, 1, world->width - 1, world->height - 1); !it.isDone;
+         NextHexSpan(&it))
+    {
+        AddFillSpan(list, world, it.y, it.minX, it.maxX);
+    }
+}
+
+internal void RectangleFillSpans(World *world, OffsetCoord a, OffsetCoord b, FillSpanList *list)
+{
+    int32 minX = Min(a.x, b.x);
+    int32 maxX = Max(a.x, b.x);
+    int32 minY = Min(a.y, b.y);
+    int32 maxY = Max(a.y, b.y);
+
+    for (int32 y = minY; y <= maxY; ++y)
+    {
+        AddFillSpan(list, world, y, minX, maxX);
+    }
+}
+
+// NOTE even-odd scanline fill through the cell centres of every row the polygon covers.
+internal void PolygonFillSpans(World *world, V2 *vertices, uint32 vertexCount, FillSpanList *list,
+                               MemoryArena *arena)
+{
+    TemporaryMemory crossingMemory = StartTemporaryMemory(arena);
+
+    real32 *crossings = PushArray(arena, vertexCount, real32);
+
+    real32 minWorldY = vertices[0].y;
+    real32 maxWorldY = vertices[0].y;
+    for (uint32 vertexIndex = 1; vertexIndex < vertexCount; ++vertexIndex)
+    {
+        minWorldY = Min(minWorldY, vertices[vertexIndex].y);
+        maxWorldY = Max(maxWorldY, vertices[vertexIndex].y);
+    }
+
+    V2 rowStep    = HexToV2(HexFromOffset({0, 2})) - HexToV2(HexFromOffset({0, 0}));
+    real32 cellDX = (HexToV2(HexFromOffset({1, 0})) - HexToV2(HexFromOffset({0, 0}))).x;
+    int32 minY    = CeilReal32ToInt32(2.0f * minWorldY / rowStep.y);
+    int32 maxY    = FloorReal32ToInt32(2.0f * maxWorldY / rowStep.y);
+
+    for (int32 y = Max(minY, 1); y <= Min(maxY, world->height - 1); ++y)
+    {
+        V2 rowOrigin         = HexToV2(HexFromOffset({0, y}));
+        uint32 crossingCount = 0;
+
+        for (uint32 vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+        {
+            V2 a = vertices[vertexIndex];
+            V2 b = vertices[(vertexIndex + 1) % vertexCount];
+
+            if ((a.y <= rowOrigin.y && rowOrigin.y < b.y) || (b.y <= rowOrigin.y && rowOrigin.y < a.y))
+            {
+                real32 t = (rowOrigin.y - a.y) / (b.y - a.y);
+                real32 x = a.x + t * (b.x - a.x);
+
+                uint32 insertIndex = crossingCount++;
+                while (insertIndex > 0 && crossings[insertIndex - 1] > x)
+                {
+                    crossings[insertIndex] = crossings[insertIndex - 1];
+                    --insertIndex;
+                }
+
+                crossings[insertIndex] = x;
+            }
+        }
+
+        for (uint32 crossingIndex = 0; crossingIndex + 1 < crossingCount; crossingIndex += 2)
+        {
+            int32 minX = CeilReal32ToInt32((crossings[crossingIndex] - rowOrigin.x) / cellDX);
+            int32 maxX = FloorReal32ToInt32((crossings[crossingIndex + 1] - rowOrigin.x) / cellDX);
+
+            AddFillSpan(list, world, y, minX, maxX);
+        }
+    }
+
+    EndTemporaryMemory(crossingMemory);
+}
+
+inline bool32 IsFillTarget(World *world, uint64 *visited, int32 x, int32 y, Biome target)
+{
+    MemoryIndex cellIndex = (MemoryIndex)y * world->width + x;
+    bool32 result         = false;
+
+    if (!(visited[cellIndex >> 6] & ((uint64)1 << (cellIndex & 63))))
+    {
+        Cell *cell = world->pager ? GetCell(world, OffsetCoord{x, y}) : world->cells + cellIndex;
+        result     = cell->biome == target;
+    }
+
+    return result;
+}
+
+// NOTE scanline flood fill. Each seed grows into the widest run of the target biome in its row, and the cells
+// touching that run in the rows above and below seed the next runs. In odd-r offset coordinates an even row touches
+// x - 1 and x of its neighbour rows, an odd row x and x + 1.
+internal void FloodFillSpans(World *world, OffsetCoord seed, FillSpanList *list, MemoryArena *arena)
+{
+    Cell *seedCell = GetCell(world, seed);
+    if (seedCell)
+    {
+        TemporaryMemory floodMemory = StartTemporaryMemory(arena);
+
+        Biome target          = seedCell->biome;
+        MemoryIndex wordCount = ((MemoryIndex)world->width * world->height + 63) / 64;
+        uint64 *visited       = PushArray(arena, wordCount, uint64);
+        OffsetCoord *seeds    = PushArray(arena, FILL_MAX_SPAN_COUNT, OffsetCoord);
+        uint32 seedCount      = 0;
+
+        memset(visited, 0, wordCount * sizeof(uint64));
+
+        seeds[seedCount++] = seed;
+        while (seedCount && !list->overflowed)
+        {
+            OffsetCoord at = seeds[--seedCount];
+            if (!IsFillTarget(world, visited, at.x, at.y, target))
+            {
+                continue;
+            }
+
+            int32 minX = at.x;
+            int32 maxX = at.x;
+
+            while (minX > 1 && IsFillTarget(world, visited, minX - 1, at.y, target))
+            {
+                --minX;
+            }
+
+            while (maxX < world->width - 1 && IsFillTarget(world, visited, maxX + 1, at.y, target))
+            {
+                ++maxX;
+            }
+
+            MemoryIndex rowIndex = (MemoryIndex)at.y * world->width;
+            for (int32 x = minX; x <= maxX; ++x)
+            {
+                MemoryIndex cellIndex = rowIndex + x;
+                visited[cellIndex >> 6] |= (uint64)1 << (cellIndex & 63);
+            }
+
+            AddFillSpan(list, world, at.y, minX, maxX);
+
+            int32 shift = at.y & 1;
+            for (int32 y = at.y - 1; y <= at.y + 1; y += 2)
+            {
+                if (y < 1 || y >= world->height)
+                {
+                    continue;
+                }
+
+                int32 scanMinX = Max(minX - 1 + shift, 1);
+                int32 scanMaxX = Min(maxX + shift, world->width - 1);
+
+                for (int32 x = scanMinX; x <= scanMaxX; ++x)
+                {
+                    if (IsFillTarget(world, visited, x, y, target))
+                    {
+                        if (seedCount == FILL_MAX_SPAN_COUNT)
+                        {
+                            list->overflowed = true;
+                            break;
+                        }
+
+                        seeds[seedCount++] = OffsetCoord{x, y};
+
+                        while (x < scanMaxX && IsFillTarget(world, visited, x + 1, y, target))
+                        {
+                            ++x;
+                        }
+                    }
+                }
+            }
+        }
+
+        EndTemporaryMemory(floodMemory);
+    }
+}
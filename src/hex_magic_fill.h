@@ -0,0 +1,32 @@
+#if !defined(HEX_MAGIC_FILL)
+
+#include "hex_magic_platform.h"
+
+// NOTE fill tools turn their region into row spans on the offset grid first and only then paint the spans, in
+// parallel once there are enough cells to be worth it.
+
+#define FILL_MAX_SPAN_COUNT (4 * 1024 * 1024)
+#define FILL_JOB_MIN_CELL_COUNT (64 * 1024)
+#define FILL_MAX_JOB_COUNT 32
+
+struct FillSpan
+{
+    int32 y;
+    int32 minX;
+    int32 maxX;
+};
+
+struct FillSpanList
+{
+    uint32 count;
+    uint32 capacity;
+    FillSpan *spans;
+
+    uint64 cellCount;
+
+    // NOTE set when a region needed more spans than there was room for, what is in the list is then incomplete.
+    bool32 overflowed;
+};
+
+#define HEX_MAGIC_FILL
+#endif
@@ -0,0 +1,685 @@
+#include "hex_magic.h"
+#include "hex_magic_flow.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_path.h"
+#include "hex_magic_platform.h"
+
+#define FLOW_LIST_HEAD 0xFFFFFFFE
+
+internal void InitializeFlowDialQueue(FlowDialQueue *queue, MemoryArena *arena, MemoryIndex capacity)
+{
+    queue->next     = PushArray(arena, capacity, uint32);
+    queue->prev     = PushArray(arena, capacity, uint32);
+    queue->count    = 0;
+    queue->distance = 0;
+
+    memset(queue->prev, 0xFF, capacity * sizeof(uint32));
+
+    for (uint32 bucketIndex = 0; bucketIndex < FLOW_BUCKET_COUNT; ++bucketIndex)
+    {
+        queue->heads[bucketIndex] = FLOW_LIST_END;
+    }
+}
+
+inline bool32 IsFlowQueued(FlowDialQueue *queue, uint32 index)
+{
+    bool32 result = queue->prev[index] != FLOW_NOT_QUEUED;
+    return result;
+}
+
+// NOTE distance has to be within FLOW_BUCKET_COUNT - 1 of the smallest distance in the queue.
+inline void PushFlowDial(FlowDialQueue *queue, uint32 index, uint32 distance)
+{
+    uint32 *head = queue->heads + (distance & (FLOW_BUCKET_COUNT - 1));
+
+    if (!queue->count || distance < queue->distance)
+    {
+        queue->distance = distance;
+    }
+
+    queue->next[index] = *head;
+    queue->prev[index] = FLOW_LIST_HEAD;
+
+    if (*head != FLOW_LIST_END)
+    {
+        queue->prev[*head] = index;
+    }
+
+    *head = index;
+    ++queue->count;
+}
+
+inline void RemoveFlowDial(FlowDialQueue *queue, uint32 index, uint32 distance)
+{
+    uint32 next = queue->next[index];
+    uint32 prev = queue->prev[index];
+
+    if (prev == FLOW_LIST_HEAD)
+    {
+        queue->heads[distance & (FLOW_BUCKET_COUNT - 1)] = next;
+    }
+    else
+    {
+        queue->next[prev] = next;
+    }
+
+    if (next != FLOW_LIST_END)
+    {
+        queue->prev[next] = prev;
+    }
+
+    queue->prev[index] = FLOW_NOT_QUEUED;
+    --queue->count;
+}
+
+inline uint32 PopFlowDial(FlowDialQueue *queue)
+{
+    Assert(queue->count);
+
+    while (queue->heads[queue->distance & (FLOW_BUCKET_COUNT - 1)] == FLOW_LIST_END)
+    {
+        ++queue->distance;
+    }
+
+    uint32 result = queue->heads[queue->distance & (FLOW_BUCKET_COUNT - 1)];
+    RemoveFlowDial(queue, result, queue->distance);
+
+    return result;
+}
+
+inline bool32 FlowFieldCacheFitsInArena(MemoryArena *arena, MemoryIndex cellCapacity)
+{
+    MemoryIndex tileCapacity = cellCapacity / FLOW_TILE_CELL_COUNT + (cellCapacity + 1) / FLOW_TILE_DIM + 2;
+
+    MemoryIndex required = sizeof(FlowFieldCache) +
+                           FLOW_CACHE_FIELD_COUNT * cellCapacity * (sizeof(uint32) + sizeof(uint8)) +
+                           cellCapacity * (sizeof(uint8) + 2 * sizeof(uint32)) +
+                           tileCapacity * (sizeof(uint8) + sizeof(uint32)) +
+                           FLOW_MAX_JOB_COUNT * FLOW_TILE_CELL_COUNT * 2 * sizeof(uint32);
+    bool32 result        = arena->used + required <= arena->size;
+
+    return result;
+}
+
+// NOTE every field gets room for cellCapacity cells up front, bigger regions are turned down.
+internal void InitializeFlowFieldCache(FlowFieldCache *cache, MemoryArena *arena, MemoryIndex cellCapacity)
+{
+    MemoryIndex tileCapacity = cellCapacity / FLOW_TILE_CELL_COUNT + (cellCapacity + 1) / FLOW_TILE_DIM + 2;
+
+    cache->cellCapacity = cellCapacity;
+    cache->useCounter   = 0;
+
+    for (uint32 fieldIndex = 0; fieldIndex < FLOW_CACHE_FIELD_COUNT; ++fieldIndex)
+    {
+        FlowField *field  = cache->fields + fieldIndex;
+        field->isValid    = false;
+        field->lastUsed   = 0;
+        field->distances  = PushArray(arena, cellCapacity, uint32);
+        field->directions = PushArray(arena, cellCapacity, uint8);
+    }
+
+    cache->cellCosts = PushArray(arena, cellCapacity, uint8);
+    InitializeFlowDialQueue(&cache->queue, arena, cellCapacity);
+
+    cache->tileStates = PushArray(arena, tileCapacity, uint8);
+    cache->phaseTiles = PushArray(arena, tileCapacity, uint32);
+
+    for (uint32 jobIndex = 0; jobIndex < FLOW_MAX_JOB_COUNT; ++jobIndex)
+    {
+        FlowTileJob *job = cache->jobs + jobIndex;
+        job->cache       = cache;
+        InitializeFlowDialQueue(&job->queue, arena, FLOW_TILE_CELL_COUNT);
+    }
+
+    cache->lastBuildCycles    = 0;
+    cache->lastBuildPassCount = 0;
+    cache->lastBuildTileCount = 0;
+}
+
+inline bool32 IsInFlowField(FlowField *field, int32 x, int32 y)
+{
+    bool32 result = x >= field->minX && y >= field->minY && x < field->minX + field->width &&
+                    y < field->minY + field->height;
+    return result;
+}
+
+inline void MarkFlowSpanDirty(FlowFieldCache *cache, int32 y, int32 minX, int32 maxX)
+{
+    for (uint32 fieldIndex = 0; fieldIndex < FLOW_CACHE_FIELD_COUNT; ++fieldIndex)
+    {
+        FlowField *field = cache->fields + fieldIndex;
+
+        if (field->isValid && y >= field->minY && y < field->minY + field->height && maxX >= field->minX &&
+            minX < field->minX + field->width)
+        {
+            field->isValid = false;
+        }
+    }
+}
+
+inline void MarkFlowCellDirty(FlowFieldCache *cache, int32 x, int32 y) { MarkFlowSpanDirty(cache, y, x, x); }
+
+// NOTE the cell to step into from at to get closer to a target, or at itself when it is a target, can't reach one or
+// lies outside the field.
+internal OffsetCoord GetFlowStep(FlowField *field, OffsetCoord at)
+{
+    OffsetCoord result = at;
+
+    if (IsInFlowField(field, at.x, at.y))
+    {
+        uint8 direction = field->directions[(at.y - field->minY) * field->width + (at.x - field->minX)];
+        if (direction != FLOW_NO_DIRECTION)
+        {
+            result = OffsetNeighbour(at, direction);
+        }
+    }
+
+    return result;
+}
+
+inline uint32 GetFlowDistance(FlowField *field, OffsetCoord at)
+{
+    uint32 result = FLOW_UNREACHABLE;
+
+    if (IsInFlowField(field, at.x, at.y))
+    {
+        result = field->distances[(at.y - field->minY) * field->width + (at.x - field->minX)];
+    }
+
+    return result;
+}
+
+// NOTE Dial's algorithm over one rectangle of the field, which is either a tile or the whole field. Seeds are field
+// cells that already have their distance and are sorted by it, they go into the queue as the search gets close enough
+// to them. Returns whether a cell on the edge of the rectangle got closer, which is what the tiles next to it care
+// about.
+internal bool32 RunFlowSearch(FlowField *field, uint8 *cellCosts, FlowDialQueue *queue, int32 rectX, int32 rectY,
+                              int32 rectWidth, int32 rectHeight, uint32 *seeds, uint32 seedCount)
+{
+    bool32 result = false;
+
+    uint32 *distances = field->distances;
+    uint8 *directions = field->directions;
+    uint32 seedIndex  = 0;
+
+    for (;;)
+    {
+        if (!queue->count)
+        {
+            if (seedIndex == seedCount)
+            {
+                break;
+            }
+
+            queue->distance = distances[seeds[seedIndex]];
+        }
+
+        while (seedIndex < seedCount && distances[seeds[seedIndex]] < queue->distance + FLOW_BUCKET_COUNT)
+        {
+            uint32 index = seeds[seedIndex++];
+            int32 localX      = index % field->width - rectX;
+            int32 localY      = index / field->width - rectY;
+            uint32 localIndex = localY * rectWidth + localX;
+
+            // NOTE a seed below the current distance was reached from within and has been settled already.
+            if (!IsFlowQueued(queue, localIndex) && (!queue->count || distances[index] >= queue->distance))
+            {
+                PushFlowDial(queue, localIndex, distances[index]);
+            }
+        }
+
+        uint32 localIndex = PopFlowDial(queue);
+        int32 localX      = localIndex % rectWidth;
+        int32 localY      = localIndex / rectWidth;
+        int32 x           = rectX + localX;
+        int32 y           = rectY + localY;
+
+        uint32 index    = y * field->width + x;
+        uint32 distance = distances[index] + cellCosts[index];
+
+        // NOTE neighbours step back into this cell, the direction they take is the opposite of the one used here.
+        OffsetCoord *offsets = globalOffsetDirections[(field->minY + y) & 1];
+
+        for (uint32 direction = 0; direction < 6; ++direction)
+        {
+            int32 neighbourX = localX + offsets[direction].x;
+            int32 neighbourY = localY + offsets[direction].y;
+
+            if (neighbourX < 0 || neighbourY < 0 || neighbourX >= rectWidth || neighbourY >= rectHeight)
+            {
+                continue;
+            }
+
+            uint32 neighbourIndex = index + offsets[direction].y * field->width + offsets[direction].x;
+            uint32 neighbourLocal = neighbourY * rectWidth + neighbourX;
+
+            if (cellCosts[neighbourIndex] && distance < distances[neighbourIndex])
+            {
+                if (IsFlowQueued(queue, neighbourLocal))
+                {
+                    RemoveFlowDial(queue, neighbourLocal, distances[neighbourIndex]);
+                }
+
+                distances[neighbourIndex]  = distance;
+                directions[neighbourIndex] = (uint8)((direction + 3) % 6);
+
+                PushFlowDial(queue, neighbourLocal, distance);
+
+                if (neighbourX == 0 || neighbourY == 0 || neighbourX == rectWidth - 1 ||
+                    neighbourY == rectHeight - 1)
+                {
+                    result = true;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE a tile is only gone over again when cells along its edge can now be reached for less from a tile next to it.
+// Those cells are the seeds, along with any targets in the tile.
+internal bool32 RunFlowTile(FlowFieldCache *cache, FlowField *field, FlowDialQueue *queue, uint32 tileIndex)
+{
+    uint32 seeds[4 * FLOW_TILE_DIM + FLOW_MAX_TARGET_COUNT];
+    uint32 seedCount = 0;
+    bool32 result    = false;
+
+    int32 rectX      = (tileIndex % cache->tileCountX) << FLOW_TILE_SHIFT;
+    int32 rectY      = (tileIndex / cache->tileCountX) << FLOW_TILE_SHIFT;
+    int32 rectWidth  = Min(FLOW_TILE_DIM, field->width - rectX);
+    int32 rectHeight = Min(FLOW_TILE_DIM, field->height - rectY);
+
+    uint32 *distances = field->distances;
+    uint8 *cellCosts  = cache->cellCosts;
+
+    for (uint32 targetIndex = 0; targetIndex < field->targetCount; ++targetIndex)
+    {
+        int32 x = field->targets[targetIndex].x - field->minX;
+        int32 y = field->targets[targetIndex].y - field->minY;
+
+        if (x >= rectX && y >= rectY && x < rectX + rectWidth && y < rectY + rectHeight &&
+            distances[y * field->width + x] == 0)
+        {
+            seeds[seedCount++] = y * field->width + x;
+        }
+    }
+
+    for (int32 localY = 0; localY < rectHeight; ++localY)
+    {
+        bool32 isEdgeRow = localY == 0 || localY == rectHeight - 1;
+        int32 step       = isEdgeRow ? 1 : Max(rectWidth - 1, 1);
+
+        for (int32 localX = 0; localX < rectWidth; localX += step)
+        {
+            int32 x      = rectX + localX;
+            int32 y      = rectY + localY;
+            uint32 index = y * field->width + x;
+
+            if (!cellCosts[index])
+            {
+                continue;
+            }
+
+            OffsetCoord *offsets = globalOffsetDirections[(field->minY + y) & 1];
+            bool32 isSeed        = false;
+
+            for (uint32 direction = 0; direction < 6; ++direction)
+            {
+                int32 neighbourX = x + offsets[direction].x;
+                int32 neighbourY = y + offsets[direction].y;
+
+                bool32 isInTile = neighbourX >= rectX && neighbourY >= rectY && neighbourX < rectX + rectWidth &&
+                                  neighbourY < rectY + rectHeight;
+                bool32 isInField = neighbourX >= 0 && neighbourY >= 0 && neighbourX < field->width &&
+                                   neighbourY < field->height;
+
+                if (isInTile || !isInField)
+                {
+                    continue;
+                }
+
+                uint32 neighbourIndex = neighbourY * field->width + neighbourX;
+                uint32 distance       = distances[neighbourIndex];
+
+                if (distance != FLOW_UNREACHABLE && distance + cellCosts[neighbourIndex] < distances[index])
+                {
+                    distances[index]         = distance + cellCosts[neighbourIndex];
+                    field->directions[index] = (uint8)direction;
+
+                    isSeed = true;
+                }
+            }
+
+            if (isSeed)
+            {
+                seeds[seedCount++] = index;
+                result             = true;
+            }
+        }
+    }
+
+    // NOTE there are only a few hundred seeds at most.
+    for (uint32 seedIndex = 1; seedIndex < seedCount; ++seedIndex)
+    {
+        uint32 seed = seeds[seedIndex];
+        uint32 at   = seedIndex;
+
+        while (at > 0 && distances[seeds[at - 1]] > distances[seed])
+        {
+            seeds[at] = seeds[at - 1];
+            --at;
+        }
+
+        seeds[at] = seed;
+    }
+
+    if (RunFlowSearch(field, cellCosts, queue, rectX, rectY, rectWidth, rectHeight, seeds, seedCount))
+    {
+        result = true;
+    }
+
+    return result;
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoFlowTileJob)
+{
+    TIMED_FUNCTION();
+
+    FlowTileJob *job      = (FlowTileJob *)data;
+    FlowFieldCache *cache = job->cache;
+
+    for (uint32 tileIndex = 0; tileIndex < job->tileCount; ++tileIndex)
+    {
+        uint32 tile = job->tiles[tileIndex];
+        if (RunFlowTile(cache, job->field, &job->queue, tile))
+        {
+            cache->tileStates[tile] |= FLOW_TILE_CHANGED;
+        }
+    }
+}
+
+// NOTE clears the field and loads the cost of every cell into the scratch, 0 for cells that can't be entered. Cells
+// in the first row or column aren't part of the world as far as GetCell is concerned, so they can't be entered either.
+internal void ResetFlowField(FlowFieldCache *cache, FlowField *field, World *world)
+{
+    MemoryIndex cellCount = (MemoryIndex)field->width * field->height;
+
+    memset(field->distances, 0xFF, cellCount * sizeof(uint32));
+    memset(field->directions, FLOW_NO_DIRECTION, cellCount * sizeof(uint8));
+
+    for (int32 localY = 0; localY < field->height; ++localY)
+    {
+        int32 y           = field->minY + localY;
+        uint8 *cellCost   = cache->cellCosts + (MemoryIndex)localY * field->width;
+        int32 firstLocalX = field->minX > 0 ? 0 : 1;
+
+        if (y == 0 || firstLocalX >= field->width)
+        {
+            memset(cellCost, 0, field->width);
+            continue;
+        }
+
+        cellCost[0] = 0;
+
+        Cell *cell = GetCellSpan(world, y, field->minX + firstLocalX, field->minX + field->width - 1, false);
+        for (int32 localX = firstLocalX; localX < field->width; ++localX)
+        {
+            cellCost[localX] = field->costs.costs[(cell++)->biome];
+        }
+    }
+
+    for (uint32 targetIndex = 0; targetIndex < field->targetCount; ++targetIndex)
+    {
+        MemoryIndex index = (MemoryIndex)(field->targets[targetIndex].y - field->minY) * field->width +
+                            (field->targets[targetIndex].x - field->minX);
+
+        // NOTE targets that can't be entered can't be reached either.
+        if (cache->cellCosts[index])
+        {
+            field->distances[index] = 0;
+        }
+    }
+}
+
+internal void BuildFlowField(FlowFieldCache *cache, FlowField *field, World *world)
+{
+    uint64 start = __rdtsc();
+
+    ResetFlowField(cache, field, world);
+
+    uint32 seeds[FLOW_MAX_TARGET_COUNT];
+    uint32 seedCount = 0;
+
+    for (uint32 targetIndex = 0; targetIndex < field->targetCount; ++targetIndex)
+    {
+        uint32 index = (field->targets[targetIndex].y - field->minY) * field->width +
+                       (field->targets[targetIndex].x - field->minX);
+
+        if (field->distances[index] == 0)
+        {
+            seeds[seedCount++] = index;
+        }
+    }
+
+    RunFlowSearch(field, cache->cellCosts, &cache->queue, 0, 0, field->width, field->height, seeds, seedCount);
+
+    cache->lastBuildCycles    = __rdtsc() - start;
+    cache->lastBuildPassCount = 1;
+    cache->lastBuildTileCount = 1;
+}
+
+// NOTE the tiles are split into four groups by the parity of their position, and no two tiles of a group touch. Each
+// pass runs the groups one after the other, with the active tiles of a group spread over the high priority queue.
+// Tiles whose edges changed wake up the tiles around them, and the passes go on until every tile is settled.
+internal void BuildFlowFieldWithJobs(FlowFieldCache *cache, FlowField *field, World *world, GameMemory *memory)
+{
+    uint64 start = __rdtsc();
+
+    ResetFlowField(cache, field, world);
+
+    cache->tileCountX = (field->width + FLOW_TILE_DIM - 1) >> FLOW_TILE_SHIFT;
+    cache->tileCountY = (field->height + FLOW_TILE_DIM - 1) >> FLOW_TILE_SHIFT;
+
+    uint32 tileCount = cache->tileCountX * cache->tileCountY;
+    memset(cache->tileStates, 0, tileCount);
+
+    for (uint32 targetIndex = 0; targetIndex < field->targetCount; ++targetIndex)
+    {
+        int32 tileX = (field->targets[targetIndex].x - field->minX) >> FLOW_TILE_SHIFT;
+        int32 tileY = (field->targets[targetIndex].y - field->minY) >> FLOW_TILE_SHIFT;
+
+        cache->tileStates[tileY * cache->tileCountX + tileX] |= FLOW_TILE_ACTIVE;
+    }
+
+    uint32 passCount    = 0;
+    uint32 runTileCount = 0;
+    bool32 isActive     = true;
+
+    while (isActive)
+    {
+        for (uint32 group = 0; group < 4; ++group)
+        {
+            uint32 phaseTileCount = 0;
+
+            for (int32 tileY = group >> 1; tileY < cache->tileCountY; tileY += 2)
+            {
+                for (int32 tileX = group & 1; tileX < cache->tileCountX; tileX += 2)
+                {
+                    uint32 tile = tileY * cache->tileCountX + tileX;
+                    if (cache->tileStates[tile] & FLOW_TILE_ACTIVE)
+                    {
+                        cache->tileStates[tile]               = 0;
+                        cache->phaseTiles[phaseTileCount++] = tile;
+                    }
+                }
+            }
+
+            if (!phaseTileCount)
+            {
+                continue;
+            }
+
+            uint32 jobCount    = phaseTileCount < FLOW_MAX_JOB_COUNT ? phaseTileCount : FLOW_MAX_JOB_COUNT;
+            uint32 tilesPerJob = (phaseTileCount + jobCount - 1) / jobCount;
+            jobCount           = (phaseTileCount + tilesPerJob - 1) / tilesPerJob;
+
+            for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+            {
+                uint32 firstTile = jobIndex * tilesPerJob;
+
+                FlowTileJob *job = cache->jobs + jobIndex;
+                job->field       = field;
+                job->tiles       = cache->phaseTiles + firstTile;
+                job->tileCount   = Min((int32)tilesPerJob, (int32)(phaseTileCount - firstTile));
+
+                memory->platformAddEntry(memory->highPriorityQueue, DoFlowTileJob, job);
+            }
+
+            memory->platformCompleteAllWork(memory->highPriorityQueue);
+            runTileCount += phaseTileCount;
+
+            for (uint32 phaseIndex = 0; phaseIndex < phaseTileCount; ++phaseIndex)
+            {
+                uint32 tile = cache->phaseTiles[phaseIndex];
+
+                if (cache->tileStates[tile] & FLOW_TILE_CHANGED)
+                {
+                    cache->tileStates[tile] &= ~FLOW_TILE_CHANGED;
+
+                    int32 tileX = tile % cache->tileCountX;
+                    int32 tileY = tile / cache->tileCountX;
+
+                    for (int32 y = Max(tileY - 1, 0); y <= Min(tileY + 1, cache->tileCountY - 1); ++y)
+                    {
+                        for (int32 x = Max(tileX - 1, 0); x <= Min(tileX + 1, cache->tileCountX - 1); ++x)
+                        {
+                            if (x != tileX || y != tileY)
+                            {
+                                cache->tileStates[y * cache->tileCountX + x] |= FLOW_TILE_ACTIVE;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        ++passCount;
+
+        isActive = false;
+        for (uint32 tile = 0; tile < tileCount; ++tile)
+        {
+            if (cache->tileStates[tile] & FLOW_TILE_ACTIVE)
+            {
+                isActive = true;
+                break;
+            }
+        }
+    }
+
+    cache->lastBuildCycles    = __rdtsc() - start;
+    cache->lastBuildPassCount = passCount;
+    cache->lastBuildTileCount = runTileCount;
+}
+
+internal uint32 HashFlowField(PathCostTable *costs, OffsetCoord *targets, uint32 targetCount, int32 minX,
+                              int32 minY, int32 maxX, int32 maxY)
+{
+    int32 bounds[] = {minX, minY, maxX, maxY};
+
+    uint32 result = Crc32(0, costs, sizeof(PathCostTable));
+    result        = Crc32(result, bounds, sizeof(bounds));
+    result        = Crc32(result, targets, targetCount * sizeof(OffsetCoord));
+
+    return result;
+}
+
+// NOTE returns the field leading to the nearest of the targets from anywhere within the region, both corners
+// included, building it unless it is cached already. Returns 0 when the region is bigger than the cache can hold.
+internal FlowField *GetFlowField(FlowFieldCache *cache, World *world, GameMemory *memory, PathCostTable *costs,
+                                 OffsetCoord *targets, uint32 targetCount, OffsetCoord regionMin,
+                                 OffsetCoord regionMax)
+{
+    FlowField *result = 0;
+
+    int32 minX = Max(regionMin.x, 0);
+    int32 minY = Max(regionMin.y, 0);
+    int32 maxX = Min(regionMax.x, world->width - 1);
+    int32 maxY = Min(regionMax.y, world->height - 1);
+
+    OffsetCoord regionTargets[FLOW_MAX_TARGET_COUNT];
+    uint32 regionTargetCount = 0;
+
+    // NOTE targets outside the region are left out, and so is anything past the first FLOW_MAX_TARGET_COUNT.
+    for (uint32 targetIndex = 0; targetIndex < targetCount && regionTargetCount < FLOW_MAX_TARGET_COUNT;
+         ++targetIndex)
+    {
+        OffsetCoord target = targets[targetIndex];
+        if (target.x >= minX && target.y >= minY && target.x <= maxX && target.y <= maxY)
+        {
+            regionTargets[regionTargetCount++] = target;
+        }
+    }
+
+    if (minX <= maxX && minY <= maxY &&
+        (MemoryIndex)(maxX - minX + 1) * (MemoryIndex)(maxY - minY + 1) <= cache->cellCapacity)
+    {
+        uint32 key = HashFlowField(costs, regionTargets, regionTargetCount, minX, minY, maxX, maxY);
+
+        for (uint32 fieldIndex = 0; fieldIndex < FLOW_CACHE_FIELD_COUNT && !result; ++fieldIndex)
+        {
+            FlowField *field = cache->fields + fieldIndex;
+
+            if (field->isValid && field->key == key && field->minX == minX && field->minY == minY &&
+                field->width == maxX - minX + 1 && field->height == maxY - minY + 1 &&
+                field->targetCount == regionTargetCount &&
+                memcmp(&field->costs, costs, sizeof(PathCostTable)) == 0 &&
+                memcmp(field->targets, regionTargets, regionTargetCount * sizeof(OffsetCoord)) == 0)
+            {
+                result = field;
+            }
+        }
+
+        if (!result)
+        {
+            // NOTE replaces an invalidated field if there is one, otherwise the one that went unused the longest.
+            result = cache->fields;
+            for (uint32 fieldIndex = 1; fieldIndex < FLOW_CACHE_FIELD_COUNT; ++fieldIndex)
+            {
+                FlowField *field = cache->fields + fieldIndex;
+
+                if (result->isValid && (!field->isValid || field->lastUsed < result->lastUsed))
+                {
+                    result = field;
+                }
+            }
+
+            result->isValid     = true;
+            result->key         = key;
+            result->costs       = *costs;
+            result->minX        = minX;
+            result->minY        = minY;
+            result->width       = maxX - minX + 1;
+            result->height      = maxY - minY + 1;
+            result->targetCount = regionTargetCount;
+
+            for (uint32 targetIndex = 0; targetIndex < regionTargetCount; ++targetIndex)
+            {
+                result->targets[targetIndex] = regionTargets[targetIndex];
+            }
+
+            if ((MemoryIndex)result->width * result->height < FLOW_JOB_MIN_CELL_COUNT)
+            {
+                BuildFlowField(cache, result, world);
+            }
+            else
+            {
+                BuildFlowFieldWithJobs(cache, result, world, memory);
+            }
+        }
+
+        result->lastUsed = ++cache->useCounter;
+    }
+
+    return result;
+}
@@ -0,0 +1,108 @@
+#if !defined(HEX_MAGIC_FLOW)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_path.h"
+
+// NOTE flow fields answer "which way to the nearest target" for every cell of a region at once, so any number of
+// units heading for the same targets can share one search and take each step with a single lookup. The search runs
+// backwards from the targets, and since every step costs a small integer, it keeps its open set in buckets by
+// distance instead of a heap.
+//
+// Fields are cached by their targets, region and costs, and dropped as soon as the terrain under them is edited. A
+// field pointer is only good until the next edit or the next GetFlowField.
+
+#define FLOW_UNREACHABLE 0xFFFFFFFF
+#define FLOW_NO_DIRECTION 0xFF
+#define FLOW_MAX_TARGET_COUNT 16
+#define FLOW_CACHE_FIELD_COUNT 4
+#define FLOW_MAX_FIELD_CELL_COUNT (2048 * 2048)
+
+// NOTE every step costs at most 255, so the open set never spans more than 256 distances.
+#define FLOW_BUCKET_COUNT 256
+#define FLOW_NOT_QUEUED 0xFFFFFFFF
+#define FLOW_LIST_END 0xFFFFFFFF
+
+// NOTE big fields are built in tiles, one job per group of tiles, going over the tiles until none of them changes.
+#define FLOW_TILE_SHIFT 6
+#define FLOW_TILE_DIM (1 << FLOW_TILE_SHIFT)
+#define FLOW_TILE_CELL_COUNT (FLOW_TILE_DIM * FLOW_TILE_DIM)
+#define FLOW_JOB_MIN_CELL_COUNT (512 * 512)
+#define FLOW_MAX_JOB_COUNT 16
+
+enum FlowTileState
+{
+    FLOW_TILE_ACTIVE  = 1 << 0,
+    FLOW_TILE_CHANGED = 1 << 1,
+};
+
+// NOTE doubly linked lists through the cells, one per bucket, so a cell whose distance drops can be moved to its new
+// bucket right away. Prev is FLOW_NOT_QUEUED for cells that aren't in any list, and every search leaves all cells
+// that way, so nothing needs clearing between searches.
+struct FlowDialQueue
+{
+    uint32 heads[FLOW_BUCKET_COUNT];
+    uint32 *next;
+    uint32 *prev;
+
+    uint32 count;
+    uint32 distance;
+};
+
+struct FlowField
+{
+    bool32 isValid;
+    uint32 key;
+    uint64 lastUsed;
+
+    PathCostTable costs;
+    uint32 targetCount;
+    OffsetCoord targets[FLOW_MAX_TARGET_COUNT];
+
+    int32 minX;
+    int32 minY;
+    int32 width;
+    int32 height;
+
+    // NOTE cost of the cheapest route from each cell to a target, and which way it starts.
+    uint32 *distances;
+    uint8 *directions;
+};
+
+struct FlowFieldCache;
+
+struct FlowTileJob
+{
+    FlowFieldCache *cache;
+    FlowField *field;
+
+    uint32 *tiles;
+    uint32 tileCount;
+
+    FlowDialQueue queue;
+};
+
+struct FlowFieldCache
+{
+    MemoryIndex cellCapacity;
+    FlowField fields[FLOW_CACHE_FIELD_COUNT];
+    uint64 useCounter;
+
+    // NOTE scratch for whichever field is being built.
+    uint8 *cellCosts;
+    FlowDialQueue queue;
+
+    int32 tileCountX;
+    int32 tileCountY;
+    uint8 *tileStates;
+    uint32 *phaseTiles;
+    FlowTileJob jobs[FLOW_MAX_JOB_COUNT];
+
+    // NOTE stats of the last build.
+    uint64 lastBuildCycles;
+    uint32 lastBuildPassCount;
+    uint32 lastBuildTileCount;
+};
+
+#define HEX_MAGIC_FLOW
+#endif
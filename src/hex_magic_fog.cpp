@@ -0,0 +1,338 @@
+#include "hex_magic.h"
+#include "hex_magic_fog.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_platform.h"
+
+inline MemoryIndex GetFogSize(World *world)
+{
+    MemoryIndex chunkCount = (MemoryIndex)((world->width + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT) *
+                             ((world->height + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT);
+
+    MemoryIndex result = sizeof(FogOfWar) + MAX_PLAYER_COUNT * chunkCount * sizeof(FogChunk);
+    return result;
+}
+
+inline bool32 FogFitsInArena(MemoryArena *arena, World *world)
+{
+    bool32 result = arena->used + GetFogSize(world) <= arena->size;
+    return result;
+}
+
+inline void MarkFogDirty(FogOfWar *fog, int32 x, int32 y)
+{
+    // NOTE a hero sees as far as its vision radius, and a cell that blocks the view only shadows cells that are
+    // further from the hero than it is, so nothing further than the radius from the change can look any different.
+    int32 minX = Max(x - HERO_VISION_RADIUS, 0);
+    int32 minY = Max(y - HERO_VISION_RADIUS, 0);
+    int32 maxX = Min(x + HERO_VISION_RADIUS, fog->width - 1);
+    int32 maxY = Min(y + HERO_VISION_RADIUS, fog->height - 1);
+
+    if (fog->isDirty)
+    {
+        fog->dirtyMinX = Min(fog->dirtyMinX, minX);
+        fog->dirtyMinY = Min(fog->dirtyMinY, minY);
+        fog->dirtyMaxX = Max(fog->dirtyMaxX, maxX);
+        fog->dirtyMaxY = Max(fog->dirtyMaxY, maxY);
+    }
+    else
+    {
+        fog->isDirty   = true;
+        fog->dirtyMinX = minX;
+        fog->dirtyMinY = minY;
+        fog->dirtyMaxX = maxX;
+        fog->dirtyMaxY = maxY;
+    }
+}
+
+internal void InitializeFog(FogOfWar *fog, MemoryArena *arena, World *world)
+{
+    fog->width       = world->width;
+    fog->height      = world->height;
+    fog->chunkCountX = (world->width + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+    fog->chunkCountY = (world->height + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+    fog->chunkCount  = (uint32)(fog->chunkCountX * fog->chunkCountY);
+    fog->chunks      = PushArray(arena, (MemoryIndex)MAX_PLAYER_COUNT * fog->chunkCount, FogChunk);
+    fog->isDirty     = false;
+    fog->shadowCount = 0;
+
+    memset(fog->chunks, 0, (MemoryIndex)MAX_PLAYER_COUNT * fog->chunkCount * sizeof(FogChunk));
+    memset(fog->viewerCounts, 0, sizeof(fog->viewerCounts));
+
+    fog->lastUpdateCycles      = 0;
+    fog->lastUpdateCellCount   = 0;
+    fog->lastUpdateViewerCount = 0;
+
+    MarkFogDirty(fog, 0, 0);
+    MarkFogDirty(fog, fog->width - 1, fog->height - 1);
+}
+
+inline FogChunk *GetFogChunk(FogOfWar *fog, uint32 player, int32 x, int32 y)
+{
+    Assert(player < MAX_PLAYER_COUNT && x >= 0 && x < fog->width && y >= 0 && y < fog->height);
+
+    uint32 chunkIndex = (y >> WORLD_CHUNK_SHIFT) * fog->chunkCountX + (x >> WORLD_CHUNK_SHIFT);
+    FogChunk *result  = fog->chunks + (MemoryIndex)player * fog->chunkCount + chunkIndex;
+
+    return result;
+}
+
+// NOTE the row of the chunk the cell is in. Bit (x & WORLD_CHUNK_MASK) is the cell itself.
+inline uint64 GetFogExploredRow(FogOfWar *fog, uint32 player, int32 x, int32 y)
+{
+    uint64 result = GetFogChunk(fog, player, x, y)->explored[y & WORLD_CHUNK_MASK];
+    return result;
+}
+
+inline uint64 GetFogVisibleRow(FogOfWar *fog, uint32 player, int32 x, int32 y)
+{
+    uint64 result = GetFogChunk(fog, player, x, y)->visible[y & WORLD_CHUNK_MASK];
+    return result;
+}
+
+inline bool32 IsFogVisible(FogOfWar *fog, uint32 player, OffsetCoord coord)
+{
+    bool32 result = false;
+
+    if (coord.x >= 0 && coord.x < fog->width && coord.y >= 0 && coord.y < fog->height)
+    {
+        result = (GetFogVisibleRow(fog, player, coord.x, coord.y) >> (coord.x & WORLD_CHUNK_MASK)) & 1;
+    }
+
+    return result;
+}
+
+inline bool32 IsFogExplored(FogOfWar *fog, uint32 player, OffsetCoord coord)
+{
+    bool32 result = false;
+
+    if (coord.x >= 0 && coord.x < fog->width && coord.y >= 0 && coord.y < fog->height)
+    {
+        result = (GetFogExploredRow(fog, player, coord.x, coord.y) >> (coord.x & WORLD_CHUNK_MASK)) & 1;
+    }
+
+    return result;
+}
+
+// NOTE bits minBit to maxBit of a row, both included.
+inline uint64 FogRowMask(int32 minBit, int32 maxBit)
+{
+    uint64 result = (maxBit == WORLD_CHUNK_MASK ? ~0ull : (1ull << (maxBit + 1)) - 1) & ~((1ull << minBit) - 1);
+    return result;
+}
+
+internal void ClearFogVisible(FogOfWar *fog, int32 minX, int32 minY, int32 maxX, int32 maxY)
+{
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        for (int32 y = minY; y <= maxY; ++y)
+        {
+            for (int32 chunkMinX = minX; chunkMinX <= maxX; chunkMinX = (chunkMinX | WORLD_CHUNK_MASK) + 1)
+            {
+                int32 chunkMaxX = Min(chunkMinX | WORLD_CHUNK_MASK, maxX);
+                uint64 mask     = FogRowMask(chunkMinX & WORLD_CHUNK_MASK, chunkMaxX & WORLD_CHUNK_MASK);
+
+                GetFogChunk(fog, player, chunkMinX, y)->visible[y & WORLD_CHUNK_MASK] &= ~mask;
+            }
+        }
+    }
+}
+
+inline bool32 IsFogAngleLess(FogAngle a, FogAngle b)
+{
+    bool32 result = (int64)a.numerator * b.denominator < (int64)b.numerator * a.denominator;
+    return result;
+}
+
+// NOTE a cell is only hidden when its center is strictly inside a shadow. The start of a ring is also its end, so
+// the first cell is hidden when there are shadows on both sides of it.
+internal bool32 IsInFogShadow(FogOfWar *fog, FogAngle angle)
+{
+    bool32 result = false;
+
+    if (angle.numerator == 0)
+    {
+        bool32 isStartShadowed = false;
+        bool32 isEndShadowed   = false;
+
+        for (uint32 shadowIndex = 0; shadowIndex < fog->shadowCount; ++shadowIndex)
+        {
+            FogShadow *shadow = fog->shadows + shadowIndex;
+
+            if (shadow->start.numerator == 0)
+            {
+                isStartShadowed = true;
+            }
+
+            if (shadow->end.numerator == shadow->end.denominator)
+            {
+                isEndShadowed = true;
+            }
+        }
+
+        result = isStartShadowed && isEndShadowed;
+    }
+    else
+    {
+        for (uint32 shadowIndex = 0; shadowIndex < fog->shadowCount; ++shadowIndex)
+        {
+            FogShadow *shadow = fog->shadows + shadowIndex;
+
+            if (IsFogAngleLess(shadow->start, angle) && IsFogAngleLess(angle, shadow->end))
+            {
+                result = true;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+internal void AddFogShadow(FogOfWar *fog, FogAngle start, FogAngle end)
+{
+    for (uint32 shadowIndex = 0; shadowIndex < fog->shadowCount;)
+    {
+        FogShadow *shadow = fog->shadows + shadowIndex;
+
+        if (!IsFogAngleLess(end, shadow->start) && !IsFogAngleLess(shadow->end, start))
+        {
+            if (IsFogAngleLess(shadow->start, start))
+            {
+                start = shadow->start;
+            }
+
+            if (IsFogAngleLess(end, shadow->end))
+            {
+                end = shadow->end;
+            }
+
+            *shadow = fog->shadows[--fog->shadowCount];
+        }
+        else
+        {
+            ++shadowIndex;
+        }
+    }
+
+    // NOTE running out of shadows only lets the hero see more than it should.
+    if (fog->shadowCount < FOG_MAX_SHADOW_COUNT)
+    {
+        FogShadow *shadow = fog->shadows + fog->shadowCount++;
+
+        shadow->start = start;
+        shadow->end   = end;
+    }
+}
+
+inline bool32 IsFogFullyShadowed(FogOfWar *fog)
+{
+    bool32 result = fog->shadowCount == 1 && fog->shadows[0].start.numerator == 0 &&
+                    fog->shadows[0].end.numerator == fog->shadows[0].end.denominator;
+
+    return result;
+}
+
+inline void SeeFogCell(FogOfWar *fog, uint32 player, OffsetCoord coord)
+{
+    FogChunk *chunk = GetFogChunk(fog, player, coord.x, coord.y);
+    uint64 bit      = 1ull << (coord.x & WORLD_CHUNK_MASK);
+
+    chunk->explored[coord.y & WORLD_CHUNK_MASK] |= bit;
+    chunk->visible[coord.y & WORLD_CHUNK_MASK] |= bit;
+}
+
+// NOTE shadow casting over the rings around the hero, from the inside out. Cell i of ring k is centered i / 6k of
+// the way round and spans half a cell either side of that, and every rock shadows its span on all of the rings
+// further out. Only cells within the given region are written.
+internal void CastFogVision(FogOfWar *fog, World *world, uint32 player, HexCoord origin, int32 radius, int32 minX,
+                            int32 minY, int32 maxX, int32 maxY)
+{
+    OffsetCoord originOffset = OffsetFromHex(origin);
+    if (originOffset.x >= minX && originOffset.x <= maxX && originOffset.y >= minY && originOffset.y <= maxY)
+    {
+        SeeFogCell(fog, player, originOffset);
+    }
+
+    fog->shadowCount = 0;
+
+    for (int32 ring = 1; ring <= radius && !IsFogFullyShadowed(fog); ++ring)
+    {
+        int32 denominator = 12 * ring;
+
+        for (HexRingIterator it = BeginHexRing(origin, ring); !it.isDone; NextHexRing(&it))
+        {
+            OffsetCoord coord = it.offset;
+            Cell *cell        = GetCell(world, coord);
+
+            if (cell)
+            {
+                FogAngle center = {2 * it.index, denominator};
+
+                if (!IsInFogShadow(fog, center) && coord.x >= minX && coord.x <= maxX && coord.y >= minY &&
+                    coord.y <= maxY)
+                {
+                    SeeFogCell(fog, player, coord);
+                }
+
+                if (cell->biome == ROCK)
+                {
+                    if (it.index == 0)
+                    {
+                        AddFogShadow(fog, {0, denominator}, {1, denominator});
+                        AddFogShadow(fog, {denominator - 1, denominator}, {denominator, denominator});
+                    }
+                    else
+                    {
+                        AddFogShadow(fog, {2 * it.index - 1, denominator}, {2 * it.index + 1, denominator});
+                    }
+                }
+            }
+        }
+    }
+}
+
+// NOTE recasts the vision of every hero that can see into the dirty region, and only writes within it, so heroes
+// whose vision is cut by the edge of the region still leave what they see outside of it alone.
+internal void UpdateFog(FogOfWar *fog, World *world)
+{
+    if (fog->isDirty)
+    {
+        uint64 start = __rdtsc();
+
+        int32 minX = fog->dirtyMinX;
+        int32 minY = fog->dirtyMinY;
+        int32 maxX = fog->dirtyMaxX;
+        int32 maxY = fog->dirtyMaxY;
+
+        ClearFogVisible(fog, minX, minY, maxX, maxY);
+        memset(fog->viewerCounts, 0, sizeof(fog->viewerCounts));
+
+        uint32 castCount = 0;
+        for (uint32 entityIndex = 1; entityIndex <= world->entityCount; ++entityIndex)
+        {
+            Entity *entity = GetEntity(world, entityIndex);
+            if (entity->type == ENTITY_HERO && entity->player < MAX_PLAYER_COUNT)
+            {
+                Cell *cell = GetEntityCell(world, entityIndex);
+                if (cell)
+                {
+                    OffsetCoord coord = OffsetFromHex(cell->coord);
+                    ++fog->viewerCounts[entity->player];
+
+                    if (coord.x + HERO_VISION_RADIUS >= minX && coord.x - HERO_VISION_RADIUS <= maxX &&
+                        coord.y + HERO_VISION_RADIUS >= minY && coord.y - HERO_VISION_RADIUS <= maxY)
+                    {
+                        CastFogVision(fog, world, entity->player, cell->coord, HERO_VISION_RADIUS, minX, minY, maxX,
+                                      maxY);
+                        ++castCount;
+                    }
+                }
+            }
+        }
+
+        fog->isDirty               = false;
+        fog->lastUpdateCellCount   = (uint32)((maxX - minX + 1) * (maxY - minY + 1));
+        fog->lastUpdateViewerCount = castCount;
+        fog->lastUpdateCycles      = __rdtsc() - start;
+    }
+}
@@ -0,0 +1,71 @@
+#if !defined(HEX_MAGIC_FOG)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+
+// NOTE what each player has explored and what their heroes can see right now, as two bit planes per world chunk. A
+// chunk row is 64 cells, so it is exactly one word, bit x of it being the cell x cells into the chunk, and the
+// renderer can skip a whole row of a chunk nobody has explored with a single test.
+//
+// Changes only mark the cells around them dirty. The next update clears what can be seen in that region and recasts
+// the vision of the heroes that can see into it, without going near the rest of the map. Explored cells stay explored
+// until the world is reloaded. In the game that is the editor painting ground and placing, removing or undoing
+// heroes, nothing walks a hero from cell to cell yet. Whatever does has to mark the cell the hero left and the one it
+// got to, the way the fog bench does.
+
+#define FOG_MAX_SHADOW_COUNT 64
+
+struct FogChunk
+{
+    uint64 explored[WORLD_CHUNK_DIM];
+    uint64 visible[WORLD_CHUNK_DIM];
+};
+
+// NOTE where along a ring a cell is, as a fraction of the way round it. A cell's place on its ring is the same
+// fraction as on every other ring along the same line from the center, so a cell that blocks the view shadows the
+// same fractions on every ring further out.
+struct FogAngle
+{
+    int32 numerator;
+    int32 denominator;
+};
+
+struct FogShadow
+{
+    FogAngle start;
+    FogAngle end;
+};
+
+struct FogOfWar
+{
+    int32 width;
+    int32 height;
+    int32 chunkCountX;
+    int32 chunkCountY;
+    uint32 chunkCount;
+
+    // NOTE all of the chunks of the first player, then all of the chunks of the next one.
+    FogChunk *chunks;
+
+    bool32 isDirty;
+    int32 dirtyMinX;
+    int32 dirtyMinY;
+    int32 dirtyMaxX;
+    int32 dirtyMaxY;
+
+    // NOTE heroes on the map for each player, as of the last update.
+    uint32 viewerCounts[MAX_PLAYER_COUNT];
+
+    // NOTE scratch for the vision being cast. Shadows that touch are merged, so the view is blocked all the way round
+    // once there is a single shadow from 0 to 1.
+    uint32 shadowCount;
+    FogShadow shadows[FOG_MAX_SHADOW_COUNT];
+
+    // NOTE stats of the last update that had anything to do.
+    uint64 lastUpdateCycles;
+    uint32 lastUpdateCellCount;
+    uint32 lastUpdateViewerCount;
+};
+
+#define HEX_MAGIC_FOG
+#endif
@@ -0,0 +1,1191 @@
+#include "hex_magic.h"
+#include "hex_magic_font.h"
+#include "hex_magic_intrinsics.h"
+#include "hex_magic_math.h"
+#include "hex_magic_platform.h"
+
+#define FONT_MAX_EDGE_COUNT 4096
+#define FONT_MAX_COMPOSITE_DEPTH 8
+#define FONT_CURVE_SEGMENT_COUNT 8
+#define FONT_SUBSAMPLE_COUNT 8
+
+// NOTE TrueType is big endian. Reads past the end of the file come back as 0, so a broken file gives broken glyphs
+// rather than a crash.
+inline uint32 TrueTypeRead8(TrueTypeFile *file, uint32 offset)
+{
+    uint32 result = 0;
+
+    if (offset < file->size)
+    {
+        result = file->data[offset];
+    }
+
+    return result;
+}
+
+inline uint32 TrueTypeRead16(TrueTypeFile *file, uint32 offset)
+{
+    uint32 result = 0;
+
+    if (offset + 2 <= file->size)
+    {
+        result = ((uint32)file->data[offset] << 8) | (uint32)file->data[offset + 1];
+    }
+
+    return result;
+}
+
+inline int32 TrueTypeReadInt16(TrueTypeFile *file, uint32 offset)
+{
+    int32 result = (int16)TrueTypeRead16(file, offset);
+    return result;
+}
+
+inline uint32 TrueTypeRead32(TrueTypeFile *file, uint32 offset)
+{
+    uint32 result = 0;
+
+    if (offset + 4 <= file->size)
+    {
+        result = ((uint32)file->data[offset] << 24) | ((uint32)file->data[offset + 1] << 16) |
+                 ((uint32)file->data[offset + 2] << 8) | (uint32)file->data[offset + 3];
+    }
+
+    return result;
+}
+
+// NOTE 2.14 fixed point, the scales of composite glyphs.
+inline real32 TrueTypeReadF2Dot14(TrueTypeFile *file, uint32 offset)
+{
+    real32 result = (real32)TrueTypeReadInt16(file, offset) / 16384.0f;
+    return result;
+}
+
+internal uint32 FindTrueTypeTable(TrueTypeFile *file, char *tag)
+{
+    uint32 result     = 0;
+    uint32 tableCount = TrueTypeRead16(file, 4);
+
+    for (uint32 tableIndex = 0; tableIndex < tableCount; ++tableIndex)
+    {
+        uint32 record = 12 + 16 * tableIndex;
+
+        if (file->data[record] == tag[0] && file->data[record + 1] == tag[1] && file->data[record + 2] == tag[2] &&
+            file->data[record + 3] == tag[3])
+        {
+            uint32 offset = TrueTypeRead32(file, record + 8);
+            uint32 length = TrueTypeRead32(file, record + 12);
+
+            if (offset < file->size && length <= file->size - offset)
+            {
+                result = offset;
+            }
+
+            break;
+        }
+    }
+
+    return result;
+}
+
+internal bool32 InitializeTrueTypeFile(TrueTypeFile *file, void *data, uint32 size)
+{
+    bool32 result = false;
+
+    *file      = {};
+    file->data = (uint8 *)data;
+    file->size = size;
+
+    uint32 version = TrueTypeRead32(file, 0);
+
+    // NOTE 'true' is what old Apple fonts have instead of the version. The table records have to be there before
+    // any of them gets looked at.
+    if (size >= 12 && (version == 0x00010000 || version == 0x74727565) &&
+        12 + 16 * TrueTypeRead16(file, 4) <= size)
+    {
+        uint32 head = FindTrueTypeTable(file, "head");
+        uint32 hhea = FindTrueTypeTable(file, "hhea");
+        uint32 maxp = FindTrueTypeTable(file, "maxp");
+        uint32 cmap = FindTrueTypeTable(file, "cmap");
+
+        file->glyf = FindTrueTypeTable(file, "glyf");
+        file->loca = FindTrueTypeTable(file, "loca");
+        file->hmtx = FindTrueTypeTable(file, "hmtx");
+        file->gpos = FindTrueTypeTable(file, "GPOS");
+        file->kern = FindTrueTypeTable(file, "kern");
+
+        if (head && hhea && maxp && cmap && file->glyf && file->loca && file->hmtx)
+        {
+            file->unitsPerEm       = (int32)TrueTypeRead16(file, head + 18);
+            file->indexToLocFormat = TrueTypeReadInt16(file, head + 50);
+            file->glyphCount       = (int32)TrueTypeRead16(file, maxp + 4);
+            file->ascender         = TrueTypeReadInt16(file, hhea + 4);
+            file->descender        = TrueTypeReadInt16(file, hhea + 6);
+            file->lineGap          = TrueTypeReadInt16(file, hhea + 8);
+            file->hMetricCount     = (int32)TrueTypeRead16(file, hhea + 34);
+
+            // NOTE only the unicode tables of format 4 are read, which covers the basic multilingual plane.
+            uint32 encodingCount = TrueTypeRead16(file, cmap + 2);
+            for (uint32 encodingIndex = 0; encodingIndex < encodingCount; ++encodingIndex)
+            {
+                uint32 record     = cmap + 4 + 8 * encodingIndex;
+                uint32 platformId = TrueTypeRead16(file, record);
+                uint32 encodingId = TrueTypeRead16(file, record + 2);
+                uint32 subtable   = cmap + TrueTypeRead32(file, record + 4);
+
+                if ((platformId == 0 || (platformId == 3 && encodingId == 1)) &&
+                    TrueTypeRead16(file, subtable) == 4)
+                {
+                    file->cmap = subtable;
+                    break;
+                }
+            }
+
+            result = file->cmap && file->unitsPerEm > 0 && file->hMetricCount > 0 &&
+                     file->ascender - file->descender > 0;
+        }
+    }
+
+    return result;
+}
+
+internal uint32 GetTrueTypeGlyphIndex(TrueTypeFile *file, uint32 codepoint)
+{
+    uint32 result = 0;
+
+    uint32 segmentCount  = TrueTypeRead16(file, file->cmap + 6) / 2;
+    uint32 endCodes      = file->cmap + 14;
+    uint32 startCodes    = endCodes + 2 * segmentCount + 2;
+    uint32 idDeltas      = startCodes + 2 * segmentCount;
+    uint32 idRangeOffset = idDeltas + 2 * segmentCount;
+
+    for (uint32 segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex)
+    {
+        if (codepoint <= TrueTypeRead16(file, endCodes + 2 * segmentIndex))
+        {
+            uint32 startCode = TrueTypeRead16(file, startCodes + 2 * segmentIndex);
+
+            if (codepoint >= startCode)
+            {
+                uint32 idDelta     = TrueTypeRead16(file, idDeltas + 2 * segmentIndex);
+                uint32 rangeOffset = TrueTypeRead16(file, idRangeOffset + 2 * segmentIndex);
+
+                if (rangeOffset == 0)
+                {
+                    result = (codepoint + idDelta) & 0xFFFF;
+                }
+                else
+                {
+                    uint32 glyphId = TrueTypeRead16(file, idRangeOffset + 2 * segmentIndex + rangeOffset +
+                                                              2 * (codepoint - startCode));
+                    if (glyphId)
+                    {
+                        result = (glyphId + idDelta) & 0xFFFF;
+                    }
+                }
+            }
+
+            break;
+        }
+    }
+
+    if (result >= (uint32)file->glyphCount)
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+// NOTE 0 for glyphs without an outline, like the space.
+internal uint32 GetTrueTypeGlyphOffset(TrueTypeFile *file, uint32 glyphIndex)
+{
+    uint32 result = 0;
+    uint32 start  = 0;
+    uint32 end    = 0;
+
+    if (glyphIndex < (uint32)file->glyphCount)
+    {
+        if (file->indexToLocFormat == 0)
+        {
+            start = 2 * TrueTypeRead16(file, file->loca + 2 * glyphIndex);
+            end   = 2 * TrueTypeRead16(file, file->loca + 2 * glyphIndex + 2);
+        }
+        else
+        {
+            start = TrueTypeRead32(file, file->loca + 4 * glyphIndex);
+            end   = TrueTypeRead32(file, file->loca + 4 * glyphIndex + 4);
+        }
+    }
+
+    if (end > start && file->glyf + end <= file->size)
+    {
+        result = file->glyf + start;
+    }
+
+    return result;
+}
+
+internal real32 GetTrueTypeAdvance(TrueTypeFile *file, uint32 glyphIndex)
+{
+    uint32 metricIndex = glyphIndex < (uint32)file->hMetricCount ? glyphIndex : file->hMetricCount - 1;
+    real32 result      = (real32)TrueTypeRead16(file, file->hmtx + 4 * metricIndex);
+
+    return result;
+}
+
+// NOTE where the glyph is in a coverage table, which is how GPOS says what glyphs a subtable is about, or -1 when it
+// isn't in there. Both formats are sorted by glyph.
+internal int32 GetTrueTypeCoverageIndex(TrueTypeFile *file, uint32 coverage, uint32 glyphIndex)
+{
+    int32 result  = -1;
+    uint32 format = TrueTypeRead16(file, coverage);
+
+    if (format == 1)
+    {
+        int32 low  = 0;
+        int32 high = (int32)TrueTypeRead16(file, coverage + 2) - 1;
+
+        while (low <= high)
+        {
+            int32 middle = (low + high) / 2;
+            uint32 glyph = TrueTypeRead16(file, coverage + 4 + 2 * middle);
+
+            if (glyph == glyphIndex)
+            {
+                result = middle;
+                break;
+            }
+            else if (glyph < glyphIndex)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle - 1;
+            }
+        }
+    }
+    else if (format == 2)
+    {
+        uint32 rangeCount = TrueTypeRead16(file, coverage + 2);
+
+        for (uint32 rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
+        {
+            uint32 range = coverage + 4 + 6 * rangeIndex;
+
+            if (glyphIndex >= TrueTypeRead16(file, range) && glyphIndex <= TrueTypeRead16(file, range + 2))
+            {
+                result = (int32)(TrueTypeRead16(file, range + 4) + glyphIndex - TrueTypeRead16(file, range));
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE glyphs a class definition leaves out are in class 0.
+internal uint32 GetTrueTypeGlyphClass(TrueTypeFile *file, uint32 classDefinition, uint32 glyphIndex)
+{
+    uint32 result = 0;
+    uint32 format = TrueTypeRead16(file, classDefinition);
+
+    if (format == 1)
+    {
+        uint32 startGlyph = TrueTypeRead16(file, classDefinition + 2);
+        uint32 glyphCount = TrueTypeRead16(file, classDefinition + 4);
+
+        if (glyphIndex >= startGlyph && glyphIndex - startGlyph < glyphCount)
+        {
+            result = TrueTypeRead16(file, classDefinition + 6 + 2 * (glyphIndex - startGlyph));
+        }
+    }
+    else if (format == 2)
+    {
+        uint32 rangeCount = TrueTypeRead16(file, classDefinition + 2);
+
+        for (uint32 rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
+        {
+            uint32 range = classDefinition + 4 + 6 * rangeIndex;
+
+            if (glyphIndex >= TrueTypeRead16(file, range) && glyphIndex <= TrueTypeRead16(file, range + 2))
+            {
+                result = TrueTypeRead16(file, range + 4);
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE every value a GPOS value record has is two bytes, the format says which ones are there. The x advance is the
+// third one, after the placement.
+inline uint32 GetTrueTypeValueRecordSize(uint32 valueFormat)
+{
+    uint32 result = 2 * __builtin_popcount(valueFormat & 0xFF);
+    return result;
+}
+
+inline int32 TrueTypeReadXAdvance(TrueTypeFile *file, uint32 valueRecord, uint32 valueFormat)
+{
+    int32 result = 0;
+
+    if (valueFormat & 0x0004)
+    {
+        result = TrueTypeReadInt16(file, valueRecord + 2 * __builtin_popcount(valueFormat & 0x0003));
+    }
+
+    return result;
+}
+
+// NOTE the first lookup that moves a pair is the one that counts, the ones after it are for the same pair in other
+// scripts or fallbacks.
+inline void SetFontKerning(int16 *kerning, uint32 first, uint32 second, int32 value)
+{
+    int16 *pair = kerning + first * FONT_GLYPH_COUNT + second;
+
+    if (*pair == 0)
+    {
+        *pair = (int16)value;
+    }
+}
+
+// NOTE pair adjustment subtables either list the glyphs that follow every covered glyph, sorted by glyph, or split
+// both sides into classes and keep a grid of them.
+internal void ReadTrueTypePairAdjustment(TrueTypeFile *file, uint32 subtable, uint32 *glyphIndices, int16 *kerning)
+{
+    uint32 format       = TrueTypeRead16(file, subtable);
+    uint32 coverage     = subtable + TrueTypeRead16(file, subtable + 2);
+    uint32 valueFormat1 = TrueTypeRead16(file, subtable + 4);
+    uint32 valueFormat2 = TrueTypeRead16(file, subtable + 6);
+    uint32 recordSize   = GetTrueTypeValueRecordSize(valueFormat1) + GetTrueTypeValueRecordSize(valueFormat2);
+
+    // NOTE adjustments that leave the advance of the first glyph alone aren't kerning.
+    if (!(valueFormat1 & 0x0004))
+    {
+        return;
+    }
+
+    for (uint32 first = 0; first < FONT_GLYPH_COUNT; ++first)
+    {
+        int32 coverageIndex = GetTrueTypeCoverageIndex(file, coverage, glyphIndices[first]);
+
+        if (coverageIndex < 0)
+        {
+            continue;
+        }
+
+        if (format == 1 && (uint32)coverageIndex < TrueTypeRead16(file, subtable + 8))
+        {
+            uint32 pairSet   = subtable + TrueTypeRead16(file, subtable + 10 + 2 * coverageIndex);
+            uint32 pairCount = TrueTypeRead16(file, pairSet);
+            uint32 pairSize  = 2 + recordSize;
+
+            for (uint32 second = 0; second < FONT_GLYPH_COUNT; ++second)
+            {
+                int32 low  = 0;
+                int32 high = (int32)pairCount - 1;
+
+                while (low <= high)
+                {
+                    int32 middle = (low + high) / 2;
+                    uint32 pair  = pairSet + 2 + pairSize * middle;
+                    uint32 glyph = TrueTypeRead16(file, pair);
+
+                    if (glyph == glyphIndices[second])
+                    {
+                        SetFontKerning(kerning, first, second, TrueTypeReadXAdvance(file, pair + 2, valueFormat1));
+                        break;
+                    }
+                    else if (glyph < glyphIndices[second])
+                    {
+                        low = middle + 1;
+                    }
+                    else
+                    {
+                        high = middle - 1;
+                    }
+                }
+            }
+        }
+        else if (format == 2)
+        {
+            uint32 classDefinition1 = subtable + TrueTypeRead16(file, subtable + 8);
+            uint32 classDefinition2 = subtable + TrueTypeRead16(file, subtable + 10);
+            uint32 class1Count      = TrueTypeRead16(file, subtable + 12);
+            uint32 class2Count      = TrueTypeRead16(file, subtable + 14);
+            uint32 class1           = GetTrueTypeGlyphClass(file, classDefinition1, glyphIndices[first]);
+
+            if (class1 < class1Count)
+            {
+                for (uint32 second = 0; second < FONT_GLYPH_COUNT; ++second)
+                {
+                    uint32 class2 = GetTrueTypeGlyphClass(file, classDefinition2, glyphIndices[second]);
+
+                    if (class2 < class2Count)
+                    {
+                        uint32 record = subtable + 16 + (class1 * class2Count + class2) * recordSize;
+                        SetFontKerning(kerning, first, second, TrueTypeReadXAdvance(file, record, valueFormat1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// NOTE kerning[first * FONT_GLYPH_COUNT + second] in font units, for the glyphs of the atlas. Fonts made these days
+// only kern through the lookups of the 'kern' feature in GPOS, the old kern table is read when there is no GPOS.
+internal void ReadTrueTypeKerning(TrueTypeFile *file, uint32 *glyphIndices, int16 *kerning)
+{
+    if (file->gpos)
+    {
+        uint32 featureList  = file->gpos + TrueTypeRead16(file, file->gpos + 6);
+        uint32 lookupList   = file->gpos + TrueTypeRead16(file, file->gpos + 8);
+        uint32 featureCount = TrueTypeRead16(file, featureList);
+        uint32 lookupCount  = TrueTypeRead16(file, lookupList);
+
+        for (uint32 featureIndex = 0; featureIndex < featureCount; ++featureIndex)
+        {
+            uint32 record = featureList + 2 + 6 * featureIndex;
+
+            if (TrueTypeRead32(file, record) != 0x6B65726E)
+            {
+                continue;
+            }
+
+            uint32 feature          = featureList + TrueTypeRead16(file, record + 4);
+            uint32 lookupIndexCount = TrueTypeRead16(file, feature + 2);
+
+            for (uint32 indexIndex = 0; indexIndex < lookupIndexCount; ++indexIndex)
+            {
+                uint32 lookupIndex = TrueTypeRead16(file, feature + 4 + 2 * indexIndex);
+
+                if (lookupIndex >= lookupCount)
+                {
+                    continue;
+                }
+
+                uint32 lookup        = lookupList + TrueTypeRead16(file, lookupList + 2 + 2 * lookupIndex);
+                uint32 lookupType    = TrueTypeRead16(file, lookup);
+                uint32 subtableCount = TrueTypeRead16(file, lookup + 4);
+
+                for (uint32 subtableIndex = 0; subtableIndex < subtableCount; ++subtableIndex)
+                {
+                    uint32 subtable = lookup + TrueTypeRead16(file, lookup + 6 + 2 * subtableIndex);
+
+                    // NOTE extension lookups are there for subtables too far away for a 16 bit offset.
+                    if (lookupType == 9 && TrueTypeRead16(file, subtable + 2) == 2)
+                    {
+                        ReadTrueTypePairAdjustment(file, subtable + TrueTypeRead32(file, subtable + 4), glyphIndices,
+                                                   kerning);
+                    }
+                    else if (lookupType == 2)
+                    {
+                        ReadTrueTypePairAdjustment(file, subtable, glyphIndices, kerning);
+                    }
+                }
+            }
+        }
+    }
+    else if (file->kern && TrueTypeRead16(file, file->kern) == 0)
+    {
+        uint32 tableCount = TrueTypeRead16(file, file->kern + 2);
+        uint32 table      = file->kern + 4;
+
+        for (uint32 tableIndex = 0; tableIndex < tableCount; ++tableIndex)
+        {
+            uint32 length   = TrueTypeRead16(file, table + 2);
+            uint32 coverage = TrueTypeRead16(file, table + 4);
+
+            // NOTE horizontal pairs of format 0, sorted by the two glyphs together.
+            if ((coverage & 0xFF07) == 0x0001)
+            {
+                uint32 pairCount = TrueTypeRead16(file, table + 6);
+
+                for (uint32 first = 0; first < FONT_GLYPH_COUNT; ++first)
+                {
+                    for (uint32 second = 0; second < FONT_GLYPH_COUNT; ++second)
+                    {
+                        uint32 key = (glyphIndices[first] << 16) | glyphIndices[second];
+                        int32 low  = 0;
+                        int32 high = (int32)pairCount - 1;
+
+                        while (low <= high)
+                        {
+                            int32 middle   = (low + high) / 2;
+                            uint32 pair    = table + 14 + 6 * middle;
+                            uint32 pairKey = TrueTypeRead32(file, pair);
+
+                            if (pairKey == key)
+                            {
+                                SetFontKerning(kerning, first, second, TrueTypeReadInt16(file, pair + 4));
+                                break;
+                            }
+                            else if (pairKey < key)
+                            {
+                                low = middle + 1;
+                            }
+                            else
+                            {
+                                high = middle - 1;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (length == 0)
+            {
+                break;
+            }
+
+            table += length;
+        }
+    }
+}
+
+// NOTE x' = m[0] x + m[2] y + m[4] and y' = m[1] x + m[3] y + m[5], from font units to pixels of the glyph.
+struct FontTransform
+{
+    real32 m[6];
+};
+
+inline V2 ApplyFontTransform(FontTransform *transform, real32 x, real32 y)
+{
+    real32 *m = transform->m;
+    V2 result = {m[0] * x + m[2] * y + m[4], m[1] * x + m[3] * y + m[5]};
+
+    return result;
+}
+
+struct FontOutline
+{
+    FontEdge *edges;
+    uint32 edgeCount;
+    uint32 maxEdgeCount;
+};
+
+inline void AddFontEdge(FontOutline *outline, V2 a, V2 b)
+{
+    // NOTE horizontal edges never cross a scanline.
+    if (a.y != b.y && outline->edgeCount < outline->maxEdgeCount)
+    {
+        FontEdge *edge = outline->edges + outline->edgeCount++;
+
+        edge->x0 = a.x;
+        edge->y0 = a.y;
+        edge->x1 = b.x;
+        edge->y1 = b.y;
+    }
+}
+
+internal void AddFontCurve(FontOutline *outline, V2 a, V2 control, V2 b)
+{
+    V2 previous = a;
+
+    for (uint32 segmentIndex = 1; segmentIndex <= FONT_CURVE_SEGMENT_COUNT; ++segmentIndex)
+    {
+        real32 t = (real32)segmentIndex / (real32)FONT_CURVE_SEGMENT_COUNT;
+        V2 point = Square(1.0f - t) * a + 2.0f * (1.0f - t) * t * control + Square(t) * b;
+
+        AddFontEdge(outline, previous, point);
+        previous = point;
+    }
+}
+
+// NOTE points are off the curve when they are the control point of a quadratic curve, two of them in a row have an
+// implied point on the curve half way between them.
+internal void AddFontContour(FontOutline *outline, V2 *points, uint8 *onCurve, uint32 pointCount)
+{
+    if (pointCount >= 2)
+    {
+        V2 start          = points[0];
+        uint32 firstIndex = 1;
+        uint32 endIndex   = pointCount;
+
+        if (!onCurve[0])
+        {
+            if (onCurve[pointCount - 1])
+            {
+                start      = points[pointCount - 1];
+                firstIndex = 0;
+                endIndex   = pointCount - 1;
+            }
+            else
+            {
+                start      = 0.5f * (points[0] + points[pointCount - 1]);
+                firstIndex = 0;
+            }
+        }
+
+        V2 current         = start;
+        V2 control         = {};
+        bool32 hasControl  = false;
+
+        for (uint32 pointIndex = firstIndex; pointIndex < endIndex; ++pointIndex)
+        {
+            V2 point = points[pointIndex];
+
+            if (onCurve[pointIndex])
+            {
+                if (hasControl)
+                {
+                    AddFontCurve(outline, current, control, point);
+                }
+                else
+                {
+                    AddFontEdge(outline, current, point);
+                }
+
+                current    = point;
+                hasControl = false;
+            }
+            else
+            {
+                if (hasControl)
+                {
+                    V2 middle = 0.5f * (control + point);
+                    AddFontCurve(outline, current, control, middle);
+                    current = middle;
+                }
+
+                control    = point;
+                hasControl = true;
+            }
+        }
+
+        if (hasControl)
+        {
+            AddFontCurve(outline, current, control, start);
+        }
+        else
+        {
+            AddFontEdge(outline, current, start);
+        }
+    }
+}
+
+internal void AddGlyphOutline(FontOutline *outline, TrueTypeFile *file, MemoryArena *arena, uint32 glyphIndex,
+                              FontTransform *transform, uint32 depth)
+{
+    uint32 glyph = GetTrueTypeGlyphOffset(file, glyphIndex);
+
+    if (glyph && depth < FONT_MAX_COMPOSITE_DEPTH)
+    {
+        int32 contourCount = TrueTypeReadInt16(file, glyph);
+
+        if (contourCount > 0)
+        {
+            uint32 endPoints         = glyph + 10;
+            uint32 pointCount        = TrueTypeRead16(file, endPoints + 2 * (contourCount - 1)) + 1;
+            uint32 instructionLength = TrueTypeRead16(file, endPoints + 2 * contourCount);
+            uint32 at                = endPoints + 2 * contourCount + 2 + instructionLength;
+
+            TemporaryMemory pointMemory = StartTemporaryMemory(arena);
+
+            uint8 *flags   = PushArray(arena, pointCount, uint8);
+            V2 *points     = PushArray(arena, pointCount, V2);
+            uint8 *onCurve = PushArray(arena, pointCount, uint8);
+
+            for (uint32 pointIndex = 0; pointIndex < pointCount;)
+            {
+                uint8 flag          = (uint8)TrueTypeRead8(file, at++);
+                uint32 repeatCount  = 1;
+
+                if (flag & 0x08)
+                {
+                    repeatCount += TrueTypeRead8(file, at++);
+                }
+
+                while (repeatCount-- && pointIndex < pointCount)
+                {
+                    flags[pointIndex++] = flag;
+                }
+            }
+
+            // NOTE coordinates are deltas from the point before, a short one is a byte whose sign is in the flags,
+            // and a long one that is left out is the same as the point before.
+            int32 x = 0;
+            for (uint32 pointIndex = 0; pointIndex < pointCount; ++pointIndex)
+            {
+                uint8 flag = flags[pointIndex];
+
+                if (flag & 0x02)
+                {
+                    int32 delta = (int32)TrueTypeRead8(file, at++);
+                    x += (flag & 0x10) ? delta : -delta;
+                }
+                else if (!(flag & 0x10))
+                {
+                    x += TrueTypeReadInt16(file, at);
+                    at += 2;
+                }
+
+                points[pointIndex].x = (real32)x;
+                onCurve[pointIndex]  = flag & 0x01;
+            }
+
+            int32 y = 0;
+            for (uint32 pointIndex = 0; pointIndex < pointCount; ++pointIndex)
+            {
+                uint8 flag = flags[pointIndex];
+
+                if (flag & 0x04)
+                {
+                    int32 delta = (int32)TrueTypeRead8(file, at++);
+                    y += (flag & 0x20) ? delta : -delta;
+                }
+                else if (!(flag & 0x20))
+                {
+                    y += TrueTypeReadInt16(file, at);
+                    at += 2;
+                }
+
+                points[pointIndex] = ApplyFontTransform(transform, points[pointIndex].x, (real32)y);
+            }
+
+            uint32 firstPoint = 0;
+            for (int32 contourIndex = 0; contourIndex < contourCount; ++contourIndex)
+            {
+                uint32 lastPoint = TrueTypeRead16(file, endPoints + 2 * contourIndex);
+
+                if (lastPoint >= firstPoint && lastPoint < pointCount)
+                {
+                    AddFontContour(outline, points + firstPoint, onCurve + firstPoint, lastPoint - firstPoint + 1);
+                    firstPoint = lastPoint + 1;
+                }
+            }
+
+            EndTemporaryMemory(pointMemory);
+        }
+        else if (contourCount < 0)
+        {
+            // NOTE composite glyphs are other glyphs moved, and sometimes scaled, into place. Components placed by
+            // matching up points are rare enough in text fonts to just be left where they are.
+            uint32 at   = glyph + 10;
+            uint32 flag = 0;
+
+            do
+            {
+                flag                    = TrueTypeRead16(file, at);
+                uint32 componentIndex   = TrueTypeRead16(file, at + 2);
+                at += 4;
+
+                real32 dx = 0.0f;
+                real32 dy = 0.0f;
+
+                if (flag & 0x0001)
+                {
+                    dx = (real32)TrueTypeReadInt16(file, at);
+                    dy = (real32)TrueTypeReadInt16(file, at + 2);
+                    at += 4;
+                }
+                else
+                {
+                    dx = (real32)(int8)TrueTypeRead8(file, at);
+                    dy = (real32)(int8)TrueTypeRead8(file, at + 1);
+                    at += 2;
+                }
+
+                if (!(flag & 0x0002))
+                {
+                    dx = 0.0f;
+                    dy = 0.0f;
+                }
+
+                real32 a = 1.0f;
+                real32 b = 0.0f;
+                real32 c = 0.0f;
+                real32 d = 1.0f;
+
+                if (flag & 0x0008)
+                {
+                    a = d = TrueTypeReadF2Dot14(file, at);
+                    at += 2;
+                }
+                else if (flag & 0x0040)
+                {
+                    a = TrueTypeReadF2Dot14(file, at);
+                    d = TrueTypeReadF2Dot14(file, at + 2);
+                    at += 4;
+                }
+                else if (flag & 0x0080)
+                {
+                    a = TrueTypeReadF2Dot14(file, at);
+                    b = TrueTypeReadF2Dot14(file, at + 2);
+                    c = TrueTypeReadF2Dot14(file, at + 4);
+                    d = TrueTypeReadF2Dot14(file, at + 6);
+                    at += 8;
+                }
+
+                real32 *m                = transform->m;
+                FontTransform component  = {};
+                component.m[0]           = m[0] * a + m[2] * b;
+                component.m[1]           = m[1] * a + m[3] * b;
+                component.m[2]           = m[0] * c + m[2] * d;
+                component.m[3]           = m[1] * c + m[3] * d;
+                component.m[4]           = m[0] * dx + m[2] * dy + m[4];
+                component.m[5]           = m[1] * dx + m[3] * dy + m[5];
+
+                AddGlyphOutline(outline, file, arena, componentIndex, &component, depth + 1);
+            } while (flag & 0x0020);
+        }
+    }
+}
+
+inline void AddCoverageSpan(real32 *coverage, int32 width, real32 minX, real32 maxX, real32 weight)
+{
+    minX = Clamp(0.0f, minX, (real32)width);
+    maxX = Clamp(0.0f, maxX, (real32)width);
+
+    if (maxX > minX)
+    {
+        int32 minPixel = FloorReal32ToInt32(minX);
+        int32 maxPixel = FloorReal32ToInt32(maxX);
+
+        if (minPixel == maxPixel)
+        {
+            coverage[minPixel] += weight * (maxX - minX);
+        }
+        else
+        {
+            coverage[minPixel] += weight * ((real32)(minPixel + 1) - minX);
+
+            for (int32 x = minPixel + 1; x < maxPixel; ++x)
+            {
+                coverage[x] += weight;
+            }
+
+            if (maxPixel < width)
+            {
+                coverage[maxPixel] += weight * (maxX - (real32)maxPixel);
+            }
+        }
+    }
+}
+
+// NOTE nonzero winding over a few scanlines per pixel, with the exact coverage along each of them, into the glyph's
+// place in the atlas.
+internal void RasterizeFontOutline(FontOutline *outline, MemoryArena *arena, Bitmap *atlas, FontGlyph *glyph)
+{
+    TemporaryMemory rasterMemory = StartTemporaryMemory(arena);
+
+    real32 *coverage   = PushArray(arena, (glyph->width + 1), real32);
+    real32 *crossingXs = PushArray(arena, (outline->edgeCount + 1), real32);
+    int32 *windings    = PushArray(arena, (outline->edgeCount + 1), int32);
+    real32 weight      = 1.0f / (real32)FONT_SUBSAMPLE_COUNT;
+
+    uint8 *row = (uint8 *)atlas->memory + glyph->y * atlas->pitch + glyph->x * BITMAP_BYTES_PER_PIXEL;
+    for (int32 y = 0; y < glyph->height; ++y)
+    {
+        for (int32 x = 0; x <= glyph->width; ++x)
+        {
+            coverage[x] = 0.0f;
+        }
+
+        for (uint32 sampleIndex = 0; sampleIndex < FONT_SUBSAMPLE_COUNT; ++sampleIndex)
+        {
+            real32 sampleY        = (real32)y + ((real32)sampleIndex + 0.5f) * weight;
+            uint32 crossingCount  = 0;
+
+            for (uint32 edgeIndex = 0; edgeIndex < outline->edgeCount; ++edgeIndex)
+            {
+                FontEdge *edge = outline->edges + edgeIndex;
+                real32 minY    = Min(edge->y0, edge->y1);
+                real32 maxY    = Max(edge->y0, edge->y1);
+
+                if (sampleY >= minY && sampleY < maxY)
+                {
+                    real32 t      = (sampleY - edge->y0) / (edge->y1 - edge->y0);
+                    real32 crossX = edge->x0 + t * (edge->x1 - edge->x0);
+                    int32 winding = edge->y1 > edge->y0 ? 1 : -1;
+
+                    // NOTE there are only ever a handful of crossings on a scanline.
+                    uint32 insertIndex = crossingCount++;
+                    while (insertIndex > 0 && crossingXs[insertIndex - 1] > crossX)
+                    {
+                        crossingXs[insertIndex] = crossingXs[insertIndex - 1];
+                        windings[insertIndex]   = windings[insertIndex - 1];
+                        --insertIndex;
+                    }
+
+                    crossingXs[insertIndex] = crossX;
+                    windings[insertIndex]   = winding;
+                }
+            }
+
+            int32 winding = 0;
+            real32 spanX  = 0.0f;
+
+            for (uint32 crossingIndex = 0; crossingIndex < crossingCount; ++crossingIndex)
+            {
+                int32 nextWinding = winding + windings[crossingIndex];
+
+                if (winding == 0 && nextWinding != 0)
+                {
+                    spanX = crossingXs[crossingIndex];
+                }
+                else if (winding != 0 && nextWinding == 0)
+                {
+                    AddCoverageSpan(coverage, glyph->width, spanX, crossingXs[crossingIndex], weight);
+                }
+
+                winding = nextWinding;
+            }
+        }
+
+        uint32 *texel = (uint32 *)row;
+        for (int32 x = 0; x < glyph->width; ++x)
+        {
+            uint32 alpha = RoundReal32ToUint32(255.0f * Clamp01(coverage[x]));
+            *texel++     = (alpha << 24) | (alpha << 16) | (alpha << 8) | alpha;
+        }
+
+        row += atlas->pitch;
+    }
+
+    EndTemporaryMemory(rasterMemory);
+}
+
+global real32 globalFontPixelHeights[FONT_SIZE_COUNT] = {15.0f, 20.0f, 28.0f};
+
+// NOTE glyphs take up whole groups of four texels in the atlas, the ones past the glyph are left empty, so drawing
+// them never has a few pixels at the end of a row that need blending one at a time.
+inline int32 GetFontGlyphCellWidth(FontGlyph *glyph)
+{
+    int32 result = (glyph->width + 3) & ~3;
+    return result;
+}
+
+struct FontShelf
+{
+    int32 x;
+    int32 y;
+    int32 height;
+};
+
+// NOTE works out the metrics of the font at its size and where every glyph goes in the atlas. Glyphs go in rows as
+// tall as their tallest glyph, a pixel apart so sampling one never picks up its neighbour.
+internal void LayoutFont(Font *font, TrueTypeFile *file, uint32 *glyphIndices, real32 pixelHeight, FontShelf *shelf)
+{
+    real32 scale = pixelHeight / (real32)(file->ascender - file->descender);
+
+    font->isValid     = true;
+    font->pixelHeight = pixelHeight;
+    font->ascent      = scale * (real32)file->ascender;
+    font->descent     = -scale * (real32)file->descender;
+    font->lineAdvance = scale * (real32)(file->ascender - file->descender + file->lineGap);
+    font->unitScale   = scale;
+
+    for (uint32 glyphIndex = 0; glyphIndex < FONT_GLYPH_COUNT; ++glyphIndex)
+    {
+        FontGlyph *glyph = font->glyphs + glyphIndex;
+        uint32 offset    = GetTrueTypeGlyphOffset(file, glyphIndices[glyphIndex]);
+
+        glyph->advance = scale * GetTrueTypeAdvance(file, glyphIndices[glyphIndex]);
+
+        if (offset)
+        {
+            int32 minX = FloorReal32ToInt32(scale * (real32)TrueTypeReadInt16(file, offset + 2));
+            int32 minY = FloorReal32ToInt32(-scale * (real32)TrueTypeReadInt16(file, offset + 8));
+            int32 maxX = CeilReal32ToInt32(scale * (real32)TrueTypeReadInt16(file, offset + 6));
+            int32 maxY = CeilReal32ToInt32(-scale * (real32)TrueTypeReadInt16(file, offset + 4));
+
+            glyph->width   = maxX - minX;
+            glyph->height  = maxY - minY;
+            glyph->offsetX = minX;
+            glyph->offsetY = minY;
+
+            if (glyph->width <= 0 || glyph->height <= 0 || glyph->width > FONT_ATLAS_WIDTH - 5)
+            {
+                glyph->width  = 0;
+                glyph->height = 0;
+            }
+        }
+
+        int32 cellWidth = GetFontGlyphCellWidth(glyph);
+
+        if (shelf->x + cellWidth + 1 > FONT_ATLAS_WIDTH)
+        {
+            shelf->x = 1;
+            shelf->y += shelf->height + 1;
+            shelf->height = 0;
+        }
+
+        glyph->x = shelf->x;
+        glyph->y = shelf->y;
+
+        shelf->x += cellWidth + 1;
+        if (shelf->height < glyph->height)
+        {
+            shelf->height = glyph->height;
+        }
+    }
+}
+
+// NOTE every size of every style the file of which could be read goes into the one atlas, which comes out of the
+// arena. A style whose file is missing or broken gets fonts that draw nothing.
+internal void BakeFontAtlas(FontAtlas *fontAtlas, MemoryArena *arena, void **fileContents, uint32 *fileSizes)
+{
+    *fontAtlas = {};
+
+    TrueTypeFile files[FONT_STYLE_COUNT]                    = {};
+    uint32 glyphIndices[FONT_STYLE_COUNT][FONT_GLYPH_COUNT] = {};
+
+    FontShelf shelf = {1, 1, 0};
+
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        TrueTypeFile *file = files + style;
+        int16 *kerning     = &fontAtlas->kerning[style][0][0];
+
+        for (uint32 size = 0; size < FONT_SIZE_COUNT; ++size)
+        {
+            fontAtlas->fonts[style][size].atlas   = &fontAtlas->bitmap;
+            fontAtlas->fonts[style][size].kerning = kerning;
+        }
+
+        if (fileContents[style] && InitializeTrueTypeFile(file, fileContents[style], fileSizes[style]))
+        {
+            for (uint32 codepoint = FONT_FIRST_CODEPOINT; codepoint <= FONT_LAST_CODEPOINT; ++codepoint)
+            {
+                glyphIndices[style][codepoint - FONT_FIRST_CODEPOINT] = GetTrueTypeGlyphIndex(file, codepoint);
+            }
+
+            ReadTrueTypeKerning(file, glyphIndices[style], kerning);
+
+            for (uint32 size = 0; size < FONT_SIZE_COUNT; ++size)
+            {
+                LayoutFont(&fontAtlas->fonts[style][size], file, glyphIndices[style], globalFontPixelHeights[size],
+                           &shelf);
+            }
+        }
+    }
+
+    Bitmap *atlas   = &fontAtlas->bitmap;
+    atlas->width    = FONT_ATLAS_WIDTH;
+    atlas->height   = shelf.y + shelf.height + 1;
+    atlas->pitch    = atlas->width * BITMAP_BYTES_PER_PIXEL;
+    atlas->memory   = PushSize(arena, atlas->pitch * atlas->height);
+    atlas->mipCount = 1;
+
+    memset(atlas->memory, 0, atlas->pitch * atlas->height);
+
+    TemporaryMemory outlineMemory = StartTemporaryMemory(arena);
+
+    FontOutline outline  = {};
+    outline.maxEdgeCount = FONT_MAX_EDGE_COUNT;
+    outline.edges        = PushArray(arena, outline.maxEdgeCount, FontEdge);
+
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        for (uint32 size = 0; size < FONT_SIZE_COUNT; ++size)
+        {
+            Font *font = &fontAtlas->fonts[style][size];
+
+            for (uint32 glyphIndex = 0; font->isValid && glyphIndex < FONT_GLYPH_COUNT; ++glyphIndex)
+            {
+                FontGlyph *glyph = font->glyphs + glyphIndex;
+
+                if (glyph->width > 0)
+                {
+                    // NOTE font units have y going up, the atlas has it going down.
+                    FontTransform transform = {};
+                    transform.m[0]          = font->unitScale;
+                    transform.m[3]          = -font->unitScale;
+                    transform.m[4]          = -(real32)glyph->offsetX;
+                    transform.m[5]          = -(real32)glyph->offsetY;
+
+                    outline.edgeCount = 0;
+                    AddGlyphOutline(&outline, files + style, arena, glyphIndices[style][glyphIndex], &transform, 0);
+                    RasterizeFontOutline(&outline, arena, atlas, glyph);
+                }
+            }
+        }
+    }
+
+    EndTemporaryMemory(outlineMemory);
+}
+
+internal void DEBUGLoadFontAtlas(ThreadContext *thread, GameMemory *memory, FontAtlas *fontAtlas, MemoryArena *arena)
+{
+    char *fileNames[FONT_STYLE_COUNT] = {
+        "assets/fonts/montserrat/Montserrat-Regular.ttf",
+        "assets/fonts/montserrat/Montserrat-Bold.ttf",
+    };
+
+    void *fileContents[FONT_STYLE_COUNT] = {};
+    uint32 fileSizes[FONT_STYLE_COUNT]   = {};
+
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        DebugReadFileResult file = memory->debugPlatformReadEntireFile(thread, fileNames[style]);
+
+        fileContents[style] = file.contents;
+        fileSizes[style]    = file.contentsSize;
+    }
+
+    BakeFontAtlas(fontAtlas, arena, fileContents, fileSizes);
+
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        if (fileContents[style])
+        {
+            memory->debugPlatformFreeFileMemory(thread, fileContents[style]);
+        }
+    }
+}
+
+inline Font *GetFont(FontAtlas *fontAtlas, FontStyle style, FontSize size)
+{
+    Font *result = &fontAtlas->fonts[style][size];
+    return result;
+}
+
+inline FontGlyph *GetFontGlyph(Font *font, char character)
+{
+    FontGlyph *result = 0;
+    uint32 codepoint  = (uint8)character;
+
+    if (font->isValid && codepoint >= FONT_FIRST_CODEPOINT && codepoint <= FONT_LAST_CODEPOINT)
+    {
+        result = font->glyphs + (codepoint - FONT_FIRST_CODEPOINT);
+    }
+
+    return result;
+}
+
+// NOTE what to move the pen by from the end of the first glyph's advance to where the second one starts.
+inline real32 GetFontKerning(Font *font, FontGlyph *first, FontGlyph *second)
+{
+    real32 result = 0.0f;
+
+    if (first && second)
+    {
+        uint32 pair = (uint32)(first - font->glyphs) * FONT_GLYPH_COUNT + (uint32)(second - font->glyphs);
+        result      = font->unitScale * (real32)font->kerning[pair];
+    }
+
+    return result;
+}
+
+internal real32 GetTextWidth(Font *font, char *text)
+{
+    real32 result       = 0.0f;
+    FontGlyph *previous = 0;
+
+    for (char *at = text; *at; ++at)
+    {
+        FontGlyph *glyph = GetFontGlyph(font, *at);
+        if (glyph)
+        {
+            result += GetFontKerning(font, previous, glyph) + glyph->advance;
+        }
+
+        previous = glyph;
+    }
+
+    return result;
+}
@@ -0,0 +1,106 @@
+#if !defined(HEX_MAGIC_FONT)
+
+#include "hex_magic_platform.h"
+
+// NOTE glyphs are rasterized from the TrueType outlines once, at every size the game uses, into one atlas of
+// premultiplied white texels, so drawing text is only ever copying parts of it to the screen tinted by the colour of
+// the text.
+#define FONT_FIRST_CODEPOINT 32
+#define FONT_LAST_CODEPOINT 126
+#define FONT_GLYPH_COUNT (FONT_LAST_CODEPOINT - FONT_FIRST_CODEPOINT + 1)
+
+#define FONT_ATLAS_WIDTH 512
+
+enum FontStyle
+{
+    FONT_STYLE_REGULAR,
+    FONT_STYLE_BOLD,
+
+    FONT_STYLE_COUNT,
+};
+
+enum FontSize
+{
+    FONT_SIZE_SMALL,
+    FONT_SIZE_MEDIUM,
+    FONT_SIZE_LARGE,
+
+    FONT_SIZE_COUNT,
+};
+
+struct FontGlyph
+{
+    // NOTE where the glyph is in the atlas.
+    int32 x;
+    int32 y;
+    int32 width;
+    int32 height;
+
+    // NOTE from the pen on the baseline to the top left corner of the glyph, y goes down the screen.
+    int32 offsetX;
+    int32 offsetY;
+
+    real32 advance;
+};
+
+struct Font
+{
+    // NOTE a font that could not be read has no glyphs, text drawn with it just takes no space.
+    bool32 isValid;
+
+    real32 pixelHeight;
+    real32 ascent;
+    real32 descent;
+    real32 lineAdvance;
+
+    // NOTE the kerning is shared by every size of a style, in font units, unitScale takes it to pixels.
+    real32 unitScale;
+    int16 *kerning;
+
+    Bitmap *atlas;
+    FontGlyph glyphs[FONT_GLYPH_COUNT];
+};
+
+struct FontAtlas
+{
+    Bitmap bitmap;
+
+    // NOTE what to move the pen by between two glyphs on top of the advance of the first, [first][second].
+    int16 kerning[FONT_STYLE_COUNT][FONT_GLYPH_COUNT][FONT_GLYPH_COUNT];
+
+    Font fonts[FONT_STYLE_COUNT][FONT_SIZE_COUNT];
+};
+
+// NOTE the parts of the TrueType file the rasterizer reads, as offsets into it.
+struct TrueTypeFile
+{
+    uint8 *data;
+    uint32 size;
+
+    uint32 cmap;
+    uint32 glyf;
+    uint32 loca;
+    uint32 hmtx;
+
+    // NOTE 0 when the font has no kerning of that kind.
+    uint32 gpos;
+    uint32 kern;
+
+    int32 unitsPerEm;
+    int32 indexToLocFormat;
+    int32 glyphCount;
+    int32 hMetricCount;
+
+    int32 ascender;
+    int32 descender;
+    int32 lineGap;
+};
+
+struct FontEdge
+{
+    real32 x0, y0;
+    real32 x1, y1;
+};
+
+#define HEX_MAGIC_FONT
+#endif
@@ -0,0 +1,806 @@
+#include "hex_magic.h"
+#include "hex_magic_generate.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_intrinsics.h"
+#include "hex_magic_math.h"
+#include "hex_magic_platform.h"
+
+// NOTE rows of the offset grid are this far apart when neighbouring cells are 1 apart.
+#define GENERATE_ROW_HEIGHT 0.8660254f
+
+#define GENERATE_HASH_PRIME_X 0x27D4EB2D
+#define GENERATE_HASH_PRIME_Y 0x165667B1
+#define GENERATE_HASH_MIX 0x2C1B3C6D
+
+// NOTE how far the noise spreads around 0.5, and how far elevation sinks at the very edge of the world.
+#define GENERATE_FIELD_GAIN 1.3f
+#define GENERATE_EDGE_DROP 0.6f
+
+inline uint32 NextGenerateRandom(GenerateRandom *random)
+{
+    uint64 x = random->state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+
+    random->state = x;
+
+    uint32 result = (uint32)((x * 0x2545F4914F6CDD1DULL) >> 32);
+    return result;
+}
+
+inline real32 GenerateRandomUnilateral(GenerateRandom *random)
+{
+    real32 result = (real32)(NextGenerateRandom(random) >> 8) * (1.0f / 16777216.0f);
+    return result;
+}
+
+inline GenerateRandom MakeGenerateRandom(uint32 seed, uint32 stream)
+{
+    GenerateRandom result;
+
+    // NOTE never 0, xorshift would get stuck there.
+    result.state = ((uint64)seed << 32 | stream) * 0x9E3779B97F4A7C15ULL | 1;
+
+    return result;
+}
+
+//
+// NOTE fields
+//
+
+// NOTE the first octave has features about featureSize cells across, every next one has features half as big, down
+// to minFeatureSize. The amplitudes add up to 1.
+internal void InitializeGenerateField(GenerateField *field, GenerateRandom *random, real32 featureSize,
+                                      real32 minFeatureSize, real32 persistence)
+{
+    field->octaveCount = 0;
+
+    real32 amplitude      = 1.0f;
+    real32 totalAmplitude = 0.0f;
+
+    while (field->octaveCount < GENERATE_MAX_OCTAVE_COUNT && (field->octaveCount == 0 || featureSize >= minFeatureSize))
+    {
+        GenerateOctave *octave = field->octaves + field->octaveCount++;
+
+        octave->seed      = NextGenerateRandom(random);
+        octave->frequency = 1.0f / featureSize;
+        octave->amplitude = amplitude;
+        octave->offsetX   = 256.0f + 256.0f * GenerateRandomUnilateral(random);
+        octave->offsetY   = 256.0f + 256.0f * GenerateRandomUnilateral(random);
+
+        totalAmplitude += amplitude;
+        amplitude *= persistence;
+        featureSize *= 0.5f;
+    }
+
+    for (uint32 octaveIndex = 0; octaveIndex < field->octaveCount; ++octaveIndex)
+    {
+        field->octaves[octaveIndex].amplitude /= totalAmplitude;
+    }
+}
+
+//
+// NOTE biomes
+//
+
+// NOTE elevation and moisture both go from 0 to 1. The sea is everything below 0.45.
+internal Biome ClassifyGeneratedCell(real32 elevation, real32 moisture)
+{
+    Biome result;
+
+    if (elevation < 0.45f)
+    {
+        result = WATER;
+    }
+    else if (elevation < 0.47f)
+    {
+        result = moisture > 0.62f ? SWAMP : SAND;
+    }
+    else if (elevation > 0.74f)
+    {
+        result = moisture > 0.4f ? SNOW : ROCK;
+    }
+    else if (elevation > 0.68f)
+    {
+        result = moisture < 0.3f ? LAVA : ROCK;
+    }
+    else if (elevation > 0.61f)
+    {
+        result = moisture < 0.45f ? ROUGH : GRASS;
+    }
+    else if (moisture > 0.62f)
+    {
+        result = elevation < 0.53f ? SWAMP : GRASS;
+    }
+    else if (moisture > 0.42f)
+    {
+        result = GRASS;
+    }
+    else if (moisture > 0.32f)
+    {
+        result = DIRT;
+    }
+    else
+    {
+        result = elevation > 0.52f ? ROUGH : SAND;
+    }
+
+    return result;
+}
+
+internal void InitializeWorldGenerator(WorldGenerator *generator, World *world, uint32 seed)
+{
+    generator->seed        = seed;
+    generator->chunkCountX = (world->width + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+    generator->chunkCountY = (world->height + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+
+    // NOTE continents scale with the world, so a big world isn't just a small one repeated.
+    int32 worldSize    = world->width > world->height ? world->width : world->height;
+    real32 featureSize = Clamp(48.0f, (real32)worldSize / 3.0f, 1024.0f);
+
+    GenerateRandom random = MakeGenerateRandom(seed, 0);
+    // NOTE coastlines and mountains want the detail, moisture only decides what grows where.
+    InitializeGenerateField(&generator->elevation, &random, featureSize, 6.0f, 0.5f);
+    InitializeGenerateField(&generator->moisture, &random, featureSize / 2.0f, 24.0f, 0.5f);
+
+    int32 minDim          = world->width < world->height ? world->width : world->height;
+    generator->edgeMargin = Clamp(8.0f, (real32)minDim / 8.0f, 256.0f);
+
+    for (uint32 elevationStep = 0; elevationStep < GENERATE_BIOME_TABLE_DIM; ++elevationStep)
+    {
+        for (uint32 moistureStep = 0; moistureStep < GENERATE_BIOME_TABLE_DIM; ++moistureStep)
+        {
+            real32 elevation = ((real32)elevationStep + 0.5f) / GENERATE_BIOME_TABLE_DIM;
+            real32 moisture  = ((real32)moistureStep + 0.5f) / GENERATE_BIOME_TABLE_DIM;
+
+            generator->biomes[elevationStep * GENERATE_BIOME_TABLE_DIM + moistureStep] =
+                (uint8)ClassifyGeneratedCell(elevation, moisture);
+        }
+    }
+}
+
+//
+// NOTE SSE2
+//
+
+// NOTE SSE2 has no 32 bit multiply that keeps the low halves, so the even and odd lanes are multiplied separately.
+inline __m128i MultiplySse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+
+    __m128i result = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                        _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    return result;
+}
+
+inline __m128i GenerateHashSse2(__m128i hashX, __m128i hashY, __m128i seed)
+{
+    __m128i result = _mm_xor_si128(seed, _mm_xor_si128(hashX, hashY));
+
+    result = _mm_xor_si128(result, _mm_srli_epi32(result, 15));
+    result = MultiplySse2(result, _mm_set1_epi32(GENERATE_HASH_MIX));
+    result = _mm_xor_si128(result, _mm_srli_epi32(result, 13));
+
+    return result;
+}
+
+// NOTE the top two bits of the hash flip the signs of the offsets, which picks one of the four diagonal gradients.
+inline __m128 GenerateGradientSse2(__m128i hash, __m128 fx, __m128 fy)
+{
+    __m128i signMask = _mm_set1_epi32((int32)0x80000000);
+    __m128 signX     = _mm_castsi128_ps(_mm_and_si128(hash, signMask));
+    __m128 signY     = _mm_castsi128_ps(_mm_and_si128(_mm_slli_epi32(hash, 1), signMask));
+
+    __m128 result = _mm_add_ps(_mm_xor_ps(fx, signX), _mm_xor_ps(fy, signY));
+    return result;
+}
+
+// NOTE 6t^5 - 15t^4 + 10t^3, so the noise is smooth across the lattice lines.
+inline __m128 GenerateFadeSse2(__m128 t)
+{
+    __m128 result = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))),
+                               _mm_set1_ps(10.0f));
+    result        = _mm_mul_ps(result, _mm_mul_ps(t, _mm_mul_ps(t, t)));
+
+    return result;
+}
+
+inline __m128 LerpSse2(__m128 a, __m128 b, __m128 t)
+{
+    __m128 result = _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+    return result;
+}
+
+// NOTE gradient noise at four positions, all of them positive. It is 0 on the lattice points and stays within -1 and
+// 1 everywhere else.
+inline __m128 GenerateNoiseSse2(__m128 x, __m128 y, __m128i seed)
+{
+    __m128i x0 = _mm_cvttps_epi32(x);
+    __m128i y0 = _mm_cvttps_epi32(y);
+
+    __m128 fx0 = _mm_sub_ps(x, _mm_cvtepi32_ps(x0));
+    __m128 fy0 = _mm_sub_ps(y, _mm_cvtepi32_ps(y0));
+    __m128 fx1 = _mm_sub_ps(fx0, _mm_set1_ps(1.0f));
+    __m128 fy1 = _mm_sub_ps(fy0, _mm_set1_ps(1.0f));
+
+    __m128i primeX = _mm_set1_epi32(GENERATE_HASH_PRIME_X);
+    __m128i primeY = _mm_set1_epi32(GENERATE_HASH_PRIME_Y);
+
+    __m128i hashX0 = MultiplySse2(x0, primeX);
+    __m128i hashX1 = _mm_add_epi32(hashX0, primeX);
+    __m128i hashY0 = MultiplySse2(y0, primeY);
+    __m128i hashY1 = _mm_add_epi32(hashY0, primeY);
+
+    __m128 n00 = GenerateGradientSse2(GenerateHashSse2(hashX0, hashY0, seed), fx0, fy0);
+    __m128 n10 = GenerateGradientSse2(GenerateHashSse2(hashX1, hashY0, seed), fx1, fy0);
+    __m128 n01 = GenerateGradientSse2(GenerateHashSse2(hashX0, hashY1, seed), fx0, fy1);
+    __m128 n11 = GenerateGradientSse2(GenerateHashSse2(hashX1, hashY1, seed), fx1, fy1);
+
+    __m128 u = GenerateFadeSse2(fx0);
+    __m128 v = GenerateFadeSse2(fy0);
+
+    __m128 result = LerpSse2(LerpSse2(n00, n10, u), LerpSse2(n01, n11, u), v);
+    result        = _mm_mul_ps(result, _mm_set1_ps(0.5f));
+
+    return result;
+}
+
+inline __m128 GenerateFractalNoiseSse2(GenerateField *field, __m128 x, __m128 y)
+{
+    __m128 result = _mm_setzero_ps();
+
+    for (uint32 octaveIndex = 0; octaveIndex < field->octaveCount; ++octaveIndex)
+    {
+        GenerateOctave *octave = field->octaves + octaveIndex;
+        __m128 frequency       = _mm_set1_ps(octave->frequency);
+
+        __m128 octaveX = _mm_add_ps(_mm_mul_ps(x, frequency), _mm_set1_ps(octave->offsetX));
+        __m128 octaveY = _mm_add_ps(_mm_mul_ps(y, frequency), _mm_set1_ps(octave->offsetY));
+        __m128 noise   = GenerateNoiseSse2(octaveX, octaveY, _mm_set1_epi32((int32)octave->seed));
+
+        result = _mm_add_ps(result, _mm_mul_ps(noise, _mm_set1_ps(octave->amplitude)));
+    }
+
+    return result;
+}
+
+// NOTE step of a value from 0 to 1 in the biome table, anything outside of that goes to the first or last step.
+inline __m128i GenerateTableStepSse2(__m128 value)
+{
+    __m128 scaled = _mm_mul_ps(value, _mm_set1_ps((real32)GENERATE_BIOME_TABLE_DIM));
+    scaled        = _mm_min_ps(_mm_max_ps(scaled, _mm_setzero_ps()), _mm_set1_ps(GENERATE_BIOME_TABLE_DIM - 1));
+
+    __m128i result = _mm_cvttps_epi32(scaled);
+    return result;
+}
+
+// NOTE both fields are centered on 0.5. Elevation drops towards the edges of the world, so the land never runs off it.
+// Writes the biome table index of each cell of the row from minX up to maxX, rounded up to four cells.
+internal void GenerateRowSse2(WorldGenerator *generator, World *world, int32 y, int32 minX, int32 maxX, int32 *indices)
+{
+    __m128 half      = _mm_set1_ps(0.5f);
+    __m128 one       = _mm_set1_ps(1.0f);
+    __m128 gain      = _mm_set1_ps(GENERATE_FIELD_GAIN);
+    __m128 edgeDrop  = _mm_set1_ps(GENERATE_EDGE_DROP);
+    __m128 edgeScale = _mm_set1_ps(1.0f / generator->edgeMargin);
+    __m128 lastX     = _mm_set1_ps((real32)(world->width - 1));
+    __m128 laneX     = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+    __m128 edgeY  = _mm_set1_ps((real32)(y < world->height - 1 - y ? y : world->height - 1 - y));
+    __m128 rowY   = _mm_set1_ps((real32)y * GENERATE_ROW_HEIGHT);
+    __m128 shiftX = _mm_set1_ps((y & 1) ? 0.5f : 0.0f);
+
+    for (int32 x = minX; x < maxX; x += 4)
+    {
+        __m128 cellX = _mm_add_ps(_mm_set1_ps((real32)x), laneX);
+        __m128 rowX  = _mm_add_ps(cellX, shiftX);
+
+        __m128 elevation = GenerateFractalNoiseSse2(&generator->elevation, rowX, rowY);
+        __m128 moisture  = GenerateFractalNoiseSse2(&generator->moisture, rowX, rowY);
+
+        __m128 edge = _mm_min_ps(_mm_min_ps(cellX, _mm_sub_ps(lastX, cellX)), edgeY);
+        edge        = _mm_sub_ps(one, _mm_min_ps(_mm_mul_ps(edge, edgeScale), one));
+
+        elevation = _mm_add_ps(half, _mm_mul_ps(elevation, gain));
+        elevation = _mm_sub_ps(elevation, _mm_mul_ps(edgeDrop, _mm_mul_ps(edge, edge)));
+        moisture  = _mm_add_ps(half, _mm_mul_ps(moisture, gain));
+
+        __m128i index = _mm_add_epi32(_mm_slli_epi32(GenerateTableStepSse2(elevation), GENERATE_BIOME_TABLE_SHIFT),
+                                      GenerateTableStepSse2(moisture));
+
+        _mm_storeu_si128((__m128i *)(indices + (x - minX)), index);
+    }
+}
+
+//
+// NOTE AVX2
+//
+
+TARGET_AVX2 inline __m256i GenerateHashAvx2(__m256i hashX, __m256i hashY, __m256i seed)
+{
+    __m256i result = _mm256_xor_si256(seed, _mm256_xor_si256(hashX, hashY));
+
+    result = _mm256_xor_si256(result, _mm256_srli_epi32(result, 15));
+    result = _mm256_mullo_epi32(result, _mm256_set1_epi32(GENERATE_HASH_MIX));
+    result = _mm256_xor_si256(result, _mm256_srli_epi32(result, 13));
+
+    return result;
+}
+
+TARGET_AVX2 inline __m256 GenerateGradientAvx2(__m256i hash, __m256 fx, __m256 fy)
+{
+    __m256i signMask = _mm256_set1_epi32((int32)0x80000000);
+    __m256 signX     = _mm256_castsi256_ps(_mm256_and_si256(hash, signMask));
+    __m256 signY     = _mm256_castsi256_ps(_mm256_and_si256(_mm256_slli_epi32(hash, 1), signMask));
+
+    __m256 result = _mm256_add_ps(_mm256_xor_ps(fx, signX), _mm256_xor_ps(fy, signY));
+    return result;
+}
+
+TARGET_AVX2 inline __m256 GenerateFadeAvx2(__m256 t)
+{
+    __m256 result = _mm256_add_ps(
+        _mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))),
+        _mm256_set1_ps(10.0f));
+    result = _mm256_mul_ps(result, _mm256_mul_ps(t, _mm256_mul_ps(t, t)));
+
+    return result;
+}
+
+TARGET_AVX2 inline __m256 LerpAvx2(__m256 a, __m256 b, __m256 t)
+{
+    __m256 result = _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+    return result;
+}
+
+TARGET_AVX2 inline __m256 GenerateNoiseAvx2(__m256 x, __m256 y, __m256i seed)
+{
+    __m256i x0 = _mm256_cvttps_epi32(x);
+    __m256i y0 = _mm256_cvttps_epi32(y);
+
+    __m256 fx0 = _mm256_sub_ps(x, _mm256_cvtepi32_ps(x0));
+    __m256 fy0 = _mm256_sub_ps(y, _mm256_cvtepi32_ps(y0));
+    __m256 fx1 = _mm256_sub_ps(fx0, _mm256_set1_ps(1.0f));
+    __m256 fy1 = _mm256_sub_ps(fy0, _mm256_set1_ps(1.0f));
+
+    __m256i primeX = _mm256_set1_epi32(GENERATE_HASH_PRIME_X);
+    __m256i primeY = _mm256_set1_epi32(GENERATE_HASH_PRIME_Y);
+
+    __m256i hashX0 = _mm256_mullo_epi32(x0, primeX);
+    __m256i hashX1 = _mm256_add_epi32(hashX0, primeX);
+    __m256i hashY0 = _mm256_mullo_epi32(y0, primeY);
+    __m256i hashY1 = _mm256_add_epi32(hashY0, primeY);
+
+    __m256 n00 = GenerateGradientAvx2(GenerateHashAvx2(hashX0, hashY0, seed), fx0, fy0);
+    __m256 n10 = GenerateGradientAvx2(GenerateHashAvx2(hashX1, hashY0, seed), fx1, fy0);
+    __m256 n01 = GenerateGradientAvx2(GenerateHashAvx2(hashX0, hashY1, seed), fx0, fy1);
+    __m256 n11 = GenerateGradientAvx2(GenerateHashAvx2(hashX1, hashY1, seed), fx1, fy1);
+
+    __m256 u = GenerateFadeAvx2(fx0);
+    __m256 v = GenerateFadeAvx2(fy0);
+
+    __m256 result = LerpAvx2(LerpAvx2(n00, n10, u), LerpAvx2(n01, n11, u), v);
+    result        = _mm256_mul_ps(result, _mm256_set1_ps(0.5f));
+
+    return result;
+}
+
+TARGET_AVX2 inline __m256 GenerateFractalNoiseAvx2(GenerateField *field, __m256 x, __m256 y)
+{
+    __m256 result = _mm256_setzero_ps();
+
+    for (uint32 octaveIndex = 0; octaveIndex < field->octaveCount; ++octaveIndex)
+    {
+        GenerateOctave *octave = field->octaves + octaveIndex;
+        __m256 frequency       = _mm256_set1_ps(octave->frequency);
+
+        __m256 octaveX = _mm256_add_ps(_mm256_mul_ps(x, frequency), _mm256_set1_ps(octave->offsetX));
+        __m256 octaveY = _mm256_add_ps(_mm256_mul_ps(y, frequency), _mm256_set1_ps(octave->offsetY));
+        __m256 noise   = GenerateNoiseAvx2(octaveX, octaveY, _mm256_set1_epi32((int32)octave->seed));
+
+        result = _mm256_add_ps(result, _mm256_mul_ps(noise, _mm256_set1_ps(octave->amplitude)));
+    }
+
+    return result;
+}
+
+TARGET_AVX2 inline __m256i GenerateTableStepAvx2(__m256 value)
+{
+    __m256 scaled = _mm256_mul_ps(value, _mm256_set1_ps((real32)GENERATE_BIOME_TABLE_DIM));
+    scaled = _mm256_min_ps(_mm256_max_ps(scaled, _mm256_setzero_ps()), _mm256_set1_ps(GENERATE_BIOME_TABLE_DIM - 1));
+
+    __m256i result = _mm256_cvttps_epi32(scaled);
+    return result;
+}
+
+TARGET_AVX2 internal void GenerateRowAvx2(WorldGenerator *generator, World *world, int32 y, int32 minX, int32 maxX,
+                                          int32 *indices)
+{
+    __m256 half      = _mm256_set1_ps(0.5f);
+    __m256 one       = _mm256_set1_ps(1.0f);
+    __m256 gain      = _mm256_set1_ps(GENERATE_FIELD_GAIN);
+    __m256 edgeDrop  = _mm256_set1_ps(GENERATE_EDGE_DROP);
+    __m256 edgeScale = _mm256_set1_ps(1.0f / generator->edgeMargin);
+    __m256 lastX     = _mm256_set1_ps((real32)(world->width - 1));
+    __m256 laneX     = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+
+    __m256 edgeY  = _mm256_set1_ps((real32)(y < world->height - 1 - y ? y : world->height - 1 - y));
+    __m256 rowY   = _mm256_set1_ps((real32)y * GENERATE_ROW_HEIGHT);
+    __m256 shiftX = _mm256_set1_ps((y & 1) ? 0.5f : 0.0f);
+
+    for (int32 x = minX; x < maxX; x += 8)
+    {
+        __m256 cellX = _mm256_add_ps(_mm256_set1_ps((real32)x), laneX);
+        __m256 rowX  = _mm256_add_ps(cellX, shiftX);
+
+        __m256 elevation = GenerateFractalNoiseAvx2(&generator->elevation, rowX, rowY);
+        __m256 moisture  = GenerateFractalNoiseAvx2(&generator->moisture, rowX, rowY);
+
+        __m256 edge = _mm256_min_ps(_mm256_min_ps(cellX, _mm256_sub_ps(lastX, cellX)), edgeY);
+        edge        = _mm256_sub_ps(one, _mm256_min_ps(_mm256_mul_ps(edge, edgeScale), one));
+
+        elevation = _mm256_add_ps(half, _mm256_mul_ps(elevation, gain));
+        elevation = _mm256_sub_ps(elevation, _mm256_mul_ps(edgeDrop, _mm256_mul_ps(edge, edge)));
+        moisture  = _mm256_add_ps(half, _mm256_mul_ps(moisture, gain));
+
+        __m256i index =
+            _mm256_add_epi32(_mm256_slli_epi32(GenerateTableStepAvx2(elevation), GENERATE_BIOME_TABLE_SHIFT),
+                             GenerateTableStepAvx2(moisture));
+
+        _mm256_storeu_si256((__m256i *)(indices + (x - minX)), index);
+    }
+}
+
+//
+// NOTE chunks
+//
+
+internal uint32 GenerateChunk(WorldGenerator *generator, World *world, uint32 chunkIndex)
+{
+    uint32 landCellCount = 0;
+
+    int32 minX = (chunkIndex % generator->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 minY = (chunkIndex / generator->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 maxX = Min(world->width, minX + WORLD_CHUNK_DIM);
+    int32 maxY = Min(world->height, minY + WORLD_CHUNK_DIM);
+
+    bool32 useAvx2 = GetHexBatchPath() == HEX_BATCH_AVX2;
+
+    for (int32 y = minY; y < maxY; ++y)
+    {
+        int32 indices[WORLD_CHUNK_DIM];
+
+        if (useAvx2)
+        {
+            GenerateRowAvx2(generator, world, y, minX, maxX, indices);
+        }
+        else
+        {
+            GenerateRowSse2(generator, world, y, minX, maxX, indices);
+        }
+
+        Cell *cell = GetCellRow(world, y) + minX;
+        for (int32 x = minX; x < maxX; ++x)
+        {
+            Biome biome = (Biome)generator->biomes[indices[x - minX]];
+            InitializeCell(cell++, x, y, biome);
+
+            landCellCount += biome != WATER;
+        }
+    }
+
+    return landCellCount;
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoGenerateJob)
+{
+    TIMED_FUNCTION();
+
+    GenerateJob *job   = (GenerateJob *)data;
+    job->landCellCount = 0;
+
+    for (uint32 chunkIndex = job->firstChunk; chunkIndex < job->firstChunk + job->chunkCount; ++chunkIndex)
+    {
+        job->landCellCount += GenerateChunk(job->generator, job->world, chunkIndex);
+    }
+}
+
+//
+// NOTE placement
+//
+
+inline V2 GetGeneratePosition(OffsetCoord offset)
+{
+    V2 result = {(real32)offset.x + ((offset.y & 1) ? 0.5f : 0.0f), (real32)offset.y * GENERATE_ROW_HEIGHT};
+    return result;
+}
+
+inline OffsetCoord GetGenerateOffset(V2 position)
+{
+    OffsetCoord result;
+
+    result.y = FloorReal32ToInt32(position.y / GENERATE_ROW_HEIGHT + 0.5f);
+    result.x = FloorReal32ToInt32(position.x - ((result.y & 1) ? 0.5f : 0.0f) + 0.5f);
+
+    return result;
+}
+
+struct PoissonSampler
+{
+    World *world;
+    uint32 biomeMask;
+
+    real32 radius;
+    real32 gridCellSize;
+    int32 gridWidth;
+    int32 gridHeight;
+
+    // NOTE index + 1 of the sample in each grid cell, the grid cells are small enough to never hold two.
+    uint32 *grid;
+
+    uint32 sampleCount;
+    uint32 maxSampleCount;
+    OffsetCoord *samples;
+    V2 *positions;
+
+    uint32 activeCount;
+    uint32 *active;
+};
+
+inline bool32 IsPoissonCellFree(PoissonSampler *sampler, OffsetCoord offset)
+{
+    bool32 result = false;
+
+    Cell *cell = GetCell(sampler->world, offset);
+    if (cell && (sampler->biomeMask & (1 << cell->biome)) && !cell->cityIndex && !cell->resourceIndex &&
+        !cell->heroIndex)
+    {
+        result = true;
+    }
+
+    return result;
+}
+
+internal bool32 TryAddPoissonSample(PoissonSampler *sampler, OffsetCoord offset)
+{
+    bool32 result = false;
+
+    if (sampler->sampleCount < sampler->maxSampleCount && IsPoissonCellFree(sampler, offset))
+    {
+        V2 position = GetGeneratePosition(offset);
+        int32 gridX = (int32)(position.x / sampler->gridCellSize);
+        int32 gridY = (int32)(position.y / sampler->gridCellSize);
+
+        bool32 isFar     = true;
+        real32 radiusSq  = sampler->radius * sampler->radius;
+        int32 firstGridY = gridY > 2 ? gridY - 2 : 0;
+        int32 lastGridY  = gridY + 2 < sampler->gridHeight - 1 ? gridY + 2 : sampler->gridHeight - 1;
+        int32 firstGridX = gridX > 2 ? gridX - 2 : 0;
+        int32 lastGridX  = gridX + 2 < sampler->gridWidth - 1 ? gridX + 2 : sampler->gridWidth - 1;
+
+        for (int32 testY = firstGridY; isFar && testY <= lastGridY; ++testY)
+        {
+            for (int32 testX = firstGridX; isFar && testX <= lastGridX; ++testX)
+            {
+                uint32 other = sampler->grid[testY * sampler->gridWidth + testX];
+                if (other && LengthSq(sampler->positions[other - 1] - position) < radiusSq)
+                {
+                    isFar = false;
+                }
+            }
+        }
+
+        if (isFar)
+        {
+            uint32 index = sampler->sampleCount++;
+
+            sampler->samples[index]                           = offset;
+            sampler->positions[index]                         = position;
+            sampler->grid[gridY * sampler->gridWidth + gridX] = index + 1;
+            sampler->active[sampler->activeCount++]           = index;
+
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+// NOTE Bridson's sampling. Candidates go in a ring between one and two radii around an active sample, and a sample
+// stops being active once none of its candidates fit. Every sample lands on the center of a cell the mask allows.
+internal uint32 SamplePoissonDisk(World *world, MemoryArena *arena, GenerateRandom *random, real32 radius,
+                                  uint32 biomeMask, OffsetCoord *samples, uint32 maxSampleCount)
+{
+    TemporaryMemory sampleMemory = StartTemporaryMemory(arena);
+
+    PoissonSampler sampler = {};
+    sampler.world          = world;
+    sampler.biomeMask      = biomeMask;
+    sampler.radius         = radius;
+    sampler.gridCellSize   = radius / Sqrt(2.0f);
+    sampler.gridWidth      = (int32)((real32)world->width / sampler.gridCellSize) + 2;
+    sampler.gridHeight     = (int32)((real32)world->height * GENERATE_ROW_HEIGHT / sampler.gridCellSize) + 2;
+    sampler.maxSampleCount = maxSampleCount;
+    sampler.samples        = samples;
+    sampler.positions      = PushArray(arena, maxSampleCount, V2);
+    sampler.active         = PushArray(arena, maxSampleCount, uint32);
+
+    MemoryIndex gridCellCount = (MemoryIndex)sampler.gridWidth * sampler.gridHeight;
+    sampler.grid              = PushArray(arena, gridCellCount, uint32);
+    memset(sampler.grid, 0, gridCellCount * sizeof(uint32));
+
+    for (uint32 throwIndex = 0; throwIndex < GENERATE_POISSON_THROW_COUNT; ++throwIndex)
+    {
+        OffsetCoord offset = {1 + (int32)(NextGenerateRandom(random) % (uint32)(world->width - 1)),
+                              1 + (int32)(NextGenerateRandom(random) % (uint32)(world->height - 1))};
+        TryAddPoissonSample(&sampler, offset);
+
+        while (sampler.activeCount)
+        {
+            uint32 activeIndex = NextGenerateRandom(random) % sampler.activeCount;
+            V2 center          = sampler.positions[sampler.active[activeIndex]];
+            bool32 found       = false;
+
+            for (uint32 candidate = 0; !found && candidate < GENERATE_POISSON_CANDIDATE_COUNT; ++candidate)
+            {
+                // NOTE picked from the square around the ring until one is in the ring, which keeps sines out of it.
+                V2 delta;
+                real32 lengthSq;
+                do
+                {
+                    delta    = {(GenerateRandomUnilateral(random) * 4.0f - 2.0f) * radius,
+                                (GenerateRandomUnilateral(random) * 4.0f - 2.0f) * radius};
+                    lengthSq = LengthSq(delta);
+                } while (lengthSq < radius * radius || lengthSq > 4.0f * radius * radius);
+
+                found = TryAddPoissonSample(&sampler, GetGenerateOffset(center + delta));
+            }
+
+            if (!found)
+            {
+                sampler.active[activeIndex] = sampler.active[--sampler.activeCount];
+            }
+        }
+    }
+
+    EndTemporaryMemory(sampleMemory);
+
+    return sampler.sampleCount;
+}
+
+// NOTE a radius that should give about count samples over that much land, with room to spare. Bridson's samples end
+// up about 0.7 radius squared apart, and each cell covers 0.87 of a cell squared.
+inline real32 GetPoissonRadius(uint32 landCellCount, uint32 count, real32 minRadius)
+{
+    real32 area   = (real32)landCellCount * GENERATE_ROW_HEIGHT;
+    real32 result = Sqrt(0.7f * area / (0.75f * (real32)count));
+
+    if (result < minRadius)
+    {
+        result = minRadius;
+    }
+
+    return result;
+}
+
+internal void PlaceGeneratedEntities(WorldGenerator *generator, World *world, MemoryArena *arena)
+{
+    TemporaryMemory placeMemory = StartTemporaryMemory(arena);
+
+    GenerateRandom random = MakeGenerateRandom(generator->seed, 1);
+    uint32 landCellCount  = generator->lastLandCellCount;
+
+    OffsetCoord *cities = PushArray(arena, GENERATE_MAX_CITY_COUNT, OffsetCoord);
+    uint32 cityCount    = 0;
+    if (landCellCount)
+    {
+        cityCount = SamplePoissonDisk(world, arena, &random, GetPoissonRadius(landCellCount, GENERATE_MAX_CITY_COUNT, 4.0f),
+                                      (1 << GRASS) | (1 << DIRT), cities, GENERATE_MAX_CITY_COUNT);
+    }
+
+    for (uint32 cityIndex = 0; cityIndex < cityCount; ++cityIndex)
+    {
+        Cell *cell      = GetCell(world, cities[cityIndex]);
+        cell->cityIndex = AddCity(world, cell->position);
+    }
+
+    OffsetCoord *resources = PushArray(arena, GENERATE_MAX_RESOURCE_COUNT, OffsetCoord);
+    uint32 resourceCount   = 0;
+    if (landCellCount)
+    {
+        uint32 resourceMask = (1 << GRASS) | (1 << DIRT) | (1 << ROUGH) | (1 << SAND) | (1 << SNOW) | (1 << SWAMP);
+        resourceCount =
+            SamplePoissonDisk(world, arena, &random, GetPoissonRadius(landCellCount, GENERATE_MAX_RESOURCE_COUNT, 2.0f),
+                              resourceMask, resources, GENERATE_MAX_RESOURCE_COUNT);
+    }
+
+    for (uint32 resourceIndex = 0; resourceIndex < resourceCount; ++resourceIndex)
+    {
+        Cell *cell          = GetCell(world, resources[resourceIndex]);
+        cell->resourceIndex = AddResource(world, cell->position);
+    }
+
+    generator->lastCityCount     = cityCount;
+    generator->lastResourceCount = resourceCount;
+
+    EndTemporaryMemory(placeMemory);
+}
+
+// NOTE replaces every cell and entity of the world. The chunks are split over at most jobCount jobs on the high
+// priority queue. A paged world gets all of its bands up front, so the jobs only ever write rows that are already
+// there, and every chunk comes out resident and dirty, so the next snapshot saves all of it. A paged world too big to
+// hold in its arena is left as it was.
+internal bool32 GenerateWorld(WorldGenerator *generator, World *world, GameMemory *memory, MemoryArena *arena,
+                              uint32 seed, uint32 jobCount)
+{
+    WorldPager *pager = world->pager;
+    bool32 result     = !pager || ReserveWorldBands(world);
+
+    if (result)
+    {
+        uint64 start = __rdtsc();
+
+        InitializeWorldGenerator(generator, world, seed);
+
+        world->selectedCell    = 0;
+        world->entityCount     = 0;
+        world->freeEntityCount = 0;
+
+        // NOTE entity 0 stands for no entity.
+        AddEntity(world);
+
+        uint32 chunkCount = generator->chunkCountX * generator->chunkCountY;
+
+        jobCount = jobCount < GENERATE_MAX_JOB_COUNT ? jobCount : GENERATE_MAX_JOB_COUNT;
+        jobCount = jobCount < chunkCount ? jobCount : chunkCount;
+        jobCount = jobCount ? jobCount : 1;
+
+        uint32 chunksPerJob = (chunkCount + jobCount - 1) / jobCount;
+        jobCount            = (chunkCount + chunksPerJob - 1) / chunksPerJob;
+
+        for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+        {
+            uint32 firstChunk = jobIndex * chunksPerJob;
+
+            GenerateJob *job = generator->jobs + jobIndex;
+            job->generator   = generator;
+            job->world       = world;
+            job->firstChunk  = firstChunk;
+            job->chunkCount  = chunkCount - firstChunk < chunksPerJob ? chunkCount - firstChunk : chunksPerJob;
+
+            memory->platformAddEntry(memory->highPriorityQueue, DoGenerateJob, job);
+        }
+
+        memory->platformCompleteAllWork(memory->highPriorityQueue);
+
+        generator->lastJobCount      = jobCount;
+        generator->lastLandCellCount = 0;
+        for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+        {
+            generator->lastLandCellCount += generator->jobs[jobIndex].landCellCount;
+        }
+
+        if (pager)
+        {
+            for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+            {
+                pager->chunkStates[chunkIndex] |= WORLD_CHUNK_RESIDENT;
+                MarkWorldChunkDirty(pager, chunkIndex);
+            }
+
+            pager->residentChunkCount = chunkCount;
+        }
+
+        uint64 fields = __rdtsc();
+
+        PlaceGeneratedEntities(generator, world, arena);
+
+        generator->lastFieldCycles = fields - start;
+        generator->lastPlaceCycles = __rdtsc() - fields;
+    }
+
+    return result;
+}
@@ -0,0 +1,93 @@
+#if !defined(HEX_MAGIC_GENERATE)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+
+// NOTE new worlds are grown from a seed. Two fields of gradient noise, elevation and moisture, are evaluated four
+// cells at a time for every cell and looked up in a table of biomes, one job per group of world chunks. The noise at
+// a cell only depends on the seed and where the cell is, so it comes out the same no matter how the chunks are split
+// between the threads. Cities and resources are then scattered over the land by Poisson disk sampling on the main
+// thread, which only depends on the seed and the biomes.
+//
+// The noise runs eight cells at a time with AVX2 when the CPU has it and four at a time with SSE2 otherwise. Both do
+// the same float operations in the same order, so every x86-64 CPU makes the same world out of the same seed.
+
+#define GENERATE_MAX_OCTAVE_COUNT 10
+#define GENERATE_MAX_JOB_COUNT 64
+
+// NOTE elevation and moisture are each quantized to this many steps to look the biome up.
+#define GENERATE_BIOME_TABLE_SHIFT 6
+#define GENERATE_BIOME_TABLE_DIM (1 << GENERATE_BIOME_TABLE_SHIFT)
+
+// NOTE the world only has room for 255 entities, some of them are left for the heroes.
+#define GENERATE_MAX_CITY_COUNT 32
+#define GENERATE_MAX_RESOURCE_COUNT 128
+
+// NOTE candidates tried around each sample, and random cells tried to start sampling areas the samples can't get to
+// from the ones there are, like islands.
+#define GENERATE_POISSON_CANDIDATE_COUNT 30
+#define GENERATE_POISSON_THROW_COUNT 256
+
+struct GenerateRandom
+{
+    uint64 state;
+};
+
+struct GenerateOctave
+{
+    uint32 seed;
+    real32 frequency;
+    real32 amplitude;
+
+    // NOTE keeps every sample position positive, so truncating it is the same as flooring it.
+    real32 offsetX;
+    real32 offsetY;
+};
+
+struct GenerateField
+{
+    uint32 octaveCount;
+    GenerateOctave octaves[GENERATE_MAX_OCTAVE_COUNT];
+};
+
+struct WorldGenerator;
+
+struct GenerateJob
+{
+    WorldGenerator *generator;
+    World *world;
+
+    uint32 firstChunk;
+    uint32 chunkCount;
+
+    uint32 landCellCount;
+};
+
+struct WorldGenerator
+{
+    uint32 seed;
+
+    int32 chunkCountX;
+    int32 chunkCountY;
+
+    GenerateField elevation;
+    GenerateField moisture;
+
+    // NOTE how far in from the edges the land starts sinking into the sea.
+    real32 edgeMargin;
+
+    uint8 biomes[GENERATE_BIOME_TABLE_DIM * GENERATE_BIOME_TABLE_DIM];
+
+    GenerateJob jobs[GENERATE_MAX_JOB_COUNT];
+
+    // NOTE stats of the last generation.
+    uint64 lastFieldCycles;
+    uint64 lastPlaceCycles;
+    uint32 lastJobCount;
+    uint32 lastLandCellCount;
+    uint32 lastCityCount;
+    uint32 lastResourceCount;
+};
+
+#define HEX_MAGIC_GENERATE
+#endif
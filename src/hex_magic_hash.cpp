@@ -0,0 +1,398 @@
+#include "hex_magic_hash.h"
+
+#define HASH_PRIME32_1 0x9E3779B1U
+#define HASH_PRIME32_2 0x85EBCA77U
+#define HASH_PRIME32_3 0xC2B2AE3DU
+#define HASH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define HASH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define HASH_PRIME64_3 0x165667B19E3779F9ULL
+#define HASH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define HASH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+global uint64 globalHashSecret[HASH_SECRET_COUNT];
+
+internal void InitializeHashSecret()
+{
+    uint64 state = HASH_PRIME64_5;
+    for (uint32 secretIndex = 0; secretIndex < ArrayCount(globalHashSecret); ++secretIndex)
+    {
+        // NOTE splitmix64.
+        state += 0x9E3779B97F4A7C15ULL;
+
+        uint64 value = state;
+        value        = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value        = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+        globalHashSecret[secretIndex] = value ^ (value >> 31);
+    }
+}
+
+inline uint64 HashAvalanche(uint64 value)
+{
+    value ^= value >> 37;
+    value *= HASH_PRIME64_3;
+    value ^= value >> 32;
+
+    return value;
+}
+
+inline uint64 HashMultiplyFold(uint64 a, uint64 b)
+{
+    unsigned __int128 product = (unsigned __int128)a * b;
+
+    uint64 result = (uint64)product ^ (uint64)(product >> 64);
+    return result;
+}
+
+inline uint64 HashRead64(uint8 *data)
+{
+    uint64 result;
+    memcpy(&result, data, sizeof(result));
+
+    return result;
+}
+
+internal void AccumulateHashStripesScalar(uint64 *accumulators, uint8 *data, MemoryIndex stripeCount,
+                                          uint32 stripeIndex)
+{
+    for (MemoryIndex stripe = 0; stripe < stripeCount; ++stripe)
+    {
+        uint64 *secret = globalHashSecret + stripeIndex + stripe;
+
+        for (uint32 lane = 0; lane < HASH_ACCUMULATOR_COUNT; ++lane)
+        {
+            uint64 value = HashRead64(data + lane * sizeof(uint64));
+            uint64 key   = value ^ secret[lane];
+
+            accumulators[lane ^ 1] += value;
+            accumulators[lane] += (key & 0xFFFFFFFF) * (key >> 32);
+        }
+
+        data += HASH_STRIPE_SIZE;
+    }
+}
+
+// NOTE neighbouring accumulators always share a register, so swapping the halves of the data hands every word to
+// its neighbour.
+internal void AccumulateHashStripesSse2(uint64 *accumulators, uint8 *data, MemoryIndex stripeCount,
+                                        uint32 stripeIndex)
+{
+    __m128i acc0 = _mm_loadu_si128((__m128i *)accumulators + 0);
+    __m128i acc1 = _mm_loadu_si128((__m128i *)accumulators + 1);
+    __m128i acc2 = _mm_loadu_si128((__m128i *)accumulators + 2);
+    __m128i acc3 = _mm_loadu_si128((__m128i *)accumulators + 3);
+
+    for (MemoryIndex stripe = 0; stripe < stripeCount; ++stripe)
+    {
+        __m128i *secret = (__m128i *)(globalHashSecret + stripeIndex + stripe);
+        __m128i *source = (__m128i *)data;
+
+#define HASH_ACCUMULATE_SSE2(acc, index)                                                                               \
+    {                                                                                                                  \
+        __m128i value   = _mm_loadu_si128(source + index);                                                             \
+        __m128i key     = _mm_xor_si128(value, _mm_loadu_si128(secret + index));                                       \
+        __m128i product = _mm_mul_epu32(key, _mm_srli_epi64(key, 32));                                                 \
+        acc             = _mm_add_epi64(acc, _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));                       \
+        acc             = _mm_add_epi64(acc, product);                                                                 \
+    }
+
+        HASH_ACCUMULATE_SSE2(acc0, 0);
+        HASH_ACCUMULATE_SSE2(acc1, 1);
+        HASH_ACCUMULATE_SSE2(acc2, 2);
+        HASH_ACCUMULATE_SSE2(acc3, 3);
+
+#undef HASH_ACCUMULATE_SSE2
+
+        data += HASH_STRIPE_SIZE;
+    }
+
+    _mm_storeu_si128((__m128i *)accumulators + 0, acc0);
+    _mm_storeu_si128((__m128i *)accumulators + 1, acc1);
+    _mm_storeu_si128((__m128i *)accumulators + 2, acc2);
+    _mm_storeu_si128((__m128i *)accumulators + 3, acc3);
+}
+
+TARGET_AVX2 internal void AccumulateHashStripesAvx2(uint64 *accumulators, uint8 *data, MemoryIndex stripeCount,
+                                                    uint32 stripeIndex)
+{
+    __m256i acc0 = _mm256_loadu_si256((__m256i *)accumulators + 0);
+    __m256i acc1 = _mm256_loadu_si256((__m256i *)accumulators + 1);
+
+    for (MemoryIndex stripe = 0; stripe < stripeCount; ++stripe)
+    {
+        __m256i *secret = (__m256i *)(globalHashSecret + stripeIndex + stripe);
+        __m256i *source = (__m256i *)data;
+
+#define HASH_ACCUMULATE_AVX2(acc, index)                                                                               \
+    {                                                                                                                  \
+        __m256i value   = _mm256_loadu_si256(source + index);                                                          \
+        __m256i key     = _mm256_xor_si256(value, _mm256_loadu_si256(secret + index));                                 \
+        __m256i product = _mm256_mul_epu32(key, _mm256_srli_epi64(key, 32));                                           \
+        acc             = _mm256_add_epi64(acc, _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));                 \
+        acc             = _mm256_add_epi64(acc, product);                                                              \
+    }
+
+        HASH_ACCUMULATE_AVX2(acc0, 0);
+        HASH_ACCUMULATE_AVX2(acc1, 1);
+
+#undef HASH_ACCUMULATE_AVX2
+
+        data += HASH_STRIPE_SIZE;
+    }
+
+    _mm256_storeu_si256((__m256i *)accumulators + 0, acc0);
+    _mm256_storeu_si256((__m256i *)accumulators + 1, acc1);
+}
+
+// NOTE once a block, so there is no point doing it any faster.
+inline void ScrambleHashAccumulators(uint64 *accumulators)
+{
+    uint64 *secret = globalHashSecret + HASH_BLOCK_STRIPE_COUNT;
+
+    for (uint32 lane = 0; lane < HASH_ACCUMULATOR_COUNT; ++lane)
+    {
+        uint64 accumulator = accumulators[lane];
+        accumulator ^= accumulator >> 47;
+        accumulator ^= secret[lane];
+        accumulator *= HASH_PRIME32_1;
+
+        accumulators[lane] = accumulator;
+    }
+}
+
+internal void AccumulateHashStripes(HashStream *stream, uint8 *data, MemoryIndex stripeCount)
+{
+    HexBatchPath path = GetHexBatchPath();
+
+    while (stripeCount)
+    {
+        MemoryIndex blockStripeCount = HASH_BLOCK_STRIPE_COUNT - stream->stripeIndex;
+        if (blockStripeCount > stripeCount)
+        {
+            blockStripeCount = stripeCount;
+        }
+
+        if (path == HEX_BATCH_AVX2)
+        {
+            AccumulateHashStripesAvx2(stream->accumulators, data, blockStripeCount, stream->stripeIndex);
+        }
+        else if (path == HEX_BATCH_SSE2)
+        {
+            AccumulateHashStripesSse2(stream->accumulators, data, blockStripeCount, stream->stripeIndex);
+        }
+        else
+        {
+            AccumulateHashStripesScalar(stream->accumulators, data, blockStripeCount, stream->stripeIndex);
+        }
+
+        data += blockStripeCount * HASH_STRIPE_SIZE;
+        stripeCount -= blockStripeCount;
+        stream->stripeIndex += (uint32)blockStripeCount;
+
+        if (stream->stripeIndex == HASH_BLOCK_STRIPE_COUNT)
+        {
+            ScrambleHashAccumulators(stream->accumulators);
+            stream->stripeIndex = 0;
+        }
+    }
+}
+
+internal void BeginHash(HashStream *stream)
+{
+    if (!globalHashSecret[0])
+    {
+        InitializeHashSecret();
+    }
+
+    stream->accumulators[0] = HASH_PRIME32_3;
+    stream->accumulators[1] = HASH_PRIME64_1;
+    stream->accumulators[2] = HASH_PRIME64_2;
+    stream->accumulators[3] = HASH_PRIME64_3;
+    stream->accumulators[4] = HASH_PRIME64_4;
+    stream->accumulators[5] = HASH_PRIME32_2;
+    stream->accumulators[6] = HASH_PRIME64_5;
+    stream->accumulators[7] = HASH_PRIME32_1;
+
+    stream->stripeIndex  = 0;
+    stream->bufferedSize = 0;
+    stream->totalSize    = 0;
+}
+
+// NOTE the hash only depends on the bytes that went in, not on how they were split up between calls.
+internal void AddHash(HashStream *stream, void *data, MemoryIndex size)
+{
+    uint8 *at = (uint8 *)data;
+    stream->totalSize += size;
+
+    if (stream->bufferedSize)
+    {
+        MemoryIndex copySize = HASH_STRIPE_SIZE - stream->bufferedSize;
+        if (copySize > size)
+        {
+            copySize = size;
+        }
+
+        memcpy(stream->buffer + stream->bufferedSize, at, copySize);
+        stream->bufferedSize += (uint32)copySize;
+        at += copySize;
+        size -= copySize;
+
+        if (stream->bufferedSize == HASH_STRIPE_SIZE)
+        {
+            AccumulateHashStripes(stream, stream->buffer, 1);
+            stream->bufferedSize = 0;
+        }
+    }
+
+    MemoryIndex stripeCount = size / HASH_STRIPE_SIZE;
+    if (stripeCount)
+    {
+        AccumulateHashStripes(stream, at, stripeCount);
+        at += stripeCount * HASH_STRIPE_SIZE;
+        size -= stripeCount * HASH_STRIPE_SIZE;
+    }
+
+    if (size)
+    {
+        memcpy(stream->buffer + stream->bufferedSize, at, size);
+        stream->bufferedSize += (uint32)size;
+    }
+}
+
+// NOTE leaves the stream as it was, so it can be hashed further.
+internal uint64 EndHash(HashStream *stream)
+{
+    HashStream last = *stream;
+
+    if (last.bufferedSize)
+    {
+        memset(last.buffer + last.bufferedSize, 0, HASH_STRIPE_SIZE - last.bufferedSize);
+        AccumulateHashStripes(&last, last.buffer, 1);
+    }
+
+    uint64 result = last.totalSize * HASH_PRIME64_1;
+    for (uint32 lane = 0; lane < HASH_ACCUMULATOR_COUNT; lane += 2)
+    {
+        result += HashMultiplyFold(last.accumulators[lane] ^ globalHashSecret[lane],
+                                   last.accumulators[lane + 1] ^ globalHashSecret[lane + 1]);
+    }
+
+    result = HashAvalanche(result);
+    return result;
+}
+
+internal uint64 Hash64(void *data, MemoryIndex size)
+{
+    HashStream stream;
+    BeginHash(&stream);
+    AddHash(&stream, data, size);
+
+    uint64 result = EndHash(&stream);
+    return result;
+}
+
+inline MemoryIndex GetWorldHashSize(World *world)
+{
+    MemoryIndex chunkCount = (MemoryIndex)((world->width + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT) *
+                             ((world->height + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT);
+
+    MemoryIndex result = sizeof(WorldHash) + chunkCount * (sizeof(uint64) + sizeof(uint8) + sizeof(uint32));
+    return result;
+}
+
+inline bool32 WorldHashFitsInArena(MemoryArena *arena, World *world)
+{
+    bool32 result = arena->used + GetWorldHashSize(world) <= arena->size;
+    return result;
+}
+
+inline uint64 GetWorldHashChunkPart(uint32 chunkIndex, uint64 chunkHash)
+{
+    uint64 result = chunkHash ? HashAvalanche(chunkHash + chunkIndex * HASH_PRIME64_2) : 0;
+    return result;
+}
+
+internal uint64 HashWorldChunk(WorldHash *hash, World *world, uint32 chunkIndex)
+{
+    int32 minX = (chunkIndex % hash->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 minY = (chunkIndex / hash->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 maxX = Min(world->width, minX + WORLD_CHUNK_DIM);
+    int32 maxY = Min(world->height, minY + WORLD_CHUNK_DIM);
+
+    HashStream stream;
+    BeginHash(&stream);
+
+    for (int32 y = minY; y < maxY; ++y)
+    {
+        Cell *row = GetCellRow(world, y) + minX;
+        AddHash(&stream, row, (maxX - minX) * sizeof(Cell));
+    }
+
+    uint64 result = EndHash(&stream);
+    return result;
+}
+
+internal void InitializeWorldHash(WorldHash *hash, MemoryArena *arena, World *world)
+{
+    hash->width       = world->width;
+    hash->height      = world->height;
+    hash->chunkCountX = (world->width + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+    hash->chunkCountY = (world->height + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+
+    uint32 chunkCount = (uint32)(hash->chunkCountX * hash->chunkCountY);
+
+    hash->chunkHashes     = PushArray(arena, chunkCount, uint64);
+    hash->dirtyFlags      = PushArray(arena, chunkCount, uint8);
+    hash->dirtyChunks     = PushArray(arena, chunkCount, uint32);
+    hash->dirtyChunkCount = 0;
+    hash->cellHash        = 0;
+
+    hash->lastUpdateCycles = 0;
+    hash->lastChunkCount   = 0;
+
+    memset(hash->dirtyFlags, 0, chunkCount * sizeof(uint8));
+
+    // NOTE hashing every chunk of a paged world would page all of it in.
+    for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+    {
+        uint64 chunkHash = world->pager ? 0 : HashWorldChunk(hash, world, chunkIndex);
+
+        hash->chunkHashes[chunkIndex] = chunkHash;
+        hash->cellHash += GetWorldHashChunkPart(chunkIndex, chunkHash);
+    }
+}
+
+inline void MarkWorldHashDirty(WorldHash *hash, int32 y, int32 minX, int32 maxX)
+{
+    for (int32 chunkX = minX >> WORLD_CHUNK_SHIFT; chunkX <= (maxX >> WORLD_CHUNK_SHIFT); ++chunkX)
+    {
+        uint32 chunkIndex = (y >> WORLD_CHUNK_SHIFT) * hash->chunkCountX + chunkX;
+
+        if (!hash->dirtyFlags[chunkIndex])
+        {
+            hash->dirtyFlags[chunkIndex]               = true;
+            hash->dirtyChunks[hash->dirtyChunkCount++] = chunkIndex;
+        }
+    }
+}
+
+internal void UpdateWorldHash(WorldHash *hash, World *world)
+{
+    uint64 startCycles = __rdtsc();
+
+    for (uint32 dirtyIndex = 0; dirtyIndex < hash->dirtyChunkCount; ++dirtyIndex)
+    {
+        uint32 chunkIndex = hash->dirtyChunks[dirtyIndex];
+        uint64 chunkHash  = HashWorldChunk(hash, world, chunkIndex);
+
+        hash->cellHash -= GetWorldHashChunkPart(chunkIndex, hash->chunkHashes[chunkIndex]);
+        hash->cellHash += GetWorldHashChunkPart(chunkIndex, chunkHash);
+
+        hash->chunkHashes[chunkIndex] = chunkHash;
+        hash->dirtyFlags[chunkIndex]  = false;
+    }
+
+    hash->lastChunkCount   = hash->dirtyChunkCount;
+    hash->lastUpdateCycles = __rdtsc() - startCycles;
+    hash->dirtyChunkCount  = 0;
+}
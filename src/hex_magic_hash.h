@@ -0,0 +1,60 @@
+#if !defined(HEX_MAGIC_HASH)
+
+#include "hex_magic_platform.h"
+
+// NOTE a fast 64 bit hash, built the same way as XXH3 but not compatible with it. Data goes through in stripes of 64
+// bytes, one 8 byte word per accumulator: every word is mixed with the secret, its two halves multiplied together and
+// added to its accumulator, while the word as it is goes to its neighbour. Every HASH_BLOCK_STRIPE_COUNT stripes the
+// accumulators get scrambled, and the hash is what they fold down to with the length at the end.
+//
+// None of that ever carries across accumulators within a block, so it is done for two, four or eight of them at a
+// time with SIMD and every path comes out with the same hash. Hashes only have to match between builds of the same
+// code, to tell whether two runs did the same thing.
+
+#define HASH_ACCUMULATOR_COUNT 8
+#define HASH_STRIPE_SIZE (HASH_ACCUMULATOR_COUNT * sizeof(uint64))
+#define HASH_BLOCK_STRIPE_COUNT 16
+
+// NOTE a stripe uses HASH_ACCUMULATOR_COUNT words of the secret starting at its place in the block, and the
+// scramble uses the ones after the last stripe.
+#define HASH_SECRET_COUNT (HASH_BLOCK_STRIPE_COUNT + HASH_ACCUMULATOR_COUNT)
+
+struct HashStream
+{
+    uint64 accumulators[HASH_ACCUMULATOR_COUNT];
+
+    // NOTE stripes done since the last scramble.
+    uint32 stripeIndex;
+
+    uint32 bufferedSize;
+    uint8 buffer[HASH_STRIPE_SIZE];
+
+    uint64 totalSize;
+};
+
+// NOTE the state of the world is hashed chunk by chunk, so an edit only has to rehash the chunks it touched. The hash
+// of the cells is a sum over the chunks, which lets a chunk swap its old part for the new one without looking at any
+// other. Chunks of a paged world count as 0 for as long as they are what the map file says they are.
+struct WorldHash
+{
+    int32 width;
+    int32 height;
+
+    int32 chunkCountX;
+    int32 chunkCountY;
+
+    uint64 *chunkHashes;
+    uint8 *dirtyFlags;
+
+    uint32 dirtyChunkCount;
+    uint32 *dirtyChunks;
+
+    uint64 cellHash;
+
+    // NOTE stats of the last update.
+    uint64 lastUpdateCycles;
+    uint32 lastChunkCount;
+};
+
+#define HEX_MAGIC_HASH
+#endif
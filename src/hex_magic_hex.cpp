@@ -2,6 +2,12 @@
 #include "hex_magic_hex.h"
 #include "hex_magic_intrinsics.h"
 
+global HexCoord globalHexDirections[6] = {{1, 0, -1}, {1, -1, 0}, {0, -1, 1}, {-1, 0, 1}, {-1, 1, 0}, {0, 1, -1}};
+
+// NOTE the same six directions in offset coordinates, for even and odd rows. Opposite directions are 3 apart.
+global OffsetCoord globalOffsetDirections[2][6] = {{{1, 0}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}, {0, 1}},
+                                                   {{1, 0}, {1, -1}, {0, -1}, {-1, 0}, {0, 1}, {1, 1}}};
+
 internal HexCoord HexFromOffset(OffsetCoord coord)
 {
     HexCoord result;
@@ -51,6 +57,17 @@ internal HexCoord RoundHex(HexCoordF hex)
     return HexCoord{q, r, s};
 }
 
+inline HexCoordF Lerp(HexCoordF a, HexCoordF b, real32 t)
+{
+    HexCoordF result;
+
+    result.q = a.q + (b.q - a.q) * t;
+    result.r = a.r + (b.r - a.r) * t;
+    result.s = a.s + (b.s - a.s) * t;
+
+    return result;
+}
+
 internal HexCoord V2ToHex(V2 pos)
 {
     HexCoordF result;
@@ -115,3 +132,200 @@ inline uint32 Distance(HexCoord a, HexCoord b)
     uint32 result = (Abs(vec.q) + Abs(vec.r) + Abs(vec.s)) / 2;
     return result;
 }
+
+// NOTE returns cell step of the stepCount + 1 cells on the line from a to b. The line is walked relative to a so
+// floats stay small on big maps, and nudged off the edges between cells so ties always round the same way.
+internal HexCoord HexLinePoint(HexCoord a, HexCoord b, uint32 step, uint32 stepCount)
+{
+    HexCoordF from = {1e-6f, 2e-6f, -3e-6f};
+    HexCoordF to   = {(real32)(b.q - a.q) + 1e-6f, (real32)(b.r - a.r) + 2e-6f, (real32)(b.s - a.s) - 3e-6f};
+    real32 t       = stepCount ? (real32)step / (real32)stepCount : 0.0f;
+
+    HexCoord result = a + RoundHex(Lerp(from, to, t));
+    return result;
+}
+
+inline OffsetCoord OffsetNeighbour(OffsetCoord coord, uint32 direction)
+{
+    OffsetCoord step   = globalOffsetDirections[coord.y & 1][direction];
+    OffsetCoord result = {coord.x + step.x, coord.y + step.y};
+
+    return result;
+}
+
+inline bool32 IsInHexMask(HexMask *mask, HexCoord hex)
+{
+    bool32 result = false;
+
+    int32 q = hex.q - mask->minQ;
+    int32 r = hex.r - mask->minR;
+
+    if (q >= 0 && r >= 0 && q < mask->dim && r < mask->dim)
+    {
+        uint32 index = r * mask->dim + q;
+        result       = (mask->bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    return result;
+}
+
+// NOTE row r of the hexagon holds q from Max(-radius, -r - radius) to Min(radius, -r + radius), and in offset
+// coordinates that is the run of x from q + (y >> 1) on, since (y - parity) / 2 is y >> 1.
+inline void SetHexSpan(HexSpanIterator *it, int32 r)
+{
+    int32 minQ = r > 0 ? -it->radius : -r - it->radius;
+    int32 maxQ = r > 0 ? -r + it->radius : it->radius;
+
+    it->y    = it->center.r + r;
+    it->minX = it->center.q + minQ + (it->y >> 1);
+    it->maxX = it->center.q + maxQ + (it->y >> 1);
+
+    if (it->minX < it->boundsMinX)
+    {
+        it->minX = it->boundsMinX;
+    }
+
+    if (it->maxX > it->boundsMaxX)
+    {
+        it->maxX = it->boundsMaxX;
+    }
+}
+
+inline void NextHexSpan(HexSpanIterator *it)
+{
+    do
+    {
+        int32 r = it->y + 1 - it->center.r;
+        if (r > it->radius || it->y + 1 > it->boundsMaxY)
+        {
+            it->isDone = true;
+            break;
+        }
+
+        SetHexSpan(it, r);
+    } while (it->minX > it->maxX);
+}
+
+internal HexSpanIterator BeginHexSpans(HexCoord center, int32 radius, int32 boundsMinX, int32 boundsMinY,
+                                       int32 boundsMaxX, int32 boundsMaxY)
+{
+    HexSpanIterator result;
+
+    result.center     = center;
+    result.radius     = radius;
+    result.boundsMinX = boundsMinX;
+    result.boundsMinY = boundsMinY;
+    result.boundsMaxX = boundsMaxX;
+    result.boundsMaxY = boundsMaxY;
+    result.isDone     = false;
+
+    // NOTE starts a row above the first one that is in bounds, and lets NextHexSpan find the first that isn't empty.
+    int32 firstR = -radius;
+    if (center.r + firstR < boundsMinY)
+    {
+        firstR = boundsMinY - center.r;
+    }
+
+    result.y = center.r + firstR - 1;
+    NextHexSpan(&result);
+
+    return result;
+}
+
+internal HexRingIterator BeginHexRing(HexCoord center, int32 radius)
+{
+    HexRingIterator result;
+
+    result.radius = radius;
+    result.side   = 0;
+    result.step   = 0;
+    result.hex    = center + radius * globalHexDirections[4];
+    result.offset = OffsetFromHex(result.hex);
+    result.index  = 0;
+    result.isDone = false;
+
+    return result;
+}
+
+inline void NextHexRing(HexRingIterator *it)
+{
+    if (it->radius == 0)
+    {
+        it->isDone = true;
+    }
+    else
+    {
+        it->hex    = it->hex + globalHexDirections[it->side];
+        it->offset = OffsetNeighbour(it->offset, it->side);
+        ++it->index;
+
+        if (++it->step == it->radius)
+        {
+            it->step = 0;
+            if (++it->side == 6)
+            {
+                it->isDone = true;
+            }
+        }
+    }
+}
+
+internal HexSpiralIterator BeginHexSpiral(HexCoord center, int32 radius)
+{
+    HexSpiralIterator result;
+
+    result.center    = center;
+    result.maxRadius = radius;
+    result.ring      = BeginHexRing(center, 0);
+    result.hex       = result.ring.hex;
+    result.offset    = result.ring.offset;
+    result.isDone    = false;
+
+    return result;
+}
+
+internal void NextHexSpiral(HexSpiralIterator *it)
+{
+    NextHexRing(&it->ring);
+
+    if (it->ring.isDone)
+    {
+        if (it->ring.radius < it->maxRadius)
+        {
+            it->ring = BeginHexRing(it->center, it->ring.radius + 1);
+        }
+        else
+        {
+            it->isDone = true;
+        }
+    }
+
+    it->hex    = it->ring.hex;
+    it->offset = it->ring.offset;
+}
+
+internal HexLineIterator BeginHexLine(HexCoord from, HexCoord to)
+{
+    HexLineIterator result;
+
+    result.from      = from;
+    result.to        = to;
+    result.step      = 0;
+    result.stepCount = Distance(from, to);
+    result.hex       = from;
+    result.isDone    = false;
+
+    return result;
+}
+
+internal void NextHexLine(HexLineIterator *it)
+{
+    if (it->step == it->stepCount)
+    {
+        it->isDone = true;
+    }
+    else
+    {
+        it->hex = HexLinePoint(it->from, it->to, ++it->step, it->stepCount);
+    }
+}
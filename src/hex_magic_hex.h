@@ -18,5 +18,113 @@ struct OffsetCoord
     int32 x, y;
 };
 
+// NOTE a set of cells within the parallelogram of dim by dim cells starting at minQ, minR, one bit per cell.
+struct HexMask
+{
+    int32 minQ;
+    int32 minR;
+    int32 dim;
+
+    uint64 *bits;
+};
+
+// NOTE iterators over the cells around a center, used as
+//
+//     for (HexRingIterator it = BeginHexRing(center, radius); !it.isDone; NextHexRing(&it))
+//
+// They keep the offset coordinates of the cell they are at up to date as they go, from the row parity and the
+// neighbour tables, so nothing converts between hex and offset coordinates per cell.
+
+// NOTE the rows of a hexagon as spans of offset coordinates, top to bottom, clipped to the given bounds. Rows that
+// are clipped away entirely are skipped.
+struct HexSpanIterator
+{
+    HexCoord center;
+    int32 radius;
+
+    int32 boundsMinX;
+    int32 boundsMinY;
+    int32 boundsMaxX;
+    int32 boundsMaxY;
+
+    int32 y;
+    int32 minX;
+    int32 maxX;
+    bool32 isDone;
+};
+
+// NOTE the cells at exactly radius steps from the center, starting from the corner in direction 4 and going round in
+// direction order. Index is how far round the ring the cell is, out of 6 * radius.
+struct HexRingIterator
+{
+    int32 radius;
+    uint32 side;
+    int32 step;
+
+    HexCoord hex;
+    OffsetCoord offset;
+    int32 index;
+    bool32 isDone;
+};
+
+// NOTE the center and then every ring out to the radius.
+struct HexSpiralIterator
+{
+    HexCoord center;
+    int32 maxRadius;
+    HexRingIterator ring;
+
+    HexCoord hex;
+    OffsetCoord offset;
+    bool32 isDone;
+};
+
+// NOTE the Distance(from, to) + 1 cells on the line from one cell to the other, both included.
+struct HexLineIterator
+{
+    HexCoord from;
+    HexCoord to;
+    uint32 step;
+    uint32 stepCount;
+
+    HexCoord hex;
+    bool32 isDone;
+};
+
+// NOTE structure of arrays views for the batched conversions, where element i of each array belongs to coordinate i.
+struct OffsetCoordBatch
+{
+    int32 *x;
+    int32 *y;
+};
+
+struct HexCoordBatch
+{
+    int32 *q;
+    int32 *r;
+    int32 *s;
+};
+
+struct HexCoordFBatch
+{
+    real32 *q;
+    real32 *r;
+    real32 *s;
+};
+
+struct V2Batch
+{
+    real32 *x;
+    real32 *y;
+};
+
+enum HexBatchPath
+{
+    HEX_BATCH_UNKNOWN,
+    HEX_BATCH_SCALAR,
+    HEX_BATCH_SSE2,
+    HEX_BATCH_AVX2,
+};
+
 #define HEX_MAGIC_HEX
 #endif
@@ -0,0 +1,447 @@
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_intrinsics.h"
+
+// NOTE the conversions of hex_magic_hex.cpp over whole arrays at once, four at a time with SSE2 or eight at a time
+// with AVX2, and whatever is left over one at a time. They do the same float operations in the same order as the one
+// at a time versions, and round halves away from zero like roundf does, so they give bit for bit the same results for
+// anything that fits in an int32. The hex bench checks that.
+//
+// SSE2 comes with every x86-64 CPU, AVX2 is only used when the CPU running the game has it.
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+// NOTE picked the first time anything is converted. Setting it before then forces a path.
+global HexBatchPath globalHexBatchPath = HEX_BATCH_UNKNOWN;
+
+inline HexBatchPath GetHexBatchPath()
+{
+    if (globalHexBatchPath == HEX_BATCH_UNKNOWN)
+    {
+        __builtin_cpu_init();
+        globalHexBatchPath = __builtin_cpu_supports("avx2") ? HEX_BATCH_AVX2 : HEX_BATCH_SSE2;
+    }
+
+    return globalHexBatchPath;
+}
+
+//
+// NOTE SSE2
+//
+
+inline __m128i SelectSse2(__m128i mask, __m128i ifSet, __m128i ifClear)
+{
+    __m128i result = _mm_or_si128(_mm_and_si128(mask, ifSet), _mm_andnot_si128(mask, ifClear));
+    return result;
+}
+
+inline __m128 AbsSse2(__m128 value)
+{
+    __m128 result = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+    return result;
+}
+
+// NOTE truncating leaves a fraction that is exact, and a fraction of a half or more takes one more step away from
+// zero, which is what roundf does without the branches.
+inline __m128i RoundSse2(__m128 value)
+{
+    __m128i truncated   = _mm_cvttps_epi32(value);
+    __m128 fraction     = _mm_sub_ps(value, _mm_cvtepi32_ps(truncated));
+    __m128 isHalfOrMore = _mm_cmpge_ps(AbsSse2(fraction), _mm_set1_ps(0.5f));
+    __m128i step        = _mm_or_si128(_mm_srai_epi32(_mm_castps_si128(value), 31), _mm_set1_epi32(1));
+
+    __m128i result = _mm_add_epi32(truncated, _mm_and_si128(_mm_castps_si128(isHalfOrMore), step));
+    return result;
+}
+
+inline void RoundHexSse2(__m128 hexQ, __m128 hexR, __m128 hexS, __m128i *outQ, __m128i *outR, __m128i *outS)
+{
+    __m128i q = RoundSse2(hexQ);
+    __m128i r = RoundSse2(hexR);
+    __m128i s = RoundSse2(hexS);
+
+    __m128 qDiff = AbsSse2(_mm_sub_ps(_mm_cvtepi32_ps(q), hexQ));
+    __m128 rDiff = AbsSse2(_mm_sub_ps(_mm_cvtepi32_ps(r), hexR));
+    __m128 sDiff = AbsSse2(_mm_sub_ps(_mm_cvtepi32_ps(s), hexS));
+
+    __m128i fixQ = _mm_castps_si128(_mm_and_ps(_mm_cmpgt_ps(qDiff, rDiff), _mm_cmpgt_ps(qDiff, sDiff)));
+    __m128i fixR = _mm_andnot_si128(fixQ, _mm_castps_si128(_mm_cmpgt_ps(rDiff, sDiff)));
+    __m128i fixS = _mm_andnot_si128(_mm_or_si128(fixQ, fixR), _mm_set1_epi32(-1));
+
+    __m128i zero = _mm_setzero_si128();
+
+    *outQ = SelectSse2(fixQ, _mm_sub_epi32(_mm_sub_epi32(zero, r), s), q);
+    *outR = SelectSse2(fixR, _mm_sub_epi32(_mm_sub_epi32(zero, q), s), r);
+    *outS = SelectSse2(fixS, _mm_sub_epi32(_mm_sub_epi32(zero, q), r), s);
+}
+
+internal uint32 HexFromOffsetSse2(OffsetCoordBatch in, HexCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    for (; index + 4 <= count; index += 4)
+    {
+        __m128i x = _mm_loadu_si128((__m128i *)(in.x + index));
+        __m128i y = _mm_loadu_si128((__m128i *)(in.y + index));
+
+        // NOTE (y - parity) / 2 is an arithmetic shift, whatever the sign of y.
+        __m128i q = _mm_sub_epi32(x, _mm_srai_epi32(y, 1));
+        __m128i s = _mm_sub_epi32(_mm_sub_epi32(_mm_setzero_si128(), q), y);
+
+        _mm_storeu_si128((__m128i *)(out.q + index), q);
+        _mm_storeu_si128((__m128i *)(out.r + index), y);
+        _mm_storeu_si128((__m128i *)(out.s + index), s);
+    }
+
+    return index;
+}
+
+internal uint32 OffsetFromHexSse2(HexCoordBatch in, OffsetCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    for (; index + 4 <= count; index += 4)
+    {
+        __m128i q = _mm_loadu_si128((__m128i *)(in.q + index));
+        __m128i r = _mm_loadu_si128((__m128i *)(in.r + index));
+
+        _mm_storeu_si128((__m128i *)(out.x + index), _mm_add_epi32(q, _mm_srai_epi32(r, 1)));
+        _mm_storeu_si128((__m128i *)(out.y + index), r);
+    }
+
+    return index;
+}
+
+internal uint32 HexToV2Sse2(HexCoordBatch in, V2Batch out, uint32 count)
+{
+    uint32 index = 0;
+
+    __m128 sqrt3     = _mm_set1_ps(Sqrt(3));
+    __m128 halfSqrt3 = _mm_set1_ps(Sqrt(3) / 2.0f);
+    __m128 yScale    = _mm_set1_ps(1.5f);
+
+    for (; index + 4 <= count; index += 4)
+    {
+        __m128 q = _mm_cvtepi32_ps(_mm_loadu_si128((__m128i *)(in.q + index)));
+        __m128 r = _mm_cvtepi32_ps(_mm_loadu_si128((__m128i *)(in.r + index)));
+
+        _mm_storeu_ps(out.x + index, _mm_add_ps(_mm_mul_ps(sqrt3, q), _mm_mul_ps(halfSqrt3, r)));
+        _mm_storeu_ps(out.y + index, _mm_mul_ps(yScale, r));
+    }
+
+    return index;
+}
+
+internal uint32 RoundHexSse2(HexCoordFBatch in, HexCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    for (; index + 4 <= count; index += 4)
+    {
+        __m128i q, r, s;
+        RoundHexSse2(_mm_loadu_ps(in.q + index), _mm_loadu_ps(in.r + index), _mm_loadu_ps(in.s + index), &q, &r, &s);
+
+        _mm_storeu_si128((__m128i *)(out.q + index), q);
+        _mm_storeu_si128((__m128i *)(out.r + index), r);
+        _mm_storeu_si128((__m128i *)(out.s + index), s);
+    }
+
+    return index;
+}
+
+internal uint32 V2ToHexSse2(V2Batch in, HexCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    __m128 qFromX   = _mm_set1_ps(Sqrt(3) / 3.0f);
+    __m128 qFromY   = _mm_set1_ps(1.0f / 3.0f);
+    __m128 rFromY   = _mm_set1_ps(2.0f / 3.0f);
+    __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+
+    for (; index + 4 <= count; index += 4)
+    {
+        __m128 x = _mm_loadu_ps(in.x + index);
+        __m128 y = _mm_loadu_ps(in.y + index);
+
+        __m128 hexQ = _mm_sub_ps(_mm_mul_ps(qFromX, x), _mm_mul_ps(qFromY, y));
+        __m128 hexR = _mm_mul_ps(rFromY, y);
+        __m128 hexS = _mm_sub_ps(_mm_xor_ps(hexQ, signMask), hexR);
+
+        __m128i q, r, s;
+        RoundHexSse2(hexQ, hexR, hexS, &q, &r, &s);
+
+        _mm_storeu_si128((__m128i *)(out.q + index), q);
+        _mm_storeu_si128((__m128i *)(out.r + index), r);
+        _mm_storeu_si128((__m128i *)(out.s + index), s);
+    }
+
+    return index;
+}
+
+//
+// NOTE AVX2
+//
+
+TARGET_AVX2 inline __m256 AbsAvx2(__m256 value)
+{
+    __m256 result = _mm256_and_ps(value, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)));
+    return result;
+}
+
+TARGET_AVX2 inline __m256i RoundAvx2(__m256 value)
+{
+    __m256i truncated   = _mm256_cvttps_epi32(value);
+    __m256 fraction     = _mm256_sub_ps(value, _mm256_cvtepi32_ps(truncated));
+    __m256 isHalfOrMore = _mm256_cmp_ps(AbsAvx2(fraction), _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+    __m256i step        = _mm256_or_si256(_mm256_srai_epi32(_mm256_castps_si256(value), 31), _mm256_set1_epi32(1));
+
+    __m256i result = _mm256_add_epi32(truncated, _mm256_and_si256(_mm256_castps_si256(isHalfOrMore), step));
+    return result;
+}
+
+TARGET_AVX2 inline void RoundHexAvx2(__m256 hexQ, __m256 hexR, __m256 hexS, __m256i *outQ, __m256i *outR,
+                                     __m256i *outS)
+{
+    __m256i q = RoundAvx2(hexQ);
+    __m256i r = RoundAvx2(hexR);
+    __m256i s = RoundAvx2(hexS);
+
+    __m256 qDiff = AbsAvx2(_mm256_sub_ps(_mm256_cvtepi32_ps(q), hexQ));
+    __m256 rDiff = AbsAvx2(_mm256_sub_ps(_mm256_cvtepi32_ps(r), hexR));
+    __m256 sDiff = AbsAvx2(_mm256_sub_ps(_mm256_cvtepi32_ps(s), hexS));
+
+    __m256 fixQ = _mm256_and_ps(_mm256_cmp_ps(qDiff, rDiff, _CMP_GT_OQ), _mm256_cmp_ps(qDiff, sDiff, _CMP_GT_OQ));
+    __m256 fixR = _mm256_andnot_ps(fixQ, _mm256_cmp_ps(rDiff, sDiff, _CMP_GT_OQ));
+    __m256 fixS = _mm256_andnot_ps(_mm256_or_ps(fixQ, fixR), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+
+    __m256i zero = _mm256_setzero_si256();
+
+    *outQ = _mm256_blendv_epi8(q, _mm256_sub_epi32(_mm256_sub_epi32(zero, r), s), _mm256_castps_si256(fixQ));
+    *outR = _mm256_blendv_epi8(r, _mm256_sub_epi32(_mm256_sub_epi32(zero, q), s), _mm256_castps_si256(fixR));
+    *outS = _mm256_blendv_epi8(s, _mm256_sub_epi32(_mm256_sub_epi32(zero, q), r), _mm256_castps_si256(fixS));
+}
+
+TARGET_AVX2 internal uint32 HexFromOffsetAvx2(OffsetCoordBatch in, HexCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    for (; index + 8 <= count; index += 8)
+    {
+        __m256i x = _mm256_loadu_si256((__m256i *)(in.x + index));
+        __m256i y = _mm256_loadu_si256((__m256i *)(in.y + index));
+
+        __m256i q = _mm256_sub_epi32(x, _mm256_srai_epi32(y, 1));
+        __m256i s = _mm256_sub_epi32(_mm256_sub_epi32(_mm256_setzero_si256(), q), y);
+
+        _mm256_storeu_si256((__m256i *)(out.q + index), q);
+        _mm256_storeu_si256((__m256i *)(out.r + index), y);
+        _mm256_storeu_si256((__m256i *)(out.s + index), s);
+    }
+
+    return index;
+}
+
+TARGET_AVX2 internal uint32 OffsetFromHexAvx2(HexCoordBatch in, OffsetCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    for (; index + 8 <= count; index += 8)
+    {
+        __m256i q = _mm256_loadu_si256((__m256i *)(in.q + index));
+        __m256i r = _mm256_loadu_si256((__m256i *)(in.r + index));
+
+        _mm256_storeu_si256((__m256i *)(out.x + index), _mm256_add_epi32(q, _mm256_srai_epi32(r, 1)));
+        _mm256_storeu_si256((__m256i *)(out.y + index), r);
+    }
+
+    return index;
+}
+
+TARGET_AVX2 internal uint32 HexToV2Avx2(HexCoordBatch in, V2Batch out, uint32 count)
+{
+    uint32 index = 0;
+
+    __m256 sqrt3     = _mm256_set1_ps(Sqrt(3));
+    __m256 halfSqrt3 = _mm256_set1_ps(Sqrt(3) / 2.0f);
+    __m256 yScale    = _mm256_set1_ps(1.5f);
+
+    for (; index + 8 <= count; index += 8)
+    {
+        __m256 q = _mm256_cvtepi32_ps(_mm256_loadu_si256((__m256i *)(in.q + index)));
+        __m256 r = _mm256_cvtepi32_ps(_mm256_loadu_si256((__m256i *)(in.r + index)));
+
+        _mm256_storeu_ps(out.x + index, _mm256_add_ps(_mm256_mul_ps(sqrt3, q), _mm256_mul_ps(halfSqrt3, r)));
+        _mm256_storeu_ps(out.y + index, _mm256_mul_ps(yScale, r));
+    }
+
+    return index;
+}
+
+TARGET_AVX2 internal uint32 RoundHexAvx2(HexCoordFBatch in, HexCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    for (; index + 8 <= count; index += 8)
+    {
+        __m256i q, r, s;
+        RoundHexAvx2(_mm256_loadu_ps(in.q + index), _mm256_loadu_ps(in.r + index), _mm256_loadu_ps(in.s + index), &q,
+                     &r, &s);
+
+        _mm256_storeu_si256((__m256i *)(out.q + index), q);
+        _mm256_storeu_si256((__m256i *)(out.r + index), r);
+        _mm256_storeu_si256((__m256i *)(out.s + index), s);
+    }
+
+    return index;
+}
+
+TARGET_AVX2 internal uint32 V2ToHexAvx2(V2Batch in, HexCoordBatch out, uint32 count)
+{
+    uint32 index = 0;
+
+    __m256 qFromX   = _mm256_set1_ps(Sqrt(3) / 3.0f);
+    __m256 qFromY   = _mm256_set1_ps(1.0f / 3.0f);
+    __m256 rFromY   = _mm256_set1_ps(2.0f / 3.0f);
+    __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+
+    for (; index + 8 <= count; index += 8)
+    {
+        __m256 x = _mm256_loadu_ps(in.x + index);
+        __m256 y = _mm256_loadu_ps(in.y + index);
+
+        __m256 hexQ = _mm256_sub_ps(_mm256_mul_ps(qFromX, x), _mm256_mul_ps(qFromY, y));
+        __m256 hexR = _mm256_mul_ps(rFromY, y);
+        __m256 hexS = _mm256_sub_ps(_mm256_xor_ps(hexQ, signMask), hexR);
+
+        __m256i q, r, s;
+        RoundHexAvx2(hexQ, hexR, hexS, &q, &r, &s);
+
+        _mm256_storeu_si256((__m256i *)(out.q + index), q);
+        _mm256_storeu_si256((__m256i *)(out.r + index), r);
+        _mm256_storeu_si256((__m256i *)(out.s + index), s);
+    }
+
+    return index;
+}
+
+//
+// NOTE batches
+//
+
+internal void HexFromOffsetBatch(OffsetCoordBatch in, HexCoordBatch out, uint32 count)
+{
+    HexBatchPath path = GetHexBatchPath();
+    uint32 index      = 0;
+
+    if (path == HEX_BATCH_AVX2)
+    {
+        index = HexFromOffsetAvx2(in, out, count);
+    }
+    else if (path == HEX_BATCH_SSE2)
+    {
+        index = HexFromOffsetSse2(in, out, count);
+    }
+
+    for (; index < count; ++index)
+    {
+        HexCoord hex = HexFromOffset({in.x[index], in.y[index]});
+
+        out.q[index] = hex.q;
+        out.r[index] = hex.r;
+        out.s[index] = hex.s;
+    }
+}
+
+internal void OffsetFromHexBatch(HexCoordBatch in, OffsetCoordBatch out, uint32 count)
+{
+    HexBatchPath path = GetHexBatchPath();
+    uint32 index      = 0;
+
+    if (path == HEX_BATCH_AVX2)
+    {
+        index = OffsetFromHexAvx2(in, out, count);
+    }
+    else if (path == HEX_BATCH_SSE2)
+    {
+        index = OffsetFromHexSse2(in, out, count);
+    }
+
+    for (; index < count; ++index)
+    {
+        OffsetCoord offset = OffsetFromHex({in.q[index], in.r[index], in.s[index]});
+
+        out.x[index] = offset.x;
+        out.y[index] = offset.y;
+    }
+}
+
+internal void HexToV2Batch(HexCoordBatch in, V2Batch out, uint32 count)
+{
+    HexBatchPath path = GetHexBatchPath();
+    uint32 index      = 0;
+
+    if (path == HEX_BATCH_AVX2)
+    {
+        index = HexToV2Avx2(in, out, count);
+    }
+    else if (path == HEX_BATCH_SSE2)
+    {
+        index = HexToV2Sse2(in, out, count);
+    }
+
+    for (; index < count; ++index)
+    {
+        V2 position = HexToV2({in.q[index], in.r[index], in.s[index]});
+
+        out.x[index] = position.x;
+        out.y[index] = position.y;
+    }
+}
+
+internal void RoundHexBatch(HexCoordFBatch in, HexCoordBatch out, uint32 count)
+{
+    HexBatchPath path = GetHexBatchPath();
+    uint32 index      = 0;
+
+    if (path == HEX_BATCH_AVX2)
+    {
+        index = RoundHexAvx2(in, out, count);
+    }
+    else if (path == HEX_BATCH_SSE2)
+    {
+        index = RoundHexSse2(in, out, count);
+    }
+
+    for (; index < count; ++index)
+    {
+        HexCoord hex = RoundHex({in.q[index], in.r[index], in.s[index]});
+
+        out.q[index] = hex.q;
+        out.r[index] = hex.r;
+        out.s[index] = hex.s;
+    }
+}
+
+internal void V2ToHexBatch(V2Batch in, HexCoordBatch out, uint32 count)
+{
+    HexBatchPath path = GetHexBatchPath();
+    uint32 index      = 0;
+
+    if (path == HEX_BATCH_AVX2)
+    {
+        index = V2ToHexAvx2(in, out, count);
+    }
+    else if (path == HEX_BATCH_SSE2)
+    {
+        index = V2ToHexSse2(in, out, count);
+    }
+
+    for (; index < count; ++index)
+    {
+        HexCoord hex = V2ToHex({in.x[index], in.y[index]});
+
+        out.q[index] = hex.q;
+        out.r[index] = hex.r;
+        out.s[index] = hex.s;
+    }
+}
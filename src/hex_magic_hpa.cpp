@@ -0,0 +1,797 @@
+#include "hex_magic.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_hpa.h"
+#include "hex_magic_path.h"
+#include "hex_magic_platform.h"
+
+inline uint32 GetHpaClusterIndex(HpaGraph *graph, int32 x, int32 y)
+{
+    uint32 result = (y >> WORLD_CHUNK_SHIFT) * graph->clusterCountX + (x >> WORLD_CHUNK_SHIFT);
+    return result;
+}
+
+inline void MarkHpaClusterDirty(HpaGraph *graph, uint32 clusterIndex)
+{
+    if (!(graph->clusterStates[clusterIndex] & HPA_CLUSTER_DIRTY))
+    {
+        graph->clusterStates[clusterIndex] |= HPA_CLUSTER_DIRTY;
+        graph->dirtyClusters[graph->dirtyClusterCount++] = clusterIndex;
+    }
+}
+
+inline void MarkHpaCellDirty(HpaGraph *graph, int32 x, int32 y)
+{
+    MarkHpaClusterDirty(graph, GetHpaClusterIndex(graph, x, y));
+}
+
+inline void MarkHpaSpanDirty(HpaGraph *graph, int32 y, int32 minX, int32 maxX)
+{
+    for (int32 x = minX & ~WORLD_CHUNK_MASK; x <= maxX; x += HPA_CLUSTER_DIM)
+    {
+        MarkHpaCellDirty(graph, x, y);
+    }
+}
+
+inline bool32 IsHpaGraphReady(HpaGraph *graph)
+{
+    bool32 result = !graph->isBuilding && !graph->dirtyClusterCount;
+    return result;
+}
+
+inline bool32 HpaGraphFitsInArena(MemoryArena *arena, World *world)
+{
+    MemoryIndex clusterCount = (MemoryIndex)((world->width + HPA_CLUSTER_DIM - 1) >> WORLD_CHUNK_SHIFT) *
+                               ((world->height + HPA_CLUSTER_DIM - 1) >> WORLD_CHUNK_SHIFT);
+    MemoryIndex searchSize   = sizeof(PathNode) + sizeof(PathHeapEntry);
+
+    MemoryIndex required = sizeof(HpaGraph) +
+                           clusterCount * (sizeof(HpaCluster) + 2 * sizeof(HpaBorder) + sizeof(uint8) +
+                                           2 * sizeof(uint32)) +
+                           (HPA_MAX_JOB_COUNT + 1) * HPA_CLUSTER_CELL_COUNT * searchSize +
+                           (clusterCount * HPA_MAX_CLUSTER_NODES + 2) * searchSize;
+    bool32 result        = arena->used + required <= arena->size;
+
+    return result;
+}
+
+// NOTE every cluster starts out dirty, the first UpdateHpaGraph builds the whole graph.
+internal void InitializeHpaGraph(HpaGraph *graph, MemoryArena *arena, World *world, PathCostTable *costs)
+{
+    graph->costs   = *costs;
+    graph->minCost = GetMinimumPathCost(costs);
+
+    graph->clusterCountX = (world->width + HPA_CLUSTER_DIM - 1) >> WORLD_CHUNK_SHIFT;
+    graph->clusterCountY = (world->height + HPA_CLUSTER_DIM - 1) >> WORLD_CHUNK_SHIFT;
+    graph->clusterCount  = graph->clusterCountX * graph->clusterCountY;
+
+    graph->clusters      = PushArray(arena, graph->clusterCount, HpaCluster);
+    graph->rightBorders  = PushArray(arena, graph->clusterCount, HpaBorder);
+    graph->bottomBorders = PushArray(arena, graph->clusterCount, HpaBorder);
+    graph->clusterStates = PushArray(arena, graph->clusterCount, uint8);
+    graph->dirtyClusters = PushArray(arena, graph->clusterCount, uint32);
+    graph->buildClusters = PushArray(arena, graph->clusterCount, uint32);
+
+    memset(graph->clusters, 0, graph->clusterCount * sizeof(HpaCluster));
+    memset(graph->rightBorders, 0, graph->clusterCount * sizeof(HpaBorder));
+    memset(graph->bottomBorders, 0, graph->clusterCount * sizeof(HpaBorder));
+    memset(graph->clusterStates, 0, graph->clusterCount * sizeof(uint8));
+
+    for (uint32 jobIndex = 0; jobIndex < HPA_MAX_JOB_COUNT; ++jobIndex)
+    {
+        HpaBuildJob *job = graph->jobs + jobIndex;
+        InitializePathfinder(&job->search, arena, HPA_CLUSTER_CELL_COUNT);
+        memset(job->grid.isTarget, 0, sizeof(job->grid.isTarget));
+    }
+
+    InitializePathfinder(&graph->abstractSearch, arena, graph->clusterCount * HPA_MAX_CLUSTER_NODES + 2);
+    InitializePathfinder(&graph->localSearch, arena, HPA_CLUSTER_CELL_COUNT);
+    memset(graph->localGrid.isTarget, 0, sizeof(graph->localGrid.isTarget));
+
+    graph->dirtyClusterCount     = 0;
+    graph->isBuilding            = false;
+    graph->jobsRemaining         = 0;
+    graph->buildClusterCount     = 0;
+    graph->lastBuildClusterCount = 0;
+    graph->lastBuildCycles       = 0;
+    graph->expandedCount         = 0;
+
+    for (uint32 clusterIndex = 0; clusterIndex < graph->clusterCount; ++clusterIndex)
+    {
+        MarkHpaClusterDirty(graph, clusterIndex);
+    }
+}
+
+inline uint8 GetHpaEntryCost(HpaGraph *graph, World *world, int32 x, int32 y)
+{
+    Cell *cell   = GetCell(world, OffsetCoord{x, y});
+    uint8 result = cell ? graph->costs.costs[cell->biome] : 0;
+
+    return result;
+}
+
+inline void AddHpaTransition(HpaBorder *border, int32 offset)
+{
+    // NOTE a border broken up into more entrances than this loses the rest, routes through them get longer.
+    if (border->transitionCount < HPA_MAX_BORDER_TRANSITIONS)
+    {
+        border->transitions[border->transitionCount++] = (uint8)offset;
+    }
+}
+
+// NOTE entrances are runs of cells that can be crossed in both directions. Short ones get a transition in the middle,
+// long ones one at each end.
+internal void BuildHpaBorder(HpaGraph *graph, World *world, uint32 clusterIndex, bool32 isBottom)
+{
+    HpaBorder *border       = (isBottom ? graph->bottomBorders : graph->rightBorders) + clusterIndex;
+    border->transitionCount = 0;
+
+    int32 clusterX = clusterIndex % graph->clusterCountX;
+    int32 clusterY = clusterIndex / graph->clusterCountX;
+
+    if (isBottom ? clusterY + 1 < graph->clusterCountY : clusterX + 1 < graph->clusterCountX)
+    {
+        int32 minX   = clusterX << WORLD_CHUNK_SHIFT;
+        int32 minY   = clusterY << WORLD_CHUNK_SHIFT;
+        int32 length = Min(HPA_CLUSTER_DIM, isBottom ? world->width - minX : world->height - minY);
+
+        int32 runStart = -1;
+        for (int32 offset = 0; offset <= length; ++offset)
+        {
+            bool32 isOpen = false;
+            if (offset < length)
+            {
+                int32 x = isBottom ? minX + offset : minX + HPA_CLUSTER_DIM - 1;
+                int32 y = isBottom ? minY + HPA_CLUSTER_DIM - 1 : minY + offset;
+
+                isOpen = GetHpaEntryCost(graph, world, x, y) &&
+                         GetHpaEntryCost(graph, world, isBottom ? x : x + 1, isBottom ? y + 1 : y);
+            }
+
+            if (isOpen && runStart < 0)
+            {
+                runStart = offset;
+            }
+            else if (!isOpen && runStart >= 0)
+            {
+                int32 runEnd = offset - 1;
+
+                if (runEnd - runStart + 1 < HPA_LONG_ENTRANCE_LENGTH)
+                {
+                    AddHpaTransition(border, (runStart + runEnd) / 2);
+                }
+                else
+                {
+                    AddHpaTransition(border, runStart);
+                    AddHpaTransition(border, runEnd);
+                }
+
+                runStart = -1;
+            }
+        }
+    }
+}
+
+// NOTE reads the cells straight out of the world, so for a paged world the cluster has to be paged in already.
+internal void LoadHpaLocalGrid(HpaGraph *graph, World *world, uint32 clusterIndex, HpaLocalGrid *grid)
+{
+    grid->minX   = (clusterIndex % graph->clusterCountX) << WORLD_CHUNK_SHIFT;
+    grid->minY   = (clusterIndex / graph->clusterCountX) << WORLD_CHUNK_SHIFT;
+    grid->width  = Min(HPA_CLUSTER_DIM, world->width - grid->minX);
+    grid->height = Min(HPA_CLUSTER_DIM, world->height - grid->minY);
+
+    for (int32 localY = 0; localY < grid->height; ++localY)
+    {
+        int32 y    = grid->minY + localY;
+        Cell *cell = GetCellRow(world, y) + grid->minX;
+
+        for (int32 localX = 0; localX < grid->width; ++localX, ++cell)
+        {
+            // NOTE GetCell never hands out the first row or column.
+            bool32 isInWorld = y > 0 && grid->minX + localX > 0;
+
+            grid->costs[localY * HPA_CLUSTER_DIM + localX] = isInWorld ? graph->costs.costs[cell->biome] : 0;
+        }
+    }
+}
+
+internal void PageInHpaCluster(HpaGraph *graph, World *world, uint32 clusterIndex)
+{
+    if (world->pager)
+    {
+        int32 minX = (clusterIndex % graph->clusterCountX) << WORLD_CHUNK_SHIFT;
+        int32 minY = (clusterIndex / graph->clusterCountX) << WORLD_CHUNK_SHIFT;
+        int32 maxX = Min(minX + HPA_CLUSTER_DIM, world->width) - 1;
+
+        // NOTE the whole cluster sits in a single chunk, any one row of it pages the chunk in.
+        GetCellSpan(world, Max(minY, 1), Max(minX, 1), maxX, false);
+    }
+}
+
+inline uint32 GetHpaLocalIndex(HpaLocalGrid *grid, OffsetCoord cell)
+{
+    uint32 result = (cell.y - grid->minY) * HPA_CLUSTER_DIM + (cell.x - grid->minX);
+    return result;
+}
+
+// NOTE Dijkstra from source without leaving the grid. In reverse the costs come out as the cost of getting from each
+// cell to source instead of from source to each cell. Stops early once targetCount targets have been settled.
+internal void SearchHpaLocalGrid(Pathfinder *search, HpaLocalGrid *grid, uint32 source, bool32 reverse,
+                                 uint32 targetCount)
+{
+    BeginPathSearch(search);
+    RelaxPathNode(search, source, 0, 0, source);
+
+    uint32 targetsLeft = targetCount;
+    while (search->heapCount)
+    {
+        uint32 localIndex = PopPathHeap(search);
+        ++search->expandedCount;
+
+        if (grid->isTarget[localIndex] && --targetsLeft == 0)
+        {
+            break;
+        }
+
+        int32 localX = localIndex & WORLD_CHUNK_MASK;
+        int32 localY = localIndex >> WORLD_CHUNK_SHIFT;
+        uint32 cost  = search->nodes[localIndex].cost;
+
+        // NOTE clusters start on even rows, so local rows have the same parity as world ones.
+        int32 shift                   = localY & 1;
+        OffsetCoord neighbourOffsets[] = {{1, 0}, {-1, 0}, {shift - 1, -1}, {shift, -1}, {shift - 1, 1}, {shift, 1}};
+
+        for (uint32 neighbourIndex = 0; neighbourIndex < ArrayCount(neighbourOffsets); ++neighbourIndex)
+        {
+            int32 x = localX + neighbourOffsets[neighbourIndex].x;
+            int32 y = localY + neighbourOffsets[neighbourIndex].y;
+
+            if (x < 0 || y < 0 || x >= grid->width || y >= grid->height)
+            {
+                continue;
+            }
+
+            uint32 neighbour = y * HPA_CLUSTER_DIM + x;
+            if (grid->costs[neighbour])
+            {
+                uint32 stepCost = reverse ? grid->costs[localIndex] : grid->costs[neighbour];
+                RelaxPathNode(search, neighbour, cost + stepCost, 0, localIndex);
+            }
+        }
+    }
+}
+
+internal void AddHpaClusterNodes(HpaCluster *cluster, HpaLocalGrid *grid, HpaBorder *border, HpaClusterSide side)
+{
+    for (uint32 transitionIndex = 0; transitionIndex < border->transitionCount; ++transitionIndex)
+    {
+        int32 offset = border->transitions[transitionIndex];
+
+        OffsetCoord cell = {};
+        switch (side)
+        {
+            case HPA_SIDE_RIGHT:
+            {
+                cell = {grid->minX + grid->width - 1, grid->minY + offset};
+            }
+            break;
+
+            case HPA_SIDE_LEFT:
+            {
+                cell = {grid->minX, grid->minY + offset};
+            }
+            break;
+
+            case HPA_SIDE_BOTTOM:
+            {
+                cell = {grid->minX + offset, grid->minY + grid->height - 1};
+            }
+            break;
+
+            case HPA_SIDE_TOP:
+            {
+                cell = {grid->minX + offset, grid->minY};
+            }
+            break;
+        }
+
+        uint32 nodeIndex = 0;
+        while (nodeIndex < cluster->nodeCount &&
+               (cluster->nodes[nodeIndex].cell.x != cell.x || cluster->nodes[nodeIndex].cell.y != cell.y))
+        {
+            ++nodeIndex;
+        }
+
+        if (nodeIndex == cluster->nodeCount)
+        {
+            HpaNode *node   = cluster->nodes + cluster->nodeCount++;
+            node->cell      = cell;
+            node->entryCost = grid->costs[GetHpaLocalIndex(grid, cell)];
+            node->sides     = 0;
+        }
+
+        cluster->nodes[nodeIndex].sides |= side;
+    }
+}
+
+// NOTE only reads the borders and the world, and only writes its own cluster, so clusters can be built in parallel
+// as long as the borders stay put.
+internal void BuildHpaCluster(HpaGraph *graph, World *world, uint32 clusterIndex, Pathfinder *search,
+                              HpaLocalGrid *grid)
+{
+    HpaCluster *cluster = graph->clusters + clusterIndex;
+    int32 clusterX      = clusterIndex % graph->clusterCountX;
+    int32 clusterY      = clusterIndex / graph->clusterCountX;
+
+    LoadHpaLocalGrid(graph, world, clusterIndex, grid);
+
+    cluster->nodeCount = 0;
+    AddHpaClusterNodes(cluster, grid, graph->rightBorders + clusterIndex, HPA_SIDE_RIGHT);
+    AddHpaClusterNodes(cluster, grid, graph->bottomBorders + clusterIndex, HPA_SIDE_BOTTOM);
+
+    if (clusterX > 0)
+    {
+        AddHpaClusterNodes(cluster, grid, graph->rightBorders + clusterIndex - 1, HPA_SIDE_LEFT);
+    }
+
+    if (clusterY > 0)
+    {
+        AddHpaClusterNodes(cluster, grid, graph->bottomBorders + clusterIndex - graph->clusterCountX, HPA_SIDE_TOP);
+    }
+
+    for (uint32 nodeIndex = 0; nodeIndex < cluster->nodeCount; ++nodeIndex)
+    {
+        grid->isTarget[GetHpaLocalIndex(grid, cluster->nodes[nodeIndex].cell)] = true;
+    }
+
+    for (uint32 fromIndex = 0; fromIndex < cluster->nodeCount; ++fromIndex)
+    {
+        SearchHpaLocalGrid(search, grid, GetHpaLocalIndex(grid, cluster->nodes[fromIndex].cell), false,
+                           cluster->nodeCount);
+
+        for (uint32 toIndex = 0; toIndex < cluster->nodeCount; ++toIndex)
+        {
+            uint32 localIndex = GetHpaLocalIndex(grid, cluster->nodes[toIndex].cell);
+            uint32 cost       = search->nodes[localIndex].cost;
+
+            cluster->costs[fromIndex][toIndex] =
+                IsPathNodeClosed(search, localIndex) && cost < HPA_UNREACHABLE ? (uint16)cost : HPA_UNREACHABLE;
+        }
+    }
+
+    for (uint32 nodeIndex = 0; nodeIndex < cluster->nodeCount; ++nodeIndex)
+    {
+        grid->isTarget[GetHpaLocalIndex(grid, cluster->nodes[nodeIndex].cell)] = false;
+    }
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoHpaBuildJob)
+{
+    TIMED_FUNCTION();
+
+    HpaBuildJob *job = (HpaBuildJob *)data;
+
+    for (uint32 clusterIndex = 0; clusterIndex < job->clusterCount; ++clusterIndex)
+    {
+        BuildHpaCluster(job->graph, job->world, job->clusters[clusterIndex], &job->search, &job->grid);
+    }
+
+    __sync_fetch_and_sub(&job->graph->jobsRemaining, 1);
+}
+
+inline void QueueHpaCluster(HpaGraph *graph, int32 clusterX, int32 clusterY)
+{
+    if (clusterX >= 0 && clusterY >= 0 && clusterX < graph->clusterCountX && clusterY < graph->clusterCountY)
+    {
+        uint32 clusterIndex = clusterY * graph->clusterCountX + clusterX;
+        if (!(graph->clusterStates[clusterIndex] & HPA_CLUSTER_QUEUED))
+        {
+            graph->clusterStates[clusterIndex] |= HPA_CLUSTER_QUEUED;
+            graph->buildClusters[graph->buildClusterCount++] = clusterIndex;
+        }
+    }
+}
+
+// NOTE the borders around dirty clusters are cheap and get redone right here. Changing them changes the nodes of the
+// clusters on both sides, so those are rebuilt along with the dirty ones, in jobs.
+internal void StartHpaBuild(HpaGraph *graph, World *world, GameMemory *memory)
+{
+    Assert(!graph->isBuilding);
+
+    graph->buildStartCycles  = __rdtsc();
+    graph->buildClusterCount = 0;
+
+    for (uint32 dirtyIndex = 0; dirtyIndex < graph->dirtyClusterCount; ++dirtyIndex)
+    {
+        uint32 clusterIndex = graph->dirtyClusters[dirtyIndex];
+        int32 clusterX      = clusterIndex % graph->clusterCountX;
+        int32 clusterY      = clusterIndex / graph->clusterCountX;
+
+        graph->clusterStates[clusterIndex] &= ~HPA_CLUSTER_DIRTY;
+
+        BuildHpaBorder(graph, world, clusterIndex, false);
+        BuildHpaBorder(graph, world, clusterIndex, true);
+
+        if (clusterX > 0)
+        {
+            BuildHpaBorder(graph, world, clusterIndex - 1, false);
+        }
+
+        if (clusterY > 0)
+        {
+            BuildHpaBorder(graph, world, clusterIndex - graph->clusterCountX, true);
+        }
+
+        QueueHpaCluster(graph, clusterX, clusterY);
+        QueueHpaCluster(graph, clusterX - 1, clusterY);
+        QueueHpaCluster(graph, clusterX + 1, clusterY);
+        QueueHpaCluster(graph, clusterX, clusterY - 1);
+        QueueHpaCluster(graph, clusterX, clusterY + 1);
+    }
+
+    graph->dirtyClusterCount = 0;
+
+    for (uint32 buildIndex = 0; buildIndex < graph->buildClusterCount; ++buildIndex)
+    {
+        uint32 clusterIndex = graph->buildClusters[buildIndex];
+
+        graph->clusterStates[clusterIndex] &= ~HPA_CLUSTER_QUEUED;
+        PageInHpaCluster(graph, world, clusterIndex);
+    }
+
+    graph->isBuilding            = true;
+    graph->buildWorld            = world;
+    graph->lastBuildClusterCount = graph->buildClusterCount;
+    graph->jobsRemaining         = 0;
+    graph->nextBuildCluster      = 0;
+
+    if (memory->highPriorityWorkerCount)
+    {
+        uint32 jobCount = Min((int32)graph->buildClusterCount, HPA_MAX_JOB_COUNT);
+        uint32 perJob   = (graph->buildClusterCount + jobCount - 1) / jobCount;
+        jobCount        = (graph->buildClusterCount + perJob - 1) / perJob;
+
+        graph->jobsRemaining    = jobCount;
+        graph->nextBuildCluster = graph->buildClusterCount;
+
+        for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+        {
+            uint32 firstCluster = jobIndex * perJob;
+
+            HpaBuildJob *job  = graph->jobs + jobIndex;
+            job->graph        = graph;
+            job->world        = world;
+            job->clusters     = graph->buildClusters + firstCluster;
+            job->clusterCount = Min((int32)perJob, (int32)(graph->buildClusterCount - firstCluster));
+
+            memory->platformAddEntry(memory->highPriorityQueue, DoHpaBuildJob, job);
+        }
+    }
+}
+
+// NOTE builds up to count of the clusters no job was queued for, on the calling thread.
+internal void BuildHpaClusterSlice(HpaGraph *graph, uint32 count)
+{
+    HpaBuildJob *scratch = graph->jobs;
+    uint32 endCluster    = Min((int32)graph->buildClusterCount, (int32)(graph->nextBuildCluster + count));
+
+    for (; graph->nextBuildCluster < endCluster; ++graph->nextBuildCluster)
+    {
+        BuildHpaCluster(graph, graph->buildWorld, graph->buildClusters[graph->nextBuildCluster], &scratch->search,
+                        &scratch->grid);
+    }
+}
+
+internal void FinishHpaBuild(HpaGraph *graph, GameMemory *memory)
+{
+    if (graph->isBuilding)
+    {
+        BuildHpaClusterSlice(graph, graph->buildClusterCount);
+
+        if (graph->jobsRemaining)
+        {
+            memory->platformCompleteAllWork(memory->highPriorityQueue);
+        }
+
+        Assert(graph->jobsRemaining == 0);
+
+        graph->lastBuildCycles = __rdtsc() - graph->buildStartCycles;
+        graph->isBuilding      = false;
+    }
+}
+
+// NOTE called once a frame. Picks up a finished build and starts the next one if anything was edited meanwhile,
+// never waiting on the build. Without worker threads this is where the build moves on, a slice every frame.
+internal void UpdateHpaGraph(HpaGraph *graph, World *world, GameMemory *memory)
+{
+    if (graph->isBuilding)
+    {
+        BuildHpaClusterSlice(graph, HPA_CLUSTERS_PER_FRAME);
+    }
+
+    if (graph->isBuilding && graph->jobsRemaining == 0 && graph->nextBuildCluster == graph->buildClusterCount)
+    {
+        FinishHpaBuild(graph, memory);
+    }
+
+    if (!graph->isBuilding && graph->dirtyClusterCount)
+    {
+        StartHpaBuild(graph, world, memory);
+    }
+}
+
+// NOTE appends the cheapest route from one cell of the cluster to another, leaving out the cell it starts from.
+internal void AppendHpaLocalPath(HpaGraph *graph, World *world, uint32 clusterIndex, OffsetCoord from,
+                                 OffsetCoord to, MemoryArena *arena, Path *path)
+{
+    HpaLocalGrid *grid  = &graph->localGrid;
+    Pathfinder *search = &graph->localSearch;
+
+    PageInHpaCluster(graph, world, clusterIndex);
+    LoadHpaLocalGrid(graph, world, clusterIndex, grid);
+
+    uint32 fromIndex = GetHpaLocalIndex(grid, from);
+    uint32 toIndex   = GetHpaLocalIndex(grid, to);
+
+    grid->isTarget[toIndex] = true;
+    SearchHpaLocalGrid(search, grid, fromIndex, false, 1);
+    grid->isTarget[toIndex] = false;
+
+    Assert(IsPathNodeClosed(search, toIndex));
+
+    uint32 stepCount = 0;
+    for (uint32 localIndex = toIndex; localIndex != fromIndex; localIndex = search->nodes[localIndex].parent)
+    {
+        ++stepCount;
+    }
+
+    OffsetCoord *cells = PushArray(arena, stepCount, OffsetCoord);
+
+    uint32 localIndex = toIndex;
+    for (uint32 stepIndex = stepCount; stepIndex > 0; --stepIndex)
+    {
+        OffsetCoord *at = cells + stepIndex - 1;
+        at->x           = grid->minX + (int32)(localIndex & WORLD_CHUNK_MASK);
+        at->y           = grid->minY + (int32)(localIndex >> WORLD_CHUNK_SHIFT);
+
+        localIndex = search->nodes[localIndex].parent;
+    }
+
+    path->cellCount += stepCount;
+}
+
+// NOTE costs between a cell and every node of its cluster, to the nodes or, in reverse, from them.
+internal void SearchHpaEndpoint(HpaGraph *graph, World *world, uint32 clusterIndex, OffsetCoord cell,
+                                bool32 reverse, uint16 *costs)
+{
+    HpaCluster *cluster = graph->clusters + clusterIndex;
+    HpaLocalGrid *grid  = &graph->localGrid;
+    Pathfinder *search  = &graph->localSearch;
+
+    PageInHpaCluster(graph, world, clusterIndex);
+    LoadHpaLocalGrid(graph, world, clusterIndex, grid);
+
+    for (uint32 nodeIndex = 0; nodeIndex < cluster->nodeCount; ++nodeIndex)
+    {
+        grid->isTarget[GetHpaLocalIndex(grid, cluster->nodes[nodeIndex].cell)] = true;
+    }
+
+    SearchHpaLocalGrid(search, grid, GetHpaLocalIndex(grid, cell), reverse, cluster->nodeCount);
+
+    for (uint32 nodeIndex = 0; nodeIndex < cluster->nodeCount; ++nodeIndex)
+    {
+        uint32 localIndex = GetHpaLocalIndex(grid, cluster->nodes[nodeIndex].cell);
+        uint32 cost       = search->nodes[localIndex].cost;
+
+        costs[nodeIndex] = IsPathNodeClosed(search, localIndex) && cost < HPA_UNREACHABLE ? (uint16)cost
+                                                                                           : HPA_UNREACHABLE;
+        grid->isTarget[localIndex] = false;
+    }
+}
+
+// NOTE start and goal join the abstract graph as two extra nodes, connected to the nodes of their own clusters. Once
+// the abstract route is known, every leg of it that stays within a cluster is walked cell by cell, and only those.
+internal Path FindHpaPath(HpaGraph *graph, World *world, OffsetCoord start, OffsetCoord goal, MemoryArena *arena)
+{
+    Path result = {};
+
+    Assert(!graph->isBuilding);
+
+    Cell *startCell = GetCell(world, start);
+    Cell *goalCell  = GetCell(world, goal);
+
+    graph->expandedCount = 0;
+
+    if (startCell && goalCell && graph->costs.costs[goalCell->biome])
+    {
+        uint32 startCluster = GetHpaClusterIndex(graph, start.x, start.y);
+        uint32 goalCluster  = GetHpaClusterIndex(graph, goal.x, goal.y);
+        uint32 startId      = graph->clusterCount * HPA_MAX_CLUSTER_NODES;
+        uint32 goalId       = startId + 1;
+        HexCoord goalHex    = goalCell->coord;
+
+        SearchHpaEndpoint(graph, world, startCluster, start, false, graph->startCosts);
+        SearchHpaEndpoint(graph, world, goalCluster, goal, true, graph->goalCosts);
+
+        // NOTE a route that never leaves the cluster doesn't go through any node.
+        uint32 directCost = 0xFFFFFFFF;
+        if (startCluster == goalCluster)
+        {
+            HpaLocalGrid *grid = &graph->localGrid;
+            uint32 goalIndex   = GetHpaLocalIndex(grid, goal);
+
+            grid->isTarget[goalIndex] = true;
+            SearchHpaLocalGrid(&graph->localSearch, grid, GetHpaLocalIndex(grid, start), false, 1);
+            grid->isTarget[goalIndex] = false;
+
+            if (IsPathNodeClosed(&graph->localSearch, goalIndex))
+            {
+                directCost = graph->localSearch.nodes[goalIndex].cost;
+            }
+        }
+
+        Pathfinder *search = &graph->abstractSearch;
+        BeginPathSearch(search);
+        RelaxPathNode(search, startId, 0, 0, startId);
+
+        while (search->heapCount)
+        {
+            uint32 id = PopPathHeap(search);
+            ++search->expandedCount;
+
+            if (id == goalId)
+            {
+                result.found = true;
+                break;
+            }
+
+            uint32 cost = search->nodes[id].cost;
+
+            if (id == startId)
+            {
+                HpaCluster *cluster = graph->clusters + startCluster;
+                for (uint32 nodeIndex = 0; nodeIndex < cluster->nodeCount; ++nodeIndex)
+                {
+                    if (graph->startCosts[nodeIndex] != HPA_UNREACHABLE)
+                    {
+                        HexCoord hex = HexFromOffset(cluster->nodes[nodeIndex].cell);
+                        RelaxPathNode(search, startCluster * HPA_MAX_CLUSTER_NODES + nodeIndex,
+                                      cost + graph->startCosts[nodeIndex], graph->minCost * Distance(hex, goalHex),
+                                      id);
+                    }
+                }
+
+                if (directCost != 0xFFFFFFFF)
+                {
+                    RelaxPathNode(search, goalId, cost + directCost, 0, id);
+                }
+
+                continue;
+            }
+
+            uint32 clusterIndex = id / HPA_MAX_CLUSTER_NODES;
+            uint32 nodeIndex    = id % HPA_MAX_CLUSTER_NODES;
+            HpaCluster *cluster = graph->clusters + clusterIndex;
+            HpaNode *node       = cluster->nodes + nodeIndex;
+
+            for (uint32 toIndex = 0; toIndex < cluster->nodeCount; ++toIndex)
+            {
+                uint16 edgeCost = cluster->costs[nodeIndex][toIndex];
+                if (toIndex != nodeIndex && edgeCost != HPA_UNREACHABLE)
+                {
+                    HexCoord hex = HexFromOffset(cluster->nodes[toIndex].cell);
+                    RelaxPathNode(search, clusterIndex * HPA_MAX_CLUSTER_NODES + toIndex, cost + edgeCost,
+                                  graph->minCost * Distance(hex, goalHex), id);
+                }
+            }
+
+            for (uint32 side = HPA_SIDE_RIGHT; side <= HPA_SIDE_TOP; side <<= 1)
+            {
+                if (!(node->sides & side))
+                {
+                    continue;
+                }
+
+                OffsetCoord across = node->cell;
+                switch (side)
+                {
+                    case HPA_SIDE_RIGHT:
+                    {
+                        ++across.x;
+                    }
+                    break;
+
+                    case HPA_SIDE_LEFT:
+                    {
+                        --across.x;
+                    }
+                    break;
+
+                    case HPA_SIDE_BOTTOM:
+                    {
+                        ++across.y;
+                    }
+                    break;
+
+                    case HPA_SIDE_TOP:
+                    {
+                        --across.y;
+                    }
+                    break;
+                }
+
+                uint32 acrossCluster = GetHpaClusterIndex(graph, across.x, across.y);
+                HpaCluster *other    = graph->clusters + acrossCluster;
+
+                for (uint32 otherIndex = 0; otherIndex < other->nodeCount; ++otherIndex)
+                {
+                    HpaNode *otherNode = other->nodes + otherIndex;
+                    if (otherNode->cell.x == across.x && otherNode->cell.y == across.y)
+                    {
+                        HexCoord hex = HexFromOffset(across);
+                        RelaxPathNode(search, acrossCluster * HPA_MAX_CLUSTER_NODES + otherIndex,
+                                      cost + otherNode->entryCost, graph->minCost * Distance(hex, goalHex), id);
+                        break;
+                    }
+                }
+            }
+
+            if (clusterIndex == goalCluster && graph->goalCosts[nodeIndex] != HPA_UNREACHABLE)
+            {
+                RelaxPathNode(search, goalId, cost + graph->goalCosts[nodeIndex], 0, id);
+            }
+        }
+
+        graph->expandedCount = search->expandedCount;
+
+        if (result.found)
+        {
+            result.cost = search->nodes[goalId].cost;
+
+            // NOTE turns the parent links around so the route can be walked from the start.
+            uint32 next = goalId;
+            uint32 id   = search->nodes[goalId].parent;
+            while (next != startId)
+            {
+                uint32 parent           = search->nodes[id].parent;
+                search->nodes[id].parent = next;
+
+                next = id;
+                id   = parent;
+            }
+
+            // NOTE nothing else goes onto the arena while the route is walked, so the legs end up back to back.
+            result.cells     = PushArray(arena, 1, OffsetCoord);
+            result.cells[0]  = start;
+            result.cellCount = 1;
+
+            uint32 fromId        = startId;
+            OffsetCoord fromCell = start;
+            while (fromId != goalId)
+            {
+                uint32 toId        = search->nodes[fromId].parent;
+                OffsetCoord toCell = toId == goalId ? goal
+                                                    : graph->clusters[toId / HPA_MAX_CLUSTER_NODES]
+                                                          .nodes[toId % HPA_MAX_CLUSTER_NODES]
+                                                          .cell;
+
+                uint32 fromCluster = fromId == startId ? startCluster : fromId / HPA_MAX_CLUSTER_NODES;
+                uint32 toCluster   = toId == goalId ? goalCluster : toId / HPA_MAX_CLUSTER_NODES;
+
+                if (fromCluster == toCluster)
+                {
+                    AppendHpaLocalPath(graph, world, fromCluster, fromCell, toCell, arena, &result);
+                }
+                else
+                {
+                    *PushStruct(arena, OffsetCoord) = toCell;
+                    ++result.cellCount;
+                }
+
+                fromId   = toId;
+                fromCell = toCell;
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,137 @@
+#if !defined(HEX_MAGIC_HPA)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_path.h"
+
+// NOTE hierarchical pathfinding over the world chunks. Wherever two chunks can be crossed between, the border gets
+// one or two transitions, each a pair of cells facing each other across it. Those cells are the nodes of a small
+// graph, with the costs between the nodes of a chunk worked out ahead of time. Long queries search that graph and only
+// walk cell by cell inside the chunks the route actually goes through.
+//
+// Borders follow the row for chunks side by side and the column for chunks on top of each other, which in odd-r
+// offset coordinates always gives neighbouring cells. Diagonal crossings are left out, so routes can come out a
+// little longer than flat A* ones.
+
+#define HPA_CLUSTER_DIM WORLD_CHUNK_DIM
+#define HPA_CLUSTER_CELL_COUNT (HPA_CLUSTER_DIM * HPA_CLUSTER_DIM)
+#define HPA_MAX_BORDER_TRANSITIONS 16
+#define HPA_MAX_CLUSTER_NODES (4 * HPA_MAX_BORDER_TRANSITIONS)
+#define HPA_LONG_ENTRANCE_LENGTH 8
+#define HPA_UNREACHABLE 0xFFFF
+#define HPA_MAX_JOB_COUNT 16
+
+// NOTE how many clusters the main thread builds a frame when there are no worker threads to run the jobs. A cluster
+// with a full set of nodes takes a few milliseconds.
+#define HPA_CLUSTERS_PER_FRAME 2
+
+enum HpaClusterSide
+{
+    HPA_SIDE_RIGHT  = 1 << 0,
+    HPA_SIDE_LEFT   = 1 << 1,
+    HPA_SIDE_BOTTOM = 1 << 2,
+    HPA_SIDE_TOP    = 1 << 3,
+};
+
+enum HpaClusterState
+{
+    HPA_CLUSTER_DIRTY  = 1 << 0,
+    HPA_CLUSTER_QUEUED = 1 << 1,
+};
+
+// NOTE offsets of the transitions along the right or bottom border of a cluster.
+struct HpaBorder
+{
+    uint32 transitionCount;
+    uint8 transitions[HPA_MAX_BORDER_TRANSITIONS];
+};
+
+struct HpaNode
+{
+    OffsetCoord cell;
+    uint32 entryCost;
+
+    // NOTE the sides whose transitions this node is part of, the cell across each of them is a node too.
+    uint32 sides;
+};
+
+struct HpaCluster
+{
+    uint32 nodeCount;
+    HpaNode nodes[HPA_MAX_CLUSTER_NODES];
+
+    // NOTE cost of the cheapest route from one node to another without leaving the cluster.
+    uint16 costs[HPA_MAX_CLUSTER_NODES][HPA_MAX_CLUSTER_NODES];
+};
+
+// NOTE entry costs of the cells of one cluster, 0 where a cell can't be entered or isn't in the world.
+struct HpaLocalGrid
+{
+    int32 minX;
+    int32 minY;
+    int32 width;
+    int32 height;
+
+    uint8 costs[HPA_CLUSTER_CELL_COUNT];
+
+    // NOTE set by whoever starts a search for the cells it is after, the search stops once it has settled them all.
+    uint8 isTarget[HPA_CLUSTER_CELL_COUNT];
+};
+
+struct HpaGraph;
+
+struct HpaBuildJob
+{
+    HpaGraph *graph;
+    World *world;
+
+    uint32 *clusters;
+    uint32 clusterCount;
+
+    Pathfinder search;
+    HpaLocalGrid grid;
+};
+
+struct HpaGraph
+{
+    PathCostTable costs;
+    uint32 minCost;
+
+    int32 clusterCountX;
+    int32 clusterCountY;
+    uint32 clusterCount;
+
+    HpaCluster *clusters;
+    HpaBorder *rightBorders;
+    HpaBorder *bottomBorders;
+
+    uint8 *clusterStates;
+    uint32 *dirtyClusters;
+    uint32 dirtyClusterCount;
+
+    // NOTE clusters are rebuilt by jobs on the high priority queue. Nothing but the jobs touches the clusters until
+    // the last one is done. Without worker threads no jobs are queued, the main thread builds the clusters from
+    // nextBuildCluster on a slice at a time instead.
+    bool32 isBuilding;
+    uint32 volatile jobsRemaining;
+    uint32 *buildClusters;
+    uint32 buildClusterCount;
+    uint32 nextBuildCluster;
+    World *buildWorld;
+    HpaBuildJob jobs[HPA_MAX_JOB_COUNT];
+    uint64 buildStartCycles;
+
+    // NOTE searches for queries on the main thread, one over the abstract graph and one within a cluster.
+    Pathfinder abstractSearch;
+    Pathfinder localSearch;
+    HpaLocalGrid localGrid;
+    uint16 startCosts[HPA_MAX_CLUSTER_NODES];
+    uint16 goalCosts[HPA_MAX_CLUSTER_NODES];
+
+    // NOTE stats of the last build and the last query.
+    uint32 lastBuildClusterCount;
+    uint64 lastBuildCycles;
+    uint32 expandedCount;
+};
+
+#define HEX_MAGIC_HPA
+#endif
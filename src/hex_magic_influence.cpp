@@ -0,0 +1,242 @@
+#include "hex_magic.h"
+#include "hex_magic_influence.h"
+#include "hex_magic_kernel.h"
+#include "hex_magic_path.h"
+#include "hex_magic_platform.h"
+
+inline MemoryIndex GetInfluenceMapSize(World *world)
+{
+    MemoryIndex gridSize = GetHexGridCellCount(world->width, world->height) * sizeof(real32);
+    MemoryIndex result   = sizeof(InfluenceMap) + (MAX_PLAYER_COUNT + 3) * gridSize +
+                         2 * (MemoryIndex)world->width * world->height * sizeof(uint8);
+
+    return result;
+}
+
+inline bool32 InfluenceMapFitsInArena(MemoryArena *arena, World *world)
+{
+    bool32 result = arena->used + GetInfluenceMapSize(world) <= arena->size;
+    return result;
+}
+
+inline void MarkInfluenceDirty(InfluenceMap *map) { map->isDirty = true; }
+
+internal void InitializeInfluenceMap(InfluenceMap *map, MemoryArena *arena, World *world)
+{
+    map->width  = world->width;
+    map->height = world->height;
+
+    // NOTE what a cell passes on to the cells around it adds up to less than what it has, so influence fades out.
+    real32 ringWeights[INFLUENCE_KERNEL_RADIUS + 1] = {0.2f, 0.07f, 0.025f};
+    map->spread                                     = MakeHexKernel(INFLUENCE_KERNEL_RADIUS, ringWeights);
+
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        map->values[player] = MakeHexScalarGrid(arena, world->width, world->height, 0, 0.0f);
+        ClearHexGrid(&map->values[player], 0.0f);
+    }
+
+    map->seeds    = MakeHexScalarGrid(arena, world->width, world->height, 0, 0.0f);
+    map->scratch  = MakeHexScalarGrid(arena, world->width, world->height, 0, 0.0f);
+    map->passable = MakeHexScalarGrid(arena, world->width, world->height, 0, 0.0f);
+    map->owners      = PushArray(arena, (MemoryIndex)world->width * world->height, uint8);
+    map->buildOwners = PushArray(arena, (MemoryIndex)world->width * world->height, uint8);
+
+    memset(map->owners, INFLUENCE_NO_OWNER, (MemoryIndex)world->width * world->height);
+    memset(map->ownedCellCounts, 0, sizeof(map->ownedCellCounts));
+
+    map->isDirty             = true;
+    map->isBuilding          = false;
+    map->hasOwners           = false;
+    map->nextBuildStep       = 0;
+    map->buildCycles         = 0;
+    map->buildFrameCount     = 0;
+    map->lastBuildCycles     = 0;
+    map->lastBuildFrameCount = 0;
+}
+
+inline uint32 GetInfluenceOwner(InfluenceMap *map, OffsetCoord offset)
+{
+    uint32 result = INFLUENCE_NO_OWNER;
+
+    if (offset.x >= 0 && offset.x < map->width && offset.y >= 0 && offset.y < map->height)
+    {
+        result = map->owners[(MemoryIndex)offset.y * map->width + offset.x];
+    }
+
+    return result;
+}
+
+internal void LoadInfluencePassable(InfluenceMap *map, World *world, PathCostTable *costs)
+{
+    ClearHexGrid(&map->passable, 0.0f);
+
+    // NOTE the first row and column aren't part of the world as far as GetCell is concerned.
+    for (int32 y = 1; y < world->height; ++y)
+    {
+        real32 *row = GetHexGridRow(&map->passable, y);
+        Cell *cell  = GetCellSpan(world, y, 1, world->width - 1, false);
+
+        for (int32 x = 1; x < world->width; ++x)
+        {
+            row[x] = costs->costs[(cell++)->biome] ? 1.0f : 0.0f;
+        }
+    }
+}
+
+internal void LoadInfluenceSeeds(InfluenceMap *map, World *world, uint32 player)
+{
+    ClearHexGrid(&map->seeds, 0.0f);
+
+    for (uint32 entityIndex = 1; entityIndex <= world->entityCount; ++entityIndex)
+    {
+        Entity *entity = GetEntity(world, entityIndex);
+        Cell *cell     = GetEntityCell(world, entityIndex);
+
+        if (cell && entity->player == player && entity->type != ENTITY_RESOURCE)
+        {
+            OffsetCoord offset = OffsetFromHex(cell->coord);
+            real32 strength    = entity->type == ENTITY_CITY ? INFLUENCE_CITY_STRENGTH : INFLUENCE_HERO_STRENGTH;
+            real32 *seed       = GetHexGridRow(&map->seeds, offset.y) + offset.x;
+
+            *seed = *seed > strength ? *seed : strength;
+        }
+    }
+}
+
+internal void StartInfluenceBuild(InfluenceMap *map, World *world)
+{
+    Assert(map->width == world->width && map->height == world->height);
+
+    map->isDirty         = false;
+    map->isBuilding      = true;
+    map->nextBuildStep   = 0;
+    map->buildCycles     = 0;
+    map->buildFrameCount = 0;
+}
+
+internal void BuildInfluenceOwners(InfluenceMap *map, uint32 ownerStep)
+{
+    int32 rowsPerStep = (map->height + INFLUENCE_OWNER_STEP_COUNT - 1) / INFLUENCE_OWNER_STEP_COUNT;
+    int32 minY        = Min(map->height, (int32)ownerStep * rowsPerStep);
+    int32 maxY        = Min(map->height, minY + rowsPerStep);
+
+    if (ownerStep == 0)
+    {
+        memset(map->buildOwnedCellCounts, 0, sizeof(map->buildOwnedCellCounts));
+    }
+
+    for (int32 y = minY; y < maxY; ++y)
+    {
+        uint8 *owner = map->buildOwners + (MemoryIndex)y * map->width;
+
+        for (int32 x = 0; x < map->width; ++x)
+        {
+            uint32 bestPlayer = INFLUENCE_NO_OWNER;
+            real32 bestValue  = INFLUENCE_MIN_OWNED;
+
+            for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+            {
+                real32 value = GetHexGridRow(&map->values[player], y)[x];
+                if (value > bestValue)
+                {
+                    bestPlayer = player;
+                    bestValue  = value;
+                }
+            }
+
+            *owner++ = (uint8)bestPlayer;
+
+            if (bestPlayer != INFLUENCE_NO_OWNER)
+            {
+                ++map->buildOwnedCellCounts[bestPlayer];
+            }
+        }
+    }
+}
+
+// NOTE runs up to stepCount of the steps left, and hands the owners over once the last one is done. Every pass keeps
+// at least the seeds, so cities and heroes always hold their own cells, and zeroes whatever heroes can't walk on, so
+// influence doesn't spread over water or mountains. The seeds of a player are taken from the world at their first
+// pass, anything that moved since the build started makes the map dirty again anyway.
+internal void BuildInfluenceSlice(InfluenceMap *map, World *world, PathCostTable *costs, GameMemory *memory,
+                                  uint32 jobCount, uint32 stepCount)
+{
+    uint64 start = __rdtsc();
+
+    uint32 endStep = Min(INFLUENCE_STEP_COUNT, (int32)(map->nextBuildStep + stepCount));
+
+    for (; map->nextBuildStep < endStep; ++map->nextBuildStep)
+    {
+        uint32 step = map->nextBuildStep;
+
+        if (step < INFLUENCE_FIRST_PASS_STEP)
+        {
+            LoadInfluencePassable(map, world, costs);
+        }
+        else if (step < INFLUENCE_FIRST_OWNER_STEP)
+        {
+            uint32 player         = (step - INFLUENCE_FIRST_PASS_STEP) / INFLUENCE_PASS_COUNT;
+            HexScalarGrid *values = &map->values[player];
+
+            if ((step - INFLUENCE_FIRST_PASS_STEP) % INFLUENCE_PASS_COUNT == 0)
+            {
+                LoadInfluenceSeeds(map, world, player);
+                ConvolveHexGrid(&map->spread, &map->seeds, values, &map->seeds, &map->passable, memory, jobCount);
+            }
+            else
+            {
+                ConvolveHexGrid(&map->spread, values, &map->scratch, &map->seeds, &map->passable, memory, jobCount);
+
+                HexScalarGrid swap = *values;
+                *values            = map->scratch;
+                map->scratch       = swap;
+            }
+        }
+        else
+        {
+            BuildInfluenceOwners(map, step - INFLUENCE_FIRST_OWNER_STEP);
+        }
+    }
+
+    map->buildCycles += __rdtsc() - start;
+    ++map->buildFrameCount;
+
+    if (map->nextBuildStep == INFLUENCE_STEP_COUNT)
+    {
+        uint8 *owners    = map->owners;
+        map->owners      = map->buildOwners;
+        map->buildOwners = owners;
+
+        memcpy(map->ownedCellCounts, map->buildOwnedCellCounts, sizeof(map->ownedCellCounts));
+
+        map->isBuilding          = false;
+        map->hasOwners           = true;
+        map->lastBuildCycles     = map->buildCycles;
+        map->lastBuildFrameCount = map->buildFrameCount;
+    }
+}
+
+// NOTE builds the whole map at once, waiting for it.
+internal void BuildInfluenceMap(InfluenceMap *map, World *world, PathCostTable *costs, GameMemory *memory,
+                                uint32 jobCount)
+{
+    StartInfluenceBuild(map, world);
+    BuildInfluenceSlice(map, world, costs, memory, jobCount, INFLUENCE_STEP_COUNT);
+}
+
+// NOTE called once a frame. Moves the build on by a few steps and starts the next one once the world changed, never
+// building the whole map in one frame.
+internal void UpdateInfluenceMap(InfluenceMap *map, World *world, PathCostTable *costs, GameMemory *memory,
+                                 uint32 jobCount)
+{
+    if (!map->isBuilding && map->isDirty)
+    {
+        StartInfluenceBuild(map, world);
+    }
+
+    if (map->isBuilding)
+    {
+        BuildInfluenceSlice(map, world, costs, memory, jobCount, INFLUENCE_STEPS_PER_FRAME);
+    }
+}
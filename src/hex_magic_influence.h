@@ -0,0 +1,63 @@
+#if !defined(HEX_MAGIC_INFLUENCE)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_kernel.h"
+
+// NOTE how strongly each player holds every cell, for the AI to weigh where to go. Cities and heroes put influence
+// on their cells, and every pass spreads it a couple of cells further over land heroes can walk on, weaker the further
+// it goes. A cell belongs to whoever has the most influence on it, as long as anybody has enough.
+
+#define INFLUENCE_KERNEL_RADIUS 2
+#define INFLUENCE_PASS_COUNT 8
+#define INFLUENCE_CITY_STRENGTH 1.0f
+#define INFLUENCE_HERO_STRENGTH 0.6f
+#define INFLUENCE_MIN_OWNED 0.005f
+#define INFLUENCE_NO_OWNER 0xFF
+
+// NOTE a rebuild takes in which cells can be walked on, runs a convolution pass for every pass of every player, then
+// works out the owners a few bands of rows at a time. It runs INFLUENCE_STEPS_PER_FRAME of those steps a frame, a
+// convolution pass over a 1024x1024 world takes a few milliseconds on one thread.
+#define INFLUENCE_OWNER_STEP_COUNT 4
+#define INFLUENCE_FIRST_PASS_STEP 1
+#define INFLUENCE_FIRST_OWNER_STEP (INFLUENCE_FIRST_PASS_STEP + MAX_PLAYER_COUNT * INFLUENCE_PASS_COUNT)
+#define INFLUENCE_STEP_COUNT (INFLUENCE_FIRST_OWNER_STEP + INFLUENCE_OWNER_STEP_COUNT)
+#define INFLUENCE_STEPS_PER_FRAME 1
+
+struct InfluenceMap
+{
+    int32 width;
+    int32 height;
+
+    // NOTE set when the world changed since the last build started. A build runs a few steps every frame, the owners
+    // stay the ones of the last finished build until the next one is done.
+    bool32 isDirty;
+    bool32 isBuilding;
+    bool32 hasOwners;
+    uint32 nextBuildStep;
+
+    HexKernel spread;
+
+    HexScalarGrid values[MAX_PLAYER_COUNT];
+    HexScalarGrid seeds;
+    HexScalarGrid scratch;
+
+    // NOTE 1 for cells a hero can walk on, 0 for the rest.
+    HexScalarGrid passable;
+
+    uint8 *owners;
+    uint32 ownedCellCounts[MAX_PLAYER_COUNT];
+
+    // NOTE the owners the build is working out, swapped with the ones above once it is done.
+    uint8 *buildOwners;
+    uint32 buildOwnedCellCounts[MAX_PLAYER_COUNT];
+
+    uint64 buildCycles;
+    uint32 buildFrameCount;
+
+    // NOTE stats of the last build, the cycles only count the frames it ran in.
+    uint64 lastBuildCycles;
+    uint32 lastBuildFrameCount;
+};
+
+#define HEX_MAGIC_INFLUENCE
+#endif
@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <math.h>
+#include <x86intrin.h>
 #include "hex_magic_platform.h"
 
 inline int32 RoundReal32ToInt32(real32 real32)
@@ -0,0 +1,462 @@
+#include "hex_magic.h"
+#include "hex_magic_journal.h"
+#include "hex_magic_map.h"
+#include "hex_magic_platform.h"
+
+internal void InitializeJournal(Journal *journal, GameMemory *memory, MemoryArena *arena,
+                                MemoryIndex snapshotArenaSize, char *baseName)
+{
+    journal->memory = memory;
+
+    snprintf(journal->mapFileName, sizeof(journal->mapFileName), "%s.map", baseName);
+    snprintf(journal->logFileName, sizeof(journal->logFileName), "%s.log", baseName);
+    snprintf(journal->snapshotFileName, sizeof(journal->snapshotFileName), "%s.map.tmp", baseName);
+    snprintf(journal->chunkLogFileName, sizeof(journal->chunkLogFileName), "%s.map.chunks", baseName);
+
+    for (uint32 bufferIndex = 0; bufferIndex < ArrayCount(journal->buffers); ++bufferIndex)
+    {
+        journal->buffers[bufferIndex]                     = PushStruct(arena, JournalBuffer);
+        journal->buffers[bufferIndex]->header.recordCount = 0;
+    }
+
+    journal->fillIndex   = 0;
+    journal->isBusy      = false;
+    journal->flushBuffer = 0;
+
+    SubArena(&journal->snapshotArena, arena, snapshotArenaSize);
+
+    journal->isStaging      = false;
+    journal->stagedRowCount = 0;
+
+    journal->snapshotRequested     = false;
+    journal->hasEditsSinceSnapshot = false;
+    journal->secondsSinceFlush     = 0.0f;
+    journal->secondsSinceSnapshot  = 0.0f;
+
+    journal->stageCycles        = 0;
+    journal->appendCycles       = 0;
+    journal->appendSyncCycles   = 0;
+    journal->snapshotCycles     = 0;
+    journal->snapshotSyncCycles = 0;
+
+    journal->flushCount    = 0;
+    journal->snapshotCount = 0;
+    journal->lastJobFailed = false;
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoJournalWork)
+{
+    TIMED_FUNCTION();
+
+    Journal *journal     = (Journal *)data;
+    GameMemory *memory   = journal->memory;
+    ThreadContext thread = {};
+    bool32 succeeded     = true;
+
+    JournalBuffer *buffer = journal->flushBuffer;
+    if (buffer->header.recordCount)
+    {
+        MemoryIndex recordsSize = buffer->header.recordCount * sizeof(JournalRecord);
+
+        buffer->header.magicValue = JOURNAL_MAGIC_VALUE;
+        buffer->header.checksum   = Crc32(0, buffer->records, recordsSize);
+
+        uint64 start = __rdtsc();
+        succeeded    = memory->debugPlatformAppendToFile(&thread, journal->logFileName,
+                                                         (uint32)(sizeof(JournalBlockHeader) + recordsSize), buffer);
+
+        uint64 appended = __rdtsc();
+        succeeded       = succeeded && memory->debugPlatformSyncFile(&thread, journal->logFileName);
+
+        journal->appendCycles     = appended - start;
+        journal->appendSyncCycles = __rdtsc() - appended;
+
+        buffer->header.recordCount = 0;
+        ++journal->flushCount;
+    }
+
+    if (journal->writeSnapshot)
+    {
+        uint64 start  = __rdtsc();
+        uint64 synced = start;
+        bool32 saved  = false;
+
+        if (journal->snapshotIsPaged)
+        {
+            saved = CommitMapChunkLog(&thread, memory, &journal->pagedFile, &journal->pagedView, &journal->chunkLog,
+                                      journal->chunkLogFileName);
+        }
+        else
+        {
+            saved = WriteMapSnapshot(&thread, memory, &journal->snapshot, &journal->snapshotArena,
+                                     journal->snapshotFileName);
+
+            // NOTE a chunk log left by a paged world on this file would be applied to the new map, so it goes first.
+            synced = __rdtsc();
+            saved  = saved && memory->debugPlatformSyncFile(&thread, journal->snapshotFileName) &&
+                    memory->debugPlatformWriteEntireFile(&thread, journal->chunkLogFileName, 0, 0) &&
+                    memory->debugPlatformReplaceFile(&thread, journal->snapshotFileName, journal->mapFileName);
+        }
+
+        journal->snapshotCycles     = synced - start;
+        journal->snapshotSyncCycles = __rdtsc() - synced;
+
+        // NOTE the log is only cut once a snapshot holding all of its edits is on disk.
+        if (saved)
+        {
+            saved = memory->debugPlatformWriteEntireFile(&thread, journal->logFileName, 0, 0);
+            ++journal->snapshotCount;
+        }
+
+        succeeded = succeeded && saved;
+    }
+
+    journal->lastJobFailed = !succeeded;
+
+    __sync_synchronize();
+
+    journal->isBusy = false;
+}
+
+internal void BeginJournalSnapshot(Journal *journal, World *world)
+{
+    Assert(!journal->isBusy);
+
+    journal->snapshotArena.used = 0;
+    journal->snapshot           = BeginMapSnapshot(world, &journal->snapshotArena);
+    journal->isStaging          = true;
+    journal->stagedRowCount     = 0;
+}
+
+// NOTE copies up to cellCount more cells of the world into the snapshot being staged, whole rows at a time.
+internal void StageJournalSnapshot(Journal *journal, World *world, MemoryIndex cellCount)
+{
+    int32 rowCount = Max((int32)(cellCount / world->width), 1);
+    int32 minY     = journal->stagedRowCount;
+    int32 maxY     = Min(world->height, minY + rowCount);
+
+    CaptureMapSnapshotRows(&journal->snapshot, world, minY, maxY);
+    journal->stagedRowCount = maxY;
+}
+
+inline void StageJournalPaint(Journal *journal, int32 x, int32 y, uint32 count, Biome biome)
+{
+    MapSnapshot *snapshot = &journal->snapshot;
+
+    int32 minX = Max(x, 0);
+    int32 maxX = Min((int32)(x + count), snapshot->width);
+
+    if (journal->isStaging && y >= 0 && y < journal->stagedRowCount && minX < maxX)
+    {
+        memset(snapshot->biomes + (MemoryIndex)y * snapshot->width + minX, biome, maxX - minX);
+    }
+}
+
+internal void StartJournalJob(Journal *journal, World *world, bool32 writeSnapshot)
+{
+    Assert(!journal->isBusy);
+
+    uint64 start = __rdtsc();
+
+    journal->flushBuffer = journal->buffers[journal->fillIndex];
+    journal->fillIndex ^= 1;
+
+    journal->writeSnapshot = writeSnapshot;
+    if (writeSnapshot)
+    {
+        // NOTE the world keeps changing while the job runs, so whatever the snapshot needs is staged here first.
+        // Paged worlds only copy their dirty chunks into a chunk log, resident ones copy out whatever rows of the
+        // biome plane UpdateJournal hasn't yet.
+        journal->snapshotIsPaged = world->pager != 0;
+        if (journal->snapshotIsPaged)
+        {
+            journal->snapshotArena.used = 0;
+            journal->pagedFile          = world->pager->file;
+            journal->pagedView = world->pager->view;
+            journal->chunkLog  = StageWorldPager(world, &journal->snapshotArena);
+        }
+        else
+        {
+            if (!journal->isStaging)
+            {
+                BeginJournalSnapshot(journal, world);
+            }
+
+            StageJournalSnapshot(journal, world, (MemoryIndex)world->width * world->height);
+            CaptureMapSnapshotEntities(&journal->snapshot, world, &journal->snapshotArena);
+        }
+
+        journal->isStaging = false;
+
+        journal->snapshotRequested     = false;
+        journal->hasEditsSinceSnapshot = false;
+        journal->secondsSinceSnapshot  = 0.0f;
+    }
+
+    journal->secondsSinceFlush = 0.0f;
+    journal->stageCycles       = __rdtsc() - start;
+    journal->isBusy            = true;
+
+    GameMemory *memory = journal->memory;
+    memory->platformAddEntry(memory->lowPriorityQueue, DoJournalWork, journal);
+}
+
+internal void FinishJournalWork(Journal *journal)
+{
+    if (journal->isBusy)
+    {
+        GameMemory *memory = journal->memory;
+        memory->platformCompleteAllWork(memory->lowPriorityQueue);
+    }
+
+    Assert(!journal->isBusy);
+}
+
+// NOTE writes out every edit made so far and waits until it is on disk. A snapshot being staged is dropped, as the
+// world is usually about to be replaced, and staged again from the start when it is next due.
+internal void FlushJournal(Journal *journal, World *world)
+{
+    FinishJournalWork(journal);
+
+    journal->isStaging = false;
+
+    if (journal->buffers[journal->fillIndex]->header.recordCount)
+    {
+        StartJournalJob(journal, world, false);
+        FinishJournalWork(journal);
+    }
+}
+
+internal JournalRecord *AppendJournalRecord(Journal *journal, World *world)
+{
+    JournalBuffer *buffer = journal->buffers[journal->fillIndex];
+
+    if (buffer->header.recordCount == ArrayCount(buffer->records))
+    {
+        // NOTE only happens when edits come in faster than the disk takes them.
+        FinishJournalWork(journal);
+        StartJournalJob(journal, world, false);
+
+        buffer = journal->buffers[journal->fillIndex];
+    }
+
+    journal->hasEditsSinceSnapshot = true;
+
+    JournalRecord *result = buffer->records + buffer->header.recordCount++;
+    return result;
+}
+
+internal void JournalPaint(Journal *journal, World *world, int32 x, int32 y, Biome biome)
+{
+    StageJournalPaint(journal, x, y, 1, biome);
+
+    JournalBuffer *buffer = journal->buffers[journal->fillIndex];
+    JournalRecord *last   = buffer->header.recordCount ? buffer->records + buffer->header.recordCount - 1 : 0;
+
+    bool32 extendsRun = last && last->type == JOURNAL_RECORD_PAINT && last->value == biome && last->y == y &&
+                        last->count < 0xFFFF;
+
+    // NOTE undo walks strokes backwards, so runs grow to the left as often as to the right.
+    if (extendsRun && last->x + last->count == x)
+    {
+        ++last->count;
+    }
+    else if (extendsRun && last->x - 1 == x)
+    {
+        --last->x;
+        ++last->count;
+    }
+    else
+    {
+        JournalRecord *record = AppendJournalRecord(journal, world);
+
+        record->type  = JOURNAL_RECORD_PAINT;
+        record->value = (uint8)biome;
+        record->count = 1;
+        record->x     = x;
+        record->y     = y;
+    }
+}
+
+// NOTE paints count cells starting at x, y, split over as many records as the run needs.
+internal void JournalPaintRun(Journal *journal, World *world, int32 x, int32 y, uint32 count, Biome biome)
+{
+    StageJournalPaint(journal, x, y, count, biome);
+
+    while (count)
+    {
+        uint32 recordCount    = count < 0xFFFF ? count : 0xFFFF;
+        JournalRecord *record = AppendJournalRecord(journal, world);
+
+        record->type  = JOURNAL_RECORD_PAINT;
+        record->value = (uint8)biome;
+        record->count = (uint16)recordCount;
+        record->x     = x;
+        record->y     = y;
+
+        x += recordCount;
+        count -= recordCount;
+    }
+}
+
+internal void JournalEntity(Journal *journal, World *world, JournalRecordType type, int32 x, int32 y,
+                            EntityType entityType)
+{
+    JournalRecord *record = AppendJournalRecord(journal, world);
+
+    record->type  = (uint8)type;
+    record->value = (uint8)entityType;
+    record->count = 1;
+    record->x     = x;
+    record->y     = y;
+}
+
+internal void RequestJournalSnapshot(Journal *journal) { journal->snapshotRequested = true; }
+
+// NOTE called once a frame, hands the edits gathered so far to the low priority queue when they are due.
+internal void UpdateJournal(Journal *journal, World *world, real32 dt)
+{
+    journal->secondsSinceFlush += dt;
+    journal->secondsSinceSnapshot += dt;
+
+    if (!journal->isBusy)
+    {
+        if (journal->lastJobFailed)
+        {
+            // NOTE whatever didn't make it to disk is still in the world, the next snapshot picks it up.
+            journal->hasEditsSinceSnapshot = true;
+            journal->lastJobFailed         = false;
+        }
+
+        bool32 wantsSnapshot =
+            journal->snapshotRequested ||
+            (journal->hasEditsSinceSnapshot && journal->secondsSinceSnapshot >= JOURNAL_SNAPSHOT_SECONDS);
+        bool32 wantsFlush = journal->buffers[journal->fillIndex]->header.recordCount &&
+                            journal->secondsSinceFlush >= JOURNAL_FLUSH_SECONDS;
+
+        uint64 start = __rdtsc();
+
+        // NOTE the job only gets a resident world's snapshot once all of its rows are in.
+        if (wantsSnapshot && !world->pager)
+        {
+            if (!journal->isStaging)
+            {
+                BeginJournalSnapshot(journal, world);
+            }
+
+            StageJournalSnapshot(journal, world, JOURNAL_SNAPSHOT_CELLS_PER_FRAME);
+            wantsSnapshot = journal->stagedRowCount == world->height;
+        }
+
+        if (wantsSnapshot || wantsFlush)
+        {
+            StartJournalJob(journal, world, wantsSnapshot);
+        }
+
+        if (journal->isStaging || wantsSnapshot)
+        {
+            journal->stageCycles = __rdtsc() - start;
+        }
+    }
+}
+
+internal void ApplyJournalRecord(World *world, JournalRecord *record)
+{
+    switch (record->type)
+    {
+        case JOURNAL_RECORD_PAINT:
+        {
+            if (record->value < BIOME_COUNT)
+            {
+                for (uint32 cellIndex = 0; cellIndex < record->count; ++cellIndex)
+                {
+                    Cell *cell = GetCell(world, OffsetCoord{record->x + (int32)cellIndex, record->y});
+                    if (cell)
+                    {
+                        SetCellBiome(world, cell, (Biome)record->value);
+                    }
+                }
+            }
+        }
+        break;
+
+        case JOURNAL_RECORD_PLACE_ENTITY:
+        {
+            Cell *cell = GetCell(world, OffsetCoord{record->x, record->y});
+
+            if (cell && record->value <= ENTITY_CITY && CanAddEntity(world))
+            {
+                PlaceEntity(world, cell, (EntityType)record->value);
+            }
+        }
+        break;
+
+        case JOURNAL_RECORD_REMOVE_ENTITY:
+        {
+            Cell *cell = GetCell(world, OffsetCoord{record->x, record->y});
+
+            if (cell && record->value <= ENTITY_CITY)
+            {
+                uint32 entityIndex = UnlinkEntity(cell, (EntityType)record->value);
+                if (entityIndex)
+                {
+                    RemoveEntity(world, entityIndex);
+                }
+            }
+        }
+        break;
+    }
+}
+
+// NOTE applies every intact block of the log to the world and returns how many records that was.
+internal uint32 ReplayJournal(ThreadContext *thread, GameMemory *memory, World *world, char *fileName)
+{
+    uint32 result = 0;
+
+    DebugReadFileResult file = memory->debugPlatformReadEntireFile(thread, fileName);
+    if (file.contents)
+    {
+        uint8 *at  = (uint8 *)file.contents;
+        uint8 *end = at + file.contentsSize;
+
+        while ((MemoryIndex)(end - at) >= sizeof(JournalBlockHeader))
+        {
+            JournalBlockHeader *header = (JournalBlockHeader *)at;
+            JournalRecord *records     = (JournalRecord *)(header + 1);
+            MemoryIndex recordsLeft    = (end - at - sizeof(JournalBlockHeader)) / sizeof(JournalRecord);
+
+            if (header->magicValue != JOURNAL_MAGIC_VALUE || header->recordCount > recordsLeft ||
+                Crc32(0, records, header->recordCount * sizeof(JournalRecord)) != header->checksum)
+            {
+                break;
+            }
+
+            for (uint32 recordIndex = 0; recordIndex < header->recordCount; ++recordIndex)
+            {
+                ApplyJournalRecord(world, records + recordIndex);
+            }
+
+            result += header->recordCount;
+            at = (uint8 *)(records + header->recordCount);
+        }
+
+        memory->debugPlatformFreeFileMemory(thread, file.contents);
+    }
+
+    return result;
+}
+
+// NOTE loads the last snapshot and replays the log on top of it, or returns 0 if there is no snapshot to load.
+internal World *LoadJournaledWorld(ThreadContext *thread, Journal *journal, MemoryArena *worldArena,
+                                   World *currentWorld)
+{
+    GameMemory *memory = journal->memory;
+    World *result      = LoadWorldMap(thread, memory, worldArena, currentWorld, journal->mapFileName);
+
+    if (result && ReplayJournal(thread, memory, result, journal->logFileName))
+    {
+        journal->hasEditsSinceSnapshot = true;
+    }
+
+    return result;
+}
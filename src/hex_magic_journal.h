@@ -0,0 +1,107 @@
+#if !defined(HEX_MAGIC_JOURNAL)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_map.h"
+
+// NOTE the journal makes editor changes durable without ever writing the whole map on the main thread. Every edit is
+// appended to a log as it happens, and the log is folded into a fresh map snapshot every so often. Loading the
+// snapshot and replaying the log on top of it gives back the world as it was last edited.
+
+#define JOURNAL_MAGIC_VALUE MAP_CODE('h', 'x', 'j', 'l')
+
+#define JOURNAL_BUFFER_RECORD_COUNT (256 * 1024)
+#define JOURNAL_FILE_NAME_LENGTH 64
+
+#define JOURNAL_FLUSH_SECONDS 1.0f
+#define JOURNAL_SNAPSHOT_SECONDS 30.0f
+
+// NOTE how many cells of a resident world's biome plane get copied into the snapshot a frame, about a millisecond.
+#define JOURNAL_SNAPSHOT_CELLS_PER_FRAME (128 * 1024)
+
+enum JournalRecordType
+{
+    JOURNAL_RECORD_PAINT        = 1,
+    JOURNAL_RECORD_PLACE_ENTITY = 2,
+    JOURNAL_RECORD_REMOVE_ENTITY = 3,
+};
+
+#pragma pack(push, 1)
+// NOTE a paint record sets count cells along the row starting at x, y to the biome in value, entity records place or
+// remove the entity type in value at x, y. Replaying a record twice does nothing the first time didn't.
+struct JournalRecord
+{
+    uint8 type;
+    uint8 value;
+    uint16 count;
+
+    int32 x;
+    int32 y;
+};
+
+// NOTE the log is a sequence of blocks, each one a header followed by its records. A block that fails its checksum
+// was torn by a crash and ends the log.
+struct JournalBlockHeader
+{
+    uint32 magicValue;
+    uint32 recordCount;
+    uint32 checksum;
+};
+#pragma pack(pop)
+
+struct JournalBuffer
+{
+    JournalBlockHeader header;
+    JournalRecord records[JOURNAL_BUFFER_RECORD_COUNT];
+};
+
+struct Journal
+{
+    GameMemory *memory;
+
+    char mapFileName[JOURNAL_FILE_NAME_LENGTH];
+    char logFileName[JOURNAL_FILE_NAME_LENGTH];
+    char snapshotFileName[JOURNAL_FILE_NAME_LENGTH];
+    char chunkLogFileName[JOURNAL_FILE_NAME_LENGTH];
+
+    // NOTE edits go into the fill buffer while the other one is being written out.
+    JournalBuffer *buffers[2];
+    uint32 fillIndex;
+
+    // NOTE only one job is ever in flight, which is what keeps appends, snapshots and log truncation in order on
+    // disk. Everything below up to the timings belongs to the job while it is set.
+    bool32 volatile isBusy;
+
+    JournalBuffer *flushBuffer;
+    bool32 writeSnapshot;
+    bool32 snapshotIsPaged;
+    DebugMappedFile pagedFile;
+    MapChunkedView pagedView;
+    MapBuffer chunkLog;
+    MapSnapshot snapshot;
+    MemoryArena snapshotArena;
+
+    // NOTE a resident world is copied into the snapshot a few rows a frame before the job is started. Paints on rows
+    // already copied are written into the snapshot as they are journaled, so it ends up as the world is when the job
+    // starts. The snapshot and its arena aren't the job's until then.
+    bool32 isStaging;
+    int32 stagedRowCount;
+
+    bool32 snapshotRequested;
+    bool32 hasEditsSinceSnapshot;
+    real32 secondsSinceFlush;
+    real32 secondsSinceSnapshot;
+
+    // NOTE cycle counts of the last job, the sync counts cover fsync alone.
+    uint64 stageCycles;
+    uint64 appendCycles;
+    uint64 appendSyncCycles;
+    uint64 snapshotCycles;
+    uint64 snapshotSyncCycles;
+
+    uint32 flushCount;
+    uint32 snapshotCount;
+    bool32 lastJobFailed;
+};
+
+#define HEX_MAGIC_JOURNAL
+#endif
@@ -0,0 +1,429 @@
+#include "hex_magic.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_kernel.h"
+#include "hex_magic_platform.h"
+
+// NOTE ringWeights has the weight of every tap that many steps from the center, from 0 up to radius.
+internal HexKernel MakeHexKernel(int32 radius, real32 *ringWeights)
+{
+    Assert(radius >= 0 && radius <= HEX_KERNEL_MAX_RADIUS);
+
+    HexKernel result = {};
+    result.radius    = radius;
+
+    for (int32 parity = 0; parity < 2; ++parity)
+    {
+        OffsetCoord center = {0, parity};
+        uint32 tapIndex    = 0;
+
+        for (HexSpiralIterator it = BeginHexSpiral(HexFromOffset(center), radius); !it.isDone; NextHexSpiral(&it))
+        {
+            result.tapX[parity][tapIndex] = it.offset.x;
+            result.tapY[tapIndex]         = it.offset.y - parity;
+            result.weights[tapIndex]      = ringWeights[it.ring.radius];
+
+            ++tapIndex;
+        }
+
+        result.tapCount = tapIndex;
+    }
+
+    return result;
+}
+
+// NOTE rows are rounded up to a whole number of the widest vectors, so grids keep whatever they come after in the arena
+// aligned.
+inline int32 GetHexGridStride(int32 width)
+{
+    int32 result = ((width + HEX_GRID_APRON_X - 1) & ~(HEX_GRID_APRON_X - 1)) + 2 * HEX_GRID_APRON_X;
+    return result;
+}
+
+inline MemoryIndex GetHexGridCellCount(int32 width, int32 height)
+{
+    MemoryIndex result = (MemoryIndex)GetHexGridStride(width) * (height + 2 * HEX_GRID_APRON_Y);
+    return result;
+}
+
+internal HexScalarGrid MakeHexScalarGrid(MemoryArena *arena, int32 width, int32 height, int32 rowParity,
+                                         real32 apronValue)
+{
+    HexScalarGrid result;
+
+    result.width      = width;
+    result.height     = height;
+    result.stride     = GetHexGridStride(width);
+    result.rowParity  = rowParity & 1;
+    result.apronValue = apronValue;
+    result.memory     = PushArray(arena, GetHexGridCellCount(width, height), real32);
+    result.values     = result.memory + HEX_GRID_APRON_Y * result.stride + HEX_GRID_APRON_X;
+
+    return result;
+}
+
+internal HexBiomeGrid MakeHexBiomeGrid(MemoryArena *arena, int32 width, int32 height, int32 rowParity)
+{
+    HexBiomeGrid result;
+
+    result.width      = width;
+    result.height     = height;
+    result.stride     = GetHexGridStride(width);
+    result.rowParity  = rowParity & 1;
+    result.apronValue = HEX_GRID_NO_BIOME;
+    result.memory     = PushArray(arena, GetHexGridCellCount(width, height), uint8);
+    result.biomes     = result.memory + HEX_GRID_APRON_Y * result.stride + HEX_GRID_APRON_X;
+
+    return result;
+}
+
+inline real32 *GetHexGridRow(HexScalarGrid *grid, int32 y)
+{
+    real32 *result = grid->values + (MemoryIndex)y * grid->stride;
+    return result;
+}
+
+inline uint8 *GetHexGridRow(HexBiomeGrid *grid, int32 y)
+{
+    uint8 *result = grid->biomes + (MemoryIndex)y * grid->stride;
+    return result;
+}
+
+internal void FillHexGridApron(HexScalarGrid *grid)
+{
+    for (int32 y = -HEX_GRID_APRON_Y; y < grid->height + HEX_GRID_APRON_Y; ++y)
+    {
+        real32 *row = GetHexGridRow(grid, y);
+
+        if (y < 0 || y >= grid->height)
+        {
+            for (int32 x = -HEX_GRID_APRON_X; x < grid->stride - HEX_GRID_APRON_X; ++x)
+            {
+                row[x] = grid->apronValue;
+            }
+        }
+        else
+        {
+            for (int32 x = -HEX_GRID_APRON_X; x < 0; ++x)
+            {
+                row[x] = grid->apronValue;
+            }
+
+            for (int32 x = grid->width; x < grid->stride - HEX_GRID_APRON_X; ++x)
+            {
+                row[x] = grid->apronValue;
+            }
+        }
+    }
+}
+
+internal void FillHexGridApron(HexBiomeGrid *grid)
+{
+    for (int32 y = -HEX_GRID_APRON_Y; y < grid->height + HEX_GRID_APRON_Y; ++y)
+    {
+        uint8 *row = GetHexGridRow(grid, y);
+
+        if (y < 0 || y >= grid->height)
+        {
+            memset(row - HEX_GRID_APRON_X, grid->apronValue, grid->stride);
+        }
+        else
+        {
+            memset(row - HEX_GRID_APRON_X, grid->apronValue, HEX_GRID_APRON_X);
+            memset(row + grid->width, grid->apronValue, grid->stride - HEX_GRID_APRON_X - grid->width);
+        }
+    }
+}
+
+internal void ClearHexGrid(HexScalarGrid *grid, real32 value)
+{
+    for (MemoryIndex index = 0; index < GetHexGridCellCount(grid->width, grid->height); ++index)
+    {
+        grid->memory[index] = value;
+    }
+
+    FillHexGridApron(grid);
+}
+
+// NOTE where each tap is from the cell it is for, in cells of the grid's memory, for rows with the given parity.
+inline void GetHexKernelDeltas(HexKernel *kernel, int32 stride, int32 parity, int32 *deltas)
+{
+    for (uint32 tapIndex = 0; tapIndex < kernel->tapCount; ++tapIndex)
+    {
+        deltas[tapIndex] = kernel->tapY[tapIndex] * stride + kernel->tapX[parity][tapIndex];
+    }
+}
+
+//
+// NOTE SSE2
+//
+
+internal void ConvolveRowSse2(HexKernelPass *pass, int32 *deltas, int32 y, int32 minX, int32 maxX)
+{
+    HexKernel *kernel = pass->kernel;
+    real32 *source    = GetHexGridRow(pass->source, y);
+    real32 *dest      = GetHexGridRow(pass->dest, y);
+    real32 *floorRow  = pass->floor ? GetHexGridRow(pass->floor, y) : 0;
+    real32 *scaleRow  = pass->scale ? GetHexGridRow(pass->scale, y) : 0;
+
+    for (int32 x = minX; x < maxX; x += 4)
+    {
+        __m128 sum = _mm_setzero_ps();
+
+        for (uint32 tapIndex = 0; tapIndex < kernel->tapCount; ++tapIndex)
+        {
+            __m128 value = _mm_loadu_ps(source + x + deltas[tapIndex]);
+            sum          = _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(kernel->weights[tapIndex])));
+        }
+
+        if (floorRow)
+        {
+            sum = _mm_max_ps(sum, _mm_loadu_ps(floorRow + x));
+        }
+
+        if (scaleRow)
+        {
+            sum = _mm_mul_ps(sum, _mm_loadu_ps(scaleRow + x));
+        }
+
+        _mm_storeu_ps(dest + x, sum);
+    }
+}
+
+// NOTE every tap adds two votes for its biome and the center adds one more, so the center wins ties. Biomes are tried
+// in order and only a strictly bigger count takes over, so nothing depends on the order of the taps.
+internal void MajorityRowSse2(HexKernelPass *pass, int32 *deltas, int32 y, int32 minX, int32 maxX)
+{
+    HexKernel *kernel = pass->kernel;
+    uint8 *source     = GetHexGridRow(pass->sourceBiomes, y);
+    uint8 *dest       = GetHexGridRow(pass->destBiomes, y);
+
+    for (int32 x = minX; x < maxX; x += 16)
+    {
+        __m128i center    = _mm_loadu_si128((__m128i *)(source + x));
+        __m128i best      = center;
+        __m128i bestCount = _mm_setzero_si128();
+
+        for (uint32 biome = 0; biome < BIOME_COUNT; ++biome)
+        {
+            __m128i biomeValue = _mm_set1_epi8((int8)biome);
+            __m128i count      = _mm_setzero_si128();
+
+            for (uint32 tapIndex = 0; tapIndex < kernel->tapCount; ++tapIndex)
+            {
+                __m128i tap = _mm_loadu_si128((__m128i *)(source + x + deltas[tapIndex]));
+                count       = _mm_sub_epi8(count, _mm_cmpeq_epi8(tap, biomeValue));
+            }
+
+            count = _mm_sub_epi8(_mm_add_epi8(count, count), _mm_cmpeq_epi8(center, biomeValue));
+
+            __m128i isBetter = _mm_cmpgt_epi8(count, bestCount);
+            best             = _mm_or_si128(_mm_and_si128(isBetter, biomeValue), _mm_andnot_si128(isBetter, best));
+            bestCount        = _mm_or_si128(_mm_and_si128(isBetter, count), _mm_andnot_si128(isBetter, bestCount));
+        }
+
+        _mm_storeu_si128((__m128i *)(dest + x), best);
+    }
+}
+
+//
+// NOTE AVX2
+//
+
+TARGET_AVX2 internal void ConvolveRowAvx2(HexKernelPass *pass, int32 *deltas, int32 y, int32 minX, int32 maxX)
+{
+    HexKernel *kernel = pass->kernel;
+    real32 *source    = GetHexGridRow(pass->source, y);
+    real32 *dest      = GetHexGridRow(pass->dest, y);
+    real32 *floorRow  = pass->floor ? GetHexGridRow(pass->floor, y) : 0;
+    real32 *scaleRow  = pass->scale ? GetHexGridRow(pass->scale, y) : 0;
+
+    for (int32 x = minX; x < maxX; x += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for (uint32 tapIndex = 0; tapIndex < kernel->tapCount; ++tapIndex)
+        {
+            __m256 value = _mm256_loadu_ps(source + x + deltas[tapIndex]);
+            sum          = _mm256_add_ps(sum, _mm256_mul_ps(value, _mm256_set1_ps(kernel->weights[tapIndex])));
+        }
+
+        if (floorRow)
+        {
+            sum = _mm256_max_ps(sum, _mm256_loadu_ps(floorRow + x));
+        }
+
+        if (scaleRow)
+        {
+            sum = _mm256_mul_ps(sum, _mm256_loadu_ps(scaleRow + x));
+        }
+
+        _mm256_storeu_ps(dest + x, sum);
+    }
+}
+
+TARGET_AVX2 internal void MajorityRowAvx2(HexKernelPass *pass, int32 *deltas, int32 y, int32 minX, int32 maxX)
+{
+    HexKernel *kernel = pass->kernel;
+    uint8 *source     = GetHexGridRow(pass->sourceBiomes, y);
+    uint8 *dest       = GetHexGridRow(pass->destBiomes, y);
+
+    for (int32 x = minX; x < maxX; x += 32)
+    {
+        __m256i center    = _mm256_loadu_si256((__m256i *)(source + x));
+        __m256i best      = center;
+        __m256i bestCount = _mm256_setzero_si256();
+
+        for (uint32 biome = 0; biome < BIOME_COUNT; ++biome)
+        {
+            __m256i biomeValue = _mm256_set1_epi8((int8)biome);
+            __m256i count      = _mm256_setzero_si256();
+
+            for (uint32 tapIndex = 0; tapIndex < kernel->tapCount; ++tapIndex)
+            {
+                __m256i tap = _mm256_loadu_si256((__m256i *)(source + x + deltas[tapIndex]));
+                count       = _mm256_sub_epi8(count, _mm256_cmpeq_epi8(tap, biomeValue));
+            }
+
+            count = _mm256_sub_epi8(_mm256_add_epi8(count, count), _mm256_cmpeq_epi8(center, biomeValue));
+
+            __m256i isBetter = _mm256_cmpgt_epi8(count, bestCount);
+            best             = _mm256_blendv_epi8(best, biomeValue, isBetter);
+            bestCount        = _mm256_blendv_epi8(bestCount, count, isBetter);
+        }
+
+        _mm256_storeu_si256((__m256i *)(dest + x), best);
+    }
+}
+
+//
+// NOTE passes
+//
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoHexKernelJob)
+{
+    TIMED_FUNCTION();
+
+    HexKernelJob *job   = (HexKernelJob *)data;
+    HexKernelPass *pass = job->pass;
+    HexKernel *kernel   = pass->kernel;
+
+    int32 stride    = pass->type == HEX_KERNEL_CONVOLVE ? pass->source->stride : pass->sourceBiomes->stride;
+    int32 rowParity = pass->type == HEX_KERNEL_CONVOLVE ? pass->source->rowParity : pass->sourceBiomes->rowParity;
+
+    int32 deltas[2][HEX_KERNEL_MAX_TAP_COUNT];
+    GetHexKernelDeltas(kernel, stride, 0, deltas[0]);
+    GetHexKernelDeltas(kernel, stride, 1, deltas[1]);
+
+    bool32 useAvx2 = GetHexBatchPath() == HEX_BATCH_AVX2;
+
+    for (uint32 tile = job->firstTile; tile < job->firstTile + job->tileCount; ++tile)
+    {
+        int32 minX = (tile % pass->tileCountX) << HEX_KERNEL_TILE_SHIFT;
+        int32 minY = (tile / pass->tileCountX) << HEX_KERNEL_TILE_SHIFT;
+        int32 maxX = Min(pass->width, minX + HEX_KERNEL_TILE_DIM);
+        int32 maxY = Min(pass->height, minY + HEX_KERNEL_TILE_DIM);
+
+        for (int32 y = minY; y < maxY; ++y)
+        {
+            int32 *rowDeltas = deltas[(y + rowParity) & 1];
+
+            if (pass->type == HEX_KERNEL_CONVOLVE)
+            {
+                if (useAvx2)
+                {
+                    ConvolveRowAvx2(pass, rowDeltas, y, minX, maxX);
+                }
+                else
+                {
+                    ConvolveRowSse2(pass, rowDeltas, y, minX, maxX);
+                }
+            }
+            else
+            {
+                if (useAvx2)
+                {
+                    MajorityRowAvx2(pass, rowDeltas, y, minX, maxX);
+                }
+                else
+                {
+                    MajorityRowSse2(pass, rowDeltas, y, minX, maxX);
+                }
+            }
+        }
+    }
+}
+
+// NOTE the last vector of a row runs into the apron of the destination, which is why it gets filled in again after.
+internal void RunHexKernelPass(HexKernelPass *pass, GameMemory *memory, uint32 jobCount)
+{
+    pass->tileCountX = (pass->width + HEX_KERNEL_TILE_DIM - 1) >> HEX_KERNEL_TILE_SHIFT;
+    pass->tileCountY = (pass->height + HEX_KERNEL_TILE_DIM - 1) >> HEX_KERNEL_TILE_SHIFT;
+
+    uint32 tileCount = pass->tileCountX * pass->tileCountY;
+
+    jobCount = jobCount < HEX_KERNEL_MAX_JOB_COUNT ? jobCount : HEX_KERNEL_MAX_JOB_COUNT;
+    jobCount = jobCount < tileCount ? jobCount : tileCount;
+    jobCount = jobCount ? jobCount : 1;
+
+    uint32 tilesPerJob = (tileCount + jobCount - 1) / jobCount;
+    jobCount           = (tileCount + tilesPerJob - 1) / tilesPerJob;
+
+    for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+    {
+        uint32 firstTile = jobIndex * tilesPerJob;
+
+        HexKernelJob *job = pass->jobs + jobIndex;
+        job->pass         = pass;
+        job->firstTile    = firstTile;
+        job->tileCount    = tileCount - firstTile < tilesPerJob ? tileCount - firstTile : tilesPerJob;
+
+        memory->platformAddEntry(memory->highPriorityQueue, DoHexKernelJob, job);
+    }
+
+    memory->platformCompleteAllWork(memory->highPriorityQueue);
+
+    if (pass->type == HEX_KERNEL_CONVOLVE)
+    {
+        FillHexGridApron(pass->dest);
+    }
+    else
+    {
+        FillHexGridApron(pass->destBiomes);
+    }
+}
+
+// NOTE floor and scale can be 0. Source and dest must be different grids.
+internal void ConvolveHexGrid(HexKernel *kernel, HexScalarGrid *source, HexScalarGrid *dest, HexScalarGrid *floor,
+                              HexScalarGrid *scale, GameMemory *memory, uint32 jobCount)
+{
+    Assert(source != dest && source->width == dest->width && source->height == dest->height);
+
+    HexKernelPass pass = {};
+    pass.type          = HEX_KERNEL_CONVOLVE;
+    pass.kernel        = kernel;
+    pass.source        = source;
+    pass.dest          = dest;
+    pass.floor         = floor;
+    pass.scale         = scale;
+    pass.width         = source->width;
+    pass.height        = source->height;
+
+    RunHexKernelPass(&pass, memory, jobCount);
+}
+
+internal void MajorityFilterHexGrid(HexKernel *kernel, HexBiomeGrid *source, HexBiomeGrid *dest, GameMemory *memory,
+                                    uint32 jobCount)
+{
+    Assert(source != dest && source->width == dest->width && source->height == dest->height);
+    Assert(2 * kernel->tapCount + 1 < 128);
+
+    HexKernelPass pass = {};
+    pass.type          = HEX_KERNEL_MAJORITY;
+    pass.kernel        = kernel;
+    pass.sourceBiomes  = source;
+    pass.destBiomes    = dest;
+    pass.width         = source->width;
+    pass.height        = source->height;
+
+    RunHexKernelPass(&pass, memory, jobCount);
+}
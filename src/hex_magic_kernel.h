@@ -0,0 +1,105 @@
+#if !defined(HEX_MAGIC_KERNEL)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+
+// NOTE passes that set every cell of a grid from the cells within a few steps of it. Grids are a single plane of
+// values on the offset grid with an apron of cells around them, so a pass never has to check where the grid ends.
+// Passes go over the grid in square tiles, one job per group of tiles. The source rows a tile reads stay in the cache
+// for the whole tile, and every row is done several cells at a time.
+//
+// The apron is wide enough for the widest vector to run past the last cell of a row, and what it runs into is put back
+// once the pass is done.
+
+#define HEX_KERNEL_MAX_RADIUS 4
+#define HEX_KERNEL_MAX_TAP_COUNT (3 * HEX_KERNEL_MAX_RADIUS * (HEX_KERNEL_MAX_RADIUS + 1) + 1)
+
+#define HEX_GRID_APRON_X 32
+#define HEX_GRID_APRON_Y HEX_KERNEL_MAX_RADIUS
+
+#define HEX_KERNEL_TILE_SHIFT 6
+#define HEX_KERNEL_TILE_DIM (1 << HEX_KERNEL_TILE_SHIFT)
+#define HEX_KERNEL_MAX_JOB_COUNT 64
+
+// NOTE biome grids have this outside of the world, it never matches any biome.
+#define HEX_GRID_NO_BIOME 0xFF
+
+// NOTE the cells within radius steps, as offsets on the offset grid, which are different for even and odd rows. Taps
+// are in order of their distance from the center, the center being the first one.
+struct HexKernel
+{
+    int32 radius;
+    uint32 tapCount;
+
+    int32 tapX[2][HEX_KERNEL_MAX_TAP_COUNT];
+    int32 tapY[HEX_KERNEL_MAX_TAP_COUNT];
+    real32 weights[HEX_KERNEL_MAX_TAP_COUNT];
+};
+
+// NOTE rowParity is whether the first row of the grid is an odd row of the world.
+struct HexScalarGrid
+{
+    int32 width;
+    int32 height;
+    int32 stride;
+    int32 rowParity;
+
+    real32 apronValue;
+    real32 *memory;
+    real32 *values;
+};
+
+struct HexBiomeGrid
+{
+    int32 width;
+    int32 height;
+    int32 stride;
+    int32 rowParity;
+
+    uint8 apronValue;
+    uint8 *memory;
+    uint8 *biomes;
+};
+
+enum HexKernelPassType
+{
+    HEX_KERNEL_CONVOLVE,
+    HEX_KERNEL_MAJORITY,
+};
+
+struct HexKernelPass;
+
+struct HexKernelJob
+{
+    HexKernelPass *pass;
+
+    uint32 firstTile;
+    uint32 tileCount;
+};
+
+// NOTE convolutions sum the weighted taps, then raise the sum to at least the floor and multiply it by the scale,
+// when there are floor and scale grids. Majority filters pick the biome most of the taps have, and keep the one of the
+// center when there's a tie.
+struct HexKernelPass
+{
+    HexKernelPassType type;
+    HexKernel *kernel;
+
+    HexScalarGrid *source;
+    HexScalarGrid *dest;
+    HexScalarGrid *floor;
+    HexScalarGrid *scale;
+
+    HexBiomeGrid *sourceBiomes;
+    HexBiomeGrid *destBiomes;
+
+    int32 width;
+    int32 height;
+    int32 tileCountX;
+    int32 tileCountY;
+
+    HexKernelJob jobs[HEX_KERNEL_MAX_JOB_COUNT];
+};
+
+#define HEX_MAGIC_KERNEL
+#endif
@@ -0,0 +1,863 @@
+#include "hex_magic.h"
+#include "hex_magic_map.h"
+#include "hex_magic_platform.h"
+
+inline uint8 *WriteVarint(uint8 *at, uint32 value)
+{
+    while (value >= 0x80)
+    {
+        *at++ = (uint8)(value | 0x80);
+        value >>= 7;
+    }
+
+    *at++ = (uint8)value;
+
+    return at;
+}
+
+// NOTE returns false for a varint that runs past end or does not fit in 32 bits.
+inline bool32 ReadVarint(uint8 **at, uint8 *end, uint32 *value)
+{
+    bool32 result = false;
+    uint32 shift  = 0;
+
+    *value = 0;
+    while (*at < end && shift < 32)
+    {
+        uint8 byte = *(*at)++;
+        *value |= (uint32)(byte & 0x7F) << shift;
+        shift += 7;
+
+        if (!(byte & 0x80))
+        {
+            // NOTE a fifth byte only has four bits left to give.
+            result = shift < 35 || byte < 0x10;
+            break;
+        }
+    }
+
+    return result;
+}
+
+internal MemoryIndex EncodeBiomeRuns(uint8 *biomes, MemoryIndex cellCount, uint8 *dest)
+{
+    uint8 *at     = dest;
+    uint8 *source = biomes;
+    uint8 *end    = biomes + cellCount;
+
+    while (source < end)
+    {
+        uint8 biome      = *source;
+        uint32 runLength = 0;
+
+        while (source < end && *source == biome)
+        {
+            ++runLength;
+            ++source;
+        }
+
+        *at++ = biome;
+        at    = WriteVarint(at, runLength);
+    }
+
+    return at - dest;
+}
+
+internal uint32 WriteMapEntities(World *world, MapEntity *dest)
+{
+    uint32 result = 0;
+
+    for (uint32 entityIndex = 1; entityIndex <= world->entityCount; ++entityIndex)
+    {
+        Cell *cell = GetEntityCell(world, entityIndex);
+        if (cell)
+        {
+            OffsetCoord offset = OffsetFromHex(cell->coord);
+
+            dest->type = GetEntity(world, entityIndex)->type;
+            dest->x    = offset.x;
+            dest->y    = offset.y;
+
+            ++dest;
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+internal void PlaceMapEntities(World *world, MapEntity *source, uint32 count)
+{
+    for (uint32 entityIndex = 0; entityIndex < count; ++entityIndex, ++source)
+    {
+        Cell *cell = GetCell(world, OffsetCoord{source->x, source->y});
+
+        if (cell && source->type <= ENTITY_CITY && CanAddEntity(world))
+        {
+            PlaceEntity(world, cell, (EntityType)source->type);
+        }
+    }
+}
+
+internal uint32 MapHeaderChecksum(MapHeader *header)
+{
+    uint32 zero   = 0;
+    uint32 result = Crc32(0, header, offsetof(MapHeader, checksum));
+
+    result = Crc32(result, &zero, sizeof(zero));
+    result = Crc32(result, header + 1, header->sectionCount * sizeof(MapSection));
+
+    return result;
+}
+
+// NOTE copies rows minY up to maxY of the biome plane into a snapshot sized for the world.
+internal void CaptureMapSnapshotRows(MapSnapshot *snapshot, World *world, int32 minY, int32 maxY)
+{
+    // NOTE only resident worlds get snapshotted in the game, a paged one gets all of it paged in.
+    uint8 *biome = snapshot->biomes + (MemoryIndex)minY * world->width;
+    for (int32 y = minY; y < maxY; ++y)
+    {
+        if (world->pager && (y == minY || (y & WORLD_CHUNK_MASK) == 0))
+        {
+            PageInWorldBand(world, y);
+        }
+
+        Cell *cell = GetCellRow(world, y);
+        for (int32 x = 0; x < world->width; ++x)
+        {
+            *biome++ = (uint8)(cell++)->biome;
+        }
+    }
+}
+
+internal MapSnapshot BeginMapSnapshot(World *world, MemoryArena *arena)
+{
+    MapSnapshot result = {};
+
+    result.width  = world->width;
+    result.height = world->height;
+    result.biomes = PushArray(arena, ((MemoryIndex)world->width * world->height), uint8);
+
+    return result;
+}
+
+internal void CaptureMapSnapshotEntities(MapSnapshot *snapshot, World *world, MemoryArena *arena)
+{
+    snapshot->entities    = PushArray(arena, world->entityCount, MapEntity);
+    snapshot->entityCount = WriteMapEntities(world, snapshot->entities);
+}
+
+internal MapSnapshot CaptureMapSnapshot(World *world, MemoryArena *arena)
+{
+    MapSnapshot result = BeginMapSnapshot(world, arena);
+
+    CaptureMapSnapshotRows(&result, world, 0, world->height);
+    CaptureMapSnapshotEntities(&result, world, arena);
+
+    return result;
+}
+
+internal MapBuffer EncodeMapSnapshot(MapSnapshot *snapshot, MemoryArena *arena)
+{
+    MapBuffer result = {};
+
+    MemoryIndex cellCount    = (MemoryIndex)snapshot->width * snapshot->height;
+    MemoryIndex maxBiomeSize = 2 * cellCount;
+    MemoryIndex maxSize      = sizeof(MapHeader) + 2 * sizeof(MapSection) + maxBiomeSize +
+                          snapshot->entityCount * sizeof(MapEntity);
+
+    result.memory = (uint8 *)PushSize(arena, maxSize);
+
+    MapHeader *header  = (MapHeader *)result.memory;
+    MapSection *biomes = (MapSection *)(header + 1);
+    MapSection *ents   = biomes + 1;
+    uint8 *at          = (uint8 *)(ents + 1);
+
+    header->magicValue   = MAP_MAGIC_VALUE;
+    header->version      = MAP_VERSION;
+    header->width        = snapshot->width;
+    header->height       = snapshot->height;
+    header->sectionCount = 2;
+    header->checksum     = 0;
+
+    biomes->type   = MAP_SECTION_BIOME_RLE;
+    biomes->offset = at - result.memory;
+    biomes->size   = EncodeBiomeRuns(snapshot->biomes, cellCount, at);
+    at += biomes->size;
+
+    ents->type   = MAP_SECTION_ENTITIES;
+    ents->offset = at - result.memory;
+    ents->size   = snapshot->entityCount * sizeof(MapEntity);
+    memcpy(at, snapshot->entities, ents->size);
+    at += ents->size;
+
+    biomes->checksum = Crc32(0, result.memory + biomes->offset, biomes->size);
+    ents->checksum   = Crc32(0, result.memory + ents->offset, ents->size);
+    header->checksum = MapHeaderChecksum(header);
+
+    result.size = at - result.memory;
+    Assert(result.size <= maxSize);
+
+    return result;
+}
+
+internal MapBuffer EncodeWorldMap(World *world, MemoryArena *arena)
+{
+    MapSnapshot snapshot = CaptureMapSnapshot(world, arena);
+    MapBuffer result     = EncodeMapSnapshot(&snapshot, arena);
+
+    return result;
+}
+
+internal MapHeader *ValidateMap(void *contents, MemoryIndex contentsSize)
+{
+    MapHeader *result = 0;
+    MapHeader *header = (MapHeader *)contents;
+
+    if (contentsSize >= sizeof(MapHeader) && header->magicValue == MAP_MAGIC_VALUE && header->version >= 1 &&
+        header->version <= MAP_VERSION &&
+        header->sectionCount <= (contentsSize - sizeof(MapHeader)) / sizeof(MapSection))
+    {
+        MemoryIndex tableSize = sizeof(MapHeader) + header->sectionCount * sizeof(MapSection);
+        bool32 isValid        = MapHeaderChecksum(header) == header->checksum;
+
+        MapSection *sections = (MapSection *)(header + 1);
+        for (uint32 sectionIndex = 0; isValid && sectionIndex < header->sectionCount; ++sectionIndex)
+        {
+            MapSection *section = sections + sectionIndex;
+
+            isValid = section->offset >= tableSize && section->offset <= contentsSize &&
+                      section->size <= contentsSize - section->offset;
+
+            // NOTE chunk records are verified as they get paged in, touching them all here would defeat the point.
+            if (isValid && section->type != MAP_SECTION_BIOME_CHUNKS)
+            {
+                isValid = Crc32(0, (uint8 *)contents + section->offset, section->size) == section->checksum;
+            }
+        }
+
+        if (isValid)
+        {
+            result = header;
+        }
+    }
+
+    return result;
+}
+
+internal MapSection *FindMapSection(MapHeader *header, uint32 type)
+{
+    MapSection *result   = 0;
+    MapSection *sections = (MapSection *)(header + 1);
+
+    for (uint32 sectionIndex = 0; sectionIndex < header->sectionCount; ++sectionIndex)
+    {
+        if (sections[sectionIndex].type == type)
+        {
+            result = sections + sectionIndex;
+            break;
+        }
+    }
+
+    return result;
+}
+
+// NOTE returns false unless the runs cover exactly cellCount cells with biomes that exist. Writes the cells into world
+// when one is given, so loading can check a map's runs before it lets go of the current world.
+internal bool32 DecodeBiomeRuns(World *world, MemoryIndex cellCount, uint8 *at, uint8 *end)
+{
+    bool32 result         = true;
+    Cell *cell            = world ? world->cells : 0;
+    MemoryIndex cellsLeft = cellCount;
+
+    int32 x = 0;
+    int32 y = 0;
+    while (result && cellsLeft)
+    {
+        uint8 biomeValue = BIOME_COUNT;
+        uint32 runLength = 0;
+
+        result = at < end;
+        if (result)
+        {
+            biomeValue = *at++;
+            result     = ReadVarint(&at, end, &runLength);
+        }
+
+        result = result && biomeValue < BIOME_COUNT && runLength > 0 && runLength <= cellsLeft;
+        if (result)
+        {
+            cellsLeft -= runLength;
+            while (cell && runLength--)
+            {
+                InitializeCell(cell++, x, y, (Biome)biomeValue);
+
+                if (++x == world->width)
+                {
+                    x = 0;
+                    ++y;
+                }
+            }
+        }
+    }
+
+    result = result && at == end;
+
+    return result;
+}
+
+inline bool32 CheckBiomeRuns(MapHeader *header, MapSection *runs)
+{
+    uint8 *at     = (uint8 *)header + runs->offset;
+    bool32 result = DecodeBiomeRuns(0, (MemoryIndex)header->width * header->height, at, at + runs->size);
+
+    return result;
+}
+
+// NOTE expects a validated map with a run-length biome plane whose runs were checked, and an arena with nothing else
+// in it.
+internal World *DecodeRunLengthWorld(MemoryArena *worldArena, MapHeader *header)
+{
+    uint8 *base        = (uint8 *)header;
+    MapSection *biomes = FindMapSection(header, MAP_SECTION_BIOME_RLE);
+    MapSection *ents   = FindMapSection(header, MAP_SECTION_ENTITIES);
+
+    World *world = CreateWorld(worldArena, header->width, header->height);
+
+    uint8 *biomeRuns = base + biomes->offset;
+    bool32 decoded   = DecodeBiomeRuns(world, (MemoryIndex)world->width * world->height, biomeRuns,
+                                       biomeRuns + biomes->size);
+    Assert(decoded);
+
+    AddEntity(world);
+
+    if (ents)
+    {
+        PlaceMapEntities(world, (MapEntity *)(base + ents->offset), (uint32)(ents->size / sizeof(MapEntity)));
+    }
+
+    return world;
+}
+
+internal World *DecodeWorldMap(MemoryArena *worldArena, void *contents, MemoryIndex contentsSize)
+{
+    World *result     = 0;
+    MapHeader *header = ValidateMap(contents, contentsSize);
+    MapSection *runs  = header ? FindMapSection(header, MAP_SECTION_BIOME_RLE) : 0;
+
+    if (runs && WorldFitsInArena(worldArena, header->width, header->height) && CheckBiomeRuns(header, runs))
+    {
+        CheckArena(worldArena);
+        worldArena->used = 0;
+
+        result = DecodeRunLengthWorld(worldArena, header);
+    }
+
+    return result;
+}
+
+inline int32 MapChunkCount(int32 dim)
+{
+    int32 result = (dim + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+    return result;
+}
+
+// NOTE lays out a chunked map of the given size at base, or only measures it when base is 0. Section checksums are
+// left for FinalizeChunkedMap.
+internal MemoryIndex LayoutChunkedMap(uint8 *base, int32 width, int32 height, MapChunkedView *view)
+{
+    uint32 chunkCountX    = MapChunkCount(width);
+    uint32 chunkCountY    = MapChunkCount(height);
+    MemoryIndex chunkSize = WORLD_CHUNK_DIM * WORLD_CHUNK_DIM;
+    uint32 entityCapacity = ArrayCount(((World *)0)->entities);
+
+    MemoryIndex tableOffset  = sizeof(MapHeader) + 3 * sizeof(MapSection);
+    MemoryIndex tableSize    = sizeof(MapChunkTable) + chunkCountX * chunkCountY * sizeof(uint32);
+    MemoryIndex entityOffset = tableOffset + tableSize;
+    MemoryIndex chunkOffset =
+        (entityOffset + entityCapacity * sizeof(MapEntity) + MAP_PAGE_SIZE - 1) & ~(MemoryIndex)(MAP_PAGE_SIZE - 1);
+    MemoryIndex result = chunkOffset + chunkCountX * chunkCountY * chunkSize;
+
+    if (base)
+    {
+        MapHeader *header = (MapHeader *)base;
+
+        header->magicValue   = MAP_MAGIC_VALUE;
+        header->version      = MAP_VERSION;
+        header->width        = width;
+        header->height       = height;
+        header->sectionCount = 3;
+        header->checksum     = 0;
+
+        MapSection *sections = (MapSection *)(header + 1);
+
+        view->header        = header;
+        view->tableSection  = sections + 0;
+        view->entitySection = sections + 1;
+        view->chunkSection  = sections + 2;
+
+        view->tableSection->type   = MAP_SECTION_CHUNK_TABLE;
+        view->tableSection->offset = tableOffset;
+        view->tableSection->size   = tableSize;
+
+        view->entitySection->type   = MAP_SECTION_ENTITIES;
+        view->entitySection->offset = entityOffset;
+        view->entitySection->size   = 0;
+
+        view->chunkSection->type     = MAP_SECTION_BIOME_CHUNKS;
+        view->chunkSection->offset   = chunkOffset;
+        view->chunkSection->size     = result - chunkOffset;
+        view->chunkSection->checksum = 0;
+
+        view->table              = (MapChunkTable *)(base + tableOffset);
+        view->table->chunkDim    = WORLD_CHUNK_DIM;
+        view->table->chunkCountX = chunkCountX;
+        view->table->chunkCountY = chunkCountY;
+        view->table->chunkSize   = (uint32)chunkSize;
+
+        view->chunkChecksums = (uint32 *)(view->table + 1);
+        view->entities       = (MapEntity *)(base + entityOffset);
+        view->entityCapacity = entityCapacity;
+        view->chunkData      = base + chunkOffset;
+    }
+
+    return result;
+}
+
+// NOTE returns a view with no chunk data unless the validated map holds a consistent chunked layout.
+internal MapChunkedView GetChunkedMapView(MapHeader *header)
+{
+    MapChunkedView result = {};
+
+    uint8 *base           = (uint8 *)header;
+    MapSection *table     = FindMapSection(header, MAP_SECTION_CHUNK_TABLE);
+    MapSection *entities  = FindMapSection(header, MAP_SECTION_ENTITIES);
+    MapSection *chunks    = FindMapSection(header, MAP_SECTION_BIOME_CHUNKS);
+    MapChunkedView layout = {};
+
+    if (table && entities && chunks && table->size >= sizeof(MapChunkTable))
+    {
+        MapChunkTable *chunkTable = (MapChunkTable *)(base + table->offset);
+        MemoryIndex chunkCount    = (MemoryIndex)chunkTable->chunkCountX * chunkTable->chunkCountY;
+
+        if (chunkTable->chunkDim == WORLD_CHUNK_DIM && chunkTable->chunkSize == WORLD_CHUNK_DIM * WORLD_CHUNK_DIM &&
+            chunkTable->chunkCountX == MapChunkCount(header->width) &&
+            chunkTable->chunkCountY == MapChunkCount(header->height) &&
+            table->size == sizeof(MapChunkTable) + chunkCount * sizeof(uint32) &&
+            chunks->size == chunkCount * chunkTable->chunkSize && (chunks->offset % MAP_PAGE_SIZE) == 0)
+        {
+            result.header         = header;
+            result.tableSection   = table;
+            result.entitySection  = entities;
+            result.chunkSection   = chunks;
+            result.table          = chunkTable;
+            result.chunkChecksums = (uint32 *)(chunkTable + 1);
+            result.entities       = (MapEntity *)(base + entities->offset);
+            result.entityCapacity = (uint32)((chunks->offset - entities->offset) / sizeof(MapEntity));
+            result.chunkData      = base + chunks->offset;
+        }
+    }
+
+    return result;
+}
+
+internal void FinalizeChunkedMap(MapChunkedView *view)
+{
+    uint8 *base = (uint8 *)view->header;
+
+    view->tableSection->checksum  = Crc32(0, base + view->tableSection->offset, view->tableSection->size);
+    view->entitySection->checksum = Crc32(0, base + view->entitySection->offset, view->entitySection->size);
+    view->header->checksum        = MapHeaderChecksum(view->header);
+}
+
+// NOTE copies a resident chunk out into a chunk record, cells past the map edge are left zero.
+internal void CopyWorldChunk(World *world, uint32 chunkCountX, uint32 chunkIndex, uint8 *dest)
+{
+    int32 minX = (chunkIndex % chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 minY = (chunkIndex / chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 maxX = Min(world->width, minX + WORLD_CHUNK_DIM);
+    int32 maxY = Min(world->height, minY + WORLD_CHUNK_DIM);
+
+    memset(dest, 0, WORLD_CHUNK_DIM * WORLD_CHUNK_DIM);
+
+    for (int32 y = minY; y < maxY; ++y)
+    {
+        uint8 *destRow = dest + (y - minY) * WORLD_CHUNK_DIM;
+        Cell *cell     = GetCellRow(world, y) + minX;
+
+        for (int32 x = minX; x < maxX; ++x)
+        {
+            *destRow++ = (uint8)(cell++)->biome;
+        }
+    }
+}
+
+internal void StoreSnapshotChunk(MapSnapshot *snapshot, MapChunkedView *view, uint32 chunkIndex)
+{
+    MapChunkTable *table = view->table;
+
+    int32 minX = (chunkIndex % table->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 minY = (chunkIndex / table->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 maxX = Min(snapshot->width, minX + WORLD_CHUNK_DIM);
+    int32 maxY = Min(snapshot->height, minY + WORLD_CHUNK_DIM);
+
+    uint8 *dest = view->chunkData + (MemoryIndex)chunkIndex * table->chunkSize;
+    for (int32 y = minY; y < maxY; ++y)
+    {
+        memcpy(dest + (y - minY) * WORLD_CHUNK_DIM, snapshot->biomes + (MemoryIndex)y * snapshot->width + minX,
+               maxX - minX);
+    }
+
+    view->chunkChecksums[chunkIndex] = Crc32(0, dest, table->chunkSize);
+}
+
+// NOTE writes a snapshot out in the chunked layout so it can be opened as a paged world later.
+internal bool32 SaveChunkedMapSnapshot(ThreadContext *thread, GameMemory *memory, MapSnapshot *snapshot,
+                                       char *fileName)
+{
+    bool32 result = false;
+
+    MemoryIndex size     = LayoutChunkedMap(0, snapshot->width, snapshot->height, 0);
+    DebugMappedFile file = memory->debugPlatformMapFile(thread, fileName, size);
+
+    if (file.memory)
+    {
+        MapChunkedView view = {};
+        LayoutChunkedMap((uint8 *)file.memory, snapshot->width, snapshot->height, &view);
+
+        uint32 chunkCount = view.table->chunkCountX * view.table->chunkCountY;
+        for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+        {
+            StoreSnapshotChunk(snapshot, &view, chunkIndex);
+        }
+
+        Assert(snapshot->entityCount <= view.entityCapacity);
+        view.entitySection->size = snapshot->entityCount * sizeof(MapEntity);
+        memcpy(view.entities, snapshot->entities, view.entitySection->size);
+
+        FinalizeChunkedMap(&view);
+
+        result = memory->debugPlatformFlushMappedFile(thread, &file);
+        memory->debugPlatformUnmapFile(thread, &file);
+    }
+
+    return result;
+}
+
+inline uint32 MapChunkLogChecksum(MapChunkLogHeader *header, MemoryIndex size)
+{
+    MapChunkLogHeader checked = *header;
+    checked.checksum          = 0;
+
+    uint32 result = Crc32(0, &checked, sizeof(checked));
+    result        = Crc32(result, header + 1, size - sizeof(MapChunkLogHeader));
+
+    return result;
+}
+
+inline MemoryIndex MapChunkLogSize(uint32 chunkCount, uint32 entityCount)
+{
+    MemoryIndex result = sizeof(MapChunkLogHeader) + chunkCount * (sizeof(uint32) + WORLD_CHUNK_DIM * WORLD_CHUNK_DIM) +
+                         entityCount * sizeof(MapEntity);
+    return result;
+}
+
+// NOTE copies the dirty chunks and the entities of a paged world into a chunk log and clears the dirty list. The
+// mapping isn't touched, so the log can be written back on any thread while the world keeps changing.
+internal MapBuffer StageWorldPager(World *world, MemoryArena *arena)
+{
+    WorldPager *pager = world->pager;
+
+    uint32 chunkCount = pager->dirtyChunkCount;
+    MemoryIndex size  = MapChunkLogSize(chunkCount, world->entityCount);
+
+    MapBuffer result = {};
+    result.memory    = (uint8 *)PushSize(arena, size);
+
+    MapChunkLogHeader *header = (MapChunkLogHeader *)result.memory;
+    uint32 *chunkIndices      = (uint32 *)(header + 1);
+    uint8 *chunks             = (uint8 *)(chunkIndices + chunkCount);
+
+    for (uint32 dirtyIndex = 0; dirtyIndex < chunkCount; ++dirtyIndex)
+    {
+        uint32 chunkIndex = pager->dirtyChunks[dirtyIndex];
+
+        chunkIndices[dirtyIndex] = chunkIndex;
+        CopyWorldChunk(world, pager->chunkCountX, chunkIndex,
+                       chunks + (MemoryIndex)dirtyIndex * WORLD_CHUNK_DIM * WORLD_CHUNK_DIM);
+
+        pager->chunkStates[chunkIndex] &= ~WORLD_CHUNK_DIRTY;
+    }
+
+    pager->dirtyChunkCount = 0;
+
+    MapEntity *entities = (MapEntity *)(chunks + (MemoryIndex)chunkCount * WORLD_CHUNK_DIM * WORLD_CHUNK_DIM);
+
+    header->magicValue  = MAP_CHUNK_LOG_MAGIC_VALUE;
+    header->width       = world->width;
+    header->height      = world->height;
+    header->chunkCount  = chunkCount;
+    header->entityCount = WriteMapEntities(world, entities);
+
+    result.size      = MapChunkLogSize(chunkCount, header->entityCount);
+    header->checksum = MapChunkLogChecksum(header, result.size);
+
+    return result;
+}
+
+// NOTE returns the header of a chunk log that is whole and fits the map it was read next to, 0 for anything else.
+internal MapChunkLogHeader *ValidateMapChunkLog(void *contents, MemoryIndex contentsSize, MemoryIndex mapSize)
+{
+    MapChunkLogHeader *result = 0;
+    MapChunkLogHeader *header = (MapChunkLogHeader *)contents;
+
+    if (contents && contentsSize >= sizeof(MapChunkLogHeader) && header->magicValue == MAP_CHUNK_LOG_MAGIC_VALUE &&
+        header->width > 0 && header->height > 0 && header->entityCount <= ArrayCount(((World *)0)->entities))
+    {
+        uint32 mapChunkCount = MapChunkCount(header->width) * MapChunkCount(header->height);
+
+        if (header->chunkCount <= mapChunkCount &&
+            contentsSize == MapChunkLogSize(header->chunkCount, header->entityCount) &&
+            mapSize == LayoutChunkedMap(0, header->width, header->height, 0) &&
+            header->checksum == MapChunkLogChecksum(header, contentsSize))
+        {
+            uint32 *chunkIndices = (uint32 *)(header + 1);
+
+            result = header;
+            for (uint32 logIndex = 0; logIndex < header->chunkCount; ++logIndex)
+            {
+                if (chunkIndices[logIndex] >= mapChunkCount)
+                {
+                    result = 0;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE writes a chunk log into a chunked map laid out for its size, leaving it to the caller to sync it to disk.
+internal void ApplyMapChunkLog(MapChunkLogHeader *header, MapChunkedView *view)
+{
+    uint32 *chunkIndices = (uint32 *)(header + 1);
+    uint8 *chunks        = (uint8 *)(chunkIndices + header->chunkCount);
+    uint32 chunkSize     = view->table->chunkSize;
+
+    Assert(chunkSize == WORLD_CHUNK_DIM * WORLD_CHUNK_DIM);
+
+    for (uint32 logIndex = 0; logIndex < header->chunkCount; ++logIndex)
+    {
+        uint32 chunkIndex = chunkIndices[logIndex];
+        uint8 *source     = chunks + (MemoryIndex)logIndex * chunkSize;
+
+        memcpy(view->chunkData + (MemoryIndex)chunkIndex * chunkSize, source, chunkSize);
+        view->chunkChecksums[chunkIndex] = Crc32(0, source, chunkSize);
+    }
+
+    Assert(header->entityCount <= view->entityCapacity);
+
+    view->entitySection->size = header->entityCount * sizeof(MapEntity);
+    memcpy(view->entities, chunks + (MemoryIndex)header->chunkCount * chunkSize, view->entitySection->size);
+
+    FinalizeChunkedMap(view);
+}
+
+// NOTE the mapping is written in place, so it is only touched once the log is synced, and the log is only emptied
+// once the mapping is. A crash anywhere in between leaves a log that LoadWorldMap applies again.
+internal bool32 CommitMapChunkLog(ThreadContext *thread, GameMemory *memory, DebugMappedFile *file,
+                                  MapChunkedView *view, MapBuffer *log, char *logFileName)
+{
+    bool32 result = memory->debugPlatformWriteEntireFile(thread, logFileName, SafeTruncateUInt64(log->size),
+                                                         log->memory) &&
+                    memory->debugPlatformSyncFile(thread, logFileName);
+
+    if (result)
+    {
+        ApplyMapChunkLog((MapChunkLogHeader *)log->memory, view);
+
+        result = memory->debugPlatformFlushMappedFile(thread, file) &&
+                 memory->debugPlatformWriteEntireFile(thread, logFileName, 0, 0);
+    }
+
+    return result;
+}
+
+// NOTE brings a mapped map up to date with a chunk log a crash left next to it. The layout is written again from the
+// size in the log, as the header and tables are what a torn write back would have broken.
+internal void RecoverMapChunkLog(ThreadContext *thread, GameMemory *memory, DebugMappedFile *file,
+                                 char *logFileName)
+{
+    DebugReadFileResult log   = memory->debugPlatformReadEntireFile(thread, logFileName);
+    MapChunkLogHeader *header = ValidateMapChunkLog(log.contents, log.contentsSize, file->size);
+
+    if (header)
+    {
+        MapChunkedView view = {};
+        LayoutChunkedMap((uint8 *)file->memory, header->width, header->height, &view);
+        ApplyMapChunkLog(header, &view);
+
+        if (memory->debugPlatformFlushMappedFile(thread, file))
+        {
+            memory->debugPlatformWriteEntireFile(thread, logFileName, 0, 0);
+        }
+    }
+
+    if (log.contents)
+    {
+        memory->debugPlatformFreeFileMemory(thread, log.contents);
+    }
+}
+
+internal bool32 FlushWorldPager(ThreadContext *thread, GameMemory *memory, World *world, MemoryArena *tempArena)
+{
+    WorldPager *pager         = world->pager;
+    TemporaryMemory logMemory = StartTemporaryMemory(tempArena);
+
+    MapBuffer log = StageWorldPager(world, tempArena);
+    bool32 result = CommitMapChunkLog(thread, memory, &pager->file, &pager->view, &log, pager->chunkLogFileName);
+
+    EndTemporaryMemory(logMemory);
+
+    return result;
+}
+
+inline void GetMapChunkLogFileName(char *dest, MemoryIndex destSize, char *mapFileName)
+{
+    snprintf(dest, destSize, "%s.chunks", mapFileName);
+}
+
+internal World *CreatePagedWorld(MemoryArena *worldArena, DebugMappedFile *file, MapChunkedView *view,
+                                 char *fileName)
+{
+    World *world = CreateEmptyWorld(worldArena, view->header->width, view->header->height);
+
+    uint32 bandCount = view->table->chunkCountY;
+    world->cellBands = PushArray(worldArena, bandCount, Cell *);
+    memset(world->cellBands, 0, bandCount * sizeof(Cell *));
+
+    WorldPager *pager  = PushStruct(worldArena, WorldPager);
+    uint32 chunkCount  = view->table->chunkCountX * view->table->chunkCountY;
+    pager->file        = *file;
+    pager->view        = *view;
+    pager->cellArena   = worldArena;
+    pager->chunkCountX = view->table->chunkCountX;
+    pager->chunkCountY = view->table->chunkCountY;
+
+    GetMapChunkLogFileName(pager->chunkLogFileName, sizeof(pager->chunkLogFileName), fileName);
+
+    pager->chunkStates        = PushArray(worldArena, chunkCount, uint8);
+    pager->residentChunkCount = 0;
+    pager->dirtyChunks        = PushArray(worldArena, chunkCount, uint32);
+    pager->dirtyChunkCount    = 0;
+
+    memset(pager->chunkStates, 0, chunkCount * sizeof(uint8));
+
+    world->pager = pager;
+
+    AddEntity(world);
+    PlaceMapEntities(world, view->entities, (uint32)(view->entitySection->size / sizeof(MapEntity)));
+
+    return world;
+}
+
+#define MAP_CHUNKED_MIN_CELL_COUNT (1024 * 1024)
+
+// NOTE picks the layout by size, big maps are written chunked so they get paged in when loaded.
+internal bool32 WriteMapSnapshot(ThreadContext *thread, GameMemory *memory, MapSnapshot *snapshot,
+                                 MemoryArena *tempArena, char *fileName)
+{
+    bool32 result = false;
+
+    if ((MemoryIndex)snapshot->width * snapshot->height >= MAP_CHUNKED_MIN_CELL_COUNT)
+    {
+        result = SaveChunkedMapSnapshot(thread, memory, snapshot, fileName);
+    }
+    else
+    {
+        TemporaryMemory mapMemory = StartTemporaryMemory(tempArena);
+
+        MapBuffer map = EncodeMapSnapshot(snapshot, tempArena);
+        result = memory->debugPlatformWriteEntireFile(thread, fileName, SafeTruncateUInt64(map.size), map.memory);
+
+        EndTemporaryMemory(mapMemory);
+    }
+
+    return result;
+}
+
+internal bool32 SaveWorldMap(ThreadContext *thread, GameMemory *memory, World *world, MemoryArena *tempArena,
+                             char *fileName)
+{
+    bool32 result = false;
+
+    if (world->pager)
+    {
+        result = FlushWorldPager(thread, memory, world, tempArena);
+    }
+    else
+    {
+        TemporaryMemory snapshotMemory = StartTemporaryMemory(tempArena);
+
+        MapSnapshot snapshot = CaptureMapSnapshot(world, tempArena);
+        result               = WriteMapSnapshot(thread, memory, &snapshot, tempArena, fileName);
+
+        EndTemporaryMemory(snapshotMemory);
+    }
+
+    return result;
+}
+
+// NOTE maps the file instead of reading it. Run-length maps are decoded straight out of the mapping, chunked maps
+// keep it and page chunks in as they get touched. The current world is only released once the new map checks out,
+// and a chunk log left next to the map is applied before it gets checked.
+internal World *LoadWorldMap(ThreadContext *thread, GameMemory *memory, MemoryArena *worldArena, World *currentWorld,
+                             char *fileName)
+{
+    World *result = 0;
+
+    DebugMappedFile file = memory->debugPlatformMapFile(thread, fileName, 0);
+    if (file.memory)
+    {
+        char logFileName[MAP_FILE_NAME_LENGTH];
+        GetMapChunkLogFileName(logFileName, sizeof(logFileName), fileName);
+        RecoverMapChunkLog(thread, memory, &file, logFileName);
+
+        MapHeader *header = ValidateMap(file.memory, file.size);
+        if (header)
+        {
+            MapChunkedView view = GetChunkedMapView(header);
+            MapSection *runs    = FindMapSection(header, MAP_SECTION_BIOME_RLE);
+
+            bool32 fits = view.chunkData ? PagedWorldFitsInArena(worldArena, header->width, header->height)
+                                         : runs && WorldFitsInArena(worldArena, header->width, header->height) &&
+                                               CheckBiomeRuns(header, runs);
+            if (fits)
+            {
+                if (currentWorld && currentWorld->pager)
+                {
+                    memory->debugPlatformUnmapFile(thread, &currentWorld->pager->file);
+                }
+
+                CheckArena(worldArena);
+                worldArena->used = 0;
+
+                if (view.chunkData)
+                {
+                    result = CreatePagedWorld(worldArena, &file, &view, fileName);
+                }
+                else
+                {
+                    result = DecodeRunLengthWorld(worldArena, header);
+                }
+            }
+        }
+
+        if (!result || !result->pager)
+        {
+            memory->debugPlatformUnmapFile(thread, &file);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,123 @@
+#if !defined(HEX_MAGIC_MAP)
+
+#include "hex_magic_platform.h"
+
+// NOTE map files are little endian and never contain pointers. A file is a MapHeader followed by the section
+// table, followed by the section payloads at the offsets the table points to.
+
+#define MAP_CODE(a, b, c, d) (((uint32)(a) << 0) | ((uint32)(b) << 8) | ((uint32)(c) << 16) | ((uint32)(d) << 24))
+
+#define MAP_MAGIC_VALUE MAP_CODE('h', 'x', 'm', 'p')
+#define MAP_VERSION 2
+#define MAP_PAGE_SIZE 4096
+#define MAP_FILE_NAME_LENGTH 128
+
+#define MAP_CHUNK_LOG_MAGIC_VALUE MAP_CODE('h', 'x', 'c', 'l')
+
+enum MapSectionType
+{
+    MAP_SECTION_BIOME_RLE = MAP_CODE('b', 'r', 'l', 'e'),
+    MAP_SECTION_ENTITIES  = MAP_CODE('e', 'n', 't', 's'),
+
+    // NOTE added in version 2 for maps that are paged in lazily. Chunk records are page aligned, fixed size and
+    // checksummed one by one in the chunk table, so the section checksum is unused.
+    MAP_SECTION_CHUNK_TABLE  = MAP_CODE('c', 't', 'a', 'b'),
+    MAP_SECTION_BIOME_CHUNKS = MAP_CODE('b', 'c', 'h', 'k'),
+};
+
+#pragma pack(push, 1)
+struct MapHeader
+{
+    uint32 magicValue;
+    uint32 version;
+
+    int32 width;
+    int32 height;
+
+    uint32 sectionCount;
+
+    // NOTE covers the header, with this field zeroed, and the section table.
+    uint32 checksum;
+};
+
+struct MapSection
+{
+    uint32 type;
+    uint32 checksum;
+    uint64 offset;
+    uint64 size;
+};
+
+// NOTE the biome plane is stored in row-major order as runs of a biome byte followed by a LEB128 run length.
+
+struct MapEntity
+{
+    uint32 type;
+    int32 x;
+    int32 y;
+};
+
+// NOTE a chunk record holds chunkDim * chunkDim biome bytes in row-major order, cells past the map edge are zero.
+struct MapChunkTable
+{
+    int32 chunkDim;
+    int32 chunkCountX;
+    int32 chunkCountY;
+    uint32 chunkSize;
+
+    // NOTE followed by one checksum per chunk record
+};
+
+// NOTE written next to a paged map before any of its dirty chunks go into the mapping, and emptied once the mapping is
+// synced. The header is followed by the index of every chunk in the log, their records and then the entities.
+struct MapChunkLogHeader
+{
+    uint32 magicValue;
+
+    int32 width;
+    int32 height;
+
+    uint32 chunkCount;
+    uint32 entityCount;
+
+    // NOTE covers the header, with this field zeroed, and everything after it.
+    uint32 checksum;
+};
+#pragma pack(pop)
+
+struct MapChunkedView
+{
+    MapHeader *header;
+
+    MapSection *tableSection;
+    MapSection *entitySection;
+    MapSection *chunkSection;
+
+    MapChunkTable *table;
+    uint32 *chunkChecksums;
+
+    MapEntity *entities;
+    uint32 entityCapacity;
+
+    uint8 *chunkData;
+};
+
+// NOTE everything that goes into a map file, copied out of the world so it can be encoded and written on any thread.
+struct MapSnapshot
+{
+    int32 width;
+    int32 height;
+    uint8 *biomes;
+
+    uint32 entityCount;
+    MapEntity *entities;
+};
+
+struct MapBuffer
+{
+    MemoryIndex size;
+    uint8 *memory;
+};
+
+#define HEX_MAGIC_MAP
+#endif
@@ -135,6 +135,12 @@ inline uint32 Abs(int32 v)
     return result;
 }
 
+inline real32 Abs(real32 v)
+{
+    real32 result = fabsf(v);
+    return result;
+}
+
 inline real32 Square(real32 v)
 {
     real32 result = v * v;
@@ -159,6 +165,18 @@ inline int32 Max(int32 a, int32 b)
     return result;
 }
 
+inline real32 Min(real32 a, real32 b)
+{
+    real32 result = a < b ? a : b;
+    return result;
+}
+
+inline real32 Max(real32 a, real32 b)
+{
+    real32 result = a > b ? a : b;
+    return result;
+}
+
 inline real32 Clamp(real32 min, real32 value, real32 max)
 {
     real32 result = value;
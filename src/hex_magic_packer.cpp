@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hex_magic.cpp"
+#include "linux_hex_magic_posix.cpp"
+
+// NOTE offline tool that turns the source assets into the asset pack the game maps at startup. Run it from data/ like
+// the game, build.sh does after every build. Anything it can't make sense of stops it, a pack is only written whole.
+
+#define PACKER_ARENA_SIZE Megabytes(256)
+#define PACKER_TEMP_FILE_NAME ASSET_PACK_FILE_NAME ".tmp"
+
+struct PackerAsset
+{
+    Bitmap source;
+    AssetPackEntry *entry;
+};
+
+inline uint64 AlignPackOffset(uint64 offset)
+{
+    uint64 result = (offset + ASSET_PACK_ALIGNMENT - 1) & ~(uint64)(ASSET_PACK_ALIGNMENT - 1);
+    return result;
+}
+
+// NOTE DEBUGLoadBMP trusts the file, so it gets looked at here first. Only what the game's own assets are is taken,
+// uncompressed 32 bit bitmaps with masks, stored bottom up.
+internal bool32 CheckBitmapFile(ThreadContext *thread, GameMemory *memory, char *fileName)
+{
+    bool32 result            = false;
+    DebugReadFileResult file = memory->debugPlatformReadEntireFile(thread, fileName);
+
+    if (file.contentsSize < sizeof(BitmapHeader))
+    {
+        printf("%s: could not read the file\n", fileName);
+    }
+    else
+    {
+        BitmapHeader *header = (BitmapHeader *)file.contents;
+        uint32 colorMask     = header->redMask | header->greenMask | header->blueMask;
+        uint64 pixelSize     = (uint64)header->width * (uint64)header->height * BITMAP_BYTES_PER_PIXEL;
+
+        if (header->fileType != MAP_CODE('B', 'M', 0, 0))
+        {
+            printf("%s: not a bitmap\n", fileName);
+        }
+        else if (header->bitsPerPixel != 32 || header->compression != 3)
+        {
+            printf("%s: only 32 bit bitmaps with masks can be packed\n", fileName);
+        }
+        else if (!header->redMask || !header->greenMask || !header->blueMask || colorMask == 0xFFFFFFFF)
+        {
+            printf("%s: needs a mask for every channel\n", fileName);
+        }
+        else if (header->width < 2 || header->height < 2)
+        {
+            printf("%s: %d by %d is not a size that can be sampled\n", fileName, header->width, header->height);
+        }
+        else if ((uint64)header->bitmapOffset + pixelSize > file.contentsSize)
+        {
+            printf("%s: pixels run past the end of the file\n", fileName);
+        }
+        else
+        {
+            result = true;
+        }
+    }
+
+    if (file.contents)
+    {
+        memory->debugPlatformFreeFileMemory(thread, file.contents);
+    }
+
+    return result;
+}
+
+// NOTE a texel of the mip is the average of the four under it. Texels are premultiplied, so the channels can be
+// averaged on their own.
+internal void DownsampleBitmap(uint32 *source, int32 sourceWidth, uint32 *dest, int32 destWidth, int32 destHeight)
+{
+    for (int32 y = 0; y < destHeight; ++y)
+    {
+        uint32 *sourceRow = source + 2 * y * sourceWidth;
+
+        for (int32 x = 0; x < destWidth; ++x)
+        {
+            uint32 texels[4] = {
+                sourceRow[2 * x],
+                sourceRow[2 * x + 1],
+                sourceRow[2 * x + sourceWidth],
+                sourceRow[2 * x + sourceWidth + 1],
+            };
+
+            uint32 result = 0;
+            for (uint32 shift = 0; shift < 32; shift += 8)
+            {
+                uint32 sum = 0;
+                for (uint32 texelIndex = 0; texelIndex < ArrayCount(texels); ++texelIndex)
+                {
+                    sum += (texels[texelIndex] >> shift) & 0xFF;
+                }
+
+                result |= ((sum + 2) / 4) << shift;
+            }
+
+            *dest++ = result;
+        }
+    }
+}
+
+internal void WriteBitmapAsset(uint8 *pack, PackerAsset *asset)
+{
+    AssetPackEntry *entry = asset->entry;
+    Bitmap *source        = &asset->source;
+
+    uint32 *dest  = (uint32 *)(pack + entry->offset);
+    int32 width   = entry->width;
+    int32 height  = entry->height;
+    int32 rowSize = width * BITMAP_BYTES_PER_PIXEL;
+
+    // NOTE bitmaps are stored bottom up, the pack has rows going down the bitmap like everything else.
+    for (int32 y = 0; y < height; ++y)
+    {
+        memcpy((uint8 *)dest + y * rowSize, (uint8 *)source->memory + y * source->pitch, rowSize);
+    }
+
+    for (uint32 mipIndex = 1; mipIndex < entry->mipCount; ++mipIndex)
+    {
+        uint32 *mip = dest + width * height;
+        DownsampleBitmap(dest, width, mip, width / 2, height / 2);
+
+        dest = mip;
+        width /= 2;
+        height /= 2;
+    }
+}
+
+internal void WriteFontAtlasAsset(uint8 *pack, AssetPackEntry *entry, FontAtlas *fontAtlas)
+{
+    uint8 *at = pack + entry->offset;
+
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        for (uint32 size = 0; size < FONT_SIZE_COUNT; ++size)
+        {
+            Font *source        = &fontAtlas->fonts[style][size];
+            AssetPackFont *dest = (AssetPackFont *)at;
+
+            dest->isValid     = source->isValid;
+            dest->pixelHeight = source->pixelHeight;
+            dest->ascent      = source->ascent;
+            dest->descent     = source->descent;
+            dest->lineAdvance = source->lineAdvance;
+            dest->unitScale   = source->unitScale;
+
+            memcpy(dest->glyphs, source->glyphs, sizeof(dest->glyphs));
+            at += sizeof(AssetPackFont);
+        }
+    }
+
+    memcpy(at, fontAtlas->kerning, sizeof(fontAtlas->kerning));
+    at += sizeof(fontAtlas->kerning);
+
+    Bitmap *atlas = &fontAtlas->bitmap;
+    memcpy(at, atlas->memory, (uint64)atlas->pitch * atlas->height);
+}
+
+int main(int argc, char *args[])
+{
+    ThreadContext thread = {};
+    GameMemory memory    = {};
+
+    memory.debugPlatformFreeFileMemory  = debugPlatformFreeFileMemory;
+    memory.debugPlatformReadEntireFile  = debugPlatformReadEntireFile;
+    memory.debugPlatformWriteEntireFile = debugPlatformWriteEntireFile;
+    memory.debugPlatformReplaceFile     = debugPlatformReplaceFile;
+
+    MemoryArena arena = {};
+    uint8 *arenaBase  = (uint8 *)malloc(PACKER_ARENA_SIZE);
+
+    if (!arenaBase)
+    {
+        printf("Could not initialize packer memory\n");
+        return 1;
+    }
+
+    InitializeArena(&arena, PACKER_ARENA_SIZE, arenaBase);
+
+    AssetPackEntry entries[ASSET_COUNT] = {};
+    PackerAsset assets[ASSET_COUNT]     = {};
+
+    uint64 offset = AlignPackOffset(sizeof(AssetPackHeader) + sizeof(entries));
+
+    for (uint32 assetIndex = 0; assetIndex < ASSET_FONT_ATLAS; ++assetIndex)
+    {
+        char *fileName = globalAssetFileNames[assetIndex];
+
+        if (!CheckBitmapFile(&thread, &memory, fileName))
+        {
+            return 1;
+        }
+
+        PackerAsset *asset = assets + assetIndex;
+        asset->source      = DEBUGLoadBMP(&thread, memory.debugPlatformReadEntireFile, fileName);
+        asset->entry       = entries + assetIndex;
+
+        AssetPackEntry *entry = asset->entry;
+        entry->id             = assetIndex;
+        entry->type           = ASSET_TYPE_BITMAP;
+        entry->width          = asset->source.width;
+        entry->height         = asset->source.height;
+        entry->mipCount       = GetAssetMipCount(entry->width, entry->height);
+        entry->size           = GetAssetBitmapSize(entry->width, entry->height, entry->mipCount);
+        entry->offset         = offset;
+
+        offset = AlignPackOffset(offset + entry->size);
+    }
+
+    FontAtlas *fontAtlas = PushStruct(&arena, FontAtlas);
+    DEBUGLoadFontAtlas(&thread, &memory, fontAtlas, &arena);
+
+    for (uint32 style = 0; style < FONT_STYLE_COUNT; ++style)
+    {
+        if (!fontAtlas->fonts[style][0].isValid)
+        {
+            printf("Could not bake the fonts, style %u is missing\n", style);
+            return 1;
+        }
+    }
+
+    AssetPackEntry *fontEntry = entries + ASSET_FONT_ATLAS;
+    fontEntry->id             = ASSET_FONT_ATLAS;
+    fontEntry->type           = ASSET_TYPE_FONT_ATLAS;
+    fontEntry->width          = fontAtlas->bitmap.width;
+    fontEntry->height         = fontAtlas->bitmap.height;
+    fontEntry->mipCount       = 1;
+    fontEntry->size           = GetAssetFontAtlasSize(fontEntry->width, fontEntry->height);
+    fontEntry->offset         = offset;
+
+    uint64 packSize = fontEntry->offset + fontEntry->size;
+    uint8 *pack     = (uint8 *)calloc(1, packSize);
+
+    if (!pack || packSize > 0xFFFFFFFF)
+    {
+        printf("Could not make a pack of %llu bytes\n", (unsigned long long)packSize);
+        return 1;
+    }
+
+    AssetPackHeader *header = (AssetPackHeader *)pack;
+    header->magicValue      = ASSET_PACK_MAGIC_VALUE;
+    header->version         = ASSET_PACK_VERSION;
+    header->assetCount      = ASSET_COUNT;
+    header->size            = packSize;
+
+    AssetPackEntry *directory = (AssetPackEntry *)(header + 1);
+    memcpy(directory, entries, sizeof(entries));
+
+    header->checksum = GetAssetPackChecksum(header, directory);
+
+    for (uint32 assetIndex = 0; assetIndex < ASSET_FONT_ATLAS; ++assetIndex)
+    {
+        WriteBitmapAsset(pack, assets + assetIndex);
+    }
+
+    WriteFontAtlasAsset(pack, fontEntry, fontAtlas);
+
+    if (!memory.debugPlatformWriteEntireFile(&thread, PACKER_TEMP_FILE_NAME, (uint32)packSize, pack) ||
+        !memory.debugPlatformReplaceFile(&thread, PACKER_TEMP_FILE_NAME, ASSET_PACK_FILE_NAME))
+    {
+        printf("Could not write %s\n", ASSET_PACK_FILE_NAME);
+        return 1;
+    }
+
+    printf("Packed %u assets into %s, %.2f MB\n", ASSET_COUNT, ASSET_PACK_FILE_NAME,
+           (real64)packSize / (1024.0 * 1024.0));
+
+    return 0;
+}
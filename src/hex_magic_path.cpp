@@ -0,0 +1,248 @@
+#include "hex_magic.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_path.h"
+#include "hex_magic_platform.h"
+
+internal PathCostTable MakeHeroPathCosts()
+{
+    PathCostTable result = {};
+
+    result.costs[WATER] = 0;
+    result.costs[GRASS] = 2;
+    result.costs[DIRT]  = 2;
+    result.costs[LAVA]  = 0;
+    result.costs[ROUGH] = 3;
+    result.costs[SAND]  = 3;
+    result.costs[SNOW]  = 4;
+    result.costs[SWAMP] = 6;
+    result.costs[ROCK]  = 0;
+
+    return result;
+}
+
+internal uint32 GetMinimumPathCost(PathCostTable *costs)
+{
+    uint32 result = 0xFF;
+
+    for (uint32 biome = 0; biome < BIOME_COUNT; ++biome)
+    {
+        if (costs->costs[biome] && costs->costs[biome] < result)
+        {
+            result = costs->costs[biome];
+        }
+    }
+
+    return result;
+}
+
+internal void InitializePathfinder(Pathfinder *pathfinder, MemoryArena *arena, MemoryIndex cellCapacity)
+{
+    pathfinder->cellCapacity = cellCapacity;
+    pathfinder->nodes        = PushArray(arena, cellCapacity, PathNode);
+    pathfinder->heap         = PushArray(arena, cellCapacity, PathHeapEntry);
+    pathfinder->generation   = 0;
+    pathfinder->heapCount    = 0;
+
+    memset(pathfinder->nodes, 0, cellCapacity * sizeof(PathNode));
+}
+
+inline void PlacePathHeapEntry(Pathfinder *pathfinder, uint32 heapIndex, PathHeapEntry entry)
+{
+    pathfinder->heap[heapIndex]                  = entry;
+    pathfinder->nodes[entry.cellIndex].heapIndex = heapIndex;
+}
+
+internal void SiftPathHeapUp(Pathfinder *pathfinder, uint32 heapIndex)
+{
+    PathHeapEntry entry = pathfinder->heap[heapIndex];
+
+    while (heapIndex > 0)
+    {
+        uint32 parentIndex = (heapIndex - 1) / 2;
+        if (pathfinder->heap[parentIndex].key <= entry.key)
+        {
+            break;
+        }
+
+        PlacePathHeapEntry(pathfinder, heapIndex, pathfinder->heap[parentIndex]);
+        heapIndex = parentIndex;
+    }
+
+    PlacePathHeapEntry(pathfinder, heapIndex, entry);
+}
+
+internal uint32 PopPathHeap(Pathfinder *pathfinder)
+{
+    Assert(pathfinder->heapCount > 0);
+
+    uint32 result       = pathfinder->heap[0].cellIndex;
+    PathHeapEntry entry = pathfinder->heap[--pathfinder->heapCount];
+    uint32 heapIndex    = 0;
+
+    for (;;)
+    {
+        uint32 childIndex = 2 * heapIndex + 1;
+        if (childIndex >= pathfinder->heapCount)
+        {
+            break;
+        }
+
+        if (childIndex + 1 < pathfinder->heapCount &&
+            pathfinder->heap[childIndex + 1].key < pathfinder->heap[childIndex].key)
+        {
+            ++childIndex;
+        }
+
+        if (entry.key <= pathfinder->heap[childIndex].key)
+        {
+            break;
+        }
+
+        PlacePathHeapEntry(pathfinder, heapIndex, pathfinder->heap[childIndex]);
+        heapIndex = childIndex;
+    }
+
+    if (pathfinder->heapCount)
+    {
+        PlacePathHeapEntry(pathfinder, heapIndex, entry);
+    }
+
+    pathfinder->nodes[result].heapIndex = PATH_CLOSED;
+
+    return result;
+}
+
+inline uint64 MakePathHeapKey(uint32 cost, uint32 estimate)
+{
+    uint64 result = ((uint64)(cost + estimate) << 32) | (0xFFFFFFFF - cost);
+    return result;
+}
+
+internal void BeginPathSearch(Pathfinder *pathfinder)
+{
+    pathfinder->expandedCount = 0;
+    pathfinder->heapCount     = 0;
+
+    if (++pathfinder->generation == 0)
+    {
+        memset(pathfinder->nodes, 0, pathfinder->cellCapacity * sizeof(PathNode));
+        pathfinder->generation = 1;
+    }
+}
+
+// NOTE records a route to index of the given cost unless there already is one at least as cheap, and puts index in
+// the open set if it isn't there yet.
+internal void RelaxPathNode(Pathfinder *pathfinder, uint32 index, uint32 cost, uint32 estimate, uint32 parent)
+{
+    PathNode *node = pathfinder->nodes + index;
+
+    if (node->generation != pathfinder->generation)
+    {
+        node->generation = pathfinder->generation;
+        node->heapIndex  = PATH_NOT_IN_HEAP;
+    }
+    else if (node->heapIndex == PATH_CLOSED || node->cost <= cost)
+    {
+        return;
+    }
+
+    node->cost   = cost;
+    node->parent = parent;
+
+    if (node->heapIndex == PATH_NOT_IN_HEAP)
+    {
+        node->heapIndex = pathfinder->heapCount++;
+    }
+
+    pathfinder->heap[node->heapIndex] = PathHeapEntry{MakePathHeapKey(cost, estimate), index};
+    SiftPathHeapUp(pathfinder, node->heapIndex);
+}
+
+// NOTE whether the last search settled index, which means its cost is final.
+inline bool32 IsPathNodeClosed(Pathfinder *pathfinder, uint32 index)
+{
+    PathNode *node = pathfinder->nodes + index;
+
+    bool32 result = node->generation == pathfinder->generation && node->heapIndex == PATH_CLOSED;
+    return result;
+}
+
+// NOTE returns the path in the given arena. Every step costs at least the cheapest passable biome, which keeps the
+// heuristic from ever overestimating.
+internal Path FindPath(Pathfinder *pathfinder, World *world, PathCostTable *costs, OffsetCoord start,
+                       OffsetCoord goal, MemoryArena *arena)
+{
+    Path result = {};
+
+    Assert((MemoryIndex)world->width * world->height <= pathfinder->cellCapacity);
+
+    uint32 minCost = GetMinimumPathCost(costs);
+
+    BeginPathSearch(pathfinder);
+
+    PathNode *nodes = pathfinder->nodes;
+
+    Cell *startCell = GetCell(world, start);
+    Cell *goalCell  = GetCell(world, goal);
+
+    if (startCell && goalCell && costs->costs[goalCell->biome])
+    {
+        HexCoord goalHex  = goalCell->coord;
+        uint32 startIndex = GetCellIndex(world, startCell);
+        uint32 goalIndex  = GetCellIndex(world, goalCell);
+
+        RelaxPathNode(pathfinder, startIndex, 0, minCost * Distance(startCell->coord, goalHex), startIndex);
+
+        while (pathfinder->heapCount)
+        {
+            uint32 cellIndex = PopPathHeap(pathfinder);
+            ++pathfinder->expandedCount;
+
+            if (cellIndex == goalIndex)
+            {
+                result.found = true;
+                break;
+            }
+
+            Cell *cell  = GetCellByIndex(world, cellIndex);
+            uint32 cost = nodes[cellIndex].cost;
+
+            for (uint32 directionIndex = 0; directionIndex < ArrayCount(globalHexDirections); ++directionIndex)
+            {
+                Cell *neighbour = GetCell(world, cell->coord + globalHexDirections[directionIndex]);
+                if (!neighbour || !costs->costs[neighbour->biome])
+                {
+                    continue;
+                }
+
+                RelaxPathNode(pathfinder, GetCellIndex(world, neighbour), cost + costs->costs[neighbour->biome],
+                              minCost * Distance(neighbour->coord, goalHex), cellIndex);
+            }
+        }
+
+        if (result.found)
+        {
+            result.cost      = nodes[goalIndex].cost;
+            result.cellCount = 1;
+
+            for (uint32 cellIndex = goalIndex; cellIndex != startIndex; cellIndex = nodes[cellIndex].parent)
+            {
+                ++result.cellCount;
+            }
+
+            result.cells = PushArray(arena, result.cellCount, OffsetCoord);
+
+            uint32 cellIndex = goalIndex;
+            for (uint32 pathIndex = result.cellCount; pathIndex > 0; --pathIndex)
+            {
+                OffsetCoord *at = result.cells + pathIndex - 1;
+                at->x           = (int32)(cellIndex % world->width);
+                at->y           = (int32)(cellIndex / world->width);
+
+                cellIndex = nodes[cellIndex].parent;
+            }
+        }
+    }
+
+    return result;
+}
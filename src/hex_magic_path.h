@@ -0,0 +1,60 @@
+#if !defined(HEX_MAGIC_PATH)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+
+// NOTE A* over the cells of the world. The per cell search state lives as long as the pathfinder and is stamped with
+// the generation of the query that last wrote it, so a new query starts by bumping the generation instead of clearing
+// anything.
+
+#define PATH_NOT_IN_HEAP 0xFFFFFFFF
+#define PATH_CLOSED 0xFFFFFFFE
+
+// NOTE cost of moving into a cell of each biome, 0 means it can't be entered at all.
+struct PathCostTable
+{
+    uint8 costs[BIOME_COUNT];
+};
+
+struct PathNode
+{
+    uint32 generation;
+    uint32 cost;
+    uint32 parent;
+
+    // NOTE position in the open set, or one of PATH_NOT_IN_HEAP and PATH_CLOSED.
+    uint32 heapIndex;
+};
+
+struct PathHeapEntry
+{
+    // NOTE the estimated total cost in the high half, ties go to the entry furthest along.
+    uint64 key;
+    uint32 cellIndex;
+};
+
+struct Pathfinder
+{
+    MemoryIndex cellCapacity;
+    PathNode *nodes;
+    uint32 generation;
+
+    PathHeapEntry *heap;
+    uint32 heapCount;
+
+    // NOTE cells taken out of the open set by the last query.
+    uint32 expandedCount;
+};
+
+// NOTE cells from start to goal, both included. Found is false when the goal can't be reached.
+struct Path
+{
+    bool32 found;
+    uint32 cost;
+
+    uint32 cellCount;
+    OffsetCoord *cells;
+};
+
+#define HEX_MAGIC_PATH
+#endif
@@ -75,7 +75,21 @@ struct ThreadContext
     int placeholder;
 };
 
-#if HEX_MAGIC_INTERNAL
+struct PlatformMappedFile
+{
+    uint64 size;
+    void *memory;
+};
+
+// NOTE maps the whole file read only and private, for data that ships with the game and is never written back.
+#define PLATFORM_MAP_READ_ONLY_FILE(name) PlatformMappedFile name(ThreadContext *thread, char *fileName)
+typedef PLATFORM_MAP_READ_ONLY_FILE(PlatformMapReadOnlyFile);
+
+#define PLATFORM_UNMAP_FILE(name) void name(ThreadContext *thread, PlatformMappedFile *file)
+typedef PLATFORM_UNMAP_FILE(PlatformUnmapFile);
+
+// NOTE the game memory always has these, maps and the journal go through them, so they are declared whether or not
+// this is an internal build.
 struct DebugReadFileResult
 {
     uint32 contentsSize;
@@ -92,8 +106,97 @@ typedef DEBUG_PLATFORM_READ_ENTIRE_FILE(DEBUGPlatformReadEntireFile);
     bool32 name(ThreadContext *thread, char *fileName, uint32 memorySize, void *memory)
 typedef DEBUG_PLATFORM_WRITE_ENTIRE_FILE(DEBUGPlatformWriteEntireFile);
 
+struct DebugMappedFile
+{
+    uint64 size;
+    void *memory;
+};
+
+// NOTE maps the file shared and writable. A non-zero size creates or resizes the file before mapping it.
+#define DEBUG_PLATFORM_MAP_FILE(name) DebugMappedFile name(ThreadContext *thread, char *fileName, uint64 size)
+typedef DEBUG_PLATFORM_MAP_FILE(DEBUGPlatformMapFile);
+
+#define DEBUG_PLATFORM_UNMAP_FILE(name) void name(ThreadContext *thread, DebugMappedFile *file)
+typedef DEBUG_PLATFORM_UNMAP_FILE(DEBUGPlatformUnmapFile);
+
+#define DEBUG_PLATFORM_FLUSH_MAPPED_FILE(name) bool32 name(ThreadContext *thread, DebugMappedFile *file)
+typedef DEBUG_PLATFORM_FLUSH_MAPPED_FILE(DEBUGPlatformFlushMappedFile);
+
+#define DEBUG_PLATFORM_APPEND_TO_FILE(name)                                                                            \
+    bool32 name(ThreadContext *thread, char *fileName, uint32 memorySize, void *memory)
+typedef DEBUG_PLATFORM_APPEND_TO_FILE(DEBUGPlatformAppendToFile);
+
+// NOTE blocks until everything written to the file so far is on disk.
+#define DEBUG_PLATFORM_SYNC_FILE(name) bool32 name(ThreadContext *thread, char *fileName)
+typedef DEBUG_PLATFORM_SYNC_FILE(DEBUGPlatformSyncFile);
+
+// NOTE atomically moves sourceFileName over destFileName.
+#define DEBUG_PLATFORM_REPLACE_FILE(name) bool32 name(ThreadContext *thread, char *sourceFileName, char *destFileName)
+typedef DEBUG_PLATFORM_REPLACE_FILE(DEBUGPlatformReplaceFile);
+
+#if HEX_MAGIC_INTERNAL
+#include <x86intrin.h>
+
+// NOTE every thread that runs a timed block gets events of its own, so recording one never waits on another thread.
+// Each thread writes into one of two arrays while the platform reads the other one, swapping them at the end of every
+// frame.
+#define DEBUG_MAX_THREAD_COUNT 64
+#define DEBUG_MAX_EVENT_COUNT (1 << 16)
+
+enum DebugEventType
+{
+    DEBUG_EVENT_BEGIN_BLOCK,
+    DEBUG_EVENT_END_BLOCK,
+};
+
+// NOTE block names point into the game code, they go bad once it gets reloaded.
+struct DebugEvent
+{
+    uint64 clock;
+    char *blockName;
+    uint32 type;
+};
+
+// NOTE only the thread itself writes its event counts, so recording an event doesn't need a locked instruction. The
+// platform zeroes the count of an array before handing it out again.
+struct DebugThreadEvents
+{
+    uint64 threadId;
+    uint32 volatile eventCounts[2];
+
+    uint32 collatedEventCount;
+    uint32 droppedEventCount;
+
+    DebugEvent events[2][DEBUG_MAX_EVENT_COUNT];
+};
+
+struct DebugTable
+{
+    uint32 volatile arrayIndex;
+    uint32 collatedArrayIndex;
+    uint32 volatile threadCount;
+
+    // NOTE what the platform measured of the frame it collated last, to put the events against.
+    real32 targetSecondsPerFrame;
+    real32 collatedSecondsElapsed;
+    uint64 collatedClockCount;
+
+    // NOTE where every thread keeps a pointer to its events, as the distance from the thread pointer to a thread local
+    // of the platform, see GetDebugThreadSlot.
+    int64 threadSlotOffset;
+
+    DebugThreadEvents threads[DEBUG_MAX_THREAD_COUNT];
+};
 #endif
 
+struct PlatformWorkQueue;
+
+#define PLATFORM_WORK_QUEUE_CALLBACK(name) void name(PlatformWorkQueue *queue, void *data)
+typedef PLATFORM_WORK_QUEUE_CALLBACK(PlatformWorkQueueCallback);
+
+typedef void PlatformAddEntry(PlatformWorkQueue *queue, PlatformWorkQueueCallback *callback, void *data);
+typedef void PlatformCompleteAllWork(PlatformWorkQueue *queue);
+
 struct GameOffscreenBuffer
 {
     void *memory;
@@ -119,7 +222,7 @@ struct GameKeyboardInput
 {
     union
     {
-        GameButtonState buttons[14];
+        GameButtonState buttons[21];
         struct
         {
             GameButtonState moveUp;
@@ -133,13 +236,22 @@ struct GameKeyboardInput
             GameButtonState actionRight;
 
             GameButtonState cancel;
+            GameButtonState endTurn;
 
             GameButtonState toggleMode;
             GameButtonState nextBiome;
             GameButtonState nextEntity;
+            GameButtonState nextTool;
 
             GameButtonState save;
             GameButtonState load;
+            GameButtonState generate;
+
+            GameButtonState undo;
+            GameButtonState redo;
+
+            GameButtonState toggleProfiler;
+            GameButtonState freezeProfiler;
         };
     };
 };
@@ -184,8 +296,175 @@ struct GameMemory
     DEBUGPlatformFreeFileMemory *debugPlatformFreeFileMemory;
     DEBUGPlatformReadEntireFile *debugPlatformReadEntireFile;
     DEBUGPlatformWriteEntireFile *debugPlatformWriteEntireFile;
+    DEBUGPlatformMapFile *debugPlatformMapFile;
+    DEBUGPlatformUnmapFile *debugPlatformUnmapFile;
+    DEBUGPlatformFlushMappedFile *debugPlatformFlushMappedFile;
+    DEBUGPlatformAppendToFile *debugPlatformAppendToFile;
+    DEBUGPlatformSyncFile *debugPlatformSyncFile;
+    DEBUGPlatformReplaceFile *debugPlatformReplaceFile;
+
+    // NOTE the high priority queue is for work the frame waits on, the low priority queue runs on its own thread
+    // for anything that may take longer than a frame, like disk IO.
+    PlatformWorkQueue *highPriorityQueue;
+    PlatformWorkQueue *lowPriorityQueue;
+
+    // NOTE 0 on a single core, where nothing runs the high priority work until the main thread waits on it.
+    uint32 highPriorityWorkerCount;
+
+    PlatformAddEntry *platformAddEntry;
+    PlatformCompleteAllWork *platformCompleteAllWork;
+
+    PlatformMapReadOnlyFile *platformMapReadOnlyFile;
+    PlatformUnmapFile *platformUnmapFile;
+
+    // NOTE hash of the simulation at the end of the last update, for the platform to log. Two runs fed the same input
+    // have to come out with the same hash on every frame.
+    uint64 debugStateHash;
+
+#if HEX_MAGIC_INTERNAL
+    // NOTE owned by the platform so the events outlive a reload of the game code.
+    DebugTable *debugTable;
+
+    // NOTE for the profiler, kept apart from the rest of the game memory so that looping a replay doesn't take the
+    // frames it has collected back in time with it.
+    uint64 debugStorageSize;
+    void *debugStorage;
+#endif
 };
 
+#if HEX_MAGIC_INTERNAL
+// NOTE the game code sets this once a frame.
+extern DebugTable *globalDebugTable;
+
+// NOTE fs points at the thread's own control block, which is the same whichever code asks for it.
+inline uint64 GetThreadId()
+{
+    uint64 result;
+    asm volatile("mov %%fs:0, %0" : "=r"(result));
+    return result;
+}
+
+// NOTE thread locals of the platform are the same distance from the thread pointer on every thread, so the slot is a
+// single load away, where a thread local of the game code would be a call into the dynamic loader. It also outlives
+// reloads of the game code.
+inline DebugThreadEvents *GetDebugThreadSlot(DebugTable *table)
+{
+    DebugThreadEvents *result;
+    asm volatile("mov %%fs:(%1), %0" : "=r"(result) : "r"(table->threadSlotOffset));
+    return result;
+}
+
+inline void SetDebugThreadSlot(DebugTable *table, DebugThreadEvents *events)
+{
+    asm volatile("mov %0, %%fs:(%1)" : : "r"(events), "r"(table->threadSlotOffset) : "memory");
+}
+
+internal DebugThreadEvents *RegisterDebugThread(DebugTable *table)
+{
+    DebugThreadEvents *result = 0;
+    uint64 threadId           = GetThreadId();
+    uint32 threadCount        = table->threadCount;
+
+    for (uint32 threadIndex = 0; threadIndex < threadCount && threadIndex < DEBUG_MAX_THREAD_COUNT; ++threadIndex)
+    {
+        if (table->threads[threadIndex].threadId == threadId)
+        {
+            result = table->threads + threadIndex;
+        }
+    }
+
+    if (!result)
+    {
+        uint32 threadIndex = __sync_fetch_and_add(&table->threadCount, 1);
+
+        // NOTE threads past the last events just don't record anything.
+        if (threadIndex < DEBUG_MAX_THREAD_COUNT)
+        {
+            result           = table->threads + threadIndex;
+            result->threadId = threadId;
+        }
+    }
+
+    SetDebugThreadSlot(table, result);
+    return result;
+}
+
+// NOTE blocks look their events up once and keep them for the end.
+inline DebugThreadEvents *GetDebugThreadEvents()
+{
+    DebugThreadEvents *result = 0;
+
+    DebugTable *table = globalDebugTable;
+    if (table)
+    {
+        result = GetDebugThreadSlot(table);
+        if (!result)
+        {
+            result = RegisterDebugThread(table);
+        }
+    }
+
+    return result;
+}
+
+// NOTE reads the clock once and does nothing else that could take long, a timed block costs two of these.
+inline void RecordDebugEvent(DebugThreadEvents *thread, char *blockName, DebugEventType type)
+{
+    if (thread)
+    {
+        uint32 arrayIndex = globalDebugTable->arrayIndex;
+        uint32 eventIndex = thread->eventCounts[arrayIndex];
+
+        if (eventIndex < DEBUG_MAX_EVENT_COUNT)
+        {
+            DebugEvent *event = thread->events[arrayIndex] + eventIndex;
+            event->clock      = __rdtsc();
+            event->blockName  = blockName;
+            event->type       = type;
+        }
+
+        // NOTE x86 doesn't reorder stores, the compiler just mustn't count the event before it is written.
+        asm volatile("" ::: "memory");
+        thread->eventCounts[arrayIndex] = eventIndex + 1;
+    }
+}
+
+struct TimedBlock
+{
+    char *blockName;
+    DebugThreadEvents *thread;
+
+    TimedBlock(char *blockNameInit)
+    {
+        blockName = blockNameInit;
+        thread    = GetDebugThreadEvents();
+
+        RecordDebugEvent(thread, blockName, DEBUG_EVENT_BEGIN_BLOCK);
+    }
+
+    ~TimedBlock()
+    {
+        RecordDebugEvent(thread, blockName, DEBUG_EVENT_END_BLOCK);
+    }
+};
+
+// NOTE TIMED_BLOCK and TIMED_FUNCTION last until the end of the scope they are in, BEGIN_TIMED_BLOCK and
+// END_TIMED_BLOCK are for parts of a function that don't have a scope of their own.
+#define TIMED_BLOCK__(blockName, number) TimedBlock timedBlock_##number(blockName)
+#define TIMED_BLOCK_(blockName, number) TIMED_BLOCK__(blockName, number)
+#define TIMED_BLOCK(blockName) TIMED_BLOCK_(blockName, __LINE__)
+#define TIMED_FUNCTION() TIMED_BLOCK((char *)__FUNCTION__)
+
+#define BEGIN_TIMED_BLOCK(id) RecordDebugEvent(GetDebugThreadEvents(), #id, DEBUG_EVENT_BEGIN_BLOCK)
+#define END_TIMED_BLOCK(id) RecordDebugEvent(GetDebugThreadEvents(), #id, DEBUG_EVENT_END_BLOCK)
+#else
+#define TIMED_BLOCK(blockName)
+#define TIMED_FUNCTION()
+
+#define BEGIN_TIMED_BLOCK(id)
+#define END_TIMED_BLOCK(id)
+#endif
+
 #define GAME_UPDATE_AND_RENDER(name)                                                                                   \
     void name(ThreadContext *thread, GameMemory *memory, GameInput *input, GameOffscreenBuffer *buffer)
 
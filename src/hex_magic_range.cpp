@@ -0,0 +1,176 @@
+#include "hex_magic.h"
+#include "hex_magic_flow.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_path.h"
+#include "hex_magic_platform.h"
+#include "hex_magic_range.h"
+
+internal void InitializeMovementRange(MovementRange *range, MemoryArena *arena)
+{
+    MemoryIndex cellCount = RANGE_MAX_DIM * RANGE_MAX_DIM;
+
+    range->mask.bits  = PushArray(arena, (cellCount + 63) / 64, uint64);
+    range->costs      = PushArray(arena, cellCount, uint16);
+    range->entryCosts = PushArray(arena, cellCount, uint8);
+    range->mask.dim   = 0;
+    range->cellCount  = 0;
+
+    InitializeFlowDialQueue(&range->queue, arena, cellCount);
+}
+
+// NOTE rows of the parallelogram are runs of consecutive cells in offset coordinates, so they are loaded a span at a
+// time.
+internal void LoadMovementRangeCosts(MovementRange *range, World *world, PathCostTable *costs)
+{
+    int32 dim = range->mask.dim;
+
+    for (int32 localR = 0; localR < dim; ++localR)
+    {
+        int32 r          = range->mask.minR + localR;
+        int32 firstX     = range->mask.minQ + (r - (r & 1)) / 2;
+        int32 minX       = Max(firstX, 1);
+        int32 maxX       = Min(firstX + dim - 1, world->width - 1);
+        uint8 *entryCost = range->entryCosts + localR * dim;
+
+        memset(entryCost, 0, dim);
+
+        if (r > 0 && r < world->height && minX <= maxX)
+        {
+            Cell *cell = GetCellSpan(world, r, minX, maxX, false);
+            for (int32 x = minX; x <= maxX; ++x)
+            {
+                entryCost[x - firstX] = costs->costs[(cell++)->biome];
+            }
+        }
+    }
+}
+
+// NOTE sizes the parallelogram around origin for movePoints and clears it, entry costs are loaded after.
+internal void BeginMovementRange(MovementRange *range, HexCoord origin, uint32 movePoints, uint32 minimumCost)
+{
+    if (movePoints >= RANGE_UNREACHABLE)
+    {
+        movePoints = RANGE_UNREACHABLE - 1;
+    }
+
+    uint32 radius = movePoints / minimumCost;
+    if (radius > RANGE_MAX_RADIUS)
+    {
+        radius = RANGE_MAX_RADIUS;
+    }
+
+    int32 dim = 2 * radius + 1;
+
+    range->origin     = origin;
+    range->movePoints = movePoints;
+    range->radius     = radius;
+    range->mask.minQ  = origin.q - (int32)radius;
+    range->mask.minR  = origin.r - (int32)radius;
+    range->mask.dim   = dim;
+    range->cellCount  = 0;
+
+    memset(range->mask.bits, 0, ((dim * dim + 63) / 64) * sizeof(uint64));
+    memset(range->costs, 0xFF, dim * dim * sizeof(uint16));
+}
+
+// NOTE same as LoadMovementRangeCosts, but from a grid of entry costs with a byte per cell in offset coordinates.
+internal void LoadMovementRangeGridCosts(MovementRange *range, uint8 *cellCosts, int32 width, int32 height)
+{
+    int32 dim = range->mask.dim;
+
+    for (int32 localR = 0; localR < dim; ++localR)
+    {
+        int32 r          = range->mask.minR + localR;
+        int32 firstX     = range->mask.minQ + (r - (r & 1)) / 2;
+        int32 minX       = Max(firstX, 0);
+        int32 maxX       = Min(firstX + dim - 1, width - 1);
+        uint8 *entryCost = range->entryCosts + localR * dim;
+
+        memset(entryCost, 0, dim);
+
+        if (r >= 0 && r < height && minX <= maxX)
+        {
+            memcpy(entryCost + (minX - firstX), cellCosts + (MemoryIndex)r * width + minX, maxX - minX + 1);
+        }
+    }
+}
+
+// NOTE bounded Dijkstra from origin, with the open set in buckets since costs are small. Cells are only added to the
+// mask once they come out of the queue, which is when their cost is final.
+internal void SearchMovementRange(MovementRange *range)
+{
+    int32 dim         = range->mask.dim;
+    uint32 movePoints = range->movePoints;
+
+    int32 neighbourOffsets[6];
+    for (uint32 direction = 0; direction < 6; ++direction)
+    {
+        neighbourOffsets[direction] = globalHexDirections[direction].r * dim + globalHexDirections[direction].q;
+    }
+
+    FlowDialQueue *queue = &range->queue;
+    uint32 originIndex   = range->radius * dim + range->radius;
+
+    range->costs[originIndex] = 0;
+    PushFlowDial(queue, originIndex, 0);
+
+    while (queue->count)
+    {
+        uint32 index = PopFlowDial(queue);
+        uint32 cost  = range->costs[index];
+
+        range->mask.bits[index >> 6] |= (uint64)1 << (index & 63);
+        ++range->cellCount;
+
+        int32 q = index % dim;
+        int32 r = index / dim;
+
+        for (uint32 direction = 0; direction < 6; ++direction)
+        {
+            int32 neighbourQ = q + globalHexDirections[direction].q;
+            int32 neighbourR = r + globalHexDirections[direction].r;
+
+            if (neighbourQ < 0 || neighbourR < 0 || neighbourQ >= dim || neighbourR >= dim)
+            {
+                continue;
+            }
+
+            uint32 neighbour = index + neighbourOffsets[direction];
+            uint32 entryCost = range->entryCosts[neighbour];
+            uint32 routeCost = cost + entryCost;
+
+            if (entryCost && routeCost <= movePoints && routeCost < range->costs[neighbour])
+            {
+                if (IsFlowQueued(queue, neighbour))
+                {
+                    RemoveFlowDial(queue, neighbour, range->costs[neighbour]);
+                }
+
+                range->costs[neighbour] = (uint16)routeCost;
+                PushFlowDial(queue, neighbour, routeCost);
+            }
+        }
+    }
+}
+
+internal void FindMovementRange(MovementRange *range, World *world, PathCostTable *costs, HexCoord origin,
+                                uint32 movePoints)
+{
+    BeginMovementRange(range, origin, movePoints, GetMinimumPathCost(costs));
+    LoadMovementRangeCosts(range, world, costs);
+    SearchMovementRange(range);
+}
+
+// NOTE move points left after getting to hex, or -1 when it is out of range.
+inline int32 GetMovementRangePointsLeft(MovementRange *range, HexCoord hex)
+{
+    int32 result = -1;
+
+    if (IsInHexMask(&range->mask, hex))
+    {
+        uint32 index = (hex.r - range->mask.minR) * range->mask.dim + (hex.q - range->mask.minQ);
+        result       = (int32)range->movePoints - range->costs[index];
+    }
+
+    return result;
+}
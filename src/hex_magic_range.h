@@ -0,0 +1,34 @@
+#if !defined(HEX_MAGIC_RANGE)
+
+#include "hex_magic_platform.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_flow.h"
+#include "hex_magic_path.h"
+
+// NOTE every cell a hero can get to with the move points it has left. No route can take it further than its move
+// points over the cheapest biome, so the search only ever looks at the parallelogram of cells within that many steps.
+// The parallelogram is sized for the longest range up front and reused by every query.
+
+#define RANGE_MAX_RADIUS 64
+#define RANGE_MAX_DIM (2 * RANGE_MAX_RADIUS + 1)
+#define RANGE_UNREACHABLE 0xFFFF
+
+struct MovementRange
+{
+    HexCoord origin;
+    uint32 movePoints;
+    uint32 radius;
+
+    // NOTE the cells that can be reached, and the move points it takes to get to each of them. Costs are only
+    // meaningful for cells in the mask.
+    HexMask mask;
+    uint16 *costs;
+    uint32 cellCount;
+
+    // NOTE cost of entering each cell of the parallelogram, 0 for cells that can't be entered or aren't in the world.
+    uint8 *entryCosts;
+    FlowDialQueue queue;
+};
+
+#define HEX_MAGIC_RANGE
+#endif
@@ -85,6 +85,19 @@ internal void RendererPushRectangle(Renderer *renderer, V2 position, V2 dimensio
     }
 }
 
+internal void RendererPushScreenRectangle(Renderer *renderer, V2 min, V2 max, V4 color)
+{
+    RendererEntryScreenRectangle *entry =
+        PushRenderElement(renderer, RendererEntryScreenRectangle, RENDERER_ENTRY_SCREEN_RECTANGLE);
+
+    if (entry)
+    {
+        entry->min   = min;
+        entry->max   = max;
+        entry->color = color;
+    }
+}
+
 internal void RendererPushHex(Renderer *renderer, V2 position, V4 color, Bitmap *texture)
 {
     RendererEntryHex *entry = PushRenderElement(renderer, RendererEntryHex, RENDERER_ENTRY_HEX);
@@ -97,6 +110,17 @@ internal void RendererPushHex(Renderer *renderer, V2 position, V4 color, Bitmap
     }
 }
 
+internal void RendererPushHexMask(Renderer *renderer, HexMask *mask, V4 color)
+{
+    RendererEntryHexMask *entry = PushRenderElement(renderer, RendererEntryHexMask, RENDERER_ENTRY_HEX_MASK);
+
+    if (entry)
+    {
+        entry->mask  = *mask;
+        entry->color = color;
+    }
+}
+
 internal void RendererPushBitmap(Renderer *renderer, V2 position, Bitmap *bitmap)
 {
     RendererEntryBitmap *entry = PushRenderElement(renderer, RendererEntryBitmap, RENDERER_ENTRY_BITMAP);
@@ -108,6 +132,31 @@ internal void RendererPushBitmap(Renderer *renderer, V2 position, Bitmap *bitmap
     }
 }
 
+// NOTE the entry is padded so the one after it starts on a pointer boundary again.
+inline MemoryIndex GetTextEntrySize(uint32 length)
+{
+    MemoryIndex result = sizeof(RendererEntryText) + ((length + 7) & ~7);
+    return result;
+}
+
+internal void RendererPushText(Renderer *renderer, Font *font, V2 position, char *text, V4 color)
+{
+    uint32 length = (uint32)strlen(text);
+
+    RendererEntryText *entry =
+        (RendererEntryText *)PushRenderElement_(renderer, GetTextEntrySize(length), RENDERER_ENTRY_TEXT);
+
+    if (entry)
+    {
+        entry->position = position;
+        entry->font     = font;
+        entry->color    = color;
+        entry->length   = length;
+
+        memcpy(entry + 1, text, length);
+    }
+}
+
 internal void DrawRectangle(GameOffscreenBuffer *buffer, V2 vMin, V2 vMax, V4 c)
 {
     int32 minX = RoundReal32ToInt32(vMin.x);
@@ -197,7 +246,30 @@ inline V4 BilinearBlend(BilinearSample sample, real32 fX, real32 fY)
     return result;
 }
 
-internal void DrawHex(GameOffscreenBuffer *buffer, Renderer *renderer, V2 worldPosition, V4 color, Bitmap *texture)
+// NOTE mips follow the bitmap in memory, each one half the size of the one before it.
+inline Bitmap GetBitmapMip(Bitmap *bitmap, uint32 level)
+{
+    Bitmap result = *bitmap;
+
+    uint32 mipCount = bitmap->mipCount ? bitmap->mipCount : 1;
+    Assert(level < mipCount);
+
+    for (uint32 mipIndex = 0; mipIndex < level; ++mipIndex)
+    {
+        Assert(result.pitch > 0);
+
+        result.memory = (uint8 *)result.memory + result.pitch * result.height;
+        result.width /= 2;
+        result.height /= 2;
+        result.pitch = result.width * BITMAP_BYTES_PER_PIXEL;
+    }
+
+    result.mipCount = mipCount - level;
+
+    return result;
+}
+
+internal void DrawHex(GameOffscreenBuffer *buffer, Renderer *renderer, V2 worldPosition, V4 color, Bitmap *bitmap)
 {
     real32 sqrt3      = Sqrt(3);
     Camera *camera    = renderer->camera;
@@ -235,6 +307,19 @@ internal void DrawHex(GameOffscreenBuffer *buffer, Renderer *renderer, V2 worldP
 
     real32 invTextureWorldSize = 0.5;
 
+    // NOTE zoomed out far enough for more than a texel to fall on a pixel, a smaller mip is sampled instead, so the
+    // texture doesn't shimmer and fewer cache lines get pulled in for it.
+    uint32 mipLevel       = 0;
+    real32 texelsPerPixel = invTextureWorldSize * (bitmap->width - 1) / scale;
+    while (texelsPerPixel >= 2.0f && mipLevel + 1 < bitmap->mipCount)
+    {
+        texelsPerPixel *= 0.5f;
+        ++mipLevel;
+    }
+
+    Bitmap mip      = GetBitmapMip(bitmap, mipLevel);
+    Bitmap *texture = &mip;
+
     uint8 *destRow = (uint8 *)buffer->memory + minX * BITMAP_BYTES_PER_PIXEL + minY * buffer->pitch;
     for (int32 y = minY; y < maxY; ++y)
     {
@@ -268,10 +353,11 @@ internal void DrawHex(GameOffscreenBuffer *buffer, Renderer *renderer, V2 worldP
                 BilinearSample source = SampleBilinear(texture, tYi, tXi);
                 V4 texel              = BilinearBlend(source, fX, fY);
 
+                // NOTE tints blend the colour in by their alpha and leave the coverage of the texel alone. Texels are
+                // premultiplied, so the colour is too.
                 if (color.a > 0.0)
                 {
-                    // TODO temp hack, should decide how we want to implement the tint
-                    texel = Lerp(texel, color, color.a);
+                    texel.rgb = Lerp(texel.rgb, texel.a * color.rgb, color.a);
                 }
 
                 V4 d      = Unpack(*dest);
@@ -409,8 +495,172 @@ internal void DrawBitmap(GameOffscreenBuffer *buffer, Bitmap *bitmap, V2 origin,
     }
 }
 
+inline uint32 Multiply255(uint32 a, uint32 b)
+{
+    uint32 product = a * b + 128;
+    uint32 result  = (product + (product >> 8)) >> 8;
+
+    return result;
+}
+
+// NOTE a * b / 255 in every 16 bit lane, rounded the same way as Multiply255.
+inline __m128i Multiply255Sse2(__m128i a, __m128i b)
+{
+    __m128i product = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+    __m128i result  = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+
+    return result;
+}
+
+// NOTE four texels of the white atlas tinted by the premultiplied colour, which has a lane for every channel of two
+// pixels, over four pixels of the screen. Channels are worked on in 16 bit lanes, two pixels to a register.
+inline __m128i BlendTextSse2(__m128i texels, __m128i pixels, __m128i color)
+{
+    __m128i zero       = _mm_setzero_si128();
+    __m128i maxChannel = _mm_set1_epi16(255);
+
+    __m128i sourceLow  = Multiply255Sse2(_mm_unpacklo_epi8(texels, zero), color);
+    __m128i sourceHigh = Multiply255Sse2(_mm_unpackhi_epi8(texels, zero), color);
+
+    // NOTE the alpha of each pixel is its fourth lane, spread over all four for the blend.
+    __m128i inverseLow  = _mm_sub_epi16(maxChannel, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sourceLow, 0xFF), 0xFF));
+    __m128i inverseHigh = _mm_sub_epi16(maxChannel, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sourceHigh, 0xFF), 0xFF));
+
+    __m128i destLow  = Multiply255Sse2(_mm_unpacklo_epi8(pixels, zero), inverseLow);
+    __m128i destHigh = Multiply255Sse2(_mm_unpackhi_epi8(pixels, zero), inverseHigh);
+
+    __m128i result = _mm_packus_epi16(_mm_add_epi16(sourceLow, destLow), _mm_add_epi16(sourceHigh, destHigh));
+    return result;
+}
+
+// NOTE the atlas is white, so a texel is the coverage in every channel and tinting it is scaling the colour by it.
+// Glyphs are blended four pixels at a time in 16 bit lanes, four pixels the glyph doesn't cover are skipped and four
+// it covers fully with an opaque colour are just stored.
+internal void DrawText(GameOffscreenBuffer *buffer, RendererEntryText *entry)
+{
+    Font *font     = entry->font;
+    Bitmap *atlas  = font->atlas;
+    V4 color       = entry->color;
+    real32 opacity = Clamp01(color.a);
+
+    uint32 alpha    = RoundReal32ToUint32(255.0f * opacity);
+    uint32 red      = RoundReal32ToUint32(255.0f * opacity * Clamp01(color.r));
+    uint32 green    = RoundReal32ToUint32(255.0f * opacity * Clamp01(color.g));
+    uint32 blue     = RoundReal32ToUint32(255.0f * opacity * Clamp01(color.b));
+    uint32 solid    = (alpha << 24) | (red << 16) | (green << 8) | blue;
+    bool32 isOpaque = alpha == 255;
+
+    __m128i zero         = _mm_setzero_si128();
+    __m128i fullCoverage = _mm_set1_epi32(-1);
+    __m128i solidWide    = _mm_set1_epi32((int32)solid);
+    __m128i colorWide    = _mm_set_epi16((int16)alpha, (int16)red, (int16)green, (int16)blue, (int16)alpha,
+                                         (int16)red, (int16)green, (int16)blue);
+
+    char *text          = (char *)(entry + 1);
+    real32 penX         = entry->position.x;
+    int32 baselineY     = RoundReal32ToInt32(entry->position.y + font->ascent);
+    FontGlyph *previous = 0;
+
+    for (uint32 characterIndex = 0; characterIndex < entry->length; ++characterIndex)
+    {
+        FontGlyph *glyph = GetFontGlyph(font, text[characterIndex]);
+
+        if (glyph)
+        {
+            penX += GetFontKerning(font, previous, glyph);
+
+            int32 minX    = RoundReal32ToInt32(penX) + glyph->offsetX;
+            int32 minY    = baselineY + glyph->offsetY;
+            int32 maxX    = minX + GetFontGlyphCellWidth(glyph);
+            int32 maxY    = minY + glyph->height;
+            int32 sourceX = glyph->x;
+            int32 sourceY = glyph->y;
+
+            if (minX < 0)
+            {
+                sourceX -= minX;
+                minX = 0;
+            }
+
+            if (minY < 0)
+            {
+                sourceY -= minY;
+                minY = 0;
+            }
+
+            if (maxX > buffer->width)
+            {
+                maxX = buffer->width;
+            }
+
+            if (maxY > buffer->height)
+            {
+                maxY = buffer->height;
+            }
+
+            int32 width = maxX - minX;
+
+            uint8 *sourceRow = (uint8 *)atlas->memory + sourceY * atlas->pitch + sourceX * BITMAP_BYTES_PER_PIXEL;
+            uint8 *destRow   = (uint8 *)buffer->memory + minY * buffer->pitch + minX * BITMAP_BYTES_PER_PIXEL;
+
+            for (int32 y = minY; y < maxY; ++y)
+            {
+                uint32 *source = (uint32 *)sourceRow;
+                uint32 *dest   = (uint32 *)destRow;
+                int32 x        = 0;
+
+                for (; x + 4 <= width; x += 4)
+                {
+                    __m128i texels = _mm_loadu_si128((__m128i *)(source + x));
+
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi32(texels, zero)) == 0xFFFF)
+                    {
+                        continue;
+                    }
+
+                    if (isOpaque && _mm_movemask_epi8(_mm_cmpeq_epi32(texels, fullCoverage)) == 0xFFFF)
+                    {
+                        _mm_storeu_si128((__m128i *)(dest + x), solidWide);
+                    }
+                    else
+                    {
+                        __m128i pixels = _mm_loadu_si128((__m128i *)(dest + x));
+                        _mm_storeu_si128((__m128i *)(dest + x), BlendTextSse2(texels, pixels, colorWide));
+                    }
+                }
+
+                // NOTE only glyphs cut off by the edge of the screen have pixels left over.
+                for (; x < width; ++x)
+                {
+                    uint32 coverage = source[x] & 0xFF;
+
+                    if (coverage)
+                    {
+                        uint32 pixel   = dest[x];
+                        uint32 inverse = 255 - Multiply255(coverage, alpha);
+
+                        dest[x] = ((Multiply255(coverage, alpha) + Multiply255(pixel >> 24, inverse)) << 24) |
+                                  ((Multiply255(coverage, red) + Multiply255((pixel >> 16) & 0xFF, inverse)) << 16) |
+                                  ((Multiply255(coverage, green) + Multiply255((pixel >> 8) & 0xFF, inverse)) << 8) |
+                                  (Multiply255(coverage, blue) + Multiply255(pixel & 0xFF, inverse));
+                    }
+                }
+
+                sourceRow += atlas->pitch;
+                destRow += buffer->pitch;
+            }
+
+            penX += glyph->advance;
+        }
+
+        previous = glyph;
+    }
+}
+
 internal void RenderToOutput(GameOffscreenBuffer *output, Renderer *renderer)
 {
+    RendererEntryHexMask *hexMask = 0;
+
     for (uint32 baseAddress = 0; baseAddress < renderer->pushBufferSize;)
     {
         RendererEntryHeader *baseEntry = (RendererEntryHeader *)(renderer->pushBufferBase + baseAddress);
@@ -444,16 +694,39 @@ internal void RenderToOutput(GameOffscreenBuffer *output, Renderer *renderer)
             }
             break;
 
+            case RENDERER_ENTRY_SCREEN_RECTANGLE:
+            {
+                RendererEntryScreenRectangle *render = (RendererEntryScreenRectangle *)baseEntry;
+                DrawRectangle(output, render->min, render->max, render->color);
+
+                baseAddress += sizeof(*render);
+            }
+            break;
+
             case RENDERER_ENTRY_HEX:
             {
                 RendererEntryHex *render = (RendererEntryHex *)baseEntry;
+                V4 color                 = render->color;
+
+                if (hexMask && color.a <= 0.0f && IsInHexMask(&hexMask->mask, V2ToHex(render->position)))
+                {
+                    color = hexMask->color;
+                }
 
-                DrawHex(output, renderer, render->position, render->color, render->texture);
+                DrawHex(output, renderer, render->position, color, render->texture);
 
                 baseAddress += sizeof(*render);
             }
             break;
 
+            case RENDERER_ENTRY_HEX_MASK:
+            {
+                hexMask = (RendererEntryHexMask *)baseEntry;
+
+                baseAddress += sizeof(*hexMask);
+            }
+            break;
+
             case RENDERER_ENTRY_BITMAP:
             {
                 RendererEntryBitmap *render = (RendererEntryBitmap *)baseEntry;
@@ -473,6 +746,15 @@ internal void RenderToOutput(GameOffscreenBuffer *output, Renderer *renderer)
             }
             break;
 
+            case RENDERER_ENTRY_TEXT:
+            {
+                RendererEntryText *render = (RendererEntryText *)baseEntry;
+                DrawText(output, render);
+
+                baseAddress += GetTextEntrySize(render->length);
+            }
+            break;
+
             default:
             {
                 InvalidCodePath;
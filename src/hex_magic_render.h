@@ -3,6 +3,7 @@
 
 #include "hex_magic_platform.h"
 #include "hex_magic_math.h"
+#include "hex_magic_font.h"
 
 struct BilinearSample
 {
@@ -15,6 +16,9 @@ enum RendererEntryType
     RENDERER_ENTRY_RECTANGLE,
     RENDERER_ENTRY_HEX,
     RENDERER_ENTRY_BITMAP,
+    RENDERER_ENTRY_SCREEN_RECTANGLE,
+    RENDERER_ENTRY_HEX_MASK,
+    RENDERER_ENTRY_TEXT,
 };
 
 struct RendererEntryHeader
@@ -37,6 +41,16 @@ struct RendererEntryRectangle
     V4 color;
 };
 
+// NOTE in pixels from the top left corner of the screen, for overlays that don't move with the camera.
+struct RendererEntryScreenRectangle
+{
+    RendererEntryHeader header;
+
+    V2 min;
+    V2 max;
+    V4 color;
+};
+
 struct RendererEntryHex
 {
     RendererEntryHeader header;
@@ -46,6 +60,15 @@ struct RendererEntryHex
     Bitmap *texture;
 };
 
+// NOTE tints every hex drawn after it whose cell is in the mask and which has no tint of its own.
+struct RendererEntryHexMask
+{
+    RendererEntryHeader header;
+
+    HexMask mask;
+    V4 color;
+};
+
 struct RendererEntryBitmap
 {
     RendererEntryHeader header;
@@ -54,6 +77,19 @@ struct RendererEntryBitmap
     Bitmap *bitmap;
 };
 
+// NOTE a line of text with its top left corner at position in pixels from the top left corner of the screen. The
+// characters are copied in right after the entry, so the string only has to live until it is pushed.
+struct RendererEntryText
+{
+    RendererEntryHeader header;
+
+    V2 position;
+    Font *font;
+    V4 color;
+
+    uint32 length;
+};
+
 struct Renderer
 {
     Camera *camera;
@@ -0,0 +1,360 @@
+#include "hex_magic.h"
+#include "hex_magic_platform.h"
+#include "hex_magic_turn.h"
+
+inline Fixed FixedMultiply(Fixed a, Fixed b)
+{
+    Fixed result = (a * b) >> FIXED_SHIFT;
+    return result;
+}
+
+inline int64 RoundFixedToInt64(Fixed value)
+{
+    int64 result = (value + FIXED_ONE / 2) >> FIXED_SHIFT;
+    return result;
+}
+
+// NOTE what a mine digs up depends on the ground it was put on.
+internal ResourceKind GetResourceKind(Biome biome)
+{
+    ResourceKind result = RESOURCE_GOLD;
+
+    switch (biome)
+    {
+        case GRASS:
+        case SWAMP:
+        {
+            result = RESOURCE_WOOD;
+        }
+        break;
+
+        case ROUGH:
+        case ROCK:
+        {
+            result = RESOURCE_ORE;
+        }
+        break;
+
+        case SNOW:
+        case LAVA:
+        {
+            result = RESOURCE_CRYSTAL;
+        }
+        break;
+
+        default:
+        {
+            result = RESOURCE_GOLD;
+        }
+        break;
+    }
+
+    return result;
+}
+
+internal Fixed GetResourceYield(ResourceKind kind)
+{
+    Fixed result = 0;
+
+    switch (kind)
+    {
+        case RESOURCE_GOLD:
+        {
+            result = 1000 * FIXED_ONE;
+        }
+        break;
+
+        case RESOURCE_WOOD:
+        case RESOURCE_ORE:
+        {
+            result = 2 * FIXED_ONE;
+        }
+        break;
+
+        case RESOURCE_CRYSTAL:
+        {
+            result = FIXED_ONE;
+        }
+        break;
+
+        default:
+        {
+            InvalidCodePath;
+        }
+        break;
+    }
+
+    return result;
+}
+
+inline uint8 GetEconomyBucket(uint32 owner, ResourceKind kind)
+{
+    uint32 row   = owner < MAX_PLAYER_COUNT ? owner : MAX_PLAYER_COUNT;
+    uint8 result = (uint8)(row * RESOURCE_KIND_COUNT + kind);
+
+    return result;
+}
+
+internal void InitializeEconomy(Economy *economy, MemoryArena *arena, uint32 cityCapacity, uint32 resourceCapacity,
+                                uint32 heroCapacity)
+{
+    EconomyCities *cities     = &economy->cities;
+    cities->capacity          = cityCapacity;
+    cities->entityIndices     = PushArray(arena, cityCapacity, uint32);
+    cities->populations       = PushArray(arena, cityCapacity, Fixed);
+    cities->capacities        = PushArray(arena, cityCapacity, Fixed);
+    cities->inverseCapacities = PushArray(arena, cityCapacity, Fixed);
+    cities->buckets           = PushArray(arena, cityCapacity, uint8);
+
+    EconomyResources *resources = &economy->resources;
+    resources->capacity         = resourceCapacity;
+    resources->entityIndices    = PushArray(arena, resourceCapacity, uint32);
+    resources->yields           = PushArray(arena, resourceCapacity, Fixed);
+    resources->buckets          = PushArray(arena, resourceCapacity, uint8);
+
+    EconomyHeroes *heroes = &economy->heroes;
+    heroes->capacity      = heroCapacity;
+    heroes->entityIndices = PushArray(arena, heroCapacity, uint32);
+    heroes->movePoints    = PushArray(arena, heroCapacity, uint32);
+    heroes->owners        = PushArray(arena, heroCapacity, uint8);
+}
+
+// NOTE every player starts with the same stockpiles, and whoever owns a city or a hero gets a turn.
+internal void ClearEconomy(Economy *economy)
+{
+    economy->isDirty       = false;
+    economy->turnIndex     = 0;
+    economy->currentPlayer = 0;
+
+    economy->cities.count    = 0;
+    economy->resources.count = 0;
+    economy->heroes.count    = 0;
+
+    for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+    {
+        economy->isPlaying[player] = false;
+
+        economy->stockpiles[player][RESOURCE_GOLD]    = 5000 * FIXED_ONE;
+        economy->stockpiles[player][RESOURCE_WOOD]    = 10 * FIXED_ONE;
+        economy->stockpiles[player][RESOURCE_ORE]     = 10 * FIXED_ONE;
+        economy->stockpiles[player][RESOURCE_CRYSTAL] = 0;
+    }
+
+    economy->lastResolveCycles = 0;
+    economy->lastJobCount      = 0;
+}
+
+internal void AddEconomyCity(Economy *economy, uint32 entityIndex, uint32 owner, Fixed population, Fixed capacity)
+{
+    EconomyCities *cities = &economy->cities;
+    Assert(cities->count < cities->capacity && capacity > 0);
+
+    uint32 index = cities->count++;
+
+    cities->entityIndices[index]     = entityIndex;
+    cities->populations[index]       = population;
+    cities->capacities[index]        = capacity;
+    cities->inverseCapacities[index] = (FIXED_ONE << FIXED_SHIFT) / capacity;
+    cities->buckets[index]           = GetEconomyBucket(owner, RESOURCE_GOLD);
+
+    if (owner < MAX_PLAYER_COUNT)
+    {
+        economy->isPlaying[owner] = true;
+    }
+}
+
+internal void AddEconomyResource(Economy *economy, uint32 entityIndex, uint32 owner, ResourceKind kind)
+{
+    EconomyResources *resources = &economy->resources;
+    Assert(resources->count < resources->capacity);
+
+    uint32 index = resources->count++;
+
+    resources->entityIndices[index] = entityIndex;
+    resources->yields[index]        = GetResourceYield(kind);
+    resources->buckets[index]       = GetEconomyBucket(owner, kind);
+}
+
+internal void AddEconomyHero(Economy *economy, uint32 entityIndex, uint32 owner, uint32 movePoints)
+{
+    EconomyHeroes *heroes = &economy->heroes;
+    Assert(heroes->count < heroes->capacity && owner < MAX_PLAYER_COUNT);
+
+    uint32 index = heroes->count++;
+
+    heroes->entityIndices[index] = entityIndex;
+    heroes->movePoints[index]    = movePoints;
+    heroes->owners[index]        = (uint8)owner;
+
+    economy->isPlaying[owner] = true;
+}
+
+// NOTE starts the game over from what is on the map.
+internal void LoadEconomy(Economy *economy, World *world)
+{
+    ClearEconomy(economy);
+
+    for (uint32 entityIndex = 1; entityIndex <= world->entityCount; ++entityIndex)
+    {
+        Entity *entity = GetEntity(world, entityIndex);
+        Cell *cell     = GetEntityCell(world, entityIndex);
+
+        if (cell)
+        {
+            switch (entity->type)
+            {
+                case ENTITY_CITY:
+                {
+                    AddEconomyCity(economy, entityIndex, entity->player, CITY_START_POPULATION, CITY_START_CAPACITY);
+                }
+                break;
+
+                case ENTITY_RESOURCE:
+                {
+                    AddEconomyResource(economy, entityIndex, entity->player, GetResourceKind(cell->biome));
+                }
+                break;
+
+                case ENTITY_HERO:
+                {
+                    AddEconomyHero(economy, entityIndex, entity->player, entity->movePoints);
+                }
+                break;
+            }
+        }
+    }
+
+    for (uint32 player = MAX_PLAYER_COUNT; player > 0; --player)
+    {
+        if (economy->isPlaying[player - 1])
+        {
+            economy->currentPlayer = player - 1;
+        }
+    }
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoTurnJob)
+{
+    TIMED_FUNCTION();
+
+    TurnJob *job     = (TurnJob *)data;
+    Economy *economy = job->economy;
+    Fixed *totals    = job->totals;
+
+    memset(totals, 0, sizeof(job->totals));
+
+    EconomyResources *resources = &economy->resources;
+    for (uint32 index = job->firstResource; index < job->firstResource + job->resourceCount; ++index)
+    {
+        totals[resources->buckets[index]] += resources->yields[index];
+    }
+
+    // NOTE cities grow a little slower the fuller they get, and never past what they can hold.
+    EconomyCities *cities = &economy->cities;
+    for (uint32 index = job->firstCity; index < job->firstCity + job->cityCount; ++index)
+    {
+        Fixed population = cities->populations[index];
+        Fixed room       = FixedMultiply(cities->capacities[index] - population, cities->inverseCapacities[index]);
+        Fixed growth     = FixedMultiply(FixedMultiply(population, CITY_GROWTH_RATE), room);
+
+        cities->populations[index] = population + growth;
+        totals[cities->buckets[index]] += CITY_BASE_INCOME + FixedMultiply(population, CITY_INCOME_PER_PERSON);
+    }
+
+    // NOTE only reads the stockpiles, which don't change until every job is done.
+    EconomyHeroes *heroes = &economy->heroes;
+    for (uint32 index = job->firstHero; index < job->firstHero + job->heroCount; ++index)
+    {
+        uint32 owner  = heroes->owners[index];
+        bool32 inDebt = economy->stockpiles[owner][RESOURCE_GOLD] < 0;
+
+        heroes->movePoints[index] = inDebt ? HERO_MOVE_POINTS / 2 : HERO_MOVE_POINTS;
+        totals[owner * RESOURCE_KIND_COUNT + RESOURCE_GOLD] -= HERO_UPKEEP;
+    }
+}
+
+inline void GetTurnJobRange(uint32 count, uint32 jobIndex, uint32 jobCount, uint32 *first, uint32 *rangeCount)
+{
+    uint32 begin = (uint32)((uint64)count * jobIndex / jobCount);
+    uint32 end   = (uint32)((uint64)count * (jobIndex + 1) / jobCount);
+
+    *first      = begin;
+    *rangeCount = end - begin;
+}
+
+internal void ResolveTurn(Economy *economy, GameMemory *memory, uint32 jobCount)
+{
+    uint64 start = __rdtsc();
+
+    uint32 entityCount = economy->cities.count + economy->resources.count + economy->heroes.count;
+    uint32 maxJobCount = entityCount / TURN_MIN_JOB_ENTITY_COUNT + 1;
+
+    jobCount = jobCount < TURN_MAX_JOB_COUNT ? jobCount : TURN_MAX_JOB_COUNT;
+    jobCount = jobCount < maxJobCount ? jobCount : maxJobCount;
+    jobCount = jobCount ? jobCount : 1;
+
+    for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+    {
+        TurnJob *job = economy->jobs + jobIndex;
+        job->economy = economy;
+
+        GetTurnJobRange(economy->cities.count, jobIndex, jobCount, &job->firstCity, &job->cityCount);
+        GetTurnJobRange(economy->resources.count, jobIndex, jobCount, &job->firstResource, &job->resourceCount);
+        GetTurnJobRange(economy->heroes.count, jobIndex, jobCount, &job->firstHero, &job->heroCount);
+
+        memory->platformAddEntry(memory->highPriorityQueue, DoTurnJob, job);
+    }
+
+    memory->platformCompleteAllWork(memory->highPriorityQueue);
+
+    for (uint32 jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+    {
+        Fixed *totals = economy->jobs[jobIndex].totals;
+
+        for (uint32 player = 0; player < MAX_PLAYER_COUNT; ++player)
+        {
+            for (uint32 kind = 0; kind < RESOURCE_KIND_COUNT; ++kind)
+            {
+                economy->stockpiles[player][kind] += totals[player * RESOURCE_KIND_COUNT + kind];
+            }
+        }
+    }
+
+    ++economy->turnIndex;
+
+    economy->lastJobCount      = jobCount;
+    economy->lastResolveCycles = __rdtsc() - start;
+}
+
+internal void ApplyEconomyToWorld(Economy *economy, World *world)
+{
+    EconomyHeroes *heroes = &economy->heroes;
+
+    for (uint32 index = 0; index < heroes->count; ++index)
+    {
+        GetEntity(world, heroes->entityIndices[index])->movePoints = heroes->movePoints[index];
+    }
+}
+
+// NOTE hands the turn to the next player that has anything on the map, resolving it on the way whenever it goes round
+// past the last one.
+internal void EndPlayerTurn(Economy *economy, World *world, GameMemory *memory)
+{
+    for (uint32 step = 0; step < MAX_PLAYER_COUNT; ++step)
+    {
+        ++economy->currentPlayer;
+
+        if (economy->currentPlayer == MAX_PLAYER_COUNT)
+        {
+            economy->currentPlayer = 0;
+
+            ResolveTurn(economy, memory, TURN_MAX_JOB_COUNT);
+            ApplyEconomyToWorld(economy, world);
+        }
+
+        if (economy->isPlaying[economy->currentPlayer])
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#if !defined(HEX_MAGIC_TURN)
+
+#include "hex_magic_platform.h"
+
+// NOTE what happens between turns. Cities, resources and heroes are copied out of the world into one array per
+// component, and the end of a turn goes over each of them in a single pass: resources produce, cities grow and pay
+// taxes, heroes cost their upkeep and get their move points back. Passes are split into jobs, each adding up what it
+// does for every player on its own, and the totals of the jobs are added up in order once they are all done.
+//
+// Amounts are fixed point, so the same turn comes out the same on every machine and however many jobs it ran on.
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE ((Fixed)1 << FIXED_SHIFT)
+
+typedef int64 Fixed;
+
+#define TURN_MAX_JOB_COUNT 64
+#define TURN_MIN_JOB_ENTITY_COUNT 4096
+#define TURN_NO_OWNER 0xFF
+
+enum ResourceKind
+{
+    RESOURCE_GOLD,
+    RESOURCE_WOOD,
+    RESOURCE_ORE,
+    RESOURCE_CRYSTAL,
+
+    RESOURCE_KIND_COUNT
+};
+
+// NOTE one bucket for every player and kind of resource, and one more row of them for whatever nobody owns, so passes
+// never have to check the owner.
+#define TURN_BUCKET_COUNT ((MAX_PLAYER_COUNT + 1) * RESOURCE_KIND_COUNT)
+
+#define CITY_START_POPULATION (500 * FIXED_ONE)
+#define CITY_START_CAPACITY (4000 * FIXED_ONE)
+#define CITY_GROWTH_RATE (FIXED_ONE / 20)
+#define CITY_BASE_INCOME (250 * FIXED_ONE)
+#define CITY_INCOME_PER_PERSON (FIXED_ONE / 4)
+#define HERO_UPKEEP (100 * FIXED_ONE)
+
+struct EconomyCities
+{
+    uint32 count;
+    uint32 capacity;
+
+    uint32 *entityIndices;
+    uint8 *buckets;
+
+    Fixed *populations;
+    Fixed *capacities;
+    Fixed *inverseCapacities;
+};
+
+struct EconomyResources
+{
+    uint32 count;
+    uint32 capacity;
+
+    uint32 *entityIndices;
+    uint8 *buckets;
+    Fixed *yields;
+};
+
+struct EconomyHeroes
+{
+    uint32 count;
+    uint32 capacity;
+
+    uint32 *entityIndices;
+    uint8 *owners;
+    uint32 *movePoints;
+};
+
+struct Economy;
+
+struct TurnJob
+{
+    Economy *economy;
+
+    uint32 firstCity;
+    uint32 cityCount;
+    uint32 firstResource;
+    uint32 resourceCount;
+    uint32 firstHero;
+    uint32 heroCount;
+
+    Fixed totals[TURN_BUCKET_COUNT];
+};
+
+// NOTE players take turns one after the other at the same machine, and the turn gets resolved once the last of them
+// ends theirs. A player still in debt when it does has heroes with half their move points for the next one.
+struct Economy
+{
+    bool32 isDirty;
+
+    uint32 turnIndex;
+    uint32 currentPlayer;
+    bool32 isPlaying[MAX_PLAYER_COUNT];
+
+    EconomyCities cities;
+    EconomyResources resources;
+    EconomyHeroes heroes;
+
+    Fixed stockpiles[MAX_PLAYER_COUNT][RESOURCE_KIND_COUNT];
+
+    TurnJob jobs[TURN_MAX_JOB_COUNT];
+
+    // NOTE stats of the last resolved turn.
+    uint64 lastResolveCycles;
+    uint32 lastJobCount;
+};
+
+#define HEX_MAGIC_TURN
+#endif
@@ -0,0 +1,230 @@
+#include "hex_magic.h"
+#include "hex_magic_platform.h"
+#include "hex_magic_undo.h"
+
+// NOTE the ring gets the largest power of two record count that fits in memoryCap.
+internal void InitializeUndoHistory(UndoHistory *history, MemoryArena *arena, MemoryIndex memoryCap)
+{
+    MemoryIndex recordCount = 1;
+    while (2 * recordCount * sizeof(UndoRecord) <= memoryCap)
+    {
+        recordCount *= 2;
+    }
+
+    history->records    = PushArray(arena, recordCount, UndoRecord);
+    history->recordMask = recordCount - 1;
+
+    history->oldest = 0;
+    history->top    = 0;
+    history->newest = 0;
+
+    history->isRecording      = false;
+    history->strokeHasBegun   = false;
+    history->strokeOverflowed = false;
+    history->strokeBegin      = 0;
+}
+
+inline UndoRecord *GetUndoRecord(UndoHistory *history, uint64 position)
+{
+    UndoRecord *result = history->records + (position & history->recordMask);
+    return result;
+}
+
+inline MemoryIndex GetUndoMemoryCap(UndoHistory *history)
+{
+    MemoryIndex result = (history->recordMask + 1) * sizeof(UndoRecord);
+    return result;
+}
+
+inline MemoryIndex GetUndoMemoryUsed(UndoHistory *history)
+{
+    MemoryIndex result = (history->newest - history->oldest) * sizeof(UndoRecord);
+    return result;
+}
+
+internal void ClearUndoHistory(UndoHistory *history)
+{
+    history->oldest = history->top = history->newest = 0;
+
+    history->isRecording      = false;
+    history->strokeHasBegun   = false;
+    history->strokeOverflowed = false;
+}
+
+// NOTE drops strokes from the old end until there is room for count more records. Returns false when the stroke
+// being recorded is the only one left and still doesn't fit.
+internal bool32 MakeUndoRoom(UndoHistory *history, uint32 count)
+{
+    bool32 result = true;
+
+    while (history->top + count - history->oldest > history->recordMask + 1)
+    {
+        if (history->strokeHasBegun && history->oldest == history->strokeBegin)
+        {
+            result = false;
+            break;
+        }
+
+        UndoRecord *begin = GetUndoRecord(history, history->oldest);
+        Assert(begin->type == UNDO_RECORD_STROKE_BEGIN);
+
+        history->oldest += begin->cellIndex + 2;
+    }
+
+    return result;
+}
+
+// NOTE the begin marker only goes in with the first change, so a stroke that never changes anything leaves the
+// history alone, including what could be redone.
+internal void BeginUndoStroke(UndoHistory *history)
+{
+    if (!history->isRecording)
+    {
+        history->isRecording      = true;
+        history->strokeHasBegun   = false;
+        history->strokeOverflowed = false;
+    }
+}
+
+// NOTE stops recording the current stroke and takes back whatever of it was recorded. The strokes before it stay
+// undoable, they just don't know about its changes.
+internal void DropUndoStroke(UndoHistory *history)
+{
+    if (history->strokeHasBegun)
+    {
+        history->top = history->strokeBegin;
+    }
+
+    // NOTE the world has moved on from whatever could have been redone.
+    history->newest = history->top;
+
+    history->strokeHasBegun   = false;
+    history->strokeOverflowed = true;
+}
+
+// NOTE makes room for count changes of the current stroke and returns the position of the first one, for callers
+// that fill in records in bulk.
+internal bool32 ReserveUndoRecords(UndoHistory *history, uint32 count, uint64 *first)
+{
+    Assert(history->isRecording);
+
+    bool32 result = false;
+
+    if (!history->strokeOverflowed)
+    {
+        // NOTE a stroke bigger than the whole history can't be undone, and there is no point in dropping older
+        // strokes to find that out.
+        uint64 strokeSize = (history->strokeHasBegun ? history->top - history->strokeBegin : 1) + (uint64)count + 1;
+
+        if (strokeSize > history->recordMask + 1)
+        {
+            DropUndoStroke(history);
+        }
+        else
+        {
+            if (!history->strokeHasBegun)
+            {
+                // NOTE a new stroke throws away whatever could have been redone.
+                history->newest = history->top;
+
+                MakeUndoRoom(history, 2);
+
+                UndoRecord *begin = GetUndoRecord(history, history->top);
+                begin->type       = UNDO_RECORD_STROKE_BEGIN;
+                begin->cellIndex  = 0;
+
+                history->strokeBegin    = history->top++;
+                history->strokeHasBegun = true;
+            }
+
+            // NOTE one extra for the end marker. Always fits now, with every older stroke dropped if need be.
+            MakeUndoRoom(history, count + 1);
+
+            *first = history->top;
+
+            history->top += count;
+            history->newest = history->top;
+
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+internal void RecordUndo(UndoHistory *history, UndoRecordType type, uint32 cellIndex, uint8 before, uint8 after,
+                         uint8 entityIndex)
+{
+    uint64 position = 0;
+
+    if (ReserveUndoRecords(history, 1, &position))
+    {
+        UndoRecord *record  = GetUndoRecord(history, position);
+        record->type        = (uint8)type;
+        record->cellIndex   = cellIndex;
+        record->before      = before;
+        record->after       = after;
+        record->entityIndex = entityIndex;
+    }
+}
+
+internal void EndUndoStroke(UndoHistory *history)
+{
+    if (history->isRecording)
+    {
+        if (history->strokeHasBegun && !history->strokeOverflowed)
+        {
+            uint32 count = (uint32)(history->top - history->strokeBegin - 1);
+
+            UndoRecord *end = GetUndoRecord(history, history->top++);
+            end->type       = UNDO_RECORD_STROKE_END;
+            end->cellIndex  = count;
+
+            GetUndoRecord(history, history->strokeBegin)->cellIndex = count;
+
+            history->newest = history->top;
+        }
+
+        history->isRecording      = false;
+        history->strokeHasBegun   = false;
+        history->strokeOverflowed = false;
+    }
+}
+
+// NOTE steps top back over the last stroke and returns its changes, which have to be reverted last to first.
+internal UndoStroke PopUndoStroke(UndoHistory *history)
+{
+    UndoStroke result = {};
+
+    if (!history->strokeHasBegun && history->top > history->oldest)
+    {
+        UndoRecord *end = GetUndoRecord(history, history->top - 1);
+        Assert(end->type == UNDO_RECORD_STROKE_END);
+
+        result.count = end->cellIndex;
+        result.first = history->top - 1 - result.count;
+
+        history->top = result.first - 1;
+    }
+
+    return result;
+}
+
+// NOTE steps top forward over the next stroke and returns its changes, which have to be applied first to last.
+internal UndoStroke PopRedoStroke(UndoHistory *history)
+{
+    UndoStroke result = {};
+
+    if (!history->strokeHasBegun && history->top < history->newest)
+    {
+        UndoRecord *begin = GetUndoRecord(history, history->top);
+        Assert(begin->type == UNDO_RECORD_STROKE_BEGIN);
+
+        result.count = begin->cellIndex;
+        result.first = history->top + 1;
+
+        history->top = result.first + result.count + 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,53 @@
+#if !defined(HEX_MAGIC_UNDO)
+
+#include "hex_magic_platform.h"
+
+// NOTE undo history is a ring of fixed size records, so it never takes more than the memory it was given. A stroke is
+// a begin marker, the changes it made in order, and an end marker. Both markers hold the number of changes so
+// strokes can be walked from either end. When the ring fills up the oldest strokes are dropped, and a stroke that
+// doesn't fit even on its own is not recorded at all.
+
+enum UndoRecordType
+{
+    UNDO_RECORD_STROKE_BEGIN,
+    UNDO_RECORD_STROKE_END,
+    UNDO_RECORD_PAINT,
+    UNDO_RECORD_ADD_ENTITY,
+};
+
+struct UndoRecord
+{
+    // NOTE holds the change count for stroke markers.
+    uint32 cellIndex;
+
+    uint8 type;
+    uint8 before;
+    uint8 after;
+    uint8 entityIndex;
+};
+
+struct UndoStroke
+{
+    uint64 first;
+    uint32 count;
+};
+
+struct UndoHistory
+{
+    UndoRecord *records;
+    uint64 recordMask;
+
+    // NOTE positions only ever grow and get masked into the ring. Strokes between oldest and top can be undone,
+    // strokes between top and newest redone.
+    uint64 oldest;
+    uint64 top;
+    uint64 newest;
+
+    bool32 isRecording;
+    bool32 strokeHasBegun;
+    bool32 strokeOverflowed;
+    uint64 strokeBegin;
+};
+
+#define HEX_MAGIC_UNDO
+#endif
@@ -0,0 +1,523 @@
+#include "hex_magic.h"
+#include "hex_magic_hex.h"
+#include "hex_magic_math.h"
+#include "hex_magic_platform.h"
+
+// NOTE slots of removed entities get handed out again before the table grows.
+internal uint32 AddEntity(World *world)
+{
+    uint32 enitityIndex = 0;
+
+    if (world->freeEntityCount)
+    {
+        enitityIndex = world->freeEntities[--world->freeEntityCount];
+    }
+    else
+    {
+        enitityIndex = ++world->entityCount;
+    }
+
+    Assert(enitityIndex < ArrayCount(world->entities));
+
+    return enitityIndex;
+}
+
+inline bool32 CanAddEntity(World *world)
+{
+    bool32 result = world->freeEntityCount > 0 || world->entityCount + 1 < ArrayCount(world->entities);
+    return result;
+}
+
+inline bool32 TakeFreeEntity(World *world, uint32 index)
+{
+    bool32 result = false;
+
+    for (uint32 freeIndex = 0; freeIndex < world->freeEntityCount; ++freeIndex)
+    {
+        if (world->freeEntities[freeIndex] == index)
+        {
+            world->freeEntities[freeIndex] = world->freeEntities[--world->freeEntityCount];
+            result                         = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+// NOTE gives the slot of an entity that is no longer linked to any cell back. The last slot shrinks the table, along
+// with any free slots that end up last after it, so placing and undoing over and over doesn't use the table up.
+internal void RemoveEntity(World *world, uint32 index)
+{
+    Assert(index > 0 && index <= world->entityCount);
+
+    if (index == world->entityCount)
+    {
+        --world->entityCount;
+
+        while (TakeFreeEntity(world, world->entityCount))
+        {
+            --world->entityCount;
+        }
+    }
+    else
+    {
+        Assert(world->freeEntityCount < ArrayCount(world->freeEntities));
+        world->freeEntities[world->freeEntityCount++] = index;
+    }
+}
+
+// NOTE takes the slot of a removed entity back, so redo can link the entity it recorded again. The slot keeps what
+// the entity was until it gets handed out again, and handing it out again means a new stroke, which drops the redo.
+internal bool32 RestoreEntity(World *world, uint32 index)
+{
+    bool32 result = TakeFreeEntity(world, index);
+
+    if (!result && index > world->entityCount && index < ArrayCount(world->entities))
+    {
+        while (world->entityCount + 1 < index)
+        {
+            world->freeEntities[world->freeEntityCount++] = ++world->entityCount;
+        }
+
+        world->entityCount = index;
+        result             = true;
+    }
+
+    return result;
+}
+
+internal Entity *GetEntity(World *world, uint32 index)
+{
+    Entity *hero = 0;
+
+    if (index > 0 && index < ArrayCount(world->entities))
+    {
+        hero = &world->entities[index];
+    }
+
+    return hero;
+}
+
+internal uint32 AddHero(World *world, V2 position)
+{
+    uint32 index   = AddEntity(world);
+    Entity *entity = GetEntity(world, index);
+
+    entity->type       = ENTITY_HERO;
+    entity->position   = position;
+    entity->movePoints = HERO_MOVE_POINTS;
+    entity->player     = 0;
+
+    return index;
+}
+
+internal uint32 AddCity(World *world, V2 position)
+{
+    uint32 index   = AddEntity(world);
+    Entity *entity = GetEntity(world, index);
+
+    entity->type       = ENTITY_CITY;
+    entity->position   = position;
+    entity->movePoints = 0;
+    entity->player     = 0;
+
+    return index;
+}
+
+internal uint32 AddResource(World *world, V2 position)
+{
+    uint32 index   = AddEntity(world);
+    Entity *entity = GetEntity(world, index);
+
+    entity->type       = ENTITY_RESOURCE;
+    entity->position   = position;
+    entity->movePoints = 0;
+    entity->player     = 0;
+
+    return index;
+}
+
+inline void InitializeCell(Cell *cell, int32 x, int32 y, Biome biome)
+{
+    cell->coord         = HexFromOffset({x, y});
+    cell->position      = HexToV2(cell->coord);
+    cell->biome         = biome;
+    cell->cityIndex     = 0;
+    cell->heroIndex     = 0;
+    cell->resourceIndex = 0;
+}
+
+// NOTE the row has to lie within the world, and on a paged world the chunks read from it have to be paged in.
+inline Cell *GetCellRow(World *world, int32 y)
+{
+    Cell *result = world->cells ? world->cells + (MemoryIndex)y * world->width
+                                : world->cellBands[y >> WORLD_CHUNK_SHIFT] +
+                                      (MemoryIndex)(y & WORLD_CHUNK_MASK) * world->width;
+    return result;
+}
+
+inline Cell *GetCellByIndex(World *world, uint32 cellIndex)
+{
+    Cell *result = world->cells ? world->cells + cellIndex
+                                : GetCellRow(world, cellIndex / world->width) + cellIndex % world->width;
+    return result;
+}
+
+inline uint32 GetWorldChunkIndex(WorldPager *pager, int32 x, int32 y)
+{
+    uint32 result = (y >> WORLD_CHUNK_SHIFT) * pager->chunkCountX + (x >> WORLD_CHUNK_SHIFT);
+    return result;
+}
+
+internal void PageInWorldChunk(World *world, uint32 chunkIndex)
+{
+    WorldPager *pager    = world->pager;
+    MapChunkedView *view = &pager->view;
+
+    Assert(!(pager->chunkStates[chunkIndex] & WORLD_CHUNK_RESIDENT));
+
+    int32 minX = (chunkIndex % pager->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 minY = (chunkIndex / pager->chunkCountX) << WORLD_CHUNK_SHIFT;
+    int32 maxX = Min(world->width, minX + WORLD_CHUNK_DIM);
+    int32 maxY = Min(world->height, minY + WORLD_CHUNK_DIM);
+
+    // NOTE the arena only ever grows by the bands that get touched, running out of it means more of the map was
+    // visited than the world arena can hold.
+    Cell **band = world->cellBands + (minY >> WORLD_CHUNK_SHIFT);
+    if (!*band)
+    {
+        *band = PushArray(pager->cellArena, ((MemoryIndex)world->width * (maxY - minY)), Cell);
+    }
+
+    uint8 *source  = view->chunkData + (MemoryIndex)chunkIndex * view->table->chunkSize;
+    bool32 isValid = Crc32(0, source, view->table->chunkSize) == view->chunkChecksums[chunkIndex];
+
+    // NOTE a chunk that fails its checksum comes back as open water rather than taking the whole map down.
+    for (int32 y = minY; y < maxY; ++y)
+    {
+        uint8 *sourceRow = source + (y - minY) * WORLD_CHUNK_DIM;
+        Cell *cell       = *band + (MemoryIndex)(y - minY) * world->width + minX;
+
+        for (int32 x = minX; x < maxX; ++x)
+        {
+            uint8 biomeValue = sourceRow[x - minX];
+            Biome biome      = isValid && biomeValue < BIOME_COUNT ? (Biome)biomeValue : WATER;
+
+            InitializeCell(cell++, x, y, biome);
+        }
+    }
+
+    pager->chunkStates[chunkIndex] |= WORLD_CHUNK_RESIDENT;
+    ++pager->residentChunkCount;
+}
+
+// NOTE pages in every chunk of the band y is in, for the few things that read a paged world row by row.
+internal void PageInWorldBand(World *world, int32 y)
+{
+    WorldPager *pager = world->pager;
+
+    for (int32 chunkX = 0; chunkX < pager->chunkCountX; ++chunkX)
+    {
+        uint32 chunkIndex = GetWorldChunkIndex(pager, chunkX << WORLD_CHUNK_SHIFT, y);
+        if (!(pager->chunkStates[chunkIndex] & WORLD_CHUNK_RESIDENT))
+        {
+            PageInWorldChunk(world, chunkIndex);
+        }
+    }
+}
+
+// NOTE gives every band of a paged world its cells without reading any chunk in, for code that is about to write
+// the whole world over. Fails without touching anything when the arena can't hold the bands that are still missing.
+internal bool32 ReserveWorldBands(World *world)
+{
+    WorldPager *pager  = world->pager;
+    MemoryArena *arena = pager->cellArena;
+
+    MemoryIndex missingSize = 0;
+    for (int32 bandIndex = 0; bandIndex < pager->chunkCountY; ++bandIndex)
+    {
+        if (!world->cellBands[bandIndex])
+        {
+            int32 minY = bandIndex << WORLD_CHUNK_SHIFT;
+            int32 maxY = Min(world->height, minY + WORLD_CHUNK_DIM);
+
+            missingSize += (MemoryIndex)world->width * (maxY - minY) * sizeof(Cell);
+        }
+    }
+
+    bool32 result = missingSize <= arena->size - arena->used;
+    if (result)
+    {
+        for (int32 bandIndex = 0; bandIndex < pager->chunkCountY; ++bandIndex)
+        {
+            if (!world->cellBands[bandIndex])
+            {
+                int32 minY = bandIndex << WORLD_CHUNK_SHIFT;
+                int32 maxY = Min(world->height, minY + WORLD_CHUNK_DIM);
+
+                world->cellBands[bandIndex] = PushArray(arena, ((MemoryIndex)world->width * (maxY - minY)), Cell);
+            }
+        }
+    }
+
+    return result;
+}
+
+internal Cell *GetCell(World *world, OffsetCoord coord)
+{
+    Cell *result = 0;
+
+    if (coord.x > 0 && coord.x < (int32)world->width && coord.y > 0 && coord.y < (int32)world->height)
+    {
+        WorldPager *pager = world->pager;
+        if (pager)
+        {
+            uint32 chunkIndex = GetWorldChunkIndex(pager, coord.x, coord.y);
+            if (!(pager->chunkStates[chunkIndex] & WORLD_CHUNK_RESIDENT))
+            {
+                PageInWorldChunk(world, chunkIndex);
+            }
+        }
+
+        result = GetCellRow(world, coord.y) + coord.x;
+    }
+
+    return result;
+}
+
+internal Cell *GetCell(World *world, HexCoord coord)
+{
+    OffsetCoord offsetCoord = OffsetFromHex(coord);
+    Cell *result            = GetCell(world, offsetCoord);
+
+    return result;
+}
+
+inline uint32 GetCellIndex(World *world, Cell *cell)
+{
+    uint32 result = 0;
+
+    if (world->cells)
+    {
+        result = (uint32)(cell - world->cells);
+    }
+    else
+    {
+        OffsetCoord offset = OffsetFromHex(cell->coord);
+        result             = (uint32)offset.y * world->width + offset.x;
+    }
+
+    return result;
+}
+
+internal World *CreateEmptyWorld(MemoryArena *arena, int32 width, int32 height)
+{
+    World *world = PushStruct(arena, World);
+
+    world->width           = width;
+    world->height          = height;
+    world->cells           = 0;
+    world->cellBands       = 0;
+    world->selectedCell    = 0;
+    world->pager           = 0;
+    world->entityCount     = 0;
+    world->freeEntityCount = 0;
+
+    return world;
+}
+
+internal World *CreateWorld(MemoryArena *arena, int32 width, int32 height)
+{
+    World *world = CreateEmptyWorld(arena, width, height);
+    world->cells = PushArray(arena, (MemoryIndex)width * height, Cell);
+
+    return world;
+}
+
+inline MemoryIndex GetWorldMetadataSize(int32 width, int32 height)
+{
+    MemoryIndex chunkCount = (MemoryIndex)((width + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT) *
+                             ((height + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT);
+    MemoryIndex bandCount  = (height + WORLD_CHUNK_MASK) >> WORLD_CHUNK_SHIFT;
+
+    MemoryIndex result = sizeof(World) + sizeof(WorldPager) + chunkCount * (sizeof(uint8) + sizeof(uint32)) +
+                         bandCount * sizeof(Cell *);
+    return result;
+}
+
+inline bool32 WorldFitsInArena(MemoryArena *arena, int32 width, int32 height)
+{
+    MemoryIndex required =
+        GetWorldMetadataSize(width, height) + (MemoryIndex)width * (MemoryIndex)height * sizeof(Cell);
+    bool32 result = width > 0 && height > 0 && required <= arena->size;
+
+    return result;
+}
+
+// NOTE a paged world only holds the bands it has touched, so it has to have room for one of them.
+inline bool32 PagedWorldFitsInArena(MemoryArena *arena, int32 width, int32 height)
+{
+    MemoryIndex required =
+        GetWorldMetadataSize(width, height) + (MemoryIndex)width * WORLD_CHUNK_DIM * sizeof(Cell);
+    bool32 result = width > 0 && height > 0 && required <= arena->size;
+
+    return result;
+}
+
+inline void MarkWorldChunkDirty(WorldPager *pager, uint32 chunkIndex)
+{
+    if (!(pager->chunkStates[chunkIndex] & WORLD_CHUNK_DIRTY))
+    {
+        pager->chunkStates[chunkIndex] |= WORLD_CHUNK_DIRTY;
+        pager->dirtyChunks[pager->dirtyChunkCount++] = chunkIndex;
+    }
+}
+
+internal void SetCellBiome(World *world, Cell *cell, Biome biome)
+{
+    if (cell->biome != biome)
+    {
+        cell->biome = biome;
+
+        WorldPager *pager = world->pager;
+        if (pager)
+        {
+            OffsetCoord offset = OffsetFromHex(cell->coord);
+            MarkWorldChunkDirty(pager, GetWorldChunkIndex(pager, offset.x, offset.y));
+        }
+    }
+}
+
+// NOTE returns the first cell of a row span that has to lie within the world, with every chunk it crosses paged in
+// and, when it is about to be written to, marked dirty.
+internal Cell *GetCellSpan(World *world, int32 y, int32 minX, int32 maxX, bool32 forWriting)
+{
+    Assert(minX > 0 && maxX < world->width && minX <= maxX && y > 0 && y < world->height);
+
+    WorldPager *pager = world->pager;
+    if (pager)
+    {
+        for (int32 chunkX = minX >> WORLD_CHUNK_SHIFT; chunkX <= (maxX >> WORLD_CHUNK_SHIFT); ++chunkX)
+        {
+            uint32 chunkIndex = GetWorldChunkIndex(pager, chunkX << WORLD_CHUNK_SHIFT, y);
+
+            if (!(pager->chunkStates[chunkIndex] & WORLD_CHUNK_RESIDENT))
+            {
+                PageInWorldChunk(world, chunkIndex);
+            }
+
+            if (forWriting)
+            {
+                MarkWorldChunkDirty(pager, chunkIndex);
+            }
+        }
+    }
+
+    Cell *result = GetCellRow(world, y) + minX;
+    return result;
+}
+
+internal uint32 PlaceEntity(World *world, Cell *cell, EntityType type)
+{
+    uint32 result = 0;
+
+    switch (type)
+    {
+        case ENTITY_HERO:
+        {
+            if (!cell->heroIndex)
+            {
+                cell->heroIndex = AddHero(world, cell->position);
+                result          = cell->heroIndex;
+            }
+        }
+        break;
+
+        case ENTITY_CITY:
+        {
+            if (!cell->cityIndex)
+            {
+                cell->cityIndex = AddCity(world, cell->position);
+                result          = cell->cityIndex;
+            }
+        }
+        break;
+
+        case ENTITY_RESOURCE:
+        {
+            if (!cell->resourceIndex)
+            {
+                cell->resourceIndex = AddResource(world, cell->position);
+                result              = cell->resourceIndex;
+            }
+        }
+        break;
+    }
+
+    return result;
+}
+
+inline uint32 *GetCellEntitySlot(Cell *cell, EntityType type)
+{
+    uint32 *result = 0;
+
+    switch (type)
+    {
+        case ENTITY_HERO:
+        {
+            result = &cell->heroIndex;
+        }
+        break;
+
+        case ENTITY_CITY:
+        {
+            result = &cell->cityIndex;
+        }
+        break;
+
+        case ENTITY_RESOURCE:
+        {
+            result = &cell->resourceIndex;
+        }
+        break;
+    }
+
+    return result;
+}
+
+// NOTE takes the entity of the given type off the cell. Its slot is kept, so the same index can be linked back.
+internal uint32 UnlinkEntity(Cell *cell, EntityType type)
+{
+    uint32 *slot  = GetCellEntitySlot(cell, type);
+    uint32 result = *slot;
+
+    *slot = 0;
+
+    return result;
+}
+
+internal void LinkEntity(Cell *cell, EntityType type, uint32 index)
+{
+    uint32 *slot = GetCellEntitySlot(cell, type);
+    Assert(!*slot);
+
+    *slot = index;
+}
+
+internal Cell *GetEntityCell(World *world, uint32 index)
+{
+    Cell *result   = 0;
+    Entity *entity = GetEntity(world, index);
+
+    if (entity)
+    {
+        Cell *cell = GetCell(world, V2ToHex(entity->position));
+        if (cell && *GetCellEntitySlot(cell, entity->type) == index)
+        {
+            result = cell;
+        }
+    }
+
+    return result;
+}
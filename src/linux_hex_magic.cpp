@@ -6,9 +6,12 @@
 #include <unistd.h>
 #include <dlfcn.h>
 #include <linux/limits.h>
+#include <cstdio>
+#include <cstring>
 
 #include "hex_magic_platform.h"
 #include "linux_hex_magic.h"
+#include "linux_hex_magic_posix.cpp"
 
 global bool32 globalIsRunning;
 global bool32 globalPause;
@@ -63,6 +66,56 @@ internal void LinuxBuildExecDirFileName(LinuxState *state, const char *fileName,
                StringLength(fileName), fileName, destCount, dest);
 }
 
+#if HEX_MAGIC_INTERNAL
+global LinuxDebugTrace globalDebugTrace;
+
+internal void LinuxBeginHashLog(LinuxHashLog *log, char *fileName)
+{
+    ThreadContext thread = {};
+
+    log->isLogging    = debugPlatformWriteEntireFile(&thread, fileName, 0, 0);
+    log->frameIndex   = 0;
+    log->bufferedSize = 0;
+
+    if (log->isLogging)
+    {
+        snprintf(log->fileName, sizeof(log->fileName), "%s", fileName);
+    }
+    else
+    {
+        printf("Could not open the hash log %s\n", fileName);
+    }
+}
+
+internal void LinuxFlushHashLog(LinuxHashLog *log)
+{
+    ThreadContext thread = {};
+
+    if (log->isLogging && log->bufferedSize)
+    {
+        debugPlatformAppendToFile(&thread, log->fileName, log->bufferedSize, log->buffer);
+        log->bufferedSize = 0;
+    }
+}
+
+internal void LinuxLogStateHash(LinuxHashLog *log, uint64 hash)
+{
+    if (log->isLogging)
+    {
+        // NOTE a line is never longer than two 64 bit numbers and the spaces between them.
+        if (log->bufferedSize + 64 > sizeof(log->buffer))
+        {
+            LinuxFlushHashLog(log);
+        }
+
+        log->bufferedSize += snprintf(log->buffer + log->bufferedSize, sizeof(log->buffer) - log->bufferedSize,
+                                      "%llu %016llx\n", (unsigned long long)log->frameIndex, (unsigned long long)hash);
+    }
+
+    ++log->frameIndex;
+}
+#endif
+
 internal void LinuxResizeBackBuffer(LinuxOffscreenBuffer *buffer, SDL_Renderer *renderer, int width, int height)
 {
     if (buffer->renderTexture)
@@ -226,113 +279,347 @@ internal void LinuxUpdateButtonState(GameButtonState *newState, bool32 isPressed
     }
 }
 
-DEBUG_PLATFORM_FREE_FILE_MEMORY(debugPlatformFreeFileMemory)
+internal int LinuxGetWindowRefreshRate(SDL_Window *window)
 {
-    if (memory)
+    SDL_DisplayMode mode;
+    int displayIndex = SDL_GetWindowDisplayIndex(window);
+
+    int defaultRefreshRate = 60;
+    if (SDL_GetDesktopDisplayMode(displayIndex, &mode) != 0)
     {
-        free(memory);
+        return defaultRefreshRate;
     }
+
+    if (mode.refresh_rate == 0)
+    {
+        return defaultRefreshRate;
+    }
+
+    return mode.refresh_rate;
+}
+
+inline real32 LinuxGetSecondsElapsed(uint64 oldCounter, uint64 currentCounter)
+{
+    real32 result = (real32)(currentCounter - oldCounter) / globalPerfCountFrequency;
+    return result;
+}
+
+#if HEX_MAGIC_INTERNAL
+internal void LinuxGetReplayFileName(LinuxState *state, uint32 slotIndex, int destCount, char *dest)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "hex_magic_replay_%u.hmr", slotIndex + 1);
+
+    LinuxBuildExecDirFileName(state, name, destCount, dest);
 }
 
-DEBUG_PLATFORM_READ_ENTIRE_FILE(debugPlatformReadEntireFile)
+#define LINUX_PAGEMAP_PRESENT ((uint64)1 << 63)
+#define LINUX_PAGEMAP_SWAPPED ((uint64)1 << 62)
+
+// NOTE sets a byte for every page of the block that has ever been touched, whether it is in memory right now or
+// swapped out. Pagemap has one entry per page of the address space, the flags are there without any privileges.
+internal bool32 LinuxGetTouchedPages(void *base, uint64 size, uint64 pageSize, uint8 *touched)
 {
-    DebugReadFileResult result = {};
-    int fileHandle             = open(fileName, O_RDONLY);
-    if (fileHandle == -1)
+    int fileHandle = open("/proc/self/pagemap", O_RDONLY);
+    bool32 result  = fileHandle != -1;
+
+    uint64 firstPage = (uint64)base / pageSize;
+    uint64 pageCount = size / pageSize;
+    uint64 entries[4096];
+
+    for (uint64 pageIndex = 0; result && pageIndex < pageCount;)
     {
-        return result;
+        uint64 entryCount = pageCount - pageIndex < ArrayCount(entries) ? pageCount - pageIndex : ArrayCount(entries);
+        ssize_t bytesRead =
+            pread(fileHandle, entries, entryCount * sizeof(uint64), (off_t)((firstPage + pageIndex) * sizeof(uint64)));
+
+        result = bytesRead == (ssize_t)(entryCount * sizeof(uint64));
+
+        for (uint64 entryIndex = 0; result && entryIndex < entryCount; ++entryIndex)
+        {
+            touched[pageIndex++] = (entries[entryIndex] & (LINUX_PAGEMAP_PRESENT | LINUX_PAGEMAP_SWAPPED)) != 0;
+        }
     }
 
-    struct stat fileStatus;
-    if (fstat(fileHandle, &fileStatus) == -1)
+    if (fileHandle != -1)
     {
         close(fileHandle);
-        return result;
     }
 
-    result.contentsSize = fileStatus.st_size;
-    result.contents     = malloc(result.contentsSize);
-    if (!result.contents)
+    return result;
+}
+
+// NOTE game memory is only reserved up front, so the snapshot takes the pages that were ever touched, swapped out ones
+// included. That is what the arenas have used rounded up to pages, tens of megabytes out of the 17GB reserved.
+internal void LinuxBeginRecordingInput(LinuxState *state, GameMemory *memory, uint32 slotIndex)
+{
+    LinuxReplayBuffer *replay = state->replayBuffers + slotIndex;
+    uint64 startCounter       = SDL_GetPerformanceCounter();
+
+    // NOTE queued work writes into game memory.
+    memory->platformCompleteAllWork(memory->highPriorityQueue);
+    memory->platformCompleteAllWork(memory->lowPriorityQueue);
+
+    uint64 pageSize  = (uint64)sysconf(_SC_PAGESIZE);
+    uint64 pageCount = state->totalSize / pageSize;
+    uint8 *touched   = (uint8 *)mmap(0, pageCount, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    Assert(state->totalSize % pageSize == 0);
+
+    if (touched == MAP_FAILED)
     {
-        result.contentsSize = 0;
-        close(fileHandle);
-        return result;
+        printf("Could not start recording\n");
+        return;
     }
 
-    uint32 bytesToRead      = result.contentsSize;
-    uint8 *nextByteLocation = (uint8 *)result.contents;
-    while (bytesToRead)
+    if (!LinuxGetTouchedPages(state->gameMemoryBlock, state->totalSize, pageSize, touched))
     {
-        ssize_t bytesRead = read(fileHandle, nextByteLocation, bytesToRead);
-        if (bytesRead == -1)
+        printf("Could not start recording, /proc/self/pagemap can't be read\n");
+        munmap(touched, pageCount);
+        return;
+    }
+
+    uint64 runCount          = 0;
+    uint64 touchedPageCount = 0;
+    for (uint64 pageIndex = 0; pageIndex < pageCount; ++pageIndex)
+    {
+        if (touched[pageIndex])
         {
-            debugPlatformFreeFileMemory(thread, result.contents);
-            result.contents     = 0;
-            result.contentsSize = 0;
-            close(fileHandle);
+            if (pageIndex == 0 || !(touched[pageIndex - 1]))
+            {
+                ++runCount;
+            }
 
-            return result;
+            ++touchedPageCount;
         }
+    }
+
+    uint64 headerSize   = sizeof(LinuxReplayHeader) + runCount * sizeof(LinuxReplayRun);
+    headerSize          = (headerSize + pageSize - 1) & ~(pageSize - 1);
+    uint64 snapshotSize = headerSize + touchedPageCount * pageSize;
 
-        bytesToRead -= bytesRead;
-        nextByteLocation += bytesRead;
+    if (replay->memoryBlock)
+    {
+        munmap(replay->memoryBlock, replay->memorySize);
+        replay->memoryBlock = 0;
     }
 
-    close(fileHandle);
-    return result;
-}
+    // NOTE mapping it with the snapshot size cuts off the frames of whatever was recorded into the slot before.
+    ThreadContext thread = {};
+    LinuxGetReplayFileName(state, slotIndex, sizeof(replay->fileName), replay->fileName);
+    DebugMappedFile file = debugPlatformMapFile(&thread, replay->fileName, snapshotSize);
 
-DEBUG_PLATFORM_WRITE_ENTIRE_FILE(debugPlatformWriteEntireFile)
-{
-    int fileHandle = open(fileName, O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (!file.memory)
+    {
+        printf("Could not create %s\n", replay->fileName);
+        munmap(touched, pageCount);
+        return;
+    }
 
-    if (fileHandle == -1)
-        return false;
+    LinuxReplayHeader *header = (LinuxReplayHeader *)file.memory;
+    header->magicValue        = LINUX_REPLAY_MAGIC_VALUE;
+    header->version           = LINUX_REPLAY_VERSION;
+    header->totalSize         = state->totalSize;
+    header->runCount          = runCount;
+    header->snapshotSize      = snapshotSize;
 
-    uint32 bytesToWrite     = memorySize;
-    uint8 *nextByteLocation = (uint8 *)memory;
-    while (bytesToWrite)
+    LinuxReplayRun *run = (LinuxReplayRun *)(header + 1);
+    uint8 *dest         = (uint8 *)file.memory + headerSize;
+
+    for (uint64 pageIndex = 0; pageIndex < pageCount;)
     {
-        ssize_t bytesWritten = write(fileHandle, nextByteLocation, bytesToWrite);
-        if (bytesWritten == -1)
+        if (touched[pageIndex])
         {
-            close(fileHandle);
-            return false;
+            uint64 firstPage = pageIndex;
+            while (pageIndex < pageCount && (touched[pageIndex]))
+            {
+                ++pageIndex;
+            }
+
+            run->offset = firstPage * pageSize;
+            run->size   = (pageIndex - firstPage) * pageSize;
+
+            memcpy(dest, (uint8 *)state->gameMemoryBlock + run->offset, run->size);
+            dest += run->size;
+            ++run;
+        }
+        else
+        {
+            ++pageIndex;
         }
-        bytesToWrite -= bytesWritten;
-        nextByteLocation += bytesWritten;
     }
 
-    close(fileHandle);
+    munmap(touched, pageCount);
+
+    replay->memoryBlock = file.memory;
+    replay->memorySize  = file.size;
+    replay->fileHandle  = open(replay->fileName, O_WRONLY | O_APPEND);
 
-    return true;
+    state->inputRecordingIndex = slotIndex + 1;
+
+    printf("Recording into %s: %.1fMB of game memory in %llu runs, snapshot took %.2fms\n", replay->fileName,
+           (real64)(touchedPageCount * pageSize) / Megabytes(1), (unsigned long long)runCount,
+           1000.0f * LinuxGetSecondsElapsed(startCounter, SDL_GetPerformanceCounter()));
 }
 
-internal int LinuxGetWindowRefreshRate(SDL_Window *window)
+internal void LinuxEndRecordingInput(LinuxState *state)
 {
-    SDL_DisplayMode mode;
-    int displayIndex = SDL_GetWindowDisplayIndex(window);
+    LinuxReplayBuffer *replay = state->replayBuffers + state->inputRecordingIndex - 1;
 
-    int defaultRefreshRate = 60;
-    if (SDL_GetDesktopDisplayMode(displayIndex, &mode) != 0)
+    close(replay->fileHandle);
+    replay->fileHandle = -1;
+
+    state->inputRecordingIndex = 0;
+}
+
+internal void LinuxRecordInput(LinuxState *state, GameInput *input, uint64 stateHash)
+{
+    LinuxReplayBuffer *replay = state->replayBuffers + state->inputRecordingIndex - 1;
+
+    LinuxReplayFrame frame = {};
+    frame.input            = *input;
+    frame.stateHash        = stateHash;
+
+    if (write(replay->fileHandle, &frame, sizeof(frame)) != sizeof(frame))
     {
-        return defaultRefreshRate;
+        printf("Could not record into %s\n", replay->fileName);
+        LinuxEndRecordingInput(state);
     }
+}
 
-    if (mode.refresh_rate == 0)
+// NOTE the snapshot holds every page that was ever touched when it was taken, so any other page is still zero in it.
+// Dropping every page first puts the ones touched since back to zero, then the snapshot's own pages get copied over,
+// which only touches as much memory as the snapshot holds.
+internal void LinuxRestoreReplaySnapshot(LinuxState *state, GameMemory *memory, LinuxReplayBuffer *replay)
+{
+    memory->platformCompleteAllWork(memory->highPriorityQueue);
+    memory->platformCompleteAllWork(memory->lowPriorityQueue);
+
+    LinuxReplayHeader *header = (LinuxReplayHeader *)replay->memoryBlock;
+    LinuxReplayRun *run       = (LinuxReplayRun *)(header + 1);
+    uint64 pageSize           = (uint64)sysconf(_SC_PAGESIZE);
+    uint64 headerSize         = sizeof(LinuxReplayHeader) + header->runCount * sizeof(LinuxReplayRun);
+    uint8 *source             = (uint8 *)replay->memoryBlock + ((headerSize + pageSize - 1) & ~(pageSize - 1));
+
+    madvise(state->gameMemoryBlock, state->totalSize, MADV_DONTNEED);
+
+    for (uint64 runIndex = 0; runIndex < header->runCount; ++runIndex, ++run)
     {
-        return defaultRefreshRate;
+        memcpy((uint8 *)state->gameMemoryBlock + run->offset, source, run->size);
+        source += run->size;
     }
 
-    return mode.refresh_rate;
+    lseek(replay->fileHandle, (off_t)header->snapshotSize, SEEK_SET);
+
+    state->playBackFrameIndex  = 0;
+    state->playBackHasDiverged = false;
 }
 
-inline real32 LinuxGetSecondsElapsed(uint64 oldCounter, uint64 currentCounter)
+internal void LinuxBeginInputPlayBack(LinuxState *state, GameMemory *memory, uint32 slotIndex)
 {
-    real32 result = (real32)(currentCounter - oldCounter) / globalPerfCountFrequency;
-    return result;
+    LinuxReplayBuffer *replay = state->replayBuffers + slotIndex;
+    uint64 startCounter       = SDL_GetPerformanceCounter();
+
+    // NOTE replays recorded by an earlier run of the game are mapped on first use.
+    if (!replay->memoryBlock)
+    {
+        ThreadContext thread = {};
+        LinuxGetReplayFileName(state, slotIndex, sizeof(replay->fileName), replay->fileName);
+        DebugMappedFile file = debugPlatformMapFile(&thread, replay->fileName, 0);
+
+        replay->memoryBlock = file.memory;
+        replay->memorySize  = file.size;
+    }
+
+    LinuxReplayHeader *header = (LinuxReplayHeader *)replay->memoryBlock;
+    if (!header || replay->memorySize < sizeof(LinuxReplayHeader) || header->magicValue != LINUX_REPLAY_MAGIC_VALUE ||
+        header->version != LINUX_REPLAY_VERSION || header->totalSize != state->totalSize ||
+        header->snapshotSize > replay->memorySize)
+    {
+        printf("Could not play back replay %u\n", slotIndex + 1);
+        return;
+    }
+
+    replay->fileHandle = open(replay->fileName, O_RDONLY);
+    if (replay->fileHandle == -1)
+    {
+        printf("Could not play back %s\n", replay->fileName);
+        return;
+    }
+
+    LinuxRestoreReplaySnapshot(state, memory, replay);
+    state->inputPlayingIndex = slotIndex + 1;
+
+    printf("Playing back %s, restoring the snapshot took %.2fms\n", replay->fileName,
+           1000.0f * LinuxGetSecondsElapsed(startCounter, SDL_GetPerformanceCounter()));
+}
+
+internal void LinuxEndInputPlayBack(LinuxState *state)
+{
+    LinuxReplayBuffer *replay = state->replayBuffers + state->inputPlayingIndex - 1;
+
+    close(replay->fileHandle);
+    replay->fileHandle = -1;
+
+    state->inputPlayingIndex = 0;
 }
 
+// NOTE loops back to the snapshot once the frames run out.
+internal void LinuxPlayBackInput(LinuxState *state, GameMemory *memory, GameInput *input)
+{
+    LinuxReplayBuffer *replay = state->replayBuffers + state->inputPlayingIndex - 1;
+
+    LinuxReplayFrame frame = {};
+    ssize_t bytesRead      = read(replay->fileHandle, &frame, sizeof(frame));
+
+    if (bytesRead != sizeof(frame))
+    {
+        LinuxRestoreReplaySnapshot(state, memory, replay);
+        bytesRead = read(replay->fileHandle, &frame, sizeof(frame));
+    }
+
+    if (bytesRead == sizeof(frame))
+    {
+        *input                   = frame.input;
+        state->playBackStateHash = frame.stateHash;
+    }
+}
+
+internal void LinuxCheckPlayBackHash(LinuxState *state, uint64 stateHash)
+{
+    if (stateHash != state->playBackStateHash && !state->playBackHasDiverged)
+    {
+        printf("Replay %u went apart from the recording at frame %llu\n", state->inputPlayingIndex,
+               (unsigned long long)state->playBackFrameIndex);
+
+        state->playBackHasDiverged = true;
+    }
+
+    ++state->playBackFrameIndex;
+}
+
+// NOTE a slot key records into its slot. Pressing one again while recording plays back what was just recorded, and
+// while playing back stops it.
+internal void LinuxToggleReplay(LinuxState *state, GameMemory *memory, uint32 slotIndex)
+{
+    if (state->inputPlayingIndex)
+    {
+        LinuxEndInputPlayBack(state);
+    }
+    else if (state->inputRecordingIndex)
+    {
+        uint32 recordingSlot = state->inputRecordingIndex - 1;
+
+        LinuxEndRecordingInput(state);
+        LinuxBeginInputPlayBack(state, memory, recordingSlot);
+    }
+    else
+    {
+        LinuxBeginRecordingInput(state, memory, slotIndex);
+    }
+}
+#endif
+
 internal void LinuxDebugDrawVertical(LinuxOffscreenBuffer *backBuffer, int x, int top, int bottom, uint32 color)
 {
     if (top <= 0)
@@ -653,6 +940,10 @@ internal void LinuxProcessEvents(SDL_Window *window, SDL_Renderer *renderer, Lin
                     {
                         ToggleFullscreen(state, window);
                     }
+                    else if (vkCode == SDLK_RETURN)
+                    {
+                        LinuxUpdateButtonState(&keyboard->endTurn, isDown);
+                    }
                     else if (vkCode == SDLK_ESCAPE)
                     {
                         LinuxUpdateButtonState(&keyboard->cancel, isDown);
@@ -666,6 +957,18 @@ internal void LinuxProcessEvents(SDL_Window *window, SDL_Renderer *renderer, Lin
                     {
                         LinuxUpdateButtonState(&keyboard->save, isDown);
                     }
+                    else if (vkCode == 'g')
+                    {
+                        LinuxUpdateButtonState(&keyboard->generate, isDown);
+                    }
+                    else if (vkCode == 'z')
+                    {
+                        LinuxUpdateButtonState(&keyboard->undo, isDown);
+                    }
+                    else if (vkCode == 'y')
+                    {
+                        LinuxUpdateButtonState(&keyboard->redo, isDown);
+                    }
                     else if (vkCode == 'e')
                     {
                         LinuxUpdateButtonState(&keyboard->toggleMode, isDown);
@@ -678,6 +981,10 @@ internal void LinuxProcessEvents(SDL_Window *window, SDL_Renderer *renderer, Lin
                     {
                         LinuxUpdateButtonState(&keyboard->nextEntity, isDown);
                     }
+                    else if (vkCode == 'f')
+                    {
+                        LinuxUpdateButtonState(&keyboard->nextTool, isDown);
+                    }
                     else if (vkCode == 'p')
                     {
                         if (isDown)
@@ -685,6 +992,21 @@ internal void LinuxProcessEvents(SDL_Window *window, SDL_Renderer *renderer, Lin
                             globalPause = !globalPause;
                         }
                     }
+                    else if (vkCode == SDLK_F5)
+                    {
+                        LinuxUpdateButtonState(&keyboard->toggleProfiler, isDown);
+                    }
+                    else if (vkCode == SDLK_F6)
+                    {
+                        LinuxUpdateButtonState(&keyboard->freezeProfiler, isDown);
+                    }
+                    else if (vkCode >= SDLK_F1 && vkCode < SDLK_F1 + LINUX_REPLAY_BUFFER_COUNT)
+                    {
+                        if (isDown)
+                        {
+                            state->pendingReplayIndex = (uint32)(vkCode - SDLK_F1) + 1;
+                        }
+                    }
 #endif
                 }
             }
@@ -713,11 +1035,27 @@ int main(int argc, char *args[])
     LinuxState linuxState = {};
 
     globalPerfCountFrequency = SDL_GetPerformanceFrequency();
+    uint64 startupCounter    = SDL_GetPerformanceCounter();
     int initWidth            = 1280;
     int initHeight           = 720;
 
     LinuxGetExecutableFileName(&linuxState, args);
 
+#if HEX_MAGIC_INTERNAL
+    for (int argIndex = 1; argIndex + 1 < argc; ++argIndex)
+    {
+        if (strcmp(args[argIndex], "--hash-log") == 0)
+        {
+            LinuxBeginHashLog(&linuxState.hashLog, args[argIndex + 1]);
+        }
+
+        if (strcmp(args[argIndex], "--trace") == 0)
+        {
+            LinuxBeginDebugTrace(&globalDebugTrace, args[argIndex + 1]);
+        }
+    }
+#endif
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
     {
         printf("Failed to initialise graphics: %s", SDL_GetError());
@@ -782,16 +1120,49 @@ int main(int argc, char *args[])
     void *baseAddress = (void *)0;
 #endif
 
+    // NOTE permanent storage is only reserved here, pages get committed on first touch. Paged maps rely on this so
+    // that the cells of unexplored chunks never cost any memory.
+    PlatformWorkQueue highPriorityQueue = {};
+    LinuxMakeQueue(&highPriorityQueue, LinuxGetWorkerThreadCount());
+
+    PlatformWorkQueue lowPriorityQueue = {};
+    LinuxMakeQueue(&lowPriorityQueue, 1);
+
     GameMemory gameMemory                   = {};
-    gameMemory.permanentStorageSize         = Megabytes(64);
+    gameMemory.permanentStorageSize         = Gigabytes(16);
     gameMemory.transientStorageSize         = Gigabytes(1);
     gameMemory.debugPlatformFreeFileMemory  = debugPlatformFreeFileMemory;
     gameMemory.debugPlatformReadEntireFile  = debugPlatformReadEntireFile;
     gameMemory.debugPlatformWriteEntireFile = debugPlatformWriteEntireFile;
+    gameMemory.debugPlatformMapFile         = debugPlatformMapFile;
+    gameMemory.debugPlatformUnmapFile       = debugPlatformUnmapFile;
+    gameMemory.debugPlatformFlushMappedFile = debugPlatformFlushMappedFile;
+    gameMemory.debugPlatformAppendToFile    = debugPlatformAppendToFile;
+    gameMemory.debugPlatformSyncFile        = debugPlatformSyncFile;
+    gameMemory.debugPlatformReplaceFile     = debugPlatformReplaceFile;
+
+    gameMemory.highPriorityQueue       = &highPriorityQueue;
+    gameMemory.lowPriorityQueue        = &lowPriorityQueue;
+    gameMemory.highPriorityWorkerCount = LinuxGetWorkerThreadCount();
+    gameMemory.platformAddEntry        = LinuxAddEntry;
+    gameMemory.platformCompleteAllWork = LinuxCompleteAllWork;
+    gameMemory.platformMapReadOnlyFile = platformMapReadOnlyFile;
+    gameMemory.platformUnmapFile       = platformUnmapFile;
+
+#if HEX_MAGIC_INTERNAL
+    gameMemory.debugTable       = LinuxAllocateDebugTable();
+    gameMemory.debugStorageSize = Megabytes(64);
+    gameMemory.debugStorage     = LinuxAllocateDebugStorage(gameMemory.debugStorageSize);
+
+    if (gameMemory.debugTable)
+    {
+        gameMemory.debugTable->targetSecondsPerFrame = targetSecondsPerFrame;
+    }
+#endif
 
-    linuxState.totalSize = gameMemory.permanentStorageSize + gameMemory.transientStorageSize;
-    linuxState.gameMemoryBlock =
-        mmap(baseAddress, (size_t)linuxState.totalSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    linuxState.totalSize       = gameMemory.permanentStorageSize + gameMemory.transientStorageSize;
+    linuxState.gameMemoryBlock = mmap(baseAddress, (size_t)linuxState.totalSize, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
 
     gameMemory.permanentStorage = linuxState.gameMemoryBlock;
     gameMemory.transientStorage = (uint8 *)gameMemory.permanentStorage + gameMemory.permanentStorageSize;
@@ -811,6 +1182,7 @@ int main(int argc, char *args[])
     uint32 fps             = 0;
     real64 currentSecond   = 0.0f;
     real32 secondsPerFrame = 0.0f;
+    bool32 firstFrameShown = false;
 
     uint32 audioLatencyBytes   = 0;
     real32 audioLatencySeconds = 0;
@@ -839,6 +1211,19 @@ int main(int argc, char *args[])
         struct timespec newGameCodeWriteTime = LinuxGetLastWriteTime(gameSoName);
         if (newGameCodeWriteTime.tv_sec != game.lastWriteTime.tv_sec)
         {
+            // NOTE queued work points into the old game code, it has to be done before that goes away.
+            LinuxCompleteAllWork(&highPriorityQueue);
+            LinuxCompleteAllWork(&lowPriorityQueue);
+
+#if HEX_MAGIC_INTERNAL
+            if (gameMemory.debugTable)
+            {
+                LinuxCollateDebugEvents(gameMemory.debugTable);
+                LinuxTraceDebugEvents(&globalDebugTrace, gameMemory.debugTable);
+                LinuxDropDebugEvents(gameMemory.debugTable);
+            }
+#endif
+
             LinuxUnloadGameCode(&game);
             game = LinuxLoadGameCode(gameSoName);
             printf("Hot reload\n");
@@ -867,6 +1252,14 @@ int main(int argc, char *args[])
 
         LinuxProcessEvents(window, renderer, &linuxState, newKeyboardInput, newMouseInput);
 
+#if HEX_MAGIC_INTERNAL
+        if (linuxState.pendingReplayIndex)
+        {
+            LinuxToggleReplay(&linuxState, &gameMemory, linuxState.pendingReplayIndex - 1);
+            linuxState.pendingReplayIndex = 0;
+        }
+#endif
+
         if (!globalPause)
         {
             ThreadContext thread = {};
@@ -877,9 +1270,30 @@ int main(int argc, char *args[])
             buffer.height              = globalBackBuffer.height;
             buffer.pitch               = globalBackBuffer.pitch;
 
+#if HEX_MAGIC_INTERNAL
+            if (linuxState.inputPlayingIndex)
+            {
+                LinuxPlayBackInput(&linuxState, &gameMemory, newInput);
+            }
+#endif
+
             if (game.updateAndRender)
             {
                 game.updateAndRender(&thread, &gameMemory, newInput, &buffer);
+
+#if HEX_MAGIC_INTERNAL
+                LinuxLogStateHash(&linuxState.hashLog, gameMemory.debugStateHash);
+
+                if (linuxState.inputRecordingIndex)
+                {
+                    LinuxRecordInput(&linuxState, newInput, gameMemory.debugStateHash);
+                }
+
+                if (linuxState.inputPlayingIndex)
+                {
+                    LinuxCheckPlayBackHash(&linuxState, gameMemory.debugStateHash);
+                }
+#endif
             }
 
             uint64 audioWallClock          = SDL_GetPerformanceCounter();
@@ -965,6 +1379,15 @@ int main(int argc, char *args[])
 
             real64 mcPerFrame = (real64)cyclesElapsed / (1000 * 1000);
 
+            if (gameMemory.debugTable)
+            {
+                LinuxCollateDebugEvents(gameMemory.debugTable);
+                LinuxTraceDebugEvents(&globalDebugTrace, gameMemory.debugTable);
+
+                gameMemory.debugTable->collatedSecondsElapsed = secondsPerFrame;
+                gameMemory.debugTable->collatedClockCount     = cyclesElapsed;
+            }
+
             if (currentSecond > 1.0f)
             {
                 // printf("%.02fms/f, %df/s, %.02fMc/f\n", msPerFrame, fps, mcPerFrame);
@@ -984,12 +1407,37 @@ int main(int argc, char *args[])
 
             flpWallClock = SDL_GetPerformanceCounter();
 
+#if HEX_MAGIC_INTERNAL
+            // NOTE most of the time it takes to get to the first frame is the game loading its assets.
+            if (!firstFrameShown)
+            {
+                printf("First frame %.2fms after start\n",
+                       1000.0f * LinuxGetSecondsElapsed(startupCounter, flpWallClock));
+            }
+#endif
+
+            firstFrameShown = true;
+
             GameInput *temp = newInput;
             newInput        = oldInput;
             oldInput        = temp;
         }
     }
 
+    LinuxCompleteAllWork(&lowPriorityQueue);
+
+#if HEX_MAGIC_INTERNAL
+    LinuxFlushHashLog(&linuxState.hashLog);
+
+    if (gameMemory.debugTable)
+    {
+        LinuxCollateDebugEvents(gameMemory.debugTable);
+        LinuxTraceDebugEvents(&globalDebugTrace, gameMemory.debugTable);
+    }
+
+    LinuxEndDebugTrace(&globalDebugTrace);
+#endif
+
     SDL_CloseAudio();
 
     return 0;
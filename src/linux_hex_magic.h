@@ -54,11 +54,62 @@ struct LinuxGameCode
     bool32 isValid;
 };
 
+#define LINUX_REPLAY_BUFFER_COUNT 4
+#define LINUX_REPLAY_MAGIC_VALUE 0x52584548
+#define LINUX_REPLAY_VERSION 2
+
+// NOTE a replay file starts with a snapshot of game memory, the header and the runs of pages it holds followed by the
+// pages themselves from the first page boundary on, and then has a frame appended for every update it was recording.
+struct LinuxReplayHeader
+{
+    uint32 magicValue;
+    uint32 version;
+
+    // NOTE the size of the game memory the snapshot was taken of.
+    uint64 totalSize;
+
+    uint64 runCount;
+
+    // NOTE where the frames start.
+    uint64 snapshotSize;
+};
+
+struct LinuxReplayRun
+{
+    uint64 offset;
+    uint64 size;
+};
+
+// NOTE the hash the frame left the simulation in, which playing it back has to come out with too.
+struct LinuxReplayFrame
+{
+    GameInput input;
+    uint64 stateHash;
+};
+
 struct LinuxReplayBuffer
 {
     int fileHandle;
     char fileName[PATH_MAX];
+
+    // NOTE the snapshot part of the file, mapped.
     void *memoryBlock;
+    uint64 memorySize;
+};
+
+#define LINUX_HASH_LOG_BUFFER_SIZE Kilobytes(16)
+
+// NOTE the state hash of every frame as a line of text, so the logs of two runs can be diffed to find the first frame
+// where they went apart.
+struct LinuxHashLog
+{
+    bool32 isLogging;
+    char fileName[PATH_MAX];
+
+    uint64 frameIndex;
+
+    uint32 bufferedSize;
+    char buffer[LINUX_HASH_LOG_BUFFER_SIZE];
 };
 
 struct LinuxState
@@ -75,6 +126,19 @@ struct LinuxState
 
     bool32 showCursor;
     SDL_Cursor *cursor;
+
+    LinuxHashLog hashLog;
+
+    // NOTE slot + 1 of the replay being recorded or played back, 0 when there is none. A slot key pressed during the
+    // frame is pending until the events are through.
+    LinuxReplayBuffer replayBuffers[LINUX_REPLAY_BUFFER_COUNT];
+    uint32 inputRecordingIndex;
+    uint32 inputPlayingIndex;
+    uint32 pendingReplayIndex;
+
+    uint64 playBackFrameIndex;
+    uint64 playBackStateHash;
+    bool32 playBackHasDiverged;
 };
 
 #define LINUX_HEX_MAGIC
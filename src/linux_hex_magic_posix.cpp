@@ -0,0 +1,566 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hex_magic_platform.h"
+
+// NOTE platform services that only need POSIX, shared by the SDL platform layer and the headless bench.
+
+struct PlatformWorkQueueEntry
+{
+    PlatformWorkQueueCallback *callback;
+    void *data;
+};
+
+struct PlatformWorkQueue
+{
+    uint32 volatile completionGoal;
+    uint32 volatile completionCount;
+
+    uint32 volatile nextEntryToWrite;
+    uint32 volatile nextEntryToRead;
+    sem_t semaphore;
+
+    PlatformWorkQueueEntry entries[256];
+};
+
+internal void LinuxAddEntry(PlatformWorkQueue *queue, PlatformWorkQueueCallback *callback, void *data)
+{
+    // NOTE only the main thread adds entries.
+    uint32 newNextEntryToWrite = (queue->nextEntryToWrite + 1) % ArrayCount(queue->entries);
+    Assert(newNextEntryToWrite != queue->nextEntryToRead);
+
+    PlatformWorkQueueEntry *entry = queue->entries + queue->nextEntryToWrite;
+    entry->callback               = callback;
+    entry->data                   = data;
+
+    ++queue->completionGoal;
+
+    __sync_synchronize();
+
+    queue->nextEntryToWrite = newNextEntryToWrite;
+    sem_post(&queue->semaphore);
+}
+
+internal bool32 LinuxDoNextWorkQueueEntry(PlatformWorkQueue *queue)
+{
+    bool32 weShouldSleep = false;
+
+    uint32 originalNextEntryToRead = queue->nextEntryToRead;
+    uint32 newNextEntryToRead      = (originalNextEntryToRead + 1) % ArrayCount(queue->entries);
+
+    if (originalNextEntryToRead != queue->nextEntryToWrite)
+    {
+        uint32 index =
+            __sync_val_compare_and_swap(&queue->nextEntryToRead, originalNextEntryToRead, newNextEntryToRead);
+
+        if (index == originalNextEntryToRead)
+        {
+            PlatformWorkQueueEntry entry = queue->entries[index];
+            entry.callback(queue, entry.data);
+
+            __sync_fetch_and_add(&queue->completionCount, 1);
+        }
+    }
+    else
+    {
+        weShouldSleep = true;
+    }
+
+    return weShouldSleep;
+}
+
+internal void LinuxCompleteAllWork(PlatformWorkQueue *queue)
+{
+    while (queue->completionGoal != queue->completionCount)
+    {
+        LinuxDoNextWorkQueueEntry(queue);
+    }
+
+    queue->completionGoal  = 0;
+    queue->completionCount = 0;
+}
+
+internal void *LinuxThreadProc(void *parameter)
+{
+    PlatformWorkQueue *queue = (PlatformWorkQueue *)parameter;
+
+    for (;;)
+    {
+        if (LinuxDoNextWorkQueueEntry(queue))
+        {
+            sem_wait(&queue->semaphore);
+        }
+    }
+
+    return 0;
+}
+
+internal void LinuxMakeQueue(PlatformWorkQueue *queue, uint32 threadCount)
+{
+    queue->completionGoal   = 0;
+    queue->completionCount  = 0;
+    queue->nextEntryToWrite = 0;
+    queue->nextEntryToRead  = 0;
+
+    sem_init(&queue->semaphore, 0, 0);
+
+    for (uint32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, 0, LinuxThreadProc, queue) == 0)
+        {
+            pthread_detach(thread);
+        }
+        else
+        {
+            printf("Failed to create worker thread\n");
+        }
+    }
+}
+
+// NOTE one thread per core besides the main one, which helps out whenever it waits on the queue.
+internal uint32 LinuxGetWorkerThreadCount()
+{
+    long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32 result  = coreCount > 1 ? (uint32)(coreCount - 1) : 0;
+
+    return result;
+}
+
+DEBUG_PLATFORM_FREE_FILE_MEMORY(debugPlatformFreeFileMemory)
+{
+    if (memory)
+    {
+        free(memory);
+    }
+}
+
+DEBUG_PLATFORM_READ_ENTIRE_FILE(debugPlatformReadEntireFile)
+{
+    DebugReadFileResult result = {};
+    int fileHandle             = open(fileName, O_RDONLY);
+    if (fileHandle == -1)
+    {
+        return result;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileHandle, &fileStatus) == -1)
+    {
+        close(fileHandle);
+        return result;
+    }
+
+    result.contentsSize = fileStatus.st_size;
+    result.contents     = malloc(result.contentsSize);
+    if (!result.contents)
+    {
+        result.contentsSize = 0;
+        close(fileHandle);
+        return result;
+    }
+
+    uint32 bytesToRead      = result.contentsSize;
+    uint8 *nextByteLocation = (uint8 *)result.contents;
+    while (bytesToRead)
+    {
+        ssize_t bytesRead = read(fileHandle, nextByteLocation, bytesToRead);
+        if (bytesRead == -1)
+        {
+            debugPlatformFreeFileMemory(thread, result.contents);
+            result.contents     = 0;
+            result.contentsSize = 0;
+            close(fileHandle);
+
+            return result;
+        }
+
+        bytesToRead -= bytesRead;
+        nextByteLocation += bytesRead;
+    }
+
+    close(fileHandle);
+    return result;
+}
+
+DEBUG_PLATFORM_WRITE_ENTIRE_FILE(debugPlatformWriteEntireFile)
+{
+    int fileHandle = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (fileHandle == -1)
+        return false;
+
+    uint32 bytesToWrite     = memorySize;
+    uint8 *nextByteLocation = (uint8 *)memory;
+    while (bytesToWrite)
+    {
+        ssize_t bytesWritten = write(fileHandle, nextByteLocation, bytesToWrite);
+        if (bytesWritten == -1)
+        {
+            close(fileHandle);
+            return false;
+        }
+        bytesToWrite -= bytesWritten;
+        nextByteLocation += bytesWritten;
+    }
+
+    close(fileHandle);
+
+    return true;
+}
+
+PLATFORM_MAP_READ_ONLY_FILE(platformMapReadOnlyFile)
+{
+    PlatformMappedFile result = {};
+
+    int fileHandle = open(fileName, O_RDONLY);
+    if (fileHandle == -1)
+    {
+        return result;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileHandle, &fileStatus) == -1 || fileStatus.st_size == 0)
+    {
+        close(fileHandle);
+        return result;
+    }
+
+    void *memory = mmap(0, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileHandle, 0);
+    close(fileHandle);
+
+    if (memory != MAP_FAILED)
+    {
+        result.size   = fileStatus.st_size;
+        result.memory = memory;
+    }
+
+    return result;
+}
+
+PLATFORM_UNMAP_FILE(platformUnmapFile)
+{
+    if (file->memory)
+    {
+        munmap(file->memory, file->size);
+    }
+
+    file->memory = 0;
+    file->size   = 0;
+}
+
+DEBUG_PLATFORM_MAP_FILE(debugPlatformMapFile)
+{
+    DebugMappedFile result = {};
+
+    int fileHandle = open(fileName, size ? O_RDWR | O_CREAT : O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fileHandle == -1)
+    {
+        return result;
+    }
+
+    if (size && ftruncate(fileHandle, (off_t)size) == -1)
+    {
+        close(fileHandle);
+        return result;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileHandle, &fileStatus) == -1 || fileStatus.st_size == 0)
+    {
+        close(fileHandle);
+        return result;
+    }
+
+    void *memory = mmap(0, fileStatus.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fileHandle, 0);
+    close(fileHandle);
+
+    if (memory != MAP_FAILED)
+    {
+        result.size   = fileStatus.st_size;
+        result.memory = memory;
+    }
+
+    return result;
+}
+
+DEBUG_PLATFORM_UNMAP_FILE(debugPlatformUnmapFile)
+{
+    if (file->memory)
+    {
+        munmap(file->memory, file->size);
+    }
+
+    file->memory = 0;
+    file->size   = 0;
+}
+
+DEBUG_PLATFORM_FLUSH_MAPPED_FILE(debugPlatformFlushMappedFile)
+{
+    bool32 result = file->memory && msync(file->memory, file->size, MS_SYNC) == 0;
+    return result;
+}
+
+DEBUG_PLATFORM_APPEND_TO_FILE(debugPlatformAppendToFile)
+{
+    int fileHandle = open(fileName, O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (fileHandle == -1)
+        return false;
+
+    uint32 bytesToWrite     = memorySize;
+    uint8 *nextByteLocation = (uint8 *)memory;
+    while (bytesToWrite)
+    {
+        ssize_t bytesWritten = write(fileHandle, nextByteLocation, bytesToWrite);
+        if (bytesWritten == -1)
+        {
+            close(fileHandle);
+            return false;
+        }
+        bytesToWrite -= bytesWritten;
+        nextByteLocation += bytesWritten;
+    }
+
+    close(fileHandle);
+
+    return true;
+}
+
+DEBUG_PLATFORM_SYNC_FILE(debugPlatformSyncFile)
+{
+    int fileHandle = open(fileName, O_RDONLY);
+
+    if (fileHandle == -1)
+        return false;
+
+    bool32 result = fsync(fileHandle) == 0;
+    close(fileHandle);
+
+    return result;
+}
+
+DEBUG_PLATFORM_REPLACE_FILE(debugPlatformReplaceFile)
+{
+    bool32 result = rename(sourceFileName, destFileName) == 0;
+    return result;
+}
+
+#if HEX_MAGIC_INTERNAL
+// NOTE the events of this thread in the debug table, the game code gets at it through GetDebugThreadSlot.
+thread_local DebugThreadEvents *globalLinuxDebugThreadSlot;
+
+// NOTE only reserved, the events of threads that never run a timed block never cost any memory.
+internal DebugTable *LinuxAllocateDebugTable()
+{
+    DebugTable *result = (DebugTable *)mmap(0, sizeof(DebugTable), PROT_READ | PROT_WRITE,
+                                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (result == MAP_FAILED)
+    {
+        result = 0;
+    }
+    else
+    {
+        result->threadSlotOffset = (int64)((uint64)&globalLinuxDebugThreadSlot - GetThreadId());
+    }
+
+    return result;
+}
+
+internal void *LinuxAllocateDebugStorage(uint64 size)
+{
+    void *result = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (result == MAP_FAILED)
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+// NOTE hands every thread the other array and leaves what they wrote this frame to be read until the next swap. A
+// thread that picked its array just before the swap can still be writing into it for a few cycles after, which at
+// worst loses that one event.
+internal void LinuxCollateDebugEvents(DebugTable *table)
+{
+    uint32 arrayIndex     = table->arrayIndex;
+    uint32 nextArrayIndex = arrayIndex ^ 1;
+
+    uint32 threadCount = table->threadCount;
+    if (threadCount > DEBUG_MAX_THREAD_COUNT)
+    {
+        threadCount = DEBUG_MAX_THREAD_COUNT;
+    }
+
+    for (uint32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        table->threads[threadIndex].eventCounts[nextArrayIndex] = 0;
+    }
+
+    __sync_synchronize();
+    table->arrayIndex = nextArrayIndex;
+    __sync_synchronize();
+
+    table->collatedArrayIndex = arrayIndex;
+
+    for (uint32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        DebugThreadEvents *thread = table->threads + threadIndex;
+        uint32 eventCount         = thread->eventCounts[arrayIndex];
+
+        thread->collatedEventCount = eventCount < DEBUG_MAX_EVENT_COUNT ? eventCount : DEBUG_MAX_EVENT_COUNT;
+        thread->droppedEventCount  = eventCount - thread->collatedEventCount;
+    }
+}
+
+// NOTE the events still name blocks in the game code that is about to go away, collating twice leaves nothing of it to
+// be read.
+internal void LinuxDropDebugEvents(DebugTable *table)
+{
+    LinuxCollateDebugEvents(table);
+    LinuxCollateDebugEvents(table);
+}
+
+#define LINUX_DEBUG_TRACE_BUFFER_SIZE Megabytes(1)
+
+// NOTE writes the events out in Chrome's trace event format, which chrome://tracing and Perfetto open.
+struct LinuxDebugTrace
+{
+    bool32 isTracing;
+    char fileName[4096];
+
+    uint64 startClock;
+    real64 clocksPerMicrosecond;
+    bool32 hasEvents;
+
+    uint32 bufferedSize;
+    char buffer[LINUX_DEBUG_TRACE_BUFFER_SIZE];
+};
+
+inline uint64 LinuxGetNanoseconds()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    uint64 result = (uint64)time.tv_sec * 1000 * 1000 * 1000 + (uint64)time.tv_nsec;
+    return result;
+}
+
+// NOTE the time stamp counter runs at a fixed rate, a few milliseconds against the monotonic clock are plenty to find
+// it.
+internal real64 LinuxMeasureClocksPerMicrosecond()
+{
+    uint64 startTime  = LinuxGetNanoseconds();
+    uint64 startClock = __rdtsc();
+    uint64 endTime    = startTime;
+
+    while (endTime - startTime < 10 * 1000 * 1000)
+    {
+        endTime = LinuxGetNanoseconds();
+    }
+
+    real64 result = (real64)(__rdtsc() - startClock) * 1000.0 / (real64)(endTime - startTime);
+    return result;
+}
+
+internal void LinuxFlushDebugTrace(LinuxDebugTrace *trace)
+{
+    ThreadContext thread = {};
+
+    if (trace->isTracing && trace->bufferedSize)
+    {
+        debugPlatformAppendToFile(&thread, trace->fileName, trace->bufferedSize, trace->buffer);
+        trace->bufferedSize = 0;
+    }
+}
+
+internal void LinuxBeginDebugTrace(LinuxDebugTrace *trace, char *fileName)
+{
+    ThreadContext thread = {};
+    char *header         = (char *)"{\"traceEvents\":[\n";
+
+    trace->isTracing    = debugPlatformWriteEntireFile(&thread, fileName, (uint32)strlen(header), header);
+    trace->hasEvents    = false;
+    trace->bufferedSize = 0;
+
+    if (trace->isTracing)
+    {
+        snprintf(trace->fileName, sizeof(trace->fileName), "%s", fileName);
+
+        trace->clocksPerMicrosecond = LinuxMeasureClocksPerMicrosecond();
+        trace->startClock           = __rdtsc();
+    }
+    else
+    {
+        printf("Could not open the trace %s\n", fileName);
+    }
+}
+
+// NOTE goes through what the last collate left to be read, has to run before the game code gets reloaded.
+internal void LinuxTraceDebugEvents(LinuxDebugTrace *trace, DebugTable *table)
+{
+    if (trace->isTracing)
+    {
+        uint32 threadCount = table->threadCount;
+        if (threadCount > DEBUG_MAX_THREAD_COUNT)
+        {
+            threadCount = DEBUG_MAX_THREAD_COUNT;
+        }
+
+        for (uint32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+        {
+            DebugThreadEvents *thread = table->threads + threadIndex;
+            DebugEvent *events        = thread->events[table->collatedArrayIndex];
+
+            for (uint32 eventIndex = 0; eventIndex < thread->collatedEventCount; ++eventIndex)
+            {
+                DebugEvent *event = events + eventIndex;
+
+                // NOTE an event at the very end of the frame may not be there yet, see LinuxCollateDebugEvents.
+                if (!event->blockName)
+                {
+                    continue;
+                }
+
+                // NOTE a line is never longer than the block name and a few numbers.
+                if (trace->bufferedSize + strlen(event->blockName) + 128 > sizeof(trace->buffer))
+                {
+                    LinuxFlushDebugTrace(trace);
+                }
+
+                real64 timeStamp = (real64)(int64)(event->clock - trace->startClock) / trace->clocksPerMicrosecond;
+                char phase       = event->type == DEBUG_EVENT_BEGIN_BLOCK ? 'B' : 'E';
+
+                trace->bufferedSize += snprintf(trace->buffer + trace->bufferedSize,
+                                                sizeof(trace->buffer) - trace->bufferedSize,
+                                                "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}",
+                                                trace->hasEvents ? ",\n" : "", event->blockName, phase, timeStamp,
+                                                threadIndex);
+                trace->hasEvents = true;
+            }
+        }
+    }
+}
+
+internal void LinuxEndDebugTrace(LinuxDebugTrace *trace)
+{
+    if (trace->isTracing)
+    {
+        trace->bufferedSize +=
+            snprintf(trace->buffer + trace->bufferedSize, sizeof(trace->buffer) - trace->bufferedSize, "\n]}\n");
+
+        LinuxFlushDebugTrace(trace);
+        trace->isTracing = false;
+    }
+}
+#endif